@@ -0,0 +1,252 @@
+// JavaScript wrapper for the native audio storage module
+let storageModule = null;
+
+try {
+  storageModule = require("./build/Release/audio_storage.node");
+} catch (error) {
+  console.warn("⚠️ Audio storage module not available:", error.message);
+  console.warn("   Segments will be written with fs on the main thread");
+  console.warn("   To build it: cd native-audio && npm run rebuild");
+}
+
+class SegmentWriter {
+  /**
+   * @param {Object} options
+   * @param {string} options.directory - Output directory (created if missing)
+   * @param {string} [options.prefix="segment"] - File name prefix
+   * @param {string} [options.format="wav"] - "wav" or "flac" (16-bit)
+   * @param {number} [options.sampleRate=16000]
+   * @param {number} [options.channels=1]
+   * @param {number} [options.maxDurationMs=0] - Rotate after this much audio (0 = never)
+   * @param {number} [options.maxBytes=0] - Rotate after this many bytes (0 = never)
+   * @param {number} [options.preallocateBytes=0] - Reserve per file (0 = derive from limits)
+   * @param {string} [options.fsync="close"] - "none", "close", "interval" or "always"
+   * @param {number} [options.fsyncIntervalMs=1000] - Period for fsync: "interval"
+   * @param {Function} [options.onSegment] - Called with info for every closed segment
+   * @param {Function} [options.onError] - Called with (message, info) when a segment fails
+   */
+  constructor(options) {
+    this.options = options;
+    this.writer = null;
+
+    if (!storageModule) {
+      return;
+    }
+
+    const { onSegment, onError } = options;
+    this.writer = new storageModule.SegmentWriter(options, (info) => {
+      if (info.error) {
+        if (onError) {
+          onError(info.error, info);
+        } else {
+          console.error(`❌ Segment writer error: ${info.error}`);
+        }
+        return;
+      }
+      if (onSegment) {
+        onSegment(info);
+      }
+    });
+  }
+
+  /**
+   * Check if the native writer is available
+   * @returns {boolean} True if the module is loaded
+   */
+  isAvailable() {
+    return this.writer !== null;
+  }
+
+  /**
+   * Queue samples for writing. Returns immediately; I/O happens on a native thread.
+   * @param {Float32Array|Int16Array|Buffer} samples - Float32 or s16le PCM
+   */
+  append(samples) {
+    this.writer.append(samples);
+  }
+
+  /**
+   * Close the current segment once everything queued so far is written
+   */
+  rotate() {
+    this.writer.rotate();
+  }
+
+  /**
+   * Flush, close the open segment and stop the I/O thread
+   * @returns {Promise<void>} Resolves once all segment callbacks have been queued
+   */
+  close() {
+    return this.writer.close();
+  }
+
+  /**
+   * @returns {{framesQueued: number, bytesWritten: number, queueDepth: number}}
+   */
+  getStats() {
+    return this.writer.getStats();
+  }
+}
+
+class CaptureSpool {
+  /**
+   * Open (and recover) a crash-safe capture spool.
+   * An existing spool keeps its stored capacity, sampleRate and channels.
+   * @param {Object} options
+   * @param {string} options.path - Spool file
+   * @param {number} [options.capacityBytes=16777216] - Ring size
+   * @param {number} [options.sampleRate=16000]
+   * @param {number} [options.channels=1]
+   * @param {boolean} [options.overwrite=true] - Drop the oldest audio when full
+   * @param {number} [options.syncIntervalMs=0] - Background flush period (0 = only sync()/close())
+   */
+  constructor(options) {
+    if (!storageModule) {
+      throw new Error("Audio storage module not available");
+    }
+    this.spool = new storageModule.CaptureSpool(options);
+  }
+
+  /**
+   * Write samples straight into the mapped ring (int16; Float32 is converted)
+   * @param {Float32Array|Int16Array|Buffer} samples
+   * @returns {boolean} false if the spool is full and overwrite is off
+   */
+  append(samples) {
+    return this.spool.append(samples);
+  }
+
+  /**
+   * Close the current segment and start the next one
+   * @returns {number} Id of the closed segment
+   */
+  endSegment() {
+    return this.spool.endSegment();
+  }
+
+  /**
+   * Segments not yet acknowledged (including ones recovered from a crash)
+   * @returns {Array<{id: number, startFrame: number, frames: number, bytes: number, durationMs: number, complete: boolean}>}
+   */
+  pendingSegments() {
+    return this.spool.pendingSegments();
+  }
+
+  /**
+   * Stream committed audio of one segment at a time
+   * @param {number} [cursor=0] - nextCursor from the previous call
+   * @param {number} [maxBytes=65536]
+   * @returns {{data: Buffer, segment: number, startFrame: number, nextCursor: number, endOfSegment: boolean}|null}
+   */
+  read(cursor = 0, maxBytes = 65536) {
+    return this.spool.read(cursor, maxBytes);
+  }
+
+  /**
+   * @param {number} id - Segment id
+   * @returns {Buffer|null} int16 PCM of the whole segment
+   */
+  readSegment(id) {
+    return this.spool.readSegment(id);
+  }
+
+  /**
+   * Release a segment (and every older one) once it has been uploaded
+   * @param {number} id - Segment id
+   */
+  ack(id) {
+    this.spool.ack(id);
+  }
+
+  /**
+   * Flush mapped pages to disk (power-loss durability)
+   */
+  sync() {
+    return this.spool.sync();
+  }
+
+  close() {
+    this.spool.close();
+  }
+
+  getStats() {
+    return this.spool.getStats();
+  }
+}
+
+class SegmentStore {
+  /**
+   * Append-only segment store (segments.dat + segments.idx in one directory)
+   * @param {Object} options
+   * @param {string} options.directory
+   * @param {number} [options.maxBytes=0] - Expire oldest segments above this (0 = unlimited)
+   * @param {number} [options.maxAgeMs=0] - Expire segments older than this
+   * @param {number} [options.maxSegments=0]
+   * @param {boolean} [options.sync=false] - fsync on every append
+   */
+  constructor(options) {
+    if (!storageModule) {
+      throw new Error("Audio storage module not available");
+    }
+    this.store = new storageModule.SegmentStore(options);
+  }
+
+  /**
+   * @param {{session: number, stream: number, startSample: number, sampleRate: number,
+   *          durationSamples?: number, codec?: string}} meta - codec: pcm16, wav, flac, opus or mp3
+   * @param {Buffer|TypedArray} data - Encoded segment (durationSamples required unless pcm16)
+   * @returns {number} Segment id
+   */
+  append(meta, data) {
+    return this.store.append(meta, data);
+  }
+
+  /**
+   * Segments of one stream overlapping [fromMs, toMs), in time order
+   * @param {{session: number, stream: number, fromMs?: number, toMs?: number}} range
+   * @returns {Array<Object>} Segment metadata
+   */
+  query(range) {
+    return this.store.query(range);
+  }
+
+  /**
+   * Segment payload as a Buffer over the mapped data file (copied only where
+   * the runtime forbids external buffers)
+   * @param {number} id
+   * @returns {Buffer|null}
+   */
+  read(id) {
+    return this.store.read(id);
+  }
+
+  get(id) {
+    return this.store.get(id);
+  }
+
+  /**
+   * @returns {Array<{session: number, stream: number}>}
+   */
+  streams() {
+    return this.store.streams();
+  }
+
+  compact() {
+    return this.store.compact();
+  }
+
+  close() {
+    this.store.close();
+  }
+
+  getStats() {
+    return this.store.getStats();
+  }
+}
+
+module.exports = {
+  SegmentWriter,
+  CaptureSpool,
+  SegmentStore,
+  isAvailable: () => storageModule !== null,
+};
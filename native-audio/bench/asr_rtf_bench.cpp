@@ -0,0 +1,164 @@
+// On-device ASR real-time factor
+//
+// Transcribes a 16 kHz mono s16le WAV file (or synthetic speech-like audio
+// when no file is given) with asr::WhisperEngine and reports time per stage
+// and the real-time factor (processing time / audio duration; below 1.0 is
+// faster than real time). Runs once to warm up, then `runs` times.
+//
+// Model load time is reported as well. With a cache path the model is loaded
+// twice: the first load converts the ggml file and writes the tensor
+// container, the second maps it (the startup path of every later process).
+// Drop the page cache in between (e.g. `purge` on macOS) to see a cold read.
+//
+// Build: npm run bench:build
+// Run:   ./build/Release/asr_rtf_bench <model.bin> [audio.wav] [threads] [runs] [audioCtx] [f32|int8|int4] [cache.tnsr]
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "asr/whisper_engine.h"
+
+static std::vector<float> MakeSpeechLikeSignal(int sampleRate, int seconds) {
+    std::vector<float> signal(static_cast<size_t>(sampleRate) * seconds);
+    std::mt19937 rng(42);
+    std::normal_distribution<float> noise(0.0f, 0.01f);
+    for (size_t i = 0; i < signal.size(); i++) {
+        const float t = static_cast<float>(i) / sampleRate;
+        const float f0 = 140.0f + 30.0f * std::sin(2.0f * static_cast<float>(M_PI) * 0.7f * t);
+        const float envelope = 0.5f + 0.5f * std::sin(2.0f * static_cast<float>(M_PI) * 4.0f * t);
+        float s = 0.0f;
+        for (int h = 1; h <= 6; h++) {
+            s += std::sin(2.0f * static_cast<float>(M_PI) * f0 * h * t) / h;
+        }
+        signal[i] = 0.2f * envelope * s + noise(rng);
+    }
+    return signal;
+}
+
+// Minimal RIFF reader: 16-bit PCM, mono, 16 kHz only
+static bool ReadWav(const char* path, std::vector<float>* out) {
+    FILE* file = std::fopen(path, "rb");
+    if (!file) return false;
+    std::vector<uint8_t> bytes;
+    uint8_t buffer[65536];
+    size_t n;
+    while ((n = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        bytes.insert(bytes.end(), buffer, buffer + n);
+    }
+    std::fclose(file);
+
+    if (bytes.size() < 12 || std::memcmp(bytes.data(), "RIFF", 4) != 0 ||
+        std::memcmp(bytes.data() + 8, "WAVE", 4) != 0) {
+        return false;
+    }
+    bool formatOk = false;
+    for (size_t pos = 12; pos + 8 <= bytes.size();) {
+        uint32_t size;
+        std::memcpy(&size, bytes.data() + pos + 4, 4);
+        const uint8_t* body = bytes.data() + pos + 8;
+        if (std::memcmp(bytes.data() + pos, "fmt ", 4) == 0 && size >= 16) {
+            uint16_t format, channels, bits;
+            uint32_t rate;
+            std::memcpy(&format, body, 2);
+            std::memcpy(&channels, body + 2, 2);
+            std::memcpy(&rate, body + 4, 4);
+            std::memcpy(&bits, body + 14, 2);
+            formatOk = format == 1 && channels == 1 && rate == 16000 && bits == 16;
+        } else if (std::memcmp(bytes.data() + pos, "data", 4) == 0 && formatOk) {
+            const size_t samples = std::min<size_t>(size, bytes.size() - pos - 8) / 2;
+            out->resize(samples);
+            for (size_t i = 0; i < samples; i++) {
+                int16_t s;
+                std::memcpy(&s, body + i * 2, 2);
+                (*out)[i] = s / 32768.0f;
+            }
+            return true;
+        }
+        pos += 8 + size + (size & 1);
+    }
+    return false;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr,
+                     "usage: %s <model.bin> [audio.wav] [threads] [runs] [audioCtx] [f32|int8|int4] [cache.tnsr]\n",
+                     argv[0]);
+        return 1;
+    }
+    const int threads = argc > 3 ? std::atoi(argv[3]) : 0;
+    const int runs = argc > 4 ? std::max(1, std::atoi(argv[4])) : 3;
+    const int audioCtx = argc > 5 ? std::atoi(argv[5]) : 0;
+    asr::WhisperLoadOptions loadOptions;
+    if (argc > 6 && !asr::parseWeightType(argv[6], &loadOptions.weights)) {
+        std::fprintf(stderr, "unknown weight type %s\n", argv[6]);
+        return 1;
+    }
+    if (argc > 7) loadOptions.cachePath = argv[7];
+
+    std::vector<float> audio;
+    if (argc > 2 && std::strcmp(argv[2], "-") != 0) {
+        if (!ReadWav(argv[2], &audio)) {
+            std::fprintf(stderr, "cannot read %s (need 16 kHz mono 16-bit PCM WAV)\n", argv[2]);
+            return 1;
+        }
+    } else {
+        audio = MakeSpeechLikeSignal(asr::kSampleRate, 10);
+    }
+
+    std::shared_ptr<asr::WhisperModel> model = std::make_shared<asr::WhisperModel>();
+    std::string error;
+    if (!model->load(argv[1], &error, loadOptions)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    std::printf("load %.1f ms (%s)\n", model->loadMs(), model->mapped() ? "mapped cache" : "ggml");
+    if (!model->cacheError().empty()) {
+        std::printf("cache not written: %s\n", model->cacheError().c_str());
+    } else if (!model->mapped() && !loadOptions.cachePath.empty()) {
+        model = std::make_shared<asr::WhisperModel>();
+        if (!model->load(argv[1], &error, loadOptions)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return 1;
+        }
+        std::printf("load %.1f ms (%s)\n", model->loadMs(), model->mapped() ? "mapped cache" : "ggml");
+    }
+    asr::WhisperEngine engine(model, threads);
+
+    const double audioMs = audio.size() * 1000.0 / asr::kSampleRate;
+    std::printf("model %s (%s), %s weights (%.0f MB), %d threads, %.1f s of audio, audioCtx %d\n\n",
+                model->modelType().c_str(), model->multilingual() ? "multilingual" : "English",
+                asr::weightTypeName(model->weightType()), model->weightBytes() / 1e6, engine.threads(),
+                audioMs / 1000.0, audioCtx > 0 ? audioCtx : model->hparams().nAudioCtx);
+    std::printf("%4s %10s %10s %10s %10s %8s %7s\n", "run", "mel_ms", "encode_ms", "decode_ms",
+                "total_ms", "tokens", "rtf");
+
+    asr::TranscribeOptions options;
+    options.audioCtx = audioCtx;
+    asr::TranscribeResult result;
+    double best = 1e30;
+    for (int run = 0; run <= runs; run++) {
+        if (!engine.transcribe(audio.data(), audio.size(), options, &result, &error)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return 1;
+        }
+        const asr::TranscribeTimings& t = result.timings;
+        const double total = t.melMs + t.encodeMs + t.decodeMs;
+        if (run == 0) continue;  // warm-up
+        best = std::min(best, total);
+        std::printf("%4d %10.1f %10.1f %10.1f %10.1f %8d %7.3f\n", run, t.melMs, t.encodeMs,
+                    t.decodeMs, total, t.tokens, total / audioMs);
+    }
+
+    std::printf("\nbest rtf %.3f, language %s (p=%.2f)\n", best / audioMs, result.language.c_str(),
+                result.languageProbability);
+    std::printf("text: %s\n", result.text.c_str());
+    return 0;
+}
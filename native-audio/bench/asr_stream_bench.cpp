@@ -0,0 +1,173 @@
+// Streaming ASR latency
+//
+// Feeds a 16 kHz mono s16le WAV file (or synthetic speech-like audio) to
+// asr::WhisperStream in 20 ms blocks, as the capture path delivers it, and
+// reports per step: compute time, tokens verified from the previous partial
+// (draft) versus decoded one by one, and conv stem rows reused. Partial
+// latency is the time from a sample arriving to the partial that covers it:
+// at most one step of buffering plus that step's compute. Final text is
+// printed as it is committed.
+//
+// Build: npm run bench:build
+// Run:   ./build/Release/asr_stream_bench <model.bin> [audio.wav] [threads] [stepMs] [f32|int8|int4]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "asr/whisper_stream.h"
+
+static std::vector<float> MakeSpeechLikeSignal(int sampleRate, int seconds) {
+    std::vector<float> signal(static_cast<size_t>(sampleRate) * seconds);
+    std::mt19937 rng(42);
+    std::normal_distribution<float> noise(0.0f, 0.01f);
+    for (size_t i = 0; i < signal.size(); i++) {
+        const float t = static_cast<float>(i) / sampleRate;
+        const float f0 = 140.0f + 30.0f * std::sin(2.0f * static_cast<float>(M_PI) * 0.7f * t);
+        const float envelope = 0.5f + 0.5f * std::sin(2.0f * static_cast<float>(M_PI) * 4.0f * t);
+        float s = 0.0f;
+        for (int h = 1; h <= 6; h++) {
+            s += std::sin(2.0f * static_cast<float>(M_PI) * f0 * h * t) / h;
+        }
+        signal[i] = 0.2f * envelope * s + noise(rng);
+    }
+    return signal;
+}
+
+// Minimal RIFF reader: 16-bit PCM, mono, 16 kHz only
+static bool ReadWav(const char* path, std::vector<float>* out) {
+    FILE* file = std::fopen(path, "rb");
+    if (!file) return false;
+    std::vector<uint8_t> bytes;
+    uint8_t buffer[65536];
+    size_t n;
+    while ((n = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        bytes.insert(bytes.end(), buffer, buffer + n);
+    }
+    std::fclose(file);
+
+    if (bytes.size() < 12 || std::memcmp(bytes.data(), "RIFF", 4) != 0 ||
+        std::memcmp(bytes.data() + 8, "WAVE", 4) != 0) {
+        return false;
+    }
+    bool formatOk = false;
+    for (size_t pos = 12; pos + 8 <= bytes.size();) {
+        uint32_t size;
+        std::memcpy(&size, bytes.data() + pos + 4, 4);
+        const uint8_t* body = bytes.data() + pos + 8;
+        if (std::memcmp(bytes.data() + pos, "fmt ", 4) == 0 && size >= 16) {
+            uint16_t format, channels, bits;
+            uint32_t rate;
+            std::memcpy(&format, body, 2);
+            std::memcpy(&channels, body + 2, 2);
+            std::memcpy(&rate, body + 4, 4);
+            std::memcpy(&bits, body + 14, 2);
+            formatOk = format == 1 && channels == 1 && rate == 16000 && bits == 16;
+        } else if (std::memcmp(bytes.data() + pos, "data", 4) == 0 && formatOk) {
+            const size_t samples = std::min<size_t>(size, bytes.size() - pos - 8) / 2;
+            out->resize(samples);
+            for (size_t i = 0; i < samples; i++) {
+                int16_t s;
+                std::memcpy(&s, body + i * 2, 2);
+                (*out)[i] = s / 32768.0f;
+            }
+            return true;
+        }
+        pos += 8 + size + (size & 1);
+    }
+    return false;
+}
+
+static double Percentile(std::vector<double> values, double p) {
+    if (values.empty()) return 0.0;
+    std::sort(values.begin(), values.end());
+    return values[static_cast<size_t>(p * (values.size() - 1))];
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s <model.bin> [audio.wav] [threads] [stepMs] [f32|int8|int4]\n", argv[0]);
+        return 1;
+    }
+    const int threads = argc > 3 ? std::atoi(argv[3]) : 0;
+    asr::StreamOptions streamOptions;
+    if (argc > 4) streamOptions.stepMs = std::atoi(argv[4]);
+    asr::WhisperLoadOptions loadOptions;
+    if (argc > 5 && !asr::parseWeightType(argv[5], &loadOptions.weights)) {
+        std::fprintf(stderr, "unknown weight type %s\n", argv[5]);
+        return 1;
+    }
+
+    std::vector<float> audio;
+    if (argc > 2 && std::strcmp(argv[2], "-") != 0) {
+        if (!ReadWav(argv[2], &audio)) {
+            std::fprintf(stderr, "cannot read %s (need 16 kHz mono 16-bit PCM WAV)\n", argv[2]);
+            return 1;
+        }
+    } else {
+        audio = MakeSpeechLikeSignal(asr::kSampleRate, 20);
+    }
+
+    std::shared_ptr<asr::WhisperModel> model = std::make_shared<asr::WhisperModel>();
+    std::string error;
+    if (!model->load(argv[1], &error, loadOptions)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    auto engine = std::make_shared<asr::WhisperEngine>(model, threads);
+    asr::WhisperStream stream(engine);
+    if (!stream.start(streamOptions, &error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+
+    std::printf("model %s, %s weights, %d threads, %.1f s of audio, step %d ms\n\n", model->modelType().c_str(),
+                asr::weightTypeName(model->weightType()), engine->threads(),
+                audio.size() / static_cast<double>(asr::kSampleRate), streamOptions.stepMs);
+
+    const size_t block = asr::kSampleRate / 50;
+    std::vector<double> stepMs;
+    asr::StreamUpdate update;
+    auto report = [&](const asr::StreamUpdate& u) {
+        for (const asr::TranscriptSegment& segment : u.finals) {
+            std::printf("[%6.2f s] final %6.2f-%6.2f  %s\n", u.audioMs / 1000.0, segment.startMs / 1000.0,
+                        segment.endMs / 1000.0, segment.text.c_str());
+        }
+    };
+    for (size_t offset = 0; offset < audio.size(); offset += block) {
+        const auto start = std::chrono::steady_clock::now();
+        if (!stream.push(audio.data() + offset, std::min(block, audio.size() - offset), &update, &error)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return 1;
+        }
+        if (update.decoded) {
+            stepMs.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        }
+        report(update);
+    }
+    if (!stream.finish(&update, &error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    report(update);
+
+    const asr::StreamTimings& t = stream.totals();
+    const double audioMs = audio.size() * 1000.0 / asr::kSampleRate;
+    const double computeMs = t.melMs + t.encodeMs + t.decodeMs;
+    std::printf("\n%d steps: step p50 %.1f ms, p95 %.1f ms, max %.1f ms\n", t.steps, Percentile(stepMs, 0.5),
+                Percentile(stepMs, 0.95), Percentile(stepMs, 1.0));
+    std::printf("partial latency p95 %.0f ms (step %d ms + compute)\n", streamOptions.stepMs + Percentile(stepMs, 0.95),
+                streamOptions.stepMs);
+    std::printf("mel %.1f ms, encode %.1f ms, decode %.1f ms, rtf %.3f\n", t.melMs, t.encodeMs, t.decodeMs,
+                computeMs / audioMs);
+    std::printf("tokens: %d from drafts, %d decoded one by one; %d conv rows reused\n", t.draftTokens, t.tokens,
+                t.reusedFrames);
+    return 0;
+}
@@ -0,0 +1,90 @@
+// Compares two Google Benchmark JSON reports (hot_paths_bench
+// --benchmark_out=<file> --benchmark_out_format=json) benchmark by benchmark
+//
+// Uses the median aggregate when the reports were run with
+// --benchmark_repetitions, else the mean over the runs of each benchmark;
+// CPU time, or real time for benchmarks measured with UseRealTime. Prints the
+// change per benchmark and exits non-zero if any got slower by more than the
+// threshold (default 10%).
+//
+// Run: npm run bench:compare -- base.json new.json [threshold_percent]
+
+const fs = require("fs");
+
+const UNIT_NS = { ns: 1, us: 1e3, ms: 1e6, s: 1e9 };
+
+function loadTimes(file) {
+  // Aggregates of constant counters come out as bare NaN or inf, which is not JSON
+  const text = fs.readFileSync(file, "utf8").replace(/:\s*-?(NaN|nan|inf|Infinity)\b/g, ": null");
+  const report = JSON.parse(text);
+  const runs = new Map();
+  const medians = new Map();
+  for (const b of report.benchmarks || []) {
+    const name = b.run_name || b.name;
+    const realTime = name.endsWith("/real_time");
+    const ns = (realTime ? b.real_time : b.cpu_time) * (UNIT_NS[b.time_unit] || 1);
+    if (b.run_type === "aggregate") {
+      if (b.aggregate_name === "median") medians.set(name, ns);
+    } else if (!b.error_occurred) {
+      if (!runs.has(name)) runs.set(name, []);
+      runs.get(name).push(ns);
+    }
+  }
+  const times = new Map();
+  for (const [name, values] of runs) {
+    times.set(name, medians.has(name) ? medians.get(name) : values.reduce((a, b) => a + b, 0) / values.length);
+  }
+  return { times, context: report.context || {} };
+}
+
+function formatNs(ns) {
+  if (ns >= 1e6) return `${(ns / 1e6).toFixed(2)} ms`;
+  if (ns >= 1e3) return `${(ns / 1e3).toFixed(2)} us`;
+  return `${ns.toFixed(1)} ns`;
+}
+
+function main() {
+  const [baseFile, newFile, thresholdArg] = process.argv.slice(2);
+  if (!baseFile || !newFile) {
+    console.error("Usage: compare_bench.js base.json new.json [threshold_percent]");
+    process.exit(2);
+  }
+  const threshold = thresholdArg !== undefined ? parseFloat(thresholdArg) : 10;
+  const base = loadTimes(baseFile);
+  const next = loadTimes(newFile);
+
+  if (base.context.host_name !== next.context.host_name || base.context.num_cpus !== next.context.num_cpus) {
+    console.log(
+      `note: reports come from different machines (${base.context.host_name}, ${next.context.host_name})\n`
+    );
+  }
+
+  const width = Math.max(40, ...[...base.times.keys()].map((name) => name.length));
+  console.log(`${"benchmark".padEnd(width)} ${"base".padStart(11)} ${"new".padStart(11)} ${"change".padStart(9)}`);
+
+  const regressions = [];
+  for (const [name, baseNs] of base.times) {
+    if (!next.times.has(name)) {
+      console.log(`${name.padEnd(width)} ${formatNs(baseNs).padStart(11)} ${"-".padStart(11)} ${"removed".padStart(9)}`);
+      continue;
+    }
+    const newNs = next.times.get(name);
+    const change = ((newNs - baseNs) / baseNs) * 100;
+    const flag = change > threshold ? "  SLOWER" : change < -threshold ? "  faster" : "";
+    if (change > threshold) regressions.push(name);
+    console.log(
+      `${name.padEnd(width)} ${formatNs(baseNs).padStart(11)} ${formatNs(newNs).padStart(11)} ` +
+        `${`${change >= 0 ? "+" : ""}${change.toFixed(1)}%`.padStart(9)}${flag}`
+    );
+  }
+  for (const [name, newNs] of next.times) {
+    if (!base.times.has(name)) {
+      console.log(`${name.padEnd(width)} ${"-".padStart(11)} ${formatNs(newNs).padStart(11)} ${"new".padStart(9)}`);
+    }
+  }
+
+  console.log(`\n${regressions.length} of ${base.times.size} benchmarks slower by more than ${threshold}%`);
+  process.exit(regressions.length > 0 ? 1 : 0);
+}
+
+main();
@@ -0,0 +1,390 @@
+// Native hot paths under Google Benchmark, for comparison across commits
+//
+// Every benchmark takes a block size (samples per call, from a 128-frame
+// render quantum to a 4096-sample callback) and a stream count (independent
+// instances driven in turn, as with several captures or worker threads), and
+// reports samples/s and x_realtime, the seconds of audio handled per second:
+//
+//   NoiseGate, SpectralNoiseReduction, Denoiser    48 kHz, src/dsp/
+//   Int16ToFloat, Int32ToFloat, FloatToInt16       src/capture/sample_format
+//   Resampler                                      48000 and 44100 -> 16000
+//   SampleRing                                     write then read per block
+//   TsfnDelivery                                   push until the JS side has it
+//
+// LatencyHistogram (the getStats() histograms) has no block or streams: one
+// record() with a clock read per iteration, as the audio callback does.
+// TraceScope is one trace::Scope, the trace point on each audio callback,
+// with tracing off (arg 0) and recording (arg 1).
+//
+// TsfnDelivery runs a CaptureDelivery per stream (chunkMs 1) whose sink does
+// what the capture addons' DeliverChunk does with a thread-safe function: a
+// non-blocking call onto a queue of at most 4 chunks per stream, serviced by
+// one "JS thread" that copies each chunk into a new buffer (Buffer::Copy) and
+// frees it. An iteration pushes one block into every stream and waits until
+// the JS thread has seen it, so its time (and x_realtime) is the push-to-JS
+// latency, which the 1 ms drain cadence dominates. The JS thread therefore
+// also times each callback: queue_us / queue_p99_us from the non-blocking
+// call to the callback (the thread-safe function hop itself), and
+// deliver_us / deliver_p99_us from the push of the chunk's oldest sample, as
+// getStats() reports delivery. The emulation stands in for N-API, which a
+// standalone binary cannot load.
+//
+// Build: npm run bench:build (needs Google Benchmark, see README)
+// Run:   npm run bench:native -- --benchmark_out=base.json --benchmark_out_format=json
+//        npm run bench:compare -- base.json new.json [threshold_percent]
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "capture/capture_delivery.h"
+#include "capture/latency_histogram.h"
+#include "capture/sample_format.h"
+#include "dsp/noise_reduction.h"
+#include "dsp/resampler.h"
+#include "trace/trace.h"
+
+namespace {
+
+constexpr int kSampleRate = 48000;
+
+std::vector<float> MakeSpeechLikeSignal(size_t count, int sampleRate, uint32_t seed) {
+    std::vector<float> signal(count);
+    std::mt19937 rng(seed);
+    std::normal_distribution<float> noise(0.0f, 0.01f);
+    for (size_t i = 0; i < count; i++) {
+        const float t = static_cast<float>(i) / sampleRate;
+        const float f0 = 140.0f + 30.0f * std::sin(2.0f * static_cast<float>(M_PI) * 0.7f * t);
+        const float envelope = 0.5f + 0.5f * std::sin(2.0f * static_cast<float>(M_PI) * 4.0f * t);
+        float s = 0.0f;
+        for (int h = 1; h <= 6; h++) {
+            s += std::sin(2.0f * static_cast<float>(M_PI) * f0 * h * t) / h;
+        }
+        signal[i] = 0.2f * envelope * s + noise(rng);
+    }
+    return signal;
+}
+
+// One block of input per stream; processing in place overwrites a scratch
+// copy, so every iteration sees the same audio
+struct Streams {
+    size_t block;
+    int count;
+    std::vector<std::vector<float>> input;
+    std::vector<std::vector<float>> scratch;
+
+    Streams(const benchmark::State& state, int sampleRate)
+        : block(static_cast<size_t>(state.range(0))), count(static_cast<int>(state.range(1))) {
+        for (int s = 0; s < count; s++) {
+            input.push_back(MakeSpeechLikeSignal(block, sampleRate, 42 + s));
+            scratch.push_back(input.back());
+        }
+    }
+};
+
+void SetRates(benchmark::State& state, const Streams& streams, int sampleRate) {
+    const double samples = static_cast<double>(state.iterations()) * streams.block * streams.count;
+    state.SetItemsProcessed(static_cast<int64_t>(samples));
+    state.counters["x_realtime"] = benchmark::Counter(samples / sampleRate, benchmark::Counter::kIsRate);
+}
+
+void BlockAndStreamArgs(benchmark::internal::Benchmark* b) {
+    b->ArgsProduct({{128, 480, 1024, 4096}, {1, 4, 16}})->ArgNames({"block", "streams"});
+}
+
+void BM_NoiseGate(benchmark::State& state) {
+    Streams streams(state, kSampleRate);
+    std::vector<dsp::NoiseGate> gates(streams.count, dsp::NoiseGate(kSampleRate));
+    for (auto _ : state) {
+        for (int s = 0; s < streams.count; s++) {
+            std::copy(streams.input[s].begin(), streams.input[s].end(), streams.scratch[s].begin());
+            gates[s].process(streams.scratch[s].data(), static_cast<int>(streams.block));
+        }
+        benchmark::ClobberMemory();
+    }
+    SetRates(state, streams, kSampleRate);
+}
+BENCHMARK(BM_NoiseGate)->Apply(BlockAndStreamArgs);
+
+// In 10 ms frames, with blocks split at frame boundaries as Denoiser does
+void BM_SpectralNoiseReduction(benchmark::State& state) {
+    Streams streams(state, kSampleRate);
+    std::vector<dsp::SpectralNoiseReduction> reducers(streams.count, dsp::SpectralNoiseReduction(dsp::kDenoiseFrameSize));
+    std::vector<int> positions(streams.count, 0);
+    for (auto _ : state) {
+        for (int s = 0; s < streams.count; s++) {
+            std::copy(streams.input[s].begin(), streams.input[s].end(), streams.scratch[s].begin());
+            float* samples = streams.scratch[s].data();
+            size_t remaining = streams.block;
+            while (remaining > 0) {
+                const int n = static_cast<int>(
+                    std::min<size_t>(remaining, static_cast<size_t>(dsp::kDenoiseFrameSize - positions[s])));
+                reducers[s].process(samples, n, positions[s]);
+                positions[s] = (positions[s] + n) % dsp::kDenoiseFrameSize;
+                samples += n;
+                remaining -= static_cast<size_t>(n);
+            }
+        }
+        benchmark::ClobberMemory();
+    }
+    SetRates(state, streams, kSampleRate);
+}
+BENCHMARK(BM_SpectralNoiseReduction)->Apply(BlockAndStreamArgs);
+
+// Both stages, as the rnnoise addon runs them
+void BM_Denoiser(benchmark::State& state) {
+    Streams streams(state, kSampleRate);
+    std::vector<dsp::Denoiser> denoisers(streams.count, dsp::Denoiser(kSampleRate));
+    for (auto _ : state) {
+        for (int s = 0; s < streams.count; s++) {
+            std::copy(streams.input[s].begin(), streams.input[s].end(), streams.scratch[s].begin());
+            denoisers[s].process(streams.scratch[s].data(), streams.block);
+        }
+        benchmark::ClobberMemory();
+    }
+    SetRates(state, streams, kSampleRate);
+}
+BENCHMARK(BM_Denoiser)->Apply(BlockAndStreamArgs);
+
+void BM_Int16ToFloat(benchmark::State& state) {
+    Streams streams(state, kSampleRate);
+    std::vector<std::vector<int16_t>> pcm(streams.count, std::vector<int16_t>(streams.block));
+    for (int s = 0; s < streams.count; s++) {
+        capture::floatToInt16(streams.input[s].data(), pcm[s].data(), streams.block);
+    }
+    for (auto _ : state) {
+        for (int s = 0; s < streams.count; s++) {
+            capture::int16ToFloat(pcm[s].data(), streams.scratch[s].data(), streams.block);
+        }
+        benchmark::ClobberMemory();
+    }
+    SetRates(state, streams, kSampleRate);
+}
+BENCHMARK(BM_Int16ToFloat)->Apply(BlockAndStreamArgs);
+
+void BM_Int32ToFloat(benchmark::State& state) {
+    Streams streams(state, kSampleRate);
+    std::vector<std::vector<int32_t>> pcm(streams.count, std::vector<int32_t>(streams.block));
+    for (int s = 0; s < streams.count; s++) {
+        for (size_t i = 0; i < streams.block; i++) {
+            pcm[s][i] = static_cast<int32_t>(streams.input[s][i] * 2147483647.0);
+        }
+    }
+    for (auto _ : state) {
+        for (int s = 0; s < streams.count; s++) {
+            capture::int32ToFloat(pcm[s].data(), streams.scratch[s].data(), streams.block);
+        }
+        benchmark::ClobberMemory();
+    }
+    SetRates(state, streams, kSampleRate);
+}
+BENCHMARK(BM_Int32ToFloat)->Apply(BlockAndStreamArgs);
+
+void BM_FloatToInt16(benchmark::State& state) {
+    Streams streams(state, kSampleRate);
+    std::vector<std::vector<int16_t>> pcm(streams.count, std::vector<int16_t>(streams.block));
+    for (auto _ : state) {
+        for (int s = 0; s < streams.count; s++) {
+            capture::floatToInt16(streams.input[s].data(), pcm[s].data(), streams.block);
+        }
+        benchmark::ClobberMemory();
+    }
+    SetRates(state, streams, kSampleRate);
+}
+BENCHMARK(BM_FloatToInt16)->Apply(BlockAndStreamArgs);
+
+void BM_Resampler(benchmark::State& state) {
+    const int inputRate = static_cast<int>(state.range(2));
+    Streams streams(state, inputRate);
+    std::vector<dsp::Resampler> resamplers(streams.count, dsp::Resampler(inputRate, 16000));
+    std::vector<float> out;
+    out.reserve(resamplers[0].maxOutput(streams.block) + 64);
+    for (auto _ : state) {
+        for (int s = 0; s < streams.count; s++) {
+            out.clear();
+            resamplers[s].process(streams.input[s].data(), streams.block, &out);
+            benchmark::DoNotOptimize(out.data());
+        }
+        benchmark::ClobberMemory();
+    }
+    SetRates(state, streams, inputRate);
+}
+BENCHMARK(BM_Resampler)
+    ->ArgsProduct({{128, 480, 1024, 4096}, {1, 4, 16}, {48000, 44100}})
+    ->ArgNames({"block", "streams", "rate"});
+
+// One ring per stream with room for 2 s at 48 kHz, as a capture's
+void BM_SampleRing(benchmark::State& state) {
+    Streams streams(state, kSampleRate);
+    std::vector<std::unique_ptr<capture::SampleRing>> rings;
+    for (int s = 0; s < streams.count; s++) {
+        rings.push_back(std::make_unique<capture::SampleRing>(2 * kSampleRate));
+    }
+    for (auto _ : state) {
+        for (int s = 0; s < streams.count; s++) {
+            rings[s]->write(streams.input[s].data(), streams.block);
+        }
+        for (int s = 0; s < streams.count; s++) {
+            benchmark::DoNotOptimize(rings[s]->read(streams.scratch[s].data(), streams.block));
+        }
+        benchmark::ClobberMemory();
+    }
+    SetRates(state, streams, kSampleRate);
+}
+BENCHMARK(BM_SampleRing)->Apply(BlockAndStreamArgs);
+
+void BM_LatencyHistogram(benchmark::State& state) {
+    capture::LatencyHistogram histogram;
+    int64_t last = capture::steadyNowNs();
+    for (auto _ : state) {
+        const int64_t now = capture::steadyNowNs();
+        histogram.record(now - last);
+        last = now;
+    }
+    benchmark::DoNotOptimize(histogram.summary().count);
+}
+BENCHMARK(BM_LatencyHistogram);
+
+void BM_TraceScope(benchmark::State& state) {
+    if (state.range(0)) trace::start(); else trace::stop();
+    for (auto _ : state) {
+        trace::Scope span("bench", "n", 1);
+        benchmark::DoNotOptimize(span.active());
+    }
+    trace::stop();
+}
+BENCHMARK(BM_TraceScope)->ArgName("recording")->Arg(0)->Arg(1);
+
+// Stand-in for a thread-safe function and the JS thread behind it
+class JsThread {
+public:
+    explicit JsThread(size_t maxQueued) : maxQueued_(maxQueued), thread_(&JsThread::run, this) {}
+
+    ~JsThread() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closing_ = true;
+        }
+        wake_.notify_one();
+        thread_.join();
+        for (const Call& call : queue_) delete call.chunk;
+    }
+
+    // NonBlockingCall: false if the queue is full (napi_queue_full).
+    // capturedNs: when the chunk's oldest sample was pushed.
+    bool call(std::vector<float>& chunk, int64_t capturedNs) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (queue_.size() >= maxQueued_) {
+            refused_++;
+            return false;
+        }
+        queue_.push_back(Call{new std::vector<float>(std::move(chunk)), capturedNs, capture::steadyNowNs()});
+        lock.unlock();
+        wake_.notify_one();
+        return true;
+    }
+
+    uint64_t received() const { return received_.load(std::memory_order_acquire); }
+    uint64_t refused() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return refused_;
+    }
+    // From NonBlockingCall to the callback: the thread-safe function's own cost
+    const capture::LatencyHistogram& queued() const { return queued_; }
+    // From push() to the callback, as getStats() delivery reports it
+    const capture::LatencyHistogram& delivered() const { return delivered_; }
+
+private:
+    struct Call {
+        std::vector<float>* chunk;
+        int64_t capturedNs;
+        int64_t queuedNs;
+    };
+
+    size_t maxQueued_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::deque<Call> queue_;
+    bool closing_ = false;
+    uint64_t refused_ = 0;
+    std::atomic<uint64_t> received_{0};
+    capture::LatencyHistogram queued_;
+    capture::LatencyHistogram delivered_;
+    std::thread thread_;
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            wake_.wait(lock, [this] { return closing_ || !queue_.empty(); });
+            if (queue_.empty()) return;
+            const Call call = queue_.front();
+            std::vector<float>* chunk = call.chunk;
+            queue_.pop_front();
+            lock.unlock();
+            const int64_t calledNs = capture::steadyNowNs();
+            queued_.record(calledNs - call.queuedNs);
+            delivered_.record(calledNs - call.capturedNs);
+            std::unique_ptr<float[]> buffer(new float[chunk->size()]);   // Buffer::Copy
+            std::copy(chunk->begin(), chunk->end(), buffer.get());
+            benchmark::DoNotOptimize(buffer.get());
+            received_.fetch_add(chunk->size(), std::memory_order_release);
+            delete chunk;
+            lock.lock();
+        }
+    }
+};
+
+void BM_TsfnDelivery(benchmark::State& state) {
+    Streams streams(state, kSampleRate);
+    JsThread js(4 * static_cast<size_t>(streams.count));
+    capture::DeliveryConfig config;
+    config.sampleRate = kSampleRate;
+    config.chunkMs = 1;
+    std::vector<std::unique_ptr<capture::CaptureDelivery>> deliveries(streams.count);
+    for (int s = 0; s < streams.count; s++) {
+        deliveries[s] = std::make_unique<capture::CaptureDelivery>(
+            config, [&js, &deliveries, s](std::vector<float>& chunk) {
+                return js.call(chunk, deliveries[s]->chunkCapturedNs());
+            });
+    }
+    for (auto& delivery : deliveries) delivery->start();
+
+    uint64_t pushed = 0;
+    for (auto _ : state) {
+        for (int s = 0; s < streams.count; s++) {
+            deliveries[s]->push(streams.input[s].data(), streams.block);
+        }
+        pushed += streams.block * static_cast<uint64_t>(streams.count);
+        while (js.received() < pushed) std::this_thread::yield();
+    }
+
+    uint64_t dropped = 0;
+    for (auto& delivery : deliveries) {
+        delivery->stop();
+        dropped += delivery->stats().samplesDropped;
+    }
+    state.counters["refused"] = static_cast<double>(js.refused());
+    state.counters["dropped"] = static_cast<double>(dropped);
+    const capture::HistogramSummary queued = js.queued().summary();
+    const capture::HistogramSummary delivered = js.delivered().summary();
+    state.counters["queue_us"] = queued.meanUs;
+    state.counters["queue_p99_us"] = queued.p99Us;
+    state.counters["deliver_us"] = delivered.meanUs;
+    state.counters["deliver_p99_us"] = delivered.p99Us;
+    SetRates(state, streams, kSampleRate);
+}
+BENCHMARK(BM_TsfnDelivery)->Apply(BlockAndStreamArgs)->UseRealTime();
+
+} // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,409 @@
+// Upload overhead per segment: new connection per file vs keep-alive pool
+//
+// Runs net::HttpUploader against a local mock HTTP/1.1 server that answers
+// every POST with a small JSON body after latencyMs. A new connection pays
+// handshakeMs before its first response, standing in for the TCP + TLS
+// handshake to a remote API (two round trips); 0 leaves only the real
+// loopback connect cost. Reported per scenario: wall time for the batch,
+// mean and p95 request latency, connections opened and the share of
+// requests that went out on a pooled connection.
+//
+// A second run makes the server fail every third request with 503 to check
+// that retries recover every upload and that in-flight requests never
+// exceed maxConcurrent.
+//
+// Build: npm run bench:build    Run: ./build/Release/http_uploader_bench [requests] [handshake_ms]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cctype>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "net/http_uploader.h"
+#include "net/upload_scheduler.h"
+
+// Minimal keep-alive HTTP/1.1 server on 127.0.0.1, one thread per connection
+class MockServer {
+public:
+    int handshakeMs = 0;
+    int latencyMs = 5;
+    int failEvery = 0;          // answer every Nth request with 503
+    int capacity = 0;           // requests worked on at once, others wait (0: no limit)
+
+    std::atomic<int> connections{0};
+    std::atomic<int> requests{0};
+    std::atomic<int> inFlight{0};
+    std::atomic<int> maxInFlight{0};
+
+    bool start() {
+        listener_ = socket(AF_INET, SOCK_STREAM, 0);
+        if (listener_ < 0) return false;
+        int one = 1;
+        setsockopt(listener_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = 0;
+        if (bind(listener_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) return false;
+        if (listen(listener_, 64) != 0) return false;
+        socklen_t length = sizeof(addr);
+        getsockname(listener_, reinterpret_cast<sockaddr*>(&addr), &length);
+        port_ = ntohs(addr.sin_port);
+        acceptor_ = std::thread([this] { acceptLoop(); });
+        return true;
+    }
+
+    void stop() {
+        stopping_ = true;
+        shutdown(listener_, SHUT_RDWR);
+        ::close(listener_);
+        if (acceptor_.joinable()) acceptor_.join();
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this] { return open_ == 0; });
+    }
+
+    void resetCounters() {
+        connections = 0;
+        requests = 0;
+        maxInFlight = 0;
+    }
+
+    std::string url() const { return "http://127.0.0.1:" + std::to_string(port_) + "/v1/listen"; }
+
+private:
+    int listener_ = -1;
+    int port_ = 0;
+    std::atomic<bool> stopping_{false};
+    std::thread acceptor_;
+    std::mutex mutex_;
+    std::condition_variable done_;
+    std::condition_variable slots_;
+    int open_ = 0;
+    int busy_ = 0;
+
+    void acceptLoop() {
+        while (!stopping_) {
+            const int client = accept(listener_, nullptr, nullptr);
+            if (client < 0) continue;
+            int one = 1;
+            setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                open_++;
+            }
+            connections++;
+            std::thread([this, client] {
+                serve(client);
+                ::close(client);
+                std::lock_guard<std::mutex> lock(mutex_);
+                open_--;
+                done_.notify_all();
+            }).detach();
+        }
+    }
+
+    void serve(int client) {
+        std::string buffer;
+        bool first = true;
+        char chunk[65536];
+        for (;;) {
+            // Headers
+            size_t headerEnd;
+            while ((headerEnd = buffer.find("\r\n\r\n")) == std::string::npos) {
+                const ssize_t n = recv(client, chunk, sizeof(chunk), 0);
+                if (n <= 0) return;
+                buffer.append(chunk, static_cast<size_t>(n));
+            }
+            std::string headers = buffer.substr(0, headerEnd);
+            for (char& c : headers) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+            size_t contentLength = 0;
+            const size_t field = headers.find("content-length:");
+            if (field != std::string::npos) contentLength = std::strtoul(headers.c_str() + field + 15, nullptr, 10);
+            const bool close = headers.find("connection: close") != std::string::npos;
+
+            // Body
+            const size_t total = headerEnd + 4 + contentLength;
+            while (buffer.size() < total) {
+                const ssize_t n = recv(client, chunk, sizeof(chunk), 0);
+                if (n <= 0) return;
+                buffer.append(chunk, static_cast<size_t>(n));
+            }
+            buffer.erase(0, total);
+
+            const int current = ++inFlight;
+            int seen = maxInFlight;
+            while (current > seen && !maxInFlight.compare_exchange_weak(seen, current)) {
+            }
+            const int number = ++requests;
+            const int delay = latencyMs + (first ? handshakeMs : 0);
+            first = false;
+            if (capacity > 0) {
+                std::unique_lock<std::mutex> lock(mutex_);
+                slots_.wait(lock, [this] { return busy_ < capacity; });
+                busy_++;
+            }
+            if (delay > 0) std::this_thread::sleep_for(std::chrono::milliseconds(delay));
+            if (capacity > 0) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                busy_--;
+                slots_.notify_one();
+            }
+            inFlight--;
+
+            const bool fail = failEvery > 0 && number % failEvery == 0;
+            const std::string body = fail ? "{\"err_msg\":\"busy\"}"
+                                          : "{\"results\":{\"bytes\":" + std::to_string(contentLength) + "}}";
+            const std::string response = std::string(fail ? "HTTP/1.1 503 Service Unavailable\r\n" : "HTTP/1.1 200 OK\r\n") +
+                                         "Content-Type: application/json\r\nContent-Length: " +
+                                         std::to_string(body.size()) + "\r\n" +
+                                         (close ? "Connection: close\r\n" : "") + "\r\n" + body;
+            if (send(client, response.data(), response.size(), MSG_NOSIGNAL) < 0 || close) return;
+        }
+    }
+};
+
+struct Outcome {
+    double wallMs = 0.0;
+    double meanMs = 0.0;
+    double p95Ms = 0.0;
+    int ok = 0;
+    int attempts = 0;
+    net::UploaderStats stats;
+};
+
+static Outcome RunBatch(const net::UploaderConfig& config, const std::string& url,
+                        const std::vector<uint8_t>& body, int count) {
+    Outcome outcome;
+    std::mutex mutex;
+    std::condition_variable done;
+    std::vector<double> latencies;
+    int remaining = count;
+
+    const auto start = std::chrono::steady_clock::now();
+    {
+        net::HttpUploader uploader(config);
+        if (!uploader.isValid()) {
+            std::fprintf(stderr, "%s\n", uploader.error().c_str());
+            std::exit(1);
+        }
+        for (int i = 0; i < count; i++) {
+            net::UploadRequest request;
+            request.url = url;
+            request.headers = {"Authorization: Token bench", "Content-Type: audio/raw"};
+            request.body = body.data();
+            request.bodySize = body.size();
+            uploader.submit(std::move(request), [&](const net::UploadResult& result) {
+                std::lock_guard<std::mutex> lock(mutex);
+                latencies.push_back(result.timings.totalMs);
+                if (result.ok && result.status == 200) outcome.ok++;
+                outcome.attempts += result.attempts;
+                if (--remaining == 0) done.notify_all();
+            });
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [&] { return remaining == 0; });
+        outcome.stats = uploader.stats();
+    }
+    outcome.wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::sort(latencies.begin(), latencies.end());
+    double sum = 0.0;
+    for (double latency : latencies) sum += latency;
+    outcome.meanMs = sum / latencies.size();
+    outcome.p95Ms = latencies[std::min(latencies.size() - 1, latencies.size() * 95 / 100)];
+    return outcome;
+}
+
+// Live segments arriving every liveIntervalMs on top of a backlog submitted
+// at once, through a submit function that either goes straight to an
+// HttpUploader or through the scheduler
+struct MixedOutcome {
+    net::LatencySummary live;
+    int liveOk = 0;
+    int liveInSlo = 0;
+    int backfillOk = 0;
+    int shed = 0;
+    double wallMs = 0.0;
+};
+
+using SubmitFn = std::function<void(bool live, std::function<void(bool ok, bool shed, double totalMs)>)>;
+
+static MixedOutcome RunMixed(const SubmitFn& submit, int backlog, int liveCount, int liveIntervalMs, int sloMs) {
+    MixedOutcome outcome;
+    std::mutex mutex;
+    std::condition_variable done;
+    int remaining = backlog + liveCount;
+    net::LatencyWindow live(static_cast<size_t>(liveCount));
+
+    auto onDone = [&](bool isLive) {
+        return [&, isLive](bool ok, bool shed, double totalMs) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (shed) outcome.shed++;
+            if (isLive && ok) {
+                live.add(totalMs);
+                outcome.liveOk++;
+                if (totalMs <= sloMs) outcome.liveInSlo++;
+            }
+            if (!isLive && ok) outcome.backfillOk++;
+            if (--remaining == 0) done.notify_all();
+        };
+    };
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < backlog; i++) submit(false, onDone(false));
+    for (int i = 0; i < liveCount; i++) {
+        std::this_thread::sleep_until(start + std::chrono::milliseconds(i * liveIntervalMs));
+        submit(true, onDone(true));
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [&] { return remaining == 0; });
+    outcome.wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    outcome.live = live.summary();
+    return outcome;
+}
+
+int main(int argc, char** argv) {
+    const int count = argc > 1 ? std::max(1, std::atoi(argv[1])) : 100;
+    const int handshakeMs = argc > 2 ? std::max(0, std::atoi(argv[2])) : 60;
+
+    MockServer server;
+    if (!server.start()) {
+        std::perror("mock server");
+        return 1;
+    }
+
+    // 5 s of 16 kHz linear16, a typical segment
+    std::vector<uint8_t> body(5 * 16000 * 2);
+    for (size_t i = 0; i < body.size(); i++) body[i] = static_cast<uint8_t>(i * 131);
+
+    struct Scenario {
+        const char* name;
+        bool reuse;
+        int concurrent;
+    };
+    const Scenario scenarios[] = {
+        {"new conn, 1", false, 1},
+        {"keep-alive, 1", true, 1},
+        {"new conn, 4", false, 4},
+        {"keep-alive, 4", true, 4},
+    };
+
+    std::printf("%d uploads of %zu KB, server latency %d ms\n", count, body.size() / 1024, server.latencyMs);
+    for (int handshake : {0, handshakeMs}) {
+        server.handshakeMs = handshake;
+        std::printf("\nhandshake %d ms per new connection%s\n\n", handshake,
+                    handshake ? " (simulated TCP + TLS)" : " (loopback connect only)");
+        std::printf("%-14s %9s %9s %9s %6s %7s %6s\n", "scenario", "wall ms", "mean ms", "p95 ms", "conns",
+                    "reused", "ok");
+        for (const Scenario& scenario : scenarios) {
+            net::UploaderConfig config;
+            config.reuseConnections = scenario.reuse;
+            config.maxConcurrent = scenario.concurrent;
+            config.maxHostConnections = scenario.concurrent;
+            server.resetCounters();
+            const Outcome outcome = RunBatch(config, server.url(), body, count);
+            std::printf("%-14s %9.0f %9.1f %9.1f %6d %6.0f%% %3d/%-3d\n", scenario.name, outcome.wallMs,
+                        outcome.meanMs, outcome.p95Ms, server.connections.load(),
+                        100.0 * outcome.stats.reused / std::max(1, outcome.attempts), outcome.ok, count);
+        }
+    }
+
+    // Retries and the concurrency bound
+    server.handshakeMs = 0;
+    server.failEvery = 3;
+    server.resetCounters();
+    net::UploaderConfig config;
+    config.maxConcurrent = 3;
+    config.maxHostConnections = 4;
+    config.backoffBaseMs = 20;
+    config.backoffMaxMs = 200;
+    config.maxRetries = 6;
+    const Outcome outcome = RunBatch(config, server.url(), body, count);
+    std::printf("\nretries (every 3rd response is 503, maxConcurrent %d)\n\n", config.maxConcurrent);
+    std::printf("ok %d/%d, attempts %d, retries %llu, max in flight at server %d, wall %.0f ms\n", outcome.ok,
+                count, outcome.attempts, static_cast<unsigned long long>(outcome.stats.retries),
+                server.maxInFlight.load(), outcome.wallMs);
+
+    // A slow uplink: the server works on 2 requests at a time, 200 ms each
+    // (10/s), while a backlog of 20 and a live segment every 150 ms arrive
+    server.failEvery = 0;
+    server.capacity = 2;
+    server.latencyMs = 200;
+    const int backlog = 20;
+    const int liveCount = 30;
+    const int liveIntervalMs = 150;
+    const int sloMs = 1500;
+    std::printf("\nslow uplink (server capacity %d x %d ms), backlog %d + %d live every %d ms, live SLO %d ms\n\n",
+                server.capacity, server.latencyMs, backlog, liveCount, liveIntervalMs, sloMs);
+    std::printf("%-16s %9s %9s %9s %8s %9s %5s %10s\n", "policy", "live p50", "live p95", "live max", "in SLO",
+                "backfill", "shed", "server max");
+
+    auto request = [&] {
+        net::UploadRequest r;
+        r.url = server.url();
+        r.body = body.data();
+        r.bodySize = body.size();
+        return r;
+    };
+    auto report = [&](const char* name, const MixedOutcome& mixed) {
+        std::printf("%-16s %9.0f %9.0f %9.0f %3d/%-4d %5d/%-3d %5d %10d\n", name, mixed.live.p50, mixed.live.p95,
+                    mixed.live.max, mixed.liveInSlo, liveCount, mixed.backfillOk, backlog, mixed.shed,
+                    server.maxInFlight.load());
+    };
+
+    {
+        // Every segment posted as soon as it exists, as the exec -> transcribe chains do
+        server.resetCounters();
+        net::UploaderConfig unbounded;
+        unbounded.maxConcurrent = 64;
+        unbounded.maxHostConnections = 64;
+        net::HttpUploader uploader(unbounded);
+        const MixedOutcome mixed = RunMixed(
+            [&](bool, std::function<void(bool, bool, double)> done) {
+                uploader.submit(request(), [done](const net::UploadResult& result) {
+                    done(result.ok && result.status == 200, false, result.timings.totalMs);
+                });
+            },
+            backlog, liveCount, liveIntervalMs, sloMs);
+        report("fire-and-forget", mixed);
+    }
+    {
+        server.resetCounters();
+        net::SchedulerConfig schedulerConfig;
+        schedulerConfig.maxInFlight = 2;
+        schedulerConfig.liveSloMs = sloMs;
+        schedulerConfig.maxQueued = 16;
+        net::UploadScheduler scheduler(schedulerConfig);
+        const MixedOutcome mixed = RunMixed(
+            [&](bool live, std::function<void(bool, bool, double)> done) {
+                scheduler.submit(request(), live ? net::UploadPriority::Live : net::UploadPriority::Backfill,
+                                 [done](const net::ScheduledResult& result) {
+                                     done(result.upload.ok && result.upload.status == 200, result.shed,
+                                          result.totalMs);
+                                 });
+            },
+            backlog, liveCount, liveIntervalMs, sloMs);
+        report("scheduler", mixed);
+        const net::SchedulerStats stats = scheduler.stats();
+        std::printf("\nscheduler: live queue wait p95 %.0f ms, backfill queue wait p95 %.0f ms, %llu deferred\n",
+                    stats.queueWait[0].p95, stats.queueWait[1].p95, static_cast<unsigned long long>(stats.deferred));
+    }
+
+    server.stop();
+    return outcome.ok == count && server.maxInFlight <= config.maxConcurrent ? 0 : 1;
+}
@@ -0,0 +1,198 @@
+// Language identification cost
+//
+// Runs asr::LanguageIdentifier over a 16 kHz mono s16le WAV file (or
+// synthetic speech-like audio) and reports mel and classifier time per
+// second of audio, the share of one core that is, and the per-segment
+// decisions. Without a model a container with random weights and the
+// default shape (80 mels, TDNN 128-128-128-256 with +-2, +-2/2, +-3/3, 0
+// context, 128-wide embedding, 32 languages) is written to a temporary file:
+// the timing is representative, the decisions are not.
+//
+// Build: npm run bench:build
+// Run:   ./build/Release/lid_bench [model.tnsr|-] [audio.wav] [segmentMs]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "asr/language_id.h"
+#include "storage/tensor_file.h"
+
+static std::vector<float> MakeSpeechLikeSignal(int sampleRate, int seconds) {
+    std::vector<float> signal(static_cast<size_t>(sampleRate) * seconds);
+    std::mt19937 rng(42);
+    std::normal_distribution<float> noise(0.0f, 0.01f);
+    for (size_t i = 0; i < signal.size(); i++) {
+        const float t = static_cast<float>(i) / sampleRate;
+        const float f0 = 140.0f + 30.0f * std::sin(2.0f * static_cast<float>(M_PI) * 0.7f * t);
+        const float envelope = 0.5f + 0.5f * std::sin(2.0f * static_cast<float>(M_PI) * 4.0f * t);
+        float s = 0.0f;
+        for (int h = 1; h <= 6; h++) {
+            s += std::sin(2.0f * static_cast<float>(M_PI) * f0 * h * t) / h;
+        }
+        signal[i] = 0.2f * envelope * s + noise(rng);
+    }
+    return signal;
+}
+
+// Minimal RIFF reader: 16-bit PCM, mono, 16 kHz only
+static bool ReadWav(const char* path, std::vector<float>* out) {
+    FILE* file = std::fopen(path, "rb");
+    if (!file) return false;
+    std::vector<uint8_t> bytes;
+    uint8_t buffer[65536];
+    size_t n;
+    while ((n = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        bytes.insert(bytes.end(), buffer, buffer + n);
+    }
+    std::fclose(file);
+
+    if (bytes.size() < 12 || std::memcmp(bytes.data(), "RIFF", 4) != 0 ||
+        std::memcmp(bytes.data() + 8, "WAVE", 4) != 0) {
+        return false;
+    }
+    bool formatOk = false;
+    for (size_t pos = 12; pos + 8 <= bytes.size();) {
+        uint32_t size;
+        std::memcpy(&size, bytes.data() + pos + 4, 4);
+        const uint8_t* body = bytes.data() + pos + 8;
+        if (std::memcmp(bytes.data() + pos, "fmt ", 4) == 0 && size >= 16) {
+            uint16_t format, channels, bits;
+            uint32_t rate;
+            std::memcpy(&format, body, 2);
+            std::memcpy(&channels, body + 2, 2);
+            std::memcpy(&rate, body + 4, 4);
+            std::memcpy(&bits, body + 14, 2);
+            formatOk = format == 1 && channels == 1 && rate == 16000 && bits == 16;
+        } else if (std::memcmp(bytes.data() + pos, "data", 4) == 0 && formatOk) {
+            const size_t samples = std::min<size_t>(size, bytes.size() - pos - 8) / 2;
+            out->resize(samples);
+            for (size_t i = 0; i < samples; i++) {
+                int16_t s;
+                std::memcpy(&s, body + i * 2, 2);
+                (*out)[i] = s / 32768.0f;
+            }
+            return true;
+        }
+        pos += 8 + size + (size & 1);
+    }
+    return false;
+}
+
+static bool AddRandom(storage::TensorFileWriter* writer, const std::string& name,
+                      const std::vector<int64_t>& shape, std::mt19937* rng, std::string* error) {
+    size_t count = 1;
+    for (int64_t d : shape) count *= static_cast<size_t>(d);
+    const float scale = shape.size() > 1 ? 1.0f / std::sqrt(static_cast<float>(shape[1])) : 0.01f;
+    std::normal_distribution<float> normal(0.0f, scale);
+    std::vector<float> values(count);
+    for (float& v : values) v = normal(*rng);
+    return writer->add(name, storage::TensorType::F32, shape, values.data(), count * sizeof(float), error);
+}
+
+static bool WriteRandomModel(const std::string& path, std::string* error) {
+    const int64_t mels = 80;
+    const int64_t languages = 32;
+    const int64_t widths[] = {128, 128, 128, 256};
+    const std::vector<int32_t> contexts[] = {{-2, -1, 0, 1, 2}, {-2, 0, 2}, {-3, 0, 3}, {0}};
+
+    storage::TensorFileWriter writer;
+    if (!writer.open(path, "lid", error)) return false;
+    std::mt19937 rng(7);
+    int64_t in = mels;
+    for (int i = 0; i < 4; i++) {
+        const std::string prefix = "tdnn" + std::to_string(i + 1);
+        const int64_t taps = static_cast<int64_t>(contexts[i].size());
+        if (!AddRandom(&writer, prefix + ".weight", {widths[i], in * taps}, &rng, error) ||
+            !AddRandom(&writer, prefix + ".bias", {widths[i]}, &rng, error) ||
+            !writer.add(prefix + ".context", storage::TensorType::Int32, {taps}, contexts[i].data(),
+                        contexts[i].size() * sizeof(int32_t), error)) {
+            return false;
+        }
+        in = widths[i];
+    }
+    std::string codes;
+    const char* names[] = {"en", "de", "es", "fr", "it", "pt", "nl", "sv", "da", "no", "fi",
+                           "pl", "cs", "ru", "uk", "tr", "ar", "hi", "bn", "ta", "te", "mr",
+                           "ja", "ko", "zh", "vi", "id", "ms", "th", "el", "he", "ro"};
+    for (const char* name : names) codes += std::string(name) + "\n";
+    return AddRandom(&writer, "embed.weight", {128, 2 * in}, &rng, error) &&
+           AddRandom(&writer, "embed.bias", {128}, &rng, error) &&
+           AddRandom(&writer, "output.weight", {languages, 128}, &rng, error) &&
+           AddRandom(&writer, "output.bias", {languages}, &rng, error) &&
+           writer.add("meta.languages", storage::TensorType::Bytes, {static_cast<int64_t>(codes.size())},
+                      codes.data(), codes.size(), error) &&
+           writer.commit(error);
+}
+
+int main(int argc, char** argv) {
+    std::string modelPath = argc > 1 ? argv[1] : "-";
+    const char* wavPath = argc > 2 ? argv[2] : nullptr;
+    asr::LanguageIdOptions options;
+    if (argc > 3) options.segmentMs = std::atoi(argv[3]);
+
+    std::string error;
+    bool random = modelPath == "-";
+    if (random) {
+        modelPath = "/tmp/lid_bench_random.tnsr";
+        if (!WriteRandomModel(modelPath, &error)) {
+            std::fprintf(stderr, "cannot write random model: %s\n", error.c_str());
+            return 1;
+        }
+    }
+
+    asr::LanguageIdentifier lid;
+    if (!lid.load(modelPath, &error)) {
+        std::fprintf(stderr, "load failed: %s\n", error.c_str());
+        return 1;
+    }
+    std::printf("model: %zu languages, %d mels, %zu parameters, %d frames of context%s\n",
+                lid.languages().size(), lid.mels(), lid.parameterCount(), lid.contextFrames(),
+                random ? " (random weights)" : "");
+
+    std::vector<float> audio;
+    if (wavPath && std::strcmp(wavPath, "-") != 0) {
+        if (!ReadWav(wavPath, &audio)) {
+            std::fprintf(stderr, "cannot read %s (need 16 kHz mono 16-bit PCM WAV)\n", wavPath);
+            return 1;
+        }
+    } else {
+        audio = MakeSpeechLikeSignal(16000, 30);
+    }
+    const double seconds = audio.size() / 16000.0;
+
+    const int runs = 5;
+    double melMs = 0.0;
+    double classifyMs = 0.0;
+    asr::LanguageIdResult result;
+    for (int run = 0; run <= runs; run++) {
+        if (!lid.identify(audio.data(), audio.size(), options, &result, &error)) {
+            std::fprintf(stderr, "identify failed: %s\n", error.c_str());
+            return 1;
+        }
+        if (run == 0) continue;  // warm-up
+        melMs += result.melMs;
+        classifyMs += result.classifyMs;
+    }
+    melMs /= runs;
+    classifyMs /= runs;
+
+    for (const asr::LanguageSegment& segment : result.segments) {
+        std::printf("  %6.2f-%6.2f s  %-4s %.2f  (%d ms speech)\n", segment.startMs / 1000.0,
+                    segment.endMs / 1000.0, segment.language.empty() ? "-" : segment.language.c_str(),
+                    segment.confidence, segment.speechMs);
+    }
+    std::printf("overall: %s %.2f\n", result.language.empty() ? "-" : result.language.c_str(),
+                result.confidence);
+    std::printf("%.1f s of audio: mel %.2f ms/s, classifier %.2f ms/s, %.2f%% of one core\n", seconds,
+                melMs / seconds, classifyMs / seconds, (melMs + classifyMs) / (seconds * 10.0));
+
+    if (random) std::remove(modelPath.c_str());
+    return 0;
+}
@@ -0,0 +1,144 @@
+// Log-mel frontend cost per stream
+//
+// Streams synthetic 16 kHz audio through asr::MelFrontend in 20 ms blocks
+// (the capture delivery size) and reports CPU time per second of audio and
+// the share of one core per stream, for 80 and 128 mel bins. A dense DFT
+// implementation of the same features is timed on a few seconds for
+// comparison, and its output is used to check accuracy.
+//
+// Build: npm run bench:build    Run: ./build/Release/mel_frontend_bench [seconds]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "asr/mel_frontend.h"
+
+static std::vector<float> MakeSpeechLikeSignal(int sampleRate, int seconds) {
+    std::vector<float> signal(static_cast<size_t>(sampleRate) * seconds);
+    std::mt19937 rng(42);
+    std::normal_distribution<float> noise(0.0f, 0.01f);
+    for (size_t i = 0; i < signal.size(); i++) {
+        const float t = static_cast<float>(i) / sampleRate;
+        const float f0 = 140.0f + 30.0f * std::sin(2.0f * static_cast<float>(M_PI) * 0.7f * t);
+        const float envelope = 0.5f + 0.5f * std::sin(2.0f * static_cast<float>(M_PI) * 4.0f * t);
+        float s = 0.0f;
+        for (int h = 1; h <= 6; h++) {
+            s += std::sin(2.0f * static_cast<float>(M_PI) * f0 * h * t) / h;
+        }
+        signal[i] = 0.2f * envelope * s + noise(rng);
+    }
+    return signal;
+}
+
+// Straightforward O(N^2) DFT + dense filterbank, the previous implementation
+static void DenseFrames(const std::vector<float>& dense, int mels, const float* x, size_t n,
+                        size_t frames, std::vector<float>* out) {
+    const int fft = 400;
+    const int bins = fft / 2 + 1;
+    std::vector<float> cosTable(static_cast<size_t>(bins) * fft);
+    std::vector<float> sinTable(cosTable.size());
+    std::vector<float> window(fft);
+    for (int i = 0; i < fft; i++) {
+        window[i] = 0.5f * (1.0f - std::cos(2.0f * static_cast<float>(M_PI) * i / fft));
+    }
+    for (int k = 0; k < bins; k++) {
+        for (int i = 0; i < fft; i++) {
+            const double angle = 2.0 * M_PI * ((static_cast<long>(k) * i) % fft) / fft;
+            cosTable[static_cast<size_t>(k) * fft + i] = static_cast<float>(std::cos(angle));
+            sinTable[static_cast<size_t>(k) * fft + i] = static_cast<float>(std::sin(angle));
+        }
+    }
+
+    out->assign(frames * mels, 0.0f);
+    std::vector<float> frame(fft);
+    std::vector<float> power(bins);
+    for (size_t t = 0; t < frames; t++) {
+        for (int i = 0; i < fft; i++) {
+            long index = static_cast<long>(t) * 160 - fft / 2 + i;
+            if (index < 0) index = -index;
+            if (index >= static_cast<long>(n)) index = 2 * (static_cast<long>(n) - 1) - index;
+            frame[i] = x[index] * window[i];
+        }
+        for (int k = 0; k < bins; k++) {
+            float re = 0.0f;
+            float im = 0.0f;
+            for (int i = 0; i < fft; i++) {
+                re += frame[i] * cosTable[static_cast<size_t>(k) * fft + i];
+                im -= frame[i] * sinTable[static_cast<size_t>(k) * fft + i];
+            }
+            power[k] = re * re + im * im;
+        }
+        for (int m = 0; m < mels; m++) {
+            float sum = 0.0f;
+            for (int k = 0; k < bins; k++) sum += dense[static_cast<size_t>(m) * bins + k] * power[k];
+            (*out)[t * mels + m] = std::log10(std::max(sum, 1e-10f));
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    const int sampleRate = 16000;
+    const int seconds = argc > 1 ? std::max(1, std::atoi(argv[1])) : 60;
+    const size_t blockSize = 320;  // 20 ms
+    const int denseSeconds = std::min(seconds, 5);
+
+    const std::vector<float> signal = MakeSpeechLikeSignal(sampleRate, seconds);
+
+    std::printf("Log-mel frontend, %d s of 16 kHz mono streamed in %zu-sample blocks\n\n",
+                seconds, blockSize);
+    std::printf("%6s %10s %12s %10s %12s %12s %12s\n", "mels", "weights", "us/audio_s", "core_%",
+                "dense_us/s", "speedup", "max_err");
+
+    for (int mels : {80, 128}) {
+        asr::MelConfig config;
+        config.mels = mels;
+        const asr::MelFilterbank filterbank = asr::MelFilterbank::slaney(sampleRate, config.fftSize, mels);
+        auto kernel = std::make_shared<asr::MelKernel>(config, filterbank);
+        asr::MelFrontend frontend(kernel);
+
+        std::vector<float> frames;
+        frames.reserve(static_cast<size_t>(seconds) * 100 * mels + mels);
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t pos = 0; pos < signal.size(); pos += blockSize) {
+            frontend.push(signal.data() + pos, std::min(blockSize, signal.size() - pos), &frames);
+        }
+        frontend.flush(&frames);
+        const double streamUs = std::chrono::duration<double, std::micro>(
+            std::chrono::steady_clock::now() - start).count();
+        const double usPerSecond = streamUs / seconds;
+
+        // Dense reference on a prefix: same framing, no right-edge effects
+        const int bins = config.fftSize / 2 + 1;
+        std::vector<float> dense(static_cast<size_t>(mels) * bins, 0.0f);
+        std::vector<float> unit(bins, 0.0f);
+        std::vector<float> column(mels);
+        for (int k = 0; k < bins; k++) {
+            unit[k] = 1.0f;
+            filterbank.apply(unit.data(), column.data());
+            for (int m = 0; m < mels; m++) dense[static_cast<size_t>(m) * bins + k] = column[m];
+            unit[k] = 0.0f;
+        }
+        const size_t denseFrames = static_cast<size_t>(denseSeconds) * 100 - 2;
+        std::vector<float> reference;
+        const auto denseStart = std::chrono::steady_clock::now();
+        DenseFrames(dense, mels, signal.data(), signal.size(), denseFrames, &reference);
+        const double denseUs = std::chrono::duration<double, std::micro>(
+            std::chrono::steady_clock::now() - denseStart).count() / denseSeconds;
+
+        float maxError = 0.0f;
+        for (size_t i = 0; i < reference.size(); i++) {
+            maxError = std::max(maxError, std::fabs(reference[i] - frames[i]));
+        }
+
+        std::printf("%6d %10zu %12.1f %10.3f %12.1f %11.1fx %12.2e\n", mels, filterbank.nonZeros(),
+                    usPerSecond, usPerSecond / 1e4, denseUs, denseUs / usPerSecond, maxError);
+    }
+    std::printf("\ncore_%% is the share of one core per stream; max_err is in log10 units\n");
+    return 0;
+}
@@ -0,0 +1,95 @@
+// Opus encoder cost per stream
+//
+// Encodes synthetic speech-like audio at 16 kHz mono through
+// codec::OggOpusEncoder for a grid of bitrates and frame sizes and reports
+// CPU time per second of audio, share of one core per stream and the
+// resulting bitrate compared with the 256 kbps linear16 stream sent today.
+//
+// Build: npm run bench:build    Run: ./build/Release/opus_encoder_bench [seconds]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "codec/ogg_opus_encoder.h"
+
+static std::vector<float> MakeSpeechLikeSignal(int sampleRate, int seconds) {
+    std::vector<float> signal(static_cast<size_t>(sampleRate) * seconds);
+    std::mt19937 rng(42);
+    std::normal_distribution<float> noise(0.0f, 0.01f);
+    for (size_t i = 0; i < signal.size(); i++) {
+        const float t = static_cast<float>(i) / sampleRate;
+        // Gliding fundamental with a few harmonics, 4 Hz syllable envelope
+        const float f0 = 140.0f + 30.0f * std::sin(2.0f * static_cast<float>(M_PI) * 0.7f * t);
+        const float envelope = 0.5f + 0.5f * std::sin(2.0f * static_cast<float>(M_PI) * 4.0f * t);
+        float s = 0.0f;
+        for (int h = 1; h <= 6; h++) {
+            s += std::sin(2.0f * static_cast<float>(M_PI) * f0 * h * t) / h;
+        }
+        signal[i] = 0.2f * envelope * s + noise(rng);
+    }
+    return signal;
+}
+
+int main(int argc, char** argv) {
+    const int sampleRate = 16000;
+    const int seconds = argc > 1 ? std::max(1, std::atoi(argv[1])) : 60;
+    const size_t blockSize = 320;  // 20 ms, matches the ScreenCaptureKit delivery size
+    const double pcmBitrate = sampleRate * 16.0;
+
+    const std::vector<float> signal = MakeSpeechLikeSignal(sampleRate, seconds);
+
+    const int bitrates[] = {12000, 16000, 24000, 32000};
+    const float frameDurations[] = {10.0f, 20.0f, 60.0f};
+    const int complexities[] = {0, 5, 10};
+
+    std::printf("Opus encode cost, %d s of 16 kHz mono per run, %zu-sample input blocks\n\n",
+                seconds, blockSize);
+    std::printf("%8s %8s %6s %12s %10s %10s %10s\n",
+                "bitrate", "frame_ms", "cplx", "us/audio_s", "core_%", "out_kbps", "vs_pcm");
+
+    for (int complexity : complexities) {
+        for (float frameMs : frameDurations) {
+            for (int bitrate : bitrates) {
+                codec::OggOpusConfig config;
+                config.sampleRate = sampleRate;
+                config.bitrate = bitrate;
+                config.frameDurationMs = frameMs;
+                config.complexity = complexity;
+
+                codec::OggOpusEncoder encoder(config);
+                if (!encoder.isValid()) {
+                    std::fprintf(stderr, "invalid config: %s\n", encoder.error().c_str());
+                    return 1;
+                }
+
+                std::vector<uint8_t> out;
+                out.reserve(static_cast<size_t>(bitrate / 8) * seconds * 2);
+
+                const auto start = std::chrono::steady_clock::now();
+                for (size_t offset = 0; offset < signal.size(); offset += blockSize) {
+                    const size_t n = std::min(blockSize, signal.size() - offset);
+                    encoder.encode(signal.data() + offset, n, out);
+                }
+                encoder.finish(out);
+                const auto end = std::chrono::steady_clock::now();
+
+                const double elapsedUs =
+                    std::chrono::duration<double, std::micro>(end - start).count();
+                const double usPerAudioSecond = elapsedUs / seconds;
+                const double outKbps = out.size() * 8.0 / seconds / 1000.0;
+
+                std::printf("%8d %8.1f %6d %12.1f %10.3f %10.1f %9.1fx\n",
+                            bitrate, frameMs, complexity, usPerAudioSecond,
+                            usPerAudioSecond / 1e4, outKbps,
+                            pcmBitrate / (outKbps * 1000.0));
+            }
+        }
+    }
+
+    return 0;
+}
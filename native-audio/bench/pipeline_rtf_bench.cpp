@@ -0,0 +1,615 @@
+// End-to-end real-time factor of the native capture pipeline over a WAV corpus
+//
+// Replays recordings through the whole native path, one 10 ms packet at a
+// time per stream:
+//
+//   replay   int16 packets at the recording's rate, as a WASAPI int16 device
+//            delivers them (the capture backend)
+//   convert  int16 -> float (capture/sample_format) into the capture's
+//            SampleRing, read back out as the delivery thread does
+//   denoise  dsp::Denoiser (spectral noise reduction + gate) at that rate
+//   resample to 16 kHz, then float -> int16
+//   segment  vad::Segmenter (voice detector + utterance cuts)
+//   encode   each finished segment to Opus (when built with libopus) or FLAC
+//
+// Streams are spread over the worker threads (one per core by default); each
+// worker takes its streams in turn, one packet each, as fast as it can, so
+// many streams share a core the way they would on a server. For each stream
+// count it reports:
+//
+//   rtf          wall time / audio duration of one stream; below 1 the
+//                machine keeps up with that many live streams
+//   capacity     streams / rtf: live streams this machine could carry
+//   p50/p99/max  processing time per 10 ms packet, all stages
+//   peak RSS     high-water mark of resident memory during the run (reset
+//                per run on Linux; since process start elsewhere)
+//   allocs       operator new calls per second and per packet
+//
+// Build: npm run bench:build
+// Run:   npm run bench:pipeline -- [corpus_dir|file.wav ...] [--streams 1,8,64,256]
+//        [--seconds 30] [--threads N] [--codec opus|flac] [--vad model.tnsr] [--json]
+// Without a corpus it replays 30 s of synthetic speech with pauses at 48 kHz.
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include "capture/capture_delivery.h"
+#include "capture/sample_format.h"
+#include "dsp/noise_reduction.h"
+#include "dsp/resampler.h"
+#include "dsp/wav_file.h"
+#include "storage/flac_encoder.h"
+#include "vad/segmenter.h"
+#if defined(HAVE_OPUS)
+#include "codec/ogg_opus_encoder.h"
+#endif
+
+namespace fs = std::filesystem;
+
+// Every operator new in the process is counted (aligned forms excepted)
+static std::atomic<uint64_t> g_allocations{0};
+
+static void* countedAlloc(size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size) { return countedAlloc(size); }
+void* operator new[](size_t size) { return countedAlloc(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1);
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1);
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+
+namespace {
+
+constexpr int kPipelineRate = 16000;   // VAD, segments and encoding
+
+struct Options {
+    std::vector<std::string> inputs;
+    std::vector<int> streams = {1, 8, 64, 256};
+    double seconds = 30.0;
+    int threads = 0;
+    std::string codec;
+    std::string vadModel;
+    bool json = false;
+};
+
+struct Recording {
+    std::string name;
+    int sampleRate = 0;
+    std::vector<int16_t> pcm;   // mono
+};
+
+struct LevelReport {
+    int streams = 0;
+    int threads = 0;
+    double audioSeconds = 0.0;   // per stream
+    double wallSeconds = 0.0;
+    double cpuSeconds = 0.0;
+    uint64_t packets = 0;
+    double p50Us = 0.0;
+    double p99Us = 0.0;
+    double maxUs = 0.0;
+    uint64_t allocations = 0;
+    uint64_t peakRssBytes = 0;
+    bool rssReset = false;
+    uint64_t segments = 0;
+    uint64_t encodedBytes = 0;
+
+    double rtf() const { return audioSeconds > 0.0 ? wallSeconds / audioSeconds : 0.0; }
+    double capacity() const { return rtf() > 0.0 ? streams / rtf() : 0.0; }
+};
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+double processCpuSeconds() {
+#if defined(_WIN32)
+    FILETIME creation, exit, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) return 0.0;
+    auto toSeconds = [](const FILETIME& t) {
+        return ((static_cast<uint64_t>(t.dwHighDateTime) << 32) | t.dwLowDateTime) / 1e7;
+    };
+    return toSeconds(kernel) + toSeconds(user);
+#else
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0.0;
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 + usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+#endif
+}
+
+// Restarts the peak RSS measurement where the OS allows it (Linux 4.0+)
+bool resetPeakRss() {
+#if defined(__linux__)
+    std::ofstream clear("/proc/self/clear_refs");
+    clear << "5";
+    return static_cast<bool>(clear.flush());
+#else
+    return false;
+#endif
+}
+
+uint64_t peakRssBytes() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+    return counters.PeakWorkingSetSize;
+#elif defined(__linux__)
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) return std::strtoull(line.c_str() + 6, nullptr, 10) * 1024;
+    }
+    return 0;
+#else
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+    return static_cast<uint64_t>(usage.ru_maxrss);   // bytes on macOS
+#endif
+}
+
+bool parseStreams(const char* list, std::vector<int>* streams) {
+    streams->clear();
+    for (const char* p = list; *p;) {
+        char* end = nullptr;
+        const long n = std::strtol(p, &end, 10);
+        if (end == p || n <= 0) return false;
+        streams->push_back(static_cast<int>(n));
+        p = *end == ',' ? end + 1 : end;
+        if (*end != ',' && *end != '\0') return false;
+    }
+    return !streams->empty();
+}
+
+bool parseArgs(int argc, char** argv, Options* options) {
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const char* v = nullptr;
+        auto value = [&](const char** out) {
+            if (i + 1 >= argc) return false;
+            *out = argv[++i];
+            return true;
+        };
+        if (arg == "--streams") {
+            if (!value(&v) || !parseStreams(v, &options->streams)) return false;
+        } else if (arg == "--seconds") {
+            if (!value(&v)) return false;
+            options->seconds = std::atof(v);
+        } else if (arg == "--threads") {
+            if (!value(&v)) return false;
+            options->threads = std::atoi(v);
+        } else if (arg == "--codec") {
+            if (!value(&v)) return false;
+            options->codec = v;
+        } else if (arg == "--vad") {
+            if (!value(&v)) return false;
+            options->vadModel = v;
+        } else if (arg == "--json") {
+            options->json = true;
+        } else if (arg.size() > 1 && arg[0] == '-') {
+            return false;
+        } else {
+            options->inputs.push_back(arg);
+        }
+    }
+    return options->seconds > 0.0;
+}
+
+bool isWav(const fs::path& path) {
+    std::string ext = path.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
+    return ext == ".wav";
+}
+
+bool loadRecording(const fs::path& path, std::vector<Recording>* recordings) {
+    dsp::WavAudio audio;
+    std::string error;
+    if (!dsp::readWav(path.string(), &audio, &error)) {
+        std::fprintf(stderr, "%s: %s\n", path.string().c_str(), error.c_str());
+        return false;
+    }
+    dsp::downmixToMono(&audio);
+    if (audio.samples.size() < static_cast<size_t>(audio.sampleRate) / 100) return true;   // under 10 ms
+    Recording recording;
+    recording.name = path.filename().string();
+    recording.sampleRate = audio.sampleRate;
+    recording.pcm.resize(audio.samples.size());
+    capture::floatToInt16(audio.samples.data(), recording.pcm.data(), audio.samples.size());
+    recordings->push_back(std::move(recording));
+    return true;
+}
+
+bool loadCorpus(const std::vector<std::string>& inputs, std::vector<Recording>* recordings) {
+    for (const std::string& input : inputs) {
+        std::error_code ec;
+        const fs::path root(input);
+        if (fs::is_directory(root, ec)) {
+            std::vector<fs::path> paths;
+            for (auto it = fs::recursive_directory_iterator(root, fs::directory_options::skip_permission_denied, ec);
+                 !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+                if (it->is_regular_file(ec) && isWav(it->path())) paths.push_back(it->path());
+            }
+            std::sort(paths.begin(), paths.end());
+            for (const fs::path& path : paths) {
+                if (!loadRecording(path, recordings)) return false;
+            }
+        } else if (fs::is_regular_file(root, ec)) {
+            if (!loadRecording(root, recordings)) return false;
+        } else {
+            std::fprintf(stderr, "not found: %s\n", input.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+// Harmonic "speech" in 0.5-3 s bursts with 0.3-1.5 s pauses over low noise
+Recording syntheticRecording(int sampleRate, double seconds) {
+    Recording recording;
+    recording.name = "synthetic";
+    recording.sampleRate = sampleRate;
+    recording.pcm.resize(static_cast<size_t>(sampleRate * seconds));
+    std::mt19937 rng(42);
+    std::normal_distribution<float> noise(0.0f, 0.003f);
+    std::uniform_real_distribution<double> burst(0.5, 3.0), pause(0.3, 1.5);
+    size_t nextToggle = static_cast<size_t>(pause(rng) * sampleRate);
+    bool speaking = false;
+    double phase = 0.0;
+    for (size_t i = 0; i < recording.pcm.size(); i++) {
+        if (i == nextToggle) {
+            speaking = !speaking;
+            nextToggle += static_cast<size_t>((speaking ? burst(rng) : pause(rng)) * sampleRate);
+        }
+        const double t = static_cast<double>(i) / sampleRate;
+        const double f0 = 140.0 + 30.0 * std::sin(2.0 * M_PI * 0.7 * t);
+        phase += 2.0 * M_PI * f0 / sampleRate;
+        float s = noise(rng);
+        if (speaking) {
+            const double envelope = 0.5 + 0.5 * std::sin(2.0 * M_PI * 4.0 * t);
+            double voiced = 0.0;
+            for (int h = 1; h <= 6; h++) voiced += std::sin(h * phase) / h;
+            s += static_cast<float>(0.2 * envelope * voiced);
+        }
+        recording.pcm[i] = static_cast<int16_t>(std::max(-1.0f, std::min(1.0f, s)) * 32767.0f);
+    }
+    return recording;
+}
+
+class SegmentEncoder {
+public:
+    explicit SegmentEncoder(bool opus) {
+#if defined(HAVE_OPUS)
+        if (opus) {
+            codec::OggOpusConfig config;
+            config.sampleRate = kPipelineRate;
+            opus_ = std::make_unique<codec::OggOpusEncoder>(config);
+            return;
+        }
+#else
+        (void)opus;
+#endif
+        flac_ = std::make_unique<storage::FlacEncoder>(kPipelineRate, 1);
+    }
+
+    // One file per segment, as the app uploads them
+    size_t encode(const std::vector<int16_t>& pcm) {
+        out_.clear();
+#if defined(HAVE_OPUS)
+        if (opus_) {
+            opus_->encode(pcm.data(), pcm.size(), out_);
+            opus_->finish(out_);
+            return out_.size();
+        }
+#endif
+        flac_->begin(out_);
+        flac_->encode(pcm.data(), pcm.size(), out_);
+        flac_->finish(out_);
+        return out_.size();
+    }
+
+private:
+#if defined(HAVE_OPUS)
+    std::unique_ptr<codec::OggOpusEncoder> opus_;
+#endif
+    std::unique_ptr<storage::FlacEncoder> flac_;
+    std::vector<uint8_t> out_;
+};
+
+class PipelineStream {
+public:
+    PipelineStream(const Recording& recording, size_t startOffset, uint64_t packets, bool opus,
+                   const vad::SegmenterConfig& segmenterConfig, std::shared_ptr<const vad::VadModel> model)
+        : recording_(recording),
+          packetSamples_(static_cast<size_t>(recording.sampleRate) / 100),
+          position_(startOffset % recording.pcm.size()),
+          packetsLeft_(packets),
+          ring_(static_cast<size_t>(recording.sampleRate) * 2),
+          denoiser_(recording.sampleRate),
+          resampler_(recording.sampleRate, kPipelineRate),
+          segmenter_(segmenterConfig, std::move(model)),
+          encoder_(opus) {
+        packet_.resize(packetSamples_);
+        converted_.resize(packetSamples_);
+        frame_.resize(packetSamples_);
+        resampled_.reserve(resampler_.maxOutput(packetSamples_) + 16);
+        pcm16_.resize(resampled_.capacity());
+    }
+
+    bool done() const { return packetsLeft_ == 0; }
+
+    // One 10 ms packet through every stage
+    void step() {
+        // Capture backend: a device packet, converted into the ring
+        for (size_t i = 0; i < packetSamples_; i++) {
+            packet_[i] = recording_.pcm[position_];
+            if (++position_ == recording_.pcm.size()) position_ = 0;
+        }
+        capture::int16ToFloat(packet_.data(), converted_.data(), packetSamples_);
+        ring_.write(converted_.data(), packetSamples_);
+
+        // Delivery side
+        const size_t n = ring_.read(frame_.data(), frame_.size());
+        denoiser_.process(frame_.data(), n);
+        resampled_.clear();
+        resampler_.process(frame_.data(), n, &resampled_);
+        capture::floatToInt16(resampled_.data(), pcm16_.data(), resampled_.size());
+        segmenter_.process(pcm16_.data(), resampled_.size(), &segments_);
+        encodeSegments();
+        packetsLeft_--;
+    }
+
+    void finish() {
+        resampled_.clear();
+        resampler_.flush(&resampled_);
+        pcm16_.resize(std::max(pcm16_.size(), resampled_.size()));
+        capture::floatToInt16(resampled_.data(), pcm16_.data(), resampled_.size());
+        segmenter_.process(pcm16_.data(), resampled_.size(), &segments_);
+        segmenter_.flush(&segments_);
+        encodeSegments();
+    }
+
+    uint64_t segments() const { return segmentCount_; }
+    uint64_t encodedBytes() const { return encodedBytes_; }
+
+private:
+    const Recording& recording_;
+    size_t packetSamples_;
+    size_t position_;
+    uint64_t packetsLeft_;
+    capture::SampleRing ring_;
+    dsp::Denoiser denoiser_;
+    dsp::Resampler resampler_;
+    vad::Segmenter segmenter_;
+    SegmentEncoder encoder_;
+    std::vector<int16_t> packet_;
+    std::vector<float> converted_;
+    std::vector<float> frame_;
+    std::vector<float> resampled_;
+    std::vector<int16_t> pcm16_;
+    std::vector<vad::Segment> segments_;
+    uint64_t segmentCount_ = 0;
+    uint64_t encodedBytes_ = 0;
+
+    void encodeSegments() {
+        for (const vad::Segment& segment : segments_) {
+            encodedBytes_ += encoder_.encode(segment.pcm);
+            segmentCount_++;
+        }
+        segments_.clear();
+    }
+};
+
+double percentile(std::vector<float>* values, double p) {
+    if (values->empty()) return 0.0;
+    const size_t k = std::min(values->size() - 1, static_cast<size_t>(p * (values->size() - 1) + 0.5));
+    std::nth_element(values->begin(), values->begin() + k, values->end());
+    return (*values)[k];
+}
+
+LevelReport runLevel(const std::vector<Recording>& recordings, int streamCount, const Options& options, bool opus,
+                     std::shared_ptr<const vad::VadModel> model) {
+    LevelReport report;
+    report.streams = streamCount;
+    report.threads = std::min(streamCount, options.threads);
+    const uint64_t packetsPerStream = static_cast<uint64_t>(options.seconds * 100.0);
+    report.audioSeconds = packetsPerStream / 100.0;
+
+    vad::SegmenterConfig segmenterConfig;
+    segmenterConfig.vad.sampleRate = kPipelineRate;
+    std::vector<std::unique_ptr<PipelineStream>> streams;
+    for (int s = 0; s < streamCount; s++) {
+        const Recording& recording = recordings[s % recordings.size()];
+        // Staggered so streams sharing a recording are not in lockstep
+        const size_t offset = (static_cast<size_t>(s / recordings.size()) * 7919 * recording.sampleRate / 100);
+        streams.push_back(std::make_unique<PipelineStream>(recording, offset, packetsPerStream, opus,
+                                                           segmenterConfig, model));
+    }
+
+    std::vector<std::vector<float>> packetUs(report.threads);
+    for (int w = 0; w < report.threads; w++) {
+        packetUs[w].reserve(static_cast<size_t>((streamCount + report.threads - 1) / report.threads) * packetsPerStream);
+    }
+
+    report.rssReset = resetPeakRss();
+    const uint64_t allocationsBefore = g_allocations.load(std::memory_order_relaxed);
+    const double cpuBefore = processCpuSeconds();
+    const auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> workers;
+    for (int w = 0; w < report.threads; w++) {
+        workers.emplace_back([&, w] {
+            std::vector<PipelineStream*> mine;
+            for (int s = w; s < streamCount; s += report.threads) mine.push_back(streams[s].get());
+            std::vector<float>& times = packetUs[w];
+            bool any = true;
+            while (any) {
+                any = false;
+                for (PipelineStream* stream : mine) {
+                    if (stream->done()) continue;
+                    const auto t0 = std::chrono::steady_clock::now();
+                    stream->step();
+                    times.push_back(std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - t0).count());
+                    any = true;
+                }
+            }
+            for (PipelineStream* stream : mine) stream->finish();
+        });
+    }
+    for (std::thread& worker : workers) worker.join();
+
+    report.wallSeconds = secondsSince(start);
+    report.cpuSeconds = processCpuSeconds() - cpuBefore;
+    report.allocations = g_allocations.load(std::memory_order_relaxed) - allocationsBefore;
+    report.peakRssBytes = peakRssBytes();
+
+    std::vector<float> all;
+    for (std::vector<float>& times : packetUs) {
+        all.insert(all.end(), times.begin(), times.end());
+        std::vector<float>().swap(times);
+    }
+    report.packets = all.size();
+    report.maxUs = all.empty() ? 0.0 : *std::max_element(all.begin(), all.end());
+    report.p99Us = percentile(&all, 0.99);
+    report.p50Us = percentile(&all, 0.50);
+    for (const auto& stream : streams) {
+        report.segments += stream->segments();
+        report.encodedBytes += stream->encodedBytes();
+    }
+    return report;
+}
+
+void printUsage() {
+    std::fprintf(stderr,
+                 "Usage: pipeline_rtf_bench [corpus_dir|file.wav ...] [--streams 1,8,64,256] [--seconds 30]\n"
+                 "                          [--threads N] [--codec opus|flac] [--vad model.tnsr] [--json]\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseArgs(argc, argv, &options)) {
+        printUsage();
+        return 2;
+    }
+    if (options.threads <= 0) options.threads = std::max(1u, std::thread::hardware_concurrency());
+
+#if defined(HAVE_OPUS)
+    const bool opus = options.codec.empty() || options.codec == "opus";
+#else
+    if (options.codec == "opus") {
+        std::fprintf(stderr, "built without libopus; use --codec flac\n");
+        return 2;
+    }
+    const bool opus = false;
+#endif
+    if (!options.codec.empty() && options.codec != "opus" && options.codec != "flac") {
+        printUsage();
+        return 2;
+    }
+
+    std::shared_ptr<const vad::VadModel> model;
+    if (!options.vadModel.empty()) {
+        std::string error;
+        model = vad::VadModel::load(options.vadModel, &error);
+        if (!model) {
+            std::fprintf(stderr, "%s: %s\n", options.vadModel.c_str(), error.c_str());
+            return 1;
+        }
+    }
+
+    std::vector<Recording> recordings;
+    if (!loadCorpus(options.inputs, &recordings)) return 1;
+    if (options.inputs.empty()) recordings.push_back(syntheticRecording(48000, 30.0));
+    if (recordings.empty()) {
+        std::fprintf(stderr, "no WAV recordings found\n");
+        return 1;
+    }
+
+    if (!options.json) {
+        double corpusSeconds = 0.0;
+        for (const Recording& r : recordings) corpusSeconds += static_cast<double>(r.pcm.size()) / r.sampleRate;
+        std::printf("%zu recording(s), %.1f s; %.0f s per stream; %d threads; %s; %s VAD\n\n", recordings.size(),
+                    corpusSeconds, options.seconds, options.threads, opus ? "opus" : "flac",
+                    model ? "neural" : "built-in");
+        std::printf("%8s %8s %8s %9s %9s %9s %9s %10s %10s %12s %9s\n", "streams", "threads", "rtf", "capacity",
+                    "p50_us", "p99_us", "max_us", "cpu_cores", "peak_MB", "allocs/s", "allocs/pkt");
+    } else {
+        std::printf("{\n  \"recordings\": %zu,\n  \"secondsPerStream\": %.1f,\n  \"threads\": %d,\n"
+                    "  \"codec\": \"%s\",\n  \"levels\": [",
+                    recordings.size(), options.seconds, options.threads, opus ? "opus" : "flac");
+    }
+
+    bool first = true;
+    bool rssSinceStart = false;
+    for (int streams : options.streams) {
+        const LevelReport r = runLevel(recordings, streams, options, opus, model);
+        const double allocsPerSecond = r.wallSeconds > 0.0 ? r.allocations / r.wallSeconds : 0.0;
+        const double allocsPerPacket = r.packets ? static_cast<double>(r.allocations) / r.packets : 0.0;
+        const double cpuCores = r.wallSeconds > 0.0 ? r.cpuSeconds / r.wallSeconds : 0.0;
+        if (!options.json) {
+            std::printf("%8d %8d %8.4f %9.1f %9.1f %9.1f %9.1f %10.2f %9.1f%s %12.0f %9.2f\n", r.streams, r.threads,
+                        r.rtf(), r.capacity(), r.p50Us, r.p99Us, r.maxUs, cpuCores, r.peakRssBytes / 1048576.0,
+                        r.rssReset ? " " : "*", allocsPerSecond, allocsPerPacket);
+        } else {
+            std::printf("%s\n    {\"streams\": %d, \"threads\": %d, \"rtf\": %.6f, \"capacity\": %.2f, "
+                        "\"packetP50Us\": %.2f, \"packetP99Us\": %.2f, \"packetMaxUs\": %.2f, "
+                        "\"wallSeconds\": %.3f, \"cpuSeconds\": %.3f, \"peakRssBytes\": %llu, "
+                        "\"peakRssSinceStart\": %s, \"allocations\": %llu, \"allocationsPerSecond\": %.1f, "
+                        "\"allocationsPerPacket\": %.3f, \"segments\": %llu, \"encodedBytes\": %llu}",
+                        first ? "" : ",", r.streams, r.threads, r.rtf(), r.capacity(), r.p50Us, r.p99Us, r.maxUs,
+                        r.wallSeconds, r.cpuSeconds, static_cast<unsigned long long>(r.peakRssBytes),
+                        r.rssReset ? "false" : "true", static_cast<unsigned long long>(r.allocations),
+                        allocsPerSecond, allocsPerPacket, static_cast<unsigned long long>(r.segments),
+                        static_cast<unsigned long long>(r.encodedBytes));
+        }
+        std::fflush(stdout);
+        first = false;
+        rssSinceStart |= !r.rssReset;
+    }
+
+    if (!options.json) {
+        std::printf("\nrtf = wall time / audio per stream (< 1: keeps up live); capacity = streams / rtf\n");
+        std::printf("p50/p99/max: one 10 ms packet through every stage; allocs: operator new calls\n");
+        if (rssSinceStart) std::printf("* peak RSS since process start (not resettable on this OS)\n");
+    } else {
+        std::printf("\n  ]\n}\n");
+    }
+    return 0;
+}
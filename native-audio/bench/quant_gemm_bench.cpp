@@ -0,0 +1,148 @@
+// Quantized GEMM/GEMV against the fp32 kernels
+//
+// Times asr::linear on fp32 weights and quant::gemm on int8 (per-channel)
+// and int4 (32-weight groups) weights for every kernel this CPU supports,
+// single-threaded, on projection shapes of the Whisper base/small models:
+// one decoder token (GEMV) and an encoder window slice (GEMM). Reports
+// effective GFLOP/s, speedup over fp32 and the relative RMS error of the
+// quantized output against a double-precision reference. Fails (exit 1) if
+// any kernel disagrees with the scalar one or the error exceeds its budget.
+//
+// Build: npm run bench:build    Run: ./build/Release/quant_gemm_bench [min_ms]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <vector>
+
+#include "asr/tensor_ops.h"
+#include "asr/thread_pool.h"
+#include "quant/gemm.h"
+
+struct Shape {
+    const char* name;
+    size_t rows;
+    size_t in;
+    size_t out;
+};
+
+// Mean time per call, repeating for at least minMs after one warm-up
+static double TimeUs(double minMs, const std::function<void()>& fn) {
+    fn();
+    size_t calls = 0;
+    const auto start = std::chrono::steady_clock::now();
+    double elapsedMs = 0.0;
+    do {
+        fn();
+        calls++;
+        elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    } while (elapsedMs < minMs);
+    return elapsedMs * 1000.0 / calls;
+}
+
+static double RelativeError(const std::vector<double>& reference, const std::vector<float>& y) {
+    double error = 0.0;
+    double norm = 0.0;
+    for (size_t i = 0; i < reference.size(); i++) {
+        error += (y[i] - reference[i]) * (y[i] - reference[i]);
+        norm += reference[i] * reference[i];
+    }
+    return std::sqrt(error / norm);
+}
+
+int main(int argc, char** argv) {
+    const double minMs = argc > 1 ? std::max(1.0, std::atof(argv[1])) : 200.0;
+    const Shape shapes[] = {
+        { "gemv 512x512", 1, 512, 512 },
+        { "gemv 512x2048", 1, 512, 2048 },
+        { "gemv 2048x512", 1, 2048, 512 },
+        { "gemv 768x51865", 1, 768, 51865 },
+        { "gemm 64x512x512", 64, 512, 512 },
+        { "gemm 256x768x3072", 256, 768, 3072 },
+    };
+    const double budget[] = { 0.02, 0.15 };   // int8, int4
+    const double agreement = 1e-5;
+
+    std::vector<quant::Isa> isas;
+    for (quant::Isa isa : { quant::Isa::Scalar, quant::Isa::Avx2, quant::Isa::AvxVnni, quant::Isa::Avx512Vnni }) {
+        if (quant::setIsa(isa)) isas.push_back(isa);
+    }
+    quant::setIsa(quant::detectIsa());
+
+    asr::ThreadPool pool(1);
+    std::mt19937 rng(7);
+    std::normal_distribution<float> normal(0.0f, 1.0f);
+    bool ok = true;
+
+    std::printf("Quantized GEMM, 1 thread, best ISA here: %s\n\n", quant::isaName(quant::detectIsa()));
+    std::printf("%-18s %-5s %-12s %10s %9s %9s %10s\n", "shape", "type", "isa", "us/call", "GFLOP/s",
+                "speedup", "rel_err");
+
+    for (const Shape& shape : shapes) {
+        std::vector<float> w(shape.out * shape.in);
+        std::vector<float> x(shape.rows * shape.in);
+        std::vector<float> bias(shape.out);
+        for (float& v : w) v = 0.05f * normal(rng);
+        for (float& v : x) v = normal(rng);
+        for (float& v : bias) v = 0.1f * normal(rng);
+
+        std::vector<double> reference(shape.rows * shape.out);
+        for (size_t r = 0; r < shape.rows; r++) {
+            for (size_t o = 0; o < shape.out; o++) {
+                double sum = bias[o];
+                for (size_t k = 0; k < shape.in; k++) sum += static_cast<double>(x[r * shape.in + k]) * w[o * shape.in + k];
+                reference[r * shape.out + o] = sum;
+            }
+        }
+
+        const double flops = 2.0 * shape.rows * shape.in * shape.out;
+        std::vector<float> y(shape.rows * shape.out);
+        const double fp32Us = TimeUs(minMs, [&] {
+            asr::linear(x.data(), shape.rows, shape.in, w.data(), bias.data(), shape.out, y.data(), pool);
+        });
+        std::printf("%-18s %-5s %-12s %10.1f %9.2f %9s %10.2e\n", shape.name, "f32", "-", fp32Us,
+                    flops / fp32Us / 1e3, "1.0x", RelativeError(reference, y));
+
+        for (quant::QuantType type : { quant::QuantType::Int8, quant::QuantType::Int4 }) {
+            const bool int8 = type == quant::QuantType::Int8;
+            quant::QuantizedMatrix matrix;
+            quant::quantizeMatrix(w.data(), shape.out, shape.in, type, int8 ? 0 : quant::kBlock, &matrix);
+            quant::QuantizedActivations activations;
+            quant::quantizeActivations(x.data(), shape.rows, shape.in, &activations);
+
+            std::vector<float> scalar;
+            for (quant::Isa isa : isas) {
+                quant::setIsa(isa);
+                // Includes quantizing the activations, as in asr::linear
+                const double us = TimeUs(minMs, [&] {
+                    quant::quantizeActivations(x.data(), shape.rows, shape.in, &activations);
+                    quant::gemm(activations, matrix, 0, shape.out, bias.data(), y.data(), shape.out);
+                });
+                const double error = RelativeError(reference, y);
+                if (isa == quant::Isa::Scalar) scalar = y;
+
+                float mismatch = 0.0f;
+                for (size_t i = 0; i < y.size(); i++) {
+                    mismatch = std::max(mismatch, std::fabs(y[i] - scalar[i]) / (1.0f + std::fabs(scalar[i])));
+                }
+                const bool pass = error <= budget[int8 ? 0 : 1] && mismatch <= agreement;
+                ok = ok && pass;
+
+                std::printf("%-18s %-5s %-12s %10.1f %9.2f %8.1fx %10.2e%s\n", shape.name, int8 ? "int8" : "int4",
+                            quant::isaName(isa), us, flops / us / 1e3, fp32Us / us, error, pass ? "" : "  FAIL");
+            }
+        }
+        std::printf("\n");
+    }
+    quant::setIsa(quant::detectIsa());
+
+    std::printf("GFLOP/s counts 2*rows*in*out per call; rel_err is RMS error / RMS output against a\n"
+                "double-precision product of the unquantized inputs (budget %.0f%% int8, %.0f%% int4)\n",
+                budget[0] * 100, budget[1] * 100);
+    if (!ok) std::printf("\nFAILED: kernel disagreement or error over budget\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,285 @@
+// Real-time safety check of the native audio callback paths
+//
+// Drives each piece of code that runs on an OS audio thread through the same
+// calls the callbacks make, inside a capture::RealtimeScope, with the
+// allocation and lock hooks of capture/realtime_check compiled in:
+//
+//   wasapi int16/int32/float   PacketConverter -> CaptureDelivery::push, with
+//                              the packet sizes a shared-mode endpoint gives
+//   sck float/int16            the ScreenCaptureKit handler's conversion and
+//                              push (mono 16 kHz as configured, and stereo)
+//   dsp 48k/16k                dsp_process in 128-frame render quanta and 10 ms
+//                              blocks, and the 48 kHz -> 16 kHz resampler
+//   traced sck/wasapi          the handlers' trace points while recording, on
+//                              a new thread whose first event claims its ring
+//
+// Each path is warmed up (buffers grow to the largest packet), then run for
+// a number of steady-state frames; any allocation, free or mutex lock in
+// them fails the check. A delivery thread drains every ring meanwhile, as in
+// the addons. First it checks that the hooks do see an allocation and a lock
+// inside a scope, so a pass is not vacuous.
+//
+// Build: npm run bench:build
+// Run:   npm run bench:rt -- [--frames N] [--abort]
+// --abort stops at the first violation with the scope's name (for a
+// debugger or a core dump) instead of counting. Exits non-zero on failure.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "capture/capture_delivery.h"
+#include "capture/realtime_check.h"
+#include "capture/sample_format.h"
+#include "dsp/audio_dsp.h"
+#include "trace/trace.h"
+
+namespace {
+
+const int kWarmupFrames = 50;
+
+struct PathResult {
+    std::string name;
+    int frames = 0;
+    capture::RtCheckStats stats;
+};
+
+// Keeps the self-test's allocation from being optimized away
+void* volatile g_sink = nullptr;
+
+bool selfTest() {
+    std::mutex mutex;
+    capture::rtResetStats();
+    {
+        capture::RealtimeScope realtime("self test");
+        g_sink = new std::vector<float>(64);
+        delete static_cast<std::vector<float>*>(g_sink);
+        std::lock_guard<std::mutex> lock(mutex);
+    }
+    // Outside a scope nothing counts
+    g_sink = new int(1);
+    delete static_cast<int*>(g_sink);
+    capture::RtCheckStats stats = capture::rtStats();
+
+    bool ok = stats.allocations == 2 && stats.frees == 2;   // the vector and its buffer
+    if (capture::rtDetectsLocks()) ok = ok && stats.locks == 1;
+    if (!ok) {
+        std::fprintf(stderr, "self test: expected 2 allocations, 2 frees%s; saw %llu, %llu, %llu locks\n",
+                     capture::rtDetectsLocks() ? ", 1 lock" : "", (unsigned long long)stats.allocations,
+                     (unsigned long long)stats.frees, (unsigned long long)stats.locks);
+    }
+    capture::rtResetStats();
+    return ok;
+}
+
+// Runs frame(i) kWarmupFrames times, then frames times inside a scope
+PathResult runPath(const std::string& name, int frames, const std::function<void(int)>& frame) {
+    for (int i = 0; i < kWarmupFrames; i++) {
+        frame(i);
+    }
+    capture::rtResetStats();
+    for (int i = 0; i < frames; i++) {
+        capture::RealtimeScope realtime(name.c_str());
+        frame(kWarmupFrames + i);
+    }
+    PathResult result;
+    result.name = name;
+    result.frames = frames;
+    result.stats = capture::rtStats();
+    return result;
+}
+
+// A device's interleaved packets, in its native format
+struct DevicePackets {
+    std::vector<int16_t> int16;
+    std::vector<int32_t> int32;
+    std::vector<float> float32;
+
+    DevicePackets(size_t samples, int channels, int sampleRate) : int16(samples), int32(samples), float32(samples) {
+        const double twoPi = 6.283185307179586;
+        for (size_t i = 0; i < samples; i++) {
+            const double t = static_cast<double>(i / channels) / sampleRate;
+            const double x = 0.5 * std::sin(twoPi * 440.0 * t);
+            float32[i] = static_cast<float>(x);
+            int16[i] = static_cast<int16_t>(x * 32767.0);
+            int32[i] = static_cast<int32_t>(x * 2147483647.0);
+        }
+    }
+
+    const void* data(capture::SampleFormat format) const {
+        switch (format) {
+            case capture::SampleFormat::Int16: return int16.data();
+            case capture::SampleFormat::Int32: return int32.data();
+            default: return float32.data();
+        }
+    }
+};
+
+// Capture callback: convert, then copy into the ring. The delivery thread
+// takes chunks out (and allocates for them) as it does for the N-API call.
+// traceName: also record the handler's trace points, as named, but only in
+// the checked frames, so the thread's first event is one of them.
+PathResult runCapturePath(const std::string& name, int frames, capture::SampleFormat format, int sampleRate,
+                          int channels, const std::vector<size_t>& packetFrames, bool reserveUpFront,
+                          const char* traceName = nullptr) {
+    capture::DeliveryConfig config;
+    config.sampleRate = sampleRate;
+    config.channels = channels;
+    config.chunkMs = 5;
+    capture::CaptureDelivery delivery(config, [](std::vector<float>& chunk) {
+        chunk.clear();
+        return true;
+    });
+    delivery.start();
+
+    const size_t maxFrames = *std::max_element(packetFrames.begin(), packetFrames.end());
+    DevicePackets device(maxFrames * channels, channels, sampleRate);
+    capture::PacketConverter converter;
+    if (reserveUpFront) {
+        converter.reserve(maxFrames * channels);   // WASAPI: GetBufferSize
+    }
+
+    const auto handle = [&](size_t samples) {
+        const float* data = converter.convert(device.data(format), samples, format);
+        if (data) delivery.push(data, samples);
+    };
+    PathResult result = runPath(name, frames, [&](int i) {
+        const size_t samples = packetFrames[i % packetFrames.size()] * channels;
+        if (traceName && i >= kWarmupFrames) {
+            trace::setThreadName(traceName);
+            trace::Scope span(traceName, "samples", static_cast<int64_t>(samples));
+            handle(samples);
+        } else {
+            handle(samples);
+        }
+    });
+    delivery.stop();
+    return result;
+}
+
+PathResult runDspPath(const std::string& name, int frames, int sampleRate, size_t block) {
+    dsp_config config;
+    dsp_config_init(&config);
+    config.sample_rate = sampleRate;
+    dsp_state* state = dsp_create(&config);
+    std::vector<float> samples(block);
+    DevicePackets device(block, 1, sampleRate);
+
+    PathResult result = runPath(name, frames, [&](int) {
+        std::copy(device.float32.begin(), device.float32.end(), samples.begin());
+        dsp_process(state, samples.data(), samples.size());
+    });
+    dsp_destroy(state);
+    return result;
+}
+
+PathResult runResamplerPath(const std::string& name, int frames, size_t block) {
+    dsp_resampler* resampler = dsp_resampler_create(48000, 16000);
+    DevicePackets device(block, 1, 48000);
+    std::vector<float> output(dsp_resampler_max_output(resampler, block));
+
+    PathResult result = runPath(name, frames, [&](int) {
+        dsp_resampler_process(resampler, device.float32.data(), block, output.data(), output.size());
+    });
+    dsp_resampler_destroy(resampler);
+    return result;
+}
+
+// A capture path with tracing on, run on a thread of its own: like a
+// ScreenCaptureKit queue thread that starts handling buffers mid-recording.
+// Fails unless every checked frame was recorded.
+PathResult runTracedPath(const std::string& name, int frames, capture::SampleFormat format, int sampleRate,
+                         int channels, const std::vector<size_t>& packetFrames, bool reserveUpFront,
+                         const char* traceName) {
+    trace::start(static_cast<size_t>(frames) * 2);
+    PathResult result;
+    std::thread callback([&] {
+        result = runCapturePath(name, frames, format, sampleRate, channels, packetFrames, reserveUpFront, traceName);
+    });
+    callback.join();
+    trace::stop();
+
+    const trace::TraceStats stats = trace::stats();
+    if (stats.events != static_cast<uint64_t>(frames) || stats.dropped != 0) {
+        std::fprintf(stderr, "%s: expected %d trace events, got %llu (%llu dropped)\n", name.c_str(), frames,
+                     (unsigned long long)stats.events, (unsigned long long)stats.dropped);
+        result.frames = 0;
+    }
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int frames = 2000;
+    bool abortOnViolation = false;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--frames" && i + 1 < argc) {
+            frames = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--abort") {
+            abortOnViolation = true;
+        } else {
+            std::fprintf(stderr, "Usage: rt_safety_check [--frames N] [--abort]\n");
+            return 2;
+        }
+    }
+
+    if (!capture::rtChecksEnabled()) {
+        std::fprintf(stderr, "built without AUDIO_RT_CHECKS\n");
+        return 2;
+    }
+    std::printf("hooks: operator new/delete, malloc family %s, mutex locks %s\n",
+                capture::rtDetectsMalloc() ? "yes" : "no", capture::rtDetectsLocks() ? "yes" : "no");
+    if (!selfTest()) {
+        return 1;
+    }
+    capture::rtSetMode(abortOnViolation ? capture::RtMode::Abort : capture::RtMode::Count);
+
+    using capture::SampleFormat;
+    // Shared-mode WASAPI packets are one device period, with the odd short one
+    const std::vector<size_t> wasapiPackets = {480, 480, 441, 480, 512, 480, 128};
+    // ScreenCaptureKit delivers 1024-frame buffers at the configured 16 kHz
+    const std::vector<size_t> sckPackets = {1024, 1024, 960, 1024};
+
+    std::vector<PathResult> results;
+    results.push_back(runCapturePath("wasapi int16 48k stereo", frames, SampleFormat::Int16, 48000, 2,
+                                     wasapiPackets, true));
+    results.push_back(runCapturePath("wasapi int32 48k stereo", frames, SampleFormat::Int32, 48000, 2,
+                                     wasapiPackets, true));
+    results.push_back(runCapturePath("wasapi float 44.1k stereo", frames, SampleFormat::Float32, 44100, 2,
+                                     wasapiPackets, true));
+    results.push_back(runCapturePath("sck float 16k mono", frames, SampleFormat::Float32, 16000, 1,
+                                     sckPackets, false));
+    results.push_back(runCapturePath("sck int16 48k stereo", frames, SampleFormat::Int16, 48000, 2,
+                                     sckPackets, false));
+    results.push_back(runDspPath("dsp 48k x128", frames, 48000, 128));
+    results.push_back(runDspPath("dsp 48k x480", frames, 48000, 480));
+    results.push_back(runDspPath("dsp 16k x160", frames, 16000, 160));
+    results.push_back(runResamplerPath("resample 48k->16k x480", frames, 480));
+    results.push_back(runTracedPath("traced sck float 16k mono", frames, SampleFormat::Float32, 16000, 1,
+                                    sckPackets, false, "sck buffer"));
+    results.push_back(runTracedPath("traced wasapi int16 48k", frames, SampleFormat::Int16, 48000, 2,
+                                    wasapiPackets, true, "wasapi packet"));
+
+    std::printf("\n%-28s %8s %8s %8s %8s  %s\n", "path", "frames", "allocs", "frees", "locks", "result");
+    int failures = 0;
+    for (const PathResult& r : results) {
+        const bool ok = r.stats.total() == 0 && r.frames > 0;
+        if (!ok) failures++;
+        std::printf("%-28s %8d %8llu %8llu %8llu  %s\n", r.name.c_str(), r.frames,
+                    (unsigned long long)r.stats.allocations, (unsigned long long)r.stats.frees,
+                    (unsigned long long)r.stats.locks, ok ? "ok" : "FAIL");
+    }
+    std::printf("\n%d of %zu paths allocate or lock in steady state\n", failures, results.size());
+    return failures > 0 ? 1 : 0;
+}
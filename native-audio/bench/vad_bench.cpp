@@ -0,0 +1,358 @@
+// Voice activity detection accuracy and cost
+//
+// Builds 60 s scenes of speech-like bursts (harmonic voice with syllable
+// modulation, short pauses inside utterances, longer ones between them)
+// over different backgrounds, runs vad::VoiceDetector on them in 20 ms
+// blocks and compares against the known speech regions:
+//
+//   recall    share of speech samples inside a detected utterance
+//   false     share of non-speech samples inside one
+//   padded    the same with the endpointer's pre-roll (200 ms) and post-roll
+//             (150 ms) added to each utterance, as the segmenter cuts it
+//   onset     mean |start event - true start| (start events are pre-rolled)
+//
+// recall and false score the detector's decisions alone (a second run with
+// pre- and post-roll at 0). Hangover only delays the end event, which is
+// placed after the last speech frame, so it counts as speech only where it
+// bridges a pause inside an utterance. The padding is deliberate and is
+// reported on its own: it adds about 20% of the non-speech in these scenes
+// (16 utterances, 350 ms each, in ~28 s).
+//
+// The previous gate (RMS > 10 on each 20 ms int16 chunk) is scored the same
+// way for comparison. Cost is CPU time per second of audio.
+//
+// The second table runs vad::Segmenter on the same scenes and counts segment
+// boundaries that fall inside an utterance (splitting words), against the
+// previous batching of every 75 gated chunks (1.5 s of voiced audio).
+//
+// The third uses scenes of short replies, which the segmenter joins with the
+// pauses between them, compacts silence inside the segments (maxGapMs 300)
+// and reports the audio uploaded before and after, the share of voiced
+// samples kept, and whether every kept sample maps back to its original
+// through the remap table.
+//
+// Build: npm run bench:build
+// Run:   ./build/Release/vad_bench [vad.tnsr] [sampleRate]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "vad/segmenter.h"
+#include "vad/voice_detector.h"
+
+struct Region {
+    size_t start;
+    size_t end;
+};
+
+struct Scene {
+    const char* name;
+    float speechDb;      // RMS of voiced audio, dBFS
+    float noiseDb;       // RMS of the background, dBFS (-200 = digital silence)
+    bool lowPassNoise;   // fan-like rumble instead of white noise
+};
+
+struct Pacing {
+    float minLength, maxLength;   // utterance, s
+    float minGap, maxGap;         // between utterances, s
+};
+
+// Utterances of 0.8-3 s with 120 ms pauses inside, 0.8-2.5 s apart
+const Pacing kMonologue = {0.8f, 3.0f, 0.8f, 2.5f};
+// Short replies and back-channels under a second, 0.5-1 s apart
+const Pacing kReplies = {0.3f, 0.9f, 0.5f, 1.0f};
+
+static std::vector<float> MakeScene(const Scene& scene, int sampleRate, int seconds,
+                                    std::vector<Region>* truth, const Pacing& pacing = kMonologue,
+                                    std::vector<uint8_t>* voiced = nullptr) {
+    const size_t n = static_cast<size_t>(sampleRate) * seconds;
+    std::vector<float> audio(n, 0.0f);
+    if (voiced) voiced->assign(n, 0);
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+
+    size_t pos = static_cast<size_t>(sampleRate);
+    while (pos < n - 4 * static_cast<size_t>(sampleRate)) {
+        const size_t length = static_cast<size_t>(
+            (pacing.minLength + (pacing.maxLength - pacing.minLength) * uniform(rng)) * sampleRate);
+        truth->push_back({pos, pos + length});
+        const float f0 = 100.0f + 120.0f * uniform(rng);
+        const size_t pause = length / 2;
+        for (size_t i = pos; i < pos + length; i++) {
+            if (i >= pos + pause && i < pos + pause + static_cast<size_t>(0.12f * sampleRate)) continue;
+            if (voiced) (*voiced)[i] = 1;
+            const float t = static_cast<float>(i - pos) / sampleRate;
+            const float pitch = f0 * (1.0f + 0.1f * std::sin(2.0f * static_cast<float>(M_PI) * 0.8f * t));
+            const float syllable = 0.55f + 0.45f * std::sin(2.0f * static_cast<float>(M_PI) * 4.0f * t);
+            float s = 0.0f;
+            for (int h = 1; h <= 12; h++) {
+                // Formant-like emphasis around 500 Hz and 1.5 kHz
+                const float f = pitch * h;
+                const float gain = 1.0f / (1.0f + std::fabs(f - 500.0f) / 300.0f) +
+                                   0.5f / (1.0f + std::fabs(f - 1500.0f) / 400.0f);
+                s += gain * std::sin(2.0f * static_cast<float>(M_PI) * pitch * h * t);
+            }
+            audio[i] = s * syllable;
+        }
+        pos += length + static_cast<size_t>((pacing.minGap + (pacing.maxGap - pacing.minGap) * uniform(rng)) * sampleRate);
+    }
+
+    // Scale voice to speechDb
+    double energy = 0.0;
+    size_t spoken = 0;
+    for (const Region& r : *truth) {
+        for (size_t i = r.start; i < r.end; i++) energy += audio[i] * audio[i];
+        spoken += r.end - r.start;
+    }
+    const float gain = static_cast<float>(std::pow(10.0, scene.speechDb / 20.0) / std::sqrt(energy / spoken));
+    for (float& s : audio) s *= gain;
+
+    if (scene.noiseDb > -150.0f) {
+        std::normal_distribution<float> normal(0.0f, 1.0f);
+        std::vector<float> noise(n);
+        float state = 0.0f;
+        double noiseEnergy = 0.0;
+        for (size_t i = 0; i < n; i++) {
+            const float white = normal(rng);
+            // One-pole low-pass at ~150 Hz, plus a 120 Hz hum, for the fan
+            state += 0.06f * (white - state);
+            noise[i] = scene.lowPassNoise
+                           ? state + 0.05f * std::sin(2.0f * static_cast<float>(M_PI) * 120.0f * i / sampleRate)
+                           : white;
+            noiseEnergy += noise[i] * noise[i];
+        }
+        const float noiseGain = static_cast<float>(std::pow(10.0, scene.noiseDb / 20.0) / std::sqrt(noiseEnergy / n));
+        for (size_t i = 0; i < n; i++) audio[i] += noise[i] * noiseGain;
+    }
+    return audio;
+}
+
+// Boundaries strictly inside a true utterance, outside its inner pause
+static size_t CutsInSpeech(const std::vector<Region>& truth, const std::vector<size_t>& cuts, int sampleRate) {
+    const size_t pause = static_cast<size_t>(0.12f * sampleRate);
+    size_t count = 0;
+    for (size_t cut : cuts) {
+        for (const Region& r : truth) {
+            const size_t mid = r.start + (r.end - r.start) / 2;
+            if (cut > r.start && cut < r.end && !(cut >= mid && cut <= mid + pause)) count++;
+        }
+    }
+    return count;
+}
+
+static void Score(const std::vector<Region>& truth, const std::vector<Region>& detected, size_t n,
+                  double* recall, double* falseRate) {
+    std::vector<uint8_t> isSpeech(n, 0);
+    std::vector<uint8_t> flagged(n, 0);
+    for (const Region& r : truth) std::fill(isSpeech.begin() + r.start, isSpeech.begin() + r.end, 1);
+    for (const Region& r : detected) std::fill(flagged.begin() + r.start, flagged.begin() + std::min(r.end, n), 1);
+    size_t speech = 0, hit = 0, silence = 0, falseHit = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (isSpeech[i]) {
+            speech++;
+            hit += flagged[i];
+        } else {
+            silence++;
+            falseHit += flagged[i];
+        }
+    }
+    *recall = speech ? static_cast<double>(hit) / speech : 0.0;
+    *falseRate = silence ? static_cast<double>(falseHit) / silence : 0.0;
+}
+
+// Utterances from VoiceDetector's start/end events, fed in blocks
+static bool Detect(const vad::VadConfig& config, const std::shared_ptr<const vad::VadModel>& model,
+                   const std::vector<float>& audio, int block, std::vector<Region>* detected) {
+    vad::VoiceDetector detector(config, model);
+    if (!detector.isValid()) {
+        std::fprintf(stderr, "%s\n", detector.error().c_str());
+        return false;
+    }
+    std::vector<vad::VadEvent> events;
+    for (size_t pos = 0; pos < audio.size(); pos += block) {
+        detector.process(audio.data() + pos, std::min<size_t>(block, audio.size() - pos), &events);
+    }
+    detector.flush(&events);
+    for (const vad::VadEvent& event : events) {
+        if (event.type == vad::VadEventType::SpeechStart) {
+            detected->push_back({static_cast<size_t>(event.sample), audio.size()});
+        } else if (!detected->empty()) {
+            detected->back().end = static_cast<size_t>(event.sample);
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    std::shared_ptr<const vad::VadModel> model;
+    if (argc > 1 && std::string(argv[1]) != "-") {
+        std::string error;
+        model = vad::VadModel::load(argv[1], &error);
+        if (!model) {
+            std::fprintf(stderr, "load failed: %s\n", error.c_str());
+            return 1;
+        }
+    }
+    vad::VadConfig config;
+    config.sampleRate = argc > 2 ? std::atoi(argv[2]) : 16000;
+    const int block = config.sampleRate / 50;
+    const int seconds = 60;
+
+    const Scene scenes[] = {
+        {"clean", -26.0f, -200.0f, false},
+        {"fan noise", -26.0f, -45.0f, true},
+        {"loud fan", -30.0f, -38.0f, true},
+        {"quiet speaker", -50.0f, -72.0f, false},
+        {"white noise", -26.0f, -50.0f, false},
+    };
+
+    std::printf("%s scorer, %d Hz, %d s per scene\n\n", model ? "model" : "built-in", config.sampleRate, seconds);
+    std::printf("%-14s %8s %8s %8s %9s %7s | %10s %8s\n", "scene", "recall", "false", "padded", "onset ms",
+                "utts", "rms recall", "false");
+    double totalMs = 0.0;
+    double totalSeconds = 0.0;
+    for (const Scene& scene : scenes) {
+        std::vector<Region> truth;
+        const std::vector<float> audio = MakeScene(scene, config.sampleRate, seconds, &truth);
+
+        std::vector<Region> detected;
+        std::vector<Region> decided;
+        const auto start = std::chrono::steady_clock::now();
+        if (!Detect(config, model, audio, block, &detected)) return 1;
+        totalMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        totalSeconds += seconds;
+        vad::VadConfig unpadded = config;
+        unpadded.endpointer.preRollMs = 0;
+        unpadded.endpointer.postRollMs = 0;
+        if (!Detect(unpadded, model, audio, block, &decided)) return 1;
+
+        double onsetMs = 0.0;
+        for (const Region& r : truth) {
+            double best = 1e9;
+            for (const Region& d : detected) {
+                best = std::min(best, std::fabs(static_cast<double>(d.start) - static_cast<double>(r.start)));
+            }
+            onsetMs += best * 1000.0 / config.sampleRate;
+        }
+        onsetMs /= truth.size();
+
+        // Previous gate: int16 RMS > 10 per 20 ms chunk
+        std::vector<Region> gated;
+        for (size_t pos = 0; pos < audio.size(); pos += block) {
+            const size_t end = std::min<size_t>(pos + block, audio.size());
+            double sum = 0.0;
+            for (size_t i = pos; i < end; i++) {
+                const double s = std::round(std::max(-1.0f, std::min(1.0f, audio[i])) * 32767.0);
+                sum += s * s;
+            }
+            if (std::sqrt(sum / (end - pos)) > 10.0) gated.push_back({pos, end});
+        }
+
+        double recall, falseRate, paddedRecall, paddedFalse, rmsRecall, rmsFalse;
+        Score(truth, decided, audio.size(), &recall, &falseRate);
+        Score(truth, detected, audio.size(), &paddedRecall, &paddedFalse);
+        Score(truth, gated, audio.size(), &rmsRecall, &rmsFalse);
+        std::printf("%-14s %7.1f%% %7.1f%% %7.1f%% %9.0f %3zu/%-3zu | %9.1f%% %7.1f%%\n", scene.name,
+                    recall * 100.0, falseRate * 100.0, paddedFalse * 100.0, onsetMs, detected.size(), truth.size(),
+                    rmsRecall * 100.0, rmsFalse * 100.0);
+    }
+    std::printf("\ncost: %.2f ms per second of audio, %.3f%% of one core\n", totalMs / totalSeconds,
+                totalMs / (totalSeconds * 10.0));
+
+    vad::SegmenterConfig segmenterConfig;
+    segmenterConfig.vad = config;
+    std::printf("\nsegmentation (min %d ms, max %d ms, overlap %d ms)\n\n", segmenterConfig.minDurationMs,
+                segmenterConfig.maxDurationMs, segmenterConfig.overlapMs);
+    std::printf("%-14s %8s %8s %11s | %10s %11s\n", "scene", "segments", "mean s", "cuts in utt",
+                "75-chunk", "cuts in utt");
+    for (const Scene& scene : scenes) {
+        std::vector<Region> truth;
+        const std::vector<float> audio = MakeScene(scene, config.sampleRate, seconds, &truth);
+        std::vector<int16_t> pcm(audio.size());
+        for (size_t i = 0; i < audio.size(); i++) {
+            pcm[i] = static_cast<int16_t>(std::round(std::max(-1.0f, std::min(1.0f, audio[i])) * 32767.0f));
+        }
+
+        vad::Segmenter segmenter(segmenterConfig, model);
+        std::vector<vad::Segment> segments;
+        for (size_t pos = 0; pos < pcm.size(); pos += block) {
+            segmenter.process(pcm.data() + pos, std::min<size_t>(block, pcm.size() - pos), &segments);
+        }
+        segmenter.flush(&segments);
+        std::vector<size_t> cuts;
+        double length = 0.0;
+        for (const vad::Segment& segment : segments) {
+            cuts.push_back(static_cast<size_t>(segment.startSample));
+            cuts.push_back(static_cast<size_t>(segment.endSample));
+            length += static_cast<double>(segment.pcm.size()) / config.sampleRate;
+        }
+
+        // Previous batching: a file every 75 chunks that pass the RMS gate
+        std::vector<size_t> batchCuts;
+        size_t voicedChunks = 0;
+        for (size_t pos = 0; pos < pcm.size(); pos += block) {
+            const size_t end = std::min<size_t>(pos + block, pcm.size());
+            double sum = 0.0;
+            for (size_t i = pos; i < end; i++) sum += static_cast<double>(pcm[i]) * pcm[i];
+            if (std::sqrt(sum / (end - pos)) > 10.0 && ++voicedChunks % 75 == 0) batchCuts.push_back(end);
+        }
+
+        std::printf("%-14s %8zu %8.2f %11zu | %10zu %11zu\n", scene.name, segments.size(),
+                    segments.empty() ? 0.0 : length / segments.size(), CutsInSpeech(truth, cuts, config.sampleRate),
+                    batchCuts.size(), CutsInSpeech(truth, batchCuts, config.sampleRate));
+    }
+
+    segmenterConfig.maxGapMs = 300;
+    std::printf("\nsilence compaction (max gap %d ms)\n\n", segmenterConfig.maxGapMs);
+    std::printf("%-14s %10s %10s %12s %8s\n", "scene", "segment s", "upload s", "voiced kept", "remap");
+    bool exact = true;
+    for (const Scene& scene : scenes) {
+        std::vector<Region> truth;
+        std::vector<uint8_t> voiced;
+        const std::vector<float> audio = MakeScene(scene, config.sampleRate, seconds, &truth, kReplies, &voiced);
+        std::vector<int16_t> pcm(audio.size());
+        for (size_t i = 0; i < audio.size(); i++) {
+            pcm[i] = static_cast<int16_t>(std::round(std::max(-1.0f, std::min(1.0f, audio[i])) * 32767.0f));
+        }
+
+        vad::Segmenter segmenter(segmenterConfig, model);
+        std::vector<vad::Segment> segments;
+        for (size_t pos = 0; pos < pcm.size(); pos += block) {
+            segmenter.process(pcm.data() + pos, std::min<size_t>(block, pcm.size() - pos), &segments);
+        }
+        segmenter.flush(&segments);
+
+        // Which original samples reach the upload, and do they map back?
+        std::vector<uint8_t> uploaded(pcm.size(), 0);
+        size_t original = 0, compacted = 0, mismatches = 0;
+        for (const vad::Segment& segment : segments) {
+            original += static_cast<size_t>(segment.endSample - segment.startSample);
+            compacted += segment.pcm.size();
+            for (size_t i = 0; i < segment.pcm.size(); i++) {
+                const size_t at = static_cast<size_t>(segment.startSample + vad::remapSample(segment.remap, i));
+                uploaded[at] = 1;
+                // Fades only scale samples toward zero
+                if (std::abs(segment.pcm[i]) > std::abs(pcm[at])) mismatches++;
+                if (segment.pcm[i] != pcm[at] && segment.pcm[i] * pcm[at] < 0) mismatches++;
+            }
+        }
+        size_t speech = 0, kept = 0;
+        for (size_t i = 0; i < pcm.size(); i++) {
+            speech += voiced[i];
+            kept += voiced[i] & uploaded[i];
+        }
+        exact = exact && mismatches == 0;
+        std::printf("%-14s %10.1f %10.1f %11.1f%% %8s\n", scene.name,
+                    static_cast<double>(original) / config.sampleRate,
+                    static_cast<double>(compacted) / config.sampleRate, 100.0 * kept / speech,
+                    mismatches == 0 ? "exact" : "WRONG");
+    }
+    return exact ? 0 : 1;
+}
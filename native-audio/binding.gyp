@@ -1,4 +1,14 @@
 {
+  "variables": {
+    "build_benchmarks%": 0,
+    "rt_checks%": 0,
+    "with_opus%": "<!(node -p \"require('child_process').spawnSync('pkg-config', ['--exists', 'opus']).status === 0 ? 1 : 0\")",
+    "opus_root%": "C:/vcpkg/installed/x64-windows",
+    "with_curl%": "<!(node -p \"require('child_process').spawnSync('pkg-config', ['--exists', 'libcurl']).status === 0 ? 1 : 0\")",
+    "curl_root%": "C:/vcpkg/installed/x64-windows",
+    "with_gbench%": "<!(node -p \"require('child_process').spawnSync('pkg-config', ['--exists', 'benchmark']).status === 0 ? 1 : 0\")",
+    "gbench_root%": "C:/vcpkg/installed/x64-windows"
+  },
   "targets": [
     {
       "target_name": "speaker_audio_capture",
@@ -12,9 +22,17 @@
       "cflags_cc!": [ "-fno-exceptions" ],
       "defines": [ "NAPI_DISABLE_CPP_EXCEPTIONS" ],
       "conditions": [
+        ["rt_checks==1", {
+          "defines": [ "AUDIO_RT_CHECKS" ]
+        }],
         ["OS=='mac'", {
           "sources": [
-            "src/speaker_audio_capture.mm"
+            "src/speaker_audio_capture.mm",
+            "src/capture/capture_delivery.cpp",
+            "src/capture/latency_histogram.cpp",
+            "src/capture/realtime_check.cpp",
+            "src/capture/sample_format.cpp",
+            "src/trace/trace.cpp"
           ],
           "xcode_settings": {
             "GCC_ENABLE_CPP_EXCEPTIONS": "YES",
@@ -42,7 +60,12 @@
         }],
         ["OS=='win'", {
           "sources": [
-            "src/speaker_audio_capture_win.cpp"
+            "src/speaker_audio_capture_win.cpp",
+            "src/capture/capture_delivery.cpp",
+            "src/capture/latency_histogram.cpp",
+            "src/capture/realtime_check.cpp",
+            "src/capture/sample_format.cpp",
+            "src/trace/trace.cpp"
           ],
           "msvs_settings": {
             "VCCLCompilerTool": {
@@ -63,10 +86,12 @@
       "target_name": "rnnoise",
       "include_dirs": [
         "<!@(node -p \"require('node-addon-api').include\")",
+        "src",
         "src/rnnoise"
       ],
       "dependencies": [
-        "<!(node -p \"require('node-addon-api').gyp\")"
+        "<!(node -p \"require('node-addon-api').gyp\")",
+        "audio_dsp"
       ],
       "cflags!": [ "-fno-exceptions" ],
       "cflags_cc!": [ "-fno-exceptions" ],
@@ -74,7 +99,9 @@
       "conditions": [
         ["OS=='mac'", {
           "sources": [
-            "src/microphone_rnnoise.cpp"
+            "src/microphone_rnnoise.cpp",
+            "src/capture/latency_histogram.cpp",
+            "src/trace/trace.cpp"
           ],
           "xcode_settings": {
             "GCC_ENABLE_CPP_EXCEPTIONS": "YES",
@@ -87,7 +114,937 @@
           }
         }]
       ]
+    },
+    {
+      "target_name": "audio_storage",
+      "sources": [
+        "src/audio_storage.cpp",
+        "src/storage/capture_spool.cpp",
+        "src/storage/checksum.cpp",
+        "src/storage/file_util.cpp",
+        "src/storage/flac_encoder.cpp",
+        "src/storage/mapped_file.cpp",
+        "src/storage/segment_store.cpp",
+        "src/storage/segment_writer.cpp"
+      ],
+      "include_dirs": [
+        "<!@(node -p \"require('node-addon-api').include\")",
+        "src"
+      ],
+      "dependencies": [
+        "<!(node -p \"require('node-addon-api').gyp\")"
+      ],
+      "cflags!": [ "-fno-exceptions" ],
+      "cflags_cc!": [ "-fno-exceptions" ],
+      "defines": [ "NAPI_DISABLE_CPP_EXCEPTIONS" ],
+      "conditions": [
+        ["OS=='mac'", {
+          "xcode_settings": {
+            "GCC_ENABLE_CPP_EXCEPTIONS": "YES",
+            "CLANG_CXX_LIBRARY": "libc++",
+            "MACOSX_DEPLOYMENT_TARGET": "13.0",
+            "OTHER_CPLUSPLUSFLAGS": [
+              "-std=c++17"
+            ],
+            "ENABLE_HARDENED_RUNTIME": "YES"
+          }
+        }],
+        ["OS=='win'", {
+          "msvs_settings": {
+            "VCCLCompilerTool": {
+              "ExceptionHandling": 1,
+              "AdditionalOptions": [
+                "/std:c++17"
+              ]
+            }
+          }
+        }]
+      ]
+    },
+    {
+      "target_name": "voice_activity",
+      "sources": [
+        "src/voice_activity.cpp",
+        "src/asr/fft.cpp",
+        "src/asr/mel_frontend.cpp",
+        "src/storage/checksum.cpp",
+        "src/storage/file_util.cpp",
+        "src/storage/mapped_file.cpp",
+        "src/storage/tensor_file.cpp",
+        "src/vad/endpointer.cpp",
+        "src/vad/segmenter.cpp",
+        "src/vad/silence_compactor.cpp",
+        "src/vad/vad_model.cpp",
+        "src/vad/voice_detector.cpp"
+      ],
+      "include_dirs": [
+        "<!@(node -p \"require('node-addon-api').include\")",
+        "src"
+      ],
+      "dependencies": [
+        "<!(node -p \"require('node-addon-api').gyp\")"
+      ],
+      "cflags!": [ "-fno-exceptions" ],
+      "cflags_cc!": [ "-fno-exceptions" ],
+      "defines": [ "NAPI_DISABLE_CPP_EXCEPTIONS" ],
+      "conditions": [
+        ["OS=='mac'", {
+          "xcode_settings": {
+            "GCC_ENABLE_CPP_EXCEPTIONS": "YES",
+            "CLANG_CXX_LIBRARY": "libc++",
+            "MACOSX_DEPLOYMENT_TARGET": "13.0",
+            "OTHER_CPLUSPLUSFLAGS": [
+              "-std=c++17"
+            ],
+            "ENABLE_HARDENED_RUNTIME": "YES"
+          }
+        }],
+        ["OS=='win'", {
+          "msvs_settings": {
+            "VCCLCompilerTool": {
+              "ExceptionHandling": 1,
+              "AdditionalOptions": [
+                "/std:c++17"
+              ]
+            }
+          }
+        }]
+      ]
+    },
+    {
+      "target_name": "quant_gemm",
+      "type": "static_library",
+      "sources": [
+        "src/quant/gemm.cpp",
+        "src/quant/gemm_avx2.cpp",
+        "src/quant/gemm_avx512.cpp",
+        "src/quant/gemm_avxvnni.cpp",
+        "src/quant/quantize.cpp"
+      ],
+      "include_dirs": [
+        "src"
+      ],
+      "direct_dependent_settings": {
+        "include_dirs": [
+          "src"
+        ]
+      },
+      "conditions": [
+        ["OS=='linux'", {
+          "cflags": [ "-fPIC" ]
+        }],
+        ["OS=='mac'", {
+          "xcode_settings": {
+            "CLANG_CXX_LIBRARY": "libc++",
+            "MACOSX_DEPLOYMENT_TARGET": "13.0",
+            "OTHER_CPLUSPLUSFLAGS": [
+              "-std=c++17"
+            ]
+          }
+        }],
+        ["OS=='win'", {
+          "msvs_settings": {
+            "VCCLCompilerTool": {
+              "AdditionalOptions": [
+                "/std:c++17"
+              ]
+            }
+          }
+        }]
+      ]
+    },
+    {
+      "target_name": "audio_dsp",
+      "type": "static_library",
+      "sources": [
+        "src/dsp/audio_dsp.cpp",
+        "src/dsp/loudness.cpp",
+        "src/dsp/noise_reduction.cpp",
+        "src/dsp/resampler.cpp",
+        "src/dsp/wav_file.cpp"
+      ],
+      "include_dirs": [
+        "src"
+      ],
+      "direct_dependent_settings": {
+        "include_dirs": [
+          "src"
+        ]
+      },
+      "conditions": [
+        ["OS=='linux'", {
+          "cflags": [ "-fPIC" ]
+        }],
+        ["OS=='mac'", {
+          "xcode_settings": {
+            "CLANG_CXX_LIBRARY": "libc++",
+            "MACOSX_DEPLOYMENT_TARGET": "13.0",
+            "OTHER_CPLUSPLUSFLAGS": [
+              "-std=c++17"
+            ]
+          }
+        }],
+        ["OS=='win'", {
+          "defines": [ "_USE_MATH_DEFINES" ],
+          "msvs_settings": {
+            "VCCLCompilerTool": {
+              "AdditionalOptions": [
+                "/std:c++17"
+              ]
+            }
+          }
+        }]
+      ]
+    },
+    {
+      "target_name": "audio_batch",
+      "type": "executable",
+      "sources": [
+        "tools/audio_batch.cpp",
+        "src/asr/fft.cpp",
+        "src/asr/mel_frontend.cpp",
+        "src/batch/audio_chain.cpp",
+        "src/batch/file_scheduler.cpp",
+        "src/storage/checksum.cpp",
+        "src/storage/file_util.cpp",
+        "src/storage/mapped_file.cpp",
+        "src/storage/tensor_file.cpp",
+        "src/vad/endpointer.cpp",
+        "src/vad/segmenter.cpp",
+        "src/vad/silence_compactor.cpp",
+        "src/vad/vad_model.cpp",
+        "src/vad/voice_detector.cpp"
+      ],
+      "include_dirs": [
+        "src"
+      ],
+      "dependencies": [
+        "audio_dsp"
+      ],
+      "cflags!": [ "-fno-exceptions" ],
+      "cflags_cc!": [ "-fno-exceptions" ],
+      "conditions": [
+        ["OS=='mac'", {
+          "xcode_settings": {
+            "GCC_ENABLE_CPP_EXCEPTIONS": "YES",
+            "CLANG_CXX_LIBRARY": "libc++",
+            "MACOSX_DEPLOYMENT_TARGET": "13.0",
+            "OTHER_CPLUSPLUSFLAGS": [
+              "-std=c++17"
+            ]
+          }
+        }],
+        ["OS=='win'", {
+          "defines": [ "_USE_MATH_DEFINES" ],
+          "msvs_settings": {
+            "VCCLCompilerTool": {
+              "ExceptionHandling": 1,
+              "AdditionalOptions": [
+                "/std:c++17"
+              ]
+            }
+          }
+        }]
+      ]
+    },
+    {
+      "target_name": "local_asr",
+      "sources": [
+        "src/local_asr.cpp",
+        "src/asr/fft.cpp",
+        "src/asr/language_id.cpp",
+        "src/asr/mel_frontend.cpp",
+        "src/asr/tensor_ops.cpp",
+        "src/asr/thread_pool.cpp",
+        "src/asr/whisper_engine.cpp",
+        "src/asr/whisper_mel.cpp",
+        "src/asr/whisper_model.cpp",
+        "src/asr/whisper_stream.cpp",
+        "src/storage/checksum.cpp",
+        "src/storage/file_util.cpp",
+        "src/storage/mapped_file.cpp",
+        "src/storage/tensor_file.cpp"
+      ],
+      "include_dirs": [
+        "<!@(node -p \"require('node-addon-api').include\")",
+        "src"
+      ],
+      "dependencies": [
+        "<!(node -p \"require('node-addon-api').gyp\")",
+        "quant_gemm"
+      ],
+      "cflags!": [ "-fno-exceptions" ],
+      "cflags_cc!": [ "-fno-exceptions" ],
+      "defines": [ "NAPI_DISABLE_CPP_EXCEPTIONS" ],
+      "conditions": [
+        ["OS=='mac'", {
+          "xcode_settings": {
+            "GCC_ENABLE_CPP_EXCEPTIONS": "YES",
+            "CLANG_CXX_LIBRARY": "libc++",
+            "MACOSX_DEPLOYMENT_TARGET": "13.0",
+            "OTHER_CPLUSPLUSFLAGS": [
+              "-std=c++17"
+            ],
+            "ENABLE_HARDENED_RUNTIME": "YES"
+          }
+        }],
+        ["OS=='win'", {
+          "msvs_settings": {
+            "VCCLCompilerTool": {
+              "ExceptionHandling": 1,
+              "AdditionalOptions": [
+                "/std:c++17"
+              ]
+            }
+          }
+        }]
+      ]
     }
+  ],
+  "conditions": [
+    ["build_benchmarks==1", {
+      "targets": [
+        {
+          "target_name": "asr_rtf_bench",
+          "type": "executable",
+          "sources": [
+            "bench/asr_rtf_bench.cpp",
+            "src/asr/fft.cpp",
+            "src/asr/mel_frontend.cpp",
+            "src/asr/tensor_ops.cpp",
+            "src/asr/thread_pool.cpp",
+            "src/asr/whisper_engine.cpp",
+            "src/asr/whisper_mel.cpp",
+            "src/asr/whisper_model.cpp",
+            "src/storage/checksum.cpp",
+            "src/storage/file_util.cpp",
+            "src/storage/mapped_file.cpp",
+            "src/storage/tensor_file.cpp"
+          ],
+          "include_dirs": [
+            "src"
+          ],
+          "dependencies": [
+            "quant_gemm"
+          ],
+          "conditions": [
+            ["OS=='mac'", {
+              "xcode_settings": {
+                "CLANG_CXX_LIBRARY": "libc++",
+                "MACOSX_DEPLOYMENT_TARGET": "13.0",
+                "OTHER_CPLUSPLUSFLAGS": [
+                  "-std=c++17"
+                ]
+              }
+            }],
+            ["OS=='win'", {
+              "defines": [ "_USE_MATH_DEFINES" ],
+              "msvs_settings": {
+                "VCCLCompilerTool": {
+                  "AdditionalOptions": [
+                    "/std:c++17"
+                  ]
+                }
+              }
+            }]
+          ]
+        },
+        {
+          "target_name": "asr_stream_bench",
+          "type": "executable",
+          "sources": [
+            "bench/asr_stream_bench.cpp",
+            "src/asr/fft.cpp",
+            "src/asr/mel_frontend.cpp",
+            "src/asr/tensor_ops.cpp",
+            "src/asr/thread_pool.cpp",
+            "src/asr/whisper_engine.cpp",
+            "src/asr/whisper_mel.cpp",
+            "src/asr/whisper_model.cpp",
+            "src/asr/whisper_stream.cpp",
+            "src/storage/checksum.cpp",
+            "src/storage/file_util.cpp",
+            "src/storage/mapped_file.cpp",
+            "src/storage/tensor_file.cpp"
+          ],
+          "include_dirs": [
+            "src"
+          ],
+          "dependencies": [
+            "quant_gemm"
+          ],
+          "conditions": [
+            ["OS=='mac'", {
+              "xcode_settings": {
+                "CLANG_CXX_LIBRARY": "libc++",
+                "MACOSX_DEPLOYMENT_TARGET": "13.0",
+                "OTHER_CPLUSPLUSFLAGS": [
+                  "-std=c++17"
+                ]
+              }
+            }],
+            ["OS=='win'", {
+              "defines": [ "_USE_MATH_DEFINES" ],
+              "msvs_settings": {
+                "VCCLCompilerTool": {
+                  "AdditionalOptions": [
+                    "/std:c++17"
+                  ]
+                }
+              }
+            }]
+          ]
+        },
+        {
+          "target_name": "lid_bench",
+          "type": "executable",
+          "sources": [
+            "bench/lid_bench.cpp",
+            "src/asr/fft.cpp",
+            "src/asr/language_id.cpp",
+            "src/asr/mel_frontend.cpp",
+            "src/asr/tensor_ops.cpp",
+            "src/asr/thread_pool.cpp",
+            "src/storage/checksum.cpp",
+            "src/storage/file_util.cpp",
+            "src/storage/mapped_file.cpp",
+            "src/storage/tensor_file.cpp"
+          ],
+          "include_dirs": [
+            "src"
+          ],
+          "dependencies": [
+            "quant_gemm"
+          ],
+          "conditions": [
+            ["OS=='mac'", {
+              "xcode_settings": {
+                "CLANG_CXX_LIBRARY": "libc++",
+                "MACOSX_DEPLOYMENT_TARGET": "13.0",
+                "OTHER_CPLUSPLUSFLAGS": [
+                  "-std=c++17"
+                ]
+              }
+            }],
+            ["OS=='win'", {
+              "defines": [ "_USE_MATH_DEFINES" ],
+              "msvs_settings": {
+                "VCCLCompilerTool": {
+                  "AdditionalOptions": [
+                    "/std:c++17"
+                  ]
+                }
+              }
+            }]
+          ]
+        },
+        {
+          "target_name": "vad_bench",
+          "type": "executable",
+          "sources": [
+            "bench/vad_bench.cpp",
+            "src/asr/fft.cpp",
+            "src/asr/mel_frontend.cpp",
+            "src/storage/checksum.cpp",
+            "src/storage/file_util.cpp",
+            "src/storage/mapped_file.cpp",
+            "src/storage/tensor_file.cpp",
+            "src/vad/endpointer.cpp",
+            "src/vad/segmenter.cpp",
+            "src/vad/silence_compactor.cpp",
+            "src/vad/vad_model.cpp",
+            "src/vad/voice_detector.cpp"
+          ],
+          "include_dirs": [
+            "src"
+          ],
+          "conditions": [
+            ["OS=='mac'", {
+              "xcode_settings": {
+                "CLANG_CXX_LIBRARY": "libc++",
+                "MACOSX_DEPLOYMENT_TARGET": "13.0",
+                "OTHER_CPLUSPLUSFLAGS": [
+                  "-std=c++17"
+                ]
+              }
+            }],
+            ["OS=='win'", {
+              "defines": [ "_USE_MATH_DEFINES" ],
+              "msvs_settings": {
+                "VCCLCompilerTool": {
+                  "AdditionalOptions": [
+                    "/std:c++17"
+                  ]
+                }
+              }
+            }]
+          ]
+        },
+        {
+          "target_name": "quant_gemm_bench",
+          "type": "executable",
+          "sources": [
+            "bench/quant_gemm_bench.cpp",
+            "src/asr/tensor_ops.cpp",
+            "src/asr/thread_pool.cpp"
+          ],
+          "include_dirs": [
+            "src"
+          ],
+          "dependencies": [
+            "quant_gemm"
+          ],
+          "conditions": [
+            ["OS=='mac'", {
+              "xcode_settings": {
+                "CLANG_CXX_LIBRARY": "libc++",
+                "MACOSX_DEPLOYMENT_TARGET": "13.0",
+                "OTHER_CPLUSPLUSFLAGS": [
+                  "-std=c++17"
+                ]
+              }
+            }],
+            ["OS=='win'", {
+              "msvs_settings": {
+                "VCCLCompilerTool": {
+                  "AdditionalOptions": [
+                    "/std:c++17"
+                  ]
+                }
+              }
+            }]
+          ]
+        },
+        {
+          "target_name": "dsp_bench",
+          "type": "executable",
+          "sources": [
+            "bench/dsp_bench.cpp"
+          ],
+          "dependencies": [
+            "audio_dsp"
+          ],
+          "conditions": [
+            ["OS=='mac'", {
+              "xcode_settings": {
+                "CLANG_CXX_LIBRARY": "libc++",
+                "MACOSX_DEPLOYMENT_TARGET": "13.0",
+                "OTHER_CPLUSPLUSFLAGS": [
+                  "-std=c++17"
+                ]
+              }
+            }],
+            ["OS=='win'", {
+              "defines": [ "_USE_MATH_DEFINES" ],
+              "msvs_settings": {
+                "VCCLCompilerTool": {
+                  "AdditionalOptions": [
+                    "/std:c++17"
+                  ]
+                }
+              }
+            }]
+          ]
+        },
+        {
+          "target_name": "rt_safety_check",
+          "type": "executable",
+          "sources": [
+            "bench/rt_safety_check.cpp",
+            "src/capture/capture_delivery.cpp",
+            "src/capture/realtime_check.cpp",
+            "src/capture/sample_format.cpp",
+            "src/trace/trace.cpp"
+          ],
+          "include_dirs": [
+            "src"
+          ],
+          "defines": [ "AUDIO_RT_CHECKS" ],
+          "dependencies": [
+            "audio_dsp"
+          ],
+          "conditions": [
+            ["OS=='linux'", {
+              "libraries": [ "-ldl", "-lpthread" ]
+            }],
+            ["OS=='mac'", {
+              "xcode_settings": {
+                "CLANG_CXX_LIBRARY": "libc++",
+                "MACOSX_DEPLOYMENT_TARGET": "13.0",
+                "OTHER_CPLUSPLUSFLAGS": [
+                  "-std=c++17"
+                ]
+              }
+            }],
+            ["OS=='win'", {
+              "msvs_settings": {
+                "VCCLCompilerTool": {
+                  "AdditionalOptions": [
+                    "/std:c++17"
+                  ]
+                }
+              }
+            }]
+          ]
+        },
+        {
+          "target_name": "pipeline_rtf_bench",
+          "type": "executable",
+          "sources": [
+            "bench/pipeline_rtf_bench.cpp",
+            "src/asr/fft.cpp",
+            "src/asr/mel_frontend.cpp",
+            "src/capture/capture_delivery.cpp",
+            "src/capture/sample_format.cpp",
+            "src/storage/checksum.cpp",
+            "src/storage/file_util.cpp",
+            "src/storage/flac_encoder.cpp",
+            "src/storage/mapped_file.cpp",
+            "src/storage/tensor_file.cpp",
+            "src/vad/endpointer.cpp",
+            "src/vad/segmenter.cpp",
+            "src/vad/silence_compactor.cpp",
+            "src/vad/vad_model.cpp",
+            "src/vad/voice_detector.cpp"
+          ],
+          "include_dirs": [
+            "src"
+          ],
+          "dependencies": [
+            "audio_dsp"
+          ],
+          "cflags!": [ "-fno-exceptions" ],
+          "cflags_cc!": [ "-fno-exceptions" ],
+          "conditions": [
+            ["with_opus==1", {
+              "defines": [ "HAVE_OPUS" ],
+              "sources": [
+                "src/codec/ogg_opus_encoder.cpp"
+              ]
+            }],
+            ["with_opus==1 and OS!='win'", {
+              "include_dirs": [
+                "<!@(pkg-config --cflags-only-I opus | sed -e 's/-I//g')"
+              ],
+              "libraries": [
+                "<!@(pkg-config --libs opus)"
+              ]
+            }],
+            ["with_opus==1 and OS=='win'", {
+              "include_dirs": [
+                "<(opus_root)/include/opus"
+              ],
+              "libraries": [
+                "<(opus_root)/lib/opus.lib"
+              ]
+            }],
+            ["OS=='mac'", {
+              "xcode_settings": {
+                "GCC_ENABLE_CPP_EXCEPTIONS": "YES",
+                "CLANG_CXX_LIBRARY": "libc++",
+                "MACOSX_DEPLOYMENT_TARGET": "13.0",
+                "OTHER_CPLUSPLUSFLAGS": [
+                  "-std=c++17"
+                ]
+              }
+            }],
+            ["OS=='win'", {
+              "defines": [ "_USE_MATH_DEFINES" ],
+              "libraries": [
+                "psapi.lib"
+              ],
+              "msvs_settings": {
+                "VCCLCompilerTool": {
+                  "ExceptionHandling": 1,
+                  "AdditionalOptions": [
+                    "/std:c++17"
+                  ]
+                }
+              }
+            }]
+          ]
+        },
+        {
+          "target_name": "mel_frontend_bench",
+          "type": "executable",
+          "sources": [
+            "bench/mel_frontend_bench.cpp",
+            "src/asr/fft.cpp",
+            "src/asr/mel_frontend.cpp"
+          ],
+          "include_dirs": [
+            "src"
+          ],
+          "conditions": [
+            ["OS=='mac'", {
+              "xcode_settings": {
+                "CLANG_CXX_LIBRARY": "libc++",
+                "MACOSX_DEPLOYMENT_TARGET": "13.0",
+                "OTHER_CPLUSPLUSFLAGS": [
+                  "-std=c++17"
+                ]
+              }
+            }],
+            ["OS=='win'", {
+              "defines": [ "_USE_MATH_DEFINES" ],
+              "msvs_settings": {
+                "VCCLCompilerTool": {
+                  "AdditionalOptions": [
+                    "/std:c++17"
+                  ]
+                }
+              }
+            }]
+          ]
+        }
+      ]
+    }],
+    ["with_opus==1", {
+      "targets": [
+        {
+          "target_name": "opus_encoder",
+          "sources": [
+            "src/opus_encoder.cpp",
+            "src/codec/ogg_opus_encoder.cpp"
+          ],
+          "include_dirs": [
+            "<!@(node -p \"require('node-addon-api').include\")",
+            "src"
+          ],
+          "dependencies": [
+            "<!(node -p \"require('node-addon-api').gyp\")"
+          ],
+          "cflags!": [ "-fno-exceptions" ],
+          "cflags_cc!": [ "-fno-exceptions" ],
+          "defines": [ "NAPI_DISABLE_CPP_EXCEPTIONS" ],
+          "conditions": [
+            ["OS!='win'", {
+              "include_dirs": [
+                "<!@(pkg-config --cflags-only-I opus | sed -e 's/-I//g')"
+              ],
+              "libraries": [
+                "<!@(pkg-config --libs opus)"
+              ]
+            }],
+            ["OS=='mac'", {
+              "xcode_settings": {
+                "GCC_ENABLE_CPP_EXCEPTIONS": "YES",
+                "CLANG_CXX_LIBRARY": "libc++",
+                "MACOSX_DEPLOYMENT_TARGET": "13.0",
+                "OTHER_CPLUSPLUSFLAGS": [
+                  "-std=c++17"
+                ],
+                "ENABLE_HARDENED_RUNTIME": "YES"
+              }
+            }],
+            ["OS=='win'", {
+              "include_dirs": [
+                "<(opus_root)/include/opus"
+              ],
+              "libraries": [
+                "<(opus_root)/lib/opus.lib"
+              ],
+              "msvs_settings": {
+                "VCCLCompilerTool": {
+                  "ExceptionHandling": 1,
+                  "AdditionalOptions": [
+                    "/std:c++17"
+                  ]
+                }
+              }
+            }]
+          ]
+        }
+      ]
+    }],
+    ["with_opus==1 and build_benchmarks==1", {
+      "targets": [
+        {
+          "target_name": "opus_encoder_bench",
+          "type": "executable",
+          "sources": [
+            "bench/opus_encoder_bench.cpp",
+            "src/codec/ogg_opus_encoder.cpp"
+          ],
+          "include_dirs": [
+            "src"
+          ],
+          "conditions": [
+            ["OS!='win'", {
+              "include_dirs": [
+                "<!@(pkg-config --cflags-only-I opus | sed -e 's/-I//g')"
+              ],
+              "libraries": [
+                "<!@(pkg-config --libs opus)"
+              ]
+            }],
+            ["OS=='mac'", {
+              "xcode_settings": {
+                "CLANG_CXX_LIBRARY": "libc++",
+                "MACOSX_DEPLOYMENT_TARGET": "13.0",
+                "OTHER_CPLUSPLUSFLAGS": [
+                  "-std=c++17"
+                ]
+              }
+            }],
+            ["OS=='win'", {
+              "include_dirs": [
+                "<(opus_root)/include/opus"
+              ],
+              "libraries": [
+                "<(opus_root)/lib/opus.lib"
+              ]
+            }]
+          ]
+        }
+      ]
+    }],
+    ["with_curl==1", {
+      "targets": [
+        {
+          "target_name": "http_uploader",
+          "sources": [
+            "src/http_uploader.cpp",
+            "src/net/http_uploader.cpp",
+            "src/net/upload_scheduler.cpp"
+          ],
+          "include_dirs": [
+            "<!@(node -p \"require('node-addon-api').include\")",
+            "src"
+          ],
+          "dependencies": [
+            "<!(node -p \"require('node-addon-api').gyp\")"
+          ],
+          "cflags!": [ "-fno-exceptions" ],
+          "cflags_cc!": [ "-fno-exceptions" ],
+          "defines": [ "NAPI_DISABLE_CPP_EXCEPTIONS" ],
+          "conditions": [
+            ["OS!='win'", {
+              "include_dirs": [
+                "<!@(pkg-config --cflags-only-I libcurl | sed -e 's/-I//g')"
+              ],
+              "libraries": [
+                "<!@(pkg-config --libs libcurl)"
+              ]
+            }],
+            ["OS=='mac'", {
+              "xcode_settings": {
+                "GCC_ENABLE_CPP_EXCEPTIONS": "YES",
+                "CLANG_CXX_LIBRARY": "libc++",
+                "MACOSX_DEPLOYMENT_TARGET": "13.0",
+                "OTHER_CPLUSPLUSFLAGS": [
+                  "-std=c++17"
+                ],
+                "ENABLE_HARDENED_RUNTIME": "YES"
+              }
+            }],
+            ["OS=='win'", {
+              "include_dirs": [
+                "<(curl_root)/include"
+              ],
+              "libraries": [
+                "<(curl_root)/lib/libcurl.lib"
+              ],
+              "msvs_settings": {
+                "VCCLCompilerTool": {
+                  "ExceptionHandling": 1,
+                  "AdditionalOptions": [
+                    "/std:c++17"
+                  ]
+                }
+              }
+            }]
+          ]
+        }
+      ]
+    }],
+    ["with_gbench==1 and build_benchmarks==1", {
+      "targets": [
+        {
+          "target_name": "hot_paths_bench",
+          "type": "executable",
+          "sources": [
+            "bench/hot_paths_bench.cpp",
+            "src/capture/capture_delivery.cpp",
+            "src/capture/latency_histogram.cpp",
+            "src/capture/sample_format.cpp",
+            "src/trace/trace.cpp"
+          ],
+          "include_dirs": [
+            "src"
+          ],
+          "dependencies": [
+            "audio_dsp"
+          ],
+          "conditions": [
+            ["OS!='win'", {
+              "include_dirs": [
+                "<!@(pkg-config --cflags-only-I benchmark | sed -e 's/-I//g')"
+              ],
+              "libraries": [
+                "<!@(pkg-config --libs benchmark)"
+              ]
+            }],
+            ["OS=='mac'", {
+              "xcode_settings": {
+                "CLANG_CXX_LIBRARY": "libc++",
+                "MACOSX_DEPLOYMENT_TARGET": "13.0",
+                "OTHER_CPLUSPLUSFLAGS": [
+                  "-std=c++17"
+                ]
+              }
+            }],
+            ["OS=='win'", {
+              "defines": [ "_USE_MATH_DEFINES" ],
+              "include_dirs": [
+                "<(gbench_root)/include"
+              ],
+              "libraries": [
+                "<(gbench_root)/lib/benchmark.lib",
+                "shlwapi.lib"
+              ],
+              "msvs_settings": {
+                "VCCLCompilerTool": {
+                  "AdditionalOptions": [
+                    "/std:c++17"
+                  ]
+                }
+              }
+            }]
+          ]
+        }
+      ]
+    }],
+    ["with_curl==1 and build_benchmarks==1 and OS!='win'", {
+      "targets": [
+        {
+          "target_name": "http_uploader_bench",
+          "type": "executable",
+          "sources": [
+            "bench/http_uploader_bench.cpp",
+            "src/net/http_uploader.cpp",
+            "src/net/upload_scheduler.cpp"
+          ],
+          "include_dirs": [
+            "src",
+            "<!@(pkg-config --cflags-only-I libcurl | sed -e 's/-I//g')"
+          ],
+          "libraries": [
+            "<!@(pkg-config --libs libcurl)"
+          ],
+          "conditions": [
+            ["OS=='mac'", {
+              "xcode_settings": {
+                "CLANG_CXX_LIBRARY": "libc++",
+                "MACOSX_DEPLOYMENT_TARGET": "13.0",
+                "OTHER_CPLUSPLUSFLAGS": [
+                  "-std=c++17"
+                ]
+              }
+            }]
+          ]
+        }
+      ]
+    }]
   ]
 }
-
@@ -0,0 +1,162 @@
+// JavaScript wrapper for the native keep-alive HTTP uploader
+let uploaderModule = null;
+
+try {
+  uploaderModule = require("./build/Release/http_uploader.node");
+} catch (error) {
+  console.warn("⚠️ HTTP uploader module not available:", error.message);
+  console.warn("   Uploads will use one https.request per segment");
+  console.warn("   To build it, install libcurl (brew install curl) and run: cd native-audio && npm run rebuild");
+}
+
+class HttpUploader {
+  /**
+   * Connection-pooled POST client. Requests to the same host share
+   * keep-alive connections (multiplexed over HTTP/2 when the server offers it).
+   * @param {Object} [options]
+   * @param {number} [options.maxConcurrent=4] - Requests in flight; the rest queue in order
+   * @param {number} [options.maxHostConnections=2] - Connections per host
+   * @param {boolean} [options.http2=true] - Negotiate HTTP/2 over TLS
+   * @param {boolean} [options.reuseConnections=true] - false opens a connection per request
+   * @param {number} [options.connectTimeoutMs=10000]
+   * @param {number} [options.timeoutMs=60000] - Per attempt
+   * @param {number} [options.maxRetries=3] - For transport errors, 408, 429 and 5xx
+   * @param {number} [options.backoffBaseMs=250] - Full-jitter exponential backoff base
+   * @param {number} [options.backoffMaxMs=8000] - Backoff cap (Retry-After included)
+   * @param {number} [options.idleTimeoutMs=118000] - Pooled connections idle longer are closed
+   */
+  constructor(options = {}) {
+    this.options = options;
+    this.uploader = uploaderModule ? new uploaderModule.HttpUploader(options) : null;
+  }
+
+  /**
+   * Check if the native uploader is available
+   * @returns {boolean} True if the module is loaded
+   */
+  isAvailable() {
+    return this.uploader !== null;
+  }
+
+  /**
+   * POST a body. Buffers and typed arrays are sent from their own memory and
+   * must not be modified until the promise settles.
+   * @param {Object} request
+   * @param {string} request.url - http:// or https:// URL
+   * @param {Object<string, string|number>} [request.headers]
+   * @param {Buffer|TypedArray|ArrayBuffer|string} [request.body]
+   * @param {number} [request.timeoutMs] - Overrides options.timeoutMs
+   * @returns {Promise<{status: number, body: string, attempts: number, reused: boolean,
+   *           httpVersion: number, timings: {queuedMs: number, connectMs: number,
+   *           tlsMs: number, firstByteMs: number, totalMs: number}}>}
+   *   Any HTTP status resolves (after retries); transport failures reject with
+   *   an Error whose code is a Node socket error name (ECONNREFUSED, ETIMEDOUT, ...)
+   */
+  post(request) {
+    return this.uploader.post(request);
+  }
+
+  /**
+   * POST and parse a JSON response
+   * @param {Object} request - As for post()
+   * @returns {Promise<{statusCode: number, data: Object, upload: Object}>}
+   */
+  async postJson(request) {
+    const response = await this.post(request);
+    let data;
+    try {
+      data = JSON.parse(response.body);
+    } catch (e) {
+      throw new Error(`Failed to parse response: ${e.message}`);
+    }
+    return { statusCode: response.status, data, upload: response };
+  }
+
+  /**
+   * Cancel pending requests (they reject with code ECANCELED) and close the pool
+   * @returns {Promise<void>}
+   */
+  close() {
+    return this.uploader.close();
+  }
+
+  /**
+   * @returns {{submitted: number, completed: number, failed: number, retries: number,
+   *            connections: number, reused: number, bytesSent: number, queued: number,
+   *            inFlight: number}}
+   */
+  getStats() {
+    return this.uploader.getStats();
+  }
+}
+
+class UploadScheduler {
+  /**
+   * Priority queue in front of a pooled uploader. Live uploads go before
+   * backfill, at most maxInFlight are sent at once, a live upload queued past
+   * liveSloMs is deferred behind older backfill, and uploads beyond maxQueued
+   * (oldest backfill first) or older than backfillMaxAgeMs are shed.
+   * @param {Object} [options] - HttpUploader options, plus:
+   * @param {number} [options.maxInFlight=4] - Uploads handed to the connection pool
+   * @param {number} [options.maxQueued=64] - Waiting uploads before shedding
+   * @param {number} [options.liveSloMs=5000] - End-to-end latency target for live uploads
+   * @param {number} [options.backfillMaxAgeMs=0] - Shed backfill waiting longer (0 = never)
+   * @param {number} [options.latencyWindow=512] - Recent uploads kept for percentiles
+   */
+  constructor(options = {}) {
+    this.options = options;
+    this.scheduler = uploaderModule ? new uploaderModule.UploadScheduler(options) : null;
+  }
+
+  /**
+   * Check if the native scheduler is available
+   * @returns {boolean} True if the module is loaded
+   */
+  isAvailable() {
+    return this.scheduler !== null;
+  }
+
+  /**
+   * Queue a POST. Resolves like HttpUploader.post() with priority, deferred,
+   * queueWaitMs and totalMs added; uploads that are shed reject with code
+   * "ESHED" (and shed: true).
+   * @param {Object} request - As for HttpUploader.post(), plus:
+   * @param {"live"|"backfill"} [request.priority="live"]
+   * @returns {Promise<Object>}
+   */
+  post(request) {
+    return this.scheduler.post(request);
+  }
+
+  /**
+   * POST and parse a JSON response
+   * @param {Object} request - As for post()
+   * @returns {Promise<{statusCode: number, data: Object, upload: Object}>}
+   */
+  postJson(request) {
+    return HttpUploader.prototype.postJson.call(this, request);
+  }
+
+  /**
+   * Cancel waiting and in-flight uploads (code ECANCELED) and close the pool
+   * @returns {Promise<void>}
+   */
+  close() {
+    return this.scheduler.close();
+  }
+
+  /**
+   * Per class ("live", "backfill"): submitted, completed, shed, queued and
+   * queueWaitMs / endToEndMs percentiles ({count, p50, p95, p99, max}) over
+   * recent uploads; plus inFlight, deferred, sloMet, sloMissed, sloAttainment
+   * and the pool's counters under uploader
+   * @returns {Object}
+   */
+  getStats() {
+    return this.scheduler.getStats();
+  }
+}
+
+module.exports = HttpUploader;
+module.exports.UploadScheduler = UploadScheduler;
+module.exports.isAvailable = () => uploaderModule !== null;
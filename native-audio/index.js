@@ -13,10 +13,23 @@ try {
   );
 }
 
+// Each AudioCapture has its own native stream, ring buffer and delivery
+// thread, so several can run at once (one per display or device) and the
+// module can be loaded in worker threads.
 class AudioCapture {
-  constructor(callback) {
+  /**
+   * @param {Function} [callback] - Receives Buffers of float32 PCM
+   * @param {Object} [options]
+   * @param {number} [options.displayId] - macOS: CGDirectDisplayID to capture (default: first display)
+   * @param {string} [options.deviceId] - Windows: endpoint id; render endpoints are captured in
+   *   loopback, capture endpoints directly (default: default render endpoint)
+   * @param {number} [options.ringMs=2000] - Audio buffered while the JS thread is busy
+   * @param {number} [options.chunkMs=20] - How often buffered audio is delivered
+   */
+  constructor(callback, options = {}) {
     this.capture = null;
     this.audioCallback = callback || null;
+    this.options = options;
     this.isCapturing = false;
   }
 
@@ -24,7 +37,12 @@ class AudioCapture {
     return nativeModule !== null;
   }
 
-  start(callback) {
+  /**
+   * Start capturing. Resolves once the native stream is running.
+   * @param {Function} [callback] - Overrides the constructor's callback
+   * @returns {Promise<{success: boolean, error?: string}>}
+   */
+  async start(callback) {
     if (!this.isAvailable()) {
       return {
         success: false,
@@ -41,9 +59,9 @@ class AudioCapture {
       }
 
       // Create capture instance with callback
-      this.capture = new nativeModule.AudioCapture(cb);
+      this.capture = new nativeModule.AudioCapture(cb, this.options);
 
-      const result = this.capture.start();
+      const result = await this.capture.start();
       this.isCapturing = result;
 
       return { success: result };
@@ -52,24 +70,23 @@ class AudioCapture {
     }
   }
 
-  stop() {
+  /**
+   * Stop capturing. Resolves once the native stream has stopped and every
+   * buffer captured before that has been passed to the callback.
+   * @returns {Promise<{success: boolean, error?: string}>}
+   */
+  async stop() {
     if (!this.capture) {
       return { success: false };
     }
 
     try {
-      this.capture.stop();
+      await this.capture.stop();
       this.isCapturing = false;
 
       // Clear the reference to allow garbage collection
-      // This ensures the destructor is called before creating a new instance
       this.capture = null;
 
-      // Force garbage collection hint (not guaranteed but helpful)
-      if (global.gc) {
-        global.gc();
-      }
-
       return { success: true };
     } catch (error) {
       this.capture = null;
@@ -87,6 +104,26 @@ class AudioCapture {
       return false;
     }
   }
+
+  /**
+   * Counters are totals since the capture was created. Histograms (in
+   * microseconds: count, meanUs, p50Us, p90Us, p99Us, p999Us, maxUs) cover
+   * the time since the last reset.
+   * @param {Object} [options]
+   * @param {boolean} [options.reset=false] - Start a new histogram interval after reading
+   * @returns {Object|null} packetsIn, samplesIn, samplesDelivered, samplesDropped
+   *   (ring overflow), chunks, bytesOut, bufferedMs, queuedChunks and
+   *   maxQueuedChunks (JS callback queue), latency: { callback (OS audio
+   *   callback per packet), delivery (packet captured to JS callback called),
+   *   jsHandler (JS callback per chunk) }, plus displayId (macOS) or deviceId,
+   *   sampleRate and channels (Windows)
+   */
+  getStats(options) {
+    if (!this.capture) {
+      return null;
+    }
+    return this.capture.getStats(options);
+  }
 }
 
 module.exports = AudioCapture;
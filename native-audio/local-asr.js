@@ -0,0 +1,218 @@
+// JavaScript wrapper for the on-device Whisper recognizer
+let asrModule = null;
+
+try {
+  asrModule = require("./build/Release/local_asr.node");
+} catch (error) {
+  console.warn("⚠️ Local ASR module not available:", error.message);
+  console.warn("   Transcription will only use the remote service");
+  console.warn("   To build it: cd native-audio && npm run rebuild");
+}
+
+class LocalRecognizer {
+  /**
+   * @param {Object} options
+   * @param {string} options.modelPath - Whisper model in ggml format (f16 or f32)
+   * @param {number} [options.threads=0] - Inference threads (0 = up to 8 by core count)
+   * @param {string} [options.weights="f32"] - "int8" or "int4" quantizes the weight matrices at load
+   * @param {string} [options.cachePath] - Tensor container for the converted weights; later loads
+   *   map it read-only instead of converting the ggml file again
+   */
+  constructor(options) {
+    this.options = options;
+    this.recognizer = asrModule ? new asrModule.LocalRecognizer(options) : null;
+  }
+
+  /**
+   * Check if the native recognizer is available
+   * @returns {boolean} True if the module is loaded
+   */
+  isAvailable() {
+    return this.recognizer !== null;
+  }
+
+  /**
+   * Read the model on a worker thread
+   * @returns {Promise<Object>} Model info (see getModelInfo)
+   */
+  load() {
+    return this.recognizer.load();
+  }
+
+  /**
+   * @returns {boolean} True once load() has resolved
+   */
+  isLoaded() {
+    return this.recognizer !== null && this.recognizer.isLoaded();
+  }
+
+  /**
+   * Transcribe 16 kHz mono audio on a worker thread
+   * @param {Float32Array|Int16Array|Buffer} samples - Float32 or s16le PCM
+   * @param {Object} [options]
+   * @param {string} [options.language="auto"] - ISO code, or "auto" to detect
+   * @param {boolean} [options.translate=false] - Translate to English
+   * @param {boolean} [options.timestamps=true] - Produce timed segments
+   * @param {number} [options.maxTokens=0] - Tokens per 30 s window (0 = model limit)
+   * @param {number} [options.audioCtx=0] - Encoder positions (0 = full 30 s window; 1500 = 30 s)
+   * @returns {Promise<{text: string, language: string, languageProbability: number,
+   *          segments: Array<{startMs: number, endMs: number, text: string}>,
+   *          timings: Object, rtf: number}>}
+   */
+  transcribe(samples, options = {}) {
+    return this.recognizer.transcribe(samples, options);
+  }
+
+  /**
+   * Start streaming recognition on the loaded model (see RecognizerStream)
+   * @param {Object} [options] - See RecognizerStream
+   * @param {Function} [onUpdate] - Called with each update
+   * @returns {RecognizerStream}
+   */
+  createStream(options = {}, onUpdate = null) {
+    return new RecognizerStream(this, options, onUpdate);
+  }
+
+  /**
+   * @returns {{type: string, multilingual: boolean, vocabulary: number, audioLayers: number,
+   *           textLayers: number, width: number, mels: number, weightBytes: number,
+   *           weights: string, kernels: string, threads: number, mapped: boolean,
+   *           loadMs: number, cacheError?: string}|null}
+   */
+  getModelInfo() {
+    return this.recognizer.getModelInfo();
+  }
+}
+
+class RecognizerStream {
+  /**
+   * Incremental recognition: push audio as it arrives and receive final and
+   * partial text every stepMs. Steps run on a worker thread, one at a time.
+   * @param {LocalRecognizer} recognizer - Loaded recognizer
+   * @param {Object} [options]
+   * @param {string} [options.language="auto"] - ISO code, or "auto" to detect from the first seconds
+   * @param {boolean} [options.translate=false] - Translate to English
+   * @param {number} [options.stepMs=300] - Re-recognize after this much new audio
+   * @param {number} [options.maxWindowMs=20000] - Make everything final once the unfinished audio is this long
+   * @param {number} [options.audioCtx=0] - Encoder positions (0 = fit the window)
+   * @param {Function} [onUpdate] - Called with {finals: Array<{startMs, endMs, text}>, partial: string,
+   *   partialStartMs, language, languageProbability, audioMs, windowMs, timings}, or {error}
+   */
+  constructor(recognizer, options = {}, onUpdate = null) {
+    if (!asrModule || !recognizer.recognizer) {
+      throw new Error("Local ASR module not available");
+    }
+    this.stream = new asrModule.RecognizerStream(recognizer.recognizer, options, onUpdate);
+  }
+
+  /**
+   * Queue 16 kHz mono audio; returns immediately
+   * @param {Float32Array|Int16Array|Buffer} samples - Float32 or s16le PCM
+   */
+  push(samples) {
+    this.stream.push(samples);
+  }
+
+  /**
+   * Recognize the queued audio and make everything final. The last update is
+   * only delivered here, not to onUpdate. The stream can be used again after.
+   * @returns {Promise<Object>} The last update
+   */
+  finish() {
+    return this.stream.finish();
+  }
+
+  /**
+   * @returns {{busy: boolean, queuedSamples: number, steps: number, melMs: number, encodeMs: number,
+   *           decodeMs: number, tokens: number, draftTokens: number, reusedFrames: number}}
+   */
+  getStats() {
+    return this.stream.getStats();
+  }
+}
+
+class LanguageIdentifier {
+  /**
+   * Spoken language identification on log-mel features; a few ms per second of audio
+   * @param {Object} options
+   * @param {string} options.modelPath - Tensor container of kind "lid" (see src/asr/language_id.h)
+   */
+  constructor(options) {
+    if (!asrModule) {
+      throw new Error("Local ASR module not available");
+    }
+    this.identifier = new asrModule.LanguageIdentifier(options);
+  }
+
+  /**
+   * Identify the language of 16 kHz mono audio, per segment, on a worker thread
+   * @param {Float32Array|Int16Array|Buffer} samples - Float32 or s16le PCM
+   * @param {Object} [options]
+   * @param {number} [options.segmentMs=3000] - One decision per segment
+   * @param {number} [options.minSpeechMs=500] - Segments with less speech are left undecided ("")
+   * @returns {Promise<{language: string, confidence: number,
+   *          segments: Array<{startMs: number, endMs: number, language: string, confidence: number,
+   *          speechMs: number}>, timings: {melMs: number, classifyMs: number, audioMs: number}}>}
+   */
+  identify(samples, options = {}) {
+    return this.identifier.identify(samples, options);
+  }
+
+  /**
+   * @returns {{languages: string[], mels: number, parameters: number, contextFrames: number}}
+   */
+  getModelInfo() {
+    return this.identifier.getModelInfo();
+  }
+}
+
+class MelFrontend {
+  /**
+   * Streaming log-mel features with Whisper framing (16 kHz, 25 ms window, 10 ms hop)
+   * @param {Object} [options]
+   * @param {number} [options.mels=80] - 80, or 128 for large-v3
+   * @param {boolean} [options.center=true] - Reflect-pad the stream edges like Whisper
+   */
+  constructor(options = {}) {
+    if (!asrModule) {
+      throw new Error("Local ASR module not available");
+    }
+    this.frontend = new asrModule.MelFrontend(options);
+  }
+
+  /**
+   * Append audio and compute every frame that became complete
+   * @param {Float32Array|Int16Array|Buffer} samples - Float32 or s16le PCM at 16 kHz
+   * @returns {Float32Array} New frames, time-major ([frame][mel]) log10 energies
+   */
+  push(samples) {
+    return this.frontend.push(samples);
+  }
+
+  /**
+   * End of stream: the remaining frames, with the right edge reflected
+   * @returns {Float32Array}
+   */
+  flush() {
+    return this.frontend.flush();
+  }
+
+  reset() {
+    this.frontend.reset();
+  }
+
+  /**
+   * @returns {{mels: number, frames: number, samples: number, processingMs: number, coreShare: number}}
+   */
+  getStats() {
+    return this.frontend.getStats();
+  }
+}
+
+module.exports = {
+  LocalRecognizer,
+  RecognizerStream,
+  LanguageIdentifier,
+  MelFrontend,
+  isAvailable: () => asrModule !== null,
+};
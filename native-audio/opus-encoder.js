@@ -0,0 +1,90 @@
+// JavaScript wrapper for the native Ogg/Opus encoder
+let opusModule = null;
+
+try {
+  opusModule = require("./build/Release/opus_encoder.node");
+} catch (error) {
+  console.warn("⚠️ Opus encoder module not available:", error.message);
+  console.warn("   Audio will be stored and uploaded as linear16 PCM");
+  console.warn("   To build it, install libopus (brew install opus) and run: cd native-audio && npm run rebuild");
+}
+
+class OpusEncoder {
+  /**
+   * @param {Object} [options]
+   * @param {number} [options.sampleRate=16000] - Input rate (8000/12000/16000/24000/48000)
+   * @param {number} [options.channels=1] - 1 or 2, interleaved input
+   * @param {number} [options.bitrate=24000] - Target bitrate in bits per second
+   * @param {number} [options.frameDurationMs=20] - 2.5, 5, 10, 20, 40 or 60
+   * @param {number} [options.complexity=5] - Encoder complexity 0-10
+   * @param {string} [options.application="voip"] - "voip" or "audio"
+   * @param {number} [options.pageDurationMs=200] - Audio per Ogg page (0 = one packet per page)
+   */
+  constructor(options = {}) {
+    this.options = options;
+    this.encoder = opusModule ? new opusModule.OpusEncoder(options) : null;
+  }
+
+  /**
+   * Check if the native encoder is available
+   * @returns {boolean} True if the module is loaded
+   */
+  isAvailable() {
+    return this.encoder !== null;
+  }
+
+  /**
+   * Encode PCM samples. Headers are emitted with the first call of a stream.
+   * @param {Float32Array|Int16Array|Buffer} samples - Float32 or s16le PCM
+   * @returns {Buffer} Completed Ogg pages (may be empty)
+   */
+  encode(samples) {
+    return this.encoder.encode(samples);
+  }
+
+  /**
+   * Close the Ogg page currently being filled
+   * @returns {Buffer} The page, or an empty buffer
+   */
+  flush() {
+    return this.encoder.flush();
+  }
+
+  /**
+   * End the current stream. The next encode() starts a new .opus stream.
+   * @returns {Buffer} Remaining pages including the end-of-stream page
+   */
+  finish() {
+    return this.encoder.finish();
+  }
+
+  /**
+   * Drop buffered audio and start a new stream
+   */
+  reset() {
+    this.encoder.reset();
+  }
+
+  /**
+   * Totals since construction
+   * @returns {{samplesIn: number, bytesOut: number, packetsOut: number, frameSize: number, averageBitrate: number}}
+   */
+  getStats() {
+    return this.encoder.getStats();
+  }
+
+  /**
+   * Encode a whole segment into a standalone .opus file
+   * @param {Float32Array|Int16Array|Buffer} samples - Float32 or s16le PCM
+   * @returns {Buffer} Complete Ogg Opus file
+   */
+  encodeSegment(samples) {
+    this.encoder.reset();
+    const body = this.encoder.encode(samples);
+    const tail = this.encoder.finish();
+    return Buffer.concat([body, tail]);
+  }
+}
+
+module.exports = OpusEncoder;
+module.exports.isAvailable = () => opusModule !== null;
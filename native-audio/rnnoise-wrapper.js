@@ -115,6 +115,26 @@ class RNNoiseWrapper {
     }
   }
 
+  /**
+   * Processing counters and timing, cheap enough to poll in production
+   * @param {Object} [options]
+   * @param {boolean} [options.reset=false] - Start a new histogram interval after reading
+   * @returns {Object|null} framesIn, samplesIn, bytesOut, bypassed, enabled and
+   *   time: { process, spectral, gate }, histograms in microseconds per
+   *   processFrame() call (count, meanUs, p50Us, p90Us, p99Us, p999Us, maxUs)
+   */
+  getStats(options) {
+    if (!this.processor) {
+      return null;
+    }
+    try {
+      return this.processor.getStats(options);
+    } catch (error) {
+      console.error("❌ Error reading RNNoise stats:", error.message);
+      return null;
+    }
+  }
+
   /**
    * Destroy the processor and free resources
    */
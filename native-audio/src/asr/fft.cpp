@@ -0,0 +1,235 @@
+#include "fft.h"
+
+#include <cmath>
+#include <stdexcept>
+
+namespace asr {
+
+namespace {
+
+const double kPi = 3.14159265358979323846;
+const int kMaxFft = 4096;
+
+// Radix-4 first, then 2, 3, 5, as kissfft does
+std::vector<int> factorize(int n) {
+    std::vector<int> factors;
+    const int radices[] = {4, 2, 3, 5};
+    for (int radix : radices) {
+        while (n % radix == 0) {
+            factors.push_back(radix);
+            n /= radix;
+        }
+    }
+    if (n != 1) factors.clear();
+    return factors;
+}
+
+} // namespace
+
+RealFft::RealFft(int n) : n_(n), half_(n / 2) {
+    const std::vector<int> factors = n > 2 ? factorize(half_) : std::vector<int>();
+    if (n % 2 != 0 || n > kMaxFft || factors.empty()) {
+        throw std::invalid_argument("unsupported FFT size");
+    }
+
+    // Digit-reversed gather order: replay kissfft's recursion once. Level l
+    // splits its input (offset, stride) into p_l interleaved children.
+    struct Pending { int offset; int stride; size_t level; };
+    std::vector<Pending> pending = {{0, 1, 0}};
+    order_.reserve(static_cast<size_t>(half_));
+    while (!pending.empty()) {
+        const Pending item = pending.back();
+        pending.pop_back();
+        const int p = factors[item.level];
+        if (item.level + 1 == factors.size()) {
+            for (int q = 0; q < p; q++) {
+                order_.push_back(item.offset + q * item.stride);
+            }
+            continue;
+        }
+        // Children are laid out in order, so push them in reverse
+        for (int q = p - 1; q >= 0; q--) {
+            pending.push_back({item.offset + q * item.stride, item.stride * p, item.level + 1});
+        }
+    }
+
+    // Butterfly stages, deepest level first
+    for (size_t level = factors.size(); level-- > 0;) {
+        Stage stage;
+        stage.radix = factors[level];
+        stage.m = 1;
+        for (size_t below = level + 1; below < factors.size(); below++) {
+            stage.m *= factors[below];
+        }
+        stage.blocks = half_ / (stage.radix * stage.m);
+
+        stage.twRe.resize(static_cast<size_t>(stage.radix - 1) * stage.m);
+        stage.twIm.resize(stage.twRe.size());
+        for (int q = 1; q < stage.radix; q++) {
+            for (int u = 0; u < stage.m; u++) {
+                const long e = (static_cast<long>(q) * u * stage.blocks) % half_;
+                const double angle = -2.0 * kPi * e / half_;
+                stage.twRe[static_cast<size_t>(q - 1) * stage.m + u] = static_cast<float>(std::cos(angle));
+                stage.twIm[static_cast<size_t>(q - 1) * stage.m + u] = static_cast<float>(std::sin(angle));
+            }
+        }
+        if (stage.radix == 3 || stage.radix == 5) {
+            const int p = stage.radix;
+            stage.dftRe.resize(static_cast<size_t>(p) * p);
+            stage.dftIm.resize(stage.dftRe.size());
+            for (int k = 0; k < p; k++) {
+                for (int q = 0; q < p; q++) {
+                    const double angle = -2.0 * kPi * ((k * q) % p) / p;
+                    stage.dftRe[static_cast<size_t>(k) * p + q] = static_cast<float>(std::cos(angle));
+                    stage.dftIm[static_cast<size_t>(k) * p + q] = static_cast<float>(std::sin(angle));
+                }
+            }
+        }
+        stages_.push_back(std::move(stage));
+    }
+
+    splitRe_.resize(static_cast<size_t>(half_) + 1);
+    splitIm_.resize(splitRe_.size());
+    for (int k = 0; k <= half_; k++) {
+        const double angle = -2.0 * kPi * k / n_;
+        splitRe_[k] = static_cast<float>(std::cos(angle));
+        splitIm_[k] = static_cast<float>(std::sin(angle));
+    }
+}
+
+void RealFft::complexForward(const float* in, float* re, float* im) const {
+    for (int i = 0; i < half_; i++) {
+        re[i] = in[2 * order_[i]];
+        im[i] = in[2 * order_[i] + 1];
+    }
+
+    for (const Stage& stage : stages_) {
+        const int p = stage.radix;
+        const int m = stage.m;
+        const float* twr = stage.twRe.data();
+        const float* twi = stage.twIm.data();
+
+        for (int b = 0; b < stage.blocks; b++) {
+            // Sub-transform q occupies [q*m, (q+1)*m); twiddle it by w^(q*u),
+            // then take a size-p DFT across q for every u
+            float* fr = re + b * p * m;
+            float* fi = im + b * p * m;
+
+            if (p == 2) {
+                for (int u = 0; u < m; u++) {
+                    const float tr = fr[u + m] * twr[u] - fi[u + m] * twi[u];
+                    const float ti = fr[u + m] * twi[u] + fi[u + m] * twr[u];
+                    fr[u + m] = fr[u] - tr;
+                    fi[u + m] = fi[u] - ti;
+                    fr[u] += tr;
+                    fi[u] += ti;
+                }
+            } else if (p == 4) {
+                const float* w1r = twr;
+                const float* w1i = twi;
+                const float* w2r = twr + m;
+                const float* w2i = twi + m;
+                const float* w3r = twr + 2 * m;
+                const float* w3i = twi + 2 * m;
+                for (int u = 0; u < m; u++) {
+                    const float ar = fr[u];
+                    const float ai = fi[u];
+                    const float br = fr[u + m] * w1r[u] - fi[u + m] * w1i[u];
+                    const float bi = fr[u + m] * w1i[u] + fi[u + m] * w1r[u];
+                    const float cr = fr[u + 2 * m] * w2r[u] - fi[u + 2 * m] * w2i[u];
+                    const float ci = fr[u + 2 * m] * w2i[u] + fi[u + 2 * m] * w2r[u];
+                    const float dr = fr[u + 3 * m] * w3r[u] - fi[u + 3 * m] * w3i[u];
+                    const float di = fr[u + 3 * m] * w3i[u] + fi[u + 3 * m] * w3r[u];
+                    const float s0r = ar + cr, s0i = ai + ci;
+                    const float s1r = ar - cr, s1i = ai - ci;
+                    const float s2r = br + dr, s2i = bi + di;
+                    const float s3r = br - dr, s3i = bi - di;
+                    fr[u] = s0r + s2r;
+                    fi[u] = s0i + s2i;
+                    fr[u + 2 * m] = s0r - s2r;
+                    fi[u + 2 * m] = s0i - s2i;
+                    // X1 = s1 - i*s3, X3 = s1 + i*s3
+                    fr[u + m] = s1r + s3i;
+                    fi[u + m] = s1i - s3r;
+                    fr[u + 3 * m] = s1r - s3i;
+                    fi[u + 3 * m] = s1i + s3r;
+                }
+            } else {
+                const float* dr = stage.dftRe.data();
+                const float* di = stage.dftIm.data();
+                float xr[5];
+                float xi[5];
+                for (int u = 0; u < m; u++) {
+                    xr[0] = fr[u];
+                    xi[0] = fi[u];
+                    for (int q = 1; q < p; q++) {
+                        const float wr = twr[static_cast<size_t>(q - 1) * m + u];
+                        const float wi = twi[static_cast<size_t>(q - 1) * m + u];
+                        const float vr = fr[u + q * m];
+                        const float vi = fi[u + q * m];
+                        xr[q] = vr * wr - vi * wi;
+                        xi[q] = vr * wi + vi * wr;
+                    }
+                    for (int k = 0; k < p; k++) {
+                        float sr = 0.0f;
+                        float si = 0.0f;
+                        for (int q = 0; q < p; q++) {
+                            const float cr = dr[k * p + q];
+                            const float ci = di[k * p + q];
+                            sr += xr[q] * cr - xi[q] * ci;
+                            si += xr[q] * ci + xi[q] * cr;
+                        }
+                        fr[u + k * m] = sr;
+                        fi[u + k * m] = si;
+                    }
+                }
+            }
+        }
+    }
+}
+
+void RealFft::forward(const float* in, float* re, float* im) const {
+    complexForward(in, re, im);
+
+    // X[k] = E[k] + w^k O[k] with E = (Z[k] + Z*[M-k]) / 2 and
+    // O = (Z[k] - Z*[M-k]) / 2i; k and M-k are computed together in place
+    const int m = half_;
+    const float z0r = re[0];
+    const float z0i = im[0];
+    re[0] = z0r + z0i;
+    im[0] = 0.0f;
+    re[m] = z0r - z0i;
+    im[m] = 0.0f;
+
+    for (int k = 1; k <= m / 2; k++) {
+        const int j = m - k;
+        const float ar = re[k], ai = im[k];
+        const float br = re[j], bi = im[j];
+
+        // Pair (k, j): E and O for both from Z[k] and Z[j]
+        const float ekr = 0.5f * (ar + br), eki = 0.5f * (ai - bi);
+        const float okr = 0.5f * (ai + bi), oki = -0.5f * (ar - br);
+        const float ejr = ekr, eji = -eki;
+        const float ojr = okr, oji = -oki;
+
+        const float wkr = splitRe_[k], wki = splitIm_[k];
+        const float wjr = splitRe_[j], wji = splitIm_[j];
+
+        re[k] = ekr + (okr * wkr - oki * wki);
+        im[k] = eki + (okr * wki + oki * wkr);
+        re[j] = ejr + (ojr * wjr - oji * wji);
+        im[j] = eji + (ojr * wji + oji * wjr);
+    }
+}
+
+void RealFft::power(const float* in, float* out) const {
+    float re[kMaxFft / 2 + 1];
+    float im[kMaxFft / 2 + 1];
+    forward(in, re, im);
+    const int count = bins();
+    for (int k = 0; k < count; k++) {
+        out[k] = re[k] * re[k] + im[k] * im[k];
+    }
+}
+
+} // namespace asr
@@ -0,0 +1,56 @@
+// Mixed-radix real FFT for the frame sizes used by the audio frontends
+//
+// A real transform of even length N runs as a complex transform of N/2 on
+// interleaved even/odd samples, followed by one split pass. The complex
+// transform is kissfft-style decimation in time, made iterative: the input is
+// gathered in digit-reversed order once, then each stage runs its butterflies
+// over split real/imaginary arrays with per-stage twiddle tables, so the
+// inner loops are unit-stride and vectorize.
+
+#ifndef ASR_FFT_H
+#define ASR_FFT_H
+
+#include <cstddef>
+#include <vector>
+
+namespace asr {
+
+class RealFft {
+public:
+    // n must be even and factor into 2, 3, 4 and 5 (400 and 512 do)
+    explicit RealFft(int n);
+
+    int size() const { return n_; }
+    int bins() const { return n_ / 2 + 1; }
+
+    // in has size() samples; re/im receive bins() values
+    void forward(const float* in, float* re, float* im) const;
+
+    // |X[k]|^2 for k in [0, bins())
+    void power(const float* in, float* out) const;
+
+private:
+    struct Stage {
+        int radix;
+        int m;                     // points per sub-transform
+        int blocks;                // independent blocks of radix * m points
+        std::vector<float> twRe;   // [radix - 1][m]: w^(q * u * blocks)
+        std::vector<float> twIm;
+        std::vector<float> dftRe;  // [radix][radix] for radix 3 and 5
+        std::vector<float> dftIm;
+    };
+
+    int n_;
+    int half_;
+    std::vector<int> order_;       // digit-reversed gather indices
+    std::vector<Stage> stages_;    // innermost first
+    std::vector<float> splitRe_;   // e^{-2 pi i k / n}, k in [0, half]
+    std::vector<float> splitIm_;
+
+    // Complex transform of half_ points z[k] = in[2k] + i in[2k+1]
+    void complexForward(const float* in, float* re, float* im) const;
+};
+
+} // namespace asr
+
+#endif
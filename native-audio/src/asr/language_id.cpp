@@ -0,0 +1,326 @@
+#include "language_id.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+#include "tensor_ops.h"
+
+namespace asr {
+
+namespace {
+
+const char* const kContainerKind = "lid";
+const int kFrameMs = 10;
+// Speech frames: loudest mel bin within 30 dB of the segment's loudest frame
+// and above digital silence (log10 units)
+const float kSpeechRange = 3.0f;
+const float kSilenceFloor = -8.0f;
+
+double elapsedMs(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+}
+
+const float* floatTensor(const storage::TensorFile& file, const std::string& name,
+                         std::vector<int64_t>* shape, std::string* error) {
+    const storage::TensorInfo* info = file.find(name);
+    if (!info || info->type != storage::TensorType::F32) {
+        *error = "language model lacks f32 tensor " + name;
+        return nullptr;
+    }
+    const uint8_t* data = file.data(*info, error);
+    if (!data) return nullptr;
+    *shape = info->shape;
+    return reinterpret_cast<const float*>(data);
+}
+
+bool isVector(const std::vector<int64_t>& shape, size_t n) {
+    return shape.size() == 1 && static_cast<size_t>(shape[0]) == n;
+}
+
+void relu(float* x, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        x[i] = std::max(x[i], 0.0f);
+    }
+}
+
+} // namespace
+
+LanguageIdentifier::LanguageIdentifier()
+    : mels_(0), left_(0), right_(0), parameters_(0), pool_(1) {}
+
+bool LanguageIdentifier::load(const std::string& path, std::string* error) {
+    file_.reset();
+    auto file = std::make_shared<storage::TensorFile>();
+    if (!file->open(path, kContainerKind, error)) return false;
+    // The model is small: check every checksum now rather than per call
+    if (!file->verifyAll(error)) {
+        *error = path + ": " + *error;
+        return false;
+    }
+
+    std::vector<Layer> tdnn;
+    size_t parameters = 0;
+    int left = 0;
+    int right = 0;
+    std::vector<int64_t> shape;
+    for (int i = 1;; i++) {
+        const std::string prefix = "tdnn" + std::to_string(i);
+        if (!file->find(prefix + ".weight")) break;
+
+        Layer layer;
+        const storage::TensorInfo* context = file->find(prefix + ".context");
+        const uint8_t* offsets = context && context->type == storage::TensorType::Int32
+                                     ? file->data(*context, error) : nullptr;
+        if (!offsets || context->bytes == 0) {
+            *error = "language model lacks " + prefix + ".context";
+            return false;
+        }
+        layer.context.resize(context->bytes / sizeof(int32_t));
+        for (size_t k = 0; k < layer.context.size(); k++) {
+            int32_t offset;
+            std::memcpy(&offset, offsets + k * sizeof(int32_t), sizeof(offset));
+            layer.context[k] = offset;
+        }
+        if (!std::is_sorted(layer.context.begin(), layer.context.end()) ||
+            layer.context.front() > 0 || layer.context.back() < 0) {
+            *error = prefix + ".context must be ascending and span offset 0";
+            return false;
+        }
+
+        layer.weight = floatTensor(*file, prefix + ".weight", &shape, error);
+        if (!layer.weight) return false;
+        const size_t taps = layer.context.size();
+        if (shape.size() != 2 || shape[0] <= 0 || shape[1] <= 0 || shape[1] % taps != 0) {
+            *error = prefix + ".weight does not match its context";
+            return false;
+        }
+        layer.out = static_cast<size_t>(shape[0]);
+        layer.in = static_cast<size_t>(shape[1]) / taps;
+        if (!tdnn.empty() && layer.in != tdnn.back().out) {
+            *error = prefix + " input does not match the previous layer";
+            return false;
+        }
+        layer.bias = floatTensor(*file, prefix + ".bias", &shape, error);
+        if (!layer.bias) return false;
+        if (!isVector(shape, layer.out)) {
+            *error = prefix + ".bias has the wrong shape";
+            return false;
+        }
+
+        left -= layer.context.front();
+        right += layer.context.back();
+        parameters += layer.out * (layer.in * taps + 1);
+        tdnn.push_back(std::move(layer));
+    }
+    if (tdnn.empty()) {
+        *error = path + " has no TDNN layers";
+        return false;
+    }
+
+    // embed and output are linear layers without context
+    Layer* heads[] = {&embed_, &output_};
+    const char* names[] = {"embed", "output"};
+    size_t width = 2 * tdnn.back().out;
+    for (int i = 0; i < 2; i++) {
+        Layer& layer = *heads[i];
+        const std::string name = names[i];
+        layer = Layer();
+        layer.context.assign(1, 0);
+        layer.weight = floatTensor(*file, name + ".weight", &shape, error);
+        if (!layer.weight) return false;
+        if (shape.size() != 2 || shape[0] <= 0 || static_cast<size_t>(shape[1]) != width) {
+            *error = name + ".weight has the wrong shape";
+            return false;
+        }
+        layer.in = width;
+        layer.out = static_cast<size_t>(shape[0]);
+        layer.bias = floatTensor(*file, name + ".bias", &shape, error);
+        if (!layer.bias) return false;
+        if (!isVector(shape, layer.out)) {
+            *error = name + ".bias has the wrong shape";
+            return false;
+        }
+        parameters += layer.out * (layer.in + 1);
+        width = layer.out;
+    }
+
+    const storage::TensorInfo* info = file->find("meta.languages");
+    const uint8_t* data = info && info->type == storage::TensorType::Bytes ? file->data(*info, error) : nullptr;
+    if (!data) {
+        *error = "language model lacks meta.languages";
+        return false;
+    }
+    std::vector<std::string> languages;
+    const std::string codes(reinterpret_cast<const char*>(data), info->bytes);
+    size_t begin = 0;
+    while (begin < codes.size()) {
+        size_t end = codes.find('\n', begin);
+        if (end == std::string::npos) end = codes.size();
+        if (end > begin) languages.push_back(codes.substr(begin, end - begin));
+        begin = end + 1;
+    }
+    if (languages.size() != output_.out) {
+        *error = "meta.languages lists " + std::to_string(languages.size()) + " codes for " +
+                 std::to_string(output_.out) + " outputs";
+        return false;
+    }
+
+    MelConfig config;
+    config.mels = static_cast<int>(tdnn.front().in);
+    kernel_ = std::make_shared<MelKernel>(config);
+    tdnn_ = std::move(tdnn);
+    languages_ = std::move(languages);
+    mels_ = config.mels;
+    left_ = left;
+    right_ = right;
+    parameters_ = parameters;
+    file_ = std::move(file);
+    return true;
+}
+
+size_t LanguageIdentifier::classify(const float* mel, size_t frames, std::vector<float>* probs) const {
+    if (!file_ || frames == 0) return 0;
+    const size_t mels = static_cast<size_t>(mels_);
+
+    std::vector<float> energy(frames);
+    float peak = kSilenceFloor;
+    for (size_t t = 0; t < frames; t++) {
+        const float* row = mel + t * mels;
+        energy[t] = *std::max_element(row, row + mels);
+        peak = std::max(peak, energy[t]);
+    }
+    const float threshold = std::max(peak - kSpeechRange, kSilenceFloor);
+    size_t speech = 0;
+    std::vector<double> mean(mels, 0.0);
+    for (size_t t = 0; t < frames; t++) {
+        if (energy[t] <= threshold) continue;
+        speech++;
+        const float* row = mel + t * mels;
+        for (size_t m = 0; m < mels; m++) mean[m] += row[m];
+    }
+    if (speech == 0) return 0;
+    for (double& value : mean) value /= static_cast<double>(speech);
+
+    // Mean-normalized input, edges repeated for the layers' context
+    size_t rows = frames + static_cast<size_t>(left_ + right_);
+    std::vector<float> x(rows * mels);
+    for (size_t r = 0; r < rows; r++) {
+        const size_t t = static_cast<size_t>(
+            std::min<int64_t>(std::max<int64_t>(static_cast<int64_t>(r) - left_, 0),
+                              static_cast<int64_t>(frames) - 1));
+        const float* src = mel + t * mels;
+        float* dst = x.data() + r * mels;
+        for (size_t m = 0; m < mels; m++) dst[m] = src[m] - static_cast<float>(mean[m]);
+    }
+
+    std::vector<float> cols;
+    std::vector<float> y;
+    size_t width = mels;
+    for (const Layer& layer : tdnn_) {
+        const size_t first = static_cast<size_t>(-layer.context.front());
+        const size_t outRows = rows - first - static_cast<size_t>(layer.context.back());
+        const size_t taps = layer.context.size();
+        cols.resize(outRows * taps * width);
+        for (size_t r = 0; r < outRows; r++) {
+            for (size_t k = 0; k < taps; k++) {
+                const size_t src = r + first + static_cast<size_t>(layer.context[k]);
+                std::memcpy(cols.data() + (r * taps + k) * width, x.data() + src * width,
+                            width * sizeof(float));
+            }
+        }
+        y.resize(outRows * layer.out);
+        linear(cols.data(), outRows, taps * width, layer.weight, layer.bias, layer.out, y.data(), pool_);
+        relu(y.data(), y.size());
+        x.swap(y);
+        rows = outRows;
+        width = layer.out;
+    }
+
+    // Statistics pooling over the speech frames (rows == frames here)
+    std::vector<double> sum(width, 0.0);
+    std::vector<double> squares(width, 0.0);
+    for (size_t t = 0; t < frames; t++) {
+        if (energy[t] <= threshold) continue;
+        const float* row = x.data() + t * width;
+        for (size_t c = 0; c < width; c++) {
+            sum[c] += row[c];
+            squares[c] += static_cast<double>(row[c]) * row[c];
+        }
+    }
+    std::vector<float> pooled(2 * width);
+    for (size_t c = 0; c < width; c++) {
+        const double m = sum[c] / static_cast<double>(speech);
+        const double variance = squares[c] / static_cast<double>(speech) - m * m;
+        pooled[c] = static_cast<float>(m);
+        pooled[width + c] = static_cast<float>(std::sqrt(std::max(variance, 1e-10)));
+    }
+
+    std::vector<float> embedding(embed_.out);
+    linear(pooled.data(), 1, embed_.in, embed_.weight, embed_.bias, embed_.out, embedding.data(), pool_);
+    relu(embedding.data(), embedding.size());
+    probs->resize(output_.out);
+    linear(embedding.data(), 1, output_.in, output_.weight, output_.bias, output_.out, probs->data(), pool_);
+    softmax(probs->data(), probs->size());
+    return speech;
+}
+
+bool LanguageIdentifier::identify(const float* pcm, size_t n, const LanguageIdOptions& options,
+                                  LanguageIdResult* result, std::string* error) const {
+    if (!file_) {
+        *error = "language model is not loaded";
+        return false;
+    }
+    *result = LanguageIdResult();
+    const int sampleRate = kernel_->config().sampleRate;
+    result->audioMs = static_cast<int64_t>(n) * 1000 / sampleRate;
+
+    auto start = std::chrono::steady_clock::now();
+    MelFrontend frontend(kernel_);
+    std::vector<float> mel;
+    frontend.push(pcm, n, &mel);
+    frontend.flush(&mel);
+    result->melMs = elapsedMs(start);
+
+    start = std::chrono::steady_clock::now();
+    const size_t mels = static_cast<size_t>(mels_);
+    const size_t frames = mel.size() / mels;
+    const size_t segmentFrames = static_cast<size_t>(std::max(100, options.segmentMs / kFrameMs));
+    const size_t minSpeech = static_cast<size_t>(std::max(1, options.minSpeechMs / kFrameMs));
+
+    std::vector<double> total(languages_.size(), 0.0);
+    double weight = 0.0;
+    std::vector<float> probs;
+    for (size_t first = 0; first < frames;) {
+        size_t last = std::min(frames, first + segmentFrames);
+        if (frames - last < segmentFrames / 2) last = frames;
+
+        LanguageSegment segment;
+        segment.startMs = static_cast<int64_t>(first) * kFrameMs;
+        segment.endMs = std::min<int64_t>(static_cast<int64_t>(last) * kFrameMs, result->audioMs);
+        const size_t speech = classify(mel.data() + first * mels, last - first, &probs);
+        segment.speechMs = static_cast<int>(speech) * kFrameMs;
+        if (speech >= minSpeech) {
+            const size_t best = static_cast<size_t>(std::max_element(probs.begin(), probs.end()) - probs.begin());
+            segment.language = languages_[best];
+            segment.confidence = probs[best];
+            for (size_t i = 0; i < probs.size(); i++) {
+                total[i] += static_cast<double>(probs[i]) * speech;
+            }
+            weight += static_cast<double>(speech);
+        }
+        result->segments.push_back(std::move(segment));
+        first = last;
+    }
+
+    if (weight > 0.0) {
+        const size_t best = static_cast<size_t>(std::max_element(total.begin(), total.end()) - total.begin());
+        result->language = languages_[best];
+        result->confidence = static_cast<float>(total[best] / weight);
+    }
+    result->classifyMs = elapsedMs(start);
+    return true;
+}
+
+} // namespace asr
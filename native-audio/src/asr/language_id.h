@@ -0,0 +1,118 @@
+// Spoken language identification on log-mel features
+//
+// A small x-vector style classifier: TDNN layers (dilated 1-D convolutions
+// over frames) turn each 10 ms mel frame into a frame embedding, mean and
+// standard deviation pooling over the speech frames of a segment give one
+// fixed-size vector, and two linear layers map it to language posteriors.
+// It shares the mel frontend with the recognizer and costs a few
+// milliseconds per second of audio on one core, so it can run on every
+// chunk before choosing a language-specific recognizer.
+//
+// Weights are read from a tensor container (storage/tensor_file.h) of kind
+// "lid", mapped read-only:
+//
+//   meta.languages   Bytes   language codes, one per output, '\n'-separated
+//   tdnnN.weight     F32     [out, in * taps], taps outermost: a row holds
+//                            in values for each context offset in turn
+//   tdnnN.bias       F32     [out]
+//   tdnnN.context    Int32   [taps] frame offsets, ascending (e.g. -2 0 2)
+//   embed.weight     F32     [embed, 2 * channels of the last TDNN layer]
+//   embed.bias       F32     [embed]
+//   output.weight    F32     [languages, embed]
+//   output.bias      F32     [languages]
+//
+// with N = 1, 2, ... for as many layers as the file has. tdnn1's input
+// width is the number of mel bins (80 or 128). Every TDNN layer and the
+// embedding are followed by ReLU; batch norm is expected to be folded into
+// the weights. Features are log10 mel energies with the per-bin mean over
+// the segment's speech frames subtracted.
+
+#ifndef ASR_LANGUAGE_ID_H
+#define ASR_LANGUAGE_ID_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mel_frontend.h"
+#include "storage/tensor_file.h"
+#include "thread_pool.h"
+
+namespace asr {
+
+struct LanguageIdOptions {
+    int segmentMs = 3000;     // one decision per segment; a shorter tail joins the previous one
+    int minSpeechMs = 500;    // segments with less speech are left undecided
+};
+
+struct LanguageSegment {
+    int64_t startMs = 0;
+    int64_t endMs = 0;
+    std::string language;     // empty if undecided
+    float confidence = 0.0f;  // posterior of language
+    int speechMs = 0;
+};
+
+struct LanguageIdResult {
+    // Over all decided segments, weighted by their speech
+    std::string language;
+    float confidence = 0.0f;
+    std::vector<LanguageSegment> segments;
+    int64_t audioMs = 0;
+    double melMs = 0.0;
+    double classifyMs = 0.0;
+};
+
+class LanguageIdentifier {
+public:
+    LanguageIdentifier();
+
+    LanguageIdentifier(const LanguageIdentifier&) = delete;
+    LanguageIdentifier& operator=(const LanguageIdentifier&) = delete;
+
+    // Map the model and check its shapes and checksums
+    bool load(const std::string& path, std::string* error);
+
+    bool loaded() const { return file_ != nullptr; }
+    const std::vector<std::string>& languages() const { return languages_; }
+    int mels() const { return mels_; }
+    // Frames of context the TDNN layers look at on each side
+    int contextFrames() const { return left_ + right_; }
+    size_t parameterCount() const { return parameters_; }
+
+    // Posteriors for one segment of log-mel frames (time-major, as produced
+    // by MelFrontend). Returns the number of speech frames used; 0 leaves
+    // probs untouched. Safe to call from several threads.
+    size_t classify(const float* mel, size_t frames, std::vector<float>* probs) const;
+
+    // Split 16 kHz mono audio into segments and identify each
+    bool identify(const float* pcm, size_t n, const LanguageIdOptions& options,
+                  LanguageIdResult* result, std::string* error) const;
+
+private:
+    struct Layer {
+        const float* weight = nullptr;
+        const float* bias = nullptr;
+        size_t in = 0;
+        size_t out = 0;
+        std::vector<int> context;
+    };
+
+    std::shared_ptr<storage::TensorFile> file_;
+    std::shared_ptr<const MelKernel> kernel_;
+    std::vector<std::string> languages_;
+    std::vector<Layer> tdnn_;
+    Layer embed_;
+    Layer output_;
+    int mels_;
+    int left_;
+    int right_;
+    size_t parameters_;
+    // No worker threads: linear() runs inline, so concurrent calls are fine
+    mutable ThreadPool pool_;
+};
+
+} // namespace asr
+
+#endif
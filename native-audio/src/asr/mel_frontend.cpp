@@ -0,0 +1,226 @@
+#include "mel_frontend.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace asr {
+
+namespace {
+
+const double kPi = 3.14159265358979323846;
+const int kMaxFftSize = 4096;
+
+// Slaney mel scale: linear below 1 kHz, logarithmic above
+double hzToMel(double hz) {
+    const double minLogHz = 1000.0;
+    const double minLogMel = minLogHz / (200.0 / 3.0);
+    const double logStep = std::log(6.4) / 27.0;
+    return hz < minLogHz ? hz / (200.0 / 3.0) : minLogMel + std::log(hz / minLogHz) / logStep;
+}
+
+double melToHz(double mel) {
+    const double minLogHz = 1000.0;
+    const double minLogMel = minLogHz / (200.0 / 3.0);
+    const double logStep = std::log(6.4) / 27.0;
+    return mel < minLogMel ? mel * (200.0 / 3.0) : minLogHz * std::exp(logStep * (mel - minLogMel));
+}
+
+} // namespace
+
+MelFilterbank::MelFilterbank(const float* dense, int mels, int bins) : mels_(mels), bins_(bins) {
+    start_.resize(static_cast<size_t>(mels));
+    count_.resize(static_cast<size_t>(mels));
+    offset_.resize(static_cast<size_t>(mels));
+    for (int m = 0; m < mels; m++) {
+        const float* row = dense + static_cast<size_t>(m) * bins;
+        int first = 0;
+        while (first < bins && row[first] == 0.0f) first++;
+        int last = bins;
+        while (last > first && row[last - 1] == 0.0f) last--;
+        start_[m] = first;
+        count_[m] = last - first;
+        offset_[m] = weights_.size();
+        weights_.insert(weights_.end(), row + first, row + last);
+    }
+}
+
+MelFilterbank MelFilterbank::slaney(int sampleRate, int fftSize, int mels) {
+    const int bins = fftSize / 2 + 1;
+    const double maxMel = hzToMel(sampleRate / 2.0);
+    std::vector<double> points(static_cast<size_t>(mels) + 2);
+    for (size_t i = 0; i < points.size(); i++) {
+        points[i] = melToHz(maxMel * static_cast<double>(i) / (mels + 1));
+    }
+
+    std::vector<float> dense(static_cast<size_t>(mels) * bins, 0.0f);
+    for (int m = 0; m < mels; m++) {
+        const double lower = points[m];
+        const double center = points[m + 1];
+        const double upper = points[m + 2];
+        const double norm = 2.0 / (upper - lower);  // equal area per filter
+        for (int k = 0; k < bins; k++) {
+            const double hz = static_cast<double>(k) * sampleRate / fftSize;
+            const double rising = (hz - lower) / (center - lower);
+            const double falling = (upper - hz) / (upper - center);
+            const double weight = std::max(0.0, std::min(rising, falling));
+            dense[static_cast<size_t>(m) * bins + k] = static_cast<float>(weight * norm);
+        }
+    }
+    return MelFilterbank(dense.data(), mels, bins);
+}
+
+void MelFilterbank::apply(const float* power, float* out) const {
+    for (int m = 0; m < mels_; m++) {
+        const float* w = weights_.data() + offset_[m];
+        const float* p = power + start_[m];
+        float sum = 0.0f;
+        for (int k = 0; k < count_[m]; k++) {
+            sum += w[k] * p[k];
+        }
+        out[m] = sum;
+    }
+}
+
+MelKernel::MelKernel(const MelConfig& config, MelFilterbank filterbank)
+    : config_(config),
+      filterbank_(filterbank.mels() > 0 ? std::move(filterbank)
+                                        : MelFilterbank::slaney(config.sampleRate, config.fftSize, config.mels)),
+      fft_(config.fftSize) {
+    config_.mels = filterbank_.mels();
+    // Periodic Hann, as torch.hann_window
+    window_.resize(static_cast<size_t>(config_.fftSize));
+    for (int i = 0; i < config_.fftSize; i++) {
+        window_[i] = static_cast<float>(0.5 * (1.0 - std::cos(2.0 * kPi * i / config_.fftSize)));
+    }
+}
+
+void MelKernel::frame(const float* samples, float* out) const {
+    float windowed[kMaxFftSize];
+    float power[kMaxFftSize / 2 + 1];
+    const int n = config_.fftSize;
+    for (int i = 0; i < n; i++) {
+        windowed[i] = samples[i] * window_[i];
+    }
+    fft_.power(windowed, power);
+    filterbank_.apply(power, out);
+    for (int m = 0; m < config_.mels; m++) {
+        out[m] = std::log10(std::max(out[m], 1e-10f));
+    }
+}
+
+MelFrontend::MelFrontend(std::shared_ptr<const MelKernel> kernel)
+    : kernel_(std::move(kernel)), base_(0), received_(0), nextFrame_(0), flushed_(false) {
+}
+
+void MelFrontend::reset() {
+    buffer_.clear();
+    base_ = 0;
+    received_ = 0;
+    nextFrame_ = 0;
+    flushed_ = false;
+}
+
+bool MelFrontend::frameReady(uint64_t frame) const {
+    const MelConfig& config = kernel_->config();
+    const uint64_t start = frame * static_cast<uint64_t>(config.hopLength);
+    // Centered frames reach fftSize/2 past their center, and the left-edge
+    // reflection reads up to sample fftSize/2 as well
+    const uint64_t last = config.center ? start + config.fftSize / 2 : start + config.fftSize - 1;
+    return received_ > last;
+}
+
+void MelFrontend::emit(uint64_t frame, bool atEnd, std::vector<float>* frames) {
+    const MelConfig& config = kernel_->config();
+    const int n = config.fftSize;
+    const int64_t first = static_cast<int64_t>(frame * static_cast<uint64_t>(config.hopLength)) -
+                          (config.center ? n / 2 : 0);
+    const int64_t length = static_cast<int64_t>(received_);
+
+    float samples[kMaxFftSize];
+    if (first >= 0 && first + n <= length) {
+        std::copy(buffer_.begin() + static_cast<ptrdiff_t>(first - static_cast<int64_t>(base_)),
+                  buffer_.begin() + static_cast<ptrdiff_t>(first - static_cast<int64_t>(base_) + n), samples);
+    } else {
+        for (int i = 0; i < n; i++) {
+            int64_t index = first + i;
+            if (index < 0) index = -index;
+            if (index >= length) index = atEnd ? 2 * (length - 1) - index : length - 1;
+            index = std::max<int64_t>(index, 0);
+            const int64_t local = index - static_cast<int64_t>(base_);
+            samples[i] = local >= 0 && local < static_cast<int64_t>(buffer_.size()) ? buffer_[local] : 0.0f;
+        }
+    }
+
+    const size_t offset = frames->size();
+    frames->resize(offset + static_cast<size_t>(kernel_->mels()));
+    kernel_->frame(samples, frames->data() + offset);
+}
+
+size_t MelFrontend::drain(std::vector<float>* frames) {
+    const MelConfig& config = kernel_->config();
+    size_t count = 0;
+    while (frameReady(nextFrame_)) {
+        emit(nextFrame_, false, frames);
+        nextFrame_++;
+        count++;
+    }
+
+    // Keep what the next frame (and the left-edge reflection) still needs
+    const uint64_t reflectEnd = config.center ? static_cast<uint64_t>(config.fftSize / 2) + 1 : 0;
+    const int64_t nextStart = static_cast<int64_t>(nextFrame_ * static_cast<uint64_t>(config.hopLength)) -
+                              (config.center ? config.fftSize / 2 : 0);
+    const uint64_t keepFrom = nextStart > 0 && static_cast<uint64_t>(nextStart) > reflectEnd
+                                  ? static_cast<uint64_t>(nextStart)
+                                  : 0;
+    // Compact lazily so the erase is amortized over many pushes
+    if (keepFrom > base_ && keepFrom - base_ >= buffer_.size() / 2) {
+        buffer_.erase(buffer_.begin(), buffer_.begin() + static_cast<ptrdiff_t>(keepFrom - base_));
+        base_ = keepFrom;
+    }
+    return count;
+}
+
+size_t MelFrontend::push(const float* samples, size_t n, std::vector<float>* frames) {
+    if (flushed_) reset();
+    buffer_.insert(buffer_.end(), samples, samples + n);
+    received_ += n;
+    return drain(frames);
+}
+
+size_t MelFrontend::push(const int16_t* samples, size_t n, std::vector<float>* frames) {
+    if (flushed_) reset();
+    const size_t offset = buffer_.size();
+    buffer_.resize(offset + n);
+    for (size_t i = 0; i < n; i++) {
+        buffer_[offset + i] = samples[i] / 32768.0f;
+    }
+    received_ += n;
+    return drain(frames);
+}
+
+size_t MelFrontend::flush(std::vector<float>* frames) {
+    const MelConfig& config = kernel_->config();
+    const uint64_t total = config.center
+        ? received_ / static_cast<uint64_t>(config.hopLength)
+        : (received_ >= static_cast<uint64_t>(config.fftSize)
+               ? (received_ - config.fftSize) / config.hopLength + 1
+               : 0);
+    size_t count = 0;
+    if (received_ > 0) {
+        for (; nextFrame_ < total; nextFrame_++, count++) {
+            emit(nextFrame_, true, frames);
+        }
+    }
+    flushed_ = true;
+    return count;
+}
+
+void normalizeWhisperMel(float* logMel, size_t count) {
+    float maxValue = -1e20f;
+    for (size_t i = 0; i < count; i++) maxValue = std::max(maxValue, logMel[i]);
+    for (size_t i = 0; i < count; i++) {
+        logMel[i] = (std::max(logMel[i], maxValue - 8.0f) + 4.0f) / 4.0f;
+    }
+}
+
+} // namespace asr
@@ -0,0 +1,118 @@
+// Streaming log-mel feature extraction
+//
+// MelKernel turns one window of samples into log10 mel energies: Hann
+// window, real FFT power spectrum, then the filterbank as a packed sparse
+// matmul (each filter stores only its non-zero span, ~2 weights per FFT bin
+// in total instead of mels x bins). MelFrontend feeds it from an incremental
+// hop buffer, so pushing audio costs exactly the frames that became complete
+// and nothing is recomputed.
+//
+// Framing follows Whisper (torch.stft with center=True): frame t is centered
+// on sample t * hop and the signal is reflected at both edges. A frame is
+// emitted once every sample it needs has arrived; flush() closes the stream
+// with the right-edge reflection, giving samples / hop frames in total, the
+// same as the batch computation.
+
+#ifndef ASR_MEL_FRONTEND_H
+#define ASR_MEL_FRONTEND_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "fft.h"
+
+namespace asr {
+
+class MelFilterbank {
+public:
+    MelFilterbank() : mels_(0), bins_(0) {}
+
+    // Pack a dense [mels, bins] matrix, e.g. the one shipped with a model
+    MelFilterbank(const float* dense, int mels, int bins);
+
+    // Slaney-style filterbank (librosa.filters.mel defaults), the one Whisper
+    // was trained with
+    static MelFilterbank slaney(int sampleRate, int fftSize, int mels);
+
+    // out[m] = sum_k filter[m][k] * power[k]
+    void apply(const float* power, float* out) const;
+
+    int mels() const { return mels_; }
+    int bins() const { return bins_; }
+    size_t nonZeros() const { return weights_.size(); }
+
+private:
+    int mels_;
+    int bins_;
+    std::vector<int> start_;        // first non-zero bin per filter
+    std::vector<int> count_;
+    std::vector<size_t> offset_;    // into weights_
+    std::vector<float> weights_;
+};
+
+struct MelConfig {
+    int sampleRate = 16000;
+    int fftSize = 400;       // 25 ms
+    int hopLength = 160;     // 10 ms
+    int mels = 80;           // 128 for large-v3
+    bool center = true;      // reflect-padded, frame t centered on t * hop
+};
+
+class MelKernel {
+public:
+    // An empty filterbank selects MelFilterbank::slaney for the config
+    explicit MelKernel(const MelConfig& config, MelFilterbank filterbank = MelFilterbank());
+
+    // samples holds fftSize values; out receives mels log10 energies
+    void frame(const float* samples, float* out) const;
+
+    const MelConfig& config() const { return config_; }
+    int mels() const { return config_.mels; }
+
+private:
+    MelConfig config_;
+    MelFilterbank filterbank_;
+    RealFft fft_;
+    std::vector<float> window_;
+};
+
+class MelFrontend {
+public:
+    explicit MelFrontend(std::shared_ptr<const MelKernel> kernel);
+
+    // Append samples and compute every frame that became complete. Frames
+    // are appended to frames time-major ([frame][mel]). Returns the count.
+    size_t push(const float* samples, size_t n, std::vector<float>* frames);
+    size_t push(const int16_t* samples, size_t n, std::vector<float>* frames);
+
+    // End of stream: emit the remaining frames with right-edge padding
+    size_t flush(std::vector<float>* frames);
+
+    void reset();
+
+    uint64_t framesEmitted() const { return nextFrame_; }
+    uint64_t samplesReceived() const { return received_; }
+    const MelKernel& kernel() const { return *kernel_; }
+
+private:
+    std::shared_ptr<const MelKernel> kernel_;
+    std::vector<float> buffer_;   // samples from absolute index base_
+    uint64_t base_;
+    uint64_t received_;
+    uint64_t nextFrame_;
+    bool flushed_;
+
+    bool frameReady(uint64_t frame) const;
+    void emit(uint64_t frame, bool atEnd, std::vector<float>* frames);
+    size_t drain(std::vector<float>* frames);
+};
+
+// Whisper's per-window normalization: clamp to 8 (log10 units) below the
+// maximum, then map to roughly [-1, 1]
+void normalizeWhisperMel(float* logMel, size_t count);
+
+} // namespace asr
+
+#endif
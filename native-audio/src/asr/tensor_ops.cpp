@@ -0,0 +1,175 @@
+#include "tensor_ops.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include "quant/gemm.h"
+
+namespace asr {
+
+namespace {
+
+// Output columns handled per task; keeps a block of weight rows hot in cache
+// while it is applied to every input row.
+const size_t kColumnBlock = 16;
+
+} // namespace
+
+float dot(const float* a, const float* b, size_t n) {
+    // Independent lanes let the compiler vectorize without -ffast-math
+    float acc[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        for (size_t j = 0; j < 8; j++) {
+            acc[j] += a[i + j] * b[i + j];
+        }
+    }
+    float sum = ((acc[0] + acc[1]) + (acc[2] + acc[3])) + ((acc[4] + acc[5]) + (acc[6] + acc[7]));
+    for (; i < n; i++) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+void linear(const float* x, size_t rows, size_t in, const float* w, const float* bias,
+            size_t out, float* y, ThreadPool& pool) {
+    const size_t blocks = (out + kColumnBlock - 1) / kColumnBlock;
+    pool.parallelFor(blocks, [&](size_t begin, size_t end) {
+        for (size_t block = begin; block < end; block++) {
+            const size_t o0 = block * kColumnBlock;
+            const size_t o1 = std::min(out, o0 + kColumnBlock);
+            for (size_t r = 0; r < rows; r++) {
+                const float* xr = x + r * in;
+                float* yr = y + r * out;
+                for (size_t o = o0; o < o1; o++) {
+                    yr[o] = dot(xr, w + o * in, in) + (bias ? bias[o] : 0.0f);
+                }
+            }
+        }
+    });
+}
+
+void linear(const float* x, size_t rows, size_t in, const quant::QuantizedMatrix& w,
+            const float* bias, size_t out, float* y, ThreadPool& pool) {
+    // Reused across calls. Workers see the caller's buffer through the
+    // reference; naming the thread_local in the lambda would give each its own.
+    thread_local quant::QuantizedActivations scratch;
+    quant::QuantizedActivations& activations = scratch;
+    quant::quantizeActivations(x, rows, in, &activations);
+
+    const size_t blocks = (out + kColumnBlock - 1) / kColumnBlock;
+    pool.parallelFor(blocks, [&](size_t begin, size_t end) {
+        quant::gemm(activations, w, begin * kColumnBlock, std::min(out, end * kColumnBlock), bias, y, out);
+    });
+}
+
+void layerNorm(const float* x, float* y, size_t rows, size_t dim, const float* gamma,
+               const float* beta, float eps) {
+    for (size_t r = 0; r < rows; r++) {
+        const float* xr = x + r * dim;
+        float* yr = y + r * dim;
+        double mean = 0.0;
+        for (size_t i = 0; i < dim; i++) mean += xr[i];
+        mean /= static_cast<double>(dim);
+        double var = 0.0;
+        for (size_t i = 0; i < dim; i++) {
+            const double d = xr[i] - mean;
+            var += d * d;
+        }
+        var /= static_cast<double>(dim);
+        const float scale = static_cast<float>(1.0 / std::sqrt(var + eps));
+        const float m = static_cast<float>(mean);
+        for (size_t i = 0; i < dim; i++) {
+            yr[i] = (xr[i] - m) * scale * gamma[i] + beta[i];
+        }
+    }
+}
+
+void layerNorm(float* x, size_t rows, size_t dim, const float* gamma, const float* beta,
+               float eps) {
+    layerNorm(x, x, rows, dim, gamma, beta, eps);
+}
+
+void gelu(float* x, size_t n) {
+    const float invSqrt2 = 0.70710678118654752f;
+    for (size_t i = 0; i < n; i++) {
+        x[i] = 0.5f * x[i] * (1.0f + std::erf(x[i] * invSqrt2));
+    }
+}
+
+void add(float* x, const float* y, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        x[i] += y[i];
+    }
+}
+
+void softmax(float* x, size_t n) {
+    float maxValue = -std::numeric_limits<float>::infinity();
+    for (size_t i = 0; i < n; i++) maxValue = std::max(maxValue, x[i]);
+    if (maxValue == -std::numeric_limits<float>::infinity()) {
+        std::fill(x, x + n, 0.0f);
+        return;
+    }
+    double sum = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        x[i] = std::exp(x[i] - maxValue);
+        sum += x[i];
+    }
+    const float inv = static_cast<float>(1.0 / sum);
+    for (size_t i = 0; i < n; i++) x[i] *= inv;
+}
+
+void attention(const float* q, size_t t, const float* k, const float* v, size_t s,
+               size_t dim, size_t heads, bool causal, size_t past, float* out,
+               ThreadPool& pool) {
+    const size_t headDim = dim / heads;
+    const float scale = 1.0f / std::sqrt(static_cast<float>(headDim));
+
+    pool.parallelFor(heads * t, [&](size_t begin, size_t end) {
+        std::vector<float> scores(s);
+        for (size_t task = begin; task < end; task++) {
+            const size_t h = task / t;
+            const size_t i = task % t;
+            const size_t visible = causal ? std::min(s, past + i + 1) : s;
+            const float* qi = q + i * dim + h * headDim;
+
+            for (size_t j = 0; j < visible; j++) {
+                scores[j] = dot(qi, k + j * dim + h * headDim, headDim) * scale;
+            }
+            softmax(scores.data(), visible);
+
+            float* oi = out + i * dim + h * headDim;
+            std::fill(oi, oi + headDim, 0.0f);
+            for (size_t j = 0; j < visible; j++) {
+                const float p = scores[j];
+                const float* vj = v + j * dim + h * headDim;
+                for (size_t d = 0; d < headDim; d++) {
+                    oi[d] += p * vj[d];
+                }
+            }
+        }
+    });
+}
+
+void im2col3(const float* x, size_t frames, size_t channels, bool channelMajor,
+             size_t stride, float* cols, size_t outFrames, size_t firstOut) {
+    for (size_t t = firstOut; t < outFrames; t++) {
+        float* row = cols + (t - firstOut) * channels * 3;
+        for (size_t c = 0; c < channels; c++) {
+            for (size_t kk = 0; kk < 3; kk++) {
+                const long src = static_cast<long>(t * stride + kk) - 1;
+                float value = 0.0f;
+                if (src >= 0 && static_cast<size_t>(src) < frames) {
+                    value = channelMajor ? x[c * frames + static_cast<size_t>(src)]
+                                         : x[static_cast<size_t>(src) * channels + c];
+                }
+                row[c * 3 + kk] = value;
+            }
+        }
+    }
+}
+
+} // namespace asr
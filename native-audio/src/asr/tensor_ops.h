@@ -0,0 +1,52 @@
+// Dense fp32 kernels for the transformer forward pass
+//
+// Activations are row-major [rows, features]. Weights use the PyTorch layout
+// [out, in], so a linear layer is one dot product per (row, output) pair and
+// weight rows are read contiguously.
+
+#ifndef ASR_TENSOR_OPS_H
+#define ASR_TENSOR_OPS_H
+
+#include <cstddef>
+
+#include "quant/quantize.h"
+#include "thread_pool.h"
+
+namespace asr {
+
+float dot(const float* a, const float* b, size_t n);
+
+// y[rows, out] = x[rows, in] * w[out, in]^T + bias (bias may be null)
+void linear(const float* x, size_t rows, size_t in, const float* w, const float* bias,
+            size_t out, float* y, ThreadPool& pool);
+
+// Same with int8/int4 weights: x is quantized per 32 values, then the
+// integer kernels picked for this CPU run over blocks of outputs
+void linear(const float* x, size_t rows, size_t in, const quant::QuantizedMatrix& w,
+            const float* bias, size_t out, float* y, ThreadPool& pool);
+
+void layerNorm(float* x, size_t rows, size_t dim, const float* gamma, const float* beta,
+               float eps = 1e-5f);
+void layerNorm(const float* x, float* y, size_t rows, size_t dim, const float* gamma,
+               const float* beta, float eps = 1e-5f);
+
+void gelu(float* x, size_t n);
+void add(float* x, const float* y, size_t n);
+void softmax(float* x, size_t n);
+
+// Multi-head scaled dot-product attention. q is [t, dim], k/v are [s, dim].
+// With causal set, query row i sees keys [0, past + i].
+void attention(const float* q, size_t t, const float* k, const float* v, size_t s,
+               size_t dim, size_t heads, bool causal, size_t past, float* out,
+               ThreadPool& pool);
+
+// Gather conv1d (kernel 3, padding 1) input windows into rows so the
+// convolution becomes a linear layer against the [out, in * 3] weight.
+// x is [frames, channels] time-major unless channelMajor is set. Only
+// output rows [firstOut, outFrames) are written, starting at cols.
+void im2col3(const float* x, size_t frames, size_t channels, bool channelMajor,
+             size_t stride, float* cols, size_t outFrames, size_t firstOut = 0);
+
+} // namespace asr
+
+#endif
@@ -0,0 +1,78 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+
+namespace asr {
+
+ThreadPool::ThreadPool(int threads)
+    : job_(nullptr), jobSize_(0), generation_(0), pending_(0), stopping_(false) {
+    if (threads <= 0) {
+        threads = static_cast<int>(std::min(8u, std::max(1u, std::thread::hardware_concurrency())));
+    }
+    for (int i = 1; i < threads; i++) {
+        workers_.emplace_back(&ThreadPool::workerLoop, this, static_cast<size_t>(i));
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+}
+
+void ThreadPool::runSlice(size_t index, size_t slices) {
+    const size_t begin = jobSize_ * index / slices;
+    const size_t end = jobSize_ * (index + 1) / slices;
+    if (begin < end) {
+        (*job_)(begin, end);
+    }
+}
+
+void ThreadPool::workerLoop(size_t index) {
+    size_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+            if (stopping_) return;
+            seen = generation_;
+        }
+
+        runSlice(index, static_cast<size_t>(size()));
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--pending_ == 0) {
+            done_.notify_one();
+        }
+    }
+}
+
+void ThreadPool::parallelFor(size_t n, const std::function<void(size_t, size_t)>& fn) {
+    if (n == 0) return;
+    if (workers_.empty() || n == 1) {
+        fn(0, n);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        job_ = &fn;
+        jobSize_ = n;
+        pending_ = workers_.size();
+        generation_++;
+    }
+    wake_.notify_all();
+
+    runSlice(0, static_cast<size_t>(size()));
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [&] { return pending_ == 0; });
+    job_ = nullptr;
+}
+
+} // namespace asr
@@ -0,0 +1,47 @@
+// Minimal fork-join pool for the recognizer's data-parallel loops
+
+#ifndef ASR_THREAD_POOL_H
+#define ASR_THREAD_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace asr {
+
+class ThreadPool {
+public:
+    // threads <= 0 picks hardware_concurrency() (capped at 8)
+    explicit ThreadPool(int threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Split [0, n) into contiguous ranges and run fn(begin, end) on each,
+    // using the calling thread as one of the workers. Blocks until done.
+    void parallelFor(size_t n, const std::function<void(size_t, size_t)>& fn);
+
+    int size() const { return static_cast<int>(workers_.size()) + 1; }
+
+private:
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    const std::function<void(size_t, size_t)>* job_;
+    size_t jobSize_;
+    size_t generation_;
+    size_t pending_;
+    bool stopping_;
+
+    void workerLoop(size_t index);
+    void runSlice(size_t index, size_t slices);
+};
+
+} // namespace asr
+
+#endif
@@ -0,0 +1,427 @@
+#include "whisper_engine.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "tensor_ops.h"
+
+namespace asr {
+
+namespace {
+
+const float kNegInf = -std::numeric_limits<float>::infinity();
+const int kMaxInitialTimestamp = 50;   // 1.0 s in 20 ms timestamp steps
+const size_t kMinWindowFrames = 10;    // ignore tails shorter than 100 ms
+
+double elapsedMs(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+}
+
+void ensure(std::vector<float>* buffer, size_t size) {
+    if (buffer->size() < size) buffer->resize(size);
+}
+
+std::string trimmed(const std::string& text) {
+    const size_t begin = text.find_first_not_of(' ');
+    if (begin == std::string::npos) return std::string();
+    return text.substr(begin, text.find_last_not_of(' ') - begin + 1);
+}
+
+// Projection through a model weight, f32 or quantized at load
+void linear(const float* x, size_t rows, size_t in, const Tensor* w, const Tensor* bias,
+            size_t out, float* y, ThreadPool& pool) {
+    const float* b = bias ? bias->ptr() : nullptr;
+    if (w->isQuantized()) {
+        asr::linear(x, rows, in, w->quantized, b, out, y, pool);
+    } else {
+        asr::linear(x, rows, in, w->ptr(), b, out, y, pool);
+    }
+}
+
+void tensorRow(const Tensor& tensor, size_t row, size_t width, float* out) {
+    if (tensor.isQuantized()) {
+        quant::dequantizeRow(tensor.quantized, row, out);
+    } else {
+        std::memcpy(out, tensor.ptr() + row * width, width * sizeof(float));
+    }
+}
+
+} // namespace
+
+WhisperEngine::WhisperEngine(std::shared_ptr<const WhisperModel> model, int threads)
+    : model_(std::move(model)),
+      pool_(threads),
+      mel_(model_->melFilters(), model_->hparams().nMels, model_->melFftBins()),
+      ctx_(0) {
+    const WhisperHParams& hp = model_->hparams();
+    const size_t state = static_cast<size_t>(hp.nTextState);
+    selfK_.resize(static_cast<size_t>(hp.nTextLayer) * hp.nTextCtx * state);
+    selfV_.resize(selfK_.size());
+}
+
+void WhisperEngine::conv1(const float* mel, bool channelMajor, size_t frames, size_t from, size_t to,
+                          float* out) {
+    if (from >= to) return;
+    const WhisperModel& m = *model_;
+    const size_t state = static_cast<size_t>(m.hparams().nAudioState);
+    const size_t mels = static_cast<size_t>(m.hparams().nMels);
+    ensure(&scratch_, (to - from) * mels * 3);
+    im2col3(mel, frames, mels, channelMajor, 1, scratch_.data(), to, from);
+    linear(scratch_.data(), to - from, mels * 3, m.conv1W, m.conv1B, state, out + from * state, pool_);
+    gelu(out + from * state, (to - from) * state);
+}
+
+void WhisperEngine::conv2(const float* conv, size_t frames, size_t from, size_t to, float* out) {
+    if (from >= to) return;
+    const WhisperModel& m = *model_;
+    const size_t state = static_cast<size_t>(m.hparams().nAudioState);
+    ensure(&scratch_, (to - from) * state * 3);
+    im2col3(conv, frames, state, false, 2, scratch_.data(), to, from);
+    linear(scratch_.data(), to - from, state * 3, m.conv2W, m.conv2B, state, out + from * state, pool_);
+    gelu(out + from * state, (to - from) * state);
+}
+
+void WhisperEngine::encode(size_t ctx) {
+    const WhisperModel& m = *model_;
+    const size_t state = static_cast<size_t>(m.hparams().nAudioState);
+    const size_t frames = 2 * ctx;
+
+    conv1_.resize(frames * state);
+    conv1(melBuffer_.data(), true, frames, 0, frames, conv1_.data());
+    encoded_.resize(ctx * state);
+    conv2(conv1_.data(), frames, 0, ctx, encoded_.data());
+    add(encoded_.data(), m.encoderPositional->ptr(), ctx * state);
+    encodeLayers(ctx);
+}
+
+void WhisperEngine::encodeLayers(size_t ctx) {
+    const WhisperModel& m = *model_;
+    const WhisperHParams& hp = m.hparams();
+    const size_t state = static_cast<size_t>(hp.nAudioState);
+    const size_t heads = static_cast<size_t>(hp.nAudioHead);
+
+    // Scratch: h, then q/k/v/attention; the mlp reuses q onwards
+    ensure(&scratch_, ctx * state * 5);
+    float* x = encoded_.data();
+    float* h = scratch_.data();
+    float* q = h + ctx * state;
+    float* k = q + ctx * state;
+    float* v = k + ctx * state;
+    float* a = v + ctx * state;
+    float* mlp = q;   // 4 * ctx * state
+
+    for (const EncoderLayer& layer : m.encoderLayers) {
+        layerNorm(x, h, ctx, state, layer.attnLnW->ptr(), layer.attnLnB->ptr());
+        linear(h, ctx, state, layer.queryW, layer.queryB, state, q, pool_);
+        linear(h, ctx, state, layer.keyW, nullptr, state, k, pool_);
+        linear(h, ctx, state, layer.valueW, layer.valueB, state, v, pool_);
+        attention(q, ctx, k, v, ctx, state, heads, false, 0, a, pool_);
+        linear(a, ctx, state, layer.outW, layer.outB, state, h, pool_);
+        add(x, h, ctx * state);
+
+        layerNorm(x, h, ctx, state, layer.mlpLnW->ptr(), layer.mlpLnB->ptr());
+        linear(h, ctx, state, layer.mlp0W, layer.mlp0B, 4 * state, mlp, pool_);
+        gelu(mlp, ctx * 4 * state);
+        linear(mlp, ctx, 4 * state, layer.mlp2W, layer.mlp2B, state, h, pool_);
+        add(x, h, ctx * state);
+    }
+    layerNorm(x, ctx, state, m.encoderLnW->ptr(), m.encoderLnB->ptr());
+    ctx_ = ctx;
+}
+
+void WhisperEngine::prepareCross() {
+    const WhisperModel& m = *model_;
+    const size_t state = static_cast<size_t>(m.hparams().nTextState);
+    const size_t layerSize = ctx_ * state;
+    crossK_.resize(m.decoderLayers.size() * layerSize);
+    crossV_.resize(crossK_.size());
+    for (size_t i = 0; i < m.decoderLayers.size(); i++) {
+        const DecoderLayer& layer = m.decoderLayers[i];
+        linear(encoded_.data(), ctx_, state, layer.crossKeyW, nullptr, state,
+               crossK_.data() + i * layerSize, pool_);
+        linear(encoded_.data(), ctx_, state, layer.crossValueW, layer.crossValueB,
+               state, crossV_.data() + i * layerSize, pool_);
+    }
+}
+
+void WhisperEngine::decode(const int32_t* tokens, size_t count, size_t past,
+                           std::vector<float>* logits, size_t logitRows) {
+    const WhisperModel& m = *model_;
+    const WhisperHParams& hp = m.hparams();
+    const size_t state = static_cast<size_t>(hp.nTextState);
+    const size_t heads = static_cast<size_t>(hp.nTextHead);
+    const size_t textCtx = static_cast<size_t>(hp.nTextCtx);
+    const size_t vocab = static_cast<size_t>(hp.nVocab);
+
+    ensure(&scratch_, count * state * 8);
+    float* x = scratch_.data();
+    float* h = x + count * state;
+    float* q = h + count * state;
+    float* a = q + count * state;
+    float* mlp = a + count * state;   // 4 * count * state
+
+    const float* positional = m.decoderPositional->ptr();
+    for (size_t i = 0; i < count; i++) {
+        float* xi = x + i * state;
+        tensorRow(*m.tokenEmbedding, static_cast<size_t>(tokens[i]), state, xi);
+        const float* p = positional + (past + i) * state;
+        for (size_t d = 0; d < state; d++) {
+            xi[d] += p[d];
+        }
+    }
+
+    for (size_t l = 0; l < m.decoderLayers.size(); l++) {
+        const DecoderLayer& layer = m.decoderLayers[l];
+        const EncoderLayer& self = layer.self;
+        float* kCache = selfK_.data() + l * textCtx * state;
+        float* vCache = selfV_.data() + l * textCtx * state;
+
+        layerNorm(x, h, count, state, self.attnLnW->ptr(), self.attnLnB->ptr());
+        linear(h, count, state, self.queryW, self.queryB, state, q, pool_);
+        linear(h, count, state, self.keyW, nullptr, state, kCache + past * state, pool_);
+        linear(h, count, state, self.valueW, self.valueB, state,
+               vCache + past * state, pool_);
+        attention(q, count, kCache, vCache, past + count, state, heads, true, past, a, pool_);
+        linear(a, count, state, self.outW, self.outB, state, h, pool_);
+        add(x, h, count * state);
+
+        layerNorm(x, h, count, state, layer.crossLnW->ptr(), layer.crossLnB->ptr());
+        linear(h, count, state, layer.crossQueryW, layer.crossQueryB, state, q, pool_);
+        attention(q, count, crossK_.data() + l * ctx_ * state, crossV_.data() + l * ctx_ * state,
+                  ctx_, state, heads, false, 0, a, pool_);
+        linear(a, count, state, layer.crossOutW, layer.crossOutB, state, h, pool_);
+        add(x, h, count * state);
+
+        layerNorm(x, h, count, state, self.mlpLnW->ptr(), self.mlpLnB->ptr());
+        linear(h, count, state, self.mlp0W, self.mlp0B, 4 * state, mlp, pool_);
+        gelu(mlp, count * 4 * state);
+        linear(mlp, count, 4 * state, self.mlp2W, self.mlp2B, state, h, pool_);
+        add(x, h, count * state);
+    }
+
+    // Only the last positions are sampled; the output projection is tied to
+    // the token embedding
+    logitRows = std::min(std::max<size_t>(logitRows, 1), count);
+    float* last = x + (count - logitRows) * state;
+    layerNorm(last, h, logitRows, state, m.decoderLnW->ptr(), m.decoderLnB->ptr());
+    logits->resize(logitRows * vocab);
+    linear(h, logitRows, state, m.tokenEmbedding, nullptr, vocab, logits->data(), pool_);
+}
+
+int WhisperEngine::detectLanguage(float* probability) {
+    const WhisperTokens& tokens = model_->tokens();
+    std::vector<float> logits;
+    decode(&tokens.sot, 1, 0, &logits);
+
+    const int count = std::min(tokens.languageCount, languageCount());
+    std::vector<float> scores(static_cast<size_t>(count));
+    for (int i = 0; i < count; i++) {
+        scores[i] = logits[static_cast<size_t>(tokens.language(i))];
+    }
+    softmax(scores.data(), scores.size());
+    const int best = static_cast<int>(std::max_element(scores.begin(), scores.end()) - scores.begin());
+    *probability = scores[best];
+    return best;
+}
+
+void WhisperEngine::applyRules(const std::vector<int32_t>& sampled, bool timestamps,
+                               size_t windowTs, std::vector<float>* logits) const {
+    const WhisperTokens& tokens = model_->tokens();
+    std::vector<float>& l = *logits;
+    const int32_t vocab = static_cast<int32_t>(l.size());
+    const int32_t begin = tokens.timestampBegin;
+
+    // Control tokens are never generated
+    for (int32_t t = tokens.sot; t < begin; t++) l[t] = kNegInf;
+    if (!timestamps) {
+        for (int32_t t = begin; t < vocab; t++) l[t] = kNegInf;
+    }
+    // No empty transcript
+    if (sampled.empty()) l[tokens.eot] = kNegInf;
+    if (!timestamps) return;
+
+    // Timestamps beyond the audio in this window are impossible
+    for (int32_t t = begin + static_cast<int32_t>(windowTs) + 1; t < vocab; t++) l[t] = kNegInf;
+
+    // Timestamps come in pairs, except directly before eot
+    const bool lastWasTs = !sampled.empty() && sampled.back() >= begin;
+    const bool penultimateWasTs = sampled.size() < 2 || sampled[sampled.size() - 2] >= begin;
+    if (lastWasTs) {
+        if (penultimateWasTs) {
+            for (int32_t t = begin; t < vocab; t++) l[t] = kNegInf;
+        } else {
+            for (int32_t t = 0; t < tokens.eot; t++) l[t] = kNegInf;
+        }
+    }
+
+    // ... and never go backwards
+    for (auto it = sampled.rbegin(); it != sampled.rend(); ++it) {
+        if (*it >= begin) {
+            const int32_t floor = (lastWasTs && !penultimateWasTs) ? *it : *it + 1;
+            for (int32_t t = begin; t < std::min(floor, vocab); t++) l[t] = kNegInf;
+            break;
+        }
+    }
+
+    // The first token is a timestamp no later than 1 s
+    if (sampled.empty()) {
+        for (int32_t t = 0; t < begin; t++) l[t] = kNegInf;
+        for (int32_t t = begin + kMaxInitialTimestamp + 1; t < vocab; t++) l[t] = kNegInf;
+    }
+
+    // Prefer a timestamp when their total probability beats every text token
+    float maxValue = kNegInf;
+    for (int32_t t = 0; t < vocab; t++) maxValue = std::max(maxValue, l[t]);
+    if (maxValue == kNegInf) return;
+    double sum = 0.0;
+    for (int32_t t = 0; t < vocab; t++) sum += std::exp(static_cast<double>(l[t] - maxValue));
+    const double logSum = std::log(sum) + maxValue;
+
+    double tsSum = 0.0;
+    for (int32_t t = begin; t < vocab; t++) tsSum += std::exp(static_cast<double>(l[t] - maxValue));
+    float maxText = kNegInf;
+    for (int32_t t = 0; t < begin; t++) maxText = std::max(maxText, l[t]);
+    if (tsSum > 0.0 && std::log(tsSum) + maxValue - logSum > maxText - logSum) {
+        for (int32_t t = 0; t < begin; t++) l[t] = kNegInf;
+    }
+}
+
+bool WhisperEngine::transcribe(const float* pcm, size_t n, const TranscribeOptions& options,
+                               TranscribeResult* result, std::string* error) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const WhisperModel& m = *model_;
+    const WhisperHParams& hp = m.hparams();
+    const WhisperTokens& tokens = m.tokens();
+
+    *result = TranscribeResult();
+    if (!m.verify(error)) return false;
+    const size_t ctx = options.audioCtx > 0
+                           ? std::min(static_cast<size_t>(options.audioCtx), static_cast<size_t>(hp.nAudioCtx))
+                           : static_cast<size_t>(hp.nAudioCtx);
+    const size_t windowFrames = 2 * ctx;
+    const size_t textCtx = static_cast<size_t>(hp.nTextCtx);
+    const size_t maxTokens = options.maxTokens > 0
+                                 ? std::min(static_cast<size_t>(options.maxTokens), textCtx / 2)
+                                 : textCtx / 2;
+
+    int languageIdx = -1;
+    if (options.language != "auto" && !options.language.empty()) {
+        languageIdx = languageIndex(options.language);
+        if (languageIdx < 0 || (m.multilingual() && languageIdx >= tokens.languageCount)) {
+            *error = "unsupported language: " + options.language;
+            return false;
+        }
+    }
+    if (!m.multilingual() && (options.translate || (languageIdx > 0))) {
+        *error = "model " + m.modelType() + " is English-only";
+        return false;
+    }
+    if (!m.multilingual()) languageIdx = 0;
+    result->language = languageCode(std::max(languageIdx, 0));
+    result->languageProbability = languageIdx >= 0 ? 1.0f : 0.0f;
+
+    const size_t totalFrames = n / kHopLength;
+    std::vector<float> logits;
+    std::vector<int32_t> sampled;
+    size_t seek = 0;
+
+    while (seek + kMinWindowFrames <= totalFrames) {
+        const size_t frames = std::min(windowFrames, totalFrames - seek);
+        const size_t offset = seek * kHopLength;
+
+        auto start = std::chrono::steady_clock::now();
+        mel_.compute(pcm + offset, n - offset, windowFrames, &melBuffer_, pool_);
+        result->timings.melMs += elapsedMs(start);
+
+        start = std::chrono::steady_clock::now();
+        encode(ctx);
+        prepareCross();
+        result->timings.encodeMs += elapsedMs(start);
+
+        start = std::chrono::steady_clock::now();
+        if (languageIdx < 0) {
+            float probability = 0.0f;
+            languageIdx = detectLanguage(&probability);
+            result->language = languageCode(languageIdx);
+            result->languageProbability = probability;
+        }
+
+        std::vector<int32_t> prompt;
+        prompt.push_back(tokens.sot);
+        if (m.multilingual()) {
+            prompt.push_back(tokens.language(languageIdx));
+            prompt.push_back(options.translate ? tokens.translate : tokens.transcribe);
+        }
+        if (!options.timestamps) prompt.push_back(tokens.noTimestamps);
+
+        // Timestamps are 20 ms steps; the window holds frames / 2 of them
+        const size_t windowTs = frames / 2;
+        sampled.clear();
+        decode(prompt.data(), prompt.size(), 0, &logits);
+        for (size_t past = prompt.size(); sampled.size() < maxTokens && past < textCtx; past++) {
+            applyRules(sampled, options.timestamps, windowTs, &logits);
+            const int32_t token = static_cast<int32_t>(
+                std::max_element(logits.begin(), logits.end()) - logits.begin());
+            if (token == tokens.eot || logits[static_cast<size_t>(token)] == kNegInf) break;
+            sampled.push_back(token);
+            if (past + 1 >= textCtx) break;
+            decode(&token, 1, past, &logits);
+        }
+        result->timings.decodeMs += elapsedMs(start);
+        result->timings.tokens += static_cast<int>(sampled.size());
+        result->timings.windows++;
+
+        // Split the tokens into timed segments
+        const int64_t windowStartMs = static_cast<int64_t>(seek) * 10;
+        const int64_t windowEndMs = windowStartMs + static_cast<int64_t>(frames) * 10;
+        const int32_t begin = tokens.timestampBegin;
+        std::vector<TranscriptSegment> segments;
+        std::string text;
+        int64_t segmentStart = windowStartMs;
+        int32_t lastPaired = -1;
+        for (size_t i = 0; i < sampled.size(); i++) {
+            const int32_t token = sampled[i];
+            if (token >= begin) {
+                const int64_t at = windowStartMs + static_cast<int64_t>(token - begin) * 20;
+                if (i > 0 && sampled[i - 1] >= begin) lastPaired = token - begin;
+                if (!trimmed(text).empty()) {
+                    segments.push_back({segmentStart, at, trimmed(text)});
+                }
+                text.clear();
+                segmentStart = at;
+            } else if (token < tokens.eot) {
+                text += m.tokenText(token);
+            }
+        }
+        if (!trimmed(text).empty()) {
+            segments.push_back({segmentStart, windowEndMs, trimmed(text)});
+        }
+
+        // Resume after the last complete segment when the window was full and
+        // the model stopped mid-sentence; otherwise the window is consumed
+        const bool singleTimestampEnding = sampled.size() >= 2 && sampled.back() >= begin &&
+                                           sampled[sampled.size() - 2] < begin;
+        size_t advance = frames;
+        if (options.timestamps && frames == windowFrames && lastPaired > 0 && !singleTimestampEnding) {
+            advance = static_cast<size_t>(lastPaired) * 2;
+            const int64_t cutMs = windowStartMs + static_cast<int64_t>(lastPaired) * 20;
+            while (!segments.empty() && segments.back().startMs >= cutMs) {
+                segments.pop_back();
+            }
+        }
+
+        for (TranscriptSegment& segment : segments) {
+            segment.endMs = std::min(std::max(segment.endMs, segment.startMs), windowEndMs);
+            if (!result->text.empty()) result->text += " ";
+            result->text += segment.text;
+            result->segments.push_back(std::move(segment));
+        }
+        seek += advance;
+    }
+    return true;
+}
+
+} // namespace asr
@@ -0,0 +1,107 @@
+// On-device Whisper inference (encoder + greedy decoder)
+//
+// Audio is processed in 30-second windows. Each window is encoded once; the
+// decoder keeps a self-attention KV cache and the per-layer cross-attention
+// keys/values of the encoder output, so every generated token costs one
+// single-row pass through the decoder. Decoding is greedy with Whisper's
+// timestamp rules (paired, monotonic, capped initial timestamp), which also
+// drive how far the next window starts.
+
+#ifndef ASR_WHISPER_ENGINE_H
+#define ASR_WHISPER_ENGINE_H
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "thread_pool.h"
+#include "whisper_mel.h"
+#include "whisper_model.h"
+
+namespace asr {
+
+struct TranscribeOptions {
+    std::string language = "auto";  // ISO code, or "auto" to detect from the first window
+    bool translate = false;          // translate to English instead of transcribing
+    bool timestamps = true;          // produce timed segments
+    int maxTokens = 0;               // per window; 0 = half the text context
+    int audioCtx = 0;                // encoder positions; 0 = model default (30 s)
+};
+
+struct TranscriptSegment {
+    int64_t startMs = 0;
+    int64_t endMs = 0;
+    std::string text;
+};
+
+struct TranscribeTimings {
+    double melMs = 0.0;
+    double encodeMs = 0.0;
+    double decodeMs = 0.0;
+    int windows = 0;
+    int tokens = 0;
+};
+
+struct TranscribeResult {
+    std::string language;
+    float languageProbability = 0.0f;
+    std::string text;
+    std::vector<TranscriptSegment> segments;
+    TranscribeTimings timings;
+};
+
+class WhisperEngine {
+public:
+    // threads <= 0 picks a default from the hardware
+    WhisperEngine(std::shared_ptr<const WhisperModel> model, int threads);
+
+    WhisperEngine(const WhisperEngine&) = delete;
+    WhisperEngine& operator=(const WhisperEngine&) = delete;
+
+    // pcm is mono float at 16 kHz. Calls are serialized per engine.
+    bool transcribe(const float* pcm, size_t n, const TranscribeOptions& options,
+                    TranscribeResult* result, std::string* error);
+
+    const WhisperModel& model() const { return *model_; }
+    int threads() const { return pool_.size(); }
+
+private:
+    friend class WhisperStream;
+
+    std::shared_ptr<const WhisperModel> model_;
+    ThreadPool pool_;
+    LogMel mel_;
+    std::mutex mutex_;
+
+    size_t ctx_;                        // encoder positions of the current window
+    std::vector<float> melBuffer_;
+    std::vector<float> conv1_;          // [2 * ctx, state]
+    std::vector<float> encoded_;        // [ctx, state]
+    std::vector<float> crossK_;         // per layer [ctx, state]
+    std::vector<float> crossV_;
+    std::vector<float> selfK_;          // per layer [textCtx, state]
+    std::vector<float> selfV_;
+    std::vector<float> scratch_;
+
+    void encode(size_t ctx);
+    // Conv stem: rows [from, to) of the first (stride 1) and second (stride
+    // 2) convolution, written to out + from * state; other rows are kept
+    void conv1(const float* mel, bool channelMajor, size_t frames, size_t from, size_t to, float* out);
+    void conv2(const float* conv, size_t frames, size_t from, size_t to, float* out);
+    // Transformer layers over encoded_, which holds stem output + positions
+    void encodeLayers(size_t ctx);
+    void prepareCross();
+    // Run tokens at positions [past, past + count) and write the logits of the
+    // last logitRows of them, [logitRows, vocab]
+    void decode(const int32_t* tokens, size_t count, size_t past, std::vector<float>* logits,
+                size_t logitRows = 1);
+    int detectLanguage(float* probability);
+    void applyRules(const std::vector<int32_t>& sampled, bool timestamps, size_t windowTs,
+                    std::vector<float>* logits) const;
+};
+
+} // namespace asr
+
+#endif
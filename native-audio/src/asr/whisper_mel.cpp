@@ -0,0 +1,61 @@
+#include "whisper_mel.h"
+
+#include <algorithm>
+
+namespace asr {
+
+namespace {
+
+MelConfig whisperConfig(int nMels) {
+    MelConfig config;
+    config.sampleRate = kSampleRate;
+    config.fftSize = kFftSize;
+    config.hopLength = kHopLength;
+    config.mels = nMels;
+    config.center = true;
+    return config;
+}
+
+} // namespace
+
+LogMel::LogMel(const std::vector<float>& filters, int nMels, int fftBins)
+    : kernel_(std::make_shared<MelKernel>(whisperConfig(nMels), MelFilterbank(filters.data(), nMels, fftBins))) {
+}
+
+void LogMel::compute(const float* pcm, size_t n, size_t frames, std::vector<float>* mel,
+                     ThreadPool& pool) const {
+    const int nMels = kernel_->mels();
+    const long length = static_cast<long>(std::max(n, frames * kHopLength));
+    auto sample = [&](long i) -> float {
+        // Centered frames: reflect at both edges of the padded signal
+        if (i < 0) i = -i;
+        if (i >= length) i = 2 * (length - 1) - i;
+        return i >= 0 && static_cast<size_t>(i) < n ? pcm[i] : 0.0f;
+    };
+
+    mel->resize(static_cast<size_t>(nMels) * frames);
+    float* out = mel->data();
+
+    pool.parallelFor(frames, [&](size_t begin, size_t end) {
+        float window[kFftSize];
+        std::vector<float> column(static_cast<size_t>(nMels));
+        for (size_t t = begin; t < end; t++) {
+            const long start = static_cast<long>(t) * kHopLength - kFftSize / 2;
+            if (start >= 0 && static_cast<size_t>(start) + kFftSize <= n) {
+                std::copy(pcm + start, pcm + start + kFftSize, window);
+            } else {
+                for (int i = 0; i < kFftSize; i++) {
+                    window[i] = sample(start + i);
+                }
+            }
+            kernel_->frame(window, column.data());
+            for (int m = 0; m < nMels; m++) {
+                out[static_cast<size_t>(m) * frames + t] = column[m];
+            }
+        }
+    });
+
+    normalizeWhisperMel(out, mel->size());
+}
+
+} // namespace asr
@@ -0,0 +1,43 @@
+// Whisper log-mel spectrogram (16 kHz, 25 ms Hann window, 10 ms hop)
+
+#ifndef ASR_WHISPER_MEL_H
+#define ASR_WHISPER_MEL_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "mel_frontend.h"
+#include "thread_pool.h"
+
+namespace asr {
+
+const int kSampleRate = 16000;
+const int kFftSize = 400;
+const int kHopLength = 160;
+const int kChunkSeconds = 30;
+const int kChunkFrames = kChunkSeconds * kSampleRate / kHopLength;  // 3000
+
+class LogMel {
+public:
+    // filters is [nMels, fftBins] as shipped with the model
+    LogMel(const std::vector<float>& filters, int nMels, int fftBins);
+
+    // Compute `frames` frames from pcm (zero-padded past n) into mel, laid
+    // out [nMels, frames]. Normalized like Whisper: log10, clamped to 8
+    // below the maximum, scaled to roughly [-1, 1].
+    void compute(const float* pcm, size_t n, size_t frames, std::vector<float>* mel,
+                 ThreadPool& pool) const;
+
+    int mels() const { return kernel_->mels(); }
+
+    // Frame kernel with the model's filterbank, for streaming frontends
+    std::shared_ptr<const MelKernel> kernel() const { return kernel_; }
+
+private:
+    std::shared_ptr<const MelKernel> kernel_;
+};
+
+} // namespace asr
+
+#endif
@@ -0,0 +1,620 @@
+#include "whisper_model.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include "storage/file_util.h"
+
+namespace asr {
+
+namespace {
+
+const uint32_t kGgmlMagic = 0x67676d6c;  // "ggml"
+const int32_t kTypeF32 = 0;
+const int32_t kTypeF16 = 1;
+const size_t kHParamCount = 11;
+const char* const kContainerKind = "whisper";
+
+const char* const kLanguages[] = {
+    "en", "zh", "de", "es", "ru", "ko", "fr", "ja", "pt", "tr", "pl", "ca", "nl",
+    "ar", "sv", "it", "id", "hi", "fi", "vi", "he", "uk", "el", "ms", "cs", "ro",
+    "da", "hu", "ta", "no", "th", "ur", "hr", "bg", "lt", "la", "mi", "ml", "cy",
+    "sk", "te", "fa", "lv", "bn", "sr", "az", "sl", "kn", "et", "mk", "br", "eu",
+    "is", "hy", "ne", "mn", "bs", "kk", "sq", "sw", "gl", "mr", "pa", "si", "km",
+    "sn", "yo", "so", "af", "oc", "ka", "be", "tg", "sd", "gu", "am", "yi", "lo",
+    "uz", "fo", "ht", "ps", "tk", "nn", "mt", "sa", "lb", "my", "bo", "tl", "mg",
+    "as", "tt", "haw", "ln", "ha", "ba", "jw", "su", "yue",
+};
+
+struct FileCloser {
+    void operator()(std::FILE* file) const { std::fclose(file); }
+};
+
+template <typename T>
+bool readValue(std::FILE* file, T* value) {
+    return std::fread(value, sizeof(T), 1, file) == 1;
+}
+
+float halfToFloat(uint16_t h) {
+    const uint32_t sign = static_cast<uint32_t>(h & 0x8000) << 16;
+    uint32_t exponent = (h >> 10) & 0x1f;
+    uint32_t mantissa = h & 0x3ff;
+    uint32_t bits;
+    if (exponent == 0) {
+        if (mantissa == 0) {
+            bits = sign;
+        } else {
+            // Subnormal: renormalize
+            exponent = 127 - 15 + 1;
+            while ((mantissa & 0x400) == 0) {
+                mantissa <<= 1;
+                exponent--;
+            }
+            bits = sign | (exponent << 23) | ((mantissa & 0x3ff) << 13);
+        }
+    } else if (exponent == 0x1f) {
+        bits = sign | 0x7f800000 | (mantissa << 13);
+    } else {
+        bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+    }
+    float result;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+const char* modelTypeFor(int32_t audioLayers) {
+    switch (audioLayers) {
+        case 4: return "tiny";
+        case 6: return "base";
+        case 12: return "small";
+        case 24: return "medium";
+        case 32: return "large";
+    }
+    return "unknown";
+}
+
+// Matrices applied through linear(): every 2-D (or conv) weight. Norm
+// weights are 1-D and positional embeddings are not named *.weight.
+bool isProjection(const std::string& name, const Tensor& tensor) {
+    const std::string suffix = ".weight";
+    return tensor.shape.size() >= 2 && name.size() > suffix.size() &&
+           name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// Identifies the source file and conversion a cache was built from
+std::string sourceStamp(const std::string& path, WeightType weights) {
+#ifdef _WIN32
+    struct _stat64 st;
+    if (_stat64(path.c_str(), &st) != 0) return std::string();
+#else
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0) return std::string();
+#endif
+    return "ggml size=" + std::to_string(static_cast<long long>(st.st_size)) +
+           " mtime=" + std::to_string(static_cast<long long>(st.st_mtime)) +
+           " weights=" + weightTypeName(weights);
+}
+
+std::string parentDirectory(const std::string& path) {
+    const size_t slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? std::string() : path.substr(0, slash);
+}
+
+} // namespace
+
+size_t Tensor::elements() const {
+    size_t count = shape.empty() ? 0 : 1;
+    for (int64_t extent : shape) count *= static_cast<size_t>(extent);
+    return count;
+}
+
+const char* weightTypeName(WeightType type) {
+    switch (type) {
+        case WeightType::Int8: return "int8";
+        case WeightType::Int4: return "int4";
+        default: return "f32";
+    }
+}
+
+bool parseWeightType(const std::string& name, WeightType* type) {
+    if (name == "f32" || name == "none") *type = WeightType::F32;
+    else if (name == "int8") *type = WeightType::Int8;
+    else if (name == "int4") *type = WeightType::Int4;
+    else return false;
+    return true;
+}
+
+int languageCount() {
+    return static_cast<int>(sizeof(kLanguages) / sizeof(kLanguages[0]));
+}
+
+const char* languageCode(int index) {
+    return index >= 0 && index < languageCount() ? kLanguages[index] : "";
+}
+
+int languageIndex(const std::string& code) {
+    for (int i = 0; i < languageCount(); i++) {
+        if (code == kLanguages[i]) return i;
+    }
+    return -1;
+}
+
+bool WhisperModel::load(const std::string& path, std::string* error,
+                        const WhisperLoadOptions& options) {
+    const auto start = std::chrono::steady_clock::now();
+    const bool ok = loadSource(path, options, error);
+    loadMs_ = ok ? std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count()
+                 : 0.0;
+    return ok;
+}
+
+bool WhisperModel::loadSource(const std::string& path, const WhisperLoadOptions& options,
+                              std::string* error) {
+    reset();
+    if (storage::TensorFile::isTensorFile(path)) {
+        return loadContainer(path, std::string(), error);
+    }
+
+    const std::string stamp = options.cachePath.empty() ? std::string() : sourceStamp(path, options.weights);
+    if (!stamp.empty() && storage::TensorFile::isTensorFile(options.cachePath)) {
+        // A stale or damaged cache is rebuilt from the model file
+        std::string cacheError;
+        if (loadContainer(options.cachePath, stamp, &cacheError)) {
+            cachePath_ = options.cachePath;
+            return true;
+        }
+        reset();
+    }
+
+    if (!loadGgml(path, options, error)) return false;
+    if (!stamp.empty()) writeContainer(options.cachePath, stamp, &cacheError_);
+    return true;
+}
+
+bool WhisperModel::verify(std::string* error) const {
+    if (!container_ || container_->verifyAll(error)) return true;
+    *error = "model cache is damaged: " + *error;
+    if (!cachePath_.empty()) storage::removeFile(cachePath_);
+    return false;
+}
+
+void WhisperModel::reset() {
+    hparams_ = WhisperHParams();
+    tokens_ = WhisperTokens();
+    modelType_.clear();
+    melFilters_.clear();
+    melFftBins_ = 0;
+    vocab_.clear();
+    tensors_.clear();
+    weightBytes_ = 0;
+    weightType_ = WeightType::F32;
+    container_.reset();
+    cacheError_.clear();
+    cachePath_.clear();
+    loadMs_ = 0.0;
+}
+
+void WhisperModel::setupTokens() {
+    modelType_ = modelTypeFor(hparams_.nAudioLayer);
+
+    // Special tokens shift with the number of language tokens
+    if (multilingual()) {
+        tokens_.languageCount = hparams_.nVocab - 51765 - 1;
+        const int32_t shift = tokens_.languageCount - 98;
+        tokens_.eot++;
+        tokens_.sot++;
+        tokens_.translate += shift;
+        tokens_.transcribe += shift;
+        tokens_.solm += shift;
+        tokens_.prev += shift;
+        tokens_.noSpeech += shift;
+        tokens_.noTimestamps += shift;
+        tokens_.timestampBegin += shift;
+    }
+    // Special tokens never render as text
+    for (int32_t i = tokens_.eot; i < hparams_.nVocab; i++) {
+        vocab_[i].clear();
+    }
+}
+
+bool WhisperModel::loadGgml(const std::string& path, const WhisperLoadOptions& options,
+                            std::string* error) {
+    std::unique_ptr<std::FILE, FileCloser> file(std::fopen(path.c_str(), "rb"));
+    if (!file) {
+        *error = "cannot open model " + path;
+        return false;
+    }
+    std::FILE* f = file.get();
+
+    uint32_t magic = 0;
+    if (!readValue(f, &magic) || magic != kGgmlMagic) {
+        *error = path + " is not a ggml Whisper model";
+        return false;
+    }
+
+    int32_t* fields[] = {
+        &hparams_.nVocab, &hparams_.nAudioCtx, &hparams_.nAudioState, &hparams_.nAudioHead,
+        &hparams_.nAudioLayer, &hparams_.nTextCtx, &hparams_.nTextState, &hparams_.nTextHead,
+        &hparams_.nTextLayer, &hparams_.nMels, &hparams_.ftype,
+    };
+    for (int32_t* field : fields) {
+        if (!readValue(f, field)) {
+            *error = "truncated model header";
+            return false;
+        }
+    }
+    if (hparams_.nAudioHead <= 0 || hparams_.nTextHead <= 0 || hparams_.nAudioLayer <= 0 ||
+        hparams_.nTextLayer <= 0 || hparams_.nVocab <= 0) {
+        *error = "invalid model hyperparameters";
+        return false;
+    }
+
+    int32_t nMel = 0;
+    if (!readValue(f, &nMel) || !readValue(f, &melFftBins_) || nMel != hparams_.nMels ||
+        melFftBins_ <= 0) {
+        *error = "invalid mel filterbank";
+        return false;
+    }
+    melFilters_.resize(static_cast<size_t>(nMel) * melFftBins_);
+    if (std::fread(melFilters_.data(), sizeof(float), melFilters_.size(), f) != melFilters_.size()) {
+        *error = "truncated mel filterbank";
+        return false;
+    }
+
+    int32_t vocabCount = 0;
+    if (!readValue(f, &vocabCount) || vocabCount < 0 || vocabCount > hparams_.nVocab) {
+        *error = "invalid vocabulary";
+        return false;
+    }
+    vocab_.assign(static_cast<size_t>(hparams_.nVocab), std::string());
+    for (int32_t i = 0; i < vocabCount; i++) {
+        uint32_t length = 0;
+        if (!readValue(f, &length) || length > 4096) {
+            *error = "invalid vocabulary entry";
+            return false;
+        }
+        vocab_[i].resize(length);
+        if (length > 0 && std::fread(&vocab_[i][0], 1, length, f) != length) {
+            *error = "truncated vocabulary";
+            return false;
+        }
+    }
+
+    setupTokens();
+
+    std::vector<uint16_t> halfs;
+    for (;;) {
+        int32_t dims = 0;
+        int32_t nameLength = 0;
+        int32_t type = 0;
+        if (!readValue(f, &dims)) break;  // end of file
+        if (!readValue(f, &nameLength) || !readValue(f, &type) || dims < 1 || dims > 4 ||
+            nameLength <= 0 || nameLength > 256) {
+            *error = "invalid tensor header";
+            return false;
+        }
+        if (type != kTypeF32 && type != kTypeF16) {
+            *error = "unsupported tensor type " + std::to_string(type) +
+                     " (quantized ggml models are not supported; use an f16 or f32 model)";
+            return false;
+        }
+
+        Tensor tensor;
+        int64_t elements = 1;
+        tensor.shape.resize(static_cast<size_t>(dims));
+        for (int32_t d = 0; d < dims; d++) {
+            int32_t extent = 0;
+            if (!readValue(f, &extent) || extent <= 0) {
+                *error = "invalid tensor shape";
+                return false;
+            }
+            // ggml stores the innermost dimension first
+            tensor.shape[static_cast<size_t>(dims - 1 - d)] = extent;
+            elements *= extent;
+        }
+
+        std::string name(static_cast<size_t>(nameLength), '\0');
+        if (std::fread(&name[0], 1, name.size(), f) != name.size()) {
+            *error = "truncated tensor name";
+            return false;
+        }
+
+        tensor.data.resize(static_cast<size_t>(elements));
+        if (type == kTypeF32) {
+            if (std::fread(tensor.data.data(), sizeof(float), tensor.data.size(), f) != tensor.data.size()) {
+                *error = "truncated tensor " + name;
+                return false;
+            }
+        } else {
+            halfs.resize(static_cast<size_t>(elements));
+            if (std::fread(halfs.data(), sizeof(uint16_t), halfs.size(), f) != halfs.size()) {
+                *error = "truncated tensor " + name;
+                return false;
+            }
+            for (size_t i = 0; i < halfs.size(); i++) {
+                tensor.data[i] = halfToFloat(halfs[i]);
+            }
+        }
+        if (options.weights != WeightType::F32 && isProjection(name, tensor)) {
+            // Quantize as each tensor arrives so the f32 copy of the whole
+            // model never has to be resident
+            const size_t rows = static_cast<size_t>(tensor.shape[0]);
+            const quant::QuantType type = options.weights == WeightType::Int8 ? quant::QuantType::Int8
+                                                                              : quant::QuantType::Int4;
+            const size_t groupSize = type == quant::QuantType::Int8 ? 0 : quant::kBlock;
+            quant::quantizeMatrix(tensor.data.data(), rows, tensor.data.size() / rows, type, groupSize,
+                                  &tensor.quantized);
+            std::vector<float>().swap(tensor.data);
+            weightBytes_ += tensor.quantized.bytes();
+        } else {
+            weightBytes_ += tensor.data.size() * sizeof(float);
+        }
+        tensors_[name] = std::move(tensor);
+    }
+
+    weightType_ = options.weights;
+    return resolve(error);
+}
+
+bool WhisperModel::loadContainer(const std::string& path, const std::string& stamp, std::string* error) {
+    auto file = std::make_shared<storage::TensorFile>();
+    if (!file->open(path, kContainerKind, error)) return false;
+
+    // Metadata is small and checked up front; the weights only on verify()
+    auto meta = [&](const char* name, storage::TensorType type, const uint8_t** data) -> uint64_t {
+        const storage::TensorInfo* info = file->find(name);
+        if (!info || info->type != type) return 0;
+        *data = file->data(*info, error);
+        return *data ? info->bytes : 0;
+    };
+    const uint8_t* data = nullptr;
+    uint64_t bytes = meta("meta.source", storage::TensorType::Bytes, &data);
+    const std::string source(reinterpret_cast<const char*>(data), data ? bytes : 0);
+    if (!stamp.empty() && source != stamp) {
+        *error = path + " was built from a different model file";
+        return false;
+    }
+
+    bytes = meta("meta.hparams", storage::TensorType::Int32, &data);
+    if (bytes != kHParamCount * sizeof(int32_t)) {
+        *error = path + ": missing hyperparameters";
+        return false;
+    }
+    int32_t values[kHParamCount];
+    std::memcpy(values, data, sizeof(values));
+    int32_t* fields[] = {
+        &hparams_.nVocab, &hparams_.nAudioCtx, &hparams_.nAudioState, &hparams_.nAudioHead,
+        &hparams_.nAudioLayer, &hparams_.nTextCtx, &hparams_.nTextState, &hparams_.nTextHead,
+        &hparams_.nTextLayer, &hparams_.nMels, &hparams_.ftype,
+    };
+    for (size_t i = 0; i < kHParamCount; i++) *fields[i] = values[i];
+    if (hparams_.nAudioHead <= 0 || hparams_.nTextHead <= 0 || hparams_.nAudioLayer <= 0 ||
+        hparams_.nTextLayer <= 0 || hparams_.nVocab <= 0 || hparams_.nMels <= 0) {
+        *error = path + ": invalid model hyperparameters";
+        return false;
+    }
+
+    const storage::TensorInfo* filters = file->find("meta.mel_filters");
+    bytes = meta("meta.mel_filters", storage::TensorType::F32, &data);
+    if (!filters || filters->shape.size() != 2 || filters->shape[0] != hparams_.nMels || filters->shape[1] <= 0 ||
+        bytes != static_cast<uint64_t>(filters->shape[0] * filters->shape[1]) * sizeof(float)) {
+        *error = path + ": invalid mel filterbank";
+        return false;
+    }
+    melFftBins_ = static_cast<int>(filters->shape[1]);
+    melFilters_.resize(static_cast<size_t>(bytes / sizeof(float)));
+    std::memcpy(melFilters_.data(), data, static_cast<size_t>(bytes));
+
+    // Vocabulary: (uint32 length, bytes) per token
+    bytes = meta("meta.vocab", storage::TensorType::Bytes, &data);
+    vocab_.assign(static_cast<size_t>(hparams_.nVocab), std::string());
+    uint64_t position = 0;
+    for (size_t i = 0; i < vocab_.size() && position + sizeof(uint32_t) <= bytes; i++) {
+        uint32_t length = 0;
+        std::memcpy(&length, data + position, sizeof(length));
+        position += sizeof(length);
+        if (length > bytes - position) break;
+        vocab_[i].assign(reinterpret_cast<const char*>(data + position), length);
+        position += length;
+    }
+    if (position != bytes) {
+        *error = path + ": invalid vocabulary";
+        return false;
+    }
+    setupTokens();
+
+    WeightType weights = WeightType::F32;
+    for (const storage::TensorInfo& info : file->tensors()) {
+        if (info.name.compare(0, 5, "meta.") == 0) continue;
+
+        Tensor tensor;
+        tensor.shape = info.shape;
+        const size_t elements = tensor.elements();
+        const uint8_t* payload = file->base() + info.offset;
+        bool valid = elements > 0;
+        if (info.type == storage::TensorType::F32) {
+            valid = valid && info.bytes == elements * sizeof(float);
+            tensor.view = reinterpret_cast<const float*>(payload);
+            weightBytes_ += info.bytes;
+        } else if ((info.type == storage::TensorType::Q8 || info.type == storage::TensorType::Q4) &&
+                   isProjection(info.name, tensor)) {
+            quant::QuantizedMatrix& q = tensor.quantized;
+            q.type = info.type == storage::TensorType::Q8 ? quant::QuantType::Int8 : quant::QuantType::Int4;
+            q.rows = static_cast<size_t>(tensor.shape[0]);
+            q.cols = elements / q.rows;
+            q.paddedCols = (q.cols + quant::kBlock - 1) / quant::kBlock * quant::kBlock;
+            q.groupSize = info.groupSize;
+            valid = valid && q.groupSize > 0 && q.groupSize % quant::kBlock == 0 &&
+                    q.paddedCols % q.groupSize == 0 && info.bytes == q.dataBytes() &&
+                    info.scaleBytes == q.scaleBytes() && info.scaleOffset % sizeof(float) == 0;
+            q.data = payload;
+            q.scales = reinterpret_cast<const float*>(file->base() + info.scaleOffset);
+            q.storage = std::shared_ptr<const void>(file, payload);
+            weights = q.type == quant::QuantType::Int8 ? WeightType::Int8 : WeightType::Int4;
+            weightBytes_ += q.bytes();
+        } else {
+            valid = false;
+        }
+        if (!valid) {
+            *error = path + ": invalid tensor " + info.name;
+            return false;
+        }
+        tensors_[info.name] = std::move(tensor);
+    }
+
+    weightType_ = weights;
+    container_ = file;
+    return resolve(error);
+}
+
+bool WhisperModel::writeContainer(const std::string& path, const std::string& stamp,
+                                  std::string* error) const {
+    const std::string directory = parentDirectory(path);
+    if (!directory.empty() && !storage::makeDirectories(directory)) {
+        *error = "cannot create " + directory + ": " + storage::errorString();
+        return false;
+    }
+
+    storage::TensorFileWriter writer;
+    if (!writer.open(path, kContainerKind, error)) return false;
+
+    const int32_t values[kHParamCount] = {
+        hparams_.nVocab, hparams_.nAudioCtx, hparams_.nAudioState, hparams_.nAudioHead,
+        hparams_.nAudioLayer, hparams_.nTextCtx, hparams_.nTextState, hparams_.nTextHead,
+        hparams_.nTextLayer, hparams_.nMels, hparams_.ftype,
+    };
+    std::string vocab;
+    for (const std::string& token : vocab_) {
+        const uint32_t length = static_cast<uint32_t>(token.size());
+        vocab.append(reinterpret_cast<const char*>(&length), sizeof(length));
+        vocab.append(token);
+    }
+    bool ok = writer.add("meta.source", storage::TensorType::Bytes, { static_cast<int64_t>(stamp.size()) },
+                         stamp.data(), stamp.size(), error) &&
+              writer.add("meta.hparams", storage::TensorType::Int32, { static_cast<int64_t>(kHParamCount) },
+                         values, sizeof(values), error) &&
+              writer.add("meta.mel_filters", storage::TensorType::F32, { hparams_.nMels, melFftBins_ },
+                         melFilters_.data(), melFilters_.size() * sizeof(float), error) &&
+              writer.add("meta.vocab", storage::TensorType::Bytes, { static_cast<int64_t>(vocab.size()) },
+                         vocab.data(), vocab.size(), error);
+
+    for (auto it = tensors_.begin(); ok && it != tensors_.end(); ++it) {
+        const Tensor& tensor = it->second;
+        if (tensor.isQuantized()) {
+            const quant::QuantizedMatrix& q = tensor.quantized;
+            ok = writer.addQuantized(it->first,
+                                     q.type == quant::QuantType::Int8 ? storage::TensorType::Q8
+                                                                      : storage::TensorType::Q4,
+                                     tensor.shape, static_cast<uint32_t>(q.groupSize), q.data, q.dataBytes(),
+                                     q.scales, q.scaleBytes(), error);
+        } else {
+            ok = writer.add(it->first, storage::TensorType::F32, tensor.shape, tensor.ptr(),
+                            tensor.elements() * sizeof(float), error);
+        }
+    }
+    return ok && writer.commit(error);
+}
+
+const std::string& WhisperModel::tokenText(int32_t token) const {
+    static const std::string empty;
+    return token >= 0 && static_cast<size_t>(token) < vocab_.size() ? vocab_[token] : empty;
+}
+
+const Tensor* WhisperModel::tensor(const std::string& name) const {
+    auto found = tensors_.find(name);
+    return found == tensors_.end() ? nullptr : &found->second;
+}
+
+bool WhisperModel::resolve(std::string* error) {
+    std::string missing;
+    auto need = [&](const std::string& name, size_t elements) -> const Tensor* {
+        const Tensor* t = tensor(name);
+        if ((!t || t->elements() != elements) && missing.empty()) {
+            missing = name;
+        }
+        return t;
+    };
+
+    const size_t mels = static_cast<size_t>(hparams_.nMels);
+    const size_t audioState = static_cast<size_t>(hparams_.nAudioState);
+    const size_t textState = static_cast<size_t>(hparams_.nTextState);
+    const size_t vocab = static_cast<size_t>(hparams_.nVocab);
+
+    conv1W = need("encoder.conv1.weight", audioState * mels * 3);
+    conv1B = need("encoder.conv1.bias", audioState);
+    conv2W = need("encoder.conv2.weight", audioState * audioState * 3);
+    conv2B = need("encoder.conv2.bias", audioState);
+    encoderPositional = need("encoder.positional_embedding",
+                             static_cast<size_t>(hparams_.nAudioCtx) * audioState);
+    encoderLnW = need("encoder.ln_post.weight", audioState);
+    encoderLnB = need("encoder.ln_post.bias", audioState);
+
+    auto block = [&](const std::string& prefix, const std::string& attn, size_t state,
+                     EncoderLayer* layer) {
+        layer->queryW = need(prefix + attn + ".query.weight", state * state);
+        layer->queryB = need(prefix + attn + ".query.bias", state);
+        layer->keyW = need(prefix + attn + ".key.weight", state * state);
+        layer->valueW = need(prefix + attn + ".value.weight", state * state);
+        layer->valueB = need(prefix + attn + ".value.bias", state);
+        layer->outW = need(prefix + attn + ".out.weight", state * state);
+        layer->outB = need(prefix + attn + ".out.bias", state);
+    };
+    auto mlp = [&](const std::string& prefix, size_t state, EncoderLayer* layer) {
+        layer->attnLnW = need(prefix + "attn_ln.weight", state);
+        layer->attnLnB = need(prefix + "attn_ln.bias", state);
+        layer->mlpLnW = need(prefix + "mlp_ln.weight", state);
+        layer->mlpLnB = need(prefix + "mlp_ln.bias", state);
+        layer->mlp0W = need(prefix + "mlp.0.weight", 4 * state * state);
+        layer->mlp0B = need(prefix + "mlp.0.bias", 4 * state);
+        layer->mlp2W = need(prefix + "mlp.2.weight", 4 * state * state);
+        layer->mlp2B = need(prefix + "mlp.2.bias", state);
+    };
+
+    encoderLayers.resize(static_cast<size_t>(hparams_.nAudioLayer));
+    for (size_t i = 0; i < encoderLayers.size(); i++) {
+        const std::string prefix = "encoder.blocks." + std::to_string(i) + ".";
+        block(prefix, "attn", audioState, &encoderLayers[i]);
+        mlp(prefix, audioState, &encoderLayers[i]);
+    }
+
+    tokenEmbedding = need("decoder.token_embedding.weight", vocab * textState);
+    decoderPositional = need("decoder.positional_embedding",
+                             static_cast<size_t>(hparams_.nTextCtx) * textState);
+    decoderLnW = need("decoder.ln.weight", textState);
+    decoderLnB = need("decoder.ln.bias", textState);
+
+    decoderLayers.resize(static_cast<size_t>(hparams_.nTextLayer));
+    for (size_t i = 0; i < decoderLayers.size(); i++) {
+        const std::string prefix = "decoder.blocks." + std::to_string(i) + ".";
+        DecoderLayer& layer = decoderLayers[i];
+        block(prefix, "attn", textState, &layer.self);
+        mlp(prefix, textState, &layer.self);
+
+        EncoderLayer cross;
+        block(prefix, "cross_attn", textState, &cross);
+        layer.crossLnW = need(prefix + "cross_attn_ln.weight", textState);
+        layer.crossLnB = need(prefix + "cross_attn_ln.bias", textState);
+        layer.crossQueryW = cross.queryW;
+        layer.crossQueryB = cross.queryB;
+        layer.crossKeyW = cross.keyW;
+        layer.crossValueW = cross.valueW;
+        layer.crossValueB = cross.valueB;
+        layer.crossOutW = cross.outW;
+        layer.crossOutB = cross.outB;
+    }
+
+    if (audioState != textState && missing.empty()) {
+        missing = "matching encoder/decoder width";
+    }
+    if (!missing.empty()) {
+        *error = "model is missing or has a malformed tensor: " + missing;
+        return false;
+    }
+    return true;
+}
+
+} // namespace asr
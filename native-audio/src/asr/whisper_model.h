@@ -0,0 +1,191 @@
+// Whisper model weights in the ggml file format used by whisper.cpp
+//
+//   int32 magic 'ggml', 11 int32 hyperparameters
+//   mel filterbank:  int32 n_mel, int32 n_fft, float[n_mel * n_fft]
+//   vocabulary:      int32 count, then (uint32 length, bytes) per token
+//   tensors:         int32 n_dims, int32 name length, int32 type,
+//                    int32 dims[n_dims] (innermost first), name, data
+//
+// f32 and f16 tensors are accepted; f16 is widened to f32 at load time so the
+// kernels only deal with one element type. Optionally the weight matrices are
+// then quantized to int8 or int4 (see quant/quantize.h) and the f32 copy is
+// dropped.
+//
+// The converted weights can be cached in a tensor container
+// (storage/tensor_file.h). A later load maps the cache read-only instead of
+// parsing and converting the ggml file, so startup costs a few milliseconds
+// and the weights are shared through the page cache; tensor checksums are
+// verified on first use (verify()).
+
+#ifndef ASR_WHISPER_MODEL_H
+#define ASR_WHISPER_MODEL_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "quant/quantize.h"
+#include "storage/tensor_file.h"
+
+namespace asr {
+
+struct WhisperHParams {
+    int32_t nVocab = 0;
+    int32_t nAudioCtx = 0;
+    int32_t nAudioState = 0;
+    int32_t nAudioHead = 0;
+    int32_t nAudioLayer = 0;
+    int32_t nTextCtx = 0;
+    int32_t nTextState = 0;
+    int32_t nTextHead = 0;
+    int32_t nTextLayer = 0;
+    int32_t nMels = 0;
+    int32_t ftype = 0;
+};
+
+struct WhisperTokens {
+    int32_t eot = 50256;
+    int32_t sot = 50257;
+    int32_t translate = 50357;
+    int32_t transcribe = 50358;
+    int32_t solm = 50359;
+    int32_t prev = 50360;
+    int32_t noSpeech = 50361;
+    int32_t noTimestamps = 50362;
+    int32_t timestampBegin = 50363;
+    int32_t languageCount = 0;   // language tokens follow sot
+
+    int32_t language(int index) const { return sot + 1 + index; }
+};
+
+struct Tensor {
+    std::vector<int64_t> shape;  // outermost first (PyTorch order)
+    std::vector<float> data;     // empty once quantized or when mapped
+    const float* view = nullptr;  // values inside the mapped cache file
+    quant::QuantizedMatrix quantized;  // [shape[0], elements / shape[0]]
+
+    size_t elements() const;
+    const float* ptr() const { return view ? view : data.data(); }
+    bool isQuantized() const { return !quantized.empty(); }
+};
+
+enum class WeightType {
+    F32,
+    Int8,   // per output channel scales
+    Int4    // one scale per 32 weights
+};
+
+struct WhisperLoadOptions {
+    WeightType weights = WeightType::F32;
+    // Tensor container holding the converted weights. Used when it matches
+    // the model file (size, mtime, weight type), rewritten otherwise. Empty
+    // disables caching.
+    std::string cachePath;
+};
+
+struct EncoderLayer {
+    const Tensor* attnLnW; const Tensor* attnLnB;
+    const Tensor* queryW; const Tensor* queryB;
+    const Tensor* keyW;
+    const Tensor* valueW; const Tensor* valueB;
+    const Tensor* outW; const Tensor* outB;
+    const Tensor* mlpLnW; const Tensor* mlpLnB;
+    const Tensor* mlp0W; const Tensor* mlp0B;
+    const Tensor* mlp2W; const Tensor* mlp2B;
+};
+
+struct DecoderLayer {
+    EncoderLayer self;
+    const Tensor* crossLnW; const Tensor* crossLnB;
+    const Tensor* crossQueryW; const Tensor* crossQueryB;
+    const Tensor* crossKeyW;
+    const Tensor* crossValueW; const Tensor* crossValueB;
+    const Tensor* crossOutW; const Tensor* crossOutB;
+};
+
+class WhisperModel {
+public:
+    // Returns false and sets *error if the file is missing, truncated, uses an
+    // unsupported tensor type or lacks a tensor the forward pass needs. path
+    // may be a ggml file or a tensor container written by a previous load.
+    // Failing to write the cache is not an error (see cacheError()).
+    bool load(const std::string& path, std::string* error,
+              const WhisperLoadOptions& options = WhisperLoadOptions());
+
+    // Check the checksums of mapped weights (once; later calls are free).
+    // Always true for weights read from a ggml file. A damaged cache is
+    // deleted so that the next load rebuilds it.
+    bool verify(std::string* error) const;
+
+    // True if the weights are mapped from a tensor container
+    bool mapped() const { return container_ != nullptr; }
+    const std::string& cacheError() const { return cacheError_; }
+    // Wall time of the last successful load()
+    double loadMs() const { return loadMs_; }
+
+    const WhisperHParams& hparams() const { return hparams_; }
+    const WhisperTokens& tokens() const { return tokens_; }
+    bool multilingual() const { return hparams_.nVocab >= 51865; }
+    const std::string& modelType() const { return modelType_; }
+
+    // [nMels, nFftBins] triangular filterbank shipped with the model
+    const std::vector<float>& melFilters() const { return melFilters_; }
+    int melFftBins() const { return melFftBins_; }
+
+    // Raw bytes of a text token ("" for special tokens)
+    const std::string& tokenText(int32_t token) const;
+
+    const Tensor* tensor(const std::string& name) const;
+
+    // Encoder / decoder weights, resolved once at load time
+    const Tensor* conv1W; const Tensor* conv1B;
+    const Tensor* conv2W; const Tensor* conv2B;
+    const Tensor* encoderPositional;
+    const Tensor* encoderLnW; const Tensor* encoderLnB;
+    std::vector<EncoderLayer> encoderLayers;
+
+    const Tensor* tokenEmbedding;
+    const Tensor* decoderPositional;
+    const Tensor* decoderLnW; const Tensor* decoderLnB;
+    std::vector<DecoderLayer> decoderLayers;
+
+    size_t weightBytes() const { return weightBytes_; }
+    WeightType weightType() const { return weightType_; }
+
+private:
+    WhisperHParams hparams_;
+    WhisperTokens tokens_;
+    std::string modelType_;
+    std::vector<float> melFilters_;
+    int melFftBins_ = 0;
+    std::vector<std::string> vocab_;
+    std::unordered_map<std::string, Tensor> tensors_;
+    size_t weightBytes_ = 0;
+    WeightType weightType_ = WeightType::F32;
+    std::shared_ptr<const storage::TensorFile> container_;
+    std::string cacheError_;
+    std::string cachePath_;  // cache mapped in place of the ggml file
+    double loadMs_ = 0.0;
+
+    void reset();
+    bool loadSource(const std::string& path, const WhisperLoadOptions& options, std::string* error);
+    void setupTokens();
+    bool loadGgml(const std::string& path, const WhisperLoadOptions& options, std::string* error);
+    bool loadContainer(const std::string& path, const std::string& stamp, std::string* error);
+    bool writeContainer(const std::string& path, const std::string& stamp, std::string* error) const;
+    bool resolve(std::string* error);
+};
+
+// Whisper language codes in token order ("en" is index 0)
+int languageCount();
+const char* languageCode(int index);
+
+const char* weightTypeName(WeightType type);   // "f32", "int8", "int4"
+bool parseWeightType(const std::string& name, WeightType* type);
+int languageIndex(const std::string& code);   // -1 if unknown
+
+} // namespace asr
+
+#endif
@@ -0,0 +1,445 @@
+#include "whisper_stream.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <limits>
+
+#include "tensor_ops.h"
+
+namespace asr {
+
+namespace {
+
+const float kNegInf = -std::numeric_limits<float>::infinity();
+const size_t kMinWindowFrames = 10;     // ignore windows shorter than 100 ms
+const size_t kCtxStep = 50;             // encoder positions are fitted in 1 s steps
+const size_t kLanguageFrames = 300;     // detect until 3 s of audio were seen
+const size_t kSilenceFrames = 200;      // a window with no text is trimmed after 2 s ...
+const size_t kSilenceKeepFrames = 100;  // ... to its last second
+const size_t kContextTokens = 64;       // final text carried into the next window's prompt
+const size_t kTokensPerSecond = 20;     // cap on hypothesis length; stops repetition loops early
+
+double elapsedMs(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+}
+
+std::string trimmed(const std::string& text) {
+    const size_t begin = text.find_first_not_of(' ');
+    if (begin == std::string::npos) return std::string();
+    return text.substr(begin, text.find_last_not_of(' ') - begin + 1);
+}
+
+void addTimings(const StreamTimings& from, StreamTimings* to) {
+    to->melMs += from.melMs;
+    to->encodeMs += from.encodeMs;
+    to->decodeMs += from.decodeMs;
+    to->steps += from.steps;
+    to->tokens += from.tokens;
+    to->draftTokens += from.draftTokens;
+    to->reusedFrames += from.reusedFrames;
+}
+
+} // namespace
+
+WhisperStream::WhisperStream(std::shared_ptr<WhisperEngine> engine)
+    : engine_(std::move(engine)),
+      frontend_(engine_->mel_.kernel()),
+      started_(false),
+      base_(0),
+      melMax_(kNegInf),
+      receivedSamples_(0),
+      samplesSinceStep_(0),
+      stable1_(0),
+      stable2_(0),
+      headDirty_(false),
+      languageIdx_(-1),
+      languageLocked_(false),
+      languageProbability_(0.0f) {
+}
+
+bool WhisperStream::start(const StreamOptions& options, std::string* error) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const WhisperModel& m = engine_->model();
+    const WhisperHParams& hp = m.hparams();
+    if (!m.verify(error)) return false;
+
+    int languageIdx = -1;
+    if (options.language != "auto" && !options.language.empty()) {
+        languageIdx = languageIndex(options.language);
+        if (languageIdx < 0 || (m.multilingual() && languageIdx >= m.tokens().languageCount)) {
+            *error = "unsupported language: " + options.language;
+            return false;
+        }
+    }
+    if (!m.multilingual() && (options.translate || languageIdx > 0)) {
+        *error = "model " + m.modelType() + " is English-only";
+        return false;
+    }
+
+    options_ = options;
+    options_.stepMs = std::min(std::max(options_.stepMs, 100), 5000);
+    if (options_.audioCtx > 0) options_.audioCtx = std::min(options_.audioCtx, hp.nAudioCtx);
+    // The window plus one step must fit the encoder
+    const int maxCtx = options_.audioCtx > 0 ? options_.audioCtx : hp.nAudioCtx;
+    options_.maxWindowMs = std::min(std::max(options_.maxWindowMs, 2000), maxCtx * 20 - options_.stepMs);
+
+    reset();
+    languageIdx_ = m.multilingual() ? languageIdx : 0;
+    languageLocked_ = languageIdx_ >= 0;
+    languageProbability_ = languageLocked_ ? 1.0f : 0.0f;
+    totals_ = StreamTimings();
+    started_ = true;
+    return true;
+}
+
+void WhisperStream::reset() {
+    frontend_.reset();
+    rawMel_.clear();
+    base_ = 0;
+    melMax_ = kNegInf;
+    receivedSamples_ = 0;
+    samplesSinceStep_ = 0;
+    stable1_ = 0;
+    stable2_ = 0;
+    headDirty_ = false;
+    context_.clear();
+    committed_.clear();
+    draft_.clear();
+    if (!options_.language.empty() && options_.language != "auto") return;
+    if (engine_->model().multilingual()) {
+        languageIdx_ = -1;
+        languageLocked_ = false;
+        languageProbability_ = 0.0f;
+    }
+}
+
+void WhisperStream::appendFrames(const std::vector<float>& frames) {
+    rawMel_.insert(rawMel_.end(), frames.begin(), frames.end());
+}
+
+bool WhisperStream::push(const float* pcm, size_t n, StreamUpdate* update, std::string* error) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    *update = StreamUpdate();
+    if (!started_) {
+        *error = "stream is not started";
+        return false;
+    }
+
+    const uint64_t stepSamples = static_cast<uint64_t>(options_.stepMs) * kSampleRate / 1000;
+    std::vector<float> frames;
+    size_t offset = 0;
+    while (offset < n) {
+        // Feed at most up to the next step so a long buffer runs every step
+        const size_t take = static_cast<size_t>(
+            std::min<uint64_t>(n - offset, stepSamples - samplesSinceStep_));
+        const auto start = std::chrono::steady_clock::now();
+        frames.clear();
+        frontend_.push(pcm + offset, take, &frames);
+        appendFrames(frames);
+        update->timings.melMs += elapsedMs(start);
+        offset += take;
+        receivedSamples_ += take;
+        samplesSinceStep_ += take;
+        if (samplesSinceStep_ >= stepSamples) {
+            samplesSinceStep_ = 0;
+            step(false, update);
+        }
+    }
+
+    update->audioMs = static_cast<int64_t>(receivedSamples_ * 1000 / kSampleRate);
+    addTimings(update->timings, &totals_);
+    return true;
+}
+
+bool WhisperStream::finish(StreamUpdate* update, std::string* error) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    *update = StreamUpdate();
+    if (!started_) {
+        *error = "stream is not started";
+        return false;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<float> frames;
+    frontend_.flush(&frames);
+    appendFrames(frames);
+    update->timings.melMs += elapsedMs(start);
+    step(true, update);
+
+    update->audioMs = static_cast<int64_t>(receivedSamples_ * 1000 / kSampleRate);
+    addTimings(update->timings, &totals_);
+    reset();
+    return true;
+}
+
+void WhisperStream::encodeWindow(size_t frames, size_t ctx, StreamTimings* timings) {
+    WhisperEngine& e = *engine_;
+    const WhisperModel& m = e.model();
+    const size_t mels = static_cast<size_t>(m.hparams().nMels);
+    const size_t state = static_cast<size_t>(m.hparams().nAudioState);
+    const size_t padded = 2 * ctx;
+
+    // Normalization depends on the window maximum; when it moves, every
+    // cached stem row is stale
+    float maxValue = kNegInf;
+    for (size_t i = 0; i < frames * mels; i++) maxValue = std::max(maxValue, rawMel_[i]);
+    if (maxValue != melMax_) {
+        melMax_ = maxValue;
+        stable1_ = 0;
+        stable2_ = 0;
+        headDirty_ = false;
+    }
+    const float floor = maxValue - 8.0f;
+    mel_.resize(padded * mels);
+    for (size_t i = 0; i < frames * mels; i++) {
+        mel_[i] = (std::max(rawMel_[i], floor) + 4.0f) / 4.0f;
+    }
+    std::fill(mel_.begin() + frames * mels, mel_.end(), (floor + 4.0f) / 4.0f);
+
+    // Conv rows that only see complete frames are final; the rows at the
+    // edge of the audio and over the padding are recomputed every step
+    conv1_.resize(padded * state);
+    conv2_.resize(ctx * state);
+    timings->reusedFrames += static_cast<int>(stable1_);
+    if (headDirty_) e.conv1(mel_.data(), false, padded, 0, 1, conv1_.data());
+    e.conv1(mel_.data(), false, padded, stable1_, padded, conv1_.data());
+    if (headDirty_) e.conv2(conv1_.data(), padded, 0, 1, conv2_.data());
+    e.conv2(conv1_.data(), padded, stable2_, ctx, conv2_.data());
+    headDirty_ = false;
+    stable1_ = frames >= 2 ? frames - 1 : 0;
+    stable2_ = frames >= 3 ? (frames - 3) / 2 + 1 : 0;
+
+    e.encoded_.resize(ctx * state);
+    std::memcpy(e.encoded_.data(), conv2_.data(), ctx * state * sizeof(float));
+    add(e.encoded_.data(), m.encoderPositional->ptr(), ctx * state);
+    e.encodeLayers(ctx);
+    e.prepareCross();
+}
+
+std::vector<int32_t> WhisperStream::decodeWindow(size_t frames, size_t* accepted, StreamTimings* timings) {
+    WhisperEngine& e = *engine_;
+    const WhisperModel& m = e.model();
+    const WhisperTokens& tokens = m.tokens();
+    const size_t textCtx = static_cast<size_t>(m.hparams().nTextCtx);
+    const size_t vocab = static_cast<size_t>(m.hparams().nVocab);
+    const size_t windowTs = frames / 2;
+
+    std::vector<int32_t> forced;
+    if (!context_.empty()) {
+        forced.push_back(tokens.prev);
+        forced.insert(forced.end(), context_.begin(), context_.end());
+    }
+    forced.push_back(tokens.sot);
+    if (m.multilingual()) {
+        forced.push_back(tokens.language(languageIdx_));
+        forced.push_back(options_.translate ? tokens.translate : tokens.transcribe);
+    }
+    forced.insert(forced.end(), committed_.begin(), committed_.end());
+
+    std::vector<int32_t> draft = draft_;
+    if (forced.size() + draft.size() + 1 >= textCtx) {
+        draft.resize(forced.size() + 1 < textCtx ? textCtx - forced.size() - 1 : 0);
+    }
+    std::vector<int32_t> sequence = forced;
+    sequence.insert(sequence.end(), draft.begin(), draft.end());
+    const size_t maxTokens = std::min(textCtx / 2, std::max<size_t>(8, frames * kTokensPerSecond / 100));
+
+    // One pass over the prompt, the final tokens and the draft; row i of the
+    // logits predicts draft[i]
+    std::vector<int32_t> sampled = committed_;
+    *accepted = 0;
+    e.decode(sequence.data(), sequence.size(), 0, &logits_, draft.size() + 1);
+    int32_t token = tokens.eot;
+    size_t i = 0;
+    for (; i <= draft.size(); i++) {
+        row_.assign(logits_.begin() + i * vocab, logits_.begin() + (i + 1) * vocab);
+        e.applyRules(sampled, true, windowTs, &row_);
+        token = static_cast<int32_t>(std::max_element(row_.begin(), row_.end()) - row_.begin());
+        if (token == tokens.eot || row_[static_cast<size_t>(token)] == kNegInf) {
+            token = tokens.eot;
+            break;
+        }
+        sampled.push_back(token);
+        if (i == draft.size() || token != draft[i]) break;
+        ++*accepted;
+    }
+    timings->draftTokens += static_cast<int>(*accepted);
+
+    // Greedy from the first token the draft did not predict
+    if (token != tokens.eot) {
+        for (size_t past = forced.size() + i; sampled.size() < maxTokens && past + 1 < textCtx; past++) {
+            e.decode(&token, 1, past, &row_);
+            timings->tokens++;
+            e.applyRules(sampled, true, windowTs, &row_);
+            token = static_cast<int32_t>(std::max_element(row_.begin(), row_.end()) - row_.begin());
+            if (token == tokens.eot || row_[static_cast<size_t>(token)] == kNegInf) break;
+            sampled.push_back(token);
+        }
+    }
+    return sampled;
+}
+
+size_t WhisperStream::agreedLength(const std::vector<int32_t>& hypothesis, size_t accepted, bool final) const {
+    if (final) return hypothesis.size();
+    const WhisperModel& m = engine_->model();
+    const WhisperTokens& tokens = m.tokens();
+    // A word may continue in a later token: only cut before a token that
+    // starts a word, or after a timestamp
+    auto boundary = [&](size_t n) {
+        if (n == hypothesis.size()) return hypothesis[n - 1] >= tokens.timestampBegin;
+        const int32_t next = hypothesis[n];
+        if (next >= tokens.eot) return true;
+        const std::string& text = m.tokenText(next);
+        return !text.empty() && text[0] == ' ';
+    };
+    size_t n = std::min(accepted, hypothesis.size());
+    while (n > 0 && !boundary(n)) n--;
+    return n;
+}
+
+int64_t WhisperStream::lastTimestampMs() const {
+    const int32_t begin = engine_->model().tokens().timestampBegin;
+    for (auto it = committed_.rbegin(); it != committed_.rend(); ++it) {
+        if (*it >= begin) return frameMs(base_) + static_cast<int64_t>(*it - begin) * 20;
+    }
+    return frameMs(base_);
+}
+
+void WhisperStream::emitFinals(const std::vector<int32_t>& tokens, size_t frames, StreamUpdate* update) {
+    const WhisperModel& m = engine_->model();
+    const int32_t begin = m.tokens().timestampBegin;
+    int64_t start = lastTimestampMs();
+    std::string text;
+    for (int32_t token : tokens) {
+        if (token >= begin) {
+            const int64_t at = frameMs(base_) + static_cast<int64_t>(token - begin) * 20;
+            if (!trimmed(text).empty()) update->finals.push_back({start, std::max(at, start), trimmed(text)});
+            text.clear();
+            start = at;
+        } else if (token < m.tokens().eot) {
+            text += m.tokenText(token);
+        }
+    }
+    if (!trimmed(text).empty()) {
+        update->finals.push_back({start, std::max(frameMs(base_ + frames), start), trimmed(text)});
+    }
+}
+
+void WhisperStream::trim(size_t frames) {
+    const WhisperModel& m = engine_->model();
+    const WhisperTokens& tokens = m.tokens();
+    const size_t mels = static_cast<size_t>(m.hparams().nMels);
+    const size_t state = static_cast<size_t>(m.hparams().nAudioState);
+    frames &= ~static_cast<size_t>(1);   // keep the stride-2 conv aligned
+    if (frames == 0) return;
+
+    for (int32_t token : committed_) {
+        if (token < tokens.eot) context_.push_back(token);
+    }
+    if (context_.size() > kContextTokens) {
+        context_.erase(context_.begin(), context_.end() - kContextTokens);
+    }
+    committed_.clear();
+
+    // The rest of the draft is kept when its timestamps are still in range
+    const int32_t shift = static_cast<int32_t>(frames / 2);
+    for (int32_t& token : draft_) {
+        if (token < tokens.timestampBegin) continue;
+        token -= shift;
+        if (token < tokens.timestampBegin) {
+            draft_.clear();
+            break;
+        }
+    }
+
+    const size_t available = rawMel_.size() / mels;
+    frames = std::min(frames, available);
+    rawMel_.erase(rawMel_.begin(), rawMel_.begin() + frames * mels);
+    base_ += frames;
+
+    // Stem rows move with the audio; the first row loses its left
+    // neighbour and is recomputed
+    if (stable1_ > frames + 1 && stable2_ > frames / 2 + 1) {
+        std::memmove(conv1_.data(), conv1_.data() + frames * state, (stable1_ - frames) * state * sizeof(float));
+        std::memmove(conv2_.data(), conv2_.data() + frames / 2 * state,
+                     (stable2_ - frames / 2) * state * sizeof(float));
+        stable1_ -= frames;
+        stable2_ -= frames / 2;
+        headDirty_ = true;
+    } else {
+        stable1_ = 0;
+        stable2_ = 0;
+        headDirty_ = false;
+    }
+}
+
+bool WhisperStream::step(bool final, StreamUpdate* update) {
+    WhisperEngine& e = *engine_;
+    const WhisperModel& m = e.model();
+    const WhisperHParams& hp = m.hparams();
+    const WhisperTokens& tokens = m.tokens();
+    const size_t mels = static_cast<size_t>(hp.nMels);
+    const size_t frames = rawMel_.size() / mels;
+    StreamTimings& timings = update->timings;
+
+    std::vector<int32_t> hypothesis;
+    size_t accepted = 0;
+    if (frames >= kMinWindowFrames) {
+        std::lock_guard<std::mutex> lock(e.mutex_);
+        const size_t maxCtx = static_cast<size_t>(options_.audioCtx > 0 ? options_.audioCtx : hp.nAudioCtx);
+        const size_t fitted = ((frames + 1) / 2 + kCtxStep - 1) / kCtxStep * kCtxStep;
+        const size_t ctx = options_.audioCtx > 0 ? maxCtx : std::min(fitted, maxCtx);
+
+        auto start = std::chrono::steady_clock::now();
+        encodeWindow(std::min(frames, 2 * ctx), ctx, &timings);
+        timings.encodeMs += elapsedMs(start);
+
+        start = std::chrono::steady_clock::now();
+        if (!languageLocked_) {
+            languageIdx_ = e.detectLanguage(&languageProbability_);
+            languageLocked_ = frames >= kLanguageFrames || final;
+        }
+        hypothesis = decodeWindow(frames, &accepted, &timings);
+        hypothesis.erase(hypothesis.begin(), hypothesis.begin() + committed_.size());
+        timings.decodeMs += elapsedMs(start);
+        timings.steps++;
+        update->decoded = true;
+    } else if (final) {
+        // Too little audio to decode again: the last guess stands
+        hypothesis = draft_;
+    }
+
+    // Past the maximum window everything is committed
+    const bool forced = final || frames * 10 >= static_cast<size_t>(options_.maxWindowMs);
+    const size_t agreed = forced ? hypothesis.size() : agreedLength(hypothesis, accepted, false);
+    const std::vector<int32_t> finals(hypothesis.begin(), hypothesis.begin() + agreed);
+    emitFinals(finals, frames, update);
+    committed_.insert(committed_.end(), finals.begin(), finals.end());
+    draft_.assign(hypothesis.begin() + agreed, hypothesis.end());
+
+    // Move the window past final text that ends a segment, past everything
+    // when forced, or past long silence
+    bool hasText = false;
+    for (int32_t token : committed_) hasText = hasText || token < tokens.eot;
+    if (!final && hasText && committed_.back() >= tokens.timestampBegin) {
+        trim(static_cast<size_t>(committed_.back() - tokens.timestampBegin) * 2);
+    } else if (!final && forced) {
+        trim(frames);
+    } else if (!final && committed_.empty() && hypothesis.empty() && frames >= kSilenceFrames) {
+        trim(frames - kSilenceKeepFrames);
+    }
+
+    std::string partial;
+    for (int32_t token : draft_) {
+        if (token < tokens.eot) partial += m.tokenText(token);
+    }
+    update->partial = trimmed(partial);
+    update->partialStartMs = lastTimestampMs();
+    update->language = languageCode(std::max(languageIdx_, 0));
+    update->languageProbability = languageProbability_;
+    update->windowMs = static_cast<int64_t>(rawMel_.size() / mels) * 10;
+    return update->decoded;
+}
+
+} // namespace asr
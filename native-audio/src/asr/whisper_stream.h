@@ -0,0 +1,144 @@
+// Incremental (streaming) Whisper recognition
+//
+// Audio is pushed as it arrives; every `stepMs` of new audio the current
+// window (the audio since the last committed segment) is re-recognized and
+// the hypothesis is split into final and partial text:
+//
+//   mel       frames come from a streaming frontend, each computed once
+//   encoder   the window is encoded with audioCtx fitted to its length. The
+//             conv stem is local, so its rows are cached and only the rows
+//             touched by new frames are computed. The transformer layers
+//             attend over the whole window and are re-run.
+//   decoder   committed tokens are forced and run as one batched pass. The
+//             previous step's partial tokens are then verified as a draft
+//             from the same pass's logits; greedy decoding continues with
+//             the KV cache from the first token that differs. The draft and
+//             the greedy result are identical up to that point, so this
+//             changes cost, not output.
+//   commit    tokens that two consecutive steps agree on (the accepted
+//             draft) become final, cut back to a word boundary. Once the
+//             final text ends a timestamped segment, the window is trimmed
+//             to that point and the final text becomes the decoder prompt
+//             for the rest of the stream.
+//
+// Any new audio changes every encoder row and, through cross-attention,
+// every decoder state, so activations beyond the conv stem cannot carry
+// across steps; the draft check gets back most of the decoder work.
+
+#ifndef ASR_WHISPER_STREAM_H
+#define ASR_WHISPER_STREAM_H
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "mel_frontend.h"
+#include "whisper_engine.h"
+
+namespace asr {
+
+struct StreamOptions {
+    std::string language = "auto";  // ISO code, or "auto" to detect from the first seconds
+    bool translate = false;
+    int stepMs = 300;                // re-recognize after this much new audio
+    int maxWindowMs = 20000;         // commit everything once the window is this long
+    int audioCtx = 0;                // encoder positions; 0 = fit the window, rounded up to 1 s
+};
+
+struct StreamTimings {
+    double melMs = 0.0;
+    double encodeMs = 0.0;
+    double decodeMs = 0.0;
+    int steps = 0;
+    int tokens = 0;          // decoded one by one
+    int draftTokens = 0;     // verified in the batched pass
+    int reusedFrames = 0;    // conv stem rows taken from the cache
+};
+
+struct StreamUpdate {
+    // Text that became final since the last update, in stream time
+    std::vector<TranscriptSegment> finals;
+    // Current guess for the audio after the final text; replaced every step
+    std::string partial;
+    int64_t partialStartMs = 0;
+    std::string language;
+    float languageProbability = 0.0f;
+    int64_t audioMs = 0;     // audio received so far
+    int64_t windowMs = 0;    // audio not yet covered by final text
+    bool decoded = false;    // false if no step ran (not enough new audio)
+    StreamTimings timings;   // of the steps behind this update
+};
+
+class WhisperStream {
+public:
+    explicit WhisperStream(std::shared_ptr<WhisperEngine> engine);
+
+    WhisperStream(const WhisperStream&) = delete;
+    WhisperStream& operator=(const WhisperStream&) = delete;
+
+    // Validate the options and reset the stream. Fails on an unsupported
+    // language, translation on an English-only model or a damaged model cache.
+    bool start(const StreamOptions& options, std::string* error);
+
+    // Append 16 kHz mono audio; runs one step per stepMs of audio that is
+    // due. Calls are serialized per stream; steps also take the engine lock.
+    bool push(const float* pcm, size_t n, StreamUpdate* update, std::string* error);
+
+    // End of stream: recognize the rest and make everything final. The
+    // stream can be started again afterwards.
+    bool finish(StreamUpdate* update, std::string* error);
+
+    const StreamTimings& totals() const { return totals_; }
+
+private:
+    std::shared_ptr<WhisperEngine> engine_;
+    std::mutex mutex_;
+    StreamOptions options_;
+    MelFrontend frontend_;
+    bool started_;
+
+    // Window: log-mel frames (time-major, not normalized) from frame base_
+    std::vector<float> rawMel_;
+    std::vector<float> mel_;      // normalized and padded for the encoder
+    uint64_t base_;
+    float melMax_;
+    uint64_t receivedSamples_;
+    uint64_t samplesSinceStep_;
+
+    // Conv stem rows; the first stable*_ rows are final for this window
+    std::vector<float> conv1_;
+    std::vector<float> conv2_;
+    size_t stable1_;
+    size_t stable2_;
+    bool headDirty_;              // first rows lost their left neighbour in a trim
+
+    std::vector<int32_t> context_;    // final text tokens of earlier windows
+    std::vector<int32_t> committed_;  // final tokens of this window
+    std::vector<int32_t> draft_;      // partial tokens of the last step
+    std::vector<float> logits_;
+    std::vector<float> row_;
+
+    int languageIdx_;
+    bool languageLocked_;
+    float languageProbability_;
+    StreamTimings totals_;
+
+    void reset();
+    void appendFrames(const std::vector<float>& frames);
+    bool step(bool final, StreamUpdate* update);
+    void encodeWindow(size_t frames, size_t ctx, StreamTimings* timings);
+    // Returns committed_ followed by this step's tokens; *accepted counts the
+    // draft tokens confirmed
+    std::vector<int32_t> decodeWindow(size_t frames, size_t* accepted, StreamTimings* timings);
+    size_t agreedLength(const std::vector<int32_t>& hypothesis, size_t accepted, bool final) const;
+    void emitFinals(const std::vector<int32_t>& tokens, size_t frames, StreamUpdate* update);
+    void trim(size_t frames);
+    int64_t frameMs(uint64_t frame) const { return static_cast<int64_t>(frame) * 10; }
+    int64_t lastTimestampMs() const;
+};
+
+} // namespace asr
+
+#endif
@@ -0,0 +1,721 @@
+#include <napi.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "storage/capture_spool.h"
+#include "storage/segment_store.h"
+#include "storage/segment_writer.h"
+
+static std::string GetStringOption(const Napi::Object& options, const char* key, const std::string& fallback) {
+    if (options.Has(key) && options.Get(key).IsString()) {
+        return options.Get(key).As<Napi::String>().Utf8Value();
+    }
+    return fallback;
+}
+
+static double GetNumberOption(const Napi::Object& options, const char* key, double fallback) {
+    if (options.Has(key) && options.Get(key).IsNumber()) {
+        return options.Get(key).As<Napi::Number>().DoubleValue();
+    }
+    return fallback;
+}
+
+static Napi::Object SegmentInfoToObject(Napi::Env env, const storage::SegmentInfo& info,
+                                        const storage::SegmentWriterConfig& config) {
+    Napi::Object obj = Napi::Object::New(env);
+    obj.Set("path", Napi::String::New(env, info.path));
+    obj.Set("index", Napi::Number::New(env, info.index));
+    obj.Set("format", Napi::String::New(env, storage::segmentFormatExtension(config.format)));
+    obj.Set("sampleRate", Napi::Number::New(env, config.sampleRate));
+    obj.Set("channels", Napi::Number::New(env, config.channels));
+    obj.Set("startFrame", Napi::Number::New(env, static_cast<double>(info.startFrame)));
+    obj.Set("frames", Napi::Number::New(env, static_cast<double>(info.frames)));
+    obj.Set("bytes", Napi::Number::New(env, static_cast<double>(info.bytes)));
+    obj.Set("durationMs", Napi::Number::New(env, info.durationMs));
+    if (!info.error.empty()) {
+        obj.Set("error", Napi::String::New(env, info.error));
+    }
+    return obj;
+}
+
+// int16 PCM in a Buffer. A slice of Node's pooled allocations can start at
+// an odd byteOffset, so the samples are copied into scratch unless aligned.
+static const int16_t* Pcm16Samples(const Napi::Uint8Array& bytes, std::vector<int16_t>* scratch, size_t* count) {
+    *count = bytes.ByteLength() / sizeof(int16_t);
+    if (reinterpret_cast<uintptr_t>(bytes.Data()) % alignof(int16_t) == 0) {
+        return reinterpret_cast<const int16_t*>(bytes.Data());
+    }
+    scratch->resize(*count);
+    std::memcpy(scratch->data(), bytes.Data(), *count * sizeof(int16_t));
+    return scratch->data();
+}
+
+// Streaming WAV/FLAC segment writer; disk I/O runs on its own thread
+class SegmentWriterAddon : public Napi::ObjectWrap<SegmentWriterAddon> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    SegmentWriterAddon(const Napi::CallbackInfo& info);
+    ~SegmentWriterAddon();
+
+private:
+    std::unique_ptr<storage::SegmentWriter> writer_;
+    Napi::ThreadSafeFunction tsfn_;
+    bool closing_;
+    std::vector<int16_t> scratch_;   // misaligned Buffer input
+
+    Napi::Value Append(const Napi::CallbackInfo& info);
+    Napi::Value Rotate(const Napi::CallbackInfo& info);
+    Napi::Value Close(const Napi::CallbackInfo& info);
+    Napi::Value GetStats(const Napi::CallbackInfo& info);
+
+    friend class SegmentWriterCloseWorker;
+};
+
+// Joins the I/O thread off the event loop and resolves close()'s promise
+class SegmentWriterCloseWorker : public Napi::AsyncWorker {
+public:
+    SegmentWriterCloseWorker(Napi::Env env, SegmentWriterAddon* owner)
+        : Napi::AsyncWorker(env), owner_(owner), deferred_(Napi::Promise::Deferred::New(env)) {
+        owner_->Ref();
+    }
+
+    Napi::Promise Promise() const { return deferred_.Promise(); }
+
+protected:
+    void Execute() override {
+        owner_->writer_->close();
+    }
+
+    void OnOK() override {
+        if (owner_->tsfn_) {
+            owner_->tsfn_.Release();
+            owner_->tsfn_ = Napi::ThreadSafeFunction();
+        }
+        owner_->Unref();
+        deferred_.Resolve(Env().Undefined());
+    }
+
+private:
+    SegmentWriterAddon* owner_;
+    Napi::Promise::Deferred deferred_;
+};
+
+SegmentWriterAddon::SegmentWriterAddon(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<SegmentWriterAddon>(info), closing_(false) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsObject()) {
+        Napi::TypeError::New(env, "Expected options object").ThrowAsJavaScriptException();
+        return;
+    }
+    Napi::Object options = info[0].As<Napi::Object>();
+
+    storage::SegmentWriterConfig config;
+    config.directory = GetStringOption(options, "directory", "");
+    if (config.directory.empty()) {
+        Napi::TypeError::New(env, "options.directory is required").ThrowAsJavaScriptException();
+        return;
+    }
+    config.prefix = GetStringOption(options, "prefix", config.prefix);
+    config.sampleRate = static_cast<int>(GetNumberOption(options, "sampleRate", config.sampleRate));
+    config.channels = static_cast<int>(GetNumberOption(options, "channels", config.channels));
+    config.maxDurationMs = static_cast<uint64_t>(GetNumberOption(options, "maxDurationMs", 0));
+    config.maxBytes = static_cast<uint64_t>(GetNumberOption(options, "maxBytes", 0));
+    config.preallocateBytes = static_cast<uint64_t>(GetNumberOption(options, "preallocateBytes", 0));
+    config.fsyncIntervalMs = static_cast<uint32_t>(GetNumberOption(options, "fsyncIntervalMs", config.fsyncIntervalMs));
+
+    const std::string format = GetStringOption(options, "format", "wav");
+    if (format == "wav") {
+        config.format = storage::SegmentFormat::Wav;
+    } else if (format == "flac") {
+        config.format = storage::SegmentFormat::Flac;
+    } else {
+        Napi::TypeError::New(env, "options.format must be \"wav\" or \"flac\"").ThrowAsJavaScriptException();
+        return;
+    }
+
+    const std::string fsync = GetStringOption(options, "fsync", "close");
+    if (fsync == "none") {
+        config.fsync = storage::FsyncPolicy::None;
+    } else if (fsync == "close") {
+        config.fsync = storage::FsyncPolicy::OnClose;
+    } else if (fsync == "interval") {
+        config.fsync = storage::FsyncPolicy::Interval;
+    } else if (fsync == "always") {
+        config.fsync = storage::FsyncPolicy::Always;
+    } else {
+        Napi::TypeError::New(env, "options.fsync must be none, close, interval or always")
+            .ThrowAsJavaScriptException();
+        return;
+    }
+
+    if (config.channels < 1 || config.channels > 8 || config.sampleRate <= 0) {
+        Napi::RangeError::New(env, "Invalid sampleRate or channels").ThrowAsJavaScriptException();
+        return;
+    }
+
+    if (info.Length() > 1 && info[1].IsFunction()) {
+        tsfn_ = Napi::ThreadSafeFunction::New(env, info[1].As<Napi::Function>(), "SegmentWriter", 0, 1);
+    }
+
+    // Segment events are raised on the I/O thread and marshalled to JS
+    storage::SegmentWriter::SegmentCallback onSegment;
+    if (tsfn_) {
+        Napi::ThreadSafeFunction tsfn = tsfn_;
+        onSegment = [tsfn, config](const storage::SegmentInfo& segment) {
+            storage::SegmentInfo copy = segment;
+            tsfn.BlockingCall([copy, config](Napi::Env env, Napi::Function jsCallback) {
+                jsCallback.Call({SegmentInfoToObject(env, copy, config)});
+            });
+        };
+    }
+
+    writer_ = std::make_unique<storage::SegmentWriter>(config, onSegment);
+}
+
+SegmentWriterAddon::~SegmentWriterAddon() {
+    if (writer_) {
+        writer_->close();
+    }
+    if (tsfn_) {
+        tsfn_.Release();
+    }
+}
+
+Napi::Value SegmentWriterAddon::Append(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (closing_) {
+        Napi::Error::New(env, "SegmentWriter is closed").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    if (info.Length() < 1 || !info[0].IsTypedArray()) {
+        Napi::TypeError::New(env, "Expected Float32Array, Int16Array or Buffer of int16 PCM")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    Napi::TypedArray input = info[0].As<Napi::TypedArray>();
+    switch (input.TypedArrayType()) {
+        case napi_float32_array: {
+            Napi::Float32Array samples = input.As<Napi::Float32Array>();
+            writer_->append(samples.Data(), samples.ElementLength());
+            break;
+        }
+        case napi_int16_array: {
+            Napi::Int16Array samples = input.As<Napi::Int16Array>();
+            writer_->append(samples.Data(), samples.ElementLength());
+            break;
+        }
+        case napi_uint8_array: {
+            size_t count;
+            const int16_t* samples = Pcm16Samples(input.As<Napi::Uint8Array>(), &scratch_, &count);
+            writer_->append(samples, count);
+            break;
+        }
+        default:
+            Napi::TypeError::New(env, "Unsupported TypedArray type for PCM input")
+                .ThrowAsJavaScriptException();
+            return env.Null();
+    }
+
+    return env.Undefined();
+}
+
+Napi::Value SegmentWriterAddon::Rotate(const Napi::CallbackInfo& info) {
+    if (!closing_) {
+        writer_->rotate();
+    }
+    return info.Env().Undefined();
+}
+
+Napi::Value SegmentWriterAddon::Close(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (closing_) {
+        Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+        deferred.Resolve(env.Undefined());
+        return deferred.Promise();
+    }
+    closing_ = true;
+
+    SegmentWriterCloseWorker* worker = new SegmentWriterCloseWorker(env, this);
+    Napi::Promise promise = worker->Promise();
+    worker->Queue();
+    return promise;
+}
+
+Napi::Value SegmentWriterAddon::GetStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    Napi::Object stats = Napi::Object::New(env);
+    stats.Set("framesQueued", Napi::Number::New(env, static_cast<double>(writer_->framesQueued())));
+    stats.Set("bytesWritten", Napi::Number::New(env, static_cast<double>(writer_->bytesWritten())));
+    stats.Set("queueDepth", Napi::Number::New(env, static_cast<double>(writer_->queueDepth())));
+    return stats;
+}
+
+Napi::Object SegmentWriterAddon::Init(Napi::Env env, Napi::Object exports) {
+    Napi::Function func = DefineClass(env, "SegmentWriter", {
+        InstanceMethod("append", &SegmentWriterAddon::Append),
+        InstanceMethod("rotate", &SegmentWriterAddon::Rotate),
+        InstanceMethod("close", &SegmentWriterAddon::Close),
+        InstanceMethod("getStats", &SegmentWriterAddon::GetStats),
+    });
+
+    exports.Set("SegmentWriter", func);
+    return exports;
+}
+
+// Hands a native byte vector to JS without copying it again. Runtimes that
+// forbid external buffers (Electron's V8 sandbox) get a copy instead.
+static Napi::Buffer<uint8_t> VectorToBuffer(Napi::Env env, std::vector<uint8_t>&& bytes) {
+    std::vector<uint8_t>* owned = new std::vector<uint8_t>(std::move(bytes));
+    return Napi::Buffer<uint8_t>::NewOrCopy(env, owned->data(), owned->size(),
+                                            [](Napi::Env, uint8_t*, std::vector<uint8_t>* hint) { delete hint; },
+                                            owned);
+}
+
+// Crash-safe ring spool for captured PCM, backed by a memory-mapped file
+class CaptureSpoolAddon : public Napi::ObjectWrap<CaptureSpoolAddon> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    CaptureSpoolAddon(const Napi::CallbackInfo& info);
+
+private:
+    storage::CaptureSpool spool_;
+    bool open_;
+    std::vector<int16_t> scratch_;   // misaligned Buffer input
+
+    Napi::Value Append(const Napi::CallbackInfo& info);
+    Napi::Value EndSegment(const Napi::CallbackInfo& info);
+    Napi::Value PendingSegments(const Napi::CallbackInfo& info);
+    Napi::Value Read(const Napi::CallbackInfo& info);
+    Napi::Value ReadSegment(const Napi::CallbackInfo& info);
+    Napi::Value Ack(const Napi::CallbackInfo& info);
+    Napi::Value Sync(const Napi::CallbackInfo& info);
+    Napi::Value Close(const Napi::CallbackInfo& info);
+    Napi::Value GetStats(const Napi::CallbackInfo& info);
+};
+
+CaptureSpoolAddon::CaptureSpoolAddon(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<CaptureSpoolAddon>(info), open_(false) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsObject()) {
+        Napi::TypeError::New(env, "Expected options object").ThrowAsJavaScriptException();
+        return;
+    }
+    Napi::Object options = info[0].As<Napi::Object>();
+
+    storage::CaptureSpoolConfig config;
+    config.path = GetStringOption(options, "path", "");
+    if (config.path.empty()) {
+        Napi::TypeError::New(env, "options.path is required").ThrowAsJavaScriptException();
+        return;
+    }
+    config.capacityBytes = static_cast<uint64_t>(GetNumberOption(options, "capacityBytes", static_cast<double>(config.capacityBytes)));
+    config.sampleRate = static_cast<int>(GetNumberOption(options, "sampleRate", config.sampleRate));
+    config.channels = static_cast<int>(GetNumberOption(options, "channels", config.channels));
+    config.syncIntervalMs = static_cast<uint32_t>(GetNumberOption(options, "syncIntervalMs", 0));
+    if (options.Has("overwrite") && options.Get("overwrite").IsBoolean()) {
+        config.overwrite = options.Get("overwrite").As<Napi::Boolean>().Value();
+    }
+
+    if (!spool_.open(config)) {
+        Napi::Error::New(env, "Failed to open capture spool: " + spool_.error()).ThrowAsJavaScriptException();
+        return;
+    }
+    open_ = true;
+}
+
+Napi::Value CaptureSpoolAddon::Append(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (!open_) {
+        Napi::Error::New(env, "CaptureSpool is closed").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    if (info.Length() < 1 || !info[0].IsTypedArray()) {
+        Napi::TypeError::New(env, "Expected Float32Array, Int16Array or Buffer of int16 PCM")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    Napi::TypedArray input = info[0].As<Napi::TypedArray>();
+    bool ok;
+    switch (input.TypedArrayType()) {
+        case napi_float32_array: {
+            Napi::Float32Array samples = input.As<Napi::Float32Array>();
+            ok = spool_.append(samples.Data(), samples.ElementLength());
+            break;
+        }
+        case napi_int16_array: {
+            Napi::Int16Array samples = input.As<Napi::Int16Array>();
+            ok = spool_.append(samples.Data(), samples.ElementLength());
+            break;
+        }
+        case napi_uint8_array: {
+            size_t count;
+            const int16_t* samples = Pcm16Samples(input.As<Napi::Uint8Array>(), &scratch_, &count);
+            ok = spool_.append(samples, count);
+            break;
+        }
+        default:
+            Napi::TypeError::New(env, "Unsupported TypedArray type for PCM input")
+                .ThrowAsJavaScriptException();
+            return env.Null();
+    }
+
+    // false when the spool is full and overwrite is off
+    return Napi::Boolean::New(env, ok);
+}
+
+Napi::Value CaptureSpoolAddon::EndSegment(const Napi::CallbackInfo& info) {
+    return Napi::Number::New(info.Env(), spool_.endSegment());
+}
+
+Napi::Value CaptureSpoolAddon::PendingSegments(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    const std::vector<storage::SpoolSegment> segments = spool_.pendingSegments();
+
+    Napi::Array result = Napi::Array::New(env, segments.size());
+    for (size_t i = 0; i < segments.size(); i++) {
+        const storage::SpoolSegment& segment = segments[i];
+        Napi::Object obj = Napi::Object::New(env);
+        obj.Set("id", Napi::Number::New(env, segment.id));
+        obj.Set("startFrame", Napi::Number::New(env, static_cast<double>(segment.startFrame)));
+        obj.Set("frames", Napi::Number::New(env, static_cast<double>(segment.frames)));
+        obj.Set("bytes", Napi::Number::New(env, static_cast<double>(segment.bytes)));
+        obj.Set("durationMs", Napi::Number::New(env, segment.frames * 1000.0 / spool_.sampleRate()));
+        obj.Set("complete", Napi::Boolean::New(env, segment.complete));
+        result.Set(static_cast<uint32_t>(i), obj);
+    }
+    return result;
+}
+
+Napi::Value CaptureSpoolAddon::Read(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    const uint64_t cursor = info.Length() > 0 && info[0].IsNumber()
+        ? static_cast<uint64_t>(info[0].As<Napi::Number>().DoubleValue()) : 0;
+    const size_t maxBytes = info.Length() > 1 && info[1].IsNumber()
+        ? static_cast<size_t>(info[1].As<Napi::Number>().DoubleValue()) : 64 * 1024;
+
+    storage::SpoolRead chunk;
+    if (!spool_.read(cursor, maxBytes, &chunk)) {
+        return env.Null();
+    }
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("segment", Napi::Number::New(env, chunk.segment));
+    result.Set("startFrame", Napi::Number::New(env, static_cast<double>(chunk.startFrame)));
+    result.Set("nextCursor", Napi::Number::New(env, static_cast<double>(chunk.nextCursor)));
+    result.Set("endOfSegment", Napi::Boolean::New(env, chunk.endOfSegment));
+    result.Set("data", VectorToBuffer(env, std::move(chunk.data)));
+    return result;
+}
+
+Napi::Value CaptureSpoolAddon::ReadSegment(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+        Napi::TypeError::New(env, "Expected segment id").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    std::vector<uint8_t> data;
+    if (!spool_.readSegment(info[0].As<Napi::Number>().Uint32Value(), &data)) {
+        return env.Null();
+    }
+    return VectorToBuffer(env, std::move(data));
+}
+
+Napi::Value CaptureSpoolAddon::Ack(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+        Napi::TypeError::New(env, "Expected segment id").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    spool_.ack(info[0].As<Napi::Number>().Uint32Value());
+    return env.Undefined();
+}
+
+Napi::Value CaptureSpoolAddon::Sync(const Napi::CallbackInfo& info) {
+    return Napi::Boolean::New(info.Env(), spool_.sync());
+}
+
+Napi::Value CaptureSpoolAddon::Close(const Napi::CallbackInfo& info) {
+    spool_.close();
+    open_ = false;
+    return info.Env().Undefined();
+}
+
+Napi::Value CaptureSpoolAddon::GetStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    const storage::SpoolStats stats = spool_.stats();
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("sampleRate", Napi::Number::New(env, spool_.sampleRate()));
+    result.Set("channels", Napi::Number::New(env, spool_.channels()));
+    result.Set("capacity", Napi::Number::New(env, static_cast<double>(stats.capacity)));
+    result.Set("usedBytes", Napi::Number::New(env, static_cast<double>(stats.usedBytes)));
+    result.Set("recordsWritten", Napi::Number::New(env, static_cast<double>(stats.recordsWritten)));
+    result.Set("droppedRecords", Napi::Number::New(env, static_cast<double>(stats.droppedRecords)));
+    result.Set("recoveredRecords", Napi::Number::New(env, static_cast<double>(stats.recoveredRecords)));
+    result.Set("currentSegment", Napi::Number::New(env, stats.currentSegment));
+    return result;
+}
+
+Napi::Object CaptureSpoolAddon::Init(Napi::Env env, Napi::Object exports) {
+    Napi::Function func = DefineClass(env, "CaptureSpool", {
+        InstanceMethod("append", &CaptureSpoolAddon::Append),
+        InstanceMethod("endSegment", &CaptureSpoolAddon::EndSegment),
+        InstanceMethod("pendingSegments", &CaptureSpoolAddon::PendingSegments),
+        InstanceMethod("read", &CaptureSpoolAddon::Read),
+        InstanceMethod("readSegment", &CaptureSpoolAddon::ReadSegment),
+        InstanceMethod("ack", &CaptureSpoolAddon::Ack),
+        InstanceMethod("sync", &CaptureSpoolAddon::Sync),
+        InstanceMethod("close", &CaptureSpoolAddon::Close),
+        InstanceMethod("getStats", &CaptureSpoolAddon::GetStats),
+    });
+
+    exports.Set("CaptureSpool", func);
+    return exports;
+}
+
+// Append-only segment store with a time index and mapped reads
+class SegmentStoreAddon : public Napi::ObjectWrap<SegmentStoreAddon> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    SegmentStoreAddon(const Napi::CallbackInfo& info);
+
+private:
+    storage::SegmentStore store_;
+    bool open_;
+
+    Napi::Value Append(const Napi::CallbackInfo& info);
+    Napi::Value Query(const Napi::CallbackInfo& info);
+    Napi::Value Read(const Napi::CallbackInfo& info);
+    Napi::Value Get(const Napi::CallbackInfo& info);
+    Napi::Value Streams(const Napi::CallbackInfo& info);
+    Napi::Value Compact(const Napi::CallbackInfo& info);
+    Napi::Value Close(const Napi::CallbackInfo& info);
+    Napi::Value GetStats(const Napi::CallbackInfo& info);
+};
+
+static Napi::Object StoredSegmentToObject(Napi::Env env, const storage::StoredSegment& segment) {
+    const double rate = segment.sampleRate > 0 ? segment.sampleRate : 1.0;
+    Napi::Object obj = Napi::Object::New(env);
+    obj.Set("id", Napi::Number::New(env, static_cast<double>(segment.id)));
+    obj.Set("session", Napi::Number::New(env, static_cast<double>(segment.session)));
+    obj.Set("stream", Napi::Number::New(env, segment.stream));
+    obj.Set("codec", Napi::String::New(env, storage::segmentCodecName(segment.codec)));
+    obj.Set("sampleRate", Napi::Number::New(env, segment.sampleRate));
+    obj.Set("startSample", Napi::Number::New(env, static_cast<double>(segment.startSample)));
+    obj.Set("durationSamples", Napi::Number::New(env, segment.durationSamples));
+    obj.Set("startMs", Napi::Number::New(env, segment.startSample * 1000.0 / rate));
+    obj.Set("durationMs", Napi::Number::New(env, segment.durationSamples * 1000.0 / rate));
+    obj.Set("bytes", Napi::Number::New(env, segment.bytes));
+    obj.Set("createdMs", Napi::Number::New(env, static_cast<double>(segment.createdMs)));
+    return obj;
+}
+
+SegmentStoreAddon::SegmentStoreAddon(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<SegmentStoreAddon>(info), open_(false) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsObject()) {
+        Napi::TypeError::New(env, "Expected options object").ThrowAsJavaScriptException();
+        return;
+    }
+    Napi::Object options = info[0].As<Napi::Object>();
+
+    storage::SegmentStoreConfig config;
+    config.directory = GetStringOption(options, "directory", "");
+    if (config.directory.empty()) {
+        Napi::TypeError::New(env, "options.directory is required").ThrowAsJavaScriptException();
+        return;
+    }
+    config.maxBytes = static_cast<uint64_t>(GetNumberOption(options, "maxBytes", 0));
+    config.maxAgeMs = static_cast<uint64_t>(GetNumberOption(options, "maxAgeMs", 0));
+    config.maxSegments = static_cast<uint32_t>(GetNumberOption(options, "maxSegments", 0));
+    if (options.Has("sync") && options.Get("sync").IsBoolean()) {
+        config.syncOnAppend = options.Get("sync").As<Napi::Boolean>().Value();
+    }
+
+    if (!store_.open(config)) {
+        Napi::Error::New(env, "Failed to open segment store: " + store_.error()).ThrowAsJavaScriptException();
+        return;
+    }
+    open_ = true;
+}
+
+Napi::Value SegmentStoreAddon::Append(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (!open_) {
+        Napi::Error::New(env, "SegmentStore is closed").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    if (info.Length() < 2 || !info[0].IsObject() || !info[1].IsTypedArray()) {
+        Napi::TypeError::New(env, "Expected (metadata, Buffer)").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    Napi::Object meta = info[0].As<Napi::Object>();
+    Napi::TypedArray data = info[1].As<Napi::TypedArray>();
+    const uint8_t* bytes = static_cast<const uint8_t*>(data.ArrayBuffer().Data()) + data.ByteOffset();
+
+    bool codecOk = false;
+    storage::StoredSegment segment;
+    segment.codec = storage::segmentCodecFromName(GetStringOption(meta, "codec", "pcm16"), &codecOk);
+    if (!codecOk) {
+        Napi::TypeError::New(env, "codec must be pcm16, wav, flac, opus or mp3").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    segment.session = static_cast<uint64_t>(GetNumberOption(meta, "session", 0));
+    segment.stream = static_cast<uint32_t>(GetNumberOption(meta, "stream", 0));
+    segment.startSample = static_cast<uint64_t>(GetNumberOption(meta, "startSample", 0));
+    segment.sampleRate = static_cast<uint32_t>(GetNumberOption(meta, "sampleRate", 16000));
+
+    // Mono int16 PCM knows its own length; compressed payloads must say so
+    const double defaultDuration = segment.codec == storage::SegmentCodec::Pcm16
+        ? static_cast<double>(data.ByteLength() / sizeof(int16_t)) : 0;
+    segment.durationSamples = static_cast<uint32_t>(GetNumberOption(meta, "durationSamples", defaultDuration));
+
+    if (!store_.append(&segment, bytes, data.ByteLength())) {
+        Napi::Error::New(env, store_.error()).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    return Napi::Number::New(env, static_cast<double>(segment.id));
+}
+
+Napi::Value SegmentStoreAddon::Query(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsObject()) {
+        Napi::TypeError::New(env, "Expected query object").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    Napi::Object query = info[0].As<Napi::Object>();
+    const uint64_t session = static_cast<uint64_t>(GetNumberOption(query, "session", 0));
+    const uint32_t stream = static_cast<uint32_t>(GetNumberOption(query, "stream", 0));
+
+    // Times are in milliseconds of the stream's own timeline
+    uint64_t fromSample = 0;
+    uint64_t toSample = UINT64_MAX;
+    const uint32_t rate = store_.streamSampleRate(session, stream);
+    if (rate > 0) {
+        fromSample = static_cast<uint64_t>(std::max(0.0, GetNumberOption(query, "fromMs", 0)) * rate / 1000.0);
+        if (query.Has("toMs") && query.Get("toMs").IsNumber()) {
+            toSample = static_cast<uint64_t>(std::max(0.0, GetNumberOption(query, "toMs", 0)) * rate / 1000.0);
+        }
+    }
+
+    const std::vector<storage::StoredSegment> segments = store_.query(session, stream, fromSample, toSample);
+    Napi::Array result = Napi::Array::New(env, segments.size());
+    for (size_t i = 0; i < segments.size(); i++) {
+        result.Set(static_cast<uint32_t>(i), StoredSegmentToObject(env, segments[i]));
+    }
+    return result;
+}
+
+Napi::Value SegmentStoreAddon::Read(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+        Napi::TypeError::New(env, "Expected segment id").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    storage::SegmentView view;
+    if (!store_.view(static_cast<uint64_t>(info[0].As<Napi::Number>().DoubleValue()), &view)) {
+        return env.Null();
+    }
+
+    // The Buffer points into the mapping and keeps it alive until collected
+    using Hold = std::shared_ptr<const storage::MappedFile>;
+    Hold* hold = new Hold(view.mapping);
+    return Napi::Buffer<uint8_t>::NewOrCopy(env, const_cast<uint8_t*>(view.data), view.size,
+                                            [](Napi::Env, uint8_t*, Hold* hint) { delete hint; },
+                                            hold);
+}
+
+Napi::Value SegmentStoreAddon::Get(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+        Napi::TypeError::New(env, "Expected segment id").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    storage::StoredSegment segment;
+    if (!store_.get(static_cast<uint64_t>(info[0].As<Napi::Number>().DoubleValue()), &segment)) {
+        return env.Null();
+    }
+    return StoredSegmentToObject(env, segment);
+}
+
+Napi::Value SegmentStoreAddon::Streams(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    const std::vector<std::pair<uint64_t, uint32_t>> streams = store_.streams();
+
+    Napi::Array result = Napi::Array::New(env, streams.size());
+    for (size_t i = 0; i < streams.size(); i++) {
+        Napi::Object obj = Napi::Object::New(env);
+        obj.Set("session", Napi::Number::New(env, static_cast<double>(streams[i].first)));
+        obj.Set("stream", Napi::Number::New(env, streams[i].second));
+        result.Set(static_cast<uint32_t>(i), obj);
+    }
+    return result;
+}
+
+Napi::Value SegmentStoreAddon::Compact(const Napi::CallbackInfo& info) {
+    return Napi::Boolean::New(info.Env(), store_.compact());
+}
+
+Napi::Value SegmentStoreAddon::Close(const Napi::CallbackInfo& info) {
+    store_.close();
+    open_ = false;
+    return info.Env().Undefined();
+}
+
+Napi::Value SegmentStoreAddon::GetStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    const storage::SegmentStoreStats stats = store_.stats();
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("segments", Napi::Number::New(env, static_cast<double>(stats.segments)));
+    result.Set("liveBytes", Napi::Number::New(env, static_cast<double>(stats.liveBytes)));
+    result.Set("fileBytes", Napi::Number::New(env, static_cast<double>(stats.fileBytes)));
+    result.Set("expiredSegments", Napi::Number::New(env, static_cast<double>(stats.expiredSegments)));
+    result.Set("compactions", Napi::Number::New(env, static_cast<double>(stats.compactions)));
+    return result;
+}
+
+Napi::Object SegmentStoreAddon::Init(Napi::Env env, Napi::Object exports) {
+    Napi::Function func = DefineClass(env, "SegmentStore", {
+        InstanceMethod("append", &SegmentStoreAddon::Append),
+        InstanceMethod("query", &SegmentStoreAddon::Query),
+        InstanceMethod("read", &SegmentStoreAddon::Read),
+        InstanceMethod("get", &SegmentStoreAddon::Get),
+        InstanceMethod("streams", &SegmentStoreAddon::Streams),
+        InstanceMethod("compact", &SegmentStoreAddon::Compact),
+        InstanceMethod("close", &SegmentStoreAddon::Close),
+        InstanceMethod("getStats", &SegmentStoreAddon::GetStats),
+    });
+
+    exports.Set("SegmentStore", func);
+    return exports;
+}
+
+// Module initialization
+Napi::Object InitAll(Napi::Env env, Napi::Object exports) {
+    SegmentWriterAddon::Init(env, exports);
+    CaptureSpoolAddon::Init(env, exports);
+    SegmentStoreAddon::Init(env, exports);
+    return exports;
+}
+
+NODE_API_MODULE(audio_storage, InitAll)
@@ -0,0 +1,114 @@
+#include "audio_chain.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "dsp/noise_reduction.h"
+#include "dsp/resampler.h"
+
+namespace batch {
+
+namespace {
+
+// Leading and trailing non-speech of samples, per the voice detector
+void trimToSpeech(const vad::VadConfig& base, int sampleRate, std::vector<float>* samples, ChainResult* result) {
+    vad::VadConfig config = base;
+    config.sampleRate = sampleRate;
+    vad::VoiceDetector detector(config);
+    if (!detector.isValid()) return;
+    std::vector<vad::VadEvent> events;
+    detector.process(samples->data(), samples->size(), &events);
+    detector.flush(&events);
+
+    uint64_t first = UINT64_MAX;
+    uint64_t last = 0;
+    for (const vad::VadEvent& event : events) {
+        if (event.type == vad::VadEventType::SpeechStart) first = std::min(first, event.sample);
+        if (event.type == vad::VadEventType::SpeechEnd) last = std::max(last, event.sample);
+    }
+    const size_t n = samples->size();
+    if (first == UINT64_MAX || last <= first) {
+        result->speechFound = false;
+        result->trimmedSamples += n;
+        samples->clear();
+        return;
+    }
+    const size_t begin = static_cast<size_t>(std::min<uint64_t>(first, n));
+    const size_t end = static_cast<size_t>(std::min<uint64_t>(last, n));
+    result->trimmedSamples += n - (end - begin);
+    samples->erase(samples->begin() + end, samples->end());
+    samples->erase(samples->begin(), samples->begin() + begin);
+}
+
+} // namespace
+
+const char* stageName(Stage stage) {
+    switch (stage) {
+        case Stage::Denoise: return "denoise";
+        case Stage::Resample: return "resample";
+        case Stage::Normalize: return "normalize";
+        case Stage::Trim: return "trim";
+    }
+    return "";
+}
+
+bool parseChain(const std::string& spec, std::vector<Stage>* stages, std::string* error) {
+    stages->clear();
+    size_t start = 0;
+    while (start <= spec.size()) {
+        size_t comma = spec.find(',', start);
+        if (comma == std::string::npos) comma = spec.size();
+        const std::string name = spec.substr(start, comma - start);
+        start = comma + 1;
+        if (name.empty()) continue;
+
+        bool found = false;
+        for (int s = 0; s < kStageCount; s++) {
+            const Stage stage = static_cast<Stage>(s);
+            if (name != stageName(stage)) continue;
+            if (std::find(stages->begin(), stages->end(), stage) != stages->end()) {
+                if (error) *error = "stage listed twice: " + name;
+                return false;
+            }
+            stages->push_back(stage);
+            found = true;
+        }
+        if (!found) {
+            if (error) *error = "unknown stage: " + name + " (expected denoise, resample, normalize, trim)";
+            return false;
+        }
+    }
+    return true;
+}
+
+void runChain(const ChainConfig& config, std::vector<float>* samples, int sampleRate, ChainResult* result) {
+    std::vector<float> scratch;
+    for (Stage stage : config.stages) {
+        const auto start = std::chrono::steady_clock::now();
+        switch (stage) {
+            case Stage::Denoise: {
+                dsp::Denoiser denoiser(sampleRate);
+                denoiser.process(samples->data(), samples->size());
+                break;
+            }
+            case Stage::Resample:
+                if (sampleRate != config.sampleRate) {
+                    dsp::resample(samples->data(), samples->size(), sampleRate, config.sampleRate, &scratch);
+                    samples->swap(scratch);
+                    sampleRate = config.sampleRate;
+                }
+                break;
+            case Stage::Normalize:
+                result->loudness = dsp::normalizeLoudness(samples->data(), samples->size(), sampleRate, config.loudness);
+                break;
+            case Stage::Trim:
+                trimToSpeech(config.vad, sampleRate, samples, result);
+                break;
+        }
+        result->stageMs[static_cast<int>(stage)] +=
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+    result->sampleRate = sampleRate;
+}
+
+} // namespace batch
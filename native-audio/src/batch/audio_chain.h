@@ -0,0 +1,54 @@
+// Offline processing chain for one recording
+//
+// A chain is a comma-separated list of stages run in the order given, on
+// mono audio (multichannel files are downmixed first):
+//
+//   denoise    spectral noise reduction + noise gate (the rnnoise addon's DSP)
+//   resample   to ChainConfig::sampleRate
+//   normalize  one gain to ChainConfig::loudness.targetLufs (BS.1770)
+//   trim       drop what precedes the first and follows the last utterance
+//              found by the voice detector (pre-/post-roll included)
+//
+// Each stage is timed separately so a batch run can say where the time went.
+
+#ifndef BATCH_AUDIO_CHAIN_H
+#define BATCH_AUDIO_CHAIN_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "dsp/loudness.h"
+#include "vad/voice_detector.h"
+
+namespace batch {
+
+enum class Stage { Denoise, Resample, Normalize, Trim };
+
+constexpr int kStageCount = 4;
+const char* stageName(Stage stage);
+
+// "denoise,resample,normalize,trim"; each stage at most once
+bool parseChain(const std::string& spec, std::vector<Stage>* stages, std::string* error);
+
+struct ChainConfig {
+    std::vector<Stage> stages;
+    int sampleRate = 16000;        // resample target
+    dsp::LoudnessConfig loudness;
+    vad::VadConfig vad;            // sampleRate is taken from the audio
+};
+
+struct ChainResult {
+    int sampleRate = 0;             // of the output
+    double stageMs[kStageCount] = {0.0, 0.0, 0.0, 0.0};
+    dsp::LoudnessResult loudness;   // when normalized
+    size_t trimmedSamples = 0;      // removed by trim, at its input rate
+    bool speechFound = true;        // trim found an utterance
+};
+
+// samples: mono audio at sampleRate, replaced by the output
+void runChain(const ChainConfig& config, std::vector<float>* samples, int sampleRate, ChainResult* result);
+
+} // namespace batch
+
+#endif
@@ -0,0 +1,112 @@
+#include "file_scheduler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <thread>
+
+namespace batch {
+
+namespace {
+
+struct WorkerQueue {
+    std::mutex mutex;
+    std::deque<size_t> tasks;            // largest first
+    std::atomic<uint64_t> remaining{0};  // cost still queued
+};
+
+} // namespace
+
+FileScheduler::FileScheduler(int threads) : threads_(threads) {
+    if (threads_ <= 0) threads_ = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+}
+
+void FileScheduler::run(const std::vector<uint64_t>& costs,
+                        const std::function<void(size_t index, int worker)>& task) {
+    const int workers = static_cast<int>(std::min<size_t>(threads_, std::max<size_t>(1, costs.size())));
+    stats_.assign(threads_, WorkerStats());
+    if (costs.empty()) return;
+
+    // Longest processing time first onto the least loaded worker
+    std::vector<size_t> order(costs.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return costs[a] > costs[b]; });
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    for (int w = 0; w < workers; w++) queues.push_back(std::make_unique<WorkerQueue>());
+    std::vector<uint64_t> load(workers, 0);
+    for (size_t index : order) {
+        const int w = static_cast<int>(std::min_element(load.begin(), load.end()) - load.begin());
+        queues[w]->tasks.push_back(index);
+        queues[w]->remaining += costs[index];
+        load[w] += costs[index] + 1;
+    }
+
+    auto takeOwn = [&](int w, size_t* index) {
+        WorkerQueue& q = *queues[w];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (q.tasks.empty()) return false;
+        *index = q.tasks.front();
+        q.tasks.pop_front();
+        q.remaining -= costs[*index];
+        return true;
+    };
+
+    auto steal = [&](int w, size_t* index) {
+        // Victims by remaining work; retry if the chosen one empties first
+        for (;;) {
+            int victim = -1;
+            uint64_t most = 0;
+            bool any = false;
+            for (int v = 0; v < workers; v++) {
+                if (v == w) continue;
+                WorkerQueue& q = *queues[v];
+                std::lock_guard<std::mutex> lock(q.mutex);
+                if (q.tasks.empty()) continue;
+                const uint64_t remaining = q.remaining.load(std::memory_order_relaxed);
+                if (!any || remaining > most) {
+                    victim = v;
+                    most = remaining;
+                    any = true;
+                }
+            }
+            if (!any) return false;
+            WorkerQueue& q = *queues[victim];
+            std::lock_guard<std::mutex> lock(q.mutex);
+            if (q.tasks.empty()) continue;
+            *index = q.tasks.back();
+            q.tasks.pop_back();
+            q.remaining -= costs[*index];
+            return true;
+        }
+    };
+
+    // Tasks never spawn tasks, so a worker that finds every queue empty is done
+    auto work = [&](int w) {
+        WorkerStats& stats = stats_[w];
+        size_t index;
+        for (;;) {
+            bool stolen = false;
+            if (!takeOwn(w, &index)) {
+                if (!steal(w, &index)) break;
+                stolen = true;
+            }
+            const auto start = std::chrono::steady_clock::now();
+            task(index, w);
+            stats.busyMs +=
+                std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            stats.tasks++;
+            if (stolen) stats.steals++;
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int w = 1; w < workers; w++) threads.emplace_back(work, w);
+    work(0);
+    for (auto& thread : threads) thread.join();
+}
+
+} // namespace batch
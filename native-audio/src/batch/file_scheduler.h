@@ -0,0 +1,47 @@
+// Work-stealing scheduler for batches of independent files
+//
+// Tasks (files) are dealt out before the run, largest first, each to the
+// worker with the least work so far, so every worker starts with about the
+// same amount of audio. A worker takes its own tasks largest first; when it
+// runs out it steals the smallest task left on the worker with the most
+// remaining work. Short files at the end of the run fill in around long ones
+// instead of one worker finishing a long tail alone. Each worker's queue has
+// its own lock and is only contended during a steal.
+
+#ifndef BATCH_FILE_SCHEDULER_H
+#define BATCH_FILE_SCHEDULER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace batch {
+
+struct WorkerStats {
+    size_t tasks = 0;
+    size_t steals = 0;     // tasks taken from another worker
+    double busyMs = 0.0;
+};
+
+class FileScheduler {
+public:
+    // threads <= 0 picks hardware_concurrency()
+    explicit FileScheduler(int threads);
+
+    // Runs task(index, worker) once for every index in [0, costs.size()),
+    // on threads() workers (the caller is worker 0). costs (bytes, samples,
+    // any unit) order and balance the work. Blocks until every task is done.
+    void run(const std::vector<uint64_t>& costs, const std::function<void(size_t index, int worker)>& task);
+
+    int threads() const { return threads_; }
+    const std::vector<WorkerStats>& stats() const { return stats_; }   // of the last run
+
+private:
+    int threads_;
+    std::vector<WorkerStats> stats_;
+};
+
+} // namespace batch
+
+#endif
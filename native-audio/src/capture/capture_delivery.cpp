@@ -0,0 +1,178 @@
+#include "capture_delivery.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <utility>
+
+#include "latency_histogram.h"
+
+namespace capture {
+
+namespace {
+
+size_t roundUpPow2(size_t n) {
+    size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+} // namespace
+
+SampleRing::SampleRing(size_t capacity)
+    : buffer_(roundUpPow2(std::max<size_t>(capacity, 2))), mask_(buffer_.size() - 1), head_(0), tail_(0) {}
+
+size_t SampleRing::write(const float* data, size_t count) {
+    const uint64_t head = head_.load(std::memory_order_relaxed);
+    const uint64_t tail = tail_.load(std::memory_order_acquire);
+    // All or nothing, so packets of interleaved frames stay frame-aligned
+    if (count > capacity() - static_cast<size_t>(head - tail)) return 0;
+
+    const size_t at = static_cast<size_t>(head) & mask_;
+    const size_t first = std::min(count, capacity() - at);
+    std::memcpy(buffer_.data() + at, data, first * sizeof(float));
+    std::memcpy(buffer_.data(), data + first, (count - first) * sizeof(float));
+    head_.store(head + count, std::memory_order_release);
+    return count;
+}
+
+size_t SampleRing::read(float* out, size_t maxCount) {
+    const uint64_t tail = tail_.load(std::memory_order_relaxed);
+    const uint64_t head = head_.load(std::memory_order_acquire);
+    const size_t n = std::min(maxCount, static_cast<size_t>(head - tail));
+    if (n == 0) return 0;
+
+    const size_t at = static_cast<size_t>(tail) & mask_;
+    const size_t first = std::min(n, capacity() - at);
+    std::memcpy(out, buffer_.data() + at, first * sizeof(float));
+    std::memcpy(out + first, buffer_.data(), (n - first) * sizeof(float));
+    tail_.store(tail + n, std::memory_order_release);
+    return n;
+}
+
+size_t SampleRing::size() const {
+    return static_cast<size_t>(head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire));
+}
+
+CaptureDelivery::CaptureDelivery(const DeliveryConfig& config, Sink sink)
+    : config_(config),
+      sink_(std::move(sink)),
+      ring_(static_cast<size_t>(std::max(1, config.sampleRate)) * std::max(1, config.channels) *
+            std::max(10, config.ringMs) / 1000),
+      running_(false),
+      chunkCapturedNs_(0),
+      marksHead_(0),
+      marksTail_(0),
+      written_(0),
+      read_(0),
+      packets_(0),
+      samplesIn_(0),
+      samplesDelivered_(0),
+      samplesDropped_(0),
+      chunks_(0) {
+    config_.chunkMs = std::max(1, config_.chunkMs);
+}
+
+CaptureDelivery::~CaptureDelivery() {
+    stop();
+}
+
+void CaptureDelivery::start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_.load(std::memory_order_relaxed)) return;
+    running_.store(true, std::memory_order_release);
+    thread_ = std::thread(&CaptureDelivery::run, this);
+}
+
+void CaptureDelivery::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_.load(std::memory_order_relaxed)) return;
+        running_.store(false, std::memory_order_release);
+    }
+    wake_.notify_all();
+    if (thread_.joinable()) thread_.join();
+}
+
+void CaptureDelivery::push(const float* data, size_t count) {
+    if (!running_.load(std::memory_order_acquire) || count == 0) return;
+    const size_t written = ring_.write(data, count);
+    packets_.fetch_add(1, std::memory_order_relaxed);
+    samplesIn_.fetch_add(count, std::memory_order_relaxed);
+    if (written < count) {
+        samplesDropped_.fetch_add(count - written, std::memory_order_relaxed);
+        return;
+    }
+
+    written_ += written;
+    const uint64_t head = marksHead_.load(std::memory_order_relaxed);
+    if (head - marksTail_.load(std::memory_order_acquire) < kMarks) {
+        marks_[head % kMarks] = PacketMark{written_, steadyNowNs()};
+        marksHead_.store(head + 1, std::memory_order_release);
+    }
+}
+
+int64_t CaptureDelivery::oldestPushedNs(uint64_t sample) {
+    uint64_t tail = marksTail_.load(std::memory_order_relaxed);
+    const uint64_t head = marksHead_.load(std::memory_order_acquire);
+    // Marks of packets read out completely are done with
+    while (tail != head && marks_[tail % kMarks].end <= sample) {
+        tail++;
+    }
+    marksTail_.store(tail, std::memory_order_release);
+    return tail != head ? marks_[tail % kMarks].pushedNs : steadyNowNs();
+}
+
+DeliveryStats CaptureDelivery::stats() const {
+    DeliveryStats stats;
+    stats.packets = packets_.load(std::memory_order_relaxed);
+    stats.samplesIn = samplesIn_.load(std::memory_order_relaxed);
+    stats.samplesDelivered = samplesDelivered_.load(std::memory_order_relaxed);
+    stats.samplesDropped = samplesDropped_.load(std::memory_order_relaxed);
+    stats.chunks = chunks_.load(std::memory_order_relaxed);
+    stats.buffered = ring_.size();
+    return stats;
+}
+
+void CaptureDelivery::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (running_.load(std::memory_order_acquire)) {
+        wake_.wait_for(lock, std::chrono::milliseconds(config_.chunkMs),
+                       [this] { return !running_.load(std::memory_order_acquire); });
+        lock.unlock();
+        drain();
+        lock.lock();
+    }
+    lock.unlock();
+
+    // Hand over everything still buffered, for as long as the sink takes it
+    while (drain()) {
+    }
+    if (!chunk_.empty()) {
+        samplesDropped_.fetch_add(chunk_.size(), std::memory_order_relaxed);
+        chunk_.clear();
+    }
+}
+
+bool CaptureDelivery::drain() {
+    // A refused chunk goes first; new audio stays in the ring meanwhile
+    if (chunk_.empty()) {
+        const size_t available = ring_.size();
+        if (available == 0) return false;
+        chunk_.resize(available);
+        chunk_.resize(ring_.read(chunk_.data(), available));
+        chunkCapturedNs_ = oldestPushedNs(read_);
+        read_ += chunk_.size();
+    }
+
+    const size_t n = chunk_.size();
+    if (!sink_ || sink_(chunk_)) {
+        samplesDelivered_.fetch_add(n, std::memory_order_relaxed);
+        chunks_.fetch_add(1, std::memory_order_relaxed);
+        chunk_.clear();
+        return true;
+    }
+    return false;
+}
+
+} // namespace capture
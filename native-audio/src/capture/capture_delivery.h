@@ -0,0 +1,135 @@
+// Per-capture sample ring and delivery thread
+//
+// The OS audio callback (ScreenCaptureKit sample handler, WASAPI capture
+// loop) only copies samples into a lock-free single-producer ring: no
+// allocation, no locks, no wakeups, no calls into JS. A delivery thread owned
+// by the same capture drains the ring every chunkMs and hands what it finds
+// to the sink, which is where the N-API thread-safe function call (and the
+// one allocation per chunk) happens. The sink may refuse a chunk (the JS
+// queue is full); it is offered again on the next pass while new audio waits
+// in the ring, so a slow JS thread backs up into the ring without blocking
+// either thread, and only overflows past ringMs of audio are dropped.
+//
+// Each AudioCapture owns one CaptureDelivery, so several captures (one per
+// display or device, or one per worker thread) run side by side without
+// shared state.
+
+#ifndef CAPTURE_CAPTURE_DELIVERY_H
+#define CAPTURE_CAPTURE_DELIVERY_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace capture {
+
+// Single-producer single-consumer ring of float samples
+class SampleRing {
+public:
+    explicit SampleRing(size_t capacity);
+
+    // Producer: copies all count samples, or none if they do not fit
+    size_t write(const float* data, size_t count);
+    // Consumer: copies up to maxCount samples, returns how many were read
+    size_t read(float* out, size_t maxCount);
+
+    size_t size() const;
+    size_t capacity() const { return mask_ + 1; }
+
+private:
+    std::vector<float> buffer_;
+    size_t mask_;
+    std::atomic<uint64_t> head_;   // written by the producer
+    std::atomic<uint64_t> tail_;   // written by the consumer
+};
+
+struct DeliveryConfig {
+    int sampleRate = 16000;
+    int channels = 1;
+    int ringMs = 2000;      // audio buffered while the JS thread is busy
+    int chunkMs = 20;       // the delivery thread drains the ring this often
+};
+
+struct DeliveryStats {
+    uint64_t packets = 0;           // push() calls
+    uint64_t samplesIn = 0;
+    uint64_t samplesDelivered = 0;
+    uint64_t samplesDropped = 0;    // ring overflow, or refused at stop()
+    uint64_t chunks = 0;
+    size_t buffered = 0;
+};
+
+class CaptureDelivery {
+public:
+    // Called on the delivery thread. Returns true once it has taken the
+    // chunk (it may move from it), false to have it offered again later.
+    using Sink = std::function<bool(std::vector<float>& chunk)>;
+
+    CaptureDelivery(const DeliveryConfig& config, Sink sink);
+    ~CaptureDelivery();
+
+    CaptureDelivery(const CaptureDelivery&) = delete;
+    CaptureDelivery& operator=(const CaptureDelivery&) = delete;
+
+    void start();
+    // Offers what is still buffered until the ring is empty or the sink
+    // refuses (the rest is counted as dropped), then joins the delivery thread.
+    // A sink that blocks instead of refusing makes this a complete flush.
+    void stop();
+    bool running() const { return running_.load(std::memory_order_acquire); }
+
+    // Audio thread: never blocks or allocates. Ignored while stopped.
+    void push(const float* data, size_t count);
+
+    // For the sink: steadyNowNs() when the oldest sample of the chunk being
+    // offered was pushed
+    int64_t chunkCapturedNs() const { return chunkCapturedNs_; }
+
+    DeliveryStats stats() const;
+    const DeliveryConfig& config() const { return config_; }
+
+private:
+    DeliveryConfig config_;
+    Sink sink_;
+    SampleRing ring_;
+
+    std::atomic<bool> running_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::thread thread_;
+    std::vector<float> chunk_;      // delivery thread: read, not yet taken
+    int64_t chunkCapturedNs_;
+
+    // When each packet in the ring was pushed, as the sample count at its
+    // end: a second single-producer ring. If it is full the packet gets no
+    // mark and its samples take the next packet's time.
+    struct PacketMark {
+        uint64_t end;
+        int64_t pushedNs;
+    };
+    static const size_t kMarks = 512;
+    PacketMark marks_[kMarks];
+    std::atomic<uint64_t> marksHead_;
+    std::atomic<uint64_t> marksTail_;
+    uint64_t written_;              // audio thread: samples written to the ring
+    uint64_t read_;                 // delivery thread: samples read from it
+
+    std::atomic<uint64_t> packets_;
+    std::atomic<uint64_t> samplesIn_;
+    std::atomic<uint64_t> samplesDelivered_;
+    std::atomic<uint64_t> samplesDropped_;
+    std::atomic<uint64_t> chunks_;
+
+    void run();
+    bool drain();   // true if a chunk was taken
+    int64_t oldestPushedNs(uint64_t sample);
+};
+
+} // namespace capture
+
+#endif
@@ -0,0 +1,57 @@
+// Per-capture metrics behind AudioCapture.getStats(), beyond the ring's own
+// DeliveryStats
+//
+// Everything is an atomic counter or a LatencyHistogram, recorded where it
+// happens: the OS audio callback times itself, and each chunk carries the
+// time its oldest sample was pushed to the JS thread, which records the
+// delivery latency and the JS handler's run time. Cheap enough to leave on.
+
+#ifndef CAPTURE_CAPTURE_METRICS_H
+#define CAPTURE_CAPTURE_METRICS_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "latency_histogram.h"
+
+namespace capture {
+
+struct CaptureMetrics {
+    LatencyHistogram callback;     // OS audio callback, per packet: convert + push
+    LatencyHistogram delivery;     // oldest sample of a chunk pushed -> JS callback called
+    LatencyHistogram jsHandler;    // the JS callback, per chunk
+    std::atomic<uint64_t> bytesOut{0};          // handed to JS
+    std::atomic<int64_t> queuedChunks{0};       // in the thread-safe function's queue
+    std::atomic<int64_t> maxQueuedChunks{0};    // since the last reset
+
+    void chunkQueued() {
+        const int64_t queued = queuedChunks.fetch_add(1, std::memory_order_relaxed) + 1;
+        int64_t max = maxQueuedChunks.load(std::memory_order_relaxed);
+        while (queued > max && !maxQueuedChunks.compare_exchange_weak(max, queued, std::memory_order_relaxed)) {
+        }
+    }
+    void chunkDequeued() { queuedChunks.fetch_sub(1, std::memory_order_relaxed); }
+
+    // Histograms and the queue high-water mark start a new interval;
+    // counters keep counting
+    void resetInterval() {
+        callback.reset();
+        delivery.reset();
+        jsHandler.reset();
+        maxQueuedChunks.store(queuedChunks.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+};
+
+// A chunk on its way through the thread-safe function to the JS callback
+struct QueuedChunk {
+    std::vector<float> samples;
+    int64_t capturedNs;                         // steadyNowNs() of its oldest sample's push
+    std::shared_ptr<CaptureMetrics> metrics;    // may outlive the capture
+    uint64_t flowId;                            // trace arrow into the JS callback, 0: none
+};
+
+} // namespace capture
+
+#endif
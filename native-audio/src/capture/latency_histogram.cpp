@@ -0,0 +1,104 @@
+#include "latency_histogram.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace capture {
+
+namespace {
+
+int floorLog2(uint64_t v) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, v);
+    return static_cast<int>(index);
+#else
+    return 63 - __builtin_clzll(v);
+#endif
+}
+
+const uint64_t kSubBuckets = uint64_t(1) << LatencyHistogram::kSubBucketBits;
+
+} // namespace
+
+LatencyHistogram::LatencyHistogram() : count_(0), sumNs_(0), maxNs_(0) {
+    for (auto& bucket : buckets_) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+size_t LatencyHistogram::bucketIndex(uint64_t ns) {
+    if (ns < kSubBuckets) return static_cast<size_t>(ns);
+    const int exponent = floorLog2(ns);
+    if (exponent > kMaxExponent) return kBuckets - 1;
+    const int shift = exponent - kSubBucketBits;
+    return static_cast<size_t>(kSubBuckets + (static_cast<uint64_t>(shift) << kSubBucketBits) +
+                               ((ns >> shift) - kSubBuckets));
+}
+
+uint64_t LatencyHistogram::bucketUpperNs(size_t index) {
+    if (index < kSubBuckets) return index;
+    const size_t j = index - kSubBuckets;
+    const int shift = static_cast<int>(j >> kSubBucketBits);
+    const uint64_t sub = kSubBuckets + (j & (kSubBuckets - 1));
+    return ((sub + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(int64_t ns) {
+    const uint64_t value = ns > 0 ? static_cast<uint64_t>(ns) : 0;
+    buckets_[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sumNs_.fetch_add(value, std::memory_order_relaxed);
+    uint64_t max = maxNs_.load(std::memory_order_relaxed);
+    while (value > max && !maxNs_.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+    }
+}
+
+HistogramSummary LatencyHistogram::summary() const {
+    uint64_t counts[kBuckets];
+    uint64_t total = 0;
+    for (size_t i = 0; i < kBuckets; i++) {
+        counts[i] = buckets_[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+
+    HistogramSummary summary;
+    summary.count = total;
+    if (total == 0) return summary;
+
+    const double maxNs = static_cast<double>(maxNs_.load(std::memory_order_relaxed));
+    summary.maxUs = maxNs / 1000.0;
+    const uint64_t sampleCount = count_.load(std::memory_order_relaxed);
+    if (sampleCount > 0) {
+        summary.meanUs = static_cast<double>(sumNs_.load(std::memory_order_relaxed)) / sampleCount / 1000.0;
+    }
+
+    const double quantiles[] = {0.5, 0.9, 0.99, 0.999};
+    double* outputs[] = {&summary.p50Us, &summary.p90Us, &summary.p99Us, &summary.p999Us};
+    size_t bucket = 0;
+    uint64_t seen = 0;
+    for (int q = 0; q < 4; q++) {
+        // Rank of the quantile, 1-based
+        uint64_t rank = static_cast<uint64_t>(quantiles[q] * total + 0.5);
+        if (rank < 1) rank = 1;
+        while (bucket < kBuckets && seen + counts[bucket] < rank) {
+            seen += counts[bucket];
+            bucket++;
+        }
+        const double upper = static_cast<double>(bucketUpperNs(bucket < kBuckets ? bucket : kBuckets - 1));
+        *outputs[q] = (upper < maxNs ? upper : maxNs) / 1000.0;
+    }
+    return summary;
+}
+
+void LatencyHistogram::reset() {
+    for (auto& bucket : buckets_) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    count_.store(0, std::memory_order_relaxed);
+    sumNs_.store(0, std::memory_order_relaxed);
+    maxNs_.store(0, std::memory_order_relaxed);
+}
+
+} // namespace capture
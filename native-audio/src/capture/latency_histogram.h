@@ -0,0 +1,64 @@
+// Lock-free latency histogram for the addons' getStats()
+//
+// HDR-style log-linear buckets over nanoseconds: exact below 32 ns, then 32
+// buckets per power of two (about 3% relative error) up to 2^40 ns (18
+// minutes; longer values land in the last bucket). record() is a handful of
+// relaxed atomic adds and never allocates, locks or calls the OS, so any
+// thread can record, the audio callback included, and it can stay on in
+// production. summary() may run concurrently with recording; it then sees
+// some of the in-flight values and not others.
+
+#ifndef CAPTURE_LATENCY_HISTOGRAM_H
+#define CAPTURE_LATENCY_HISTOGRAM_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace capture {
+
+// steady_clock in nanoseconds: the time base of the histograms (and of
+// timestamps passed between threads)
+inline int64_t steadyNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct HistogramSummary {
+    uint64_t count = 0;
+    double meanUs = 0;
+    double p50Us = 0;
+    double p90Us = 0;
+    double p99Us = 0;
+    double p999Us = 0;
+    double maxUs = 0;
+};
+
+class LatencyHistogram {
+public:
+    static const int kSubBucketBits = 5;
+    static const int kMaxExponent = 40;
+    static const size_t kBuckets = (kMaxExponent - kSubBucketBits + 2) << kSubBucketBits;
+
+    LatencyHistogram();
+
+    void record(int64_t ns);
+    // Percentiles are the upper edge of the bucket they fall in
+    HistogramSummary summary() const;
+    // Starts a new interval. Values recorded during the reset may be lost.
+    void reset();
+
+    static size_t bucketIndex(uint64_t ns);
+    static uint64_t bucketUpperNs(size_t index);
+
+private:
+    std::atomic<uint64_t> buckets_[kBuckets];
+    std::atomic<uint64_t> count_;
+    std::atomic<uint64_t> sumNs_;
+    std::atomic<uint64_t> maxNs_;
+};
+
+} // namespace capture
+
+#endif
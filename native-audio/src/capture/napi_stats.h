@@ -0,0 +1,55 @@
+// getStats() helpers shared by the addons
+
+#ifndef CAPTURE_NAPI_STATS_H
+#define CAPTURE_NAPI_STATS_H
+
+#include <napi.h>
+
+#include "capture_delivery.h"
+#include "capture_metrics.h"
+#include "latency_histogram.h"
+
+namespace capture {
+
+// { count, meanUs, p50Us, p90Us, p99Us, p999Us, maxUs }
+inline Napi::Object histogramToJs(Napi::Env env, const HistogramSummary& summary) {
+    Napi::Object out = Napi::Object::New(env);
+    out.Set("count", Napi::Number::New(env, static_cast<double>(summary.count)));
+    out.Set("meanUs", Napi::Number::New(env, summary.meanUs));
+    out.Set("p50Us", Napi::Number::New(env, summary.p50Us));
+    out.Set("p90Us", Napi::Number::New(env, summary.p90Us));
+    out.Set("p99Us", Napi::Number::New(env, summary.p99Us));
+    out.Set("p999Us", Napi::Number::New(env, summary.p999Us));
+    out.Set("maxUs", Napi::Number::New(env, summary.maxUs));
+    return out;
+}
+
+// getStats({ reset: true }): histograms cover the time since the last reset
+inline bool statsResetRequested(const Napi::CallbackInfo& info) {
+    if (info.Length() < 1 || !info[0].IsObject()) return false;
+    Napi::Value reset = info[0].As<Napi::Object>().Get("reset");
+    return reset.IsBoolean() && reset.As<Napi::Boolean>().Value();
+}
+
+// The capture addons' counters beyond samples, and their histograms:
+// packetsIn, bytesOut, queuedChunks, maxQueuedChunks,
+// latency: { callback, delivery, jsHandler }
+inline void setCaptureMetrics(Napi::Env env, Napi::Object stats, const DeliveryStats& delivery,
+                              CaptureMetrics& metrics, bool reset) {
+    stats.Set("packetsIn", Napi::Number::New(env, static_cast<double>(delivery.packets)));
+    stats.Set("bytesOut", Napi::Number::New(env, static_cast<double>(metrics.bytesOut.load())));
+    stats.Set("queuedChunks", Napi::Number::New(env, static_cast<double>(metrics.queuedChunks.load())));
+    stats.Set("maxQueuedChunks", Napi::Number::New(env, static_cast<double>(metrics.maxQueuedChunks.load())));
+
+    Napi::Object latency = Napi::Object::New(env);
+    latency.Set("callback", histogramToJs(env, metrics.callback.summary()));
+    latency.Set("delivery", histogramToJs(env, metrics.delivery.summary()));
+    latency.Set("jsHandler", histogramToJs(env, metrics.jsHandler.summary()));
+    stats.Set("latency", latency);
+
+    if (reset) metrics.resetInterval();
+}
+
+} // namespace capture
+
+#endif
@@ -0,0 +1,346 @@
+#include "realtime_check.h"
+
+#if defined(AUDIO_RT_CHECKS)
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#if defined(_WIN32)
+#include <crtdbg.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+#if defined(__GLIBC__)
+#include <dlfcn.h>
+#include <malloc.h>
+#endif
+
+#if defined(__GLIBC__) || defined(__APPLE__) || (defined(_WIN32) && defined(_DEBUG))
+#define RT_MALLOC_HOOKED 1
+#endif
+
+namespace capture {
+
+namespace {
+
+std::atomic<int> g_mode{static_cast<int>(RtMode::Count)};
+std::atomic<uint64_t> g_allocations{0};
+std::atomic<uint64_t> g_frees{0};
+std::atomic<uint64_t> g_locks{0};
+std::atomic<const char*> g_firstScope{nullptr};
+std::atomic<int> g_firstKind{0};
+
+// Per-thread state. POSIX thread-specific data never allocates, where a
+// thread_local in a shared library may on its first use on a thread, which
+// would re-enter the allocation hooks.
+#if defined(_WIN32)
+thread_local intptr_t t_depth = 0;
+thread_local const char* t_name = nullptr;
+thread_local intptr_t t_reporting = 0;
+
+intptr_t depth() { return t_depth; }
+void setDepth(intptr_t d) { t_depth = d; }
+const char* scopeName() { return t_name; }
+void setScopeName(const char* name) { t_name = name; }
+bool reporting() { return t_reporting != 0; }
+void setReporting(bool r) { t_reporting = r ? 1 : 0; }
+#else
+struct Keys {
+    pthread_key_t depth;
+    pthread_key_t name;
+    pthread_key_t reporting;
+    Keys() {
+        pthread_key_create(&depth, nullptr);
+        pthread_key_create(&name, nullptr);
+        pthread_key_create(&reporting, nullptr);
+    }
+};
+const Keys g_keys;
+
+intptr_t depth() { return reinterpret_cast<intptr_t>(pthread_getspecific(g_keys.depth)); }
+void setDepth(intptr_t d) { pthread_setspecific(g_keys.depth, reinterpret_cast<void*>(d)); }
+const char* scopeName() { return static_cast<const char*>(pthread_getspecific(g_keys.name)); }
+void setScopeName(const char* name) { pthread_setspecific(g_keys.name, name); }
+bool reporting() { return pthread_getspecific(g_keys.reporting) != nullptr; }
+void setReporting(bool r) { pthread_setspecific(g_keys.reporting, r ? reinterpret_cast<void*>(1) : nullptr); }
+#endif
+
+const char* kindName(RtViolation kind) {
+    switch (kind) {
+        case RtViolation::Allocation: return "allocation";
+        case RtViolation::Free: return "free";
+        case RtViolation::Lock: return "mutex lock";
+    }
+    return "violation";
+}
+
+#if defined(__GLIBC__)
+// Interposed only if this is the executable's malloc (not a shared library's)
+bool mallocInterposed() {
+    static const bool interposed = dlsym(RTLD_DEFAULT, "malloc") == reinterpret_cast<void*>(&::malloc);
+    return interposed;
+}
+#endif
+
+} // namespace
+
+bool rtChecksEnabled() { return true; }
+
+bool rtDetectsMalloc() {
+#if defined(__GLIBC__)
+    return mallocInterposed();
+#elif defined(RT_MALLOC_HOOKED)
+    return true;
+#else
+    return false;   // operator new / delete only
+#endif
+}
+
+bool rtDetectsLocks() {
+#if defined(__GLIBC__)
+    return mallocInterposed();   // interposed the same way
+#else
+    return false;
+#endif
+}
+
+void rtSetMode(RtMode mode) { g_mode.store(static_cast<int>(mode), std::memory_order_relaxed); }
+
+RtCheckStats rtStats() {
+    RtCheckStats stats;
+    stats.allocations = g_allocations.load(std::memory_order_relaxed);
+    stats.frees = g_frees.load(std::memory_order_relaxed);
+    stats.locks = g_locks.load(std::memory_order_relaxed);
+    stats.firstScope = g_firstScope.load(std::memory_order_relaxed);
+    stats.firstKind = static_cast<RtViolation>(g_firstKind.load(std::memory_order_relaxed));
+    return stats;
+}
+
+void rtResetStats() {
+    g_allocations.store(0, std::memory_order_relaxed);
+    g_frees.store(0, std::memory_order_relaxed);
+    g_locks.store(0, std::memory_order_relaxed);
+    g_firstScope.store(nullptr, std::memory_order_relaxed);
+}
+
+bool rtOnRealtimeThread() { return depth() > 0; }
+
+void rtEnter(const char* name) {
+    const intptr_t d = depth();
+    if (d == 0) setScopeName(name);
+    setDepth(d + 1);
+}
+
+void rtLeave() {
+    const intptr_t d = depth();
+    if (d > 0) setDepth(d - 1);
+}
+
+void rtViolation(RtViolation kind, size_t bytes) {
+    if (depth() == 0 || reporting()) return;
+    switch (kind) {
+        case RtViolation::Allocation: g_allocations.fetch_add(1, std::memory_order_relaxed); break;
+        case RtViolation::Free: g_frees.fetch_add(1, std::memory_order_relaxed); break;
+        case RtViolation::Lock: g_locks.fetch_add(1, std::memory_order_relaxed); break;
+    }
+    const char* expected = nullptr;
+    if (g_firstScope.compare_exchange_strong(expected, scopeName(), std::memory_order_relaxed)) {
+        g_firstKind.store(static_cast<int>(kind), std::memory_order_relaxed);
+    }
+    if (g_mode.load(std::memory_order_relaxed) != static_cast<int>(RtMode::Abort)) return;
+
+    // Whatever reporting itself allocates or locks is not counted
+    setReporting(true);
+    char message[256];
+    const int n = std::snprintf(message, sizeof(message), "real-time violation: %s%s%zu%s in \"%s\"\n",
+                                kindName(kind), bytes ? " of " : "", bytes, bytes ? " bytes" : "",
+                                scopeName() ? scopeName() : "?");
+#if defined(_WIN32)
+    std::fwrite(message, 1, n > 0 ? static_cast<size_t>(n) : 0, stderr);
+#else
+    if (n > 0) {
+        ssize_t ignored = write(2, message, static_cast<size_t>(n));
+        (void)ignored;
+    }
+#endif
+    std::abort();
+}
+
+} // namespace capture
+
+// Allocation hooks ----------------------------------------------------------
+
+#if defined(__GLIBC__)
+
+// The executable's definitions take the place of libc's for the whole
+// process, operator new included; they forward to glibc's allocator.
+extern "C" {
+void* __libc_malloc(size_t size);
+void __libc_free(void* p);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* p, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+
+void* malloc(size_t size) {
+    capture::rtViolation(capture::RtViolation::Allocation, size);
+    return __libc_malloc(size);
+}
+
+void free(void* p) {
+    if (p) capture::rtViolation(capture::RtViolation::Free, 0);
+    __libc_free(p);
+}
+
+void* calloc(size_t count, size_t size) {
+    capture::rtViolation(capture::RtViolation::Allocation, count * size);
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* p, size_t size) {
+    capture::rtViolation(capture::RtViolation::Allocation, size);
+    return __libc_realloc(p, size);
+}
+
+void* memalign(size_t alignment, size_t size) {
+    capture::rtViolation(capture::RtViolation::Allocation, size);
+    return __libc_memalign(alignment, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size) {
+    capture::rtViolation(capture::RtViolation::Allocation, size);
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** out, size_t alignment, size_t size) {
+    if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0) return 22;   // EINVAL
+    capture::rtViolation(capture::RtViolation::Allocation, size);
+    void* p = __libc_memalign(alignment, size);
+    if (!p) return 12;   // ENOMEM
+    *out = p;
+    return 0;
+}
+
+void* valloc(size_t size) {
+    capture::rtViolation(capture::RtViolation::Allocation, size);
+    return __libc_memalign(static_cast<size_t>(sysconf(_SC_PAGESIZE)), size);
+}
+
+void* pvalloc(size_t size) {
+    capture::rtViolation(capture::RtViolation::Allocation, size);
+    const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return __libc_memalign(page, (size + page - 1) / page * page);
+}
+
+// std::mutex::lock lands here too. The real function is looked up on first
+// use (dlsym does not take this lock).
+int pthread_mutex_lock(pthread_mutex_t* mutex) {
+    using LockFn = int (*)(pthread_mutex_t*);
+    static LockFn next = reinterpret_cast<LockFn>(dlsym(RTLD_NEXT, "pthread_mutex_lock"));
+    capture::rtViolation(capture::RtViolation::Lock, 0);
+    return next(mutex);
+}
+}
+
+#elif defined(__APPLE__)
+
+// libmalloc calls malloc_logger (the MallocStackLogging hook) for every zone
+// allocation and free in the process, whichever image made it
+typedef void(malloc_logger_t)(uint32_t type, uintptr_t arg1, uintptr_t arg2, uintptr_t arg3, uintptr_t result,
+                              uint32_t numHotFramesToSkip);
+extern "C" malloc_logger_t* malloc_logger;
+
+namespace {
+
+constexpr uint32_t kLogAlloc = 2;
+constexpr uint32_t kLogDealloc = 4;
+constexpr uint32_t kLogVm = 16 | 32;   // vm_allocate / vm_deallocate, not malloc
+
+malloc_logger_t* g_previousLogger = nullptr;
+
+void realtimeMallocLogger(uint32_t type, uintptr_t arg1, uintptr_t arg2, uintptr_t arg3, uintptr_t result,
+                          uint32_t numHotFramesToSkip) {
+    if (!(type & kLogVm)) {
+        if (type & kLogAlloc) capture::rtViolation(capture::RtViolation::Allocation, 0);
+        if ((type & kLogDealloc) && !(type & kLogAlloc)) capture::rtViolation(capture::RtViolation::Free, 0);
+    }
+    if (g_previousLogger) g_previousLogger(type, arg1, arg2, arg3, result, numHotFramesToSkip + 1);
+}
+
+struct InstallMallocLogger {
+    InstallMallocLogger() {
+        g_previousLogger = malloc_logger;
+        malloc_logger = realtimeMallocLogger;
+    }
+} g_installMallocLogger;
+
+} // namespace
+
+#elif defined(_WIN32) && defined(_DEBUG)
+
+namespace {
+
+int __cdecl realtimeAllocHook(int allocType, void*, size_t size, int blockType, long, const unsigned char*, int) {
+    if (blockType == _CRT_BLOCK) return TRUE;   // the CRT's own bookkeeping
+    if (allocType == _HOOK_FREE) {
+        capture::rtViolation(capture::RtViolation::Free, 0);
+    } else {
+        capture::rtViolation(capture::RtViolation::Allocation, size);
+    }
+    return TRUE;
+}
+
+struct InstallAllocHook {
+    InstallAllocHook() { _CrtSetAllocHook(realtimeAllocHook); }
+} g_installAllocHook;
+
+} // namespace
+
+#endif
+
+#if !defined(RT_MALLOC_HOOKED)
+
+// No allocator hook on this platform: catch C++ allocations at least
+void* operator new(size_t size) {
+    capture::rtViolation(capture::RtViolation::Allocation, size);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t size) { return ::operator new(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    capture::rtViolation(capture::RtViolation::Allocation, size);
+    return std::malloc(size ? size : 1);
+}
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept { return ::operator new(size, tag); }
+void operator delete(void* p) noexcept {
+    if (p) capture::rtViolation(capture::RtViolation::Free, 0);
+    std::free(p);
+}
+void operator delete[](void* p) noexcept { ::operator delete(p); }
+void operator delete(void* p, size_t) noexcept { ::operator delete(p); }
+void operator delete[](void* p, size_t) noexcept { ::operator delete(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { ::operator delete(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { ::operator delete(p); }
+
+#endif
+
+#else   // !AUDIO_RT_CHECKS
+
+namespace capture {
+
+bool rtChecksEnabled() { return false; }
+bool rtDetectsMalloc() { return false; }
+bool rtDetectsLocks() { return false; }
+void rtSetMode(RtMode) {}
+RtCheckStats rtStats() { return RtCheckStats(); }
+void rtResetStats() {}
+bool rtOnRealtimeThread() { return false; }
+void rtViolation(RtViolation, size_t) {}
+void rtEnter(const char*) {}
+void rtLeave() {}
+
+} // namespace capture
+
+#endif
@@ -0,0 +1,80 @@
+// Real-time safety checks for audio callback threads (debug builds)
+//
+// Code that runs on an OS audio thread (the ScreenCaptureKit sample handler,
+// the WASAPI capture loop, a DSP block in a render callback) must not
+// allocate, free or wait on a lock: any of them can stall for longer than
+// the buffer lasts. Such code opens a RealtimeScope; while one is open on a
+// thread, every allocation, free and mutex lock it makes is a violation,
+// counted (RtMode::Count) or fatal with a message naming the scope
+// (RtMode::Abort).
+//
+// The checks are compiled in with AUDIO_RT_CHECKS defined; otherwise
+// RealtimeScope is empty and the functions report nothing. What is seen:
+//
+//   operator new / delete   everywhere
+//   malloc family           glibc, when linked into the executable (the
+//                           functions are interposed); macOS via the
+//                           malloc_logger hook; Windows debug CRT via
+//                           _CrtSetAllocHook
+//   pthread_mutex_lock      glibc executables only (std::mutex included)
+//
+// So the complete check is an executable on Linux (rt_safety_check); inside
+// the addons on macOS and Windows allocations are still caught.
+
+#ifndef CAPTURE_REALTIME_CHECK_H
+#define CAPTURE_REALTIME_CHECK_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace capture {
+
+enum class RtMode { Count, Abort };
+enum class RtViolation { Allocation, Free, Lock };
+
+struct RtCheckStats {
+    uint64_t allocations = 0;
+    uint64_t frees = 0;
+    uint64_t locks = 0;
+    // Scope and kind of the first violation since the last reset
+    const char* firstScope = nullptr;
+    RtViolation firstKind = RtViolation::Allocation;
+
+    uint64_t total() const { return allocations + frees + locks; }
+};
+
+// True when built with AUDIO_RT_CHECKS
+bool rtChecksEnabled();
+// Which violations this build can see (see above)
+bool rtDetectsMalloc();
+bool rtDetectsLocks();
+
+void rtSetMode(RtMode mode);
+RtCheckStats rtStats();
+void rtResetStats();
+
+// The calling thread is inside a RealtimeScope
+bool rtOnRealtimeThread();
+// Called by the hooks; ignored unless the calling thread is real-time
+void rtViolation(RtViolation kind, size_t bytes);
+
+void rtEnter(const char* name);
+void rtLeave();
+
+// Marks the calling thread real-time until the scope closes. Nestable; name
+// must outlive the scope (a string literal).
+class RealtimeScope {
+public:
+#if defined(AUDIO_RT_CHECKS)
+    explicit RealtimeScope(const char* name) { rtEnter(name); }
+    ~RealtimeScope() { rtLeave(); }
+#else
+    explicit RealtimeScope(const char*) {}
+#endif
+    RealtimeScope(const RealtimeScope&) = delete;
+    RealtimeScope& operator=(const RealtimeScope&) = delete;
+};
+
+} // namespace capture
+
+#endif
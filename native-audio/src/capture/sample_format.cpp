@@ -0,0 +1,50 @@
+#include "sample_format.h"
+
+#include <algorithm>
+
+namespace capture {
+
+void int16ToFloat(const int16_t* in, float* out, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        out[i] = in[i] * (1.0f / 32768.0f);
+    }
+}
+
+void int32ToFloat(const int32_t* in, float* out, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        out[i] = static_cast<float>(in[i]) * (1.0f / 2147483648.0f);
+    }
+}
+
+void floatToInt16(const float* in, int16_t* out, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        const float x = in[i];
+        const float s = std::min(std::max(x == x ? x : 0.0f, -1.0f), 1.0f);   // NaN -> 0, as in JS
+        const float scale = s < 0.0f ? 32768.0f : 32767.0f;
+        out[i] = static_cast<int16_t>(static_cast<int32_t>(s * scale));
+    }
+}
+
+void PacketConverter::reserve(size_t samples) {
+    if (buffer_.size() < samples) buffer_.resize(samples);
+}
+
+const float* PacketConverter::convert(const void* data, size_t samples, SampleFormat format) {
+    switch (format) {
+        case SampleFormat::Float32:
+            return static_cast<const float*>(data);
+        case SampleFormat::Int16:
+            reserve(samples);
+            int16ToFloat(static_cast<const int16_t*>(data), buffer_.data(), samples);
+            return buffer_.data();
+        case SampleFormat::Int32:
+            reserve(samples);
+            int32ToFloat(static_cast<const int32_t*>(data), buffer_.data(), samples);
+            return buffer_.data();
+        case SampleFormat::Unsupported:
+            break;
+    }
+    return nullptr;
+}
+
+} // namespace capture
@@ -0,0 +1,43 @@
+// Sample format conversion on the capture paths
+//
+// The capture backends receive int16, int32 or float32 PCM depending on the
+// device and hand float32 to the ring; the microphone path sends 16-bit PCM
+// on. The int-to-float loops vectorize; floatToInt16's clamp keeps GCC from
+// vectorizing it without -ffast-math (hot_paths_bench shows the difference).
+
+#ifndef CAPTURE_SAMPLE_FORMAT_H
+#define CAPTURE_SAMPLE_FORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace capture {
+
+// [-32768, 32767] -> [-1, 1)
+void int16ToFloat(const int16_t* in, float* out, size_t count);
+// [-2^31, 2^31) -> [-1, 1)
+void int32ToFloat(const int32_t* in, float* out, size_t count);
+// Clamped to [-1, 1], then scaled by 32768 below zero and 32767 above (the
+// renderer's floatTo16BitPCM), truncated toward zero
+void floatToInt16(const float* in, int16_t* out, size_t count);
+
+enum class SampleFormat { Unsupported, Float32, Int16, Int32 };
+
+// Interleaved device packets to float32 for the ring. Runs on the audio
+// thread: the buffer only grows, so once reserve() has seen the largest
+// packet (or one has passed) convert() does not allocate.
+class PacketConverter {
+public:
+    void reserve(size_t samples);
+
+    // Float32 input is returned as is; nullptr for an unsupported format
+    const float* convert(const void* data, size_t samples, SampleFormat format);
+
+private:
+    std::vector<float> buffer_;
+};
+
+} // namespace capture
+
+#endif
@@ -0,0 +1,353 @@
+#include "ogg_opus_encoder.h"
+
+#include <opus.h>
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+
+namespace codec {
+
+namespace {
+
+// Largest packet libopus produces for a single frame (RFC 6716, 3.4)
+constexpr size_t kMaxPacketBytes = 1275 * 3 + 7;
+constexpr size_t kMaxLacingValues = 255;
+constexpr int kOggHeaderBos = 0x02;
+constexpr int kOggHeaderEos = 0x04;
+constexpr char kVendor[] = "native-audio-capture";
+
+struct CrcTable {
+    uint32_t table[256];
+    CrcTable() {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t r = i << 24;
+            for (int j = 0; j < 8; j++) {
+                r = (r & 0x80000000u) ? (r << 1) ^ 0x04c11db7u : (r << 1);
+            }
+            table[i] = r;
+        }
+    }
+};
+
+const CrcTable& crcTable() {
+    static const CrcTable table;
+    return table;
+}
+
+void putLE16(std::vector<uint8_t>& v, uint16_t x) {
+    v.push_back(x & 0xff);
+    v.push_back(x >> 8);
+}
+
+void putLE32(std::vector<uint8_t>& v, uint32_t x) {
+    for (int i = 0; i < 4; i++) v.push_back((x >> (8 * i)) & 0xff);
+}
+
+void putLE32At(uint8_t* p, uint32_t x) {
+    for (int i = 0; i < 4; i++) p[i] = (x >> (8 * i)) & 0xff;
+}
+
+void putLE64At(uint8_t* p, uint64_t x) {
+    for (int i = 0; i < 8; i++) p[i] = (x >> (8 * i)) & 0xff;
+}
+
+bool isValidFrameDuration(float ms) {
+    static const float allowed[] = {2.5f, 5.0f, 10.0f, 20.0f, 40.0f, 60.0f};
+    for (float a : allowed) {
+        if (ms == a) return true;
+    }
+    return false;
+}
+
+} // namespace
+
+uint32_t oggCrc32(const uint8_t* data, size_t length, uint32_t crc) {
+    const uint32_t* table = crcTable().table;
+    for (size_t i = 0; i < length; i++) {
+        crc = (crc << 8) ^ table[((crc >> 24) & 0xff) ^ data[i]];
+    }
+    return crc;
+}
+
+OggOpusEncoder::OggOpusEncoder(const OggOpusConfig& config)
+    : config_(config),
+      encoder_(nullptr),
+      frameSize_(0),
+      preSkip_(0),
+      granuleScale_(1),
+      pendingFrames_(0),
+      pagePackets_(0),
+      pageSamples_(0),
+      pageGranule_(0),
+      headersWritten_(false),
+      serial_(0),
+      pageSequence_(0),
+      granulePos_(0),
+      streamSamples_(0),
+      totalSamplesIn_(0),
+      totalBytesOut_(0),
+      totalPacketsOut_(0) {
+    const int rate = config_.sampleRate;
+    if (rate != 8000 && rate != 12000 && rate != 16000 && rate != 24000 && rate != 48000) {
+        error_ = "sampleRate must be 8000, 12000, 16000, 24000 or 48000";
+        return;
+    }
+    if (config_.channels != 1 && config_.channels != 2) {
+        error_ = "channels must be 1 or 2";
+        return;
+    }
+    if (!isValidFrameDuration(config_.frameDurationMs)) {
+        error_ = "frameDurationMs must be 2.5, 5, 10, 20, 40 or 60";
+        return;
+    }
+
+    int err = OPUS_OK;
+    encoder_ = opus_encoder_create(rate, config_.channels,
+                                   config_.voip ? OPUS_APPLICATION_VOIP : OPUS_APPLICATION_AUDIO,
+                                   &err);
+    if (err != OPUS_OK || !encoder_) {
+        error_ = std::string("opus_encoder_create failed: ") + opus_strerror(err);
+        encoder_ = nullptr;
+        return;
+    }
+
+    opus_encoder_ctl(encoder_, OPUS_SET_BITRATE(config_.bitrate));
+    opus_encoder_ctl(encoder_, OPUS_SET_COMPLEXITY(std::max(0, std::min(10, config_.complexity))));
+    opus_encoder_ctl(encoder_, OPUS_SET_SIGNAL(config_.voip ? OPUS_SIGNAL_VOICE : OPUS_AUTO));
+
+    opus_int32 lookahead = 0;
+    opus_encoder_ctl(encoder_, OPUS_GET_LOOKAHEAD(&lookahead));
+
+    granuleScale_ = 48000 / rate;
+    preSkip_ = lookahead * granuleScale_;
+    frameSize_ = static_cast<int>(rate * config_.frameDurationMs / 1000.0f);
+
+    pending_.resize(static_cast<size_t>(frameSize_) * config_.channels, 0.0f);
+    packet_.resize(kMaxPacketBytes);
+    pageBody_.reserve(64 * 1024);
+    pageLacing_.reserve(kMaxLacingValues);
+
+    startStream();
+}
+
+OggOpusEncoder::~OggOpusEncoder() {
+    if (encoder_) {
+        opus_encoder_destroy(encoder_);
+    }
+}
+
+void OggOpusEncoder::startStream() {
+    static std::random_device rd;
+    serial_ = rd();
+    pageSequence_ = 0;
+    granulePos_ = 0;
+    streamSamples_ = 0;
+    headersWritten_ = false;
+    pendingFrames_ = 0;
+    pageBody_.clear();
+    pageLacing_.clear();
+    pagePackets_ = 0;
+    pageSamples_ = 0;
+    pageGranule_ = 0;
+}
+
+void OggOpusEncoder::reset() {
+    if (encoder_) {
+        opus_encoder_ctl(encoder_, OPUS_RESET_STATE);
+    }
+    startStream();
+}
+
+void OggOpusEncoder::writeHeaders(std::vector<uint8_t>& out) {
+    // Identification header, alone on the BOS page
+    std::vector<uint8_t> head;
+    head.insert(head.end(), {'O', 'p', 'u', 's', 'H', 'e', 'a', 'd'});
+    head.push_back(1);  // version
+    head.push_back(static_cast<uint8_t>(config_.channels));
+    putLE16(head, static_cast<uint16_t>(preSkip_));
+    putLE32(head, static_cast<uint32_t>(config_.sampleRate));
+    putLE16(head, 0);   // output gain
+    head.push_back(0);  // mapping family 0: mono/stereo
+
+    // Comment header, on its own page with granule 0
+    std::vector<uint8_t> tags;
+    tags.insert(tags.end(), {'O', 'p', 'u', 's', 'T', 'a', 'g', 's'});
+    putLE32(tags, sizeof(kVendor) - 1);
+    tags.insert(tags.end(), kVendor, kVendor + sizeof(kVendor) - 1);
+    putLE32(tags, 0);   // user comment count
+
+    uint8_t lacing[kMaxLacingValues];
+    size_t n = 0;
+    size_t remaining = head.size();
+    do {
+        lacing[n++] = static_cast<uint8_t>(std::min<size_t>(remaining, 255));
+        remaining = remaining >= 255 ? remaining - 255 : 0;
+    } while (lacing[n - 1] == 255);
+    writePage(head.data(), head.size(), lacing, n, kOggHeaderBos, 0, out);
+
+    n = 0;
+    remaining = tags.size();
+    do {
+        lacing[n++] = static_cast<uint8_t>(std::min<size_t>(remaining, 255));
+        remaining = remaining >= 255 ? remaining - 255 : 0;
+    } while (lacing[n - 1] == 255);
+    writePage(tags.data(), tags.size(), lacing, n, 0, 0, out);
+
+    headersWritten_ = true;
+}
+
+void OggOpusEncoder::writePage(const uint8_t* body, size_t bodyLength,
+                               const uint8_t* lacing, size_t lacingLength,
+                               uint8_t headerType, int64_t granule,
+                               std::vector<uint8_t>& out) {
+    const size_t start = out.size();
+    const size_t headerLength = 27 + lacingLength;
+    out.resize(start + headerLength + bodyLength);
+    uint8_t* p = out.data() + start;
+
+    std::memcpy(p, "OggS", 4);
+    p[4] = 0;  // stream structure version
+    p[5] = headerType;
+    putLE64At(p + 6, static_cast<uint64_t>(granule));
+    putLE32At(p + 14, serial_);
+    putLE32At(p + 18, pageSequence_++);
+    putLE32At(p + 22, 0);  // checksum, filled in below
+    p[26] = static_cast<uint8_t>(lacingLength);
+    if (lacingLength > 0) {
+        std::memcpy(p + 27, lacing, lacingLength);
+    }
+    if (bodyLength > 0) {
+        std::memcpy(p + headerLength, body, bodyLength);
+    }
+
+    putLE32At(p + 22, oggCrc32(p, headerLength + bodyLength));
+    totalBytesOut_ += headerLength + bodyLength;
+}
+
+void OggOpusEncoder::appendPacket(const uint8_t* data, size_t length, int64_t granule,
+                                  std::vector<uint8_t>& out) {
+    const size_t lacingNeeded = length / 255 + 1;
+    if (pageLacing_.size() + lacingNeeded > kMaxLacingValues) {
+        flush(out);
+    }
+
+    pageBody_.insert(pageBody_.end(), data, data + length);
+    size_t remaining = length;
+    while (remaining >= 255) {
+        pageLacing_.push_back(255);
+        remaining -= 255;
+    }
+    pageLacing_.push_back(static_cast<uint8_t>(remaining));
+
+    pagePackets_++;
+    pageSamples_ += frameSize_;
+    pageGranule_ = granule;
+    totalPacketsOut_++;
+
+    const int64_t pageMs = pageSamples_ * 1000 / config_.sampleRate;
+    if (pageMs >= config_.pageDurationMs) {
+        flush(out);
+    }
+}
+
+void OggOpusEncoder::flush(std::vector<uint8_t>& out) {
+    if (pagePackets_ == 0) {
+        return;
+    }
+    writePage(pageBody_.data(), pageBody_.size(),
+              pageLacing_.data(), pageLacing_.size(),
+              0, pageGranule_, out);
+    pageBody_.clear();
+    pageLacing_.clear();
+    pagePackets_ = 0;
+    pageSamples_ = 0;
+}
+
+bool OggOpusEncoder::encodePendingFrame(std::vector<uint8_t>& out, int64_t maxGranule) {
+    const opus_int32 bytes = opus_encode_float(encoder_, pending_.data(), frameSize_,
+                                               packet_.data(),
+                                               static_cast<opus_int32>(packet_.size()));
+    pendingFrames_ = 0;
+    if (bytes < 0) {
+        error_ = std::string("opus_encode_float failed: ") + opus_strerror(bytes);
+        return false;
+    }
+    granulePos_ += static_cast<int64_t>(frameSize_) * granuleScale_;
+    appendPacket(packet_.data(), static_cast<size_t>(bytes), std::min(granulePos_, maxGranule), out);
+    return true;
+}
+
+void OggOpusEncoder::encode(const float* samples, size_t numSamples, std::vector<uint8_t>& out) {
+    if (!encoder_ || numSamples == 0) {
+        return;
+    }
+    if (!headersWritten_) {
+        writeHeaders(out);
+    }
+
+    const size_t channels = static_cast<size_t>(config_.channels);
+    const size_t frames = numSamples / channels;
+    totalSamplesIn_ += frames;
+    streamSamples_ += static_cast<int64_t>(frames);
+
+    size_t consumed = 0;
+    while (consumed < frames) {
+        const size_t take = std::min(frames - consumed,
+                                     static_cast<size_t>(frameSize_) - pendingFrames_);
+        std::memcpy(pending_.data() + pendingFrames_ * channels,
+                    samples + consumed * channels,
+                    take * channels * sizeof(float));
+        pendingFrames_ += take;
+        consumed += take;
+        if (pendingFrames_ == static_cast<size_t>(frameSize_)) {
+            encodePendingFrame(out);
+        }
+    }
+}
+
+void OggOpusEncoder::encode(const int16_t* samples, size_t numSamples, std::vector<uint8_t>& out) {
+    // Convert in frame-sized slices so the staging buffer is the only copy
+    float block[960 * 2];
+    const size_t blockSamples = sizeof(block) / sizeof(block[0]);
+    size_t offset = 0;
+    while (offset < numSamples) {
+        const size_t n = std::min(blockSamples, numSamples - offset);
+        for (size_t i = 0; i < n; i++) {
+            block[i] = samples[offset + i] / 32768.0f;
+        }
+        encode(block, n, out);
+        offset += n;
+    }
+}
+
+void OggOpusEncoder::finish(std::vector<uint8_t>& out) {
+    if (!encoder_ || !headersWritten_) {
+        reset();
+        return;
+    }
+
+    // The decoder drops the first preSkip_ samples, so the last input sample
+    // only comes out once the encoder has produced preSkip_ more. Feed
+    // silence until it has, then end-trim the padding with the EOS granule.
+    const int64_t endGranule = streamSamples_ * granuleScale_ + preSkip_;
+    const size_t channels = static_cast<size_t>(config_.channels);
+    while (granulePos_ < endGranule) {
+        std::fill(pending_.begin() + pendingFrames_ * channels, pending_.end(), 0.0f);
+        if (!encodePendingFrame(out, endGranule)) {
+            break;
+        }
+    }
+
+    writePage(pageBody_.data(), pageBody_.size(),
+              pageLacing_.data(), pageLacing_.size(),
+              kOggHeaderEos, endGranule, out);
+    pageBody_.clear();
+    pageLacing_.clear();
+    pagePackets_ = 0;
+    pageSamples_ = 0;
+
+    reset();
+}
+
+} // namespace codec
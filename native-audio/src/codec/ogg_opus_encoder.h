@@ -0,0 +1,113 @@
+// Streaming Opus encoder with Ogg framing (RFC 7845)
+//
+// Takes float or int16 PCM in arbitrary block sizes, cuts it into Opus
+// frames and emits complete Ogg pages. The output of one stream (from the
+// first encode() call up to finish()) is a valid .opus file, and every
+// page boundary is a valid point to hand bytes to a socket or a file.
+
+#ifndef OGG_OPUS_ENCODER_H
+#define OGG_OPUS_ENCODER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct OpusEncoder;
+
+namespace codec {
+
+struct OggOpusConfig {
+    int sampleRate = 16000;        // 8000, 12000, 16000, 24000 or 48000
+    int channels = 1;              // 1 or 2
+    int bitrate = 24000;           // bits per second
+    float frameDurationMs = 20.0f; // 2.5, 5, 10, 20, 40 or 60
+    int complexity = 5;            // 0-10
+    bool voip = true;              // OPUS_APPLICATION_VOIP vs _AUDIO
+    int pageDurationMs = 200;      // close a page after this much audio (0 = one packet per page)
+};
+
+class OggOpusEncoder {
+public:
+    explicit OggOpusEncoder(const OggOpusConfig& config);
+    ~OggOpusEncoder();
+
+    OggOpusEncoder(const OggOpusEncoder&) = delete;
+    OggOpusEncoder& operator=(const OggOpusEncoder&) = delete;
+
+    // False if libopus rejected the configuration; see error().
+    bool isValid() const { return encoder_ != nullptr; }
+    const std::string& error() const { return error_; }
+
+    // Append interleaved samples. Completed pages are appended to out.
+    void encode(const float* samples, size_t numSamples, std::vector<uint8_t>& out);
+    void encode(const int16_t* samples, size_t numSamples, std::vector<uint8_t>& out);
+
+    // Close the page that is currently being filled, if any.
+    void flush(std::vector<uint8_t>& out);
+
+    // Pad with silence until the encoder has flushed its lookahead, write the
+    // EOS page trimmed to the input length and reset so the next encode()
+    // starts a new logical stream.
+    void finish(std::vector<uint8_t>& out);
+
+    // Drop buffered audio and start a new logical stream.
+    void reset();
+
+    const OggOpusConfig& config() const { return config_; }
+    int frameSize() const { return frameSize_; }
+
+    // Totals across all streams, for bitrate/throughput reporting.
+    uint64_t samplesIn() const { return totalSamplesIn_; }
+    uint64_t bytesOut() const { return totalBytesOut_; }
+    uint64_t packetsOut() const { return totalPacketsOut_; }
+
+private:
+    OggOpusConfig config_;
+    ::OpusEncoder* encoder_;
+    std::string error_;
+
+    int frameSize_;        // samples per channel per Opus frame
+    int preSkip_;          // encoder lookahead at 48 kHz
+    int granuleScale_;     // 48000 / sampleRate
+
+    // Partial-frame staging (interleaved)
+    std::vector<float> pending_;
+    size_t pendingFrames_;
+    std::vector<uint8_t> packet_;
+
+    // Ogg page being assembled
+    std::vector<uint8_t> pageBody_;
+    std::vector<uint8_t> pageLacing_;
+    int pagePackets_;
+    int64_t pageSamples_;
+    int64_t pageGranule_;
+
+    // Logical stream state
+    bool headersWritten_;
+    uint32_t serial_;
+    uint32_t pageSequence_;
+    int64_t granulePos_;      // 48 kHz samples encoded, pre-skip included
+    int64_t streamSamples_;   // input samples per channel in this stream
+
+    uint64_t totalSamplesIn_;
+    uint64_t totalBytesOut_;
+    uint64_t totalPacketsOut_;
+
+    void writeHeaders(std::vector<uint8_t>& out);
+    bool encodePendingFrame(std::vector<uint8_t>& out, int64_t maxGranule = INT64_MAX);
+    void appendPacket(const uint8_t* data, size_t length, int64_t granule,
+                      std::vector<uint8_t>& out);
+    void writePage(const uint8_t* body, size_t bodyLength,
+                   const uint8_t* lacing, size_t lacingLength,
+                   uint8_t headerType, int64_t granule,
+                   std::vector<uint8_t>& out);
+    void startStream();
+};
+
+// Ogg page checksum (polynomial 0x04c11db7, no reflection, zero init).
+uint32_t oggCrc32(const uint8_t* data, size_t length, uint32_t crc = 0);
+
+} // namespace codec
+
+#endif
@@ -0,0 +1,146 @@
+#include "audio_dsp.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <new>
+#include <vector>
+
+#include "loudness.h"
+#include "noise_reduction.h"
+#include "resampler.h"
+
+struct dsp_state {
+    dsp_config config;
+    dsp::Denoiser denoiser;
+
+    explicit dsp_state(const dsp_config& c) : config(c), denoiser(c.sample_rate, c.frame_size) {
+        denoiser.setStageTiming(c.stage_timing != 0);
+    }
+};
+
+struct dsp_resampler {
+    dsp::Resampler resampler;
+    std::vector<float> pending;   // produced, not yet returned
+    size_t pendingStart = 0;
+
+    dsp_resampler(int inputRate, int outputRate) : resampler(inputRate, outputRate) {}
+
+    size_t drain(float* output, size_t capacity) {
+        const size_t n = std::min(capacity, pending.size() - pendingStart);
+        if (n > 0) std::memcpy(output, pending.data() + pendingStart, n * sizeof(float));
+        pendingStart += n;
+        if (pendingStart == pending.size()) {
+            pending.clear();   // keeps the capacity: no allocation once warm
+            pendingStart = 0;
+        }
+        return n;
+    }
+};
+
+extern "C" {
+
+int dsp_api_version(void) {
+    return DSP_API_VERSION;
+}
+
+void dsp_config_init(dsp_config* config) {
+    if (!config) return;
+    config->size = sizeof(dsp_config);
+    config->sample_rate = dsp::kDenoiseSampleRate;
+    config->frame_size = 0;
+    config->stage_timing = 0;
+}
+
+dsp_state* dsp_create(const dsp_config* config) {
+    dsp_config c;
+    dsp_config_init(&c);
+    if (config) {
+        // Fields are only appended: those an older caller's struct lacks keep their defaults
+        if (config->size < offsetof(dsp_config, sample_rate) + sizeof(int)) return nullptr;
+        std::memcpy(&c, config, std::min(config->size, sizeof(dsp_config)));
+        c.size = sizeof(dsp_config);
+    }
+    if (c.sample_rate < 1000 || c.sample_rate > 384000 || c.frame_size < 0) return nullptr;
+    if (c.frame_size == 0) c.frame_size = c.sample_rate / 100;
+    return new (std::nothrow) dsp_state(c);
+}
+
+int dsp_process(dsp_state* state, float* samples, size_t count) {
+    if (!state || (!samples && count > 0)) return DSP_ERROR_INVALID;
+    state->denoiser.process(samples, count);
+    return DSP_OK;
+}
+
+int dsp_frame_size(const dsp_state* state) {
+    return state ? state->denoiser.frameSize() : 0;
+}
+
+int dsp_stage_times(const dsp_state* state, unsigned long long* spectral_ns, unsigned long long* gate_ns) {
+    if (!state) return DSP_ERROR_INVALID;
+    if (spectral_ns) *spectral_ns = state->denoiser.spectralNs();
+    if (gate_ns) *gate_ns = state->denoiser.gateNs();
+    return DSP_OK;
+}
+
+void dsp_reset(dsp_state* state) {
+    if (!state) return;
+    state->denoiser = dsp::Denoiser(state->config.sample_rate, state->config.frame_size);
+    state->denoiser.setStageTiming(state->config.stage_timing != 0);
+}
+
+void dsp_destroy(dsp_state* state) {
+    delete state;
+}
+
+dsp_resampler* dsp_resampler_create(int input_rate, int output_rate) {
+    if (input_rate <= 0 || output_rate <= 0) return nullptr;
+    return new (std::nothrow) dsp_resampler(input_rate, output_rate);
+}
+
+size_t dsp_resampler_max_output(const dsp_resampler* resampler, size_t input_count) {
+    if (!resampler) return 0;
+    return resampler->pending.size() - resampler->pendingStart + resampler->resampler.maxOutput(input_count);
+}
+
+size_t dsp_resampler_process(dsp_resampler* resampler, const float* input, size_t input_count, float* output,
+                             size_t output_capacity) {
+    if (!resampler) return 0;
+    if (input && input_count > 0) resampler->resampler.process(input, input_count, &resampler->pending);
+    return output ? resampler->drain(output, output_capacity) : 0;
+}
+
+size_t dsp_resampler_flush(dsp_resampler* resampler, float* output, size_t output_capacity) {
+    if (!resampler) return 0;
+    resampler->resampler.flush(&resampler->pending);
+    return output ? resampler->drain(output, output_capacity) : 0;
+}
+
+void dsp_resampler_reset(dsp_resampler* resampler) {
+    if (!resampler) return;
+    resampler->resampler.reset();
+    resampler->pending.clear();
+    resampler->pendingStart = 0;
+}
+
+void dsp_resampler_destroy(dsp_resampler* resampler) {
+    delete resampler;
+}
+
+double dsp_loudness(const float* samples, size_t count, int sample_rate) {
+    if (!samples || count == 0) return -HUGE_VAL;
+    return dsp::integratedLoudness(samples, count, sample_rate);
+}
+
+int dsp_normalize(float* samples, size_t count, int sample_rate, double target_lufs, double peak_db,
+                  double* gain_db) {
+    if ((!samples && count > 0) || sample_rate <= 0) return DSP_ERROR_INVALID;
+    dsp::LoudnessConfig config;
+    config.targetLufs = target_lufs;
+    config.peakDb = peak_db;
+    const dsp::LoudnessResult result = dsp::normalizeLoudness(samples, count, sample_rate, config);
+    if (gain_db) *gain_db = result.gainDb;
+    return DSP_OK;
+}
+
+} // extern "C"
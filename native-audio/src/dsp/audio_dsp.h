@@ -0,0 +1,94 @@
+/* C interface to the audio DSP library (static library target audio_dsp)
+ *
+ * Everything the addons, the batch tool and the benchmarks need from
+ * src/dsp/ behind opaque handles and plain C types, so the library can be
+ * linked from C, C++, or through an FFI without the C++ classes (or the
+ * Node runtime) in the way. Handles are not thread-safe; use one per
+ * stream. Functions returning int return DSP_OK or a negative DSP_ERROR_*.
+ *
+ * Compatibility: functions are only ever added. dsp_config carries its own
+ * size, so a caller built against an older header keeps working after
+ * fields are appended.
+ */
+
+#ifndef DSP_AUDIO_DSP_H
+#define DSP_AUDIO_DSP_H
+
+#include <stddef.h>
+
+#ifndef DSP_API
+# if defined(_WIN32) && defined(DSP_SHARED)
+#  define DSP_API __declspec(dllexport)
+# elif defined(__GNUC__)
+#  define DSP_API __attribute__((visibility("default")))
+# else
+#  define DSP_API
+# endif
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DSP_API_VERSION 2
+
+#define DSP_OK 0
+#define DSP_ERROR_INVALID (-1)
+
+DSP_API int dsp_api_version(void);
+
+/* Noise suppression (spectral reduction + noise gate), processed in place */
+
+typedef struct dsp_state dsp_state;
+
+typedef struct dsp_config {
+    size_t size;          /* sizeof(dsp_config), set by dsp_config_init */
+    int sample_rate;      /* default 48000 */
+    int frame_size;       /* samples per frame; default sample_rate / 100 */
+    int stage_timing;     /* nonzero: time each stage for dsp_stage_times (v2) */
+} dsp_config;
+
+DSP_API void dsp_config_init(dsp_config* config);
+/* NULL config: defaults. Returns NULL for an invalid config. */
+DSP_API dsp_state* dsp_create(const dsp_config* config);
+/* In place, any count: frames continue across calls, so the output is the
+ * same however the stream is split */
+DSP_API int dsp_process(dsp_state* state, float* samples, size_t count);
+DSP_API int dsp_frame_size(const dsp_state* state);
+/* Nanoseconds spent in spectral reduction and in the gate since creation or
+ * the last reset; zero unless created with stage_timing (v2) */
+DSP_API int dsp_stage_times(const dsp_state* state, unsigned long long* spectral_ns,
+                            unsigned long long* gate_ns);
+DSP_API void dsp_reset(dsp_state* state);
+DSP_API void dsp_destroy(dsp_state* state);
+
+/* Streaming sample rate conversion */
+
+typedef struct dsp_resampler dsp_resampler;
+
+DSP_API dsp_resampler* dsp_resampler_create(int input_rate, int output_rate);
+/* Output capacity that lets the next process() call return everything */
+DSP_API size_t dsp_resampler_max_output(const dsp_resampler* resampler, size_t input_count);
+/* Returns the samples written to output; any that did not fit are returned
+ * by the next call */
+DSP_API size_t dsp_resampler_process(dsp_resampler* resampler, const float* input, size_t input_count,
+                                     float* output, size_t output_capacity);
+/* End of stream: the remaining output (call until it returns 0) */
+DSP_API size_t dsp_resampler_flush(dsp_resampler* resampler, float* output, size_t output_capacity);
+DSP_API void dsp_resampler_reset(dsp_resampler* resampler);
+DSP_API void dsp_resampler_destroy(dsp_resampler* resampler);
+
+/* Loudness (BS.1770 integrated, mono) */
+
+/* LUFS, or -HUGE_VAL for silence */
+DSP_API double dsp_loudness(const float* samples, size_t count, int sample_rate);
+/* One gain to target_lufs, capped so the sample peak stays below peak_db.
+ * gain_db (optional) receives the gain applied; silence is left unchanged. */
+DSP_API int dsp_normalize(float* samples, size_t count, int sample_rate, double target_lufs, double peak_db,
+                          double* gain_db);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,131 @@
+#include "loudness.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace dsp {
+
+namespace {
+
+constexpr double kAbsoluteGateLufs = -70.0;
+constexpr double kRelativeGateLu = -10.0;
+
+struct Biquad {
+    double b0, b1, b2, a1, a2;
+    double z1 = 0.0, z2 = 0.0;
+
+    double run(double x) {
+        const double y = b0 * x + z1;
+        z1 = b1 * x - a1 * y + z2;
+        z2 = b2 * x - a2 * y;
+        return y;
+    }
+};
+
+// BS.1770 pre-filter (head diffraction shelf) at any sample rate
+Biquad shelf(int sampleRate) {
+    const double f0 = 1681.974450955533;
+    const double gainDb = 3.999843853973347;
+    const double q = 0.7071752369554196;
+    const double k = std::tan(M_PI * f0 / sampleRate);
+    const double vh = std::pow(10.0, gainDb / 20.0);
+    const double vb = std::pow(vh, 0.4996667741545416);
+    const double a0 = 1.0 + k / q + k * k;
+    return {(vh + vb * k / q + k * k) / a0, 2.0 * (k * k - vh) / a0, (vh - vb * k / q + k * k) / a0,
+            2.0 * (k * k - 1.0) / a0, (1.0 - k / q + k * k) / a0};
+}
+
+// BS.1770 RLB high-pass
+Biquad highPass(int sampleRate) {
+    const double f0 = 38.13547087602444;
+    const double q = 0.5003270373238773;
+    const double k = std::tan(M_PI * f0 / sampleRate);
+    const double a0 = 1.0 + k / q + k * k;
+    return {1.0, -2.0, 1.0, 2.0 * (k * k - 1.0) / a0, (1.0 - k / q + k * k) / a0};
+}
+
+double toLufs(double power) {
+    return -0.691 + 10.0 * std::log10(power);
+}
+
+} // namespace
+
+double integratedLoudness(const float* samples, size_t n, int sampleRate) {
+    if (n == 0 || sampleRate <= 0) return -HUGE_VAL;
+
+    // Mean square of the K-weighted signal per 100 ms step
+    Biquad pre = shelf(sampleRate);
+    Biquad rlb = highPass(sampleRate);
+    const size_t step = std::max<size_t>(1, static_cast<size_t>(sampleRate) / 10);
+    std::vector<double> stepPower;
+    stepPower.reserve(n / step + 1);
+    double energy = 0.0;
+    size_t count = 0;
+    for (size_t i = 0; i < n; i++) {
+        const double y = rlb.run(pre.run(samples[i]));
+        energy += y * y;
+        if (++count == step) {
+            stepPower.push_back(energy / step);
+            energy = 0.0;
+            count = 0;
+        }
+    }
+
+    // 400 ms blocks = 4 consecutive steps; shorter input is one block
+    std::vector<double> blocks;
+    if (stepPower.size() < 4) {
+        double total = energy;
+        for (double p : stepPower) total += p * step;
+        blocks.push_back(total / n);
+    } else {
+        for (size_t b = 0; b + 4 <= stepPower.size(); b++) {
+            blocks.push_back((stepPower[b] + stepPower[b + 1] + stepPower[b + 2] + stepPower[b + 3]) / 4.0);
+        }
+    }
+
+    double sum = 0.0;
+    size_t kept = 0;
+    for (double p : blocks) {
+        if (p > 0.0 && toLufs(p) > kAbsoluteGateLufs) {
+            sum += p;
+            kept++;
+        }
+    }
+    if (kept == 0) return -HUGE_VAL;
+
+    const double relativeGate = toLufs(sum / kept) + kRelativeGateLu;
+    double gatedSum = 0.0;
+    size_t gated = 0;
+    for (double p : blocks) {
+        if (p > 0.0 && toLufs(p) > kAbsoluteGateLufs && toLufs(p) > relativeGate) {
+            gatedSum += p;
+            gated++;
+        }
+    }
+    return gated > 0 ? toLufs(gatedSum / gated) : -HUGE_VAL;
+}
+
+LoudnessResult normalizeLoudness(float* samples, size_t n, int sampleRate, const LoudnessConfig& config) {
+    LoudnessResult result;
+    result.inputLufs = integratedLoudness(samples, n, sampleRate);
+    if (!std::isfinite(result.inputLufs)) return result;
+
+    double gainDb = std::min(config.targetLufs - result.inputLufs, config.maxGainDb);
+    float peak = 0.0f;
+    for (size_t i = 0; i < n; i++) peak = std::max(peak, std::fabs(samples[i]));
+    if (peak > 0.0f) {
+        const double headroomDb = config.peakDb - 20.0 * std::log10(peak);
+        if (gainDb > headroomDb) {
+            gainDb = headroomDb;
+            result.peakLimited = true;
+        }
+    }
+
+    result.gainDb = gainDb;
+    const float gain = static_cast<float>(std::pow(10.0, gainDb / 20.0));
+    for (size_t i = 0; i < n; i++) samples[i] *= gain;
+    return result;
+}
+
+} // namespace dsp
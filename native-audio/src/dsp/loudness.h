@@ -0,0 +1,37 @@
+// Integrated loudness (ITU-R BS.1770-4 / EBU R128) and normalization
+//
+// The signal is K-weighted (the standard's high shelf and high-pass, with
+// coefficients derived for the actual sample rate), mean square power is
+// taken over 400 ms blocks with 75% overlap, blocks below -70 LUFS and then
+// those more than 10 LU below the mean of the rest are discarded, and the
+// loudness is -0.691 + 10 log10 of the mean power of what remains. Mono
+// input: multichannel audio is downmixed before it gets here.
+
+#ifndef DSP_LOUDNESS_H
+#define DSP_LOUDNESS_H
+
+#include <cstddef>
+
+namespace dsp {
+
+// LUFS, or -HUGE_VAL when no block passes the absolute gate (silence)
+double integratedLoudness(const float* samples, size_t n, int sampleRate);
+
+struct LoudnessConfig {
+    double targetLufs = -23.0;   // EBU R128 programme level
+    double peakDb = -1.0;        // the gain is capped so the sample peak stays below
+    double maxGainDb = 30.0;     // quiet recordings are not amplified past this
+};
+
+struct LoudnessResult {
+    double inputLufs = 0.0;      // -HUGE_VAL for silence
+    double gainDb = 0.0;         // applied
+    bool peakLimited = false;    // the gain was reduced to respect peakDb
+};
+
+// Applies one gain to the whole buffer. Silence is left unchanged.
+LoudnessResult normalizeLoudness(float* samples, size_t n, int sampleRate, const LoudnessConfig& config);
+
+} // namespace dsp
+
+#endif
@@ -0,0 +1,121 @@
+#include "noise_reduction.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace dsp {
+
+NoiseGate::NoiseGate(int sr)
+    : threshold(0.01f),    // -40dB
+      attackTime(0.001f),  // 1ms
+      releaseTime(0.1f),   // 100ms
+      holdTime(0.05f),     // 50ms
+      envelope(0.0f),
+      holdCounter(0.0f),
+      prevGain(1.0f),
+      sampleRate(sr) {}
+
+void NoiseGate::process(float* samples, int numSamples) {
+    float attackCoef = std::exp(-1.0f / (attackTime * sampleRate));
+    float releaseCoef = std::exp(-1.0f / (releaseTime * sampleRate));
+
+    for (int i = 0; i < numSamples; i++) {
+        float inputLevel = std::fabs(samples[i]);
+
+        // Envelope follower
+        if (inputLevel > envelope) {
+            envelope = attackCoef * envelope + (1.0f - attackCoef) * inputLevel;
+            holdCounter = holdTime * sampleRate;
+        } else {
+            if (holdCounter > 0) {
+                holdCounter--;
+            } else {
+                envelope = releaseCoef * envelope + (1.0f - releaseCoef) * inputLevel;
+            }
+        }
+
+        // Apply gate
+        float gain = (envelope > threshold) ? 1.0f : 0.0f;
+
+        // Smooth gain transitions
+        gain = prevGain * 0.99f + gain * 0.01f;
+        prevGain = gain;
+
+        samples[i] *= gain;
+    }
+}
+
+SpectralNoiseReduction::SpectralNoiseReduction(int fs)
+    : frameSize(fs),
+      noiseFloor(0.001f) {
+    noiseProfile.resize(frameSize, 0.0f);
+    windowFunc.resize(frameSize);
+
+    // Hann window
+    for (int i = 0; i < frameSize; i++) {
+        windowFunc[i] = 0.5f * (1.0f - std::cos(2.0f * static_cast<float>(M_PI) * i / (frameSize - 1)));
+    }
+}
+
+void SpectralNoiseReduction::updateNoiseProfile(const float* samples, int numSamples) {
+    // Simple noise profile estimation
+    for (int i = 0; i < numSamples && i < frameSize; i++) {
+        float absVal = std::fabs(samples[i]);
+        noiseProfile[i] = noiseProfile[i] * 0.95f + absVal * 0.05f;
+    }
+}
+
+void SpectralNoiseReduction::process(float* samples, int numSamples, int offset) {
+    // Simple spectral subtraction approximation on the windowed signal
+    const int inFrame = std::max(0, std::min(numSamples, frameSize - offset));
+    const float* window = windowFunc.data() + offset;
+    const float* noise = noiseProfile.data() + offset;
+    int i = 0;
+    for (; i < inFrame; i++) {
+        float signal = std::fabs(samples[i] * window[i]);
+
+        if (signal > noise[i] * 2.0f) {
+            // Signal is significantly above noise
+            float gain = 1.0f - (noise[i] / signal);
+            gain = std::max(0.0f, std::min(1.0f, gain));
+            samples[i] *= gain;
+        } else {
+            // Signal is in noise floor
+            samples[i] *= 0.1f;  // Attenuate
+        }
+    }
+
+    // Past the frame the window is zero: always in the noise floor
+    for (i = inFrame; i < numSamples; i++) {
+        samples[i] *= 0.1f;
+    }
+}
+
+Denoiser::Denoiser(int sampleRate, int frameSize)
+    : frameSize_(std::max(2, frameSize > 0 ? frameSize : sampleRate / 100)), position_(0), spectral_(frameSize_),
+      gate_(sampleRate) {}
+
+void Denoiser::process(float* samples, size_t numSamples) {
+    using Clock = std::chrono::steady_clock;
+    size_t offset = 0;
+    while (offset < numSamples) {
+        const int n = static_cast<int>(std::min<size_t>(frameSize_ - position_, numSamples - offset));
+        if (timing_) {
+            const Clock::time_point start = Clock::now();
+            spectral_.process(samples + offset, n, position_);
+            const Clock::time_point mid = Clock::now();
+            gate_.process(samples + offset, n);
+            const Clock::time_point end = Clock::now();
+            spectralNs_ += std::chrono::duration_cast<std::chrono::nanoseconds>(mid - start).count();
+            gateNs_ += std::chrono::duration_cast<std::chrono::nanoseconds>(end - mid).count();
+        } else {
+            spectral_.process(samples + offset, n, position_);
+            gate_.process(samples + offset, n);
+        }
+        position_ = (position_ + n) % frameSize_;
+        offset += n;
+    }
+}
+
+} // namespace dsp
@@ -0,0 +1,84 @@
+// Noise suppression used by the microphone path (rnnoise addon) and the
+// offline batch tool
+//
+// SpectralNoiseReduction attenuates samples that do not stand out from a
+// per-position noise profile within a Hann-windowed frame; NoiseGate then
+// closes on an envelope follower (1 ms attack, 50 ms hold, 100 ms release)
+// below -40 dBFS, with the gain smoothed per sample. Both keep their state
+// per instance, so one pair per stream.
+
+#ifndef DSP_NOISE_REDUCTION_H
+#define DSP_NOISE_REDUCTION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace dsp {
+
+constexpr int kDenoiseFrameSize = 480;     // 10 ms at 48 kHz
+constexpr int kDenoiseSampleRate = 48000;
+
+class NoiseGate {
+public:
+    explicit NoiseGate(int sampleRate = kDenoiseSampleRate);
+
+    void process(float* samples, int numSamples);
+
+private:
+    float threshold;
+    float attackTime;
+    float releaseTime;
+    float holdTime;
+    float envelope;
+    float holdCounter;
+    float prevGain;
+    int sampleRate;
+};
+
+class SpectralNoiseReduction {
+public:
+    explicit SpectralNoiseReduction(int frameSize = kDenoiseFrameSize);
+
+    void updateNoiseProfile(const float* samples, int numSamples);
+    // samples start at position offset within the frame; positions past
+    // frameSize count as noise floor
+    void process(float* samples, int numSamples, int offset = 0);
+
+private:
+    std::vector<float> noiseProfile;
+    std::vector<float> windowFunc;
+    int frameSize;
+    float noiseFloor;
+};
+
+// Both stages over a stream in frames of frameSize samples (sampleRate / 100
+// if not given): the processing the addon applies to each 10 ms block it is
+// given. Frames continue across calls, so the output does not depend on how
+// the stream is split (480-sample blocks, 128-frame render quanta, ...).
+class Denoiser {
+public:
+    explicit Denoiser(int sampleRate = kDenoiseSampleRate, int frameSize = 0);
+
+    void process(float* samples, size_t numSamples);
+    int frameSize() const { return frameSize_; }
+
+    // Off by default: two clock reads per stage and frame
+    void setStageTiming(bool enabled) { timing_ = enabled; }
+    // Time spent in each stage since construction, while timing was on
+    uint64_t spectralNs() const { return spectralNs_; }
+    uint64_t gateNs() const { return gateNs_; }
+
+private:
+    int frameSize_;
+    int position_;   // within the current frame
+    bool timing_ = false;
+    uint64_t spectralNs_ = 0;
+    uint64_t gateNs_ = 0;
+    SpectralNoiseReduction spectral_;
+    NoiseGate gate_;
+};
+
+} // namespace dsp
+
+#endif
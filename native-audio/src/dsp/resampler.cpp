@@ -0,0 +1,142 @@
+#include "resampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace dsp {
+
+namespace {
+
+constexpr int kZeroCrossings = 16;
+constexpr double kKaiserBeta = 8.6;
+constexpr int kMaxPhases = 4096;
+
+double besselI0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 50; k++) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+        if (term < sum * 1e-12) break;
+    }
+    return sum;
+}
+
+} // namespace
+
+Resampler::Resampler(int inputRate, int outputRate)
+    : inputRate_(std::max(1, inputRate)), outputRate_(std::max(1, outputRate)), halfTaps_(0), phases_(1),
+      historyStart_(0), inputCount_(0), outputCount_(0) {
+    const uint64_t g = std::gcd(static_cast<uint64_t>(inputRate_), static_cast<uint64_t>(outputRate_));
+    up_ = outputRate_ / g;
+    down_ = inputRate_ / g;
+    if (passthrough()) return;
+
+    // Kernel in input samples; narrowed to the output band when downsampling
+    const double scale = std::min(1.0, static_cast<double>(up_) / down_);
+    const double halfLength = kZeroCrossings / scale;
+    halfTaps_ = static_cast<int>(std::ceil(halfLength));
+    phases_ = static_cast<int>(std::min<uint64_t>(up_, kMaxPhases));
+
+    const int taps = 2 * halfTaps_;
+    const double norm = besselI0(kKaiserBeta);
+    table_.resize(static_cast<size_t>(phases_) * taps);
+    for (int p = 0; p < phases_; p++) {
+        const double frac = static_cast<double>(p) / phases_;
+        float* row = table_.data() + static_cast<size_t>(p) * taps;
+        double sum = 0.0;
+        for (int i = 0; i < taps; i++) {
+            // Tap i weighs input sample base - halfTaps + 1 + i
+            const double t = frac - (i - halfTaps_ + 1);
+            double h = 0.0;
+            if (std::fabs(t) < halfLength) {
+                const double x = scale * t;
+                const double sinc = x == 0.0 ? 1.0 : std::sin(M_PI * x) / (M_PI * x);
+                const double r = t / halfLength;
+                h = scale * sinc * besselI0(kKaiserBeta * std::sqrt(1.0 - r * r)) / norm;
+            }
+            row[i] = static_cast<float>(h);
+            sum += h;
+        }
+        // Unity gain at DC for every phase
+        if (sum != 0.0) {
+            for (int i = 0; i < taps; i++) row[i] = static_cast<float>(row[i] / sum);
+        }
+    }
+    reset();
+}
+
+void Resampler::reset() {
+    inputCount_ = 0;
+    outputCount_ = 0;
+    history_.assign(halfTaps_ > 0 ? halfTaps_ - 1 : 0, 0.0f);
+    historyStart_ = 0 - static_cast<uint64_t>(history_.size());
+}
+
+size_t Resampler::maxOutput(size_t n) const {
+    if (passthrough()) return n;
+    return static_cast<size_t>(((inputCount_ + n) * up_ + down_ - 1) / down_ - outputCount_);
+}
+
+void Resampler::process(const float* samples, size_t n, std::vector<float>* out) {
+    if (passthrough()) {
+        out->insert(out->end(), samples, samples + n);
+        inputCount_ += n;
+        outputCount_ += n;
+        return;
+    }
+    history_.insert(history_.end(), samples, samples + n);
+    inputCount_ += n;
+    produce(UINT64_MAX, out);
+}
+
+void Resampler::flush(std::vector<float>* out) {
+    if (passthrough()) return;
+    const uint64_t total = (inputCount_ * up_ + down_ - 1) / down_;
+    history_.insert(history_.end(), halfTaps_ + 1, 0.0f);
+    produce(total, out);
+    reset();
+}
+
+void Resampler::produce(uint64_t limit, std::vector<float>* out) {
+    const int taps = 2 * halfTaps_;
+    const uint64_t end = historyStart_ + history_.size();
+    while (outputCount_ < limit) {
+        const uint64_t position = outputCount_ * down_;
+        const uint64_t base = position / up_;
+        // Needs input samples [base - halfTaps + 1, base + halfTaps]
+        if (base + halfTaps_ >= end) break;
+        const int phase = static_cast<int>((position % up_) * phases_ / up_);
+        const float* row = table_.data() + static_cast<size_t>(phase) * taps;
+        const float* x = history_.data() + (base - halfTaps_ + 1 - historyStart_);
+        // taps is even; two accumulators halve the dependency chain of adds
+        float acc0 = 0.0f;
+        float acc1 = 0.0f;
+        for (int i = 0; i < taps; i += 2) {
+            acc0 += row[i] * x[i];
+            acc1 += row[i + 1] * x[i + 1];
+        }
+        out->push_back(acc0 + acc1);
+        outputCount_++;
+    }
+
+    // Drop input no later output can reach
+    const uint64_t nextBase = outputCount_ * down_ / up_;
+    const uint64_t keepFrom = nextBase - halfTaps_ + 1;
+    if (static_cast<int64_t>(keepFrom - historyStart_) > 0) {
+        const size_t drop = std::min<size_t>(history_.size(), static_cast<size_t>(keepFrom - historyStart_));
+        history_.erase(history_.begin(), history_.begin() + drop);
+        historyStart_ += drop;
+    }
+}
+
+void resample(const float* samples, size_t n, int inputRate, int outputRate, std::vector<float>* out) {
+    Resampler resampler(inputRate, outputRate);
+    out->clear();
+    out->reserve(static_cast<size_t>(static_cast<double>(n) * outputRate / std::max(1, inputRate)) + 1);
+    resampler.process(samples, n, out);
+    resampler.flush(out);
+}
+
+} // namespace dsp
@@ -0,0 +1,60 @@
+// Streaming sample rate conversion
+//
+// Rational polyphase resampler: the rate ratio is reduced to L/M and each
+// output sample is a dot product of 2 * halfTaps input samples with one of L
+// precomputed phases of a Kaiser-windowed sinc (16 zero crossings, beta 8.6,
+// about 90 dB stopband). When downsampling the cutoff moves to the output
+// Nyquist frequency, so content above it is removed rather than aliased.
+// Ratios with more than 4096 phases use the nearest of 4096. The filter is
+// centered, so output sample k lines up with input time k * M / L with no
+// added delay; flush() supplies the trailing context.
+
+#ifndef DSP_RESAMPLER_H
+#define DSP_RESAMPLER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace dsp {
+
+class Resampler {
+public:
+    Resampler(int inputRate, int outputRate);
+
+    // Appends the output samples that became complete
+    void process(const float* samples, size_t n, std::vector<float>* out);
+    // End of stream: appends the rest, ceil(inputSamples * L / M) in total
+    void flush(std::vector<float>* out);
+    void reset();
+
+    // Upper bound on what process(n) plus flush() can still append
+    size_t maxOutput(size_t n) const;
+
+    int inputRate() const { return inputRate_; }
+    int outputRate() const { return outputRate_; }
+    bool passthrough() const { return up_ == down_; }
+
+private:
+    int inputRate_;
+    int outputRate_;
+    uint64_t up_;      // L
+    uint64_t down_;    // M
+    int halfTaps_;
+    int phases_;
+    std::vector<float> table_;     // [phase][2 * halfTaps]
+
+    std::vector<float> history_;   // input from sample historyStart_ on
+    uint64_t historyStart_;        // may be "negative": history starts with zero padding
+    uint64_t inputCount_;
+    uint64_t outputCount_;
+
+    void produce(uint64_t limit, std::vector<float>* out);
+};
+
+// Whole-buffer conversion
+void resample(const float* samples, size_t n, int inputRate, int outputRate, std::vector<float>* out);
+
+} // namespace dsp
+
+#endif
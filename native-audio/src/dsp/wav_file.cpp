@@ -0,0 +1,168 @@
+#include "wav_file.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+namespace dsp {
+
+namespace {
+
+constexpr uint16_t kFormatPcm = 1;
+constexpr uint16_t kFormatFloat = 3;
+constexpr uint16_t kFormatExtensible = 0xFFFE;
+
+uint16_t le16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+uint32_t le32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16) |
+           (static_cast<uint32_t>(p[3]) << 24);
+}
+
+void put16(std::vector<uint8_t>* out, uint16_t v) {
+    out->push_back(static_cast<uint8_t>(v));
+    out->push_back(static_cast<uint8_t>(v >> 8));
+}
+
+void put32(std::vector<uint8_t>* out, uint32_t v) {
+    put16(out, static_cast<uint16_t>(v));
+    put16(out, static_cast<uint16_t>(v >> 16));
+}
+
+bool fail(std::string* error, const std::string& message) {
+    if (error) *error = message;
+    return false;
+}
+
+float decodeSample(const uint8_t* p, uint16_t format, int bits) {
+    if (format == kFormatFloat) {
+        if (bits == 32) {
+            float f;
+            std::memcpy(&f, p, 4);
+            return f;
+        }
+        double d;
+        std::memcpy(&d, p, 8);
+        return static_cast<float>(d);
+    }
+    switch (bits) {
+        case 8: return (p[0] - 128) / 128.0f;
+        case 16: return static_cast<int16_t>(le16(p)) / 32768.0f;
+        case 24: {
+            int32_t v = p[0] | (p[1] << 8) | (p[2] << 16);
+            if (v & 0x800000) v -= 0x1000000;
+            return v / 8388608.0f;
+        }
+        default: return static_cast<int32_t>(le32(p)) / 2147483648.0f;
+    }
+}
+
+} // namespace
+
+bool readWav(const std::string& path, WavAudio* audio, std::string* error) {
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) return fail(error, "cannot open " + path);
+    std::vector<uint8_t> bytes;
+    uint8_t buffer[65536];
+    size_t n;
+    while ((n = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        bytes.insert(bytes.end(), buffer, buffer + n);
+    }
+    std::fclose(file);
+
+    if (bytes.size() < 12 || std::memcmp(bytes.data(), "RIFF", 4) != 0 ||
+        std::memcmp(bytes.data() + 8, "WAVE", 4) != 0) {
+        return fail(error, "not a RIFF/WAVE file");
+    }
+
+    uint16_t format = 0;
+    int channels = 0;
+    int bits = 0;
+    uint32_t rate = 0;
+    for (size_t pos = 12; pos + 8 <= bytes.size();) {
+        const uint32_t size = le32(bytes.data() + pos + 4);
+        const uint8_t* body = bytes.data() + pos + 8;
+        const size_t available = std::min<size_t>(size, bytes.size() - pos - 8);
+        if (std::memcmp(bytes.data() + pos, "fmt ", 4) == 0) {
+            if (available < 16) return fail(error, "truncated fmt chunk");
+            format = le16(body);
+            channels = le16(body + 2);
+            rate = le32(body + 4);
+            bits = le16(body + 14);
+            if (format == kFormatExtensible) {
+                if (available < 26) return fail(error, "truncated WAVE_FORMAT_EXTENSIBLE header");
+                format = le16(body + 24);   // first two bytes of the subformat GUID
+            }
+            const bool pcm = format == kFormatPcm && (bits == 8 || bits == 16 || bits == 24 || bits == 32);
+            const bool flt = format == kFormatFloat && (bits == 32 || bits == 64);
+            if (!pcm && !flt) {
+                return fail(error, "unsupported sample format " + std::to_string(format) + "/" +
+                                       std::to_string(bits) + " bit");
+            }
+            if (channels <= 0 || rate == 0) return fail(error, "invalid channel count or sample rate");
+        } else if (std::memcmp(bytes.data() + pos, "data", 4) == 0) {
+            if (channels == 0) return fail(error, "data chunk before fmt chunk");
+            const size_t bytesPerSample = bits / 8;
+            const size_t count = available / (bytesPerSample * channels) * channels;
+            audio->sampleRate = static_cast<int>(rate);
+            audio->channels = channels;
+            audio->samples.resize(count);
+            for (size_t i = 0; i < count; i++) {
+                audio->samples[i] = decodeSample(body + i * bytesPerSample, format, bits);
+            }
+            return true;
+        }
+        pos += 8 + static_cast<size_t>(size) + (size & 1);
+    }
+    return fail(error, "no data chunk");
+}
+
+bool writeWav(const std::string& path, const float* samples, size_t n, int sampleRate, int channels,
+              std::string* error) {
+    const uint64_t dataBytes = static_cast<uint64_t>(n) * 2;
+    if (dataBytes + 36 > UINT32_MAX) return fail(error, "too long for a WAV file");
+
+    std::vector<uint8_t> bytes;
+    bytes.reserve(44 + dataBytes);
+    bytes.insert(bytes.end(), {'R', 'I', 'F', 'F'});
+    put32(&bytes, static_cast<uint32_t>(36 + dataBytes));
+    bytes.insert(bytes.end(), {'W', 'A', 'V', 'E', 'f', 'm', 't', ' '});
+    put32(&bytes, 16);
+    put16(&bytes, kFormatPcm);
+    put16(&bytes, static_cast<uint16_t>(channels));
+    put32(&bytes, static_cast<uint32_t>(sampleRate));
+    put32(&bytes, static_cast<uint32_t>(sampleRate * channels * 2));
+    put16(&bytes, static_cast<uint16_t>(channels * 2));
+    put16(&bytes, 16);
+    bytes.insert(bytes.end(), {'d', 'a', 't', 'a'});
+    put32(&bytes, static_cast<uint32_t>(dataBytes));
+    for (size_t i = 0; i < n; i++) {
+        const float s = std::max(-1.0f, std::min(1.0f, samples[i]));
+        put16(&bytes, static_cast<uint16_t>(static_cast<int16_t>(std::lrint(s * 32767.0f))));
+    }
+
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) return fail(error, "cannot create " + path);
+    const bool ok = std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+    if (std::fclose(file) != 0 || !ok) return fail(error, "write failed: " + path);
+    return true;
+}
+
+void downmixToMono(WavAudio* audio) {
+    if (audio->channels <= 1) return;
+    const size_t frames = audio->frames();
+    const int channels = audio->channels;
+    for (size_t f = 0; f < frames; f++) {
+        float sum = 0.0f;
+        for (int c = 0; c < channels; c++) sum += audio->samples[f * channels + c];
+        audio->samples[f] = sum / channels;
+    }
+    audio->samples.resize(frames);
+    audio->channels = 1;
+}
+
+} // namespace dsp
@@ -0,0 +1,34 @@
+// WAV file reading and writing for offline processing
+//
+// Reads RIFF/WAVE with integer PCM (8, 16, 24 or 32 bit) or IEEE float (32
+// or 64 bit) samples, plain or WAVE_FORMAT_EXTENSIBLE, any channel count and
+// sample rate. Writes 16-bit PCM.
+
+#ifndef DSP_WAV_FILE_H
+#define DSP_WAV_FILE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace dsp {
+
+struct WavAudio {
+    int sampleRate = 0;
+    int channels = 0;
+    std::vector<float> samples;   // interleaved, [-1, 1]
+
+    size_t frames() const { return channels > 0 ? samples.size() / channels : 0; }
+    double seconds() const { return sampleRate > 0 ? static_cast<double>(frames()) / sampleRate : 0.0; }
+};
+
+bool readWav(const std::string& path, WavAudio* audio, std::string* error);
+bool writeWav(const std::string& path, const float* samples, size_t n, int sampleRate, int channels,
+              std::string* error);
+
+// Average of the channels, in place
+void downmixToMono(WavAudio* audio);
+
+} // namespace dsp
+
+#endif
@@ -0,0 +1,530 @@
+#include <napi.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "net/http_uploader.h"
+#include "net/upload_scheduler.h"
+
+static double GetNumberOption(const Napi::Object& options, const char* key, double fallback) {
+    if (options.Has(key) && options.Get(key).IsNumber()) {
+        return options.Get(key).As<Napi::Number>().DoubleValue();
+    }
+    return fallback;
+}
+
+static bool GetBoolOption(const Napi::Object& options, const char* key, bool fallback) {
+    if (options.Has(key) && options.Get(key).IsBoolean()) {
+        return options.Get(key).As<Napi::Boolean>().Value();
+    }
+    return fallback;
+}
+
+static Napi::Object ResultToObject(Napi::Env env, const net::UploadResult& result) {
+    Napi::Object timings = Napi::Object::New(env);
+    timings.Set("queuedMs", Napi::Number::New(env, result.timings.queuedMs));
+    timings.Set("connectMs", Napi::Number::New(env, result.timings.connectMs));
+    timings.Set("tlsMs", Napi::Number::New(env, result.timings.tlsMs));
+    timings.Set("firstByteMs", Napi::Number::New(env, result.timings.firstByteMs));
+    timings.Set("totalMs", Napi::Number::New(env, result.timings.totalMs));
+
+    Napi::Object obj = Napi::Object::New(env);
+    obj.Set("status", Napi::Number::New(env, static_cast<double>(result.status)));
+    obj.Set("body", Napi::String::New(env, result.body));
+    obj.Set("attempts", Napi::Number::New(env, result.attempts));
+    obj.Set("reused", Napi::Boolean::New(env, result.reused));
+    obj.Set("httpVersion", Napi::Number::New(env, result.httpVersion));
+    obj.Set("timings", timings);
+    return obj;
+}
+
+static Napi::Object LatencyToObject(Napi::Env env, const net::LatencySummary& summary) {
+    Napi::Object obj = Napi::Object::New(env);
+    obj.Set("count", Napi::Number::New(env, static_cast<double>(summary.count)));
+    obj.Set("p50", Napi::Number::New(env, summary.p50));
+    obj.Set("p95", Napi::Number::New(env, summary.p95));
+    obj.Set("p99", Napi::Number::New(env, summary.p99));
+    obj.Set("max", Napi::Number::New(env, summary.max));
+    return obj;
+}
+
+static Napi::Object UploaderStatsToObject(Napi::Env env, const net::UploaderStats& counters) {
+    Napi::Object stats = Napi::Object::New(env);
+    stats.Set("submitted", Napi::Number::New(env, static_cast<double>(counters.submitted)));
+    stats.Set("completed", Napi::Number::New(env, static_cast<double>(counters.completed)));
+    stats.Set("failed", Napi::Number::New(env, static_cast<double>(counters.failed)));
+    stats.Set("retries", Napi::Number::New(env, static_cast<double>(counters.retries)));
+    stats.Set("connections", Napi::Number::New(env, static_cast<double>(counters.connections)));
+    stats.Set("reused", Napi::Number::New(env, static_cast<double>(counters.reused)));
+    stats.Set("bytesSent", Napi::Number::New(env, static_cast<double>(counters.bytesSent)));
+    stats.Set("queued", Napi::Number::New(env, static_cast<double>(counters.queued)));
+    stats.Set("inFlight", Napi::Number::New(env, static_cast<double>(counters.inFlight)));
+    return stats;
+}
+
+static void ReadUploaderOptions(const Napi::Object& options, net::UploaderConfig* config) {
+    config->maxConcurrent = static_cast<int>(GetNumberOption(options, "maxConcurrent", config->maxConcurrent));
+    config->maxHostConnections =
+        static_cast<int>(GetNumberOption(options, "maxHostConnections", config->maxHostConnections));
+    config->http2 = GetBoolOption(options, "http2", config->http2);
+    config->reuseConnections = GetBoolOption(options, "reuseConnections", config->reuseConnections);
+    config->connectTimeoutMs =
+        static_cast<int>(GetNumberOption(options, "connectTimeoutMs", config->connectTimeoutMs));
+    config->timeoutMs = static_cast<int>(GetNumberOption(options, "timeoutMs", config->timeoutMs));
+    config->maxRetries = static_cast<int>(GetNumberOption(options, "maxRetries", config->maxRetries));
+    config->backoffBaseMs = static_cast<int>(GetNumberOption(options, "backoffBaseMs", config->backoffBaseMs));
+    config->backoffMaxMs = static_cast<int>(GetNumberOption(options, "backoffMaxMs", config->backoffMaxMs));
+    config->idleTimeoutMs = static_cast<int>(GetNumberOption(options, "idleTimeoutMs", config->idleTimeoutMs));
+}
+
+// A request in flight: its promise, and the JS body kept alive (and unmoved)
+// until the worker is done sending it
+struct PendingUpload {
+    Napi::Promise::Deferred deferred;
+    Napi::Reference<Napi::Value> body;
+    std::string text;
+
+    explicit PendingUpload(Napi::Env env) : deferred(Napi::Promise::Deferred::New(env)) {}
+};
+
+// Fills request from a JS { url, headers, body, timeoutMs } object. Buffers
+// and typed arrays are sent from their own memory (pinned by pending);
+// strings are copied into it. Throws and returns false on bad input.
+static bool ReadUploadRequest(Napi::Env env, const Napi::CallbackInfo& info, net::UploadRequest* request,
+                              PendingUpload* pending) {
+    if (info.Length() < 1 || !info[0].IsObject()) {
+        Napi::TypeError::New(env, "Expected request object").ThrowAsJavaScriptException();
+        return false;
+    }
+    Napi::Object options = info[0].As<Napi::Object>();
+    if (!options.Get("url").IsString()) {
+        Napi::TypeError::New(env, "request.url is required").ThrowAsJavaScriptException();
+        return false;
+    }
+
+    request->url = options.Get("url").As<Napi::String>().Utf8Value();
+    request->timeoutMs = static_cast<int>(GetNumberOption(options, "timeoutMs", 0));
+
+    if (options.Get("headers").IsObject()) {
+        Napi::Object headers = options.Get("headers").As<Napi::Object>();
+        Napi::Array names = headers.GetPropertyNames();
+        for (uint32_t i = 0; i < names.Length(); i++) {
+            Napi::Value name = names.Get(i);
+            Napi::Value value = headers.Get(name);
+            if (value.IsUndefined() || value.IsNull()) continue;
+            request->headers.push_back(name.ToString().Utf8Value() + ": " + value.ToString().Utf8Value());
+        }
+    }
+
+    Napi::Value body = options.Get("body");
+    if (body.IsTypedArray()) {
+        Napi::TypedArray array = body.As<Napi::TypedArray>();
+        request->body = static_cast<const uint8_t*>(array.ArrayBuffer().Data()) + array.ByteOffset();
+        request->bodySize = array.ByteLength();
+        pending->body = Napi::Persistent(body);
+    } else if (body.IsArrayBuffer()) {
+        Napi::ArrayBuffer buffer = body.As<Napi::ArrayBuffer>();
+        request->body = static_cast<const uint8_t*>(buffer.Data());
+        request->bodySize = buffer.ByteLength();
+        pending->body = Napi::Persistent(body);
+    } else if (body.IsString()) {
+        pending->text = body.As<Napi::String>().Utf8Value();
+        request->body = reinterpret_cast<const uint8_t*>(pending->text.data());
+        request->bodySize = pending->text.size();
+    } else if (!body.IsUndefined() && !body.IsNull()) {
+        Napi::TypeError::New(env, "request.body must be a Buffer, TypedArray, ArrayBuffer or string")
+            .ThrowAsJavaScriptException();
+        return false;
+    }
+    return true;
+}
+
+// Carries Node's socket error codes, so callers can treat it like an
+// https.request failure
+static Napi::Value UploadError(Napi::Env env, const net::UploadResult& result) {
+    Napi::Error error = Napi::Error::New(env, result.error);
+    error.Set("code", Napi::String::New(env, result.errorCode));
+    error.Set("attempts", Napi::Number::New(env, result.attempts));
+    return error.Value();
+}
+
+// Pooled HTTP client; requests run on the uploader's worker thread and
+// settle their promises through a thread-safe function
+class HttpUploaderAddon : public Napi::ObjectWrap<HttpUploaderAddon> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    HttpUploaderAddon(const Napi::CallbackInfo& info);
+    ~HttpUploaderAddon();
+
+private:
+    std::unique_ptr<net::HttpUploader> uploader_;
+    Napi::ThreadSafeFunction tsfn_;
+    std::unordered_map<uint64_t, std::unique_ptr<PendingUpload>> pending_;   // JS thread only
+    uint64_t nextId_;
+    bool closing_;
+
+    Napi::Value Post(const Napi::CallbackInfo& info);
+    Napi::Value Close(const Napi::CallbackInfo& info);
+    Napi::Value GetStats(const Napi::CallbackInfo& info);
+
+    void Settle(Napi::Env env, uint64_t id, const net::UploadResult& result);
+
+    friend class HttpUploaderCloseWorker;
+};
+
+// Cancels outstanding requests and joins the worker off the event loop
+class HttpUploaderCloseWorker : public Napi::AsyncWorker {
+public:
+    HttpUploaderCloseWorker(Napi::Env env, HttpUploaderAddon* owner)
+        : Napi::AsyncWorker(env), owner_(owner), deferred_(Napi::Promise::Deferred::New(env)) {
+        owner_->Ref();
+    }
+
+    Napi::Promise Promise() const { return deferred_.Promise(); }
+
+protected:
+    void Execute() override {
+        owner_->uploader_->close();
+    }
+
+    void OnOK() override {
+        // Cancellations queued by close() are still delivered after Release()
+        if (owner_->tsfn_) {
+            owner_->tsfn_.Release();
+            owner_->tsfn_ = Napi::ThreadSafeFunction();
+        }
+        owner_->Unref();
+        deferred_.Resolve(Env().Undefined());
+    }
+
+private:
+    HttpUploaderAddon* owner_;
+    Napi::Promise::Deferred deferred_;
+};
+
+HttpUploaderAddon::HttpUploaderAddon(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<HttpUploaderAddon>(info), nextId_(1), closing_(false) {
+    Napi::Env env = info.Env();
+
+    net::UploaderConfig config;
+    if (info.Length() > 0 && info[0].IsObject()) {
+        ReadUploaderOptions(info[0].As<Napi::Object>(), &config);
+    }
+
+    uploader_ = std::make_unique<net::HttpUploader>(config);
+    if (!uploader_->isValid()) {
+        Napi::Error::New(env, uploader_->error()).ThrowAsJavaScriptException();
+        return;
+    }
+
+    // Keeps the event loop alive only while requests are pending
+    tsfn_ = Napi::ThreadSafeFunction::New(env, Napi::Function::New(env, [](const Napi::CallbackInfo&) {}),
+                                          "HttpUploader", 0, 1);
+    tsfn_.Unref(env);
+}
+
+HttpUploaderAddon::~HttpUploaderAddon() {
+    // Pending requests hold a reference to this object, so it is only
+    // collected when none are left (or the environment is torn down)
+    if (uploader_) {
+        uploader_->close();
+    }
+    if (tsfn_) {
+        tsfn_.Release();
+    }
+}
+
+Napi::Value HttpUploaderAddon::Post(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (closing_) {
+        Napi::Error::New(env, "HttpUploader is closed").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    net::UploadRequest request;
+    std::unique_ptr<PendingUpload> pending = std::make_unique<PendingUpload>(env);
+    if (!ReadUploadRequest(env, info, &request, pending.get())) return env.Null();
+
+    const uint64_t id = nextId_++;
+    Napi::Promise promise = pending->deferred.Promise();
+    if (pending_.empty()) {
+        tsfn_.Ref(env);
+        Ref();
+    }
+    pending_.emplace(id, std::move(pending));
+
+    Napi::ThreadSafeFunction tsfn = tsfn_;
+    HttpUploaderAddon* self = this;
+    uploader_->submit(std::move(request), [tsfn, self, id](const net::UploadResult& result) {
+        net::UploadResult copy = result;
+        tsfn.BlockingCall([self, id, copy](Napi::Env env, Napi::Function) { self->Settle(env, id, copy); });
+    });
+    return promise;
+}
+
+void HttpUploaderAddon::Settle(Napi::Env env, uint64_t id, const net::UploadResult& result) {
+    auto it = pending_.find(id);
+    if (it == pending_.end()) return;
+    std::unique_ptr<PendingUpload> pending = std::move(it->second);
+    pending_.erase(it);
+
+    if (result.ok) {
+        pending->deferred.Resolve(ResultToObject(env, result));
+    } else {
+        pending->deferred.Reject(UploadError(env, result));
+    }
+
+    if (pending_.empty()) {
+        if (tsfn_) tsfn_.Unref(env);
+        Unref();
+    }
+}
+
+Napi::Value HttpUploaderAddon::Close(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (closing_) {
+        Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+        deferred.Resolve(env.Undefined());
+        return deferred.Promise();
+    }
+    closing_ = true;
+
+    HttpUploaderCloseWorker* worker = new HttpUploaderCloseWorker(env, this);
+    Napi::Promise promise = worker->Promise();
+    worker->Queue();
+    return promise;
+}
+
+Napi::Value HttpUploaderAddon::GetStats(const Napi::CallbackInfo& info) {
+    return UploaderStatsToObject(info.Env(), uploader_->stats());
+}
+
+Napi::Object HttpUploaderAddon::Init(Napi::Env env, Napi::Object exports) {
+    Napi::Function func = DefineClass(env, "HttpUploader", {
+        InstanceMethod("post", &HttpUploaderAddon::Post),
+        InstanceMethod("close", &HttpUploaderAddon::Close),
+        InstanceMethod("getStats", &HttpUploaderAddon::GetStats),
+    });
+
+    exports.Set("HttpUploader", func);
+    return exports;
+}
+
+static const char* const kPriorities[] = {"live", "backfill"};
+
+// Priority scheduler in front of a pooled uploader: live before backfill,
+// bounded in-flight requests, deferral past the latency target, shedding
+class UploadSchedulerAddon : public Napi::ObjectWrap<UploadSchedulerAddon> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    UploadSchedulerAddon(const Napi::CallbackInfo& info);
+    ~UploadSchedulerAddon();
+
+private:
+    std::unique_ptr<net::UploadScheduler> scheduler_;
+    Napi::ThreadSafeFunction tsfn_;
+    std::unordered_map<uint64_t, std::unique_ptr<PendingUpload>> pending_;   // JS thread only
+    uint64_t nextId_;
+    bool closing_;
+
+    Napi::Value Post(const Napi::CallbackInfo& info);
+    Napi::Value Close(const Napi::CallbackInfo& info);
+    Napi::Value GetStats(const Napi::CallbackInfo& info);
+
+    void Settle(Napi::Env env, uint64_t id, const net::ScheduledResult& result);
+
+    friend class UploadSchedulerCloseWorker;
+};
+
+class UploadSchedulerCloseWorker : public Napi::AsyncWorker {
+public:
+    UploadSchedulerCloseWorker(Napi::Env env, UploadSchedulerAddon* owner)
+        : Napi::AsyncWorker(env), owner_(owner), deferred_(Napi::Promise::Deferred::New(env)) {
+        owner_->Ref();
+    }
+
+    Napi::Promise Promise() const { return deferred_.Promise(); }
+
+protected:
+    void Execute() override {
+        owner_->scheduler_->close();
+    }
+
+    void OnOK() override {
+        if (owner_->tsfn_) {
+            owner_->tsfn_.Release();
+            owner_->tsfn_ = Napi::ThreadSafeFunction();
+        }
+        owner_->Unref();
+        deferred_.Resolve(Env().Undefined());
+    }
+
+private:
+    UploadSchedulerAddon* owner_;
+    Napi::Promise::Deferred deferred_;
+};
+
+UploadSchedulerAddon::UploadSchedulerAddon(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<UploadSchedulerAddon>(info), nextId_(1), closing_(false) {
+    Napi::Env env = info.Env();
+
+    net::SchedulerConfig config;
+    if (info.Length() > 0 && info[0].IsObject()) {
+        Napi::Object options = info[0].As<Napi::Object>();
+        ReadUploaderOptions(options, &config.uploader);
+        config.maxInFlight = static_cast<int>(GetNumberOption(options, "maxInFlight", config.maxInFlight));
+        config.maxQueued = static_cast<size_t>(GetNumberOption(options, "maxQueued", static_cast<double>(config.maxQueued)));
+        config.liveSloMs = static_cast<int>(GetNumberOption(options, "liveSloMs", config.liveSloMs));
+        config.backfillMaxAgeMs =
+            static_cast<int>(GetNumberOption(options, "backfillMaxAgeMs", config.backfillMaxAgeMs));
+        config.latencyWindow =
+            static_cast<size_t>(GetNumberOption(options, "latencyWindow", static_cast<double>(config.latencyWindow)));
+    }
+
+    scheduler_ = std::make_unique<net::UploadScheduler>(config);
+    if (!scheduler_->isValid()) {
+        Napi::Error::New(env, scheduler_->error()).ThrowAsJavaScriptException();
+        return;
+    }
+
+    tsfn_ = Napi::ThreadSafeFunction::New(env, Napi::Function::New(env, [](const Napi::CallbackInfo&) {}),
+                                          "UploadScheduler", 0, 1);
+    tsfn_.Unref(env);
+}
+
+UploadSchedulerAddon::~UploadSchedulerAddon() {
+    if (scheduler_) {
+        scheduler_->close();
+    }
+    if (tsfn_) {
+        tsfn_.Release();
+    }
+}
+
+Napi::Value UploadSchedulerAddon::Post(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (closing_) {
+        Napi::Error::New(env, "UploadScheduler is closed").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    net::UploadRequest request;
+    std::unique_ptr<PendingUpload> pending = std::make_unique<PendingUpload>(env);
+    if (!ReadUploadRequest(env, info, &request, pending.get())) return env.Null();
+
+    net::UploadPriority priority = net::UploadPriority::Live;
+    Napi::Value value = info[0].As<Napi::Object>().Get("priority");
+    if (value.IsString()) {
+        const std::string name = value.As<Napi::String>().Utf8Value();
+        if (name == "backfill") {
+            priority = net::UploadPriority::Backfill;
+        } else if (name != "live") {
+            Napi::TypeError::New(env, "request.priority must be \"live\" or \"backfill\"")
+                .ThrowAsJavaScriptException();
+            return env.Null();
+        }
+    }
+
+    const uint64_t id = nextId_++;
+    Napi::Promise promise = pending->deferred.Promise();
+    if (pending_.empty()) {
+        tsfn_.Ref(env);
+        Ref();
+    }
+    pending_.emplace(id, std::move(pending));
+
+    // Uploads shed inside submit() complete on this thread; they still go
+    // through the queue so the promise settles after post() returns
+    Napi::ThreadSafeFunction tsfn = tsfn_;
+    UploadSchedulerAddon* self = this;
+    scheduler_->submit(std::move(request), priority, [tsfn, self, id](const net::ScheduledResult& result) {
+        net::ScheduledResult copy = result;
+        tsfn.BlockingCall([self, id, copy](Napi::Env env, Napi::Function) { self->Settle(env, id, copy); });
+    });
+    return promise;
+}
+
+void UploadSchedulerAddon::Settle(Napi::Env env, uint64_t id, const net::ScheduledResult& result) {
+    auto it = pending_.find(id);
+    if (it == pending_.end()) return;
+    std::unique_ptr<PendingUpload> pending = std::move(it->second);
+    pending_.erase(it);
+
+    if (result.upload.ok) {
+        Napi::Object obj = ResultToObject(env, result.upload);
+        obj.Set("priority", Napi::String::New(env, kPriorities[static_cast<int>(result.priority)]));
+        obj.Set("deferred", Napi::Boolean::New(env, result.deferred));
+        obj.Set("queueWaitMs", Napi::Number::New(env, result.queueWaitMs));
+        obj.Set("totalMs", Napi::Number::New(env, result.totalMs));
+        pending->deferred.Resolve(obj);
+    } else {
+        Napi::Value error = UploadError(env, result.upload);
+        error.As<Napi::Object>().Set("shed", Napi::Boolean::New(env, result.shed));
+        pending->deferred.Reject(error);
+    }
+
+    if (pending_.empty()) {
+        if (tsfn_) tsfn_.Unref(env);
+        Unref();
+    }
+}
+
+Napi::Value UploadSchedulerAddon::Close(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (closing_) {
+        Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+        deferred.Resolve(env.Undefined());
+        return deferred.Promise();
+    }
+    closing_ = true;
+
+    UploadSchedulerCloseWorker* worker = new UploadSchedulerCloseWorker(env, this);
+    Napi::Promise promise = worker->Promise();
+    worker->Queue();
+    return promise;
+}
+
+Napi::Value UploadSchedulerAddon::GetStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    const net::SchedulerStats counters = scheduler_->stats();
+
+    Napi::Object stats = Napi::Object::New(env);
+    for (int p = 0; p < net::kUploadPriorities; p++) {
+        Napi::Object queue = Napi::Object::New(env);
+        queue.Set("submitted", Napi::Number::New(env, static_cast<double>(counters.submitted[p])));
+        queue.Set("completed", Napi::Number::New(env, static_cast<double>(counters.completed[p])));
+        queue.Set("shed", Napi::Number::New(env, static_cast<double>(counters.shed[p])));
+        queue.Set("queued", Napi::Number::New(env, static_cast<double>(counters.queued[p])));
+        queue.Set("queueWaitMs", LatencyToObject(env, counters.queueWait[p]));
+        queue.Set("endToEndMs", LatencyToObject(env, counters.endToEnd[p]));
+        stats.Set(kPriorities[p], queue);
+    }
+    const uint64_t judged = counters.sloMet + counters.sloMissed;
+    stats.Set("inFlight", Napi::Number::New(env, static_cast<double>(counters.inFlight)));
+    stats.Set("deferred", Napi::Number::New(env, static_cast<double>(counters.deferred)));
+    stats.Set("sloMet", Napi::Number::New(env, static_cast<double>(counters.sloMet)));
+    stats.Set("sloMissed", Napi::Number::New(env, static_cast<double>(counters.sloMissed)));
+    stats.Set("sloAttainment", Napi::Number::New(env, judged ? static_cast<double>(counters.sloMet) / judged : 1.0));
+    stats.Set("uploader", UploaderStatsToObject(env, counters.uploader));
+    return stats;
+}
+
+Napi::Object UploadSchedulerAddon::Init(Napi::Env env, Napi::Object exports) {
+    Napi::Function func = DefineClass(env, "UploadScheduler", {
+        InstanceMethod("post", &UploadSchedulerAddon::Post),
+        InstanceMethod("close", &UploadSchedulerAddon::Close),
+        InstanceMethod("getStats", &UploadSchedulerAddon::GetStats),
+    });
+
+    exports.Set("UploadScheduler", func);
+    return exports;
+}
+
+Napi::Object InitAll(Napi::Env env, Napi::Object exports) {
+    HttpUploaderAddon::Init(env, exports);
+    return UploadSchedulerAddon::Init(env, exports);
+}
+
+NODE_API_MODULE(http_uploader, InitAll)
@@ -0,0 +1,818 @@
+#include <napi.h>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "asr/language_id.h"
+#include "asr/mel_frontend.h"
+#include "asr/whisper_engine.h"
+#include "asr/whisper_stream.h"
+#include "quant/gemm.h"
+
+static std::string GetStringOption(const Napi::Object& options, const char* key, const std::string& fallback) {
+    if (options.Has(key) && options.Get(key).IsString()) {
+        return options.Get(key).As<Napi::String>().Utf8Value();
+    }
+    return fallback;
+}
+
+static double GetNumberOption(const Napi::Object& options, const char* key, double fallback) {
+    if (options.Has(key) && options.Get(key).IsNumber()) {
+        return options.Get(key).As<Napi::Number>().DoubleValue();
+    }
+    return fallback;
+}
+
+static bool GetBoolOption(const Napi::Object& options, const char* key, bool fallback) {
+    if (options.Has(key) && options.Get(key).IsBoolean()) {
+        return options.Get(key).As<Napi::Boolean>().Value();
+    }
+    return fallback;
+}
+
+static Napi::Object ModelInfoToObject(Napi::Env env, const asr::WhisperEngine& engine) {
+    const asr::WhisperModel& model = engine.model();
+    const asr::WhisperHParams& hp = model.hparams();
+    Napi::Object obj = Napi::Object::New(env);
+    obj.Set("type", Napi::String::New(env, model.modelType()));
+    obj.Set("multilingual", Napi::Boolean::New(env, model.multilingual()));
+    obj.Set("vocabulary", Napi::Number::New(env, hp.nVocab));
+    obj.Set("audioLayers", Napi::Number::New(env, hp.nAudioLayer));
+    obj.Set("textLayers", Napi::Number::New(env, hp.nTextLayer));
+    obj.Set("width", Napi::Number::New(env, hp.nAudioState));
+    obj.Set("mels", Napi::Number::New(env, hp.nMels));
+    obj.Set("weightBytes", Napi::Number::New(env, static_cast<double>(model.weightBytes())));
+    obj.Set("weights", Napi::String::New(env, asr::weightTypeName(model.weightType())));
+    obj.Set("kernels", Napi::String::New(env, model.weightType() == asr::WeightType::F32
+                                                  ? "f32" : quant::isaName(quant::activeIsa())));
+    obj.Set("threads", Napi::Number::New(env, engine.threads()));
+    obj.Set("mapped", Napi::Boolean::New(env, model.mapped()));
+    obj.Set("loadMs", Napi::Number::New(env, model.loadMs()));
+    if (!model.cacheError().empty()) {
+        obj.Set("cacheError", Napi::String::New(env, model.cacheError()));
+    }
+    return obj;
+}
+
+static Napi::Array SegmentsToArray(Napi::Env env, const std::vector<asr::TranscriptSegment>& segments) {
+    Napi::Array array = Napi::Array::New(env, segments.size());
+    for (size_t i = 0; i < segments.size(); i++) {
+        const asr::TranscriptSegment& segment = segments[i];
+        Napi::Object item = Napi::Object::New(env);
+        item.Set("startMs", Napi::Number::New(env, static_cast<double>(segment.startMs)));
+        item.Set("endMs", Napi::Number::New(env, static_cast<double>(segment.endMs)));
+        item.Set("text", Napi::String::New(env, segment.text));
+        array.Set(static_cast<uint32_t>(i), item);
+    }
+    return array;
+}
+
+// Float copy of 16 kHz PCM given as Float32Array, Int16Array or s16le Buffer
+static bool ReadPcm(const Napi::TypedArray& input, std::vector<float>* pcm) {
+    switch (input.TypedArrayType()) {
+        case napi_float32_array: {
+            Napi::Float32Array samples = input.As<Napi::Float32Array>();
+            pcm->insert(pcm->end(), samples.Data(), samples.Data() + samples.ElementLength());
+            return true;
+        }
+        case napi_int16_array:
+        case napi_uint8_array: {
+            const int16_t* samples = input.TypedArrayType() == napi_int16_array
+                ? input.As<Napi::Int16Array>().Data()
+                : reinterpret_cast<const int16_t*>(input.As<Napi::Uint8Array>().Data());
+            const size_t count = input.ByteLength() / sizeof(int16_t);
+            for (size_t i = 0; i < count; i++) {
+                pcm->push_back(samples[i] / 32768.0f);
+            }
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+// Whisper-compatible recognizer; loading and inference run on the libuv pool
+class LocalRecognizerAddon : public Napi::ObjectWrap<LocalRecognizerAddon> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    LocalRecognizerAddon(const Napi::CallbackInfo& info);
+
+private:
+    std::string modelPath_;
+    int threads_;
+    asr::WhisperLoadOptions loadOptions_;
+    std::shared_ptr<asr::WhisperEngine> engine_;
+    bool loading_;
+
+    Napi::Value Load(const Napi::CallbackInfo& info);
+    Napi::Value Transcribe(const Napi::CallbackInfo& info);
+    Napi::Value IsLoaded(const Napi::CallbackInfo& info);
+    Napi::Value GetModelInfo(const Napi::CallbackInfo& info);
+
+    friend class RecognizerLoadWorker;
+    friend class RecognizerStreamAddon;
+};
+
+// Reads and converts the model weights off the event loop
+class RecognizerLoadWorker : public Napi::AsyncWorker {
+public:
+    RecognizerLoadWorker(Napi::Env env, LocalRecognizerAddon* owner)
+        : Napi::AsyncWorker(env), owner_(owner), path_(owner->modelPath_), threads_(owner->threads_),
+          options_(owner->loadOptions_), deferred_(Napi::Promise::Deferred::New(env)) {
+        owner_->Ref();
+    }
+
+    Napi::Promise Promise() const { return deferred_.Promise(); }
+
+protected:
+    void Execute() override {
+        std::shared_ptr<asr::WhisperModel> model = std::make_shared<asr::WhisperModel>();
+        std::string error;
+        if (!model->load(path_, &error, options_)) {
+            SetError(error);
+            return;
+        }
+        engine_ = std::make_shared<asr::WhisperEngine>(model, threads_);
+    }
+
+    void OnOK() override {
+        owner_->engine_ = engine_;
+        owner_->loading_ = false;
+        owner_->Unref();
+        deferred_.Resolve(ModelInfoToObject(Env(), *engine_));
+    }
+
+    void OnError(const Napi::Error& error) override {
+        owner_->loading_ = false;
+        owner_->Unref();
+        deferred_.Reject(error.Value());
+    }
+
+private:
+    LocalRecognizerAddon* owner_;
+    std::string path_;
+    int threads_;
+    asr::WhisperLoadOptions options_;
+    std::shared_ptr<asr::WhisperEngine> engine_;
+    Napi::Promise::Deferred deferred_;
+};
+
+class RecognizerTranscribeWorker : public Napi::AsyncWorker {
+public:
+    RecognizerTranscribeWorker(Napi::Env env, std::shared_ptr<asr::WhisperEngine> engine,
+                               std::vector<float> pcm, const asr::TranscribeOptions& options)
+        : Napi::AsyncWorker(env), engine_(std::move(engine)), pcm_(std::move(pcm)), options_(options),
+          deferred_(Napi::Promise::Deferred::New(env)) {
+    }
+
+    Napi::Promise Promise() const { return deferred_.Promise(); }
+
+protected:
+    void Execute() override {
+        std::string error;
+        if (!engine_->transcribe(pcm_.data(), pcm_.size(), options_, &result_, &error)) {
+            SetError(error);
+        }
+    }
+
+    void OnOK() override {
+        Napi::Env env = Env();
+        Napi::Object obj = Napi::Object::New(env);
+        obj.Set("text", Napi::String::New(env, result_.text));
+        obj.Set("language", Napi::String::New(env, result_.language));
+        obj.Set("languageProbability", Napi::Number::New(env, result_.languageProbability));
+
+        obj.Set("segments", SegmentsToArray(env, result_.segments));
+
+        const asr::TranscribeTimings& timings = result_.timings;
+        const double totalMs = timings.melMs + timings.encodeMs + timings.decodeMs;
+        const double audioMs = pcm_.size() * 1000.0 / asr::kSampleRate;
+        Napi::Object t = Napi::Object::New(env);
+        t.Set("melMs", Napi::Number::New(env, timings.melMs));
+        t.Set("encodeMs", Napi::Number::New(env, timings.encodeMs));
+        t.Set("decodeMs", Napi::Number::New(env, timings.decodeMs));
+        t.Set("totalMs", Napi::Number::New(env, totalMs));
+        t.Set("audioMs", Napi::Number::New(env, audioMs));
+        t.Set("windows", Napi::Number::New(env, timings.windows));
+        t.Set("tokens", Napi::Number::New(env, timings.tokens));
+        obj.Set("timings", t);
+        obj.Set("rtf", Napi::Number::New(env, audioMs > 0 ? totalMs / audioMs : 0.0));
+
+        deferred_.Resolve(obj);
+    }
+
+    void OnError(const Napi::Error& error) override {
+        deferred_.Reject(error.Value());
+    }
+
+private:
+    std::shared_ptr<asr::WhisperEngine> engine_;
+    std::vector<float> pcm_;
+    asr::TranscribeOptions options_;
+    asr::TranscribeResult result_;
+    Napi::Promise::Deferred deferred_;
+};
+
+LocalRecognizerAddon::LocalRecognizerAddon(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<LocalRecognizerAddon>(info), threads_(0), loading_(false) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsObject()) {
+        Napi::TypeError::New(env, "Expected options object").ThrowAsJavaScriptException();
+        return;
+    }
+    Napi::Object options = info[0].As<Napi::Object>();
+
+    modelPath_ = GetStringOption(options, "modelPath", "");
+    if (modelPath_.empty()) {
+        Napi::TypeError::New(env, "options.modelPath is required").ThrowAsJavaScriptException();
+        return;
+    }
+    threads_ = static_cast<int>(GetNumberOption(options, "threads", 0));
+
+    const std::string weights = GetStringOption(options, "weights", "f32");
+    if (!asr::parseWeightType(weights, &loadOptions_.weights)) {
+        Napi::RangeError::New(env, "options.weights must be \"f32\", \"int8\" or \"int4\"")
+            .ThrowAsJavaScriptException();
+        return;
+    }
+    loadOptions_.cachePath = GetStringOption(options, "cachePath", "");
+}
+
+Napi::Value LocalRecognizerAddon::Load(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (engine_ || loading_) {
+        Napi::Error::New(env, "Model is already loaded").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    loading_ = true;
+
+    RecognizerLoadWorker* worker = new RecognizerLoadWorker(env, this);
+    Napi::Promise promise = worker->Promise();
+    worker->Queue();
+    return promise;
+}
+
+Napi::Value LocalRecognizerAddon::Transcribe(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (!engine_) {
+        Napi::Error::New(env, "Model is not loaded").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    if (info.Length() < 1 || !info[0].IsTypedArray()) {
+        Napi::TypeError::New(env, "Expected Float32Array, Int16Array or Buffer of 16 kHz mono PCM")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    asr::TranscribeOptions options;
+    if (info.Length() > 1 && info[1].IsObject()) {
+        Napi::Object opts = info[1].As<Napi::Object>();
+        options.language = GetStringOption(opts, "language", options.language);
+        options.translate = GetBoolOption(opts, "translate", options.translate);
+        options.timestamps = GetBoolOption(opts, "timestamps", options.timestamps);
+        options.maxTokens = static_cast<int>(GetNumberOption(opts, "maxTokens", 0));
+        options.audioCtx = static_cast<int>(GetNumberOption(opts, "audioCtx", 0));
+        if (GetNumberOption(opts, "sampleRate", asr::kSampleRate) != asr::kSampleRate) {
+            Napi::RangeError::New(env, "Only 16 kHz input is supported").ThrowAsJavaScriptException();
+            return env.Null();
+        }
+    }
+
+    // The worker owns a float copy; the caller's buffer may be reused at once
+    std::vector<float> pcm;
+    if (!ReadPcm(info[0].As<Napi::TypedArray>(), &pcm)) {
+        Napi::TypeError::New(env, "Unsupported TypedArray type for PCM input")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    RecognizerTranscribeWorker* worker =
+        new RecognizerTranscribeWorker(env, engine_, std::move(pcm), options);
+    Napi::Promise promise = worker->Promise();
+    worker->Queue();
+    return promise;
+}
+
+Napi::Value LocalRecognizerAddon::IsLoaded(const Napi::CallbackInfo& info) {
+    return Napi::Boolean::New(info.Env(), engine_ != nullptr);
+}
+
+Napi::Value LocalRecognizerAddon::GetModelInfo(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (!engine_) {
+        return env.Null();
+    }
+    return ModelInfoToObject(env, *engine_);
+}
+
+Napi::Object LocalRecognizerAddon::Init(Napi::Env env, Napi::Object exports) {
+    Napi::Function func = DefineClass(env, "LocalRecognizer", {
+        InstanceMethod("load", &LocalRecognizerAddon::Load),
+        InstanceMethod("transcribe", &LocalRecognizerAddon::Transcribe),
+        InstanceMethod("isLoaded", &LocalRecognizerAddon::IsLoaded),
+        InstanceMethod("getModelInfo", &LocalRecognizerAddon::GetModelInfo),
+    });
+
+    exports.Set("LocalRecognizer", func);
+    return exports;
+}
+
+static Napi::Object StreamUpdateToObject(Napi::Env env, const asr::StreamUpdate& update) {
+    Napi::Object obj = Napi::Object::New(env);
+    obj.Set("finals", SegmentsToArray(env, update.finals));
+    obj.Set("partial", Napi::String::New(env, update.partial));
+    obj.Set("partialStartMs", Napi::Number::New(env, static_cast<double>(update.partialStartMs)));
+    obj.Set("language", Napi::String::New(env, update.language));
+    obj.Set("languageProbability", Napi::Number::New(env, update.languageProbability));
+    obj.Set("audioMs", Napi::Number::New(env, static_cast<double>(update.audioMs)));
+    obj.Set("windowMs", Napi::Number::New(env, static_cast<double>(update.windowMs)));
+
+    const asr::StreamTimings& timings = update.timings;
+    Napi::Object t = Napi::Object::New(env);
+    t.Set("melMs", Napi::Number::New(env, timings.melMs));
+    t.Set("encodeMs", Napi::Number::New(env, timings.encodeMs));
+    t.Set("decodeMs", Napi::Number::New(env, timings.decodeMs));
+    t.Set("totalMs", Napi::Number::New(env, timings.melMs + timings.encodeMs + timings.decodeMs));
+    t.Set("steps", Napi::Number::New(env, timings.steps));
+    t.Set("tokens", Napi::Number::New(env, timings.tokens));
+    t.Set("draftTokens", Napi::Number::New(env, timings.draftTokens));
+    obj.Set("timings", t);
+    return obj;
+}
+
+// Streaming recognition on a loaded recognizer. push() only queues audio;
+// one worker at a time feeds the queue to the stream, so audio stays in
+// order, and updates are delivered to the callback on the JS thread.
+class RecognizerStreamAddon : public Napi::ObjectWrap<RecognizerStreamAddon> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    RecognizerStreamAddon(const Napi::CallbackInfo& info);
+
+private:
+    std::shared_ptr<asr::WhisperStream> stream_;
+    Napi::FunctionReference onUpdate_;
+    std::vector<float> pending_;
+    bool running_;
+    bool finishing_;
+    std::unique_ptr<Napi::Promise::Deferred> finishDeferred_;
+
+    Napi::Value Push(const Napi::CallbackInfo& info);
+    Napi::Value Finish(const Napi::CallbackInfo& info);
+    Napi::Value GetStats(const Napi::CallbackInfo& info);
+    void Drain(Napi::Env env);
+    void Delivered(Napi::Env env, const asr::StreamUpdate& update, bool final, const std::string& error);
+
+    friend class RecognizerStreamWorker;
+};
+
+class RecognizerStreamWorker : public Napi::AsyncWorker {
+public:
+    RecognizerStreamWorker(Napi::Env env, RecognizerStreamAddon* owner, std::vector<float> pcm, bool final)
+        : Napi::AsyncWorker(env), owner_(owner), stream_(owner->stream_), pcm_(std::move(pcm)), final_(final) {
+        owner_->Ref();
+    }
+
+protected:
+    void Execute() override {
+        std::string error;
+        bool ok = pcm_.empty() || stream_->push(pcm_.data(), pcm_.size(), &update_, &error);
+        if (ok && final_) {
+            asr::StreamUpdate last;
+            ok = stream_->finish(&last, &error);
+            // Finals of the last push come first
+            last.finals.insert(last.finals.begin(), update_.finals.begin(), update_.finals.end());
+            update_ = std::move(last);
+        }
+        if (!ok) SetError(error);
+    }
+
+    void OnOK() override {
+        owner_->Delivered(Env(), update_, final_, std::string());
+        owner_->Unref();
+    }
+
+    void OnError(const Napi::Error& error) override {
+        owner_->Delivered(Env(), update_, final_, error.Message());
+        owner_->Unref();
+    }
+
+private:
+    RecognizerStreamAddon* owner_;
+    std::shared_ptr<asr::WhisperStream> stream_;
+    std::vector<float> pcm_;
+    bool final_;
+    asr::StreamUpdate update_;
+};
+
+RecognizerStreamAddon::RecognizerStreamAddon(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<RecognizerStreamAddon>(info), running_(false), finishing_(false) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsObject()) {
+        Napi::TypeError::New(env, "Expected a LocalRecognizer").ThrowAsJavaScriptException();
+        return;
+    }
+    LocalRecognizerAddon* recognizer = Napi::ObjectWrap<LocalRecognizerAddon>::Unwrap(info[0].As<Napi::Object>());
+    if (!recognizer || !recognizer->engine_) {
+        Napi::Error::New(env, "Model is not loaded").ThrowAsJavaScriptException();
+        return;
+    }
+
+    asr::StreamOptions options;
+    if (info.Length() > 1 && info[1].IsObject()) {
+        Napi::Object opts = info[1].As<Napi::Object>();
+        options.language = GetStringOption(opts, "language", options.language);
+        options.translate = GetBoolOption(opts, "translate", options.translate);
+        options.stepMs = static_cast<int>(GetNumberOption(opts, "stepMs", options.stepMs));
+        options.maxWindowMs = static_cast<int>(GetNumberOption(opts, "maxWindowMs", options.maxWindowMs));
+        options.audioCtx = static_cast<int>(GetNumberOption(opts, "audioCtx", 0));
+    }
+    if (info.Length() > 2 && info[2].IsFunction()) {
+        onUpdate_ = Napi::Persistent(info[2].As<Napi::Function>());
+    }
+
+    stream_ = std::make_shared<asr::WhisperStream>(recognizer->engine_);
+    std::string error;
+    if (!stream_->start(options, &error)) {
+        Napi::Error::New(env, error).ThrowAsJavaScriptException();
+    }
+}
+
+void RecognizerStreamAddon::Drain(Napi::Env env) {
+    if (running_ || (pending_.empty() && !finishing_)) return;
+    running_ = true;
+    RecognizerStreamWorker* worker = new RecognizerStreamWorker(env, this, std::move(pending_), finishing_);
+    pending_.clear();
+    worker->Queue();
+}
+
+void RecognizerStreamAddon::Delivered(Napi::Env env, const asr::StreamUpdate& update, bool final,
+                                      const std::string& error) {
+    running_ = false;
+    if (final && finishDeferred_) {
+        if (error.empty()) {
+            finishDeferred_->Resolve(StreamUpdateToObject(env, update));
+        } else {
+            finishDeferred_->Reject(Napi::Error::New(env, error).Value());
+        }
+        finishDeferred_.reset();
+        finishing_ = false;
+        return;
+    }
+
+    if (!onUpdate_.IsEmpty() && !error.empty()) {
+        Napi::Object obj = Napi::Object::New(env);
+        obj.Set("error", Napi::String::New(env, error));
+        onUpdate_.Call({obj});
+    } else if (!onUpdate_.IsEmpty() && (update.decoded || !update.finals.empty())) {
+        onUpdate_.Call({StreamUpdateToObject(env, update)});
+    }
+    Drain(env);
+}
+
+Napi::Value RecognizerStreamAddon::Push(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (finishing_) {
+        Napi::Error::New(env, "Stream is finishing").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    if (info.Length() < 1 || !info[0].IsTypedArray()) {
+        Napi::TypeError::New(env, "Expected Float32Array, Int16Array or Buffer of 16 kHz mono PCM")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    if (!ReadPcm(info[0].As<Napi::TypedArray>(), &pending_)) {
+        Napi::TypeError::New(env, "Unsupported TypedArray type for PCM input")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    Drain(env);
+    return env.Undefined();
+}
+
+Napi::Value RecognizerStreamAddon::Finish(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (finishing_) {
+        Napi::Error::New(env, "Stream is already finishing").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    finishing_ = true;
+    finishDeferred_ = std::make_unique<Napi::Promise::Deferred>(Napi::Promise::Deferred::New(env));
+    Napi::Promise promise = finishDeferred_->Promise();
+    Drain(env);
+    return promise;
+}
+
+Napi::Value RecognizerStreamAddon::GetStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    // Totals are written by the worker; read them between steps only
+    asr::StreamTimings totals;
+    if (!running_) totals = stream_->totals();
+    Napi::Object stats = Napi::Object::New(env);
+    stats.Set("busy", Napi::Boolean::New(env, running_));
+    stats.Set("queuedSamples", Napi::Number::New(env, static_cast<double>(pending_.size())));
+    stats.Set("steps", Napi::Number::New(env, totals.steps));
+    stats.Set("melMs", Napi::Number::New(env, totals.melMs));
+    stats.Set("encodeMs", Napi::Number::New(env, totals.encodeMs));
+    stats.Set("decodeMs", Napi::Number::New(env, totals.decodeMs));
+    stats.Set("tokens", Napi::Number::New(env, totals.tokens));
+    stats.Set("draftTokens", Napi::Number::New(env, totals.draftTokens));
+    stats.Set("reusedFrames", Napi::Number::New(env, totals.reusedFrames));
+    return stats;
+}
+
+Napi::Object RecognizerStreamAddon::Init(Napi::Env env, Napi::Object exports) {
+    Napi::Function func = DefineClass(env, "RecognizerStream", {
+        InstanceMethod("push", &RecognizerStreamAddon::Push),
+        InstanceMethod("finish", &RecognizerStreamAddon::Finish),
+        InstanceMethod("getStats", &RecognizerStreamAddon::GetStats),
+    });
+
+    exports.Set("RecognizerStream", func);
+    return exports;
+}
+
+// Spoken language identification. The model is a small mapped file and is
+// loaded in the constructor; identify() runs on the libuv pool.
+class LanguageIdentifierAddon : public Napi::ObjectWrap<LanguageIdentifierAddon> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    LanguageIdentifierAddon(const Napi::CallbackInfo& info);
+
+private:
+    std::shared_ptr<asr::LanguageIdentifier> lid_;
+
+    Napi::Value Identify(const Napi::CallbackInfo& info);
+    Napi::Value GetModelInfo(const Napi::CallbackInfo& info);
+};
+
+class LanguageIdentifyWorker : public Napi::AsyncWorker {
+public:
+    LanguageIdentifyWorker(Napi::Env env, std::shared_ptr<asr::LanguageIdentifier> lid,
+                           std::vector<float> pcm, const asr::LanguageIdOptions& options)
+        : Napi::AsyncWorker(env), lid_(std::move(lid)), pcm_(std::move(pcm)), options_(options),
+          deferred_(Napi::Promise::Deferred::New(env)) {
+    }
+
+    Napi::Promise Promise() const { return deferred_.Promise(); }
+
+protected:
+    void Execute() override {
+        std::string error;
+        if (!lid_->identify(pcm_.data(), pcm_.size(), options_, &result_, &error)) {
+            SetError(error);
+        }
+    }
+
+    void OnOK() override {
+        Napi::Env env = Env();
+        Napi::Object obj = Napi::Object::New(env);
+        obj.Set("language", Napi::String::New(env, result_.language));
+        obj.Set("confidence", Napi::Number::New(env, result_.confidence));
+
+        Napi::Array segments = Napi::Array::New(env, result_.segments.size());
+        for (size_t i = 0; i < result_.segments.size(); i++) {
+            const asr::LanguageSegment& segment = result_.segments[i];
+            Napi::Object item = Napi::Object::New(env);
+            item.Set("startMs", Napi::Number::New(env, static_cast<double>(segment.startMs)));
+            item.Set("endMs", Napi::Number::New(env, static_cast<double>(segment.endMs)));
+            item.Set("language", Napi::String::New(env, segment.language));
+            item.Set("confidence", Napi::Number::New(env, segment.confidence));
+            item.Set("speechMs", Napi::Number::New(env, segment.speechMs));
+            segments.Set(static_cast<uint32_t>(i), item);
+        }
+        obj.Set("segments", segments);
+
+        Napi::Object t = Napi::Object::New(env);
+        t.Set("melMs", Napi::Number::New(env, result_.melMs));
+        t.Set("classifyMs", Napi::Number::New(env, result_.classifyMs));
+        t.Set("audioMs", Napi::Number::New(env, static_cast<double>(result_.audioMs)));
+        obj.Set("timings", t);
+
+        deferred_.Resolve(obj);
+    }
+
+    void OnError(const Napi::Error& error) override {
+        deferred_.Reject(error.Value());
+    }
+
+private:
+    std::shared_ptr<asr::LanguageIdentifier> lid_;
+    std::vector<float> pcm_;
+    asr::LanguageIdOptions options_;
+    asr::LanguageIdResult result_;
+    Napi::Promise::Deferred deferred_;
+};
+
+LanguageIdentifierAddon::LanguageIdentifierAddon(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<LanguageIdentifierAddon>(info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsObject()) {
+        Napi::TypeError::New(env, "Expected options object").ThrowAsJavaScriptException();
+        return;
+    }
+    const std::string modelPath = GetStringOption(info[0].As<Napi::Object>(), "modelPath", "");
+    if (modelPath.empty()) {
+        Napi::TypeError::New(env, "options.modelPath is required").ThrowAsJavaScriptException();
+        return;
+    }
+
+    auto lid = std::make_shared<asr::LanguageIdentifier>();
+    std::string error;
+    if (!lid->load(modelPath, &error)) {
+        Napi::Error::New(env, error).ThrowAsJavaScriptException();
+        return;
+    }
+    lid_ = std::move(lid);
+}
+
+Napi::Value LanguageIdentifierAddon::Identify(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsTypedArray()) {
+        Napi::TypeError::New(env, "Expected Float32Array, Int16Array or Buffer of 16 kHz mono PCM")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    asr::LanguageIdOptions options;
+    if (info.Length() > 1 && info[1].IsObject()) {
+        Napi::Object opts = info[1].As<Napi::Object>();
+        options.segmentMs = static_cast<int>(GetNumberOption(opts, "segmentMs", options.segmentMs));
+        options.minSpeechMs = static_cast<int>(GetNumberOption(opts, "minSpeechMs", options.minSpeechMs));
+    }
+
+    std::vector<float> pcm;
+    if (!ReadPcm(info[0].As<Napi::TypedArray>(), &pcm)) {
+        Napi::TypeError::New(env, "Unsupported TypedArray type for PCM input")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    LanguageIdentifyWorker* worker = new LanguageIdentifyWorker(env, lid_, std::move(pcm), options);
+    Napi::Promise promise = worker->Promise();
+    worker->Queue();
+    return promise;
+}
+
+Napi::Value LanguageIdentifierAddon::GetModelInfo(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    const std::vector<std::string>& languages = lid_->languages();
+    Napi::Array codes = Napi::Array::New(env, languages.size());
+    for (size_t i = 0; i < languages.size(); i++) {
+        codes.Set(static_cast<uint32_t>(i), Napi::String::New(env, languages[i]));
+    }
+    Napi::Object obj = Napi::Object::New(env);
+    obj.Set("languages", codes);
+    obj.Set("mels", Napi::Number::New(env, lid_->mels()));
+    obj.Set("parameters", Napi::Number::New(env, static_cast<double>(lid_->parameterCount())));
+    obj.Set("contextFrames", Napi::Number::New(env, lid_->contextFrames()));
+    return obj;
+}
+
+Napi::Object LanguageIdentifierAddon::Init(Napi::Env env, Napi::Object exports) {
+    Napi::Function func = DefineClass(env, "LanguageIdentifier", {
+        InstanceMethod("identify", &LanguageIdentifierAddon::Identify),
+        InstanceMethod("getModelInfo", &LanguageIdentifierAddon::GetModelInfo),
+    });
+
+    exports.Set("LanguageIdentifier", func);
+    return exports;
+}
+
+// Streaming log-mel features (Whisper framing); runs inline, it is cheap
+class MelFrontendAddon : public Napi::ObjectWrap<MelFrontendAddon> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    MelFrontendAddon(const Napi::CallbackInfo& info);
+
+private:
+    std::unique_ptr<asr::MelFrontend> frontend_;
+    std::vector<float> frames_;
+    double processingMs_;
+
+    Napi::Value Push(const Napi::CallbackInfo& info);
+    Napi::Value Flush(const Napi::CallbackInfo& info);
+    Napi::Value Reset(const Napi::CallbackInfo& info);
+    Napi::Value GetStats(const Napi::CallbackInfo& info);
+    Napi::Value TakeFrames(Napi::Env env);
+};
+
+MelFrontendAddon::MelFrontendAddon(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<MelFrontendAddon>(info), processingMs_(0.0) {
+    Napi::Env env = info.Env();
+
+    asr::MelConfig config;
+    if (info.Length() > 0 && info[0].IsObject()) {
+        Napi::Object options = info[0].As<Napi::Object>();
+        config.mels = static_cast<int>(GetNumberOption(options, "mels", config.mels));
+        config.center = GetBoolOption(options, "center", config.center);
+    }
+    if (config.mels != 80 && config.mels != 128) {
+        Napi::RangeError::New(env, "options.mels must be 80 or 128").ThrowAsJavaScriptException();
+        return;
+    }
+
+    frontend_ = std::make_unique<asr::MelFrontend>(std::make_shared<asr::MelKernel>(config));
+}
+
+Napi::Value MelFrontendAddon::TakeFrames(Napi::Env env) {
+    Napi::Float32Array result = Napi::Float32Array::New(env, frames_.size());
+    if (!frames_.empty()) {
+        std::memcpy(result.Data(), frames_.data(), frames_.size() * sizeof(float));
+    }
+    frames_.clear();
+    return result;
+}
+
+Napi::Value MelFrontendAddon::Push(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsTypedArray()) {
+        Napi::TypeError::New(env, "Expected Float32Array, Int16Array or Buffer of 16 kHz mono PCM")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    Napi::TypedArray input = info[0].As<Napi::TypedArray>();
+    switch (input.TypedArrayType()) {
+        case napi_float32_array: {
+            Napi::Float32Array samples = input.As<Napi::Float32Array>();
+            frontend_->push(samples.Data(), samples.ElementLength(), &frames_);
+            break;
+        }
+        case napi_int16_array: {
+            Napi::Int16Array samples = input.As<Napi::Int16Array>();
+            frontend_->push(samples.Data(), samples.ElementLength(), &frames_);
+            break;
+        }
+        case napi_uint8_array: {
+            Napi::Uint8Array bytes = input.As<Napi::Uint8Array>();
+            frontend_->push(reinterpret_cast<const int16_t*>(bytes.Data()),
+                            bytes.ByteLength() / sizeof(int16_t), &frames_);
+            break;
+        }
+        default:
+            Napi::TypeError::New(env, "Unsupported TypedArray type for PCM input")
+                .ThrowAsJavaScriptException();
+            return env.Null();
+    }
+    processingMs_ += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    return TakeFrames(env);
+}
+
+Napi::Value MelFrontendAddon::Flush(const Napi::CallbackInfo& info) {
+    frontend_->flush(&frames_);
+    return TakeFrames(info.Env());
+}
+
+Napi::Value MelFrontendAddon::Reset(const Napi::CallbackInfo& info) {
+    frontend_->reset();
+    frames_.clear();
+    processingMs_ = 0.0;
+    return info.Env().Undefined();
+}
+
+Napi::Value MelFrontendAddon::GetStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    const double audioMs = frontend_->samplesReceived() * 1000.0 / frontend_->kernel().config().sampleRate;
+    Napi::Object stats = Napi::Object::New(env);
+    stats.Set("mels", Napi::Number::New(env, frontend_->kernel().mels()));
+    stats.Set("frames", Napi::Number::New(env, static_cast<double>(frontend_->framesEmitted())));
+    stats.Set("samples", Napi::Number::New(env, static_cast<double>(frontend_->samplesReceived())));
+    stats.Set("processingMs", Napi::Number::New(env, processingMs_));
+    stats.Set("coreShare", Napi::Number::New(env, audioMs > 0 ? processingMs_ / audioMs : 0.0));
+    return stats;
+}
+
+Napi::Object MelFrontendAddon::Init(Napi::Env env, Napi::Object exports) {
+    Napi::Function func = DefineClass(env, "MelFrontend", {
+        InstanceMethod("push", &MelFrontendAddon::Push),
+        InstanceMethod("flush", &MelFrontendAddon::Flush),
+        InstanceMethod("reset", &MelFrontendAddon::Reset),
+        InstanceMethod("getStats", &MelFrontendAddon::GetStats),
+    });
+
+    exports.Set("MelFrontend", func);
+    return exports;
+}
+
+// Module initialization
+Napi::Object InitAll(Napi::Env env, Napi::Object exports) {
+    LocalRecognizerAddon::Init(env, exports);
+    RecognizerStreamAddon::Init(env, exports);
+    LanguageIdentifierAddon::Init(env, exports);
+    MelFrontendAddon::Init(env, exports);
+    return exports;
+}
+
+NODE_API_MODULE(local_asr, InitAll)
@@ -2,120 +2,18 @@
 #include <iostream>
 #include <cstring>
 #include <cmath>
-#include <vector>
 #include <memory>
 
+#include "capture/latency_histogram.h"
+#include "capture/napi_stats.h"
+#include "dsp/audio_dsp.h"
+#include "trace/trace.h"
+#include "trace/trace_napi.h"
+
 // RNNoise configuration
 #define FRAME_SIZE 480  // RNNoise processes 480 samples (10ms at 48kHz) at a time
 #define SAMPLE_RATE 48000
 
-// Simple noise gate implementation as fallback if RNNoise is not available
-class NoiseGate {
-private:
-    float threshold;
-    float attackTime;
-    float releaseTime;
-    float holdTime;
-    float envelope;
-    float holdCounter;
-    int sampleRate;
-    
-public:
-    NoiseGate(int sr = SAMPLE_RATE) 
-        : threshold(0.01f),  // -40dB
-          attackTime(0.001f),  // 1ms
-          releaseTime(0.1f),   // 100ms
-          holdTime(0.05f),     // 50ms
-          envelope(0.0f),
-          holdCounter(0.0f),
-          sampleRate(sr) {}
-    
-    void process(float* samples, int numSamples) {
-        float attackCoef = exp(-1.0f / (attackTime * sampleRate));
-        float releaseCoef = exp(-1.0f / (releaseTime * sampleRate));
-        
-        for (int i = 0; i < numSamples; i++) {
-            float inputLevel = fabs(samples[i]);
-            
-            // Envelope follower
-            if (inputLevel > envelope) {
-                envelope = attackCoef * envelope + (1.0f - attackCoef) * inputLevel;
-                holdCounter = holdTime * sampleRate;
-            } else {
-                if (holdCounter > 0) {
-                    holdCounter--;
-                } else {
-                    envelope = releaseCoef * envelope + (1.0f - releaseCoef) * inputLevel;
-                }
-            }
-            
-            // Apply gate
-            float gain = (envelope > threshold) ? 1.0f : 0.0f;
-            
-            // Smooth gain transitions
-            static float prevGain = 1.0f;
-            gain = prevGain * 0.99f + gain * 0.01f;
-            prevGain = gain;
-            
-            samples[i] *= gain;
-        }
-    }
-};
-
-// Advanced noise suppression using spectral subtraction
-class SpectralNoiseReduction {
-private:
-    std::vector<float> noiseProfile;
-    std::vector<float> windowFunc;
-    int frameSize;
-    float noiseFloor;
-    
-public:
-    SpectralNoiseReduction(int fs = FRAME_SIZE) 
-        : frameSize(fs),
-          noiseFloor(0.001f) {
-        noiseProfile.resize(frameSize, 0.0f);
-        windowFunc.resize(frameSize);
-        
-        // Hann window
-        for (int i = 0; i < frameSize; i++) {
-            windowFunc[i] = 0.5f * (1.0f - cos(2.0f * M_PI * i / (frameSize - 1)));
-        }
-    }
-    
-    void updateNoiseProfile(const float* samples, int numSamples) {
-        // Simple noise profile estimation
-        for (int i = 0; i < numSamples && i < frameSize; i++) {
-            float absVal = fabs(samples[i]);
-            noiseProfile[i] = noiseProfile[i] * 0.95f + absVal * 0.05f;
-        }
-    }
-    
-    void process(float* samples, int numSamples) {
-        // Apply windowing
-        std::vector<float> windowed(numSamples);
-        for (int i = 0; i < numSamples && i < frameSize; i++) {
-            windowed[i] = samples[i] * windowFunc[i];
-        }
-        
-        // Simple spectral subtraction approximation
-        for (int i = 0; i < numSamples; i++) {
-            float noise = (i < frameSize) ? noiseProfile[i] : noiseFloor;
-            float signal = fabs(windowed[i]);
-            
-            if (signal > noise * 2.0f) {
-                // Signal is significantly above noise
-                float gain = 1.0f - (noise / signal);
-                gain = std::max(0.0f, std::min(1.0f, gain));
-                samples[i] *= gain;
-            } else {
-                // Signal is in noise floor
-                samples[i] *= 0.1f;  // Attenuate
-            }
-        }
-    }
-};
-
 class RNNoiseProcessor : public Napi::ObjectWrap<RNNoiseProcessor> {
 public:
     static Napi::Object Init(Napi::Env env, Napi::Object exports);
@@ -123,33 +21,57 @@ public:
     ~RNNoiseProcessor();
 
 private:
-    std::unique_ptr<NoiseGate> noiseGate;
-    std::unique_ptr<SpectralNoiseReduction> spectralNR;
-    std::vector<float> buffer;
-    int bufferPos;
+    dsp_state* dsp;   // spectral noise reduction + noise gate (audio_dsp library)
     bool enabled;
     
+    // getStats(); JS thread only, like every call on this object
+    uint64_t framesIn;
+    uint64_t samplesIn;
+    uint64_t bytesOut;
+    uint64_t bypassed;            // frames passed through while disabled
+    unsigned long long lastSpectralNs;
+    unsigned long long lastGateNs;
+    capture::LatencyHistogram processTime;    // whole processFrame() call
+    capture::LatencyHistogram spectralTime;   // per call, from the DSP's stage timing
+    capture::LatencyHistogram gateTime;
+    
     Napi::Value ProcessFrame(const Napi::CallbackInfo& info);
     Napi::Value SetEnabled(const Napi::CallbackInfo& info);
     Napi::Value IsEnabled(const Napi::CallbackInfo& info);
     Napi::Value Reset(const Napi::CallbackInfo& info);
+    Napi::Value GetStats(const Napi::CallbackInfo& info);
 };
 
 RNNoiseProcessor::RNNoiseProcessor(const Napi::CallbackInfo& info) 
     : Napi::ObjectWrap<RNNoiseProcessor>(info),
-      bufferPos(0),
-      enabled(true) {
+      dsp(nullptr),
+      enabled(true),
+      framesIn(0),
+      samplesIn(0),
+      bytesOut(0),
+      bypassed(0),
+      lastSpectralNs(0),
+      lastGateNs(0) {
     
     // Initialize noise reduction components
-    noiseGate = std::make_unique<NoiseGate>(SAMPLE_RATE);
-    spectralNR = std::make_unique<SpectralNoiseReduction>(FRAME_SIZE);
-    buffer.resize(FRAME_SIZE, 0.0f);
+    dsp_config config;
+    dsp_config_init(&config);
+    config.sample_rate = SAMPLE_RATE;
+    config.frame_size = FRAME_SIZE;
+    config.stage_timing = 1;
+    dsp = dsp_create(&config);
+    if (!dsp) {
+        Napi::Error::New(info.Env(), "Failed to create the noise reduction state")
+            .ThrowAsJavaScriptException();
+        return;
+    }
     
     std::cout << "✅ RNNoise processor initialized (Frame size: " << FRAME_SIZE 
               << ", Sample rate: " << SAMPLE_RATE << "Hz)" << std::endl;
 }
 
 RNNoiseProcessor::~RNNoiseProcessor() {
+    dsp_destroy(dsp);
     std::cout << "🔴 RNNoise processor destroyed" << std::endl;
 }
 
@@ -168,8 +90,13 @@ Napi::Value RNNoiseProcessor::ProcessFrame(const Napi::CallbackInfo& info) {
         return env.Null();
     }
     
+    const int64_t start = capture::steadyNowNs();
     Napi::Float32Array inputArray = info[0].As<Napi::Float32Array>();
     uint32_t length = inputArray.ElementLength();
+    trace::Scope span("rnnoise frame", "samples", length);
+    framesIn++;
+    samplesIn += length;
+    bytesOut += length * sizeof(float);
     
     // Create output array
     Napi::Float32Array outputArray = Napi::Float32Array::New(env, length);
@@ -183,20 +110,23 @@ Napi::Value RNNoiseProcessor::ProcessFrame(const Napi::CallbackInfo& info) {
         if (inputData != nullptr && outputData != nullptr) {
             std::memcpy(outputData, inputData, length * sizeof(float));
         }
+        bypassed++;
+        processTime.record(capture::steadyNowNs() - start);
         return outputArray;
     }
     
-    // For simplicity and stability, process directly without buffering
-    // This avoids complex buffer management that could cause memory issues
-    std::vector<float> tempBuffer(length);
-    std::memcpy(tempBuffer.data(), inputData, length * sizeof(float));
+    // Apply noise reduction in place on the output copy, FRAME_SIZE at a time
+    std::memcpy(outputData, inputData, length * sizeof(float));
+    dsp_process(dsp, outputData, length);
     
-    // Apply noise reduction in place
-    spectralNR->process(tempBuffer.data(), std::min((size_t)length, (size_t)FRAME_SIZE));
-    noiseGate->process(tempBuffer.data(), length);
-    
-    // Copy result to output
-    std::memcpy(outputData, tempBuffer.data(), length * sizeof(float));
+    unsigned long long spectralNs = 0;
+    unsigned long long gateNs = 0;
+    dsp_stage_times(dsp, &spectralNs, &gateNs);
+    spectralTime.record(static_cast<int64_t>(spectralNs - lastSpectralNs));
+    gateTime.record(static_cast<int64_t>(gateNs - lastGateNs));
+    lastSpectralNs = spectralNs;
+    lastGateNs = gateNs;
+    processTime.record(capture::steadyNowNs() - start);
     
     return outputArray;
 }
@@ -221,23 +151,49 @@ Napi::Value RNNoiseProcessor::IsEnabled(const Napi::CallbackInfo& info) {
 }
 
 Napi::Value RNNoiseProcessor::Reset(const Napi::CallbackInfo& info) {
-    bufferPos = 0;
-    std::fill(buffer.begin(), buffer.end(), 0.0f);
-    
-    // Reset noise reduction components
-    noiseGate = std::make_unique<NoiseGate>(SAMPLE_RATE);
-    spectralNR = std::make_unique<SpectralNoiseReduction>(FRAME_SIZE);
+    // Reset noise reduction components (and their stage times)
+    dsp_reset(dsp);
+    lastSpectralNs = 0;
+    lastGateNs = 0;
     
     std::cout << "🔄 RNNoise processor reset" << std::endl;
     return info.Env().Undefined();
 }
 
+// { framesIn, samplesIn, bytesOut, bypassed, enabled,
+//   time: { process, spectral, gate } } with the histograms in microseconds;
+// getStats({ reset: true }) starts a new histogram interval
+Napi::Value RNNoiseProcessor::GetStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    Napi::Object stats = Napi::Object::New(env);
+    stats.Set("framesIn", Napi::Number::New(env, static_cast<double>(framesIn)));
+    stats.Set("samplesIn", Napi::Number::New(env, static_cast<double>(samplesIn)));
+    stats.Set("bytesOut", Napi::Number::New(env, static_cast<double>(bytesOut)));
+    stats.Set("bypassed", Napi::Number::New(env, static_cast<double>(bypassed)));
+    stats.Set("enabled", Napi::Boolean::New(env, enabled));
+    
+    Napi::Object time = Napi::Object::New(env);
+    time.Set("process", capture::histogramToJs(env, processTime.summary()));
+    time.Set("spectral", capture::histogramToJs(env, spectralTime.summary()));
+    time.Set("gate", capture::histogramToJs(env, gateTime.summary()));
+    stats.Set("time", time);
+    
+    if (capture::statsResetRequested(info)) {
+        processTime.reset();
+        spectralTime.reset();
+        gateTime.reset();
+    }
+    return stats;
+}
+
 Napi::Object RNNoiseProcessor::Init(Napi::Env env, Napi::Object exports) {
     Napi::Function func = DefineClass(env, "RNNoiseProcessor", {
         InstanceMethod("processFrame", &RNNoiseProcessor::ProcessFrame),
         InstanceMethod("setEnabled", &RNNoiseProcessor::SetEnabled),
         InstanceMethod("isEnabled", &RNNoiseProcessor::IsEnabled),
         InstanceMethod("reset", &RNNoiseProcessor::Reset),
+        InstanceMethod("getStats", &RNNoiseProcessor::GetStats),
     });
     
     Napi::FunctionReference* constructor = new Napi::FunctionReference();
@@ -255,7 +211,9 @@ Napi::Object RNNoiseProcessor::Init(Napi::Env env, Napi::Object exports) {
 
 // Module initialization
 Napi::Object InitAll(Napi::Env env, Napi::Object exports) {
-    return RNNoiseProcessor::Init(env, exports);
+    RNNoiseProcessor::Init(env, exports);
+    trace::initNapi(env, exports);
+    return exports;
 }
 
 NODE_API_MODULE(rnnoise, InitAll)
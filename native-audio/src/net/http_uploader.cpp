@@ -0,0 +1,412 @@
+#include "http_uploader.h"
+
+#include <curl/curl.h>
+
+#include <algorithm>
+#include <chrono>
+
+namespace net {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double msBetween(Clock::time_point from, Clock::time_point to) {
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+double usToMs(curl_off_t us) {
+    return static_cast<double>(us) / 1000.0;
+}
+
+size_t appendBody(char* data, size_t size, size_t count, void* user) {
+    static_cast<std::string*>(user)->append(data, size * count);
+    return size * count;
+}
+
+// Names the JS side already knows from Node's socket errors
+const char* errnoName(CURLcode code) {
+    switch (code) {
+        case CURLE_COULDNT_RESOLVE_HOST:
+        case CURLE_COULDNT_RESOLVE_PROXY:
+            return "ENOTFOUND";
+        case CURLE_COULDNT_CONNECT:
+            return "ECONNREFUSED";
+        case CURLE_OPERATION_TIMEDOUT:
+            return "ETIMEDOUT";
+        case CURLE_SEND_ERROR:
+        case CURLE_RECV_ERROR:
+        case CURLE_GOT_NOTHING:
+        case CURLE_PARTIAL_FILE:
+        case CURLE_HTTP2:
+        case CURLE_HTTP2_STREAM:
+            return "ECONNRESET";
+        case CURLE_SSL_CONNECT_ERROR:
+        case CURLE_PEER_FAILED_VERIFICATION:
+            return "EPROTO";
+        default:
+            return "EIO";
+    }
+}
+
+// A failed name lookup is not retried: it means the machine is offline, and
+// the caller should fall back (to local transcription) without waiting
+bool retryable(CURLcode code) {
+    switch (code) {
+        case CURLE_COULDNT_CONNECT:
+        case CURLE_OPERATION_TIMEDOUT:
+        case CURLE_SEND_ERROR:
+        case CURLE_RECV_ERROR:
+        case CURLE_GOT_NOTHING:
+        case CURLE_PARTIAL_FILE:
+        case CURLE_HTTP2:
+        case CURLE_HTTP2_STREAM:
+        case CURLE_SSL_CONNECT_ERROR:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool retryable(long status) {
+    return status == 408 || status == 429 || status >= 500;
+}
+
+void initCurl() {
+    static std::once_flag once;
+    std::call_once(once, [] { curl_global_init(CURL_GLOBAL_DEFAULT); });
+}
+
+} // namespace
+
+struct HttpUploader::Transfer {
+    UploadRequest request;
+    Callback done;
+    CURL* easy = nullptr;
+    curl_slist* headers = nullptr;
+    char errorBuffer[CURL_ERROR_SIZE] = {0};
+    UploadResult result;
+    Clock::time_point submitted;
+    Clock::time_point due;            // end of the retry backoff
+    Clock::time_point attemptStart;
+};
+
+HttpUploader::HttpUploader(const UploaderConfig& config)
+    : config_(config), multi_(nullptr), share_(nullptr), closing_(false), rng_(0),
+      submitted_(0), completed_(0), failed_(0), retries_(0), connections_(0), reused_(0),
+      bytesSent_(0), queued_(0), inFlight_(0) {
+    config_.maxConcurrent = std::max(1, config_.maxConcurrent);
+    config_.maxHostConnections = std::max(1, config_.maxHostConnections);
+    config_.maxRetries = std::max(0, config_.maxRetries);
+
+    initCurl();
+    CURLM* multi = curl_multi_init();
+    CURLSH* share = curl_share_init();
+    if (!multi || !share) {
+        if (multi) curl_multi_cleanup(multi);
+        if (share) curl_share_cleanup(share);
+        error_ = "Failed to initialize libcurl";
+        return;
+    }
+    multi_ = multi;
+    share_ = share;
+
+    // Only the worker thread touches the share, so it needs no lock callbacks
+    curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+
+    curl_multi_setopt(multi, CURLMOPT_PIPELINING, config_.http2 ? CURLPIPE_MULTIPLEX : CURLPIPE_NOTHING);
+    curl_multi_setopt(multi, CURLMOPT_MAX_HOST_CONNECTIONS, static_cast<long>(config_.maxHostConnections));
+    curl_multi_setopt(multi, CURLMOPT_MAXCONNECTS, static_cast<long>(config_.maxHostConnections * 2));
+
+    rng_ = static_cast<uint64_t>(Clock::now().time_since_epoch().count()) ^
+           reinterpret_cast<uintptr_t>(this) ^ 0x9E3779B97F4A7C15ull;
+    if (rng_ == 0) rng_ = 1;
+
+    worker_ = std::thread([this] { run(); });
+}
+
+HttpUploader::~HttpUploader() {
+    close();
+    for (void* easy : idleHandles_) curl_easy_cleanup(static_cast<CURL*>(easy));
+    idleHandles_.clear();
+    if (multi_) curl_multi_cleanup(static_cast<CURLM*>(multi_));
+    if (share_) curl_share_cleanup(static_cast<CURLSH*>(share_));
+}
+
+bool HttpUploader::submit(UploadRequest request, Callback done) {
+    if (!isValid()) return false;
+
+    Transfer* transfer = new Transfer();
+    transfer->request = std::move(request);
+    transfer->done = std::move(done);
+    transfer->submitted = Clock::now();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (closing_) {
+            delete transfer;
+            return false;
+        }
+        incoming_.push_back(transfer);
+    }
+    submitted_++;
+    queued_++;
+    curl_multi_wakeup(static_cast<CURLM*>(multi_));
+    return true;
+}
+
+void HttpUploader::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closing_ = true;
+    }
+    if (multi_) curl_multi_wakeup(static_cast<CURLM*>(multi_));
+    if (worker_.joinable()) worker_.join();
+}
+
+UploaderStats HttpUploader::stats() const {
+    UploaderStats stats;
+    stats.submitted = submitted_;
+    stats.completed = completed_;
+    stats.failed = failed_;
+    stats.retries = retries_;
+    stats.connections = connections_;
+    stats.reused = reused_;
+    stats.bytesSent = bytesSent_;
+    stats.queued = queued_;
+    stats.inFlight = inFlight_;
+    return stats;
+}
+
+void HttpUploader::run() {
+    CURLM* multi = static_cast<CURLM*>(multi_);
+
+    for (;;) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (closing_) break;
+            ready_.insert(ready_.end(), incoming_.begin(), incoming_.end());
+            incoming_.clear();
+        }
+
+        // Retries whose backoff ran out go first: they have waited longest
+        const Clock::time_point now = Clock::now();
+        std::sort(delayed_.begin(), delayed_.end(),
+                  [](const Transfer* a, const Transfer* b) { return a->due > b->due; });
+        while (!delayed_.empty() && delayed_.back()->due <= now) {
+            ready_.push_front(delayed_.back());
+            delayed_.pop_back();
+        }
+
+        while (!ready_.empty() && active_.size() < static_cast<size_t>(config_.maxConcurrent)) {
+            Transfer* transfer = ready_.front();
+            ready_.pop_front();
+            start(transfer);
+        }
+
+        int running = 0;
+        curl_multi_perform(multi, &running);
+
+        int left = 0;
+        while (CURLMsg* message = curl_multi_info_read(multi, &left)) {
+            if (message->msg != CURLMSG_DONE) continue;
+            Transfer* transfer = nullptr;
+            curl_easy_getinfo(message->easy_handle, CURLINFO_PRIVATE, &transfer);
+            finish(transfer, message->data.result);
+        }
+
+        // Sleep until a socket is ready, a backoff runs out or submit() wakes us
+        int timeoutMs = 1000;
+        if (!ready_.empty() && active_.size() < static_cast<size_t>(config_.maxConcurrent)) {
+            timeoutMs = 0;
+        } else if (!delayed_.empty()) {
+            const Transfer* next = *std::min_element(
+                delayed_.begin(), delayed_.end(), [](const Transfer* a, const Transfer* b) { return a->due < b->due; });
+            const double wait = msBetween(Clock::now(), next->due);
+            timeoutMs = std::max(0, std::min(timeoutMs, static_cast<int>(wait) + 1));
+        }
+        curl_multi_poll(multi, nullptr, 0, timeoutMs, nullptr);
+    }
+
+    // Closing: everything still pending is cancelled
+    for (Transfer* transfer : active_) {
+        curl_multi_remove_handle(multi, transfer->easy);
+        curl_easy_cleanup(transfer->easy);
+        transfer->easy = nullptr;
+        complete(transfer, true);
+    }
+    active_.clear();
+    for (Transfer* transfer : ready_) complete(transfer, true);
+    ready_.clear();
+    for (Transfer* transfer : delayed_) complete(transfer, true);
+    delayed_.clear();
+    std::deque<Transfer*> incoming;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        incoming.swap(incoming_);
+    }
+    for (Transfer* transfer : incoming) complete(transfer, true);
+    queued_ = 0;
+    inFlight_ = 0;
+}
+
+void HttpUploader::start(Transfer* transfer) {
+    CURL* easy = nullptr;
+    if (!idleHandles_.empty()) {
+        easy = static_cast<CURL*>(idleHandles_.back());
+        idleHandles_.pop_back();
+    } else {
+        easy = curl_easy_init();
+    }
+    queued_--;
+    if (!easy) {
+        transfer->result.error = "curl_easy_init failed";
+        transfer->result.errorCode = "ENOMEM";
+        complete(transfer, false);
+        return;
+    }
+    transfer->easy = easy;
+
+    // Built once per request; an empty "Expect:" stops libcurl from waiting
+    // a round trip for "100 Continue" before sending larger bodies
+    if (!transfer->headers) {
+        for (const std::string& header : transfer->request.headers) {
+            transfer->headers = curl_slist_append(transfer->headers, header.c_str());
+        }
+        transfer->headers = curl_slist_append(transfer->headers, "Expect:");
+    }
+
+    const UploadRequest& request = transfer->request;
+    static const char kEmpty[] = "";
+    curl_easy_setopt(easy, CURLOPT_URL, request.url.c_str());
+    curl_easy_setopt(easy, CURLOPT_PRIVATE, transfer);
+    curl_easy_setopt(easy, CURLOPT_SHARE, static_cast<CURLSH*>(share_));
+    curl_easy_setopt(easy, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(easy, CURLOPT_ERRORBUFFER, transfer->errorBuffer);
+    curl_easy_setopt(easy, CURLOPT_POST, 1L);
+    curl_easy_setopt(easy, CURLOPT_POSTFIELDS, request.body ? reinterpret_cast<const char*>(request.body) : kEmpty);
+    curl_easy_setopt(easy, CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(request.bodySize));
+    curl_easy_setopt(easy, CURLOPT_HTTPHEADER, transfer->headers);
+    curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, appendBody);
+    curl_easy_setopt(easy, CURLOPT_WRITEDATA, &transfer->result.body);
+    curl_easy_setopt(easy, CURLOPT_ACCEPT_ENCODING, "");
+    curl_easy_setopt(easy, CURLOPT_CONNECTTIMEOUT_MS, static_cast<long>(config_.connectTimeoutMs));
+    curl_easy_setopt(easy, CURLOPT_TIMEOUT_MS,
+                     static_cast<long>(request.timeoutMs > 0 ? request.timeoutMs : config_.timeoutMs));
+    curl_easy_setopt(easy, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(easy, CURLOPT_MAXAGE_CONN, static_cast<long>(std::max(1, config_.idleTimeoutMs / 1000)));
+    if (config_.http2) {
+        // Wait for a connection that is still negotiating rather than open
+        // another one, so requests to one host end up multiplexed
+        curl_easy_setopt(easy, CURLOPT_HTTP_VERSION, static_cast<long>(CURL_HTTP_VERSION_2TLS));
+        curl_easy_setopt(easy, CURLOPT_PIPEWAIT, 1L);
+    } else {
+        curl_easy_setopt(easy, CURLOPT_HTTP_VERSION, static_cast<long>(CURL_HTTP_VERSION_1_1));
+    }
+    if (!config_.reuseConnections) {
+        curl_easy_setopt(easy, CURLOPT_FRESH_CONNECT, 1L);
+        curl_easy_setopt(easy, CURLOPT_FORBID_REUSE, 1L);
+    }
+
+    transfer->attemptStart = Clock::now();
+    if (transfer->result.attempts == 0) {
+        transfer->result.timings.queuedMs = msBetween(transfer->submitted, transfer->attemptStart);
+    }
+    transfer->result.attempts++;
+    transfer->result.body.clear();
+    transfer->errorBuffer[0] = '\0';
+
+    curl_multi_add_handle(static_cast<CURLM*>(multi_), easy);
+    active_.push_back(transfer);
+    inFlight_++;
+}
+
+void HttpUploader::finish(Transfer* transfer, int code) {
+    const CURLcode result = static_cast<CURLcode>(code);
+    CURL* easy = transfer->easy;
+    curl_multi_remove_handle(static_cast<CURLM*>(multi_), easy);
+    active_.erase(std::find(active_.begin(), active_.end(), transfer));
+    inFlight_--;
+
+    long status = 0;
+    long connects = 0;
+    long version = 0;
+    curl_off_t connect = 0, appConnect = 0, firstByte = 0, retryAfter = 0;
+    curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &status);
+    curl_easy_getinfo(easy, CURLINFO_NUM_CONNECTS, &connects);
+    curl_easy_getinfo(easy, CURLINFO_HTTP_VERSION, &version);
+    curl_easy_getinfo(easy, CURLINFO_CONNECT_TIME_T, &connect);
+    curl_easy_getinfo(easy, CURLINFO_APPCONNECT_TIME_T, &appConnect);
+    curl_easy_getinfo(easy, CURLINFO_STARTTRANSFER_TIME_T, &firstByte);
+    curl_easy_getinfo(easy, CURLINFO_RETRY_AFTER, &retryAfter);
+
+    UploadResult& out = transfer->result;
+    out.reused = connects == 0 && result == CURLE_OK;
+    out.httpVersion = version == CURL_HTTP_VERSION_2_0 ? 2 : 1;
+    out.timings.connectMs = out.reused ? 0.0 : usToMs(connect);
+    out.timings.tlsMs = out.reused || appConnect <= connect ? 0.0 : usToMs(appConnect - connect);
+    out.timings.firstByteMs = usToMs(firstByte);
+    connections_ += static_cast<uint64_t>(std::max(0L, connects));
+    if (out.reused) reused_++;
+
+    curl_easy_reset(easy);
+    if (idleHandles_.size() < static_cast<size_t>(config_.maxConcurrent)) {
+        idleHandles_.push_back(easy);
+    } else {
+        curl_easy_cleanup(easy);
+    }
+    transfer->easy = nullptr;
+
+    const bool again = result == CURLE_OK ? retryable(status) : retryable(result);
+    if (again && out.attempts <= config_.maxRetries) {
+        retries_++;
+        queued_++;
+        transfer->due = Clock::now() + std::chrono::milliseconds(backoffMs(out.attempts, static_cast<long>(retryAfter)));
+        delayed_.push_back(transfer);
+        return;
+    }
+
+    out.ok = result == CURLE_OK;
+    out.status = status;
+    if (out.ok) {
+        bytesSent_ += transfer->request.bodySize;
+    } else {
+        out.error = transfer->errorBuffer[0] ? transfer->errorBuffer : curl_easy_strerror(result);
+        out.errorCode = errnoName(result);
+    }
+    complete(transfer, false);
+}
+
+void HttpUploader::complete(Transfer* transfer, bool cancelled) {
+    UploadResult& out = transfer->result;
+    if (cancelled) {
+        out.ok = false;
+        out.error = "Upload cancelled";
+        out.errorCode = "ECANCELED";
+    }
+    out.timings.totalMs = msBetween(transfer->submitted, Clock::now());
+    completed_++;
+    if (!out.ok) failed_++;
+
+    if (transfer->done) transfer->done(out);
+    if (transfer->headers) curl_slist_free_all(transfer->headers);
+    delete transfer;
+}
+
+// Full jitter: uniform in [0, min(max, base * 2^(attempt - 1))]. A server's
+// Retry-After is a floor, but still capped so a segment is not held for
+// minutes behind a rate limit.
+int HttpUploader::backoffMs(int attempt, long retryAfterSeconds) {
+    const int shift = std::min(attempt - 1, 20);
+    const int64_t cap = std::min<int64_t>(config_.backoffMaxMs, static_cast<int64_t>(config_.backoffBaseMs) << shift);
+    rng_ ^= rng_ << 13;
+    rng_ ^= rng_ >> 7;
+    rng_ ^= rng_ << 17;
+    int64_t delay = cap > 0 ? static_cast<int64_t>(rng_ % static_cast<uint64_t>(cap + 1)) : 0;
+    if (retryAfterSeconds > 0) {
+        delay = std::max<int64_t>(delay, std::min<int64_t>(retryAfterSeconds * 1000, config_.backoffMaxMs));
+    }
+    return static_cast<int>(delay);
+}
+
+} // namespace net
@@ -0,0 +1,150 @@
+// Keep-alive HTTP uploader for transcription requests
+//
+// One libcurl multi handle on a worker thread owns the connection pool, so
+// consecutive segments go out on an already connected (and TLS-negotiated)
+// socket instead of paying a TCP + TLS handshake per file:
+//
+//   - HTTP/2 is negotiated over TLS and requests to the same host are
+//     multiplexed on one connection; HTTP/1.1 servers get up to
+//     maxHostConnections keep-alive connections
+//   - at most maxConcurrent requests are in flight, the rest wait in FIFO order
+//   - request bodies are sent straight from the caller's memory, no copy
+//   - transport failures, 408, 429 and 5xx are retried up to maxRetries times
+//     after a full-jitter exponential backoff (honouring Retry-After)
+//   - TLS sessions are shared across connections, so a reconnect resumes
+//     the session instead of a full handshake
+//
+// Completion callbacks run on the worker thread.
+
+#ifndef NET_HTTP_UPLOADER_H
+#define NET_HTTP_UPLOADER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace net {
+
+struct UploaderConfig {
+    int maxConcurrent = 4;          // requests in flight
+    int maxHostConnections = 2;     // per host; HTTP/2 multiplexes the rest onto them
+    bool http2 = true;              // offer h2 over TLS (ALPN)
+    bool reuseConnections = true;   // false: fresh connection per request (for comparison)
+    int connectTimeoutMs = 10000;
+    int timeoutMs = 60000;          // per attempt
+    int maxRetries = 3;
+    int backoffBaseMs = 250;
+    int backoffMaxMs = 8000;
+    int idleTimeoutMs = 118000;     // close pooled connections idle for longer
+};
+
+struct UploadRequest {
+    std::string url;
+    std::vector<std::string> headers;   // "Name: value"
+    const uint8_t* body = nullptr;      // must stay valid until the callback
+    size_t bodySize = 0;
+    int timeoutMs = 0;                  // 0: config.timeoutMs
+};
+
+struct UploadTimings {
+    double queuedMs = 0.0;      // submit -> first attempt started
+    double connectMs = 0.0;     // TCP connect, 0 on a reused connection
+    double tlsMs = 0.0;         // TLS handshake, 0 on a reused connection
+    double firstByteMs = 0.0;   // attempt start -> first response byte
+    double totalMs = 0.0;       // submit -> done, retries and backoff included
+};
+
+struct UploadResult {
+    bool ok = false;            // a response arrived (any status)
+    long status = 0;
+    std::string body;
+    std::string error;          // transport error text when !ok
+    std::string errorCode;      // errno-style name when !ok: ECONNREFUSED, ETIMEDOUT, ...
+    int attempts = 0;
+    bool reused = false;        // last attempt ran on a pooled connection
+    int httpVersion = 0;        // 1 (HTTP/1.x) or 2
+    UploadTimings timings;
+};
+
+struct UploaderStats {
+    uint64_t submitted = 0;
+    uint64_t completed = 0;
+    uint64_t failed = 0;          // completed without a response
+    uint64_t retries = 0;
+    uint64_t connections = 0;     // connections opened
+    uint64_t reused = 0;          // attempts on a pooled connection
+    uint64_t bytesSent = 0;
+    size_t queued = 0;
+    size_t inFlight = 0;
+};
+
+class HttpUploader {
+public:
+    using Callback = std::function<void(const UploadResult&)>;
+
+    explicit HttpUploader(const UploaderConfig& config);
+    ~HttpUploader();
+
+    HttpUploader(const HttpUploader&) = delete;
+    HttpUploader& operator=(const HttpUploader&) = delete;
+
+    bool isValid() const { return error_.empty(); }
+    const std::string& error() const { return error_; }
+
+    // Queue a request. done is called exactly once, also for requests that
+    // are cancelled by close() (errorCode "ECANCELED"). Returns false after close().
+    bool submit(UploadRequest request, Callback done);
+
+    // Cancel queued and in-flight requests and stop the worker
+    void close();
+
+    UploaderStats stats() const;
+    const UploaderConfig& config() const { return config_; }
+
+private:
+    struct Transfer;
+
+    UploaderConfig config_;
+    std::string error_;
+    void* multi_;     // CURLM
+    void* share_;     // CURLSH
+
+    mutable std::mutex mutex_;
+    std::deque<Transfer*> incoming_;
+    bool closing_;
+    std::thread worker_;
+
+    // Worker thread only
+    std::deque<Transfer*> ready_;        // waiting for a free slot
+    std::vector<Transfer*> delayed_;     // waiting out a retry backoff
+    std::vector<Transfer*> active_;
+    std::vector<void*> idleHandles_;     // CURL easy handles for reuse
+    uint64_t rng_;
+
+    std::atomic<uint64_t> submitted_;
+    std::atomic<uint64_t> completed_;
+    std::atomic<uint64_t> failed_;
+    std::atomic<uint64_t> retries_;
+    std::atomic<uint64_t> connections_;
+    std::atomic<uint64_t> reused_;
+    std::atomic<uint64_t> bytesSent_;
+    std::atomic<size_t> queued_;
+    std::atomic<size_t> inFlight_;
+
+    void run();
+    void start(Transfer* transfer);
+    void finish(Transfer* transfer, int code);
+    void complete(Transfer* transfer, bool cancelled);
+    int backoffMs(int attempt, long retryAfterSeconds);
+};
+
+} // namespace net
+
+#endif
@@ -0,0 +1,230 @@
+#include "upload_scheduler.h"
+
+#include <string>
+#include <utility>
+
+namespace net {
+
+namespace {
+
+double msBetween(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+} // namespace
+
+void LatencyWindow::add(double value) {
+    if (values_.size() < capacity_) {
+        values_.push_back(value);
+    } else {
+        values_[next_] = value;
+    }
+    next_ = (next_ + 1) % capacity_;
+}
+
+LatencySummary LatencyWindow::summary() const {
+    LatencySummary summary;
+    summary.count = values_.size();
+    if (values_.empty()) return summary;
+
+    std::vector<double> sorted = values_;
+    std::sort(sorted.begin(), sorted.end());
+    auto at = [&](double q) { return sorted[std::min(sorted.size() - 1, static_cast<size_t>(q * sorted.size()))]; };
+    summary.p50 = at(0.50);
+    summary.p95 = at(0.95);
+    summary.p99 = at(0.99);
+    summary.max = sorted.back();
+    return summary;
+}
+
+UploadScheduler::UploadScheduler(const SchedulerConfig& config)
+    : config_(config), inFlight_(0), closing_(false), deferred_(0), sloMet_(0), sloMissed_(0) {
+    config_.maxInFlight = std::max(1, config_.maxInFlight);
+    config_.uploader.maxConcurrent = config_.maxInFlight;
+    uploader_ = std::make_unique<HttpUploader>(config_.uploader);
+
+    for (int p = 0; p < kUploadPriorities; p++) {
+        submitted_[p] = 0;
+        completed_[p] = 0;
+        shed_[p] = 0;
+        queueWait_[p] = LatencyWindow(config_.latencyWindow);
+        endToEnd_[p] = LatencyWindow(config_.latencyWindow);
+    }
+}
+
+UploadScheduler::~UploadScheduler() {
+    close();
+}
+
+bool UploadScheduler::submit(UploadRequest request, UploadPriority priority, Callback done) {
+    if (!isValid()) return false;
+
+    Job* job = new Job();
+    job->request = std::move(request);
+    job->priority = priority;
+    job->done = std::move(done);
+    job->submitted = Clock::now();
+
+    std::vector<Job*> start;
+    std::vector<Job*> shed;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (closing_) {
+            delete job;
+            return false;
+        }
+        submitted_[static_cast<int>(priority)]++;
+        (priority == UploadPriority::Live ? live_ : backfill_).push_back(job);
+        schedule(job->submitted, &start, &shed);
+    }
+    drop(shed, "ESHED", "Shed from the upload queue");
+    launch(start);
+    return true;
+}
+
+void UploadScheduler::close() {
+    std::vector<Job*> waiting;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (closing_) return;
+        closing_ = true;
+        waiting.insert(waiting.end(), live_.begin(), live_.end());
+        waiting.insert(waiting.end(), backfill_.begin(), backfill_.end());
+        live_.clear();
+        backfill_.clear();
+    }
+    drop(waiting, "ECANCELED", "Upload cancelled");
+    // In-flight uploads complete through finish() with ECANCELED
+    uploader_->close();
+}
+
+SchedulerStats UploadScheduler::stats() const {
+    SchedulerStats stats;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (int p = 0; p < kUploadPriorities; p++) {
+            stats.submitted[p] = submitted_[p];
+            stats.completed[p] = completed_[p];
+            stats.shed[p] = shed_[p];
+            stats.queueWait[p] = queueWait_[p].summary();
+            stats.endToEnd[p] = endToEnd_[p].summary();
+        }
+        stats.queued[0] = live_.size();
+        stats.queued[1] = backfill_.size();
+        stats.inFlight = inFlight_;
+        stats.deferred = deferred_;
+        stats.sloMet = sloMet_;
+        stats.sloMissed = sloMissed_;
+    }
+    stats.uploader = uploader_->stats();
+    return stats;
+}
+
+void UploadScheduler::schedule(Clock::time_point now, std::vector<Job*>* start, std::vector<Job*>* shed) {
+    // Live uploads past their target go behind the backfill that is older
+    // than them, so fresh live audio is not held up by stale audio
+    while (!live_.empty() && msBetween(live_.front()->submitted, now) > config_.liveSloMs) {
+        Job* job = live_.front();
+        live_.pop_front();
+        job->deferred = true;
+        deferred_++;
+        auto at = std::upper_bound(backfill_.begin(), backfill_.end(), job,
+                                   [](const Job* a, const Job* b) { return a->submitted < b->submitted; });
+        backfill_.insert(at, job);
+    }
+
+    if (config_.backfillMaxAgeMs > 0) {
+        while (!backfill_.empty() && msBetween(backfill_.front()->submitted, now) > config_.backfillMaxAgeMs) {
+            shedJob(backfill_.front(), shed);
+            backfill_.pop_front();
+        }
+    }
+
+    while (live_.size() + backfill_.size() > config_.maxQueued) {
+        std::deque<Job*>& queue = backfill_.empty() ? live_ : backfill_;
+        shedJob(queue.front(), shed);
+        queue.pop_front();
+    }
+
+    while (inFlight_ < static_cast<size_t>(config_.maxInFlight) && (!live_.empty() || !backfill_.empty())) {
+        std::deque<Job*>& queue = live_.empty() ? backfill_ : live_;
+        Job* job = queue.front();
+        queue.pop_front();
+        job->started = now;
+        queueWait_[static_cast<int>(job->priority)].add(msBetween(job->submitted, now));
+        inFlight_++;
+        start->push_back(job);
+    }
+}
+
+void UploadScheduler::shedJob(Job* job, std::vector<Job*>* shed) {
+    shed_[static_cast<int>(job->priority)]++;
+    if (job->priority == UploadPriority::Live) sloMissed_++;
+    shed->push_back(job);
+}
+
+void UploadScheduler::launch(const std::vector<Job*>& start) {
+    for (Job* job : start) {
+        const bool queued = uploader_->submit(job->request, [this, job](const UploadResult& result) {
+            finish(job, result);
+        });
+        if (!queued) {
+            UploadResult result;
+            result.error = "Upload cancelled";
+            result.errorCode = "ECANCELED";
+            finish(job, result);
+        }
+    }
+}
+
+void UploadScheduler::finish(Job* job, const UploadResult& result) {
+    const Clock::time_point now = Clock::now();
+    ScheduledResult out;
+    out.upload = result;
+    out.priority = job->priority;
+    out.deferred = job->deferred;
+    out.queueWaitMs = msBetween(job->submitted, job->started);
+    out.totalMs = msBetween(job->submitted, now);
+
+    std::vector<Job*> start;
+    std::vector<Job*> shed;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        inFlight_--;
+        const int p = static_cast<int>(job->priority);
+        completed_[p]++;
+        endToEnd_[p].add(out.totalMs);
+        if (job->priority == UploadPriority::Live) {
+            if (result.ok && out.totalMs <= config_.liveSloMs) {
+                sloMet_++;
+            } else {
+                sloMissed_++;
+            }
+        }
+        if (!closing_) schedule(now, &start, &shed);
+    }
+
+    if (job->done) job->done(out);
+    delete job;
+
+    drop(shed, "ESHED", "Shed from the upload queue");
+    launch(start);
+}
+
+void UploadScheduler::drop(const std::vector<Job*>& jobs, const char* code, const char* message) {
+    const Clock::time_point now = Clock::now();
+    for (Job* job : jobs) {
+        ScheduledResult out;
+        out.upload.error = message;
+        out.upload.errorCode = code;
+        out.priority = job->priority;
+        out.deferred = job->deferred;
+        out.shed = std::string(code) == "ESHED";
+        out.queueWaitMs = msBetween(job->submitted, now);
+        out.totalMs = out.queueWaitMs;
+        if (job->done) job->done(out);
+        delete job;
+    }
+}
+
+} // namespace net
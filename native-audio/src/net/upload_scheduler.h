@@ -0,0 +1,156 @@
+// Priority upload scheduler on top of HttpUploader
+//
+// Decides which upload goes out next when the network cannot keep up:
+//
+//   - two classes: live segments (just captured, someone is waiting for the
+//     transcript) always go before backfill (recovered or deferred work)
+//   - at most maxInFlight uploads are handed to the uploader (retry backoff
+//     included); the rest wait here, not in sockets or temp files
+//   - a live upload still queued after liveSloMs has already missed its
+//     latency target: it is deferred to the backfill queue so fresh live
+//     audio overtakes it
+//   - more than maxQueued waiting uploads, or backfill older than
+//     backfillMaxAgeMs, are shed (oldest backfill first) and complete with
+//     errorCode "ESHED" so the caller can fall back
+//
+// Queue wait and end-to-end latency are kept per class over a window of
+// recent uploads for percentiles. Callbacks run on the uploader's worker
+// thread, or on the caller's thread for uploads shed in submit().
+
+#ifndef NET_UPLOAD_SCHEDULER_H
+#define NET_UPLOAD_SCHEDULER_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "http_uploader.h"
+
+namespace net {
+
+enum class UploadPriority { Live = 0, Backfill = 1 };
+constexpr int kUploadPriorities = 2;
+
+struct SchedulerConfig {
+    UploaderConfig uploader;        // maxConcurrent is replaced by maxInFlight
+    int maxInFlight = 4;
+    size_t maxQueued = 64;          // waiting uploads beyond this are shed
+    int liveSloMs = 5000;           // end-to-end target for live uploads
+    int backfillMaxAgeMs = 0;       // 0: backfill is never shed for age
+    size_t latencyWindow = 512;     // recent uploads per class kept for percentiles
+};
+
+struct ScheduledResult {
+    UploadResult upload;
+    UploadPriority priority = UploadPriority::Live;   // as submitted
+    bool deferred = false;          // a live upload moved to backfill
+    bool shed = false;
+    double queueWaitMs = 0.0;       // submit -> handed to the uploader
+    double totalMs = 0.0;           // submit -> done
+};
+
+struct LatencySummary {
+    size_t count = 0;
+    double p50 = 0.0;
+    double p95 = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+};
+
+// Most recent N samples
+class LatencyWindow {
+public:
+    explicit LatencyWindow(size_t capacity = 512) : capacity_(std::max<size_t>(1, capacity)), next_(0) {}
+
+    void add(double value);
+    LatencySummary summary() const;
+
+private:
+    size_t capacity_;
+    size_t next_;
+    std::vector<double> values_;
+};
+
+struct SchedulerStats {
+    uint64_t submitted[kUploadPriorities] = {0, 0};
+    uint64_t completed[kUploadPriorities] = {0, 0};
+    uint64_t shed[kUploadPriorities] = {0, 0};
+    uint64_t deferred = 0;
+    uint64_t sloMet = 0;            // live uploads answered within liveSloMs
+    uint64_t sloMissed = 0;
+    size_t queued[kUploadPriorities] = {0, 0};
+    size_t inFlight = 0;
+    LatencySummary queueWait[kUploadPriorities];
+    LatencySummary endToEnd[kUploadPriorities];
+    UploaderStats uploader;
+};
+
+class UploadScheduler {
+public:
+    using Callback = std::function<void(const ScheduledResult&)>;
+
+    explicit UploadScheduler(const SchedulerConfig& config);
+    ~UploadScheduler();
+
+    UploadScheduler(const UploadScheduler&) = delete;
+    UploadScheduler& operator=(const UploadScheduler&) = delete;
+
+    bool isValid() const { return uploader_->isValid(); }
+    const std::string& error() const { return uploader_->error(); }
+
+    // Queue an upload; done is called exactly once. Returns false after close().
+    bool submit(UploadRequest request, UploadPriority priority, Callback done);
+
+    // Cancel waiting and in-flight uploads (errorCode "ECANCELED")
+    void close();
+
+    SchedulerStats stats() const;
+    const SchedulerConfig& config() const { return config_; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Job {
+        UploadRequest request;
+        UploadPriority priority;
+        Callback done;
+        Clock::time_point submitted;
+        Clock::time_point started;
+        bool deferred = false;
+    };
+
+    SchedulerConfig config_;
+    std::unique_ptr<HttpUploader> uploader_;
+
+    mutable std::mutex mutex_;
+    std::deque<Job*> live_;         // FIFO
+    std::deque<Job*> backfill_;     // ordered by submit time
+    size_t inFlight_;
+    bool closing_;
+
+    uint64_t submitted_[kUploadPriorities];
+    uint64_t completed_[kUploadPriorities];
+    uint64_t shed_[kUploadPriorities];
+    uint64_t deferred_;
+    uint64_t sloMet_;
+    uint64_t sloMissed_;
+    LatencyWindow queueWait_[kUploadPriorities];
+    LatencyWindow endToEnd_[kUploadPriorities];
+
+    // With mutex_ held: apply deferral, shedding and the in-flight cap
+    void schedule(Clock::time_point now, std::vector<Job*>* start, std::vector<Job*>* shed);
+    void shedJob(Job* job, std::vector<Job*>* shed);
+    void launch(const std::vector<Job*>& start);
+    void finish(Job* job, const UploadResult& result);
+    void drop(const std::vector<Job*>& jobs, const char* code, const char* message);
+};
+
+} // namespace net
+
+#endif
@@ -0,0 +1,160 @@
+#include <napi.h>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "codec/ogg_opus_encoder.h"
+
+// N-API wrapper around codec::OggOpusEncoder
+class OpusEncoderAddon : public Napi::ObjectWrap<OpusEncoderAddon> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    OpusEncoderAddon(const Napi::CallbackInfo& info);
+
+private:
+    std::unique_ptr<codec::OggOpusEncoder> encoder_;
+    std::vector<uint8_t> output_;
+
+    Napi::Value Encode(const Napi::CallbackInfo& info);
+    Napi::Value Flush(const Napi::CallbackInfo& info);
+    Napi::Value Finish(const Napi::CallbackInfo& info);
+    Napi::Value Reset(const Napi::CallbackInfo& info);
+    Napi::Value GetStats(const Napi::CallbackInfo& info);
+
+    Napi::Value TakeOutput(Napi::Env env);
+};
+
+static int GetIntOption(const Napi::Object& options, const char* key, int fallback) {
+    if (options.Has(key) && options.Get(key).IsNumber()) {
+        return options.Get(key).As<Napi::Number>().Int32Value();
+    }
+    return fallback;
+}
+
+OpusEncoderAddon::OpusEncoderAddon(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<OpusEncoderAddon>(info) {
+    Napi::Env env = info.Env();
+
+    codec::OggOpusConfig config;
+    if (info.Length() > 0 && info[0].IsObject()) {
+        Napi::Object options = info[0].As<Napi::Object>();
+        config.sampleRate = GetIntOption(options, "sampleRate", config.sampleRate);
+        config.channels = GetIntOption(options, "channels", config.channels);
+        config.bitrate = GetIntOption(options, "bitrate", config.bitrate);
+        config.complexity = GetIntOption(options, "complexity", config.complexity);
+        config.pageDurationMs = GetIntOption(options, "pageDurationMs", config.pageDurationMs);
+        if (options.Has("frameDurationMs") && options.Get("frameDurationMs").IsNumber()) {
+            config.frameDurationMs = options.Get("frameDurationMs").As<Napi::Number>().FloatValue();
+        }
+        if (options.Has("application") && options.Get("application").IsString()) {
+            config.voip = options.Get("application").As<Napi::String>().Utf8Value() != "audio";
+        }
+    }
+
+    encoder_ = std::make_unique<codec::OggOpusEncoder>(config);
+    if (!encoder_->isValid()) {
+        Napi::Error::New(env, encoder_->error()).ThrowAsJavaScriptException();
+        return;
+    }
+
+    std::cout << "✅ Opus encoder initialized (" << config.sampleRate << "Hz, "
+              << config.bitrate / 1000 << "kbps, " << config.frameDurationMs
+              << "ms frames)" << std::endl;
+}
+
+Napi::Value OpusEncoderAddon::TakeOutput(Napi::Env env) {
+    Napi::Buffer<uint8_t> buffer = Napi::Buffer<uint8_t>::Copy(env, output_.data(), output_.size());
+    output_.clear();
+    return buffer;
+}
+
+Napi::Value OpusEncoderAddon::Encode(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsTypedArray()) {
+        Napi::TypeError::New(env, "Expected Float32Array, Int16Array or Buffer of int16 PCM")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    Napi::TypedArray input = info[0].As<Napi::TypedArray>();
+    switch (input.TypedArrayType()) {
+        case napi_float32_array: {
+            Napi::Float32Array samples = input.As<Napi::Float32Array>();
+            encoder_->encode(samples.Data(), samples.ElementLength(), output_);
+            break;
+        }
+        case napi_int16_array: {
+            Napi::Int16Array samples = input.As<Napi::Int16Array>();
+            encoder_->encode(samples.Data(), samples.ElementLength(), output_);
+            break;
+        }
+        case napi_uint8_array: {
+            // Node Buffer holding s16le PCM, as produced by main.js
+            Napi::Uint8Array bytes = input.As<Napi::Uint8Array>();
+            encoder_->encode(reinterpret_cast<const int16_t*>(bytes.Data()),
+                             bytes.ByteLength() / sizeof(int16_t), output_);
+            break;
+        }
+        default:
+            Napi::TypeError::New(env, "Unsupported TypedArray type for PCM input")
+                .ThrowAsJavaScriptException();
+            return env.Null();
+    }
+
+    return TakeOutput(env);
+}
+
+Napi::Value OpusEncoderAddon::Flush(const Napi::CallbackInfo& info) {
+    encoder_->flush(output_);
+    return TakeOutput(info.Env());
+}
+
+Napi::Value OpusEncoderAddon::Finish(const Napi::CallbackInfo& info) {
+    encoder_->finish(output_);
+    return TakeOutput(info.Env());
+}
+
+Napi::Value OpusEncoderAddon::Reset(const Napi::CallbackInfo& info) {
+    encoder_->reset();
+    output_.clear();
+    return info.Env().Undefined();
+}
+
+Napi::Value OpusEncoderAddon::GetStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    const codec::OggOpusConfig& config = encoder_->config();
+    const double seconds = static_cast<double>(encoder_->samplesIn()) / config.sampleRate;
+
+    Napi::Object stats = Napi::Object::New(env);
+    stats.Set("samplesIn", Napi::Number::New(env, static_cast<double>(encoder_->samplesIn())));
+    stats.Set("bytesOut", Napi::Number::New(env, static_cast<double>(encoder_->bytesOut())));
+    stats.Set("packetsOut", Napi::Number::New(env, static_cast<double>(encoder_->packetsOut())));
+    stats.Set("frameSize", Napi::Number::New(env, encoder_->frameSize()));
+    stats.Set("averageBitrate", Napi::Number::New(env,
+        seconds > 0 ? encoder_->bytesOut() * 8.0 / seconds : 0.0));
+    return stats;
+}
+
+Napi::Object OpusEncoderAddon::Init(Napi::Env env, Napi::Object exports) {
+    Napi::Function func = DefineClass(env, "OpusEncoder", {
+        InstanceMethod("encode", &OpusEncoderAddon::Encode),
+        InstanceMethod("flush", &OpusEncoderAddon::Flush),
+        InstanceMethod("finish", &OpusEncoderAddon::Finish),
+        InstanceMethod("reset", &OpusEncoderAddon::Reset),
+        InstanceMethod("getStats", &OpusEncoderAddon::GetStats),
+    });
+
+    Napi::FunctionReference* constructor = new Napi::FunctionReference();
+    *constructor = Napi::Persistent(func);
+    env.SetInstanceData(constructor);
+
+    exports.Set("OpusEncoder", func);
+    return exports;
+}
+
+Napi::Object InitAll(Napi::Env env, Napi::Object exports) {
+    return OpusEncoderAddon::Init(env, exports);
+}
+
+NODE_API_MODULE(opus_encoder, InitAll)
@@ -0,0 +1,217 @@
+#include "gemm.h"
+#include "kernels.h"
+
+#include <atomic>
+#include <vector>
+
+#if defined(QUANT_X86)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace quant {
+
+namespace {
+
+template <bool Int4>
+void scalarKernel(const KernelArgs& args) {
+    int8_t w[kBlock];
+    for (size_t o = args.o0; o < args.o1; o++) {
+        const uint8_t* wRow = args.w + o * args.wRowBytes;
+        const float* wScales = args.wScales + o * args.groupsPerRow;
+        const float bias = args.bias ? args.bias[o] : 0.0f;
+
+        for (size_t r = 0; r < args.rows; r++) {
+            const int8_t* a = args.a + r * args.blocks * kBlock;
+            const float* aScales = args.aScales + r * args.blocks;
+            float sum = 0.0f;
+            for (size_t b = 0; b < args.blocks; b++) {
+                if (Int4) {
+                    const uint8_t* packed = wRow + b * 16;
+                    for (size_t j = 0; j < 16; j++) {
+                        w[j] = static_cast<int8_t>((packed[j] & 0x0F) - 8);
+                        w[j + 16] = static_cast<int8_t>((packed[j] >> 4) - 8);
+                    }
+                } else {
+                    for (size_t j = 0; j < kBlock; j++) w[j] = static_cast<int8_t>(wRow[b * kBlock + j]);
+                }
+                int32_t dot = 0;
+                for (size_t j = 0; j < kBlock; j++) dot += a[b * kBlock + j] * w[j];
+                sum += static_cast<float>(dot) * aScales[b] * wScales[b / args.blocksPerGroup];
+            }
+            args.y[r * args.ldy + o] = sum + bias;
+        }
+    }
+}
+
+#if defined(QUANT_X86)
+void cpuid(int leaf, int subleaf, unsigned regs[4]) {
+#if defined(_MSC_VER)
+    int out[4];
+    __cpuidex(out, leaf, subleaf);
+    for (int i = 0; i < 4; i++) regs[i] = static_cast<unsigned>(out[i]);
+#else
+    __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+unsigned long long xgetbv0() {
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    unsigned lo, hi;
+    __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    return (static_cast<unsigned long long>(hi) << 32) | lo;
+#endif
+}
+#endif
+
+bool supported(Isa isa) {
+    if (isa == Isa::Scalar) return true;
+#if defined(QUANT_X86)
+    unsigned r[4];
+    cpuid(0, 0, r);
+    const unsigned maxLeaf = r[0];
+    if (maxLeaf < 7) return false;
+
+    cpuid(1, 0, r);
+    const bool osxsave = (r[2] >> 27) & 1;
+    const bool fma = (r[2] >> 12) & 1;
+    if (!osxsave) return false;
+    const unsigned long long xcr0 = xgetbv0();
+    const bool ymm = (xcr0 & 0x6) == 0x6;
+    const bool zmm = (xcr0 & 0xE6) == 0xE6;
+
+    cpuid(7, 0, r);
+    const bool avx2 = (r[1] >> 5) & 1;
+    const bool avx512 = ((r[1] >> 16) & 1) && ((r[1] >> 17) & 1) &&   // F, DQ
+                        ((r[1] >> 30) & 1) && ((r[1] >> 31) & 1);     // BW, VL
+    const bool avx512Vnni = (r[2] >> 11) & 1;
+    cpuid(7, 1, r);
+    const bool avxVnni = (r[0] >> 4) & 1;
+
+    switch (isa) {
+    case Isa::Avx2:
+        return ymm && avx2 && fma;
+    case Isa::AvxVnni:
+#if defined(QUANT_AVXVNNI)
+        return ymm && avx2 && fma && avxVnni;
+#else
+        return false;
+#endif
+    case Isa::Avx512Vnni:
+        return zmm && avx2 && fma && avx512 && avx512Vnni;
+    default:
+        return false;
+    }
+#else
+    return false;
+#endif
+}
+
+KernelSet kernelsFor(Isa isa) {
+    switch (isa) {
+#if defined(QUANT_X86)
+    case Isa::Avx2:
+        return avx2Kernels();
+#if defined(QUANT_AVXVNNI)
+    case Isa::AvxVnni:
+        return avxVnniKernels();
+#endif
+    case Isa::Avx512Vnni:
+        return avx512VnniKernels();
+#endif
+    default:
+        return scalarKernels();
+    }
+}
+
+struct Dispatch {
+    std::atomic<int> isa;
+    std::atomic<KernelFn> int8;
+    std::atomic<KernelFn> int4;
+
+    Dispatch() {
+        const Isa best = detectIsa();
+        const KernelSet kernels = kernelsFor(best);
+        isa.store(static_cast<int>(best));
+        int8.store(kernels.int8);
+        int4.store(kernels.int4);
+    }
+};
+
+Dispatch& dispatch() {
+    static Dispatch instance;
+    return instance;
+}
+
+} // namespace
+
+KernelSet scalarKernels() {
+    return { scalarKernel<false>, scalarKernel<true> };
+}
+
+const char* isaName(Isa isa) {
+    switch (isa) {
+    case Isa::Avx2: return "avx2";
+    case Isa::AvxVnni: return "avx-vnni";
+    case Isa::Avx512Vnni: return "avx512-vnni";
+    default: return "scalar";
+    }
+}
+
+Isa detectIsa() {
+    static const Isa best = [] {
+        for (Isa isa : { Isa::Avx512Vnni, Isa::AvxVnni, Isa::Avx2 }) {
+            if (supported(isa)) return isa;
+        }
+        return Isa::Scalar;
+    }();
+    return best;
+}
+
+Isa activeIsa() {
+    return static_cast<Isa>(dispatch().isa.load());
+}
+
+bool setIsa(Isa isa) {
+    if (!supported(isa)) return false;
+    const KernelSet kernels = kernelsFor(isa);
+    Dispatch& d = dispatch();
+    d.int8.store(kernels.int8);
+    d.int4.store(kernels.int4);
+    d.isa.store(static_cast<int>(isa));
+    return true;
+}
+
+void gemm(const QuantizedActivations& x, const QuantizedMatrix& w, size_t o0, size_t o1,
+          const float* bias, float* y, size_t ldy) {
+    if (o0 >= o1 || x.rows == 0) return;
+
+    KernelArgs args;
+    args.a = x.data.data();
+    args.aScales = x.scales.data();
+    args.rows = x.rows;
+    args.blocks = x.blocks();
+    args.w = w.data;
+    args.wRowBytes = w.rowBytes();
+    args.wScales = w.scales;
+    args.groupsPerRow = w.groupsPerRow();
+    args.blocksPerGroup = w.blocksPerGroup();
+    args.o0 = o0;
+    args.o1 = o1;
+    args.bias = bias;
+    args.y = y;
+    args.ldy = ldy;
+    thread_local std::vector<float> blockScales;
+    blockScales.resize(args.blocks);
+    args.blockScales = blockScales.data();
+
+    const KernelFn kernel = w.type == QuantType::Int4 ? dispatch().int4.load() : dispatch().int8.load();
+    kernel(args);
+}
+
+} // namespace quant
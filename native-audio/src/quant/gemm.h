@@ -0,0 +1,40 @@
+// Quantized matrix multiply with runtime ISA dispatch
+//
+//   y[r * ldy + o] = bias[o] + sum_k x[r][k] * W[o][k]    for o in [o0, o1)
+//
+// x is given as QuantizedActivations and W as a QuantizedMatrix of the same
+// column count. One call runs on the calling thread; callers split the output
+// range across threads. The best kernel for the CPU is picked on first use:
+// AVX-512 VNNI, AVX-VNNI or AVX2 on x86-64, a portable scalar loop elsewhere.
+
+#ifndef QUANT_GEMM_H
+#define QUANT_GEMM_H
+
+#include "quantize.h"
+
+namespace quant {
+
+enum class Isa {
+    Scalar,
+    Avx2,
+    AvxVnni,
+    Avx512Vnni
+};
+
+const char* isaName(Isa isa);
+
+// Best ISA this CPU and build support
+Isa detectIsa();
+
+Isa activeIsa();
+
+// Override dispatch (benchmarks and accuracy checks). Returns false and keeps
+// the current kernels if the ISA is not supported here.
+bool setIsa(Isa isa);
+
+void gemm(const QuantizedActivations& x, const QuantizedMatrix& w, size_t o0, size_t o1,
+          const float* bias, float* y, size_t ldy);
+
+} // namespace quant
+
+#endif
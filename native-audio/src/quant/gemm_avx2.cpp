@@ -0,0 +1,76 @@
+// AVX2 kernels: unsigned x signed byte products via the sign trick
+// (maddubs(|a|, sign(w, a))), widened with madd and accumulated in float.
+
+#include "kernels.h"
+
+#if defined(QUANT_X86)
+
+#include "quantize.h"
+
+#include <immintrin.h>
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2,fma"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+#endif
+
+#include "kernel_loop.h"
+
+namespace quant {
+namespace {
+
+struct Avx2Ops {
+    static const size_t kStep = 1;
+    typedef __m256i Vec;
+    typedef __m256 Acc;
+
+    static Acc zero() { return _mm256_setzero_ps(); }
+
+    static Vec loadA(const int8_t* p, size_t) {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    }
+
+    static Vec loadW8(const uint8_t* p, size_t) {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    }
+
+    static Vec loadW4(const uint8_t* p, size_t) {
+        const __m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        const __m128i mask = _mm_set1_epi8(0x0F);
+        const __m128i lo = _mm_and_si128(packed, mask);
+        const __m128i hi = _mm_and_si128(_mm_srli_epi16(packed, 4), mask);
+        const __m256i both = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+        return _mm256_sub_epi8(both, _mm256_set1_epi8(8));
+    }
+
+    static Acc madd(Acc acc, Vec a, Vec w, const float* scales) {
+        const __m256i products = _mm256_maddubs_epi16(_mm256_sign_epi8(a, a), _mm256_sign_epi8(w, a));
+        const __m256i dot = _mm256_madd_epi16(products, _mm256_set1_epi16(1));
+        return _mm256_fmadd_ps(_mm256_cvtepi32_ps(dot), _mm256_set1_ps(scales[0]), acc);
+    }
+
+    static float reduce(Acc acc) {
+        __m128 sum = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+        sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+        sum = _mm_add_ss(sum, _mm_movehdup_ps(sum));
+        return _mm_cvtss_f32(sum);
+    }
+};
+
+} // namespace
+
+KernelSet avx2Kernels() {
+    return { blockedKernel<Avx2Ops, false>, blockedKernel<Avx2Ops, true> };
+}
+
+} // namespace quant
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#endif
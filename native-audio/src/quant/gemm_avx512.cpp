@@ -0,0 +1,86 @@
+// AVX-512 VNNI kernels: two 32-weight blocks per vpdpbusd. The sign of the
+// activations moves onto the weights with a masked subtract, so the unsigned
+// operand is |a| as in the 256-bit paths.
+
+#include "kernels.h"
+
+#if defined(QUANT_X86)
+
+#include "quantize.h"
+
+#include <immintrin.h>
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2,fma,avx512f,avx512bw,avx512dq,avx512vl,avx512vnni"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2,fma,avx512f,avx512bw,avx512dq,avx512vl,avx512vnni")
+#endif
+
+#include "kernel_loop.h"
+
+namespace quant {
+namespace {
+
+struct Avx512VnniOps {
+    static const size_t kStep = 2;
+    typedef __m512i Vec;
+    typedef __m512 Acc;
+
+    static Acc zero() { return _mm512_setzero_ps(); }
+
+    static Vec load(const void* p, size_t blocks) {
+        if (blocks == 2) return _mm512_loadu_si512(p);
+        return _mm512_maskz_loadu_epi8(0xFFFFFFFFull, p);
+    }
+
+    static Vec loadA(const int8_t* p, size_t blocks) { return load(p, blocks); }
+
+    static Vec loadW8(const uint8_t* p, size_t blocks) { return load(p, blocks); }
+
+    // Zero-masked forms throughout: the unmasked ones start from an undefined
+    // register, which GCC reports as -Wmaybe-uninitialized
+    static Vec loadW4(const uint8_t* p, size_t blocks) {
+        const __m256i packed = blocks == 2
+            ? _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p))
+            : _mm256_zextsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+        // 128-bit lanes p0 p0 p1 p1, high nibbles taken from the odd lanes
+        const __m512i lanes = _mm512_maskz_permutexvar_epi64(
+            0xFF, _mm512_set_epi64(3, 2, 3, 2, 1, 0, 1, 0), _mm512_maskz_broadcast_i64x4(0xFF, packed));
+        const __m512i nibbles = _mm512_mask_blend_epi64(0xCC, lanes, _mm512_srli_epi16(lanes, 4));
+        return _mm512_sub_epi8(_mm512_and_si512(nibbles, _mm512_set1_epi8(0x0F)), _mm512_set1_epi8(8));
+    }
+
+    static Acc madd(Acc acc, Vec a, Vec w, const float* scales) {
+        const __mmask64 negative = _mm512_movepi8_mask(a);
+        const __m512i signedW = _mm512_mask_sub_epi8(w, negative, _mm512_setzero_si512(), w);
+        const __m512i dot = _mm512_dpbusd_epi32(_mm512_setzero_si512(), _mm512_abs_epi8(a), signedW);
+        const __m512 scale = _mm512_insertf32x8(_mm512_set1_ps(scales[0]), _mm256_set1_ps(scales[1]), 1);
+        return _mm512_fmadd_ps(_mm512_maskz_cvtepi32_ps(0xFFFF, dot), scale, acc);
+    }
+
+    // Same order as _mm512_reduce_add_ps
+    static float reduce(Acc acc) {
+        const __m256 half = _mm256_add_ps(_mm512_maskz_extractf32x8_ps(0xFF, acc, 0), _mm512_maskz_extractf32x8_ps(0xFF, acc, 1));
+        __m128 sum = _mm_add_ps(_mm256_castps256_ps128(half), _mm256_extractf128_ps(half, 1));
+        sum = _mm_add_ps(sum, _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(1, 0, 3, 2)));
+        sum = _mm_add_ps(sum, _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm_cvtss_f32(sum);
+    }
+};
+
+} // namespace
+
+KernelSet avx512VnniKernels() {
+    return { blockedKernel<Avx512VnniOps, false>, blockedKernel<Avx512VnniOps, true> };
+}
+
+} // namespace quant
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#endif
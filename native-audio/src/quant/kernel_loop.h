@@ -0,0 +1,92 @@
+// Blocked loop shared by the SIMD kernels. Include it inside the file's
+// target region so the instantiations are compiled for that ISA.
+//
+// Ops provides:
+//   kStep                       blocks consumed per step (1 or 2)
+//   Vec, Acc                    integer operand and float accumulator types
+//   zero(), reduce(acc)
+//   loadA(p, n), loadW8(p, n), loadW4(p, n)   n = blocks to load (<= kStep)
+//   madd(acc, a, w, scales)     acc += dot(a, w) per block * scales[block]
+
+#ifndef QUANT_KERNEL_LOOP_H
+#define QUANT_KERNEL_LOOP_H
+
+#include "kernels.h"
+#include "quantize.h"
+
+namespace quant {
+namespace {
+
+// Activation rows sharing one pass over a weight row
+const size_t kRowTile = 4;
+// Rows kept hot in cache while sweeping the output range
+const size_t kRowPanel = 32;
+
+template <class Ops, bool Int4>
+inline typename Ops::Vec loadWeights(const uint8_t* row, size_t block, size_t count) {
+    return Int4 ? Ops::loadW4(row + block * 16, count) : Ops::loadW8(row + block * kBlock, count);
+}
+
+// wScales holds the weight row's scale expanded to one per block
+template <class Ops, bool Int4, size_t Rows>
+inline void kernelTile(const KernelArgs& args, size_t o, size_t r, const float* wScales) {
+    const uint8_t* wRow = args.w + o * args.wRowBytes;
+    const size_t stride = args.blocks * kBlock;
+
+    typename Ops::Acc acc[Rows];
+    for (size_t i = 0; i < Rows; i++) acc[i] = Ops::zero();
+
+    float scales[Ops::kStep];
+    size_t b = 0;
+    for (; b + Ops::kStep <= args.blocks; b += Ops::kStep) {
+        const typename Ops::Vec w = loadWeights<Ops, Int4>(wRow, b, Ops::kStep);
+        for (size_t i = 0; i < Rows; i++) {
+            const float* aScales = args.aScales + (r + i) * args.blocks + b;
+            for (size_t k = 0; k < Ops::kStep; k++) {
+                scales[k] = aScales[k] * wScales[b + k];
+            }
+            const typename Ops::Vec a = Ops::loadA(args.a + (r + i) * stride + b * kBlock, Ops::kStep);
+            acc[i] = Ops::madd(acc[i], a, w, scales);
+        }
+    }
+    if (b < args.blocks) {
+        const size_t count = args.blocks - b;
+        const typename Ops::Vec w = loadWeights<Ops, Int4>(wRow, b, count);
+        for (size_t i = 0; i < Rows; i++) {
+            const float* aScales = args.aScales + (r + i) * args.blocks + b;
+            for (size_t k = 0; k < Ops::kStep; k++) {
+                scales[k] = k < count ? aScales[k] * wScales[b + k] : 0.0f;
+            }
+            const typename Ops::Vec a = Ops::loadA(args.a + (r + i) * stride + b * kBlock, count);
+            acc[i] = Ops::madd(acc[i], a, w, scales);
+        }
+    }
+
+    const float bias = args.bias ? args.bias[o] : 0.0f;
+    for (size_t i = 0; i < Rows; i++) {
+        args.y[(r + i) * args.ldy + o] = Ops::reduce(acc[i]) + bias;
+    }
+}
+
+template <class Ops, bool Int4>
+void blockedKernel(const KernelArgs& args) {
+    float* blockScales = args.blockScales;
+    for (size_t panel = 0; panel < args.rows; panel += kRowPanel) {
+        const size_t panelEnd = panel + kRowPanel < args.rows ? panel + kRowPanel : args.rows;
+        for (size_t o = args.o0; o < args.o1; o++) {
+            const float* groupScales = args.wScales + o * args.groupsPerRow;
+            for (size_t b = 0; b < args.blocks; b++) blockScales[b] = groupScales[b / args.blocksPerGroup];
+
+            size_t r = panel;
+            for (; r + kRowTile <= panelEnd; r += kRowTile) {
+                kernelTile<Ops, Int4, kRowTile>(args, o, r, blockScales);
+            }
+            for (; r < panelEnd; r++) kernelTile<Ops, Int4, 1>(args, o, r, blockScales);
+        }
+    }
+}
+
+} // namespace
+} // namespace quant
+
+#endif
@@ -0,0 +1,50 @@
+// Internal kernel table shared by gemm.cpp and the ISA-specific kernels
+
+#ifndef QUANT_KERNELS_H
+#define QUANT_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace quant {
+
+struct KernelArgs {
+    const int8_t* a;          // activations [rows][blocks * 32]
+    const float* aScales;     // [rows][blocks]
+    size_t rows;
+    size_t blocks;
+    const uint8_t* w;         // weight rows, rowBytes apart
+    size_t wRowBytes;
+    const float* wScales;     // [out][groupsPerRow]
+    size_t groupsPerRow;
+    size_t blocksPerGroup;
+    size_t o0;
+    size_t o1;
+    const float* bias;
+    float* y;
+    size_t ldy;
+    float* blockScales;       // scratch, one float per block
+};
+
+typedef void (*KernelFn)(const KernelArgs& args);
+
+struct KernelSet {
+    KernelFn int8;
+    KernelFn int4;
+};
+
+KernelSet scalarKernels();
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define QUANT_X86 1
+KernelSet avx2Kernels();
+KernelSet avx512VnniKernels();
+#if defined(__clang__) ? (__clang_major__ >= 13) : (defined(__GNUC__) && __GNUC__ >= 11)
+#define QUANT_AVXVNNI 1
+KernelSet avxVnniKernels();
+#endif
+#endif
+
+} // namespace quant
+
+#endif
@@ -0,0 +1,125 @@
+#include "quantize.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace quant {
+
+namespace {
+
+size_t padded(size_t cols) {
+    return (cols + kBlock - 1) / kBlock * kBlock;
+}
+
+int8_t roundClamp(float value, int low, int high) {
+    const int q = static_cast<int>(std::lround(value));
+    return static_cast<int8_t>(std::min(high, std::max(low, q)));
+}
+
+} // namespace
+
+bool quantizeMatrix(const float* weights, size_t rows, size_t cols, QuantType type,
+                    size_t groupSize, QuantizedMatrix* out) {
+    const size_t paddedCols = padded(cols);
+    if (groupSize == 0 || groupSize > paddedCols) groupSize = paddedCols;
+    if (groupSize % kBlock != 0 || paddedCols % groupSize != 0) return false;
+
+    out->type = type;
+    out->rows = rows;
+    out->cols = cols;
+    out->paddedCols = paddedCols;
+    out->groupSize = groupSize;
+
+    // Scales first so they stay float-aligned
+    auto buffer = std::make_shared<std::vector<uint8_t>>(out->scaleBytes() + out->dataBytes(), 0);
+    float* scales = reinterpret_cast<float*>(buffer->data());
+    uint8_t* data = buffer->data() + out->scaleBytes();
+    out->data = data;
+    out->scales = scales;
+    out->storage = buffer;
+
+    std::vector<float> row(paddedCols, 0.0f);
+    std::vector<int8_t> q(paddedCols, 0);
+    for (size_t r = 0; r < rows; r++) {
+        std::copy(weights + r * cols, weights + (r + 1) * cols, row.begin());
+
+        for (size_t g = 0; g < out->groupsPerRow(); g++) {
+            const float* values = row.data() + g * groupSize;
+            float scale = 0.0f;
+            if (type == QuantType::Int8) {
+                float maxAbs = 0.0f;
+                for (size_t i = 0; i < groupSize; i++) maxAbs = std::max(maxAbs, std::fabs(values[i]));
+                scale = maxAbs / 127.0f;
+                const float inv = scale > 0.0f ? 1.0f / scale : 0.0f;
+                for (size_t i = 0; i < groupSize; i++) q[g * groupSize + i] = roundClamp(values[i] * inv, -127, 127);
+            } else {
+                // Map the largest-magnitude value onto -8 so the full range is used
+                float extreme = 0.0f;
+                for (size_t i = 0; i < groupSize; i++) {
+                    if (std::fabs(values[i]) > std::fabs(extreme)) extreme = values[i];
+                }
+                scale = extreme / -8.0f;
+                const float inv = scale != 0.0f ? 1.0f / scale : 0.0f;
+                for (size_t i = 0; i < groupSize; i++) q[g * groupSize + i] = roundClamp(values[i] * inv, -8, 7);
+            }
+            scales[r * out->groupsPerRow() + g] = scale;
+        }
+
+        uint8_t* dst = data + r * out->rowBytes();
+        if (type == QuantType::Int8) {
+            std::copy(q.begin(), q.end(), reinterpret_cast<int8_t*>(dst));
+        } else {
+            for (size_t b = 0; b < paddedCols / kBlock; b++) {
+                const int8_t* block = q.data() + b * kBlock;
+                for (size_t j = 0; j < kBlock / 2; j++) {
+                    dst[b * 16 + j] = static_cast<uint8_t>((block[j] + 8) | ((block[j + 16] + 8) << 4));
+                }
+            }
+        }
+    }
+    return true;
+}
+
+void dequantizeRow(const QuantizedMatrix& matrix, size_t row, float* out) {
+    const uint8_t* src = matrix.data + row * matrix.rowBytes();
+    const float* scales = matrix.scales + row * matrix.groupsPerRow();
+    for (size_t i = 0; i < matrix.cols; i++) {
+        int q;
+        if (matrix.type == QuantType::Int8) {
+            q = static_cast<int8_t>(src[i]);
+        } else {
+            const size_t b = i / kBlock;
+            const size_t j = i % kBlock;
+            const uint8_t byte = src[b * 16 + (j & 15)];
+            q = (j < 16 ? (byte & 0x0F) : (byte >> 4)) - 8;
+        }
+        out[i] = q * scales[i / matrix.groupSize];
+    }
+}
+
+void quantizeActivations(const float* x, size_t rows, size_t cols, QuantizedActivations* out) {
+    out->rows = rows;
+    out->cols = cols;
+    out->paddedCols = padded(cols);
+    out->data.resize(rows * out->paddedCols);
+    out->scales.resize(rows * out->blocks());
+
+    for (size_t r = 0; r < rows; r++) {
+        const float* src = x + r * cols;
+        int8_t* dst = out->data.data() + r * out->paddedCols;
+        for (size_t b = 0; b < out->blocks(); b++) {
+            const size_t begin = b * kBlock;
+            const size_t end = std::min(cols, begin + kBlock);
+            float maxAbs = 0.0f;
+            for (size_t i = begin; i < end; i++) maxAbs = std::max(maxAbs, std::fabs(src[i]));
+            const float scale = maxAbs / 127.0f;
+            const float inv = scale > 0.0f ? 1.0f / scale : 0.0f;
+            for (size_t i = begin; i < begin + kBlock; i++) {
+                dst[i] = i < end ? roundClamp(src[i] * inv, -127, 127) : 0;
+            }
+            out->scales[r * out->blocks() + b] = scale;
+        }
+    }
+}
+
+} // namespace quant
@@ -0,0 +1,80 @@
+// Quantized weights and activations for the local inference kernels
+//
+// Weights are row-major with one row per output channel, zero-padded to a
+// multiple of 32 input columns. Each row is split into groups of groupSize
+// columns (a multiple of 32, or the whole row for per-channel scales) that
+// share one float scale:
+//
+//   Int8  one signed byte per weight, symmetric in [-127, 127]
+//   Int4  16 bytes per 32 weights; byte j holds weight j in its low nibble
+//         and weight j + 16 in its high nibble, stored as q + 8, q in [-8, 7]
+//
+// Activations are quantized on the fly to int8 with one scale per 32-value
+// block, so every kernel works block by block:
+//
+//   y[r][o] = sum_b  aScale[r][b] * wScale[o][group(b)] * dot(a[r][b], w[o][b])
+//
+// with the dot product taken in integer arithmetic.
+
+#ifndef QUANT_QUANTIZE_H
+#define QUANT_QUANTIZE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace quant {
+
+const size_t kBlock = 32;
+
+enum class QuantType : uint32_t {
+    Int8 = 8,
+    Int4 = 4
+};
+
+struct QuantizedMatrix {
+    QuantType type = QuantType::Int8;
+    size_t rows = 0;          // output channels
+    size_t cols = 0;          // input features
+    size_t paddedCols = 0;    // cols rounded up to kBlock
+    size_t groupSize = 0;     // columns per scale
+    const uint8_t* data = nullptr;   // [rows][rowBytes()]
+    const float* scales = nullptr;   // [rows][groupsPerRow()]
+    // Keeps data and scales alive: a heap buffer from quantizeMatrix() or a
+    // read-only file mapping the matrix was loaded from
+    std::shared_ptr<const void> storage;
+
+    size_t rowBytes() const { return type == QuantType::Int8 ? paddedCols : paddedCols / 2; }
+    size_t groupsPerRow() const { return groupSize ? paddedCols / groupSize : 0; }
+    size_t blocksPerGroup() const { return groupSize / kBlock; }
+    size_t dataBytes() const { return rows * rowBytes(); }
+    size_t scaleBytes() const { return rows * groupsPerRow() * sizeof(float); }
+    size_t bytes() const { return dataBytes() + scaleBytes(); }
+    bool empty() const { return rows == 0; }
+};
+
+struct QuantizedActivations {
+    size_t rows = 0;
+    size_t cols = 0;
+    size_t paddedCols = 0;
+    std::vector<int8_t> data;   // [rows][paddedCols], in [-127, 127]
+    std::vector<float> scales;  // [rows][paddedCols / kBlock]
+
+    size_t blocks() const { return paddedCols / kBlock; }
+};
+
+// Quantize a row-major [rows, cols] matrix. groupSize 0 means one scale per
+// row; otherwise it must be a multiple of kBlock (it is clamped to the padded
+// row). Returns false for an invalid group size.
+bool quantizeMatrix(const float* weights, size_t rows, size_t cols, QuantType type,
+                    size_t groupSize, QuantizedMatrix* out);
+
+// Recover one row (cols values) in float
+void dequantizeRow(const QuantizedMatrix& matrix, size_t row, float* out);
+
+void quantizeActivations(const float* x, size_t rows, size_t cols, QuantizedActivations* out);
+
+} // namespace quant
+
+#endif
@@ -104,10 +104,23 @@ RNNOISE_EXPORT float rnnoise_process_frame(DenoiseState *st, float *x);
  *
  * It must either be freed with rnnoise_model_free() or passed to rnnoise_create().
  *
+ * If f starts with a tensor container (storage/tensor_file.h, kind
+ * "rnnoise") the weights are mapped read-only and used in place instead of
+ * being parsed; f may be closed once the call returns. The mapping is
+ * released by rnnoise_model_free().
+ *
  * @param   f    FILE pointer opened in binary mode
  */
 RNNOISE_EXPORT RNNModel *rnnoise_model_from_file(FILE *f);
 
+/**
+ * Load a model from a tensor container by path
+ *
+ * Same as rnnoise_model_from_file() on a container, without opening a FILE.
+ * Returns NULL if the file is missing or is not an "rnnoise" container.
+ */
+RNNOISE_EXPORT RNNModel *rnnoise_model_from_filename(const char *path);
+
 /**
  * Free a custom model
  *
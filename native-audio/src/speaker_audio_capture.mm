@@ -4,26 +4,81 @@
 #import <CoreMedia/CoreMedia.h>
 #import <objc/message.h>
 #include <napi.h>
-#include <vector>
+#include <atomic>
 #include <functional>
+#include <memory>
+#include <string>
+#include <vector>
 
-using namespace Napi;
-
-// Forward declaration
-class AudioCaptureAddon;
+#include "capture/capture_delivery.h"
+#include "capture/capture_metrics.h"
+#include "capture/napi_stats.h"
+#include "capture/realtime_check.h"
+#include "capture/sample_format.h"
+#include "trace/trace.h"
+#include "trace/trace_napi.h"
 
-// Global callback
-std::function<void(const float*, size_t)> g_audioCallback;
-AudioCaptureAddon* g_captureInstance = nullptr;
+using namespace Napi;
 
-// Stream output handler
+// Stream output handler. Runs on ScreenCaptureKit's audio queue: after the
+// first buffer of a format it only converts into scratch that has grown to
+// the largest buffer seen and copies into the ring, without allocating or
+// logging.
 typedef void (^AudioCallback)(const float* data, size_t length);
 
 @interface StreamOutputHandler : NSObject <SCStreamOutput>
 @property (nonatomic, copy) AudioCallback callback;
+- (void)setMetrics:(std::shared_ptr<capture::CaptureMetrics>)metrics;
 @end
 
-@implementation StreamOutputHandler
+@implementation StreamOutputHandler {
+    CMFormatDescriptionRef _formatDesc;     // retained; the format below is for it
+    capture::SampleFormat _format;
+    std::vector<uint64_t> _bufferList;      // AudioBufferList storage, 8-byte aligned
+    capture::PacketConverter _converter;
+    std::shared_ptr<capture::CaptureMetrics> _metrics;
+}
+
+- (void)setMetrics:(std::shared_ptr<capture::CaptureMetrics>)metrics {
+    _metrics = std::move(metrics);
+}
+
+- (void)dealloc {
+    if (_formatDesc) {
+        CFRelease(_formatDesc);
+    }
+    self.callback = nil;
+    [super dealloc];
+}
+
+// Once per format, not per buffer
+- (void)updateFormat:(CMFormatDescriptionRef)formatDesc {
+    if (_formatDesc) {
+        CFRelease(_formatDesc);
+    }
+    _formatDesc = formatDesc ? (CMFormatDescriptionRef)CFRetain(formatDesc) : NULL;
+    
+    const AudioStreamBasicDescription* asbd =
+        formatDesc ? CMAudioFormatDescriptionGetStreamBasicDescription(formatDesc) : NULL;
+    if (!asbd) {
+        _format = capture::SampleFormat::Float32;   // assume Float32
+        return;
+    }
+    NSLog(@"🎚️ Audio format: sampleRate=%.0f, channels=%u, format=%u, flags=%u, bytesPerFrame=%u",
+          asbd->mSampleRate, asbd->mChannelsPerFrame, asbd->mFormatID, asbd->mFormatFlags, asbd->mBytesPerFrame);
+    if (asbd->mFormatID != kAudioFormatLinearPCM) {
+        _format = capture::SampleFormat::Float32;
+    } else if (asbd->mFormatFlags & kAudioFormatFlagIsFloat) {
+        _format = capture::SampleFormat::Float32;
+    } else if ((asbd->mFormatFlags & kAudioFormatFlagIsSignedInteger) && asbd->mBitsPerChannel == 32) {
+        _format = capture::SampleFormat::Int32;
+    } else if (asbd->mFormatFlags & kAudioFormatFlagIsSignedInteger) {
+        _format = capture::SampleFormat::Int16;
+    } else {
+        _format = capture::SampleFormat::Unsupported;
+        NSLog(@"⚠️ Unsupported audio format flags: %u, buffers are skipped", asbd->mFormatFlags);
+    }
+}
 
 - (void)stream:(SCStream *)stream didOutputSampleBuffer:(CMSampleBufferRef)sampleBuffer ofType:(SCStreamOutputType)type {
     if (type != SCStreamOutputTypeAudio) {
@@ -34,24 +89,13 @@ typedef void (^AudioCallback)(const float* data, size_t length);
         return;
     }
     
-    // Check audio format
-    CMAudioFormatDescriptionRef formatDesc = CMSampleBufferGetFormatDescription(sampleBuffer);
-    if (formatDesc) {
-        const AudioStreamBasicDescription* asbd = CMAudioFormatDescriptionGetStreamBasicDescription(formatDesc);
-        static int formatLogCount = 0;
-        if (formatLogCount < 2) {
-            if (asbd) {
-                NSLog(@"🎚️ Audio format: sampleRate=%.0f, channels=%u, format=%u (1=Float32, 2=Int16), bytesPerFrame=%u",
-                      asbd->mSampleRate, asbd->mChannelsPerFrame, asbd->mFormatID, asbd->mBytesPerFrame);
-                formatLogCount++;
-            }
-        }
+    CMFormatDescriptionRef formatDesc = CMSampleBufferGetFormatDescription(sampleBuffer);
+    if (formatDesc != _formatDesc || _bufferList.empty()) {
+        [self updateFormat:formatDesc];
     }
     
-    CMBlockBufferRef blockBuffer = NULL;
+    // Get the required size
     size_t bufferListSize = 0;
-    
-    // First, get the required size
     OSStatus status = CMSampleBufferGetAudioBufferListWithRetainedBlockBuffer(
         sampleBuffer,
         &bufferListSize,
@@ -68,18 +112,27 @@ typedef void (^AudioCallback)(const float* data, size_t length);
         return;
     }
     
-    // Allocate buffer list
-    AudioBufferList* allocatedBufferList = (AudioBufferList*)malloc(bufferListSize);
-    if (!allocatedBufferList) {
-        NSLog(@"❌ Failed to allocate audio buffer list");
-        return;
+    // Grows to fit the first buffer (or a format with more channels), then
+    // is reused
+    size_t words = (bufferListSize + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+    if (_bufferList.size() < words) {
+        _bufferList.resize(words);
     }
+    AudioBufferList* bufferList = reinterpret_cast<AudioBufferList*>(_bufferList.data());
+    
+    // The audio queue may hop threads; each new one claims a spare trace
+    // buffer, which takes no lock
+    capture::RealtimeScope realtime("ScreenCaptureKit audio");
+    trace::setThreadName("ScreenCaptureKit audio");
+    trace::Scope span("sck buffer", "bytes", static_cast<int64_t>(bufferListSize));
+    const int64_t callbackStart = capture::steadyNowNs();
     
     // Get the actual audio data
+    CMBlockBufferRef blockBuffer = NULL;
     status = CMSampleBufferGetAudioBufferListWithRetainedBlockBuffer(
         sampleBuffer,
         NULL,
-        allocatedBufferList,
+        bufferList,
         bufferListSize,
         NULL,
         NULL,
@@ -88,8 +141,6 @@ typedef void (^AudioCallback)(const float* data, size_t length);
     );
     
     if (status != noErr) {
-        NSLog(@"❌ Error getting audio buffer: %d", (int)status);
-        free(allocatedBufferList);
         if (blockBuffer) {
             CFRelease(blockBuffer);
         }
@@ -97,78 +148,35 @@ typedef void (^AudioCallback)(const float* data, size_t length);
     }
     
     // Process audio buffers
-    UInt32 numBuffers = allocatedBufferList->mNumberBuffers;
-    static int sampleCount = 0;
+    size_t sampleBytes = _format == capture::SampleFormat::Int16 ? sizeof(int16_t) : sizeof(float);
+    UInt32 numBuffers = bufferList->mNumberBuffers;
     for (UInt32 i = 0; i < numBuffers; i++) {
-        AudioBuffer buffer = allocatedBufferList->mBuffers[i];
+        AudioBuffer buffer = bufferList->mBuffers[i];
         if (buffer.mData && buffer.mDataByteSize > 0) {
-            // Check format - might be Int16 or Float32
-            CMAudioFormatDescriptionRef formatDesc = CMSampleBufferGetFormatDescription(sampleBuffer);
-            const AudioStreamBasicDescription* asbd = NULL;
-            if (formatDesc) {
-                asbd = CMAudioFormatDescriptionGetStreamBasicDescription(formatDesc);
-            }
-            
-            size_t length = 0;
-            float* floatData = NULL;
-            
-            if (asbd && asbd->mFormatID == kAudioFormatLinearPCM) {
-                if (asbd->mFormatFlags & kAudioFormatFlagIsFloat) {
-                    // Float32 format
-                    length = buffer.mDataByteSize / sizeof(float);
-                    floatData = (float*)buffer.mData;
-                } else if (asbd->mFormatFlags & kAudioFormatFlagIsSignedInteger) {
-                    // Int16 format - convert to float
-                    length = buffer.mDataByteSize / sizeof(int16_t);
-                    int16_t* int16Data = (int16_t*)buffer.mData;
-                    floatData = (float*)malloc(length * sizeof(float));
-                    for (size_t j = 0; j < length; j++) {
-                        floatData[j] = int16Data[j] / 32768.0f;
-                    }
-                } else {
-                    NSLog(@"⚠️ Unsupported audio format flags: %u", asbd->mFormatFlags);
-                    continue;
-                }
-            } else {
-                // Default: assume Float32
-                length = buffer.mDataByteSize / sizeof(float);
-                floatData = (float*)buffer.mData;
-            }
-            
+            size_t length = buffer.mDataByteSize / sampleBytes;
+            const float* floatData = _converter.convert(buffer.mData, length, _format);
             if (floatData && length > 0) {
-                // Log first few samples to verify audio is coming through
-                if (sampleCount < 5) {
-                    // Check if audio has non-zero values
-                    float maxValue = 0.0;
-                    float minValue = 0.0;
-                    for (size_t j = 0; j < length && j < 100; j++) {
-                        if (floatData[j] > maxValue) maxValue = floatData[j];
-                        if (floatData[j] < minValue) minValue = floatData[j];
-                    }
-                    NSLog(@"🎵 Audio sample %d: %lu floats, range: [%f, %f], first: %f", 
-                          sampleCount, length, minValue, maxValue, length > 0 ? floatData[0] : 0.0);
-                    sampleCount++;
-                }
-                
                 self.callback(floatData, length);
-                
-                // Free converted buffer if we allocated it
-                if (asbd && !(asbd->mFormatFlags & kAudioFormatFlagIsFloat)) {
-                    free(floatData);
-                }
             }
         }
     }
     
-    free(allocatedBufferList);
     if (blockBuffer) {
         CFRelease(blockBuffer);
     }
+    if (_metrics) {
+        _metrics->callback.record(capture::steadyNowNs() - callbackStart);
+    }
 }
 
 @end
 
-// Main addon class
+// Chunks queued towards the JS thread before the delivery thread leaves new
+// audio in the ring
+static const size_t kMaxQueuedChunks = 4;
+
+// Main addon class. Each instance owns its stream, ring and delivery thread;
+// nothing is shared between instances, environments or worker threads.
 class AudioCaptureAddon : public Napi::ObjectWrap<AudioCaptureAddon> {
 public:
     static Napi::Object Init(Napi::Env env, Napi::Object exports);
@@ -176,53 +184,92 @@ public:
     ~AudioCaptureAddon();
 
 private:
-    static Napi::FunctionReference constructor;
+    // JS thread only; the instance is Ref()'d while starting or stopping
+    enum class State { Idle, Starting, Running, Stopping };
+    
     SCStream* stream_;
     StreamOutputHandler* outputHandler_;
-    bool isCapturing_;
+    std::atomic<bool> isCapturing_;
+    std::atomic<bool> flushing_;    // stop(): the delivery thread may block on the queue
+    uint32_t displayId_;            // 0: first display
+    State state_;
+    std::unique_ptr<Napi::Promise::Deferred> startDeferred_;
+    std::vector<std::unique_ptr<Napi::Promise::Deferred>> stopDeferreds_;
     Napi::ThreadSafeFunction tsfn_;
     Napi::FunctionReference callback_;
+    // Shared with the stream output block, which may outlive this object
+    std::shared_ptr<capture::CaptureDelivery> delivery_;
+    std::shared_ptr<capture::CaptureMetrics> metrics_;
     
     Napi::Value Start(const Napi::CallbackInfo& info);
     Napi::Value Stop(const Napi::CallbackInfo& info);
     Napi::Value IsActive(const Napi::CallbackInfo& info);
+    Napi::Value GetStats(const Napi::CallbackInfo& info);
     
-    void OnAudioData(const float* data, size_t length);
+    bool DeliverChunk(std::vector<float>& chunk);
     void StartCaptureAsync();
+    void StartFailed(const std::string& error);
+    void PostToJs(std::function<void(Napi::Env)> fn);
+    void OnStarted(Napi::Env env, bool ok, const std::string& error);
+    void BeginStop();
+    void FinishStopAsync();
+    void OnStopped(Napi::Env env);
 };
 
-Napi::FunctionReference AudioCaptureAddon::constructor;
-
 Napi::Object AudioCaptureAddon::Init(Napi::Env env, Napi::Object exports) {
     Napi::Function func = DefineClass(env, "AudioCapture", {
         InstanceMethod("start", &AudioCaptureAddon::Start),
         InstanceMethod("stop", &AudioCaptureAddon::Stop),
         InstanceMethod("isActive", &AudioCaptureAddon::IsActive),
+        InstanceMethod("getStats", &AudioCaptureAddon::GetStats),
     });
     
-    constructor = Napi::Persistent(func);
-    constructor.SuppressDestruct();
+    Napi::FunctionReference* constructor = new Napi::FunctionReference();
+    *constructor = Napi::Persistent(func);
+    env.SetInstanceData(constructor);
     
     exports.Set("AudioCapture", func);
     return exports;
 }
 
+// new AudioCapture(callback, { displayId, ringMs, chunkMs })
 AudioCaptureAddon::AudioCaptureAddon(const Napi::CallbackInfo& info)
-    : Napi::ObjectWrap<AudioCaptureAddon>(info), stream_(nil), outputHandler_(nil), isCapturing_(false) {
+    : Napi::ObjectWrap<AudioCaptureAddon>(info), stream_(nil), outputHandler_(nil), isCapturing_(false),
+      flushing_(false), displayId_(0), state_(State::Idle),
+      metrics_(std::make_shared<capture::CaptureMetrics>()) {
     
     Napi::Env env = info.Env();
     
-    // Create thread-safe function for callbacks
-    if (info.Length() > 0 && info[0].IsFunction()) {
+    capture::DeliveryConfig config;
+    config.sampleRate = 16000;
+    config.channels = 1;
+    if (info.Length() > 1 && info[1].IsObject()) {
+        Napi::Object options = info[1].As<Napi::Object>();
+        if (options.Get("displayId").IsNumber()) {
+            displayId_ = options.Get("displayId").As<Napi::Number>().Uint32Value();
+        }
+        if (options.Get("ringMs").IsNumber()) {
+            config.ringMs = options.Get("ringMs").As<Napi::Number>().Int32Value();
+        }
+        if (options.Get("chunkMs").IsNumber()) {
+            config.chunkMs = options.Get("chunkMs").As<Napi::Number>().Int32Value();
+        }
+    }
+    
+    // Create thread-safe function for callbacks. It also carries start/stop
+    // completions, so it exists even without a callback.
+    {
         try {
-            Napi::Function cb = info[0].As<Napi::Function>();
+            Napi::Function cb = info.Length() > 0 && info[0].IsFunction()
+                ? info[0].As<Napi::Function>()
+                : Napi::Function::New(env, [](const Napi::CallbackInfo&) {});
             callback_ = Napi::Persistent(cb);
             
             tsfn_ = Napi::ThreadSafeFunction::New(
                 env,
                 cb,
                 "AudioCapture",
-                0,
+                kMaxQueuedChunks,
                 1
             );
         } catch (const Napi::Error& e) {
@@ -232,64 +279,31 @@ AudioCaptureAddon::AudioCaptureAddon(const Napi::CallbackInfo& info)
         }
     }
     
-    g_captureInstance = this;
+    delivery_ = std::make_shared<capture::CaptureDelivery>(
+        config, [this](std::vector<float>& chunk) { return DeliverChunk(chunk); });
 }
 
 AudioCaptureAddon::~AudioCaptureAddon() {
     NSLog(@"🧹 Destructor called, cleaning up...");
     
-    // Clear global instance pointer if it points to us
-    if (g_captureInstance == this) {
-        g_captureInstance = nullptr;
-    }
-    
-    // Stop capture synchronously
-    if (isCapturing_ && stream_) {
-        isCapturing_ = false;
-        __block BOOL stopCompleted = NO;
-        __block SCStream* streamToStop = stream_;
-        
-        // Check if we're on the main thread to avoid deadlock
-        if ([NSThread isMainThread]) {
-            // Already on main thread, execute directly
-            @autoreleasepool {
-                if (streamToStop) {
-                    [streamToStop stopCaptureWithCompletionHandler:^(NSError* error) {
-                        if (error) {
-                            NSLog(@"⚠️ Error stopping capture in destructor: %@", error.localizedDescription);
-                        }
-                        stopCompleted = YES;
-                    }];
-                    
-                    // Wait a bit for completion
-                    NSDate* timeout = [NSDate dateWithTimeIntervalSinceNow:0.3];
-                    while (!stopCompleted && [timeout timeIntervalSinceNow] > 0) {
-                        [[NSRunLoop currentRunLoop] runMode:NSDefaultRunLoopMode beforeDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
-                    }
-                }
+    // Not waited for: the stream finishes stopping on its own queue. A
+    // pending start() or stop() holds a reference, so there is none here.
+    isCapturing_ = false;
+    if (stream_) {
+        [stream_ stopCaptureWithCompletionHandler:^(NSError* error) {
+            if (error) {
+                NSLog(@"⚠️ Error stopping capture in destructor: %@", error.localizedDescription);
             }
-        } else {
-            // Not on main thread, use dispatch_async (can't use sync from destructor)
-            dispatch_async(dispatch_get_main_queue(), ^{
-                @autoreleasepool {
-                    if (streamToStop) {
-                        [streamToStop stopCaptureWithCompletionHandler:^(NSError* error) {
-                            if (error) {
-                                NSLog(@"⚠️ Error stopping capture in destructor: %@", error.localizedDescription);
-                            }
-                        }];
-                    }
-                }
-            });
-            // Brief sleep to give async call a chance to start
-            usleep(50000); // 50ms
-        }
+        }];
     }
     
     // Clear references
     stream_ = nil;
     outputHandler_ = nil;
     
+    // The delivery thread calls into tsfn_, so it stops first
+    delivery_->stop();
+    
     // Release thread-safe function if it was created
     try {
         if (tsfn_) {
@@ -303,47 +317,140 @@ AudioCaptureAddon::~AudioCaptureAddon() {
     NSLog(@"✅ Destructor completed");
 }
 
-void AudioCaptureAddon::OnAudioData(const float* data, size_t length) {
-    // Check if we're still capturing
-    if (!isCapturing_) {
-        return;
+// Delivery thread: queue a chunk for the JS callback. While capturing this
+// never blocks; a full queue leaves the chunk with the delivery thread for
+// its next pass. The final flush of stop() waits for room instead, so every
+// buffered chunk is queued before the stop completion.
+bool AudioCaptureAddon::DeliverChunk(std::vector<float>& chunk) {
+    if (!tsfn_) {
+        return true;
     }
-    
-    if (length == 0 || !data) {
-        return;
+    trace::setThreadName("capture delivery");
+    trace::Scope span("deliver chunk", "samples", static_cast<int64_t>(chunk.size()));
+    
+    auto callJs = [](Napi::Env env, Napi::Function jsCallback, capture::QueuedChunk* data) {
+        capture::CaptureMetrics& metrics = *data->metrics;
+        metrics.chunkDequeued();
+        if (!jsCallback.IsEmpty() && !jsCallback.IsUndefined()) {
+            trace::Scope span("js callback", "samples", static_cast<int64_t>(data->samples.size()));
+            span.flowIn(data->flowId);
+            const int64_t calledNs = capture::steadyNowNs();
+            metrics.delivery.record(calledNs - data->capturedNs);
+            // Convert to Buffer for efficient transfer
+            Napi::Buffer<float> buffer = Napi::Buffer<float>::Copy(env, data->samples.data(), data->samples.size());
+            metrics.bytesOut.fetch_add(data->samples.size() * sizeof(float), std::memory_order_relaxed);
+            jsCallback.Call({buffer});
+            metrics.jsHandler.record(capture::steadyNowNs() - calledNs);
+        }
+        delete data;
+    };
+    // An arrow from here to the JS callback that receives the chunk
+    const uint64_t flowId = span.active() ? trace::newId() : 0;
+    span.flowOut(flowId);
+    capture::QueuedChunk* audioData =
+        new capture::QueuedChunk{std::move(chunk), delivery_->chunkCapturedNs(), metrics_, flowId};
+    metrics_->chunkQueued();
+    napi_status status = flushing_ ? tsfn_.BlockingCall(audioData, callJs) : tsfn_.NonBlockingCall(audioData, callJs);
+    
+    if (status == napi_queue_full) {
+        span.flowOut(0);
+        metrics_->chunkDequeued();
+        chunk = std::move(audioData->samples);
+        delete audioData;
+        return false;
     }
+    if (status != napi_ok) {
+        // Shutting down: nobody is listening any more
+        metrics_->chunkDequeued();
+        delete audioData;
+    }
+    return true;
+}
+
+// Run fn on the JS thread, behind every chunk already queued. Completion
+// handlers may run on the main thread, which in Electron is the JS thread
+// and must never wait on its own queue, so this hops to a background queue.
+void AudioCaptureAddon::PostToJs(std::function<void(Napi::Env)> fn) {
+    Napi::ThreadSafeFunction tsfn = tsfn_;
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+        tsfn.BlockingCall([fn](Napi::Env env, Napi::Function) { fn(env); });
+    });
+}
+
+void AudioCaptureAddon::StartFailed(const std::string& error) {
+    AudioCaptureAddon* self = this;
+    PostToJs([self, error](Napi::Env env) { self->OnStarted(env, false, error); });
+}
+
+void AudioCaptureAddon::OnStarted(Napi::Env env, bool ok, const std::string& error) {
+    std::unique_ptr<Napi::Promise::Deferred> deferred = std::move(startDeferred_);
+    if (ok) {
+        state_ = State::Running;
+        isCapturing_ = true;
+        deferred->Resolve(Napi::Boolean::New(env, true));
+    } else {
+        state_ = State::Idle;
+        isCapturing_ = false;
+        delivery_->stop();
+        deferred->Reject(Napi::Error::New(env, error).Value());
+    }
+    Unref();
     
-    // Copy data for thread safety
-    std::vector<float> audioData(data, data + length);
-    
-    try {
-        // Check if thread-safe function is valid before calling
-        if (!tsfn_) {
-            return;
+    // stop() called while starting
+    if (!stopDeferreds_.empty()) {
+        if (ok) {
+            BeginStop();
+        } else {
+            OnStopped(env);
         }
-        
-        tsfn_.NonBlockingCall([audioData](Napi::Env env, Napi::Function jsCallback) {
-            try {
-                if (jsCallback.IsEmpty() || jsCallback.IsUndefined()) {
-                    return;
-                }
-                // Convert to Buffer for efficient transfer
-                Napi::Buffer<float> buffer = Napi::Buffer<float>::Copy(env, audioData.data(), audioData.size());
-                jsCallback.Call({buffer});
-            } catch (const Napi::Error& e) {
-                // Log but don't crash - this happens in JS thread
-                // Can't use NSLog from JS thread, so just ignore
-            } catch (...) {
-                // Ignore other errors
+    }
+}
+
+void AudioCaptureAddon::BeginStop() {
+    NSLog(@"🛑 Stopping capture...");
+    state_ = State::Stopping;
+    isCapturing_ = false;
+    
+    AudioCaptureAddon* self = this;
+    if (stream_) {
+        [stream_ stopCaptureWithCompletionHandler:^(NSError* error) {
+            if (error) {
+                NSLog(@"⚠️ Error stopping capture: %@", error.localizedDescription);
+            } else {
+                NSLog(@"✅ Stream stopped successfully");
             }
-        });
-    } catch (const Napi::Error& e) {
-        // This can happen if the thread-safe function is invalid
-        // Don't log here as it's expected during shutdown
-    } catch (const std::exception& e) {
-        // Don't log here as it's expected during shutdown
-    } catch (...) {
-        // Ignore other errors
+            self->FinishStopAsync();
+        }];
+    } else {
+        FinishStopAsync();
+    }
+}
+
+// The stream has stopped: queue what is left in the ring, then the
+// completion, on a background queue (see PostToJs)
+void AudioCaptureAddon::FinishStopAsync() {
+    AudioCaptureAddon* self = this;
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+        self->flushing_ = true;
+        self->delivery_->stop();
+        self->flushing_ = false;
+        self->tsfn_.BlockingCall([self](Napi::Env env, Napi::Function) { self->OnStopped(env); });
+    });
+}
+
+void AudioCaptureAddon::OnStopped(Napi::Env env) {
+    stream_ = nil;
+    outputHandler_ = nil;
+    state_ = State::Idle;
+    NSLog(@"✅ Stop completed");
+    
+    std::vector<std::unique_ptr<Napi::Promise::Deferred>> deferreds = std::move(stopDeferreds_);
+    stopDeferreds_.clear();
+    for (auto& deferred : deferreds) {
+        deferred->Resolve(env.Undefined());
+    }
+    if (!deferreds.empty()) {
+        Unref();
     }
 }
 
@@ -358,7 +465,7 @@ void AudioCaptureAddon::StartCaptureAsync() {
             Class shareableContentClass = NSClassFromString(@"SCShareableContent");
             if (!shareableContentClass) {
                 NSLog(@"❌ SCShareableContent class not found");
-                blockSelf->isCapturing_ = false;
+                blockSelf->StartFailed("ScreenCaptureKit is not available");
                 return;
             }
             
@@ -378,13 +485,13 @@ void AudioCaptureAddon::StartCaptureAsync() {
                             }
                             if (error) {
                                 NSLog(@"❌ Error getting shareable content: %@", error.localizedDescription);
-                                blockSelf->isCapturing_ = false;
+                                blockSelf->StartFailed(std::string("Error getting shareable content: ") + error.localizedDescription.UTF8String);
                                 return;
                             }
                             
                             if (!content) {
                                 NSLog(@"❌ No shareable content returned");
-                                blockSelf->isCapturing_ = false;
+                                blockSelf->StartFailed("No shareable content returned");
                                 return;
                             }
                             
@@ -392,19 +499,33 @@ void AudioCaptureAddon::StartCaptureAsync() {
                             
                             if (content.displays.count == 0) {
                                 NSLog(@"❌ No displays available");
-                                blockSelf->isCapturing_ = false;
+                                blockSelf->StartFailed("No displays available");
                                 return;
                             }
                             
-                            // Get first display
+                            // The requested display, else the first one
                             SCDisplay* display = content.displays.firstObject;
+                            if (blockSelf->displayId_ != 0) {
+                                display = nil;
+                                for (SCDisplay* candidate in content.displays) {
+                                    if (candidate.displayID == blockSelf->displayId_) {
+                                        display = candidate;
+                                        break;
+                                    }
+                                }
+                                if (!display) {
+                                    NSLog(@"❌ Display %u not found", blockSelf->displayId_);
+                                    blockSelf->StartFailed("Display " + std::to_string(blockSelf->displayId_) + " not found");
+                                    return;
+                                }
+                            }
                             NSLog(@"🖥️ Using display: %u", (unsigned int)display.displayID);
                             
                             // Create content filter
                             SCContentFilter* filter = [[SCContentFilter alloc] initWithDisplay:display excludingWindows:@[]];
                             if (!filter) {
                                 NSLog(@"❌ Failed to create content filter");
-                                blockSelf->isCapturing_ = false;
+                                blockSelf->StartFailed("Failed to create content filter");
                                 return;
                             }
                             
@@ -415,22 +536,23 @@ void AudioCaptureAddon::StartCaptureAsync() {
                             config.channelCount = 1;
                             NSLog(@"⚙️ Stream config: audio=YES, sampleRate=16000, channels=1");
                             
-                            // Create output handler with weak reference check
+                            // Create output handler. It only copies into this
+                            // capture's ring (ignored once delivery has stopped),
+                            // and keeps the ring alive for as long as the stream
+                            // may still call it
                             StreamOutputHandler* handler = [[StreamOutputHandler alloc] init];
+                            std::shared_ptr<capture::CaptureDelivery> delivery = blockSelf->delivery_;
                             handler.callback = ^(const float* data, size_t length) {
-                                // Use global instance pointer and check if still valid
-                                AudioCaptureAddon* instance = g_captureInstance;
-                                if (instance && instance->isCapturing_ && length > 0) {
-                                    instance->OnAudioData(data, length);
-                                }
+                                delivery->push(data, length);
                             };
+                            [handler setMetrics:blockSelf->metrics_];
                             
                             // Create stream - retain it immediately
                             SCStream* stream = [[SCStream alloc] initWithFilter:filter configuration:config delegate:nil];
                             
                             if (!stream) {
                                 NSLog(@"❌ Failed to create stream");
-                                blockSelf->isCapturing_ = false;
+                                blockSelf->StartFailed("Failed to create stream");
                                 return;
                             }
                             
@@ -446,9 +568,9 @@ void AudioCaptureAddon::StartCaptureAsync() {
                             
                             if (!added || outputError) {
                                 NSLog(@"❌ Error adding stream output: %@", outputError ? outputError.localizedDescription : @"Unknown error");
-                                blockSelf->isCapturing_ = false;
                                 blockSelf->stream_ = nil;
                                 blockSelf->outputHandler_ = nil;
+                                blockSelf->StartFailed(outputError ? std::string("Error adding stream output: ") + outputError.localizedDescription.UTF8String : "Error adding stream output");
                                 return;
                             }
                             
@@ -459,16 +581,12 @@ void AudioCaptureAddon::StartCaptureAsync() {
                             [stream startCaptureWithCompletionHandler:^(NSError* startError) {
                                 if (startError) {
                                     NSLog(@"❌ Error starting capture: %@", startError.localizedDescription);
-                                    if (captureSelf) {
-                                        captureSelf->isCapturing_ = false;
-                                        captureSelf->stream_ = nil;
-                                        captureSelf->outputHandler_ = nil;
-                                    }
+                                    captureSelf->stream_ = nil;
+                                    captureSelf->outputHandler_ = nil;
+                                    captureSelf->StartFailed(std::string("Error starting capture: ") + startError.localizedDescription.UTF8String);
                                 } else {
                                     NSLog(@"✅ Native macOS audio capture started successfully");
-                                    if (captureSelf) {
-                                        captureSelf->isCapturing_ = true;
-                                    }
+                                    captureSelf->PostToJs([captureSelf](Napi::Env env) { captureSelf->OnStarted(env, true, std::string()); });
                                 }
                             }];
                         } copy]; // Copy the block to heap
@@ -484,7 +602,7 @@ void AudioCaptureAddon::StartCaptureAsync() {
                         NSMethodSignature* sig = [shareableContentClass methodSignatureForSelector:getContentSelector];
                         if (!sig) {
                             NSLog(@"❌ Method signature not found for getShareableContentWithCompletionHandler:");
-                            blockSelf->isCapturing_ = false;
+                            blockSelf->StartFailed("getShareableContentWithCompletionHandler: signature not found");
                             return;
                         }
                         
@@ -500,112 +618,82 @@ void AudioCaptureAddon::StartCaptureAsync() {
                         return;
                     } else {
                         NSLog(@"❌ getShareableContentWithCompletionHandler: method not found");
-                        blockSelf->isCapturing_ = false;
+                        blockSelf->StartFailed("getShareableContentWithCompletionHandler: not found");
                         return;
                     }
         }
     });
 }
 
+// Resolves true once the stream is running (false if already started),
+// rejects if it could not be started
 Napi::Value AudioCaptureAddon::Start(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
     
-    if (isCapturing_) {
-        return Napi::Boolean::New(env, false);
+    if (state_ != State::Idle) {
+        Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+        deferred.Resolve(Napi::Boolean::New(env, false));
+        return deferred.Promise();
     }
     
+    state_ = State::Starting;
+    startDeferred_ = std::make_unique<Napi::Promise::Deferred>(Napi::Promise::Deferred::New(env));
+    Napi::Promise promise = startDeferred_->Promise();
+    Ref();
+    
     // Start native ScreenCaptureKit capture
+    delivery_->start();
     StartCaptureAsync();
-    
-    // Return true - we're attempting native capture
-    // The actual success will be determined asynchronously
-    return Napi::Boolean::New(env, true);
+    return promise;
 }
 
+// Resolves once the stream has stopped and every chunk captured before that
+// has been passed to the callback
 Napi::Value AudioCaptureAddon::Stop(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
     
-    if (!isCapturing_) {
-        NSLog(@"⚠️ Stop called but not capturing");
-        return env.Undefined();
+    std::unique_ptr<Napi::Promise::Deferred> deferred =
+        std::make_unique<Napi::Promise::Deferred>(Napi::Promise::Deferred::New(env));
+    Napi::Promise promise = deferred->Promise();
+    if (state_ == State::Idle) {
+        deferred->Resolve(env.Undefined());
+        return promise;
     }
     
-    NSLog(@"🛑 Stopping capture...");
-    
-    // Mark as not capturing immediately to stop callbacks
-    isCapturing_ = false;
-    
-    if (stream_) {
-        __block SCStream* streamToStop = stream_;
-        __block BOOL stopCompleted = NO;
-        
-        // Check if we're on the main queue
-        if ([NSThread isMainThread]) {
-            // Already on main thread, execute directly
-            @autoreleasepool {
-                [streamToStop stopCaptureWithCompletionHandler:^(NSError* error) {
-                    if (error) {
-                        NSLog(@"⚠️ Error stopping capture: %@", error.localizedDescription);
-                    } else {
-                        NSLog(@"✅ Stream stopped successfully");
-                    }
-                    stopCompleted = YES;
-                }];
-                
-                // Wait for completion with timeout
-                NSDate* timeout = [NSDate dateWithTimeIntervalSinceNow:0.5];
-                while (!stopCompleted && [timeout timeIntervalSinceNow] > 0) {
-                    [[NSRunLoop currentRunLoop] runMode:NSDefaultRunLoopMode beforeDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
-                }
-                
-                if (!stopCompleted) {
-                    NSLog(@"⚠️ Stop completion handler timed out, continuing anyway");
-                }
-            }
-        } else {
-            // Not on main thread, use dispatch_sync
-            dispatch_sync(dispatch_get_main_queue(), ^{
-                @autoreleasepool {
-                    [streamToStop stopCaptureWithCompletionHandler:^(NSError* error) {
-                        if (error) {
-                            NSLog(@"⚠️ Error stopping capture: %@", error.localizedDescription);
-                        } else {
-                            NSLog(@"✅ Stream stopped successfully");
-                        }
-                        stopCompleted = YES;
-                    }];
-                    
-                    // Wait for completion with timeout
-                    NSDate* timeout = [NSDate dateWithTimeIntervalSinceNow:0.5];
-                    while (!stopCompleted && [timeout timeIntervalSinceNow] > 0) {
-                        [[NSRunLoop currentRunLoop] runMode:NSDefaultRunLoopMode beforeDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
-                    }
-                    
-                    if (!stopCompleted) {
-                        NSLog(@"⚠️ Stop completion handler timed out, continuing anyway");
-                    }
-                }
-            });
-        }
-        
-        // Small delay to ensure all callbacks have finished
-        usleep(50000); // 50ms
+    if (stopDeferreds_.empty()) {
+        Ref();
     }
-    
-    stream_ = nil;
-    outputHandler_ = nil;
-    
-    NSLog(@"✅ Stop completed");
-    return env.Undefined();
+    stopDeferreds_.push_back(std::move(deferred));
+    // Starting: OnStarted() stops; Stopping: already on its way
+    if (state_ == State::Running) {
+        BeginStop();
+    }
+    return promise;
 }
 
 Napi::Value AudioCaptureAddon::IsActive(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
-    return Napi::Boolean::New(env, isCapturing_);
+    return Napi::Boolean::New(env, isCapturing_.load());
+}
+
+Napi::Value AudioCaptureAddon::GetStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    const capture::DeliveryStats delivery = delivery_->stats();
+    
+    Napi::Object stats = Napi::Object::New(env);
+    stats.Set("displayId", Napi::Number::New(env, displayId_));
+    stats.Set("samplesIn", Napi::Number::New(env, static_cast<double>(delivery.samplesIn)));
+    stats.Set("samplesDelivered", Napi::Number::New(env, static_cast<double>(delivery.samplesDelivered)));
+    stats.Set("samplesDropped", Napi::Number::New(env, static_cast<double>(delivery.samplesDropped)));
+    stats.Set("chunks", Napi::Number::New(env, static_cast<double>(delivery.chunks)));
+    stats.Set("bufferedMs", Napi::Number::New(env, delivery.buffered * 1000.0 / delivery_->config().sampleRate));
+    capture::setCaptureMetrics(env, stats, delivery, *metrics_, capture::statsResetRequested(info));
+    return stats;
 }
 
 Napi::Object Init(Napi::Env env, Napi::Object exports) {
     AudioCaptureAddon::Init(env, exports);
+    trace::initNapi(env, exports);
     return exports;
 }
 
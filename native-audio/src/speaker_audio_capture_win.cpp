@@ -7,8 +7,21 @@
 #include <vector>
 #include <thread>
 #include <atomic>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
 #include <iostream>
 
+#include "capture/capture_delivery.h"
+#include "capture/capture_metrics.h"
+#include "capture/napi_stats.h"
+#include "capture/realtime_check.h"
+#include "capture/sample_format.h"
+#include "trace/trace.h"
+#include "trace/trace_napi.h"
+
 // Link required COM libraries
 #pragma comment(lib, "ole32.lib")
 #pragma comment(lib, "oleaut32.lib")
@@ -38,10 +51,27 @@ private:
     bool initialized_;
 };
 
-// Forward declaration
-class AudioCaptureAddon;
+// Chunks queued towards the JS thread before the delivery thread leaves new
+// audio in the ring
+static const size_t kMaxQueuedChunks = 4;
+
+static std::wstring Utf8ToWide(const std::string& text) {
+    if (text.empty()) return std::wstring();
+    int length = MultiByteToWideChar(CP_UTF8, 0, text.c_str(), (int)text.size(), NULL, 0);
+    std::wstring wide(length, L'\0');
+    MultiByteToWideChar(CP_UTF8, 0, text.c_str(), (int)text.size(), &wide[0], length);
+    return wide;
+}
+
+static std::string FormatError(const char* what, HRESULT hr) {
+    char code[16];
+    snprintf(code, sizeof(code), "0x%08lx", (unsigned long)hr);
+    return std::string(what) + " (" + code + ")";
+}
 
-// Main addon class
+// Main addon class. Each instance owns its endpoint, capture thread, ring and
+// delivery thread; nothing is shared between instances, environments or
+// worker threads.
 class AudioCaptureAddon : public Napi::ObjectWrap<AudioCaptureAddon> {
 public:
     static Napi::Object Init(Napi::Env env, Napi::Object exports);
@@ -49,12 +79,26 @@ public:
     ~AudioCaptureAddon();
 
 private:
-    static Napi::FunctionReference constructor;
+    // JS thread only; the instance is Ref()'d while starting or stopping
+    enum class State { Idle, Starting, Running, Stopping };
     
     std::atomic<bool> isCapturing_;
+    std::atomic<bool> stopRequested_;   // stop(): flush the ring and report back
+    std::atomic<bool> flushing_;        // the delivery thread may block on the queue
+    std::atomic<bool> closing_;         // destructor: the JS thread is not listening
+    State state_;
+    std::unique_ptr<Napi::Promise::Deferred> startDeferred_;
+    std::vector<std::unique_ptr<Napi::Promise::Deferred>> stopDeferreds_;
     std::thread captureThread_;
     Napi::ThreadSafeFunction tsfn_;
     Napi::FunctionReference callback_;
+    std::string deviceId_;              // empty: default render endpoint
+    std::atomic<int> sampleRate_;       // endpoint mix format, once known
+    std::atomic<int> channels_;
+    capture::DeliveryConfig deliveryConfig_;
+    std::unique_ptr<capture::CaptureDelivery> delivery_;  // replaced by the capture thread
+    std::mutex deliveryMutex_;          // guards replacing delivery_ against getStats()
+    capture::PacketConverter converter_;  // capture thread only
     
     // COM objects
     IMMDeviceEnumerator* pEnumerator_;
@@ -62,51 +106,85 @@ private:
     IAudioClient* pAudioClient_;
     IAudioCaptureClient* pCaptureClient_;
     
+    std::shared_ptr<capture::CaptureMetrics> metrics_;  // for the instance's lifetime, across starts
+    
     Napi::Value Start(const Napi::CallbackInfo& info);
     Napi::Value Stop(const Napi::CallbackInfo& info);
     Napi::Value IsActive(const Napi::CallbackInfo& info);
+    Napi::Value GetStats(const Napi::CallbackInfo& info);
     
+    bool DeliverChunk(std::vector<float>& chunk);
     void CaptureThreadFunc();
     void CleanupCOM();
+    
+    void PostToJs(std::function<void(Napi::Env)> fn);
+    void StartFailed(const std::string& error);
+    void OnStarted(Napi::Env env, bool ok, const std::string& error);
+    void BeginStop();
+    void OnStopped(Napi::Env env);
 };
 
-Napi::FunctionReference AudioCaptureAddon::constructor;
-
 Napi::Object AudioCaptureAddon::Init(Napi::Env env, Napi::Object exports) {
     Napi::Function func = DefineClass(env, "AudioCapture", {
         InstanceMethod("start", &AudioCaptureAddon::Start),
         InstanceMethod("stop", &AudioCaptureAddon::Stop),
         InstanceMethod("isActive", &AudioCaptureAddon::IsActive),
+        InstanceMethod("getStats", &AudioCaptureAddon::GetStats),
     });
     
-    constructor = Napi::Persistent(func);
-    constructor.SuppressDestruct();
+    Napi::FunctionReference* constructor = new Napi::FunctionReference();
+    *constructor = Napi::Persistent(func);
+    env.SetInstanceData(constructor);
     
     exports.Set("AudioCapture", func);
     return exports;
 }
 
+// new AudioCapture(callback, { deviceId, ringMs, chunkMs })
 AudioCaptureAddon::AudioCaptureAddon(const Napi::CallbackInfo& info)
     : Napi::ObjectWrap<AudioCaptureAddon>(info),
       isCapturing_(false),
+      stopRequested_(false),
+      flushing_(false),
+      closing_(false),
+      state_(State::Idle),
+      sampleRate_(0),
+      channels_(0),
       pEnumerator_(nullptr),
       pDevice_(nullptr),
       pAudioClient_(nullptr),
-      pCaptureClient_(nullptr) {
+      pCaptureClient_(nullptr),
+      metrics_(std::make_shared<capture::CaptureMetrics>()) {
     
     Napi::Env env = info.Env();
     
-    // Create thread-safe function for callbacks
-    if (info.Length() > 0 && info[0].IsFunction()) {
+    if (info.Length() > 1 && info[1].IsObject()) {
+        Napi::Object options = info[1].As<Napi::Object>();
+        if (options.Get("deviceId").IsString()) {
+            deviceId_ = options.Get("deviceId").As<Napi::String>().Utf8Value();
+        }
+        if (options.Get("ringMs").IsNumber()) {
+            deliveryConfig_.ringMs = options.Get("ringMs").As<Napi::Number>().Int32Value();
+        }
+        if (options.Get("chunkMs").IsNumber()) {
+            deliveryConfig_.chunkMs = options.Get("chunkMs").As<Napi::Number>().Int32Value();
+        }
+    }
+    
+    // Create thread-safe function for callbacks. It also carries start/stop
+    // completions, so it exists even without a callback.
+    {
         try {
-            Napi::Function cb = info[0].As<Napi::Function>();
+            Napi::Function cb = info.Length() > 0 && info[0].IsFunction()
+                ? info[0].As<Napi::Function>()
+                : Napi::Function::New(env, [](const Napi::CallbackInfo&) {});
             callback_ = Napi::Persistent(cb);
             
             tsfn_ = Napi::ThreadSafeFunction::New(
                 env,
                 cb,
                 "AudioCapture",
-                0,
+                kMaxQueuedChunks,
                 1
             );
         } catch (const Napi::Error& e) {
@@ -120,16 +198,21 @@ AudioCaptureAddon::AudioCaptureAddon(const Napi::CallbackInfo& info)
 AudioCaptureAddon::~AudioCaptureAddon() {
     std::cout << "Destructor called, cleaning up..." << std::endl;
     
-    // Stop capture if running
-    if (isCapturing_) {
-        isCapturing_ = false;
-        if (captureThread_.joinable()) {
-            captureThread_.join();
-        }
+    // Stop capture if running. A pending start() or stop() holds a
+    // reference, so nothing waits for this thread's completions.
+    closing_ = true;
+    isCapturing_ = false;
+    if (captureThread_.joinable()) {
+        captureThread_.join();
     }
     
     CleanupCOM();
     
+    // The delivery thread calls into tsfn_, so it stops first
+    if (delivery_) {
+        delivery_->stop();
+    }
+    
     // Release thread-safe function
     try {
         if (tsfn_) {
@@ -161,12 +244,126 @@ void AudioCaptureAddon::CleanupCOM() {
     }
 }
 
+// Delivery thread: queue a chunk for the JS callback. While capturing this
+// never blocks; a full queue leaves the chunk with the delivery thread for
+// its next pass. The final flush of stop() waits for room instead, so every
+// buffered chunk is queued before the stop completion.
+bool AudioCaptureAddon::DeliverChunk(std::vector<float>& chunk) {
+    if (!tsfn_) {
+        return true;
+    }
+    trace::setThreadName("capture delivery");
+    trace::Scope span("deliver chunk", "samples", static_cast<int64_t>(chunk.size()));
+    
+    auto callJs = [](Napi::Env env, Napi::Function jsCallback, capture::QueuedChunk* data) {
+        capture::CaptureMetrics& metrics = *data->metrics;
+        metrics.chunkDequeued();
+        if (!jsCallback.IsEmpty() && !jsCallback.IsUndefined()) {
+            trace::Scope span("js callback", "samples", static_cast<int64_t>(data->samples.size()));
+            span.flowIn(data->flowId);
+            const int64_t calledNs = capture::steadyNowNs();
+            metrics.delivery.record(calledNs - data->capturedNs);
+            // Convert to Buffer for efficient transfer
+            Napi::Buffer<float> buffer = Napi::Buffer<float>::Copy(env, data->samples.data(), data->samples.size());
+            metrics.bytesOut.fetch_add(data->samples.size() * sizeof(float), std::memory_order_relaxed);
+            jsCallback.Call({buffer});
+            metrics.jsHandler.record(capture::steadyNowNs() - calledNs);
+        }
+        delete data;
+    };
+    // An arrow from here to the JS callback that receives the chunk
+    const uint64_t flowId = span.active() ? trace::newId() : 0;
+    span.flowOut(flowId);
+    capture::QueuedChunk* audioData =
+        new capture::QueuedChunk{std::move(chunk), delivery_->chunkCapturedNs(), metrics_, flowId};
+    metrics_->chunkQueued();
+    napi_status status = flushing_ ? tsfn_.BlockingCall(audioData, callJs) : tsfn_.NonBlockingCall(audioData, callJs);
+    
+    if (status == napi_queue_full) {
+        span.flowOut(0);
+        metrics_->chunkDequeued();
+        chunk = std::move(audioData->samples);
+        delete audioData;
+        return false;
+    }
+    if (status != napi_ok) {
+        // Shutting down: nobody is listening any more
+        metrics_->chunkDequeued();
+        delete audioData;
+    }
+    return true;
+}
+
+// Capture thread: run fn on the JS thread, behind every chunk already
+// queued. Waits for room in the queue without blocking on it, so the
+// destructor (on the JS thread) can always join this thread.
+void AudioCaptureAddon::PostToJs(std::function<void(Napi::Env)> fn) {
+    auto callJs = [fn](Napi::Env env, Napi::Function) { fn(env); };
+    while (!closing_ && tsfn_.NonBlockingCall(callJs) == napi_queue_full) {
+        Sleep(1);
+    }
+}
+
+void AudioCaptureAddon::StartFailed(const std::string& error) {
+    std::cerr << "Capture not started: " << error << std::endl;
+    isCapturing_ = false;
+    AudioCaptureAddon* self = this;
+    PostToJs([self, error](Napi::Env env) { self->OnStarted(env, false, error); });
+}
+
+void AudioCaptureAddon::OnStarted(Napi::Env env, bool ok, const std::string& error) {
+    std::unique_ptr<Napi::Promise::Deferred> deferred = std::move(startDeferred_);
+    if (ok) {
+        state_ = State::Running;
+        deferred->Resolve(Napi::Boolean::New(env, true));
+    } else {
+        // The capture thread has exited on its own
+        state_ = State::Idle;
+        deferred->Reject(Napi::Error::New(env, error).Value());
+    }
+    Unref();
+    
+    // stop() called while starting
+    if (!stopDeferreds_.empty()) {
+        if (ok) {
+            BeginStop();
+        } else {
+            OnStopped(env);
+        }
+    }
+}
+
+void AudioCaptureAddon::BeginStop() {
+    std::cout << "Stopping capture..." << std::endl;
+    state_ = State::Stopping;
+    stopRequested_ = true;
+    
+    // Signal the thread to stop; it reports back through OnStopped()
+    isCapturing_ = false;
+}
+
+// Also reached when the capture thread ends on its own (device lost)
+void AudioCaptureAddon::OnStopped(Napi::Env env) {
+    state_ = State::Idle;
+    isCapturing_ = false;
+    std::cout << "Stop completed" << std::endl;
+    
+    std::vector<std::unique_ptr<Napi::Promise::Deferred>> deferreds = std::move(stopDeferreds_);
+    stopDeferreds_.clear();
+    for (auto& deferred : deferreds) {
+        deferred->Resolve(env.Undefined());
+    }
+    if (!deferreds.empty()) {
+        Unref();
+    }
+}
+
 void AudioCaptureAddon::CaptureThreadFunc() {
     // Initialize COM for this thread
     COMInitializer comInit;
     if (!comInit.IsInitialized()) {
         std::cerr << "Failed to initialize COM in capture thread" << std::endl;
-        isCapturing_ = false;
+        StartFailed("Failed to initialize COM in capture thread");
         return;
     }
     
@@ -183,24 +380,37 @@ void AudioCaptureAddon::CaptureThreadFunc() {
     
     if (FAILED(hr)) {
         std::cerr << "Failed to create device enumerator: " << std::hex << hr << std::endl;
-        isCapturing_ = false;
+        StartFailed(FormatError("Failed to create device enumerator", hr));
         return;
     }
     
-    // Get default audio endpoint (speakers/headphones for loopback)
-    hr = pEnumerator_->GetDefaultAudioEndpoint(
-        eRender,  // Use render endpoint for loopback recording
-        eConsole,
-        &pDevice_
-    );
+    if (deviceId_.empty()) {
+        // Get default audio endpoint (speakers/headphones for loopback)
+        hr = pEnumerator_->GetDefaultAudioEndpoint(
+            eRender,  // Use render endpoint for loopback recording
+            eConsole,
+            &pDevice_
+        );
+    } else {
+        hr = pEnumerator_->GetDevice(Utf8ToWide(deviceId_).c_str(), &pDevice_);
+    }
     
     if (FAILED(hr)) {
-        std::cerr << "Failed to get default audio endpoint: " << std::hex << hr << std::endl;
+        std::cerr << "Failed to get audio endpoint " << (deviceId_.empty() ? "(default)" : deviceId_)
+                  << ": " << std::hex << hr << std::endl;
         CleanupCOM();
-        isCapturing_ = false;
+        StartFailed(FormatError("Failed to get audio endpoint", hr));
         return;
     }
     
+    // Render endpoints are captured in loopback, capture endpoints directly
+    EDataFlow dataFlow = eRender;
+    IMMEndpoint* pEndpoint = nullptr;
+    if (SUCCEEDED(pDevice_->QueryInterface(__uuidof(IMMEndpoint), (void**)&pEndpoint))) {
+        pEndpoint->GetDataFlow(&dataFlow);
+        pEndpoint->Release();
+    }
+    
     // Activate audio client
     hr = pDevice_->Activate(
         __uuidof(IAudioClient),
@@ -212,7 +422,7 @@ void AudioCaptureAddon::CaptureThreadFunc() {
     if (FAILED(hr)) {
         std::cerr << "Failed to activate audio client: " << std::hex << hr << std::endl;
         CleanupCOM();
-        isCapturing_ = false;
+        StartFailed(FormatError("Failed to activate audio client", hr));
         return;
     }
     
@@ -223,7 +433,7 @@ void AudioCaptureAddon::CaptureThreadFunc() {
     if (FAILED(hr)) {
         std::cerr << "Failed to get mix format: " << std::hex << hr << std::endl;
         CleanupCOM();
-        isCapturing_ = false;
+        StartFailed(FormatError("Failed to get mix format", hr));
         return;
     }
     
@@ -231,10 +441,10 @@ void AudioCaptureAddon::CaptureThreadFunc() {
               << ", channels=" << pwfx->nChannels 
               << ", bits=" << pwfx->wBitsPerSample << std::endl;
     
-    // Initialize audio client in loopback mode
+    // Initialize audio client (loopback mode for render endpoints)
     hr = pAudioClient_->Initialize(
         AUDCLNT_SHAREMODE_SHARED,
-        AUDCLNT_STREAMFLAGS_LOOPBACK,  // Loopback flag to capture system audio
+        dataFlow == eRender ? AUDCLNT_STREAMFLAGS_LOOPBACK : 0,  // Loopback flag to capture system audio
         10000000,  // 1 second buffer
         0,
         pwfx,
@@ -245,7 +455,7 @@ void AudioCaptureAddon::CaptureThreadFunc() {
         std::cerr << "Failed to initialize audio client: " << std::hex << hr << std::endl;
         CoTaskMemFree(pwfx);
         CleanupCOM();
-        isCapturing_ = false;
+        StartFailed(FormatError("Failed to initialize audio client", hr));
         return;
     }
     
@@ -259,7 +469,7 @@ void AudioCaptureAddon::CaptureThreadFunc() {
         std::cerr << "Failed to get capture client: " << std::hex << hr << std::endl;
         CoTaskMemFree(pwfx);
         CleanupCOM();
-        isCapturing_ = false;
+        StartFailed(FormatError("Failed to get capture client", hr));
         return;
     }
     
@@ -270,18 +480,52 @@ void AudioCaptureAddon::CaptureThreadFunc() {
         std::cerr << "Failed to start audio client: " << std::hex << hr << std::endl;
         CoTaskMemFree(pwfx);
         CleanupCOM();
-        isCapturing_ = false;
+        StartFailed(FormatError("Failed to start audio client", hr));
         return;
     }
     
     std::cout << "Windows audio capture started successfully" << std::endl;
+    AudioCaptureAddon* self = this;
+    PostToJs([self](Napi::Env env) { self->OnStarted(env, true, std::string()); });
     
     // Calculate bytes per sample
     UINT32 bytesPerSample = pwfx->wBitsPerSample / 8;
     UINT32 channels = pwfx->nChannels;
+    sampleRate_ = (int)pwfx->nSamplesPerSec;
+    channels_ = (int)channels;
+    
+    // The ring is sized for this endpoint's format; it lives as long as the
+    // capture thread that feeds it
+    deliveryConfig_.sampleRate = (int)pwfx->nSamplesPerSec;
+    deliveryConfig_.channels = (int)channels;
+    {
+        std::lock_guard<std::mutex> lock(deliveryMutex_);
+        delivery_.reset(new capture::CaptureDelivery(
+            deliveryConfig_, [this](std::vector<float>& chunk) { return DeliverChunk(chunk); }));
+    }
+    delivery_->start();
     bool isFloat = (pwfx->wFormatTag == WAVE_FORMAT_IEEE_FLOAT) || 
                    (pwfx->wFormatTag == WAVE_FORMAT_EXTENSIBLE && 
                     reinterpret_cast<WAVEFORMATEXTENSIBLE*>(pwfx)->SubFormat == KSDATAFORMAT_SUBTYPE_IEEE_FLOAT);
+    capture::SampleFormat format = capture::SampleFormat::Unsupported;
+    if (isFloat && bytesPerSample == 4) {
+        format = capture::SampleFormat::Float32;
+    } else if (!isFloat && bytesPerSample == 2) {
+        format = capture::SampleFormat::Int16;
+    } else if (!isFloat && bytesPerSample == 4) {
+        format = capture::SampleFormat::Int32;
+    } else {
+        std::cerr << "Unsupported capture format (" << pwfx->wBitsPerSample << "-bit), packets are skipped" << std::endl;
+    }
+    
+    // No packet is larger than the endpoint buffer, so the loop never
+    // allocates
+    UINT32 bufferFrames = 0;
+    if (SUCCEEDED(pAudioClient_->GetBufferSize(&bufferFrames))) {
+        converter_.reserve((size_t)bufferFrames * channels);
+    }
+    
+    trace::setThreadName("wasapi capture");
     
     // Capture loop
     while (isCapturing_) {
@@ -314,44 +558,17 @@ void AudioCaptureAddon::CaptureThreadFunc() {
             }
             
             if (numFramesAvailable > 0 && !(flags & AUDCLNT_BUFFERFLAGS_SILENT)) {
-                // Convert audio data to float32
+                capture::RealtimeScope realtime("wasapi capture");
+                trace::Scope span("wasapi packet", "frames", numFramesAvailable);
+                const int64_t packetStart = capture::steadyNowNs();
                 size_t totalSamples = numFramesAvailable * channels;
-                std::vector<float> audioData(totalSamples);
-                
-                if (isFloat && bytesPerSample == 4) {
-                    // Already float32
-                    memcpy(audioData.data(), pData, totalSamples * sizeof(float));
-                } else if (!isFloat && bytesPerSample == 2) {
-                    // Convert int16 to float
-                    int16_t* int16Data = reinterpret_cast<int16_t*>(pData);
-                    for (size_t i = 0; i < totalSamples; i++) {
-                        audioData[i] = int16Data[i] / 32768.0f;
-                    }
-                } else if (!isFloat && bytesPerSample == 4) {
-                    // Convert int32 to float
-                    int32_t* int32Data = reinterpret_cast<int32_t*>(pData);
-                    for (size_t i = 0; i < totalSamples; i++) {
-                        audioData[i] = int32Data[i] / 2147483648.0f;
-                    }
-                }
+                const float* audioData = converter_.convert(pData, totalSamples, format);
                 
-                // Send to JavaScript via thread-safe function
-                if (tsfn_ && isCapturing_) {
-                    tsfn_.NonBlockingCall([audioData](Napi::Env env, Napi::Function jsCallback) {
-                        try {
-                            if (jsCallback.IsEmpty() || jsCallback.IsUndefined()) {
-                                return;
-                            }
-                            // Convert to Buffer for efficient transfer
-                            Napi::Buffer<float> buffer = Napi::Buffer<float>::Copy(env, audioData.data(), audioData.size());
-                            jsCallback.Call({buffer});
-                        } catch (const Napi::Error& e) {
-                            // Ignore errors during callback
-                        } catch (...) {
-                            // Ignore other errors
-                        }
-                    });
+                // Into this capture's ring; the delivery thread sends it on
+                if (audioData && isCapturing_) {
+                    delivery_->push(audioData, totalSamples);
                 }
+                metrics_->callback.record(capture::steadyNowNs() - packetStart);
             }
             
             hr = pCaptureClient_->ReleaseBuffer(numFramesAvailable);
@@ -378,43 +595,68 @@ void AudioCaptureAddon::CaptureThreadFunc() {
     CoTaskMemFree(pwfx);
     CleanupCOM();
     
+    // Hand over what is still in the ring (all of it, after stop()), then
+    // stop the delivery thread and report back
+    flushing_ = stopRequested_.load() && !closing_;
+    delivery_->stop();
+    flushing_ = false;
+    
     std::cout << "Capture thread completed" << std::endl;
+    PostToJs([self](Napi::Env env) { self->OnStopped(env); });
 }
 
+// Resolves true once the endpoint is capturing (false if already started),
+// rejects if it could not be opened
 Napi::Value AudioCaptureAddon::Start(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
     
-    if (isCapturing_) {
-        return Napi::Boolean::New(env, false);
+    if (state_ != State::Idle) {
+        Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+        deferred.Resolve(Napi::Boolean::New(env, false));
+        return deferred.Promise();
+    }
+    
+    // The previous capture thread has already reported back, so this only
+    // waits for it to return
+    if (captureThread_.joinable()) {
+        captureThread_.join();
     }
     
+    state_ = State::Starting;
+    startDeferred_ = std::make_unique<Napi::Promise::Deferred>(Napi::Promise::Deferred::New(env));
+    Napi::Promise promise = startDeferred_->Promise();
+    Ref();
+    
     // Start capture in a new thread
+    stopRequested_ = false;
     isCapturing_ = true;
     captureThread_ = std::thread(&AudioCaptureAddon::CaptureThreadFunc, this);
-    
-    return Napi::Boolean::New(env, true);
+    return promise;
 }
 
+// Resolves once the capture thread has stopped the endpoint and every chunk
+// captured before that has been passed to the callback. The thread is joined
+// by the next start() or the destructor, after it has finished.
 Napi::Value AudioCaptureAddon::Stop(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
     
-    if (!isCapturing_) {
-        std::cout << "Stop called but not capturing" << std::endl;
-        return env.Undefined();
+    std::unique_ptr<Napi::Promise::Deferred> deferred =
+        std::make_unique<Napi::Promise::Deferred>(Napi::Promise::Deferred::New(env));
+    Napi::Promise promise = deferred->Promise();
+    if (state_ == State::Idle) {
+        deferred->Resolve(env.Undefined());
+        return promise;
     }
     
-    std::cout << "Stopping capture..." << std::endl;
-    
-    // Signal the thread to stop
-    isCapturing_ = false;
-    
-    // Wait for the thread to finish
-    if (captureThread_.joinable()) {
-        captureThread_.join();
+    if (stopDeferreds_.empty()) {
+        Ref();
     }
-    
-    std::cout << "Stop completed" << std::endl;
-    return env.Undefined();
+    stopDeferreds_.push_back(std::move(deferred));
+    // Starting: OnStarted() stops; Stopping: already on its way
+    if (state_ == State::Running) {
+        BeginStop();
+    }
+    return promise;
 }
 
 Napi::Value AudioCaptureAddon::IsActive(const Napi::CallbackInfo& info) {
@@ -422,8 +664,35 @@ Napi::Value AudioCaptureAddon::IsActive(const Napi::CallbackInfo& info) {
     return Napi::Boolean::New(env, isCapturing_.load());
 }
 
+Napi::Value AudioCaptureAddon::GetStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    Napi::Object stats = Napi::Object::New(env);
+    stats.Set("deviceId", Napi::String::New(env, deviceId_));
+    stats.Set("sampleRate", Napi::Number::New(env, sampleRate_.load()));
+    stats.Set("channels", Napi::Number::New(env, channels_.load()));
+    
+    // No ring before the capture thread has opened the endpoint
+    capture::DeliveryStats delivery;
+    {
+        std::lock_guard<std::mutex> lock(deliveryMutex_);
+        if (delivery_) {
+            delivery = delivery_->stats();
+        }
+    }
+    stats.Set("samplesIn", Napi::Number::New(env, static_cast<double>(delivery.samplesIn)));
+    stats.Set("samplesDelivered", Napi::Number::New(env, static_cast<double>(delivery.samplesDelivered)));
+    stats.Set("samplesDropped", Napi::Number::New(env, static_cast<double>(delivery.samplesDropped)));
+    stats.Set("chunks", Napi::Number::New(env, static_cast<double>(delivery.chunks)));
+    stats.Set("bufferedMs", Napi::Number::New(env, sampleRate_ > 0 && channels_ > 0
+        ? delivery.buffered * 1000.0 / (sampleRate_ * channels_) : 0.0));
+    capture::setCaptureMetrics(env, stats, delivery, *metrics_, capture::statsResetRequested(info));
+    return stats;
+}
+
 Napi::Object Init(Napi::Env env, Napi::Object exports) {
     AudioCaptureAddon::Init(env, exports);
+    trace::initNapi(env, exports);
     return exports;
 }
 
@@ -0,0 +1,484 @@
+#include "capture_spool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+#include "checksum.h"
+#include "file_util.h"
+
+namespace storage {
+
+namespace {
+
+const uint32_t kSpoolMagic = 0x4C505343;   // "CSPL"
+const uint32_t kRecordMagic = 0x43455253;  // "SREC"
+const uint32_t kSpoolVersion = 1;
+const uint64_t kSlotOffsets[2] = {0, 512};
+const uint64_t kMinCapacity = 64 * 1024;
+
+inline uint64_t align8(uint64_t value) {
+    return (value + 7) & ~static_cast<uint64_t>(7);
+}
+
+} // namespace
+
+CaptureSpool::CaptureSpool()
+    : fd_(-1),
+      capacity_(0),
+      sampleRate_(0),
+      channels_(0),
+      overwrite_(true),
+      syncIntervalMs_(0),
+      generation_(0),
+      head_(0),
+      tail_(0),
+      tailSeq_(0),
+      nextSeq_(0),
+      nextFrame_(0),
+      segment_(0),
+      reservedAt_(0),
+      reservedSamples_(0),
+      reserved_(false),
+      recordsWritten_(0),
+      droppedRecords_(0),
+      recoveredRecords_(0) {
+}
+
+CaptureSpool::~CaptureSpool() {
+    close();
+}
+
+bool CaptureSpool::open(const CaptureSpoolConfig& config) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (config.channels < 1 || config.sampleRate <= 0) {
+        fail("invalid sampleRate or channels");
+        return false;
+    }
+
+    fd_ = openFile(config.path, false);
+    if (fd_ < 0) {
+        fail("cannot open " + config.path + ": " + errorString());
+        return false;
+    }
+
+    overwrite_ = config.overwrite;
+    syncIntervalMs_ = config.syncIntervalMs;
+    lastSync_ = std::chrono::steady_clock::now();
+
+    uint64_t size = 0;
+    if (!fileSize(fd_, &size)) {
+        fail("cannot stat " + config.path + ": " + errorString());
+        return false;
+    }
+
+    // Try to recover an existing spool first
+    if (size > kHeaderBytes && map_.map(fd_, size, true)) {
+        if (loadHeader() && kHeaderBytes + capacity_ == size) {
+            recover();
+            return true;
+        }
+        map_.unmap();
+    }
+
+    // Fresh (or unreadable) spool: start from an all-zero file
+    capacity_ = std::max(kMinCapacity, align8(config.capacityBytes));
+    sampleRate_ = config.sampleRate;
+    channels_ = config.channels;
+    generation_ = 0;
+    head_ = tail_ = 0;
+    tailSeq_ = nextSeq_ = 0;
+    nextFrame_ = 0;
+    segment_ = 0;
+
+    if (!truncateFile(fd_, 0) || !truncateFile(fd_, kHeaderBytes + capacity_)) {
+        fail("cannot size " + config.path + ": " + errorString());
+        return false;
+    }
+    preallocate(fd_, kHeaderBytes + capacity_);
+
+    if (!map_.map(fd_, kHeaderBytes + capacity_, true)) {
+        fail("cannot map " + config.path + ": " + errorString());
+        return false;
+    }
+
+    writeHeader();
+    return true;
+}
+
+void CaptureSpool::close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (map_.isMapped()) {
+        writeHeader();
+        map_.flush(0, map_.size(), false);
+        map_.unmap();
+    }
+    if (fd_ >= 0) {
+        closeFile(fd_);
+        fd_ = -1;
+    }
+    reserved_ = false;
+}
+
+uint64_t CaptureSpool::recordStart(uint64_t logical) const {
+    // A gap too small for a record header is skipped implicitly
+    const uint64_t remaining = capacity_ - physical(logical);
+    return remaining < sizeof(RecordHeader) ? logical + remaining : logical;
+}
+
+const CaptureSpool::RecordHeader* CaptureSpool::headerAt(uint64_t logical) const {
+    return reinterpret_cast<const RecordHeader*>(ring() + physical(recordStart(logical)));
+}
+
+uint64_t CaptureSpool::nextRecord(uint64_t logical) const {
+    return recordStart(logical) + align8(sizeof(RecordHeader) + headerAt(logical)->payloadBytes);
+}
+
+bool CaptureSpool::validRecord(uint64_t logical, uint64_t expectedSeq) const {
+    const uint64_t offset = physical(recordStart(logical));
+    const RecordHeader* header = headerAt(logical);
+
+    if (header->magic != kRecordMagic || header->seq != expectedSeq) return false;
+
+    const uint64_t end = offset + sizeof(RecordHeader) + header->payloadBytes;
+    if (header->segment == kPadSegment) {
+        if (end != capacity_) return false;
+    } else if (end > capacity_ || (header->payloadBytes % sizeof(int16_t)) != 0) {
+        return false;
+    }
+
+    RecordHeader copy = *header;
+    copy.crc = 0;
+    uint32_t crc = crc32c(&copy, sizeof(copy));
+    if (header->segment != kPadSegment) {
+        crc = crc32c(ring() + offset + sizeof(RecordHeader), header->payloadBytes, crc);
+    }
+    return crc == header->crc;
+}
+
+bool CaptureSpool::makeRoom(uint64_t bytes) {
+    while (head_ + bytes - tail_ > capacity_) {
+        if (!overwrite_ || tail_ == head_) return false;
+        dropOldest();
+    }
+    return true;
+}
+
+void CaptureSpool::dropOldest() {
+    const RecordHeader* header = headerAt(tail_);
+    if (header->segment != kPadSegment) {
+        tailSeq_++;
+        droppedRecords_++;
+    }
+    tail_ = nextRecord(tail_);
+}
+
+int16_t* CaptureSpool::reserve(size_t numSamples) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!map_.isMapped() || numSamples == 0) return nullptr;
+
+    const uint64_t bytes = align8(sizeof(RecordHeader) + numSamples * sizeof(int16_t));
+    if (bytes > capacity_) return nullptr;
+
+    // Records never straddle the end of the ring
+    uint64_t start = recordStart(head_);
+    const uint64_t offset = physical(start);
+    if (offset + bytes > capacity_) {
+        start += capacity_ - offset;
+    }
+
+    if (!makeRoom(start + bytes - head_)) return nullptr;
+
+    reservedAt_ = start;
+    reservedSamples_ = numSamples;
+    reserved_ = true;
+    return reinterpret_cast<int16_t*>(ring() + physical(start) + sizeof(RecordHeader));
+}
+
+bool CaptureSpool::commit(size_t numSamples) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!reserved_ || numSamples > reservedSamples_) return false;
+    reserved_ = false;
+    if (numSamples == 0) return true;
+
+    // Fill the gap before a wrapped record with a pad record
+    const uint64_t padAt = recordStart(head_);
+    if (padAt != reservedAt_) {
+        RecordHeader pad = {};
+        pad.magic = kRecordMagic;
+        pad.payloadBytes = static_cast<uint32_t>(capacity_ - physical(padAt) - sizeof(RecordHeader));
+        pad.seq = nextSeq_;
+        pad.segment = kPadSegment;
+        pad.crc = crc32c(&pad, sizeof(pad));
+        std::memcpy(ring() + physical(padAt), &pad, sizeof(pad));
+    }
+
+    uint8_t* record = ring() + physical(reservedAt_);
+    const uint32_t payloadBytes = static_cast<uint32_t>(numSamples * sizeof(int16_t));
+
+    RecordHeader header = {};
+    header.magic = kRecordMagic;
+    header.payloadBytes = payloadBytes;
+    header.seq = nextSeq_;
+    header.startFrame = nextFrame_;
+    header.segment = segment_;
+    header.crc = crc32c(record + sizeof(RecordHeader), payloadBytes, crc32c(&header, sizeof(header)));
+    std::memcpy(record, &header, sizeof(header));
+
+    head_ = reservedAt_ + align8(sizeof(RecordHeader) + payloadBytes);
+    nextSeq_++;
+    nextFrame_ += numSamples / static_cast<size_t>(channels_);
+    recordsWritten_++;
+    writeHeader();
+
+    if (syncIntervalMs_ > 0) {
+        const auto now = std::chrono::steady_clock::now();
+        if (now - lastSync_ >= std::chrono::milliseconds(syncIntervalMs_)) {
+            map_.flush(0, map_.size(), true);
+            lastSync_ = now;
+        }
+    }
+    return true;
+}
+
+bool CaptureSpool::append(const int16_t* samples, size_t numSamples) {
+    int16_t* dst = reserve(numSamples);
+    if (!dst) return false;
+    std::memcpy(dst, samples, numSamples * sizeof(int16_t));
+    return commit(numSamples);
+}
+
+bool CaptureSpool::append(const float* samples, size_t numSamples) {
+    int16_t* dst = reserve(numSamples);
+    if (!dst) return false;
+    for (size_t i = 0; i < numSamples; i++) {
+        const float s = std::max(-1.0f, std::min(1.0f, samples[i]));
+        dst[i] = static_cast<int16_t>(std::lround(s < 0 ? s * 32768.0f : s * 32767.0f));
+    }
+    return commit(numSamples);
+}
+
+uint32_t CaptureSpool::endSegment() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const uint32_t closed = segment_++;
+    if (map_.isMapped()) writeHeader();
+    return closed;
+}
+
+std::vector<SpoolSegment> CaptureSpool::pendingSegments() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<SpoolSegment> segments;
+    if (!map_.isMapped()) return segments;
+
+    uint64_t seq = tailSeq_;
+    for (uint64_t pos = tail_; pos < head_; pos = nextRecord(pos)) {
+        const RecordHeader* header = headerAt(pos);
+        if (header->segment == kPadSegment) continue;
+
+        if (segments.empty() || segments.back().id != header->segment) {
+            SpoolSegment segment;
+            segment.id = header->segment;
+            segment.firstSeq = seq;
+            segment.startFrame = header->startFrame;
+            segment.complete = header->segment != segment_;
+            segments.push_back(segment);
+        }
+        SpoolSegment& segment = segments.back();
+        segment.lastSeq = seq;
+        segment.bytes += header->payloadBytes;
+        segment.frames += header->payloadBytes / (sizeof(int16_t) * channels_);
+        seq++;
+    }
+    return segments;
+}
+
+bool CaptureSpool::read(uint64_t cursor, size_t maxBytes, SpoolRead* out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    out->data.clear();
+    out->endOfSegment = false;
+    if (!map_.isMapped()) return false;
+
+    uint64_t pos = std::max(cursor, tail_);
+    while (pos < head_ && headerAt(pos)->segment == kPadSegment) {
+        pos = nextRecord(pos);
+    }
+    if (pos >= head_) {
+        out->nextCursor = pos;
+        return false;
+    }
+
+    const RecordHeader* first = headerAt(pos);
+    out->segment = first->segment;
+    out->startFrame = first->startFrame;
+
+    while (pos < head_) {
+        const RecordHeader* header = headerAt(pos);
+        if (header->segment != kPadSegment) {
+            if (header->segment != out->segment) {
+                out->endOfSegment = true;
+                break;
+            }
+            if (!out->data.empty() && out->data.size() + header->payloadBytes > maxBytes) break;
+
+            const uint8_t* payload = reinterpret_cast<const uint8_t*>(header) + sizeof(RecordHeader);
+            out->data.insert(out->data.end(), payload, payload + header->payloadBytes);
+        }
+        pos = nextRecord(pos);
+    }
+    if (pos >= head_ && out->segment != segment_) {
+        out->endOfSegment = true;
+    }
+    out->nextCursor = pos;
+    return true;
+}
+
+bool CaptureSpool::readSegment(uint32_t segment, std::vector<uint8_t>* out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    out->clear();
+    if (!map_.isMapped()) return false;
+
+    bool found = false;
+    for (uint64_t pos = tail_; pos < head_; pos = nextRecord(pos)) {
+        const RecordHeader* header = headerAt(pos);
+        if (header->segment != segment) continue;
+        const uint8_t* payload = reinterpret_cast<const uint8_t*>(header) + sizeof(RecordHeader);
+        out->insert(out->end(), payload, payload + header->payloadBytes);
+        found = true;
+    }
+    return found;
+}
+
+void CaptureSpool::ack(uint32_t segment) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!map_.isMapped()) return;
+
+    while (tail_ < head_) {
+        const RecordHeader* header = headerAt(tail_);
+        if (header->segment != kPadSegment) {
+            if (header->segment > segment) break;
+            tailSeq_++;
+        }
+        tail_ = nextRecord(tail_);
+    }
+    writeHeader();
+}
+
+bool CaptureSpool::sync() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!map_.isMapped()) return false;
+    lastSync_ = std::chrono::steady_clock::now();
+    return map_.flush(0, map_.size(), false);
+}
+
+SpoolStats CaptureSpool::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    SpoolStats stats;
+    stats.capacity = capacity_;
+    stats.usedBytes = head_ - tail_;
+    stats.recordsWritten = recordsWritten_;
+    stats.droppedRecords = droppedRecords_;
+    stats.recoveredRecords = recoveredRecords_;
+    stats.currentSegment = segment_;
+    return stats;
+}
+
+void CaptureSpool::writeHeader() {
+    HeaderSlot slot = {};
+    slot.magic = kSpoolMagic;
+    slot.version = kSpoolVersion;
+    slot.capacity = capacity_;
+    slot.sampleRate = static_cast<uint32_t>(sampleRate_);
+    slot.channels = static_cast<uint32_t>(channels_);
+    slot.generation = ++generation_;
+    slot.head = head_;
+    slot.tail = tail_;
+    slot.nextSeq = nextSeq_;
+    slot.nextFrame = nextFrame_;
+    slot.tailSeq = tailSeq_;
+    slot.segment = segment_;
+    slot.crc = crc32c(&slot, offsetof(HeaderSlot, crc));
+
+    // Alternate slots so a torn write leaves the previous header intact
+    std::memcpy(map_.data() + kSlotOffsets[generation_ & 1], &slot, sizeof(slot));
+}
+
+bool CaptureSpool::loadHeader() {
+    bool found = false;
+    HeaderSlot best = {};
+
+    for (uint64_t offset : kSlotOffsets) {
+        HeaderSlot slot;
+        std::memcpy(&slot, map_.data() + offset, sizeof(slot));
+        if (slot.magic != kSpoolMagic || slot.version != kSpoolVersion) continue;
+        if (slot.crc != crc32c(&slot, offsetof(HeaderSlot, crc))) continue;
+        if (!found || slot.generation > best.generation) {
+            best = slot;
+            found = true;
+        }
+    }
+
+    if (!found || best.capacity < kMinCapacity || (best.capacity & 7) != 0 ||
+        best.channels < 1 || best.sampleRate == 0 || best.tail > best.head ||
+        best.head - best.tail > best.capacity) {
+        return false;
+    }
+
+    capacity_ = best.capacity;
+    sampleRate_ = static_cast<int>(best.sampleRate);
+    channels_ = static_cast<int>(best.channels);
+    generation_ = best.generation;
+    head_ = best.head;
+    tail_ = best.tail;
+    tailSeq_ = best.tailSeq;
+    nextSeq_ = best.nextSeq;
+    nextFrame_ = best.nextFrame;
+    segment_ = best.segment;
+    return true;
+}
+
+void CaptureSpool::recover() {
+    // Re-validate from the tail; the header may lag behind the records (or,
+    // after a torn page write, run ahead of them).
+    uint64_t pos = tail_;
+    uint64_t seq = tailSeq_;
+    uint64_t frame = nextFrame_;
+    bool any = false;
+    uint32_t lastSegment = 0;
+
+    while (pos - tail_ < capacity_ && validRecord(pos, seq)) {
+        const RecordHeader* header = headerAt(pos);
+        const uint64_t next = nextRecord(pos);
+        if (next - tail_ > capacity_) break;
+
+        if (header->segment != kPadSegment) {
+            frame = header->startFrame + header->payloadBytes / (sizeof(int16_t) * channels_);
+            lastSegment = header->segment;
+            any = true;
+            seq++;
+            recoveredRecords_++;
+        }
+        pos = next;
+    }
+
+    head_ = pos;
+    nextSeq_ = seq;
+    nextFrame_ = std::max(frame, nextFrame_);
+
+    // Whatever was being written when the process died is now a closed segment
+    if (any && lastSegment >= segment_) {
+        segment_ = lastSegment + 1;
+    }
+    writeHeader();
+}
+
+void CaptureSpool::fail(const std::string& message) {
+    error_ = message;
+    if (fd_ >= 0) {
+        closeFile(fd_);
+        fd_ = -1;
+    }
+}
+
+} // namespace storage
@@ -0,0 +1,192 @@
+// Crash-safe capture spool
+//
+// Captured PCM is written straight into a memory-mapped ring file, so a crash
+// of the process loses nothing that append() has returned for: the pages
+// belong to the kernel page cache, not to the process. sync() (or the
+// syncIntervalMs policy) additionally flushes them for power-loss safety.
+//
+// File layout:
+//   [0, 4096)        two header slots, written alternately (generation + CRC)
+//   [4096, end)      ring of records, 8-byte aligned
+//
+// Each record is a 32-byte header (magic, payload size, sequence number,
+// start frame, segment id, CRC-32C over header and payload) followed by int16
+// PCM. Records never straddle the end of the ring; the gap is filled with a
+// pad record (or skipped if smaller than a record header). On open, records
+// are re-validated from the oldest unacknowledged one until the first bad
+// CRC or out-of-order sequence number, which also picks up records committed
+// after the last header update.
+//
+// Audio is grouped into segments (one per transcription upload). A segment
+// stays in the ring until ack()ed; recoverable segments from a previous run
+// are listed by pendingSegments().
+
+#ifndef STORAGE_CAPTURE_SPOOL_H
+#define STORAGE_CAPTURE_SPOOL_H
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "mapped_file.h"
+
+namespace storage {
+
+struct CaptureSpoolConfig {
+    std::string path;
+    uint64_t capacityBytes = 16 * 1024 * 1024;  // ring size, excluding the header page
+    int sampleRate = 16000;
+    int channels = 1;
+    bool overwrite = true;       // drop the oldest records when full (else reject)
+    uint32_t syncIntervalMs = 0; // 0 = only on sync()/close()
+};
+
+struct SpoolSegment {
+    uint32_t id = 0;
+    uint64_t firstSeq = 0;
+    uint64_t lastSeq = 0;
+    uint64_t startFrame = 0;
+    uint64_t frames = 0;
+    uint64_t bytes = 0;
+    bool complete = false;   // false only for the segment still being written
+};
+
+struct SpoolRead {
+    std::vector<uint8_t> data;   // concatenated int16 PCM
+    uint64_t startFrame = 0;
+    uint32_t segment = 0;
+    uint64_t nextCursor = 0;     // pass back to continue reading
+    bool endOfSegment = false;
+};
+
+struct SpoolStats {
+    uint64_t capacity = 0;
+    uint64_t usedBytes = 0;
+    uint64_t recordsWritten = 0;
+    uint64_t droppedRecords = 0;
+    uint64_t recoveredRecords = 0;
+    uint32_t currentSegment = 0;
+};
+
+class CaptureSpool {
+public:
+    CaptureSpool();
+    ~CaptureSpool();
+
+    CaptureSpool(const CaptureSpool&) = delete;
+    CaptureSpool& operator=(const CaptureSpool&) = delete;
+
+    // Open or create the spool. An existing valid spool is recovered and its
+    // stored capacity and format win over the config. Returns false and sets
+    // error() on failure.
+    bool open(const CaptureSpoolConfig& config);
+    void close();
+
+    // Zero-copy append: reserve() returns a pointer into the mapped ring with
+    // room for numSamples int16 samples; fill it, then commit() the same
+    // count. Only one reservation may be outstanding. Returns nullptr if the
+    // record does not fit.
+    int16_t* reserve(size_t numSamples);
+    bool commit(size_t numSamples);
+
+    // Convenience wrappers over reserve()/commit(); the conversion or memcpy
+    // into the mapping is the only copy.
+    bool append(const int16_t* samples, size_t numSamples);
+    bool append(const float* samples, size_t numSamples);
+
+    // Close the current segment and start the next one. Returns the closed id.
+    uint32_t endSegment();
+
+    std::vector<SpoolSegment> pendingSegments() const;
+
+    // Read committed records of one segment starting at cursor (0 = start of
+    // the oldest segment). Stops at maxBytes or the end of the segment.
+    bool read(uint64_t cursor, size_t maxBytes, SpoolRead* out) const;
+    bool readSegment(uint32_t segment, std::vector<uint8_t>* out) const;
+
+    // Release every record whose segment id is <= segment.
+    void ack(uint32_t segment);
+
+    bool sync();
+
+    SpoolStats stats() const;
+    int sampleRate() const { return sampleRate_; }
+    int channels() const { return channels_; }
+    const std::string& error() const { return error_; }
+
+private:
+    struct RecordHeader {
+        uint32_t magic;
+        uint32_t payloadBytes;
+        uint64_t seq;
+        uint64_t startFrame;
+        uint32_t segment;
+        uint32_t crc;
+    };
+
+    struct HeaderSlot {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t capacity;
+        uint32_t sampleRate;
+        uint32_t channels;
+        uint64_t generation;
+        uint64_t head;       // logical end of committed records
+        uint64_t tail;       // logical start of the oldest unacked record
+        uint64_t nextSeq;
+        uint64_t nextFrame;
+        uint64_t tailSeq;    // sequence number of the record at tail
+        uint32_t segment;    // segment being written
+        uint32_t crc;
+    };
+
+    static const uint64_t kHeaderBytes = 4096;
+    static const uint32_t kPadSegment = 0xFFFFFFFFu;
+
+    mutable std::mutex mutex_;
+    int fd_;
+    MappedFile map_;
+    std::string error_;
+
+    uint64_t capacity_;
+    int sampleRate_;
+    int channels_;
+    bool overwrite_;
+    uint32_t syncIntervalMs_;
+
+    uint64_t generation_;
+    uint64_t head_;
+    uint64_t tail_;
+    uint64_t tailSeq_;
+    uint64_t nextSeq_;
+    uint64_t nextFrame_;
+    uint32_t segment_;
+
+    uint64_t reservedAt_;    // logical offset of the outstanding record
+    size_t reservedSamples_;
+    bool reserved_;
+
+    uint64_t recordsWritten_;
+    uint64_t droppedRecords_;
+    uint64_t recoveredRecords_;
+    std::chrono::steady_clock::time_point lastSync_;
+
+    uint8_t* ring() const { return map_.data() + kHeaderBytes; }
+    uint64_t physical(uint64_t logical) const { return logical % capacity_; }
+    uint64_t recordStart(uint64_t logical) const;
+    const RecordHeader* headerAt(uint64_t logical) const;
+    bool validRecord(uint64_t logical, uint64_t expectedSeq) const;
+    uint64_t nextRecord(uint64_t logical) const;
+    bool makeRoom(uint64_t bytes);
+    void dropOldest();
+    void writeHeader();
+    bool loadHeader();
+    void recover();
+    void fail(const std::string& message);
+};
+
+} // namespace storage
+
+#endif
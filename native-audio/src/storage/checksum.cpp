@@ -0,0 +1,53 @@
+#include "checksum.h"
+
+namespace storage {
+
+namespace {
+
+// Slicing-by-8 tables for the reflected polynomial 0x82F63B78
+struct Crc32cTables {
+    uint32_t t[8][256];
+
+    Crc32cTables() {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? (c >> 1) ^ 0x82F63B78u : c >> 1;
+            }
+            t[0][i] = c;
+        }
+        for (uint32_t i = 0; i < 256; i++) {
+            for (int s = 1; s < 8; s++) {
+                t[s][i] = (t[s - 1][i] >> 8) ^ t[0][t[s - 1][i] & 0xFF];
+            }
+        }
+    }
+};
+
+const Crc32cTables& tables() {
+    static const Crc32cTables instance;
+    return instance;
+}
+
+} // namespace
+
+uint32_t crc32c(const void* data, size_t length, uint32_t crc) {
+    const uint32_t(&t)[8][256] = tables().t;
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    crc = ~crc;
+
+    while (length >= 8) {
+        const uint32_t lo = (static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 |
+                             static_cast<uint32_t>(p[2]) << 16 | static_cast<uint32_t>(p[3]) << 24) ^ crc;
+        crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^
+              t[3][p[4]] ^ t[2][p[5]] ^ t[1][p[6]] ^ t[0][p[7]];
+        p += 8;
+        length -= 8;
+    }
+    while (length-- > 0) {
+        crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xFF];
+    }
+    return ~crc;
+}
+
+} // namespace storage
@@ -0,0 +1,16 @@
+// CRC-32C (Castagnoli) used to validate records in the on-disk formats
+
+#ifndef STORAGE_CHECKSUM_H
+#define STORAGE_CHECKSUM_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace storage {
+
+// Pass the previous result as crc to checksum data in pieces; start with 0.
+uint32_t crc32c(const void* data, size_t length, uint32_t crc = 0);
+
+} // namespace storage
+
+#endif
@@ -0,0 +1,192 @@
+#include "file_util.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#include <io.h>
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace storage {
+
+int openFile(const std::string& path, bool truncate) {
+#ifdef _WIN32
+    int flags = _O_RDWR | _O_CREAT | _O_BINARY;
+    if (truncate) flags |= _O_TRUNC;
+    return _open(path.c_str(), flags, _S_IREAD | _S_IWRITE);
+#else
+    int flags = O_RDWR | O_CREAT | O_CLOEXEC;
+    if (truncate) flags |= O_TRUNC;
+    return ::open(path.c_str(), flags, 0644);
+#endif
+}
+
+int openReadOnly(const std::string& path) {
+#ifdef _WIN32
+    return _open(path.c_str(), _O_RDONLY | _O_BINARY);
+#else
+    return ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+#endif
+}
+
+void closeFile(int fd) {
+    if (fd < 0) return;
+#ifdef _WIN32
+    _close(fd);
+#else
+    ::close(fd);
+#endif
+}
+
+bool writeAt(int fd, const void* data, size_t length, uint64_t offset) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    while (length > 0) {
+#ifdef _WIN32
+        if (_lseeki64(fd, static_cast<__int64>(offset), SEEK_SET) < 0) return false;
+        const int n = _write(fd, p, static_cast<unsigned int>(length));
+#else
+        const ssize_t n = ::pwrite(fd, p, length, static_cast<off_t>(offset));
+#endif
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        p += n;
+        offset += static_cast<uint64_t>(n);
+        length -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool readAt(int fd, void* data, size_t length, uint64_t offset) {
+    uint8_t* p = static_cast<uint8_t*>(data);
+    while (length > 0) {
+#ifdef _WIN32
+        if (_lseeki64(fd, static_cast<__int64>(offset), SEEK_SET) < 0) return false;
+        const int n = _read(fd, p, static_cast<unsigned int>(length));
+#else
+        const ssize_t n = ::pread(fd, p, length, static_cast<off_t>(offset));
+#endif
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        if (n == 0) {
+            errno = EIO;
+            return false;
+        }
+        p += n;
+        offset += static_cast<uint64_t>(n);
+        length -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool syncFile(int fd) {
+#ifdef _WIN32
+    return _commit(fd) == 0;
+#elif defined(__APPLE__)
+    // fsync on macOS only reaches the drive cache
+    if (::fcntl(fd, F_FULLFSYNC) == 0) return true;
+    return ::fsync(fd) == 0;
+#else
+    return ::fdatasync(fd) == 0;
+#endif
+}
+
+bool truncateFile(int fd, uint64_t length) {
+#ifdef _WIN32
+    return _chsize_s(fd, static_cast<__int64>(length)) == 0;
+#else
+    return ::ftruncate(fd, static_cast<off_t>(length)) == 0;
+#endif
+}
+
+bool fileSize(int fd, uint64_t* size) {
+#ifdef _WIN32
+    struct _stat64 st;
+    if (_fstat64(fd, &st) != 0) return false;
+#else
+    struct stat st;
+    if (::fstat(fd, &st) != 0) return false;
+#endif
+    *size = static_cast<uint64_t>(st.st_size);
+    return true;
+}
+
+bool preallocate(int fd, uint64_t length) {
+#if defined(__linux__)
+    if (::fallocate(fd, FALLOC_FL_KEEP_SIZE, 0, static_cast<off_t>(length)) == 0) {
+        return true;
+    }
+    // Filesystems without fallocate (tmpfs on old kernels, some FUSE mounts)
+    return errno == EOPNOTSUPP || errno == ENOSYS;
+#elif defined(__APPLE__)
+    fstore_t store;
+    std::memset(&store, 0, sizeof(store));
+    store.fst_flags = F_ALLOCATECONTIG;
+    store.fst_posmode = F_PEOFPOSMODE;
+    store.fst_offset = 0;
+    store.fst_length = static_cast<off_t>(length);
+    if (::fcntl(fd, F_PREALLOCATE, &store) == 0) return true;
+    store.fst_flags = F_ALLOCATEALL;
+    if (::fcntl(fd, F_PREALLOCATE, &store) == 0) return true;
+    return errno == ENOTSUP;
+#else
+    (void)fd;
+    (void)length;
+    return true;
+#endif
+}
+
+bool makeDirectories(const std::string& path) {
+    if (path.empty()) return true;
+    std::string partial;
+    partial.reserve(path.size());
+    for (size_t i = 0; i < path.size(); i++) {
+        partial.push_back(path[i]);
+        const bool atSeparator = path[i] == '/' || path[i] == '\\';
+        if (!atSeparator && i + 1 != path.size()) continue;
+        if (partial.size() <= 1) continue;
+#ifdef _WIN32
+        const int rc = _mkdir(partial.c_str());
+#else
+        const int rc = ::mkdir(partial.c_str(), 0755);
+#endif
+        if (rc != 0 && errno != EEXIST) return false;
+    }
+    return true;
+}
+
+bool removeFile(const std::string& path) {
+#ifdef _WIN32
+    return _unlink(path.c_str()) == 0;
+#else
+    return ::unlink(path.c_str()) == 0;
+#endif
+}
+
+bool renameFile(const std::string& from, const std::string& to) {
+#ifdef _WIN32
+    // Fails while the target is open or mapped; callers treat that as "try later"
+    if (MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING)) return true;
+    errno = EACCES;
+    return false;
+#else
+    return ::rename(from.c_str(), to.c_str()) == 0;
+#endif
+}
+
+std::string errorString() {
+    return std::strerror(errno);
+}
+
+} // namespace storage
@@ -0,0 +1,42 @@
+// Small portable file helpers for the storage layer
+//
+// Thin wrappers over POSIX descriptors (and their MSVC CRT equivalents) for
+// positional I/O, preallocation and durability. All functions return false
+// and leave errno set on failure.
+
+#ifndef STORAGE_FILE_UTIL_H
+#define STORAGE_FILE_UTIL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace storage {
+
+// Open for read/write, creating the file if needed. Returns -1 on failure.
+int openFile(const std::string& path, bool truncate);
+// Open an existing file read-only. Returns -1 on failure.
+int openReadOnly(const std::string& path);
+void closeFile(int fd);
+
+bool writeAt(int fd, const void* data, size_t length, uint64_t offset);
+bool readAt(int fd, void* data, size_t length, uint64_t offset);
+bool syncFile(int fd);
+bool truncateFile(int fd, uint64_t length);
+bool fileSize(int fd, uint64_t* size);
+
+// Reserve disk blocks for [0, length) without changing the file size, so
+// later appends do not fragment or hit ENOSPC mid-segment. Falls back to a
+// no-op where the platform has no preallocation primitive.
+bool preallocate(int fd, uint64_t length);
+
+bool makeDirectories(const std::string& path);
+bool removeFile(const std::string& path);
+// Atomically replace `to` with `from`.
+bool renameFile(const std::string& from, const std::string& to);
+
+std::string errorString();
+
+} // namespace storage
+
+#endif
@@ -0,0 +1,361 @@
+#include "flac_encoder.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace storage {
+
+namespace {
+
+constexpr int kMaxFixedOrder = 4;
+constexpr int kMaxPartitionOrder = 6;
+constexpr int kMaxRiceParameter = 14;  // 15 is the escape code
+
+class BitWriter {
+public:
+    explicit BitWriter(std::vector<uint8_t>& out) : out_(out), acc_(0), bits_(0) {}
+
+    void put(uint32_t value, int count) {
+        // count <= 32; at most 7 bits are pending between calls
+        const uint64_t mask = count == 32 ? 0xffffffffull : ((1ull << count) - 1);
+        acc_ = (acc_ << count) | (value & mask);
+        bits_ += count;
+        while (bits_ >= 8) {
+            bits_ -= 8;
+            out_.push_back(static_cast<uint8_t>(acc_ >> bits_));
+        }
+    }
+
+    void putSigned(int32_t value, int count) {
+        put(static_cast<uint32_t>(value), count);
+    }
+
+    void putUnary(uint32_t zeros) {
+        while (zeros >= 16) {
+            put(0, 16);
+            zeros -= 16;
+        }
+        put(1, static_cast<int>(zeros) + 1);
+    }
+
+    void putRice(int32_t residual, int k) {
+        const uint32_t u = (static_cast<uint32_t>(residual) << 1) ^ static_cast<uint32_t>(residual >> 31);
+        putUnary(u >> k);
+        if (k > 0) put(u & ((1u << k) - 1), k);
+    }
+
+    void alignToByte() {
+        if (bits_ > 0) put(0, 8 - bits_);
+    }
+
+private:
+    std::vector<uint8_t>& out_;
+    uint64_t acc_;
+    int bits_;
+};
+
+uint8_t crc8(const uint8_t* data, size_t length) {
+    uint8_t crc = 0;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= data[i];
+        for (int j = 0; j < 8; j++) {
+            crc = (crc & 0x80) ? static_cast<uint8_t>((crc << 1) ^ 0x07) : static_cast<uint8_t>(crc << 1);
+        }
+    }
+    return crc;
+}
+
+struct Crc16Table {
+    uint16_t table[256];
+    Crc16Table() {
+        for (int i = 0; i < 256; i++) {
+            uint16_t crc = static_cast<uint16_t>(i << 8);
+            for (int j = 0; j < 8; j++) {
+                crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x8005) : static_cast<uint16_t>(crc << 1);
+            }
+            table[i] = crc;
+        }
+    }
+};
+
+uint16_t crc16(const uint8_t* data, size_t length) {
+    static const Crc16Table t;
+    uint16_t crc = 0;
+    for (size_t i = 0; i < length; i++) {
+        crc = static_cast<uint16_t>((crc << 8) ^ t.table[((crc >> 8) ^ data[i]) & 0xff]);
+    }
+    return crc;
+}
+
+int sampleRateCode(int rate) {
+    switch (rate) {
+        case 8000: return 4;
+        case 16000: return 5;
+        case 22050: return 6;
+        case 24000: return 7;
+        case 32000: return 8;
+        case 44100: return 9;
+        case 48000: return 10;
+        case 96000: return 11;
+        default: return 0;  // take it from STREAMINFO
+    }
+}
+
+void putUtf8Number(std::vector<uint8_t>& out, uint64_t v) {
+    if (v < 0x80) {
+        out.push_back(static_cast<uint8_t>(v));
+        return;
+    }
+    int bytes = 2;
+    while (bytes < 7 && v >= (1ull << (5 * bytes + 1))) bytes++;
+    out.push_back(static_cast<uint8_t>((0xff00u >> bytes) | (v >> (6 * (bytes - 1)))));
+    for (int i = bytes - 2; i >= 0; i--) {
+        out.push_back(static_cast<uint8_t>(0x80 | ((v >> (6 * i)) & 0x3f)));
+    }
+}
+
+void computeResidual(const int32_t* x, size_t n, int order, int32_t* r) {
+    switch (order) {
+        case 0:
+            for (size_t i = 0; i < n; i++) r[i] = x[i];
+            break;
+        case 1:
+            for (size_t i = 1; i < n; i++) r[i] = x[i] - x[i - 1];
+            break;
+        case 2:
+            for (size_t i = 2; i < n; i++) r[i] = x[i] - 2 * x[i - 1] + x[i - 2];
+            break;
+        case 3:
+            for (size_t i = 3; i < n; i++) r[i] = x[i] - 3 * x[i - 1] + 3 * x[i - 2] - x[i - 3];
+            break;
+        case 4:
+            for (size_t i = 4; i < n; i++)
+                r[i] = x[i] - 4 * x[i - 1] + 6 * x[i - 2] - 4 * x[i - 3] + x[i - 4];
+            break;
+    }
+}
+
+// Bits needed to Rice-code n residuals with parameter k
+uint64_t riceBits(const int32_t* r, size_t n, int k) {
+    uint64_t bits = static_cast<uint64_t>(n) * (1 + k);
+    for (size_t i = 0; i < n; i++) {
+        const uint32_t u = (static_cast<uint32_t>(r[i]) << 1) ^ static_cast<uint32_t>(r[i] >> 31);
+        bits += u >> k;
+    }
+    return bits;
+}
+
+int bestRiceParameter(const int32_t* r, size_t n, uint64_t* bitsOut) {
+    if (n == 0) {
+        *bitsOut = 0;
+        return 0;
+    }
+    uint64_t sum = 0;
+    for (size_t i = 0; i < n; i++) {
+        sum += (static_cast<uint32_t>(r[i]) << 1) ^ static_cast<uint32_t>(r[i] >> 31);
+    }
+    int k = 0;
+    const uint64_t mean = sum / n;
+    while (k < kMaxRiceParameter && (1ull << (k + 1)) <= mean) k++;
+
+    int best = k;
+    uint64_t bestBits = riceBits(r, n, k);
+    for (int candidate : {k - 1, k + 1}) {
+        if (candidate < 0 || candidate > kMaxRiceParameter) continue;
+        const uint64_t bits = riceBits(r, n, candidate);
+        if (bits < bestBits) {
+            bestBits = bits;
+            best = candidate;
+        }
+    }
+    *bitsOut = bestBits;
+    return best;
+}
+
+struct ResidualPlan {
+    int partitionOrder = 0;
+    int parameters[1 << kMaxPartitionOrder] = {};
+    uint64_t bits = ~0ull;
+};
+
+ResidualPlan planResidual(const int32_t* r, size_t blockSize, int order) {
+    ResidualPlan best;
+    for (int p = 0; p <= kMaxPartitionOrder; p++) {
+        const size_t partitions = size_t(1) << p;
+        if (blockSize % partitions != 0) break;
+        const size_t partitionSize = blockSize / partitions;
+        if (partitionSize <= static_cast<size_t>(order)) break;
+
+        ResidualPlan plan;
+        plan.partitionOrder = p;
+        plan.bits = 2 + 4;  // coding method + partition order
+        for (size_t i = 0; i < partitions; i++) {
+            const size_t start = i == 0 ? static_cast<size_t>(order) : i * partitionSize;
+            const size_t end = (i + 1) * partitionSize;
+            uint64_t bits = 0;
+            plan.parameters[i] = bestRiceParameter(r + start, end - start, &bits);
+            plan.bits += 4 + bits;
+        }
+        if (plan.bits < best.bits) best = plan;
+    }
+    return best;
+}
+
+} // namespace
+
+FlacEncoder::FlacEncoder(int sampleRate, int channels, int blockSize)
+    : sampleRate_(sampleRate),
+      channels_(channels),
+      blockSize_(std::max(16, std::min(blockSize, 65535))),
+      blockFrames_(0),
+      frameNumber_(0),
+      totalFrames_(0),
+      minFrameBytes_(0),
+      maxFrameBytes_(0) {
+    block_.resize(static_cast<size_t>(blockSize_) * channels_);
+    channel_.resize(blockSize_);
+    residual_.resize(blockSize_);
+}
+
+void FlacEncoder::begin(std::vector<uint8_t>& out) {
+    blockFrames_ = 0;
+    frameNumber_ = 0;
+    totalFrames_ = 0;
+    minFrameBytes_ = 0;
+    maxFrameBytes_ = 0;
+    out.insert(out.end(), {'f', 'L', 'a', 'C'});
+    streamInfo(out);
+}
+
+void FlacEncoder::streamInfo(std::vector<uint8_t>& out, bool lastMetadataBlock) const {
+    BitWriter bw(out);
+    bw.put(lastMetadataBlock ? 1 : 0, 1);
+    bw.put(0, 7);           // STREAMINFO
+    bw.put(34, 24);
+    bw.put(static_cast<uint32_t>(blockSize_), 16);
+    bw.put(static_cast<uint32_t>(blockSize_), 16);
+    bw.put(minFrameBytes_, 24);
+    bw.put(maxFrameBytes_, 24);
+    bw.put(static_cast<uint32_t>(sampleRate_), 20);
+    bw.put(static_cast<uint32_t>(channels_ - 1), 3);
+    bw.put(15, 5);          // 16 bits per sample
+    bw.put(static_cast<uint32_t>(totalFrames_ >> 32) & 0xf, 4);
+    bw.put(static_cast<uint32_t>(totalFrames_ & 0xffffffffu), 32);
+    for (int i = 0; i < 4; i++) bw.put(0, 32);  // MD5 unknown
+}
+
+void FlacEncoder::encode(const int16_t* samples, size_t frames, std::vector<uint8_t>& out) {
+    const size_t channels = static_cast<size_t>(channels_);
+    while (frames > 0) {
+        const size_t take = std::min(frames, static_cast<size_t>(blockSize_) - blockFrames_);
+        std::memcpy(block_.data() + blockFrames_ * channels, samples, take * channels * sizeof(int16_t));
+        blockFrames_ += take;
+        samples += take * channels;
+        frames -= take;
+        if (blockFrames_ == static_cast<size_t>(blockSize_)) {
+            encodeFrame(block_.data(), blockFrames_, out);
+            blockFrames_ = 0;
+        }
+    }
+}
+
+void FlacEncoder::finish(std::vector<uint8_t>& out) {
+    if (blockFrames_ > 0) {
+        encodeFrame(block_.data(), blockFrames_, out);
+        blockFrames_ = 0;
+    }
+}
+
+void FlacEncoder::encodeFrame(const int16_t* samples, size_t frames, std::vector<uint8_t>& out) {
+    const size_t frameStart = out.size();
+    const size_t channels = static_cast<size_t>(channels_);
+
+    // Frame header
+    out.push_back(0xff);
+    out.push_back(0xf8);  // sync + reserved + fixed blocksize
+    out.push_back(static_cast<uint8_t>((7 << 4) | sampleRateCode(sampleRate_)));  // 16-bit blocksize at end
+    out.push_back(static_cast<uint8_t>(((channels_ - 1) << 4) | (4 << 1)));        // independent, 16 bps
+    putUtf8Number(out, frameNumber_);
+    out.push_back(static_cast<uint8_t>((frames - 1) >> 8));
+    out.push_back(static_cast<uint8_t>((frames - 1) & 0xff));
+    out.push_back(crc8(out.data() + frameStart, out.size() - frameStart));
+
+    BitWriter bw(out);
+    for (size_t c = 0; c < channels; c++) {
+        int32_t* x = channel_.data();
+        bool constant = true;
+        for (size_t i = 0; i < frames; i++) {
+            x[i] = samples[i * channels + c];
+            constant = constant && x[i] == x[0];
+        }
+
+        if (constant) {
+            bw.put(0, 1);
+            bw.put(0, 6);   // CONSTANT
+            bw.put(0, 1);
+            bw.putSigned(x[0], 16);
+            continue;
+        }
+
+        // Pick the fixed predictor with the smallest residual magnitude,
+        // compared over the samples every order predicts
+        int bestOrder = 0;
+        uint64_t bestSum = ~0ull;
+        const int maxOrder = static_cast<int>(std::min<size_t>(kMaxFixedOrder, frames - 1));
+        for (int order = 0; order <= maxOrder; order++) {
+            computeResidual(x, frames, order, residual_.data());
+            uint64_t sum = 0;
+            for (size_t i = static_cast<size_t>(maxOrder); i < frames; i++) {
+                sum += static_cast<uint64_t>(std::abs(residual_[i]));
+            }
+            if (sum < bestSum) {
+                bestSum = sum;
+                bestOrder = order;
+            }
+        }
+
+        computeResidual(x, frames, bestOrder, residual_.data());
+        const ResidualPlan plan = planResidual(residual_.data(), frames, bestOrder);
+        const uint64_t fixedBits = 8 + static_cast<uint64_t>(bestOrder) * 16 + plan.bits;
+        const uint64_t verbatimBits = 8 + static_cast<uint64_t>(frames) * 16;
+
+        if (plan.bits == ~0ull || fixedBits >= verbatimBits) {
+            bw.put(0, 1);
+            bw.put(1, 6);   // VERBATIM
+            bw.put(0, 1);
+            for (size_t i = 0; i < frames; i++) bw.putSigned(x[i], 16);
+            continue;
+        }
+
+        bw.put(0, 1);
+        bw.put(static_cast<uint32_t>(8 | bestOrder), 6);  // FIXED
+        bw.put(0, 1);
+        for (int i = 0; i < bestOrder; i++) bw.putSigned(x[i], 16);
+
+        bw.put(0, 2);   // Rice, 4-bit parameters
+        bw.put(static_cast<uint32_t>(plan.partitionOrder), 4);
+        const size_t partitions = size_t(1) << plan.partitionOrder;
+        const size_t partitionSize = frames / partitions;
+        for (size_t p = 0; p < partitions; p++) {
+            const int k = plan.parameters[p];
+            bw.put(static_cast<uint32_t>(k), 4);
+            const size_t start = p == 0 ? static_cast<size_t>(bestOrder) : p * partitionSize;
+            const size_t end = (p + 1) * partitionSize;
+            for (size_t i = start; i < end; i++) bw.putRice(residual_[i], k);
+        }
+    }
+    bw.alignToByte();
+
+    const uint16_t crc = crc16(out.data() + frameStart, out.size() - frameStart);
+    out.push_back(static_cast<uint8_t>(crc >> 8));
+    out.push_back(static_cast<uint8_t>(crc & 0xff));
+
+    const uint32_t frameBytes = static_cast<uint32_t>(out.size() - frameStart);
+    minFrameBytes_ = minFrameBytes_ == 0 ? frameBytes : std::min(minFrameBytes_, frameBytes);
+    maxFrameBytes_ = std::max(maxFrameBytes_, frameBytes);
+    frameNumber_++;
+    totalFrames_ += frames;
+}
+
+} // namespace storage
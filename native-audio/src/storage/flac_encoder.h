@@ -0,0 +1,59 @@
+// Minimal streaming FLAC encoder (16-bit, fixed blocksize)
+//
+// Uses the FLAC fixed polynomial predictors (orders 0-4) with partitioned
+// Rice coding and constant subframes for digital silence. Typical speech
+// compresses to 50-60% of PCM; the output is decodable by any FLAC reader.
+// The STREAMINFO MD5 is left as zero ("unknown"), which the spec allows.
+
+#ifndef STORAGE_FLAC_ENCODER_H
+#define STORAGE_FLAC_ENCODER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace storage {
+
+class FlacEncoder {
+public:
+    FlacEncoder(int sampleRate, int channels, int blockSize = 4096);
+
+    // Size of the stream header; streamInfo() output belongs at offset 4.
+    static constexpr size_t kHeaderSize = 4 + 4 + 34;
+    static constexpr size_t kStreamInfoOffset = 4;
+
+    // Start a new stream: resets counters and appends the header to out.
+    void begin(std::vector<uint8_t>& out);
+
+    // Buffer interleaved samples and append every completed frame to out.
+    void encode(const int16_t* samples, size_t frames, std::vector<uint8_t>& out);
+
+    // Encode the trailing partial block, if any.
+    void finish(std::vector<uint8_t>& out);
+
+    // STREAMINFO reflecting everything encoded so far (34 bytes + block header).
+    void streamInfo(std::vector<uint8_t>& out, bool lastMetadataBlock = true) const;
+
+    uint64_t totalFrames() const { return totalFrames_; }
+
+private:
+    int sampleRate_;
+    int channels_;
+    int blockSize_;
+
+    std::vector<int16_t> block_;   // interleaved pending samples
+    size_t blockFrames_;
+    uint64_t frameNumber_;
+    uint64_t totalFrames_;
+    uint32_t minFrameBytes_;
+    uint32_t maxFrameBytes_;
+
+    std::vector<int32_t> channel_;
+    std::vector<int32_t> residual_;
+
+    void encodeFrame(const int16_t* samples, size_t frames, std::vector<uint8_t>& out);
+};
+
+} // namespace storage
+
+#endif
@@ -0,0 +1,86 @@
+#include "mapped_file.h"
+
+#ifdef _WIN32
+#include <io.h>
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace storage {
+
+MappedFile::MappedFile()
+    : data_(nullptr), size_(0)
+#ifdef _WIN32
+    , mapping_(nullptr)
+#endif
+{
+}
+
+MappedFile::~MappedFile() {
+    unmap();
+}
+
+bool MappedFile::map(int fd, uint64_t length, bool writable) {
+    unmap();
+    if (length == 0) return false;
+
+#ifdef _WIN32
+    HANDLE file = reinterpret_cast<HANDLE>(_get_osfhandle(fd));
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    HANDLE mapping = CreateFileMappingW(file, nullptr, writable ? PAGE_READWRITE : PAGE_READONLY,
+                                        static_cast<DWORD>(length >> 32),
+                                        static_cast<DWORD>(length & 0xFFFFFFFFu), nullptr);
+    if (!mapping) return false;
+
+    void* view = MapViewOfFile(mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0,
+                               static_cast<SIZE_T>(length));
+    if (!view) {
+        CloseHandle(mapping);
+        return false;
+    }
+    mapping_ = mapping;
+    data_ = static_cast<uint8_t*>(view);
+#else
+    void* view = ::mmap(nullptr, static_cast<size_t>(length),
+                        writable ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, fd, 0);
+    if (view == MAP_FAILED) return false;
+    data_ = static_cast<uint8_t*>(view);
+#endif
+
+    size_ = length;
+    return true;
+}
+
+void MappedFile::unmap() {
+    if (!data_) return;
+#ifdef _WIN32
+    UnmapViewOfFile(data_);
+    CloseHandle(static_cast<HANDLE>(mapping_));
+    mapping_ = nullptr;
+#else
+    ::munmap(data_, static_cast<size_t>(size_));
+#endif
+    data_ = nullptr;
+    size_ = 0;
+}
+
+bool MappedFile::flush(uint64_t offset, uint64_t length, bool async) {
+    if (!data_ || offset >= size_) return false;
+    if (length > size_ - offset) length = size_ - offset;
+
+#ifdef _WIN32
+    (void)async;
+    return FlushViewOfFile(data_ + offset, static_cast<SIZE_T>(length)) != 0;
+#else
+    // msync wants a page-aligned start address
+    const uint64_t page = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    const uint64_t start = offset - (offset % page);
+    return ::msync(data_ + start, static_cast<size_t>(length + (offset - start)),
+                   async ? MS_ASYNC : MS_SYNC) == 0;
+#endif
+}
+
+} // namespace storage
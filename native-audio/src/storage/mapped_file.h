@@ -0,0 +1,45 @@
+// Memory-mapped view of a whole file
+//
+// Used by the capture spool (read/write ring) and the segment store
+// (read-only views handed to JS). The mapping is owned by the object and
+// released on unmap() or destruction; the descriptor stays with the caller.
+
+#ifndef STORAGE_MAPPED_FILE_H
+#define STORAGE_MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace storage {
+
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Map [0, length) of fd. The file must already be at least length bytes.
+    bool map(int fd, uint64_t length, bool writable);
+    void unmap();
+
+    // Write dirty pages in [offset, offset + length) back to the file.
+    // async=true schedules the write-back without waiting for it.
+    bool flush(uint64_t offset, uint64_t length, bool async);
+
+    uint8_t* data() const { return data_; }
+    uint64_t size() const { return size_; }
+    bool isMapped() const { return data_ != nullptr; }
+
+private:
+    uint8_t* data_;
+    uint64_t size_;
+#ifdef _WIN32
+    void* mapping_;
+#endif
+};
+
+} // namespace storage
+
+#endif
@@ -0,0 +1,536 @@
+#include "segment_store.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+
+#include "checksum.h"
+#include "file_util.h"
+
+namespace storage {
+
+namespace {
+
+const uint32_t kDataMagic = 0x54414453;   // "SDAT"
+const uint32_t kIndexMagic = 0x58444953;  // "SIDX"
+const uint32_t kStoreVersion = 1;
+const uint64_t kHeaderSize = 64;
+const uint64_t kCompactMinDeadBytes = 4 * 1024 * 1024;
+const size_t kCopyChunk = 1024 * 1024;
+
+struct DataHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t base;
+    uint8_t reserved[44];
+    uint32_t crc;
+};
+
+struct IndexHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t base;
+    uint64_t firstLive;
+    uint8_t reserved[36];
+    uint32_t crc;
+};
+
+struct IndexEntry {
+    uint64_t session;
+    uint64_t startSample;
+    uint64_t offset;
+    uint64_t createdMs;
+    uint32_t stream;
+    uint32_t codec;
+    uint32_t sampleRate;
+    uint32_t durationSamples;
+    uint32_t bytes;
+    uint32_t dataCrc;
+    uint32_t reserved;
+    uint32_t crc;
+};
+
+static_assert(sizeof(DataHeader) == kHeaderSize, "data header layout");
+static_assert(sizeof(IndexHeader) == kHeaderSize, "index header layout");
+static_assert(sizeof(IndexEntry) == 64, "index entry layout");
+
+uint64_t nowMs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+uint64_t entryOffset(uint64_t id, uint64_t base) {
+    return kHeaderSize + (id - base) * sizeof(IndexEntry);
+}
+
+} // namespace
+
+SegmentStore::SegmentStore()
+    : dataFd_(-1),
+      indexFd_(-1),
+      dataBase_(0),
+      dataEnd_(0),
+      indexBase_(0),
+      firstLive_(0),
+      nextId_(0),
+      liveBytes_(0),
+      expired_(0),
+      compactions_(0) {
+}
+
+SegmentStore::~SegmentStore() {
+    close();
+}
+
+std::string SegmentStore::path(const char* name) const {
+    std::string result = config_.directory;
+    if (!result.empty() && result.back() != '/' && result.back() != '\\') {
+        result.push_back('/');
+    }
+    return result + name;
+}
+
+bool SegmentStore::fail(const std::string& message) {
+    error_ = message;
+    closeFile(dataFd_);
+    closeFile(indexFd_);
+    dataFd_ = indexFd_ = -1;
+    return false;
+}
+
+bool SegmentStore::open(const SegmentStoreConfig& config) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    config_ = config;
+
+    if (!makeDirectories(config_.directory)) {
+        return fail("cannot create " + config_.directory + ": " + errorString());
+    }
+    dataFd_ = openFile(path("segments.dat"), false);
+    indexFd_ = openFile(path("segments.idx"), false);
+    if (dataFd_ < 0 || indexFd_ < 0) {
+        return fail("cannot open segment store in " + config_.directory + ": " + errorString());
+    }
+    if (!load()) return false;
+
+    enforceQuotaLocked(nowMs());
+    return true;
+}
+
+void SegmentStore::close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    mapping_.reset();
+    if (indexFd_ >= 0) {
+        syncFile(dataFd_);
+        syncFile(indexFd_);
+    }
+    closeFile(dataFd_);
+    closeFile(indexFd_);
+    dataFd_ = indexFd_ = -1;
+    segments_.clear();
+    byStream_.clear();
+}
+
+bool SegmentStore::writeDataHeader(int fd, uint64_t base) {
+    DataHeader header = {};
+    header.magic = kDataMagic;
+    header.version = kStoreVersion;
+    header.base = base;
+    header.crc = crc32c(&header, offsetof(DataHeader, crc));
+    return writeAt(fd, &header, sizeof(header), 0);
+}
+
+bool SegmentStore::writeIndexHeader(int fd, uint64_t base, uint64_t firstLive) {
+    IndexHeader header = {};
+    header.magic = kIndexMagic;
+    header.version = kStoreVersion;
+    header.base = base;
+    header.firstLive = firstLive;
+    header.crc = crc32c(&header, offsetof(IndexHeader, crc));
+    return writeAt(fd, &header, sizeof(header), 0);
+}
+
+bool SegmentStore::load() {
+    uint64_t dataSize = 0;
+    uint64_t indexSize = 0;
+    if (!fileSize(dataFd_, &dataSize) || !fileSize(indexFd_, &indexSize)) {
+        return fail("cannot stat segment store: " + errorString());
+    }
+
+    // Headers: create when missing, refuse to touch a store we cannot read
+    if (dataSize < kHeaderSize) {
+        if (!truncateFile(dataFd_, 0) || !writeDataHeader(dataFd_, 0)) {
+            return fail("cannot initialize segments.dat: " + errorString());
+        }
+        dataSize = kHeaderSize;
+    }
+    DataHeader dataHeader;
+    if (!readAt(dataFd_, &dataHeader, sizeof(dataHeader), 0) || dataHeader.magic != kDataMagic ||
+        dataHeader.version != kStoreVersion || dataHeader.crc != crc32c(&dataHeader, offsetof(DataHeader, crc))) {
+        return fail("segments.dat has an invalid header");
+    }
+
+    if (indexSize < kHeaderSize) {
+        if (!truncateFile(indexFd_, 0) || !writeIndexHeader(indexFd_, 0, 0)) {
+            return fail("cannot initialize segments.idx: " + errorString());
+        }
+        indexSize = kHeaderSize;
+    }
+    IndexHeader indexHeader;
+    if (!readAt(indexFd_, &indexHeader, sizeof(indexHeader), 0) || indexHeader.magic != kIndexMagic ||
+        indexHeader.version != kStoreVersion || indexHeader.crc != crc32c(&indexHeader, offsetof(IndexHeader, crc))) {
+        return fail("segments.idx has an invalid header");
+    }
+
+    dataBase_ = dataHeader.base;
+    indexBase_ = indexHeader.base;
+    firstLive_ = std::max(indexHeader.firstLive, indexBase_);
+
+    const uint64_t dataLimit = dataBase_ + (dataSize - kHeaderSize);
+    const size_t count = static_cast<size_t>((indexSize - kHeaderSize) / sizeof(IndexEntry));
+    std::vector<IndexEntry> entries(count);
+    if (count > 0 && !readAt(indexFd_, entries.data(), count * sizeof(IndexEntry), kHeaderSize)) {
+        return fail("cannot read segments.idx: " + errorString());
+    }
+
+    // Keep the longest prefix of intact, in-order entries
+    size_t valid = 0;
+    uint64_t end = dataBase_;
+    for (; valid < count; valid++) {
+        const IndexEntry& entry = entries[valid];
+        if (entry.crc != crc32c(&entry, offsetof(IndexEntry, crc))) break;
+        const uint64_t id = indexBase_ + valid;
+        if (id >= firstLive_) {
+            if (entry.offset < end || entry.offset + entry.bytes > dataLimit) break;
+        }
+        end = std::max(end, entry.offset + entry.bytes);
+    }
+
+    // The newest payload is the one a crash may have torn
+    while (valid > 0 && indexBase_ + valid - 1 >= firstLive_) {
+        const IndexEntry& last = entries[valid - 1];
+        std::vector<uint8_t> payload(last.bytes);
+        if (last.bytes == 0 ||
+            (readAt(dataFd_, payload.data(), payload.size(), kHeaderSize + last.offset - dataBase_) &&
+             crc32c(payload.data(), payload.size()) == last.dataCrc)) {
+            break;
+        }
+        valid--;
+        end = valid > 0 ? std::max(dataBase_, entries[valid - 1].offset + entries[valid - 1].bytes) : dataBase_;
+    }
+
+    // Drop whatever a crash left behind the last good entry
+    if (indexSize != kHeaderSize + valid * sizeof(IndexEntry)) {
+        truncateFile(indexFd_, kHeaderSize + valid * sizeof(IndexEntry));
+    }
+    dataEnd_ = std::max(end, dataBase_);
+    if (dataLimit != dataEnd_) {
+        truncateFile(dataFd_, kHeaderSize + (dataEnd_ - dataBase_));
+    }
+
+    nextId_ = indexBase_ + valid;
+    firstLive_ = std::min(firstLive_, nextId_);
+    liveBytes_ = 0;
+    for (uint64_t id = firstLive_; id < nextId_; id++) {
+        const IndexEntry& entry = entries[static_cast<size_t>(id - indexBase_)];
+        StoredSegment segment;
+        segment.id = id;
+        segment.session = entry.session;
+        segment.stream = entry.stream;
+        segment.codec = static_cast<SegmentCodec>(entry.codec);
+        segment.startSample = entry.startSample;
+        segment.durationSamples = entry.durationSamples;
+        segment.sampleRate = entry.sampleRate;
+        segment.offset = entry.offset;
+        segment.bytes = entry.bytes;
+        segment.createdMs = entry.createdMs;
+        segments_.push_back(segment);
+        index(segment);
+        liveBytes_ += segment.bytes;
+    }
+    return true;
+}
+
+void SegmentStore::index(const StoredSegment& segment) {
+    std::vector<uint64_t>& ids = byStream_[StreamKey(segment.session, segment.stream)];
+    // Segments nearly always arrive in time order
+    if (ids.empty() || find(ids.back())->startSample <= segment.startSample) {
+        ids.push_back(segment.id);
+        return;
+    }
+    auto it = std::upper_bound(ids.begin(), ids.end(), segment.startSample,
+                               [this](uint64_t start, uint64_t id) { return start < find(id)->startSample; });
+    ids.insert(it, segment.id);
+}
+
+const StoredSegment* SegmentStore::find(uint64_t id) const {
+    if (id < firstLive_ || id >= nextId_) return nullptr;
+    return &segments_[static_cast<size_t>(id - firstLive_)];
+}
+
+bool SegmentStore::append(StoredSegment* meta, const void* data, size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (dataFd_ < 0) {
+        error_ = "segment store is closed";
+        return false;
+    }
+
+    meta->id = nextId_;
+    meta->offset = dataEnd_;
+    meta->bytes = static_cast<uint32_t>(bytes);
+    meta->createdMs = nowMs();
+
+    // Payload first, then the entry that makes it visible
+    if (!writeAt(dataFd_, data, bytes, kHeaderSize + (dataEnd_ - dataBase_))) {
+        error_ = "cannot write segment data: " + errorString();
+        return false;
+    }
+    if (config_.syncOnAppend) syncFile(dataFd_);
+
+    IndexEntry entry = {};
+    entry.session = meta->session;
+    entry.startSample = meta->startSample;
+    entry.offset = meta->offset;
+    entry.createdMs = meta->createdMs;
+    entry.stream = meta->stream;
+    entry.codec = static_cast<uint32_t>(meta->codec);
+    entry.sampleRate = meta->sampleRate;
+    entry.durationSamples = meta->durationSamples;
+    entry.bytes = meta->bytes;
+    entry.dataCrc = crc32c(data, bytes);
+    entry.crc = crc32c(&entry, offsetof(IndexEntry, crc));
+
+    if (!writeAt(indexFd_, &entry, sizeof(entry), entryOffset(nextId_, indexBase_))) {
+        error_ = "cannot write segment index: " + errorString();
+        // Leave dataEnd_ alone: the orphaned payload is overwritten next time
+        return false;
+    }
+    if (config_.syncOnAppend) syncFile(indexFd_);
+
+    nextId_++;
+    dataEnd_ += bytes;
+    segments_.push_back(*meta);
+    index(*meta);
+    liveBytes_ += bytes;
+
+    enforceQuotaLocked(meta->createdMs);
+    return true;
+}
+
+std::vector<StoredSegment> SegmentStore::query(uint64_t session, uint32_t stream,
+                                               uint64_t fromSample, uint64_t toSample) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<StoredSegment> result;
+
+    auto found = byStream_.find(StreamKey(session, stream));
+    if (found == byStream_.end()) return result;
+    const std::vector<uint64_t>& ids = found->second;
+
+    // First segment starting after fromSample; the one before may still cover it
+    auto it = std::upper_bound(ids.begin(), ids.end(), fromSample,
+                               [this](uint64_t start, uint64_t id) { return start < find(id)->startSample; });
+    if (it != ids.begin()) --it;
+
+    for (; it != ids.end(); ++it) {
+        const StoredSegment* segment = find(*it);
+        if (segment->startSample >= toSample) break;
+        if (segment->startSample + segment->durationSamples > fromSample) {
+            result.push_back(*segment);
+        }
+    }
+    return result;
+}
+
+std::vector<std::pair<uint64_t, uint32_t>> SegmentStore::streams() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::pair<uint64_t, uint32_t>> result;
+    result.reserve(byStream_.size());
+    for (const auto& entry : byStream_) {
+        result.push_back(entry.first);
+    }
+    return result;
+}
+
+uint32_t SegmentStore::streamSampleRate(uint64_t session, uint32_t stream) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto found = byStream_.find(StreamKey(session, stream));
+    if (found == byStream_.end() || found->second.empty()) return 0;
+    return find(found->second.back())->sampleRate;
+}
+
+bool SegmentStore::get(uint64_t id, StoredSegment* out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const StoredSegment* segment = find(id);
+    if (!segment) return false;
+    *out = *segment;
+    return true;
+}
+
+bool SegmentStore::view(uint64_t id, SegmentView* out) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const StoredSegment* segment = find(id);
+    if (!segment || dataFd_ < 0) return false;
+
+    const uint64_t start = kHeaderSize + (segment->offset - dataBase_);
+    if (!mapping_ || mapping_->size() < start + segment->bytes) {
+        // The file grew (or was compacted): map its current extent. Views
+        // handed out earlier keep the previous mapping alive.
+        uint64_t size = 0;
+        std::shared_ptr<MappedFile> mapping = std::make_shared<MappedFile>();
+        if (!fileSize(dataFd_, &size) || !mapping->map(dataFd_, size, false)) {
+            error_ = "cannot map segments.dat: " + errorString();
+            return false;
+        }
+        mapping_ = mapping;
+    }
+
+    out->mapping = mapping_;
+    out->data = mapping_->data() + start;
+    out->size = segment->bytes;
+    return true;
+}
+
+void SegmentStore::expireOldest() {
+    const StoredSegment& oldest = segments_.front();
+
+    auto found = byStream_.find(StreamKey(oldest.session, oldest.stream));
+    if (found != byStream_.end()) {
+        std::vector<uint64_t>& ids = found->second;
+        ids.erase(std::remove(ids.begin(), ids.end(), oldest.id), ids.end());
+        if (ids.empty()) byStream_.erase(found);
+    }
+
+    liveBytes_ -= oldest.bytes;
+    segments_.pop_front();
+    firstLive_++;
+    expired_++;
+}
+
+void SegmentStore::enforceQuota(uint64_t now) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (dataFd_ >= 0) enforceQuotaLocked(now);
+}
+
+void SegmentStore::enforceQuotaLocked(uint64_t now) {
+    bool changed = false;
+    while (!segments_.empty()) {
+        const StoredSegment& oldest = segments_.front();
+        const bool overCount = config_.maxSegments > 0 && segments_.size() > config_.maxSegments;
+        const bool overBytes = config_.maxBytes > 0 && liveBytes_ > config_.maxBytes;
+        const bool tooOld = config_.maxAgeMs > 0 && now > oldest.createdMs &&
+                            now - oldest.createdMs > config_.maxAgeMs;
+        if (!overCount && !overBytes && !tooOld) break;
+        expireOldest();
+        changed = true;
+    }
+    if (!changed) return;
+
+    writeIndexHeader(indexFd_, indexBase_, firstLive_);
+
+    // Reclaim the expired prefix once it outweighs the live data
+    const uint64_t liveStart = segments_.empty() ? dataEnd_ : segments_.front().offset;
+    const uint64_t dead = liveStart - dataBase_;
+    if (dead >= kCompactMinDeadBytes && dead > liveBytes_) {
+        compactLocked();
+    }
+}
+
+bool SegmentStore::compact() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (dataFd_ < 0) return false;
+    return compactLocked();
+}
+
+bool SegmentStore::compactLocked() {
+    const uint64_t newDataBase = segments_.empty() ? dataEnd_ : segments_.front().offset;
+    const std::string dataPath = path("segments.dat");
+    const std::string indexPath = path("segments.idx");
+    const std::string dataTemp = dataPath + ".compact";
+    const std::string indexTemp = indexPath + ".compact";
+
+    int dataOut = openFile(dataTemp, true);
+    int indexOut = openFile(indexTemp, true);
+    bool ok = dataOut >= 0 && indexOut >= 0 && writeDataHeader(dataOut, newDataBase) &&
+              writeIndexHeader(indexOut, firstLive_, firstLive_);
+
+    // Copy the live payloads and entries verbatim; offsets and ids do not change
+    std::vector<uint8_t> buffer;
+    struct Range { int from; int to; uint64_t src; uint64_t dst; uint64_t length; };
+    const Range ranges[2] = {
+        {dataFd_, dataOut, kHeaderSize + (newDataBase - dataBase_), kHeaderSize, dataEnd_ - newDataBase},
+        {indexFd_, indexOut, entryOffset(firstLive_, indexBase_), kHeaderSize,
+         (nextId_ - firstLive_) * sizeof(IndexEntry)},
+    };
+    for (const Range& range : ranges) {
+        for (uint64_t done = 0; ok && done < range.length;) {
+            const size_t n = static_cast<size_t>(std::min<uint64_t>(kCopyChunk, range.length - done));
+            buffer.resize(n);
+            ok = readAt(range.from, buffer.data(), n, range.src + done) &&
+                 writeAt(range.to, buffer.data(), n, range.dst + done);
+            done += n;
+        }
+    }
+    ok = ok && syncFile(dataOut) && syncFile(indexOut);
+    closeFile(dataOut);
+    closeFile(indexOut);
+
+    if (ok) {
+        // Windows cannot replace open files
+        closeFile(dataFd_);
+        closeFile(indexFd_);
+        mapping_.reset();
+        // The data file goes first: the old index stays valid against it
+        ok = renameFile(dataTemp, dataPath);
+        if (ok) {
+            dataBase_ = newDataBase;
+            if (renameFile(indexTemp, indexPath)) {
+                indexBase_ = firstLive_;
+            }
+        }
+        dataFd_ = openFile(dataPath, false);
+        indexFd_ = openFile(indexPath, false);
+        if (dataFd_ < 0 || indexFd_ < 0) {
+            return fail("cannot reopen segment store after compaction: " + errorString());
+        }
+    }
+
+    removeFile(dataTemp);
+    removeFile(indexTemp);
+    if (ok) compactions_++;
+    return ok;
+}
+
+SegmentStoreStats SegmentStore::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    SegmentStoreStats stats;
+    stats.segments = segments_.size();
+    stats.liveBytes = liveBytes_;
+    stats.fileBytes = kHeaderSize + (dataEnd_ - dataBase_);
+    stats.expiredSegments = expired_;
+    stats.compactions = compactions_;
+    return stats;
+}
+
+SegmentCodec segmentCodecFromName(const std::string& name, bool* ok) {
+    *ok = true;
+    if (name == "pcm16") return SegmentCodec::Pcm16;
+    if (name == "wav") return SegmentCodec::Wav;
+    if (name == "flac") return SegmentCodec::Flac;
+    if (name == "opus") return SegmentCodec::OggOpus;
+    if (name == "mp3") return SegmentCodec::Mp3;
+    *ok = false;
+    return SegmentCodec::Pcm16;
+}
+
+const char* segmentCodecName(SegmentCodec codec) {
+    switch (codec) {
+        case SegmentCodec::Pcm16: return "pcm16";
+        case SegmentCodec::Wav: return "wav";
+        case SegmentCodec::Flac: return "flac";
+        case SegmentCodec::OggOpus: return "opus";
+        case SegmentCodec::Mp3: return "mp3";
+    }
+    return "pcm16";
+}
+
+} // namespace storage
@@ -0,0 +1,155 @@
+// Append-only store for captured audio segments
+//
+// Two files in one directory:
+//   segments.dat   64-byte header, then segment payloads back to back
+//   segments.idx   64-byte header, then one 64-byte entry per segment
+//
+// Offsets in the index are logical: the data header records the logical
+// offset of its first payload byte, so compaction can drop the expired
+// prefix of the data file without rewriting a single index entry. Entry ids
+// are stable for the same reason (the index header records the id of its
+// first entry).
+//
+// Segments expire oldest-first under the byte / age / count quotas. Lookups
+// by time go through a per-(session, stream) vector sorted by start sample,
+// so a time range costs one binary search. Segments of one stream are
+// assumed not to overlap.
+//
+// Payloads are read through a read-only mapping of the data file. A view
+// holds a reference to the mapping it came from, so it stays valid across
+// remaps (the file grew) and compaction (the file was replaced).
+
+#ifndef STORAGE_SEGMENT_STORE_H
+#define STORAGE_SEGMENT_STORE_H
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "mapped_file.h"
+
+namespace storage {
+
+enum class SegmentCodec : uint32_t {
+    Pcm16 = 0,
+    Wav = 1,
+    Flac = 2,
+    OggOpus = 3,
+    Mp3 = 4
+};
+
+struct StoredSegment {
+    uint64_t id = 0;
+    uint64_t session = 0;
+    uint32_t stream = 0;
+    SegmentCodec codec = SegmentCodec::Pcm16;
+    uint64_t startSample = 0;
+    uint32_t durationSamples = 0;
+    uint32_t sampleRate = 0;
+    uint64_t offset = 0;      // logical offset in segments.dat
+    uint32_t bytes = 0;
+    uint64_t createdMs = 0;   // wall clock, used by the age quota
+};
+
+struct SegmentStoreConfig {
+    std::string directory;
+    uint64_t maxBytes = 0;       // 0 = unlimited
+    uint64_t maxAgeMs = 0;
+    uint32_t maxSegments = 0;
+    bool syncOnAppend = false;   // fsync data, then index, on every append
+};
+
+struct SegmentStoreStats {
+    uint64_t segments = 0;
+    uint64_t liveBytes = 0;
+    uint64_t fileBytes = 0;
+    uint64_t expiredSegments = 0;
+    uint64_t compactions = 0;
+};
+
+// Read-only payload view; keeps its mapping alive
+struct SegmentView {
+    std::shared_ptr<const MappedFile> mapping;
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+};
+
+class SegmentStore {
+public:
+    SegmentStore();
+    ~SegmentStore();
+
+    SegmentStore(const SegmentStore&) = delete;
+    SegmentStore& operator=(const SegmentStore&) = delete;
+
+    // Open or create the store and drop any entry (and payload tail) that a
+    // crash left half-written. Returns false and sets error() on failure.
+    bool open(const SegmentStoreConfig& config);
+    void close();
+
+    // Append one segment. meta.id, offset, bytes and createdMs are filled in.
+    bool append(StoredSegment* meta, const void* data, size_t bytes);
+
+    // Segments of one stream overlapping [fromSample, toSample), in time order
+    std::vector<StoredSegment> query(uint64_t session, uint32_t stream,
+                                     uint64_t fromSample, uint64_t toSample) const;
+    std::vector<std::pair<uint64_t, uint32_t>> streams() const;
+    uint32_t streamSampleRate(uint64_t session, uint32_t stream) const;  // 0 if unknown
+    bool get(uint64_t id, StoredSegment* out) const;
+    bool view(uint64_t id, SegmentView* out);
+
+    // Expire segments over quota (also done on every append).
+    void enforceQuota(uint64_t nowMs);
+    // Rewrite both files without the expired prefix. Returns false if the
+    // files could not be replaced (e.g. still mapped on Windows).
+    bool compact();
+
+    SegmentStoreStats stats() const;
+    const std::string& error() const { return error_; }
+
+private:
+    using StreamKey = std::pair<uint64_t, uint32_t>;
+
+    mutable std::mutex mutex_;
+    SegmentStoreConfig config_;
+    std::string error_;
+    int dataFd_;
+    int indexFd_;
+
+    uint64_t dataBase_;      // logical offset of the first payload byte on disk
+    uint64_t dataEnd_;       // logical end of the last payload
+    uint64_t indexBase_;     // id of the first entry on disk
+    uint64_t firstLive_;     // id of the oldest unexpired segment
+    uint64_t nextId_;
+
+    std::deque<StoredSegment> segments_;          // live, in id order
+    std::map<StreamKey, std::vector<uint64_t>> byStream_;  // ids sorted by start
+    uint64_t liveBytes_;
+    uint64_t expired_;
+    uint64_t compactions_;
+
+    std::shared_ptr<MappedFile> mapping_;
+
+    const StoredSegment* find(uint64_t id) const;
+    void index(const StoredSegment& segment);
+    void expireOldest();
+    void enforceQuotaLocked(uint64_t nowMs);
+    bool writeDataHeader(int fd, uint64_t base);
+    bool writeIndexHeader(int fd, uint64_t base, uint64_t firstLive);
+    bool load();
+    bool compactLocked();
+    std::string path(const char* name) const;
+    bool fail(const std::string& message);
+};
+
+SegmentCodec segmentCodecFromName(const std::string& name, bool* ok);
+const char* segmentCodecName(SegmentCodec codec);
+
+} // namespace storage
+
+#endif
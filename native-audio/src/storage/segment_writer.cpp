@@ -0,0 +1,395 @@
+#include "segment_writer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include "file_util.h"
+
+namespace storage {
+
+namespace {
+
+constexpr size_t kWavHeaderSize = 44;
+constexpr uint64_t kDefaultPreallocateBytes = 4 * 1024 * 1024;
+constexpr uint64_t kMinGrowBytes = 1024 * 1024;
+constexpr size_t kMaxFreeBlocks = 64;
+
+void putLE16(uint8_t* p, uint16_t v) {
+    p[0] = v & 0xff;
+    p[1] = v >> 8;
+}
+
+void putLE32(uint8_t* p, uint32_t v) {
+    for (int i = 0; i < 4; i++) p[i] = (v >> (8 * i)) & 0xff;
+}
+
+void buildWavHeader(uint8_t* h, int sampleRate, int channels, uint64_t dataBytes) {
+    // RIFF sizes are 32-bit; clamp so oversized files still parse as "to EOF"
+    const uint32_t data = dataBytes > 0xffffffffull - 36 ? 0xffffffffu - 36 : static_cast<uint32_t>(dataBytes);
+    const uint16_t blockAlign = static_cast<uint16_t>(channels * 2);
+    std::memcpy(h, "RIFF", 4);
+    putLE32(h + 4, 36 + data);
+    std::memcpy(h + 8, "WAVE", 4);
+    std::memcpy(h + 12, "fmt ", 4);
+    putLE32(h + 16, 16);
+    putLE16(h + 20, 1);  // PCM
+    putLE16(h + 22, static_cast<uint16_t>(channels));
+    putLE32(h + 24, static_cast<uint32_t>(sampleRate));
+    putLE32(h + 28, static_cast<uint32_t>(sampleRate) * blockAlign);
+    putLE16(h + 32, blockAlign);
+    putLE16(h + 34, 16);
+    std::memcpy(h + 36, "data", 4);
+    putLE32(h + 40, data);
+}
+
+inline int16_t floatToInt16(float s) {
+    s = std::max(-1.0f, std::min(1.0f, s));
+    return static_cast<int16_t>(s < 0 ? s * 32768.0f : s * 32767.0f);
+}
+
+std::string joinPath(const std::string& dir, const std::string& name) {
+    if (dir.empty()) return name;
+    const char last = dir.back();
+    if (last == '/' || last == '\\') return dir + name;
+    return dir + "/" + name;
+}
+
+} // namespace
+
+const char* segmentFormatExtension(SegmentFormat format) {
+    return format == SegmentFormat::Flac ? "flac" : "wav";
+}
+
+SegmentWriter::SegmentWriter(const SegmentWriterConfig& config, SegmentCallback onSegment)
+    : config_(config),
+      onSegment_(std::move(onSegment)),
+      stopping_(false),
+      closed_(false),
+      framesQueued_(0),
+      bytesWritten_(0),
+      fd_(-1),
+      fileOffset_(0),
+      allocated_(0),
+      timelineFrame_(0),
+      nextIndex_(0),
+      lastSync_(std::chrono::steady_clock::now()),
+      dropUntilRotate_(false) {
+    const auto now = std::chrono::system_clock::now().time_since_epoch();
+    sessionTag_ = std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(now).count());
+
+    if (config_.format == SegmentFormat::Flac) {
+        flac_ = std::make_unique<FlacEncoder>(config_.sampleRate, config_.channels);
+    }
+    encoded_.reserve(64 * 1024);
+
+    thread_ = std::thread(&SegmentWriter::run, this);
+}
+
+SegmentWriter::~SegmentWriter() {
+    close();
+}
+
+size_t SegmentWriter::queueDepth() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queue_.size();
+}
+
+std::unique_ptr<SegmentWriter::Block> SegmentWriter::takeBlock() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (freeBlocks_.empty()) {
+        return std::make_unique<Block>();
+    }
+    std::unique_ptr<Block> block = std::move(freeBlocks_.back());
+    freeBlocks_.pop_back();
+    block->samples.clear();
+    block->rotate = false;
+    return block;
+}
+
+void SegmentWriter::enqueue(std::unique_ptr<Block> block) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (closed_) return;
+        queue_.push_back(std::move(block));
+    }
+    cv_.notify_one();
+}
+
+void SegmentWriter::append(const float* samples, size_t numSamples) {
+    if (numSamples == 0) return;
+    std::unique_ptr<Block> block = takeBlock();
+    block->samples.resize(numSamples);
+    for (size_t i = 0; i < numSamples; i++) {
+        block->samples[i] = floatToInt16(samples[i]);
+    }
+    framesQueued_.fetch_add(numSamples / config_.channels, std::memory_order_relaxed);
+    enqueue(std::move(block));
+}
+
+void SegmentWriter::append(const int16_t* samples, size_t numSamples) {
+    if (numSamples == 0) return;
+    std::unique_ptr<Block> block = takeBlock();
+    block->samples.assign(samples, samples + numSamples);
+    framesQueued_.fetch_add(numSamples / config_.channels, std::memory_order_relaxed);
+    enqueue(std::move(block));
+}
+
+void SegmentWriter::rotate() {
+    std::unique_ptr<Block> block = takeBlock();
+    block->rotate = true;
+    enqueue(std::move(block));
+}
+
+void SegmentWriter::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (closed_) return;
+        stopping_ = true;
+        closed_ = true;
+    }
+    cv_.notify_one();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void SegmentWriter::run() {
+    for (;;) {
+        std::unique_ptr<Block> block;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (config_.fsync == FsyncPolicy::Interval && fd_ >= 0) {
+                cv_.wait_for(lock, std::chrono::milliseconds(config_.fsyncIntervalMs),
+                             [this] { return stopping_ || !queue_.empty(); });
+            } else {
+                cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            }
+            if (!queue_.empty()) {
+                block = std::move(queue_.front());
+                queue_.pop_front();
+            } else if (stopping_) {
+                break;
+            }
+        }
+
+        if (block) {
+            const size_t frames = block->samples.size() / config_.channels;
+            if (frames > 0) {
+                writeSamples(block->samples.data(), frames);
+            }
+            if (block->rotate) {
+                closeSegment();
+                dropUntilRotate_ = false;
+            }
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (freeBlocks_.size() < kMaxFreeBlocks) {
+                freeBlocks_.push_back(std::move(block));
+            }
+        }
+
+        maybeSync();
+    }
+
+    closeSegment();
+}
+
+uint64_t SegmentWriter::frameLimit() const {
+    if (config_.maxDurationMs == 0) return 0;
+    return std::max<uint64_t>(1, config_.maxDurationMs * config_.sampleRate / 1000);
+}
+
+void SegmentWriter::writeSamples(const int16_t* samples, size_t frames) {
+    const size_t channels = static_cast<size_t>(config_.channels);
+    const uint64_t limit = frameLimit();
+
+    while (frames > 0) {
+        if (fd_ < 0) {
+            if (dropUntilRotate_ || !openSegment()) {
+                timelineFrame_ += frames;
+                return;
+            }
+        }
+
+        size_t take = frames;
+        if (limit > 0) {
+            take = static_cast<size_t>(std::min<uint64_t>(take, limit - current_.frames));
+        }
+
+        const uint8_t* data;
+        size_t length;
+        if (flac_) {
+            encoded_.clear();
+            flac_->encode(samples, take, encoded_);
+            data = encoded_.data();
+            length = encoded_.size();
+        } else {
+            data = reinterpret_cast<const uint8_t*>(samples);
+            length = take * channels * sizeof(int16_t);
+        }
+
+        if (length > 0) {
+            ensureAllocated(fileOffset_ + length);
+            if (!writeAt(fd_, data, length, fileOffset_)) {
+                fail("write failed: " + errorString());
+                timelineFrame_ += frames;
+                return;
+            }
+            fileOffset_ += length;
+            bytesWritten_.fetch_add(length, std::memory_order_relaxed);
+        }
+
+        current_.frames += take;
+        timelineFrame_ += take;
+        samples += take * channels;
+        frames -= take;
+
+        if (config_.fsync == FsyncPolicy::Always) {
+            writeHeader();
+            syncFile(fd_);
+        }
+
+        const bool durationReached = limit > 0 && current_.frames >= limit;
+        const bool sizeReached = config_.maxBytes > 0 && fileOffset_ >= config_.maxBytes;
+        if (durationReached || sizeReached) {
+            closeSegment();
+        }
+    }
+}
+
+bool SegmentWriter::openSegment() {
+    if (!makeDirectories(config_.directory)) {
+        fail("cannot create directory " + config_.directory + ": " + errorString());
+        return false;
+    }
+
+    char suffix[16];
+    std::snprintf(suffix, sizeof(suffix), "%06u", nextIndex_);
+    const std::string name = config_.prefix + "_" + sessionTag_ + "_" + suffix + "." +
+                             segmentFormatExtension(config_.format);
+
+    current_ = SegmentInfo();
+    current_.path = joinPath(config_.directory, name);
+    current_.index = nextIndex_++;
+    current_.startFrame = timelineFrame_;
+
+    fd_ = openFile(current_.path, true);
+    if (fd_ < 0) {
+        fail("cannot open " + current_.path + ": " + errorString());
+        return false;
+    }
+
+    uint64_t initial = config_.preallocateBytes;
+    if (initial == 0) {
+        const uint64_t frameBytes = static_cast<uint64_t>(config_.channels) * 2;
+        initial = kDefaultPreallocateBytes;
+        if (config_.maxDurationMs > 0) {
+            initial = frameLimit() * frameBytes + kWavHeaderSize;
+            if (flac_) initial = initial * 3 / 5;
+        }
+        if (config_.maxBytes > 0) {
+            initial = std::min(initial, config_.maxBytes + kWavHeaderSize);
+        }
+    }
+    allocated_ = 0;
+    ensureAllocated(initial);
+
+    fileOffset_ = 0;
+    encoded_.clear();
+    if (flac_) {
+        flac_->begin(encoded_);
+    } else {
+        encoded_.resize(kWavHeaderSize);
+        buildWavHeader(encoded_.data(), config_.sampleRate, config_.channels, 0);
+    }
+    if (!writeAt(fd_, encoded_.data(), encoded_.size(), 0)) {
+        fail("header write failed: " + errorString());
+        return false;
+    }
+    fileOffset_ = encoded_.size();
+    lastSync_ = std::chrono::steady_clock::now();
+    return true;
+}
+
+void SegmentWriter::writeHeader() {
+    if (fd_ < 0) return;
+    if (flac_) {
+        // Mid-stream this describes the frames written so far, which is
+        // exactly what a reader of a crashed file needs
+        std::vector<uint8_t> info;
+        info.reserve(FlacEncoder::kHeaderSize);
+        flac_->streamInfo(info);
+        writeAt(fd_, info.data(), info.size(), FlacEncoder::kStreamInfoOffset);
+    } else {
+        uint8_t header[kWavHeaderSize];
+        buildWavHeader(header, config_.sampleRate, config_.channels, fileOffset_ - kWavHeaderSize);
+        writeAt(fd_, header, sizeof(header), 0);
+    }
+}
+
+void SegmentWriter::closeSegment() {
+    if (fd_ < 0) return;
+
+    if (flac_) {
+        encoded_.clear();
+        flac_->finish(encoded_);
+        if (!encoded_.empty()) {
+            if (writeAt(fd_, encoded_.data(), encoded_.size(), fileOffset_)) {
+                fileOffset_ += encoded_.size();
+                bytesWritten_.fetch_add(encoded_.size(), std::memory_order_relaxed);
+            }
+        }
+    }
+
+    writeHeader();
+    // Give back any preallocated tail that was not used
+    truncateFile(fd_, fileOffset_);
+    if (config_.fsync != FsyncPolicy::None) {
+        syncFile(fd_);
+    }
+    closeFile(fd_);
+    fd_ = -1;
+
+    current_.bytes = fileOffset_;
+    current_.durationMs = current_.frames * 1000.0 / config_.sampleRate;
+    if (onSegment_) {
+        onSegment_(current_);
+    }
+}
+
+void SegmentWriter::ensureAllocated(uint64_t size) {
+    if (size <= allocated_) return;
+    const uint64_t grow = std::max(size, allocated_ + std::max(kMinGrowBytes, allocated_ / 2));
+    if (preallocate(fd_, grow)) {
+        allocated_ = grow;
+    } else {
+        // Out of space or unsupported; writes will report the real error
+        allocated_ = size;
+    }
+}
+
+void SegmentWriter::maybeSync() {
+    if (fd_ < 0 || config_.fsync != FsyncPolicy::Interval) return;
+    const auto now = std::chrono::steady_clock::now();
+    if (now - lastSync_ < std::chrono::milliseconds(config_.fsyncIntervalMs)) return;
+    // Refresh the header first so a crash leaves a playable file
+    writeHeader();
+    syncFile(fd_);
+    lastSync_ = now;
+}
+
+void SegmentWriter::fail(const std::string& message) {
+    SegmentInfo info = current_;
+    info.error = message;
+    if (fd_ >= 0) {
+        closeFile(fd_);
+        fd_ = -1;
+    }
+    dropUntilRotate_ = true;
+    if (onSegment_) {
+        onSegment_(info);
+    }
+}
+
+} // namespace storage
@@ -0,0 +1,136 @@
+// Background segment writer for captured PCM
+//
+// append() copies samples into a pooled block and returns; a dedicated I/O
+// thread converts them to 16-bit WAV or FLAC and writes them into files that
+// are preallocated up front. Segments rotate by duration and/or size and
+// every closed segment is reported through the callback (on the I/O thread).
+
+#ifndef STORAGE_SEGMENT_WRITER_H
+#define STORAGE_SEGMENT_WRITER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "flac_encoder.h"
+
+namespace storage {
+
+enum class SegmentFormat { Wav, Flac };
+
+enum class FsyncPolicy {
+    None,       // leave it to the OS
+    OnClose,    // fsync each segment when it is closed
+    Interval,   // also fsync (and refresh headers) every fsyncIntervalMs
+    Always      // fsync after every write batch
+};
+
+struct SegmentWriterConfig {
+    std::string directory;
+    std::string prefix = "segment";
+    SegmentFormat format = SegmentFormat::Wav;
+    int sampleRate = 16000;
+    int channels = 1;
+    uint64_t maxDurationMs = 0;     // 0 = no duration limit
+    uint64_t maxBytes = 0;          // 0 = no size limit
+    uint64_t preallocateBytes = 0;  // 0 = derive from the limits
+    FsyncPolicy fsync = FsyncPolicy::OnClose;
+    uint32_t fsyncIntervalMs = 1000;
+};
+
+struct SegmentInfo {
+    std::string path;
+    uint32_t index = 0;
+    uint64_t startFrame = 0;   // position in the writer's timeline
+    uint64_t frames = 0;
+    uint64_t bytes = 0;
+    double durationMs = 0.0;
+    std::string error;         // non-empty if the segment failed
+};
+
+class SegmentWriter {
+public:
+    using SegmentCallback = std::function<void(const SegmentInfo&)>;
+
+    SegmentWriter(const SegmentWriterConfig& config, SegmentCallback onSegment);
+    ~SegmentWriter();
+
+    SegmentWriter(const SegmentWriter&) = delete;
+    SegmentWriter& operator=(const SegmentWriter&) = delete;
+
+    // Queue interleaved samples. Never blocks on disk.
+    void append(const float* samples, size_t numSamples);
+    void append(const int16_t* samples, size_t numSamples);
+
+    // Close the current segment after everything queued so far.
+    void rotate();
+
+    // Drain the queue, close the open segment and stop the I/O thread.
+    // Safe to call more than once; the destructor calls it too.
+    void close();
+
+    const SegmentWriterConfig& config() const { return config_; }
+    uint64_t framesQueued() const { return framesQueued_.load(std::memory_order_relaxed); }
+    uint64_t bytesWritten() const { return bytesWritten_.load(std::memory_order_relaxed); }
+    size_t queueDepth() const;
+
+private:
+    struct Block {
+        std::vector<int16_t> samples;
+        bool rotate = false;
+    };
+
+    SegmentWriterConfig config_;
+    SegmentCallback onSegment_;
+
+    // Producer/consumer queue between append() and the I/O thread
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::unique_ptr<Block>> queue_;
+    std::vector<std::unique_ptr<Block>> freeBlocks_;
+    bool stopping_;
+    bool closed_;
+    std::thread thread_;
+
+    std::atomic<uint64_t> framesQueued_;
+    std::atomic<uint64_t> bytesWritten_;
+
+    // I/O thread state
+    int fd_;
+    SegmentInfo current_;
+    uint64_t fileOffset_;
+    uint64_t allocated_;
+    uint64_t timelineFrame_;
+    uint32_t nextIndex_;
+    std::string sessionTag_;
+    std::vector<uint8_t> encoded_;
+    std::unique_ptr<FlacEncoder> flac_;
+    std::chrono::steady_clock::time_point lastSync_;
+    bool dropUntilRotate_;
+
+    std::unique_ptr<Block> takeBlock();
+    void enqueue(std::unique_ptr<Block> block);
+    void run();
+    void writeSamples(const int16_t* samples, size_t frames);
+    bool openSegment();
+    void closeSegment();
+    void writeHeader();
+    void ensureAllocated(uint64_t size);
+    void maybeSync();
+    void fail(const std::string& message);
+    uint64_t frameLimit() const;
+};
+
+const char* segmentFormatExtension(SegmentFormat format);
+
+} // namespace storage
+
+#endif
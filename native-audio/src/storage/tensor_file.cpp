@@ -0,0 +1,331 @@
+#include "tensor_file.h"
+
+#include <cstddef>
+#include <cstring>
+
+#include "checksum.h"
+#include "file_util.h"
+
+namespace storage {
+
+namespace {
+
+const uint32_t kMagic = 0x52534E54;   // "TNSR"
+const size_t kMaxDims = 4;
+const size_t kKindLength = 16;
+
+struct FileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t alignment;
+    uint32_t count;
+    uint64_t indexOffset;
+    uint64_t indexBytes;
+    uint64_t fileBytes;
+    char kind[kKindLength];
+    uint32_t indexCrc;
+    uint32_t crc;
+};
+
+struct IndexEntry {
+    uint32_t type;
+    uint32_t dims;
+    int64_t shape[kMaxDims];
+    uint64_t offset;
+    uint64_t bytes;
+    uint64_t scaleOffset;
+    uint64_t scaleBytes;
+    uint32_t groupSize;
+    uint32_t dataCrc;
+    uint32_t nameLength;
+    uint32_t reserved[3];
+};
+
+static_assert(sizeof(FileHeader) == 64, "tensor file header layout");
+static_assert(sizeof(IndexEntry) == 96, "tensor index entry layout");
+
+uint64_t alignUp(uint64_t value, uint64_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+bool withinFile(uint64_t offset, uint64_t bytes, uint64_t fileBytes) {
+    return offset <= fileBytes && bytes <= fileBytes - offset;
+}
+
+} // namespace
+
+TensorFile::TensorFile() {
+}
+
+TensorFile::~TensorFile() {
+}
+
+bool TensorFile::isTensorFile(const std::string& path) {
+    const int fd = openReadOnly(path);
+    if (fd < 0) return false;
+    uint32_t magic = 0;
+    const bool ok = readAt(fd, &magic, sizeof(magic), 0) && magic == kMagic;
+    closeFile(fd);
+    return ok;
+}
+
+bool TensorFile::open(const std::string& path, const std::string& kind, std::string* error) {
+    const int fd = openReadOnly(path);
+    if (fd < 0) {
+        *error = "cannot open " + path + ": " + errorString();
+        return false;
+    }
+    uint64_t fileBytes = 0;
+    const bool mapped = fileSize(fd, &fileBytes) && fileBytes >= sizeof(FileHeader) &&
+                        map_.map(fd, fileBytes, false);
+    // The mapping keeps its own reference to the file
+    closeFile(fd);
+    if (!mapped) {
+        *error = path + " is not a tensor file";
+        return false;
+    }
+
+    FileHeader header;
+    std::memcpy(&header, map_.data(), sizeof(header));
+    if (header.magic != kMagic) {
+        *error = path + " is not a tensor file";
+        return false;
+    }
+    if (header.version != kVersion) {
+        *error = path + " has tensor format version " + std::to_string(header.version) +
+                 " (expected " + std::to_string(kVersion) + ")";
+        return false;
+    }
+    if (crc32c(&header, offsetof(FileHeader, crc)) != header.crc) {
+        *error = path + ": corrupt header";
+        return false;
+    }
+    if (header.fileBytes != fileBytes || !withinFile(header.indexOffset, header.indexBytes, fileBytes)) {
+        *error = path + ": truncated";
+        return false;
+    }
+    const uint8_t* index = map_.data() + header.indexOffset;
+    if (crc32c(index, static_cast<size_t>(header.indexBytes)) != header.indexCrc) {
+        *error = path + ": corrupt index";
+        return false;
+    }
+    kind_.assign(header.kind, strnlen(header.kind, kKindLength));
+    if (!kind.empty() && kind_ != kind) {
+        *error = path + " holds a " + kind_ + " model, not " + kind;
+        return false;
+    }
+
+    tensors_.clear();
+    byName_.clear();
+    uint64_t position = 0;
+    for (uint32_t i = 0; i < header.count; i++) {
+        IndexEntry entry;
+        if (!withinFile(position, sizeof(entry), header.indexBytes)) break;
+        std::memcpy(&entry, index + position, sizeof(entry));
+        position += sizeof(entry);
+        if (entry.dims > kMaxDims || !withinFile(position, entry.nameLength, header.indexBytes) ||
+            !withinFile(entry.offset, entry.bytes, fileBytes) ||
+            !withinFile(entry.scaleOffset, entry.scaleBytes, fileBytes) || entry.offset % kAlignment != 0 ||
+            entry.type > static_cast<uint32_t>(TensorType::Q4)) {
+            break;
+        }
+
+        TensorInfo info;
+        info.name.assign(reinterpret_cast<const char*>(index + position), entry.nameLength);
+        info.type = static_cast<TensorType>(entry.type);
+        info.shape.assign(entry.shape, entry.shape + entry.dims);
+        info.groupSize = entry.groupSize;
+        info.offset = entry.offset;
+        info.bytes = entry.bytes;
+        info.scaleOffset = entry.scaleOffset;
+        info.scaleBytes = entry.scaleBytes;
+        info.crc = entry.dataCrc;
+        position = alignUp(position + entry.nameLength, 8);
+
+        byName_[info.name] = tensors_.size();
+        tensors_.push_back(std::move(info));
+    }
+    if (tensors_.size() != header.count) {
+        *error = path + ": invalid tensor index";
+        tensors_.clear();
+        byName_.clear();
+        return false;
+    }
+
+    state_.reset(new std::atomic<uint8_t>[tensors_.size()]);
+    for (size_t i = 0; i < tensors_.size(); i++) state_[i].store(0);
+    return true;
+}
+
+const TensorInfo* TensorFile::find(const std::string& name) const {
+    auto found = byName_.find(name);
+    return found == byName_.end() ? nullptr : &tensors_[found->second];
+}
+
+bool TensorFile::verify(const TensorInfo& tensor, std::string* error) const {
+    const size_t index = static_cast<size_t>(&tensor - tensors_.data());
+    uint8_t state = state_[index].load(std::memory_order_acquire);
+    if (state == 0) {
+        // Concurrent first accesses may both compute the checksum; harmless
+        uint32_t crc = crc32c(map_.data() + tensor.offset, static_cast<size_t>(tensor.bytes));
+        crc = crc32c(map_.data() + tensor.scaleOffset, static_cast<size_t>(tensor.scaleBytes), crc);
+        state = crc == tensor.crc ? 1 : 2;
+        state_[index].store(state, std::memory_order_release);
+    }
+    if (state != 1) {
+        *error = "tensor " + tensor.name + " is corrupt (checksum mismatch)";
+        return false;
+    }
+    return true;
+}
+
+const uint8_t* TensorFile::data(const TensorInfo& tensor, std::string* error) const {
+    return verify(tensor, error) ? map_.data() + tensor.offset : nullptr;
+}
+
+const uint8_t* TensorFile::scales(const TensorInfo& tensor, std::string* error) const {
+    return verify(tensor, error) ? map_.data() + tensor.scaleOffset : nullptr;
+}
+
+bool TensorFile::verifyAll(std::string* error) const {
+    for (const TensorInfo& tensor : tensors_) {
+        if (!verify(tensor, error)) return false;
+    }
+    return true;
+}
+
+TensorFileWriter::TensorFileWriter()
+    : fd_(-1), end_(0) {
+}
+
+TensorFileWriter::~TensorFileWriter() {
+    abandon();
+}
+
+bool TensorFileWriter::open(const std::string& path, const std::string& kind, std::string* error) {
+    abandon();
+    if (kind.size() > kKindLength) {
+        *error = "tensor file kind too long";
+        return false;
+    }
+    path_ = path;
+    tempPath_ = path + ".tmp";
+    kind_ = kind;
+    tensors_.clear();
+    fd_ = openFile(tempPath_, true);
+    if (fd_ < 0) {
+        *error = "cannot create " + tempPath_ + ": " + errorString();
+        return false;
+    }
+    end_ = TensorFile::kAlignment;   // header, padded
+    return true;
+}
+
+bool TensorFileWriter::writePadded(const void* data, uint64_t bytes, uint64_t* offset,
+                                   std::string* error) {
+    *offset = alignUp(end_, TensorFile::kAlignment);
+    if (bytes > 0 && !writeAt(fd_, data, static_cast<size_t>(bytes), *offset)) {
+        *error = "cannot write " + tempPath_ + ": " + errorString();
+        return false;
+    }
+    end_ = *offset + bytes;
+    return true;
+}
+
+bool TensorFileWriter::add(const std::string& name, TensorType type, const std::vector<int64_t>& shape,
+                           const void* data, uint64_t bytes, std::string* error) {
+    return addQuantized(name, type, shape, 0, data, bytes, nullptr, 0, error);
+}
+
+bool TensorFileWriter::addQuantized(const std::string& name, TensorType type,
+                                    const std::vector<int64_t>& shape, uint32_t groupSize,
+                                    const void* data, uint64_t bytes, const float* scales,
+                                    uint64_t scaleBytes, std::string* error) {
+    if (fd_ < 0) {
+        *error = "tensor file is not open";
+        return false;
+    }
+    if (shape.size() > kMaxDims || name.empty() || name.size() > 1024) {
+        *error = "invalid tensor " + name;
+        return false;
+    }
+
+    TensorInfo info;
+    info.name = name;
+    info.type = type;
+    info.shape = shape;
+    info.groupSize = groupSize;
+    info.bytes = bytes;
+    info.scaleBytes = scaleBytes;
+    if (!writePadded(data, bytes, &info.offset, error)) return false;
+    info.scaleOffset = info.offset + bytes;
+    if (scaleBytes > 0 && !writePadded(scales, scaleBytes, &info.scaleOffset, error)) return false;
+    info.crc = crc32c(data, static_cast<size_t>(bytes));
+    info.crc = crc32c(scales, static_cast<size_t>(scaleBytes), info.crc);
+    tensors_.push_back(std::move(info));
+    return true;
+}
+
+bool TensorFileWriter::commit(std::string* error) {
+    if (fd_ < 0) {
+        *error = "tensor file is not open";
+        return false;
+    }
+
+    std::vector<uint8_t> index;
+    for (const TensorInfo& tensor : tensors_) {
+        IndexEntry entry;
+        std::memset(&entry, 0, sizeof(entry));
+        entry.type = static_cast<uint32_t>(tensor.type);
+        entry.dims = static_cast<uint32_t>(tensor.shape.size());
+        for (size_t d = 0; d < tensor.shape.size(); d++) entry.shape[d] = tensor.shape[d];
+        entry.offset = tensor.offset;
+        entry.bytes = tensor.bytes;
+        entry.scaleOffset = tensor.scaleOffset;
+        entry.scaleBytes = tensor.scaleBytes;
+        entry.groupSize = tensor.groupSize;
+        entry.dataCrc = tensor.crc;
+        entry.nameLength = static_cast<uint32_t>(tensor.name.size());
+
+        const size_t at = index.size();
+        index.resize(alignUp(at + sizeof(entry) + tensor.name.size(), 8), 0);
+        std::memcpy(index.data() + at, &entry, sizeof(entry));
+        std::memcpy(index.data() + at + sizeof(entry), tensor.name.data(), tensor.name.size());
+    }
+
+    FileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = kMagic;
+    header.version = TensorFile::kVersion;
+    header.alignment = static_cast<uint32_t>(TensorFile::kAlignment);
+    header.count = static_cast<uint32_t>(tensors_.size());
+    if (!writePadded(index.data(), index.size(), &header.indexOffset, error)) return false;
+    header.indexBytes = index.size();
+    header.fileBytes = end_;
+    std::memcpy(header.kind, kind_.data(), kind_.size());
+    header.indexCrc = crc32c(index.data(), index.size());
+    header.crc = crc32c(&header, offsetof(FileHeader, crc));
+
+    // Header last: until it is written the file does not parse
+    if (!writeAt(fd_, &header, sizeof(header), 0) || !truncateFile(fd_, end_) || !syncFile(fd_)) {
+        *error = "cannot write " + tempPath_ + ": " + errorString();
+        return false;
+    }
+    closeFile(fd_);
+    fd_ = -1;
+    if (!renameFile(tempPath_, path_)) {
+        *error = "cannot rename " + tempPath_ + ": " + errorString();
+        removeFile(tempPath_);
+        return false;
+    }
+    return true;
+}
+
+void TensorFileWriter::abandon() {
+    if (fd_ < 0) return;
+    closeFile(fd_);
+    fd_ = -1;
+    removeFile(tempPath_);
+}
+
+} // namespace storage
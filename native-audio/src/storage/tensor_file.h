@@ -0,0 +1,135 @@
+// Read-only tensor container for on-device model weights
+//
+//   64-byte header   magic "TNSR", format version, alignment, tensor count,
+//                    index location, file size, model kind, checksums
+//   payloads         one region per tensor, each starting on a 64-byte
+//                    boundary so SIMD kernels can use it in place
+//   index            one 96-byte entry per tensor followed by its name
+//
+// Files are opened through a read-only shared mapping: nothing is copied
+// and every process using the same model shares one set of pages in the page
+// cache. open() only validates the header and the index (a few KB); the
+// payload checksum of a tensor is checked the first time it is requested,
+// or for all tensors at once with verifyAll(), so startup does not touch the
+// weights. Files are written to a temporary name and renamed into place, so
+// a crash never leaves a half-written container behind.
+
+#ifndef STORAGE_TENSOR_FILE_H
+#define STORAGE_TENSOR_FILE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "mapped_file.h"
+
+namespace storage {
+
+enum class TensorType : uint32_t {
+    F32 = 0,
+    F16 = 1,
+    Int32 = 2,
+    Bytes = 3,   // opaque blob (vocabularies, serialized models)
+    Q8 = 4,      // quant::QuantizedMatrix, int8 rows + float scales
+    Q4 = 5       // quant::QuantizedMatrix, packed int4 rows + float scales
+};
+
+struct TensorInfo {
+    std::string name;
+    TensorType type = TensorType::F32;
+    std::vector<int64_t> shape;   // outermost first
+    uint32_t groupSize = 0;       // Q8 / Q4: columns per scale
+    uint64_t offset = 0;          // payload, from the start of the file
+    uint64_t bytes = 0;
+    uint64_t scaleOffset = 0;     // Q8 / Q4 scales
+    uint64_t scaleBytes = 0;
+    uint32_t crc = 0;             // CRC-32C of payload, then scales
+};
+
+class TensorFile {
+public:
+    static const uint32_t kVersion = 1;
+    static const uint64_t kAlignment = 64;
+
+    TensorFile();
+    ~TensorFile();
+
+    TensorFile(const TensorFile&) = delete;
+    TensorFile& operator=(const TensorFile&) = delete;
+
+    // True if the file starts with the container magic (any version)
+    static bool isTensorFile(const std::string& path);
+
+    // Map the file and validate its header and index. Fails on a foreign
+    // or truncated file, another format version, or a different kind
+    // (pass an empty kind to accept any).
+    bool open(const std::string& path, const std::string& kind, std::string* error);
+
+    const std::string& kind() const { return kind_; }
+    uint64_t size() const { return map_.size(); }
+    const std::vector<TensorInfo>& tensors() const { return tensors_; }
+    const TensorInfo* find(const std::string& name) const;
+
+    // Payload / scales of a tensor, checksum-verified on first access.
+    // Returns null (and sets *error) if the tensor is corrupt.
+    const uint8_t* data(const TensorInfo& tensor, std::string* error) const;
+    const uint8_t* scales(const TensorInfo& tensor, std::string* error) const;
+
+    // Verify every tensor not yet checked
+    bool verifyAll(std::string* error) const;
+
+    // Base of the mapping, for views that must outlive lookups
+    const uint8_t* base() const { return map_.data(); }
+
+private:
+    MappedFile map_;
+    std::string kind_;
+    std::vector<TensorInfo> tensors_;
+    std::unordered_map<std::string, size_t> byName_;
+    // 0 = unchecked, 1 = valid, 2 = corrupt
+    mutable std::unique_ptr<std::atomic<uint8_t>[]> state_;
+
+    bool verify(const TensorInfo& tensor, std::string* error) const;
+};
+
+class TensorFileWriter {
+public:
+    TensorFileWriter();
+    ~TensorFileWriter();
+
+    TensorFileWriter(const TensorFileWriter&) = delete;
+    TensorFileWriter& operator=(const TensorFileWriter&) = delete;
+
+    // Start writing path.tmp; commit() renames it to path
+    bool open(const std::string& path, const std::string& kind, std::string* error);
+
+    bool add(const std::string& name, TensorType type, const std::vector<int64_t>& shape,
+             const void* data, uint64_t bytes, std::string* error);
+    // Quantized matrix: payload and per-group scales
+    bool addQuantized(const std::string& name, TensorType type, const std::vector<int64_t>& shape,
+                      uint32_t groupSize, const void* data, uint64_t bytes, const float* scales,
+                      uint64_t scaleBytes, std::string* error);
+
+    // Write index and header, sync and move the file into place
+    bool commit(std::string* error);
+    // Drop the temporary file (also done by the destructor if not committed)
+    void abandon();
+
+private:
+    int fd_;
+    std::string path_;
+    std::string tempPath_;
+    std::string kind_;
+    uint64_t end_;
+    std::vector<TensorInfo> tensors_;
+
+    bool writePadded(const void* data, uint64_t bytes, uint64_t* offset, std::string* error);
+};
+
+} // namespace storage
+
+#endif
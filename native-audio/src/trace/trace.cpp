@@ -0,0 +1,641 @@
+#include "trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <vector>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+#endif
+
+namespace trace {
+
+namespace detail {
+std::atomic<bool> g_enabled{false};
+}
+
+namespace {
+
+enum class Kind : uint8_t { Complete, Instant, Counter, AsyncBegin, AsyncEnd };
+
+struct Event {
+    int64_t startNs;
+    int64_t endNs;
+    const char* name;
+    const char* argName;
+    int64_t arg;            // counter value
+    uint64_t flowOut;       // async id
+    uint64_t flowIn;
+    Kind kind;
+};
+
+// One writer (the thread that claimed it); export reads it like a seqlock
+struct ThreadBuffer {
+    explicit ThreadBuffer(size_t capacity)
+        : events(new Event[capacity]), capacity(capacity), head(0), first(0), claimed(false), tid(0),
+          name(nullptr) {}
+
+    std::unique_ptr<Event[]> events;
+    const size_t capacity;
+    std::atomic<uint64_t> head;     // events ever written
+    std::atomic<uint64_t> first;    // earlier ones belong to a previous start()
+    std::atomic<bool> claimed;      // by a thread, for good
+    std::atomic<uint64_t> tid;
+    std::atomic<const char*> name;
+
+    void push(const Event& event) {
+        const uint64_t h = head.load(std::memory_order_relaxed);
+        events[h % capacity] = event;
+        head.store(h + 1, std::memory_order_release);
+    }
+
+    // The events of the current recording still in the ring
+    void snapshot(std::vector<Event>* out, uint64_t* overwritten) const {
+        const uint64_t h1 = head.load(std::memory_order_acquire);
+        const uint64_t begin = std::max(first.load(std::memory_order_relaxed), h1 > capacity ? h1 - capacity : 0);
+        const size_t at = out->size();
+        for (uint64_t i = begin; i < h1; i++) {
+            out->push_back(events[i % capacity]);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        // The writer may have reused slots meanwhile: those copies are torn
+        const uint64_t h2 = head.load(std::memory_order_relaxed);
+        const uint64_t valid = h2 + 1 > capacity ? h2 + 1 - capacity : 0;
+        if (valid > begin) {
+            const size_t torn = static_cast<size_t>(std::min(valid, h1) - begin);
+            out->erase(out->begin() + at, out->begin() + at + torn);
+        }
+        const uint64_t from = first.load(std::memory_order_relaxed);
+        if (h2 - from > capacity) *overwritten += h2 - from - capacity;
+    }
+};
+
+const size_t kMaxThreads = 256;
+// Unclaimed buffers start() leaves ready, so threads that begin recording
+// afterwards (GCD hands the ScreenCaptureKit queue to any worker) need not
+// allocate
+const size_t kSpareBuffers = 16;
+
+// Buffers are created under the mutex and published in pool[0, allocated);
+// threads claim them without it
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> owned;
+    std::atomic<ThreadBuffer*> pool[kMaxThreads] = {};
+    std::atomic<size_t> allocated{0};
+    size_t capacity = 8192;
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<uint64_t> nextId{0};
+    std::set<std::string> names;
+};
+
+// Never destroyed: threads may still trace while the process exits
+Registry& registry() {
+    static Registry* r = new Registry;
+    return *r;
+}
+
+thread_local ThreadBuffer* t_buffer = nullptr;
+thread_local size_t t_scanned = 0;   // pool slots seen claimed by others
+thread_local const char* t_name = nullptr;
+
+uint64_t osThreadId() {
+#if defined(_WIN32)
+    return GetCurrentThreadId();
+#elif defined(__APPLE__)
+    uint64_t id = 0;
+    pthread_threadid_np(nullptr, &id);
+    return id;
+#elif defined(__linux__)
+    return static_cast<uint64_t>(syscall(SYS_gettid));
+#else
+    return reinterpret_cast<uint64_t>(pthread_self());
+#endif
+}
+
+uint64_t processId() {
+#if defined(_WIN32)
+    return GetCurrentProcessId();
+#else
+    return static_cast<uint64_t>(getpid());
+#endif
+}
+
+// Runs on audio callback threads: no lock and no allocation. Without a
+// spare buffer the thread's events are dropped until start() adds more.
+ThreadBuffer* threadBuffer() {
+    if (t_buffer) return t_buffer;
+    Registry& r = registry();
+    const size_t allocated = r.allocated.load(std::memory_order_acquire);
+    for (; t_scanned < allocated; t_scanned++) {
+        ThreadBuffer* buffer = r.pool[t_scanned].load(std::memory_order_relaxed);
+        if (buffer->claimed.load(std::memory_order_relaxed) ||
+            buffer->claimed.exchange(true, std::memory_order_acquire)) {
+            continue;
+        }
+        // Published to export by the first push's release
+        buffer->tid.store(osThreadId(), std::memory_order_relaxed);
+        buffer->name.store(t_name, std::memory_order_relaxed);
+        t_buffer = buffer;
+        return buffer;
+    }
+    return nullptr;
+}
+
+// Under r.mutex
+void addSpareBuffers(Registry& r) {
+    size_t allocated = r.allocated.load(std::memory_order_relaxed);
+    size_t spare = 0;
+    for (size_t i = 0; i < allocated; i++) {
+        if (!r.pool[i].load(std::memory_order_relaxed)->claimed.load(std::memory_order_relaxed)) spare++;
+    }
+    for (; spare < kSpareBuffers && allocated < kMaxThreads; spare++, allocated++) {
+        r.owned.emplace_back(new ThreadBuffer(r.capacity));
+        r.pool[allocated].store(r.owned.back().get(), std::memory_order_relaxed);
+        r.allocated.store(allocated + 1, std::memory_order_release);
+    }
+}
+
+void record(const Event& event) {
+    if (ThreadBuffer* buffer = threadBuffer()) {
+        buffer->push(event);
+    } else {
+        registry().dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+struct ThreadEvents {
+    uint64_t tid;
+    const char* name;
+    std::vector<Event> events;
+};
+
+std::vector<ThreadEvents> collect(uint64_t* overwritten) {
+    Registry& r = registry();
+    const size_t allocated = r.allocated.load(std::memory_order_acquire);
+    std::vector<ThreadEvents> threads;
+    for (size_t i = 0; i < allocated; i++) {
+        const ThreadBuffer* buffer = r.pool[i].load(std::memory_order_relaxed);
+        if (!buffer->claimed.load(std::memory_order_relaxed)) continue;
+        ThreadEvents thread;
+        buffer->snapshot(&thread.events, overwritten);
+        thread.tid = buffer->tid.load(std::memory_order_relaxed);
+        thread.name = buffer->name.load(std::memory_order_relaxed);
+        if (!thread.events.empty() || thread.name) threads.push_back(std::move(thread));
+    }
+    return threads;
+}
+
+// 64-bit mix for track uuids that agree between addons in one process
+uint64_t mix(uint64_t a, uint64_t b) {
+    uint64_t x = a * 0x9E3779B97F4A7C15ull ^ (b + 0x632BE59BD9B4E019ull + (a << 6) + (a >> 2));
+    x ^= x >> 31;
+    x *= 0xBF58476D1CE4E5B9ull;
+    x ^= x >> 29;
+    return x;
+}
+
+uint64_t hashName(const char* s) {
+    uint64_t h = 1469598103934665603ull;   // FNV-1a
+    for (; s && *s; s++) {
+        h ^= static_cast<unsigned char>(*s);
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+// JSON ----------------------------------------------------------------------
+
+void appendJsonString(std::string* out, const char* s) {
+    out->push_back('"');
+    for (; s && *s; s++) {
+        const unsigned char c = static_cast<unsigned char>(*s);
+        if (c == '"' || c == '\\') {
+            out->push_back('\\');
+            out->push_back(static_cast<char>(c));
+        } else if (c < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out->append(escaped);
+        } else {
+            out->push_back(static_cast<char>(c));
+        }
+    }
+    out->push_back('"');
+}
+
+void appendUs(std::string* out, int64_t ns) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.3f", ns / 1000.0);
+    out->append(buf);
+}
+
+void appendEventHead(std::string* out, const char* phase, const char* name, int64_t tsNs, uint64_t pid,
+                     uint64_t tid) {
+    out->append(out->back() == '[' ? "\n" : ",\n");
+    out->append("{\"ph\":\"");
+    out->append(phase);
+    out->append("\",\"cat\":\"audio\",\"name\":");
+    appendJsonString(out, name);
+    out->append(",\"ts\":");
+    appendUs(out, tsNs);
+    out->append(",\"pid\":" + std::to_string(pid) + ",\"tid\":" + std::to_string(tid));
+}
+
+// Protobuf ------------------------------------------------------------------
+
+class ProtoWriter {
+public:
+    void varint(int field, uint64_t value) {
+        key(field, 0);
+        putVarint(value);
+    }
+    void fixed64(int field, uint64_t value) {
+        key(field, 1);
+        for (int i = 0; i < 8; i++) out_.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+    }
+    void bytes(int field, const std::string& value) {
+        key(field, 2);
+        putVarint(value.size());
+        out_.append(value);
+    }
+    void string(int field, const char* value) { bytes(field, value ? std::string(value) : std::string()); }
+    void message(int field, const ProtoWriter& message) { bytes(field, message.out_); }
+
+    const std::string& data() const { return out_; }
+
+private:
+    std::string out_;
+
+    void key(int field, int wireType) { putVarint((static_cast<uint64_t>(field) << 3) | wireType); }
+    void putVarint(uint64_t value) {
+        while (value >= 0x80) {
+            out_.push_back(static_cast<char>((value & 0x7f) | 0x80));
+            value >>= 7;
+        }
+        out_.push_back(static_cast<char>(value));
+    }
+};
+
+// perfetto.protos field numbers
+namespace pb {
+const int kTracePacket = 1;
+const int kPacketTimestamp = 8;
+const int kPacketSequenceId = 10;
+const int kPacketTrackEvent = 11;
+const int kPacketSequenceFlags = 13;
+const int kPacketTrackDescriptor = 60;
+const int kSeqIncrementalStateCleared = 1;
+
+const int kTrackUuid = 1;
+const int kTrackName = 2;
+const int kTrackProcess = 3;
+const int kTrackThread = 4;
+const int kTrackParentUuid = 5;
+const int kTrackCounter = 8;
+const int kProcessPid = 1;
+const int kProcessName = 6;
+const int kThreadPid = 1;
+const int kThreadTid = 2;
+const int kThreadName = 5;
+
+const int kEventDebugAnnotations = 4;
+const int kEventType = 9;
+const int kEventTrackUuid = 11;
+const int kEventName = 23;
+const int kEventCounterValue = 30;
+const int kEventFlowIds = 47;
+const int kEventTerminatingFlowIds = 48;
+const int kAnnotationIntValue = 4;
+const int kAnnotationName = 10;
+
+const int kSliceBegin = 1;
+const int kSliceEnd = 2;
+const int kInstant = 3;
+const int kCounter = 4;
+} // namespace pb
+
+class PerfettoWriter {
+public:
+    explicit PerfettoWriter(uint32_t sequenceId) : sequenceId_(sequenceId) {}
+
+    void descriptor(const ProtoWriter& track) {
+        ProtoWriter packet;
+        packet.message(pb::kPacketTrackDescriptor, track);
+        emit(packet);
+    }
+
+    void event(int64_t ns, const ProtoWriter& trackEvent) {
+        ProtoWriter packet;
+        packet.varint(pb::kPacketTimestamp, static_cast<uint64_t>(std::max<int64_t>(ns, 0)));
+        packet.message(pb::kPacketTrackEvent, trackEvent);
+        emit(packet);
+    }
+
+    const std::string& data() const { return trace_.data(); }
+
+private:
+    ProtoWriter trace_;
+    uint32_t sequenceId_;
+    bool first_ = true;
+
+    void emit(ProtoWriter& packet) {
+        packet.varint(pb::kPacketSequenceId, sequenceId_);
+        if (first_) packet.varint(pb::kPacketSequenceFlags, pb::kSeqIncrementalStateCleared);
+        first_ = false;
+        trace_.message(pb::kTracePacket, packet);
+    }
+};
+
+ProtoWriter sliceEvent(int type, uint64_t track, const char* name) {
+    ProtoWriter event;
+    event.varint(pb::kEventType, static_cast<uint64_t>(type));
+    event.varint(pb::kEventTrackUuid, track);
+    if (name) event.string(pb::kEventName, name);
+    return event;
+}
+
+} // namespace
+
+void start(size_t eventsPerThread) {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.capacity = std::max<size_t>(64, eventsPerThread);
+    for (auto& buffer : r.owned) {
+        buffer->first.store(buffer->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+    }
+    addSpareBuffers(r);
+    r.dropped.store(0, std::memory_order_relaxed);
+    if (r.nextId.load(std::memory_order_relaxed) == 0) {
+        // Ids from different addons should not collide
+        r.nextId.store(mix(reinterpret_cast<uintptr_t>(&r), static_cast<uint64_t>(nowNs())) >> 16 | 1,
+                       std::memory_order_relaxed);
+    }
+    detail::g_enabled.store(true, std::memory_order_release);
+}
+
+void stop() {
+    detail::g_enabled.store(false, std::memory_order_release);
+}
+
+int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint64_t newId() {
+    return registry().nextId.fetch_add(1, std::memory_order_relaxed);
+}
+
+void setThreadName(const char* name) {
+    if (t_name == name) return;
+    t_name = name;
+    if (t_buffer) t_buffer->name.store(name, std::memory_order_relaxed);
+}
+
+const char* intern(const std::string& name) {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    return r.names.insert(name).first->c_str();
+}
+
+void complete(const char* name, int64_t startNs, int64_t endNs, const char* argName, int64_t arg, uint64_t flowOut,
+              uint64_t flowIn) {
+    if (!enabled()) return;
+    record(Event{startNs, endNs, name, argName, arg, flowOut, flowIn, Kind::Complete});
+}
+
+void instant(const char* name) {
+    if (!enabled()) return;
+    const int64_t now = nowNs();
+    record(Event{now, now, name, nullptr, 0, 0, 0, Kind::Instant});
+}
+
+void counter(const char* name, int64_t value) {
+    if (!enabled()) return;
+    const int64_t now = nowNs();
+    record(Event{now, now, name, nullptr, value, 0, 0, Kind::Counter});
+}
+
+void asyncBegin(const char* name, uint64_t id) {
+    if (!enabled()) return;
+    const int64_t now = nowNs();
+    record(Event{now, now, name, nullptr, 0, id, 0, Kind::AsyncBegin});
+}
+
+void asyncEnd(const char* name, uint64_t id) {
+    if (!enabled()) return;
+    const int64_t now = nowNs();
+    record(Event{now, now, name, nullptr, 0, id, 0, Kind::AsyncEnd});
+}
+
+TraceStats stats() {
+    TraceStats result;
+    const std::vector<ThreadEvents> threads = collect(&result.overwritten);
+    result.threads = threads.size();
+    for (const ThreadEvents& thread : threads) result.events += thread.events.size();
+    result.dropped = registry().dropped.load(std::memory_order_relaxed);
+    return result;
+}
+
+std::string exportChromeJson(const char* processName) {
+    uint64_t overwritten = 0;
+    const std::vector<ThreadEvents> threads = collect(&overwritten);
+    const uint64_t pid = processId();
+
+    std::string out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    out.append("\n{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":" + std::to_string(pid) +
+               ",\"tid\":0,\"args\":{\"name\":");
+    appendJsonString(&out, processName);
+    out.append("}}");
+    for (const ThreadEvents& thread : threads) {
+        if (thread.name) {
+            out.append(",\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":" + std::to_string(pid) +
+                       ",\"tid\":" + std::to_string(thread.tid) + ",\"args\":{\"name\":");
+            appendJsonString(&out, thread.name);
+            out.append("}}");
+        }
+        for (const Event& e : thread.events) {
+            switch (e.kind) {
+                case Kind::Complete: {
+                    appendEventHead(&out, "X", e.name, e.startNs, pid, thread.tid);
+                    out.append(",\"dur\":");
+                    appendUs(&out, std::max<int64_t>(e.endNs - e.startNs, 0));
+                    if (e.argName) {
+                        out.append(",\"args\":{");
+                        appendJsonString(&out, e.argName);
+                        out.append(":" + std::to_string(e.arg) + "}");
+                    }
+                    out.append("}");
+                    // Flow arrows bind to the slice around their timestamp
+                    const int64_t mid = e.startNs + (e.endNs - e.startNs) / 2;
+                    if (e.flowOut) {
+                        appendEventHead(&out, "s", "flow", mid, pid, thread.tid);
+                        out.append(",\"id\":" + std::to_string(e.flowOut) + "}");
+                    }
+                    if (e.flowIn) {
+                        appendEventHead(&out, "f", "flow", mid, pid, thread.tid);
+                        out.append(",\"bp\":\"e\",\"id\":" + std::to_string(e.flowIn) + "}");
+                    }
+                    break;
+                }
+                case Kind::Instant:
+                    appendEventHead(&out, "i", e.name, e.startNs, pid, thread.tid);
+                    out.append(",\"s\":\"t\"}");
+                    break;
+                case Kind::Counter:
+                    appendEventHead(&out, "C", e.name, e.startNs, pid, thread.tid);
+                    out.append(",\"args\":{\"value\":" + std::to_string(e.arg) + "}}");
+                    break;
+                case Kind::AsyncBegin:
+                case Kind::AsyncEnd:
+                    appendEventHead(&out, e.kind == Kind::AsyncBegin ? "b" : "e", e.name, e.startNs, pid,
+                                    thread.tid);
+                    out.append(",\"id\":\"0x" + [&] {
+                        char id[24];
+                        std::snprintf(id, sizeof(id), "%llx", static_cast<unsigned long long>(e.flowOut));
+                        return std::string(id);
+                    }() + "\"}");
+                    break;
+            }
+        }
+    }
+    out.append("\n]}\n");
+    return out;
+}
+
+std::string exportPerfetto(const char* processName) {
+    uint64_t overwritten = 0;
+    const std::vector<ThreadEvents> threads = collect(&overwritten);
+    const uint64_t pid = processId();
+    const uint64_t processTrack = mix(pid, 0);
+    // Sequences must not collide with another addon's in the same file
+    const uint32_t sequenceBase = static_cast<uint32_t>(mix(reinterpret_cast<uintptr_t>(&registry()), pid)) & 0x3fffffff;
+
+    std::string out;
+    {
+        PerfettoWriter writer(sequenceBase);
+        ProtoWriter process;
+        process.varint(pb::kProcessPid, pid);
+        process.string(pb::kProcessName, processName);
+        ProtoWriter track;
+        track.varint(pb::kTrackUuid, processTrack);
+        track.message(pb::kTrackProcess, process);
+        writer.descriptor(track);
+        out.append(writer.data());
+    }
+
+    uint32_t sequence = sequenceBase + 1;
+    for (const ThreadEvents& thread : threads) {
+        PerfettoWriter writer(sequence++);
+        const uint64_t threadTrack = mix(pid, thread.tid + 1);
+
+        ProtoWriter threadDescriptor;
+        threadDescriptor.varint(pb::kThreadPid, pid);
+        threadDescriptor.varint(pb::kThreadTid, thread.tid);
+        if (thread.name) threadDescriptor.string(pb::kThreadName, thread.name);
+        ProtoWriter track;
+        track.varint(pb::kTrackUuid, threadTrack);
+        track.varint(pb::kTrackParentUuid, processTrack);
+        track.message(pb::kTrackThread, threadDescriptor);
+        writer.descriptor(track);
+
+        // Slices become begin/end pairs, which must nest in timestamp order:
+        // at the same time ends go first, then the longer slice begins first
+        struct Point {
+            int64_t ns;
+            int order;          // 0 end, 1 begin, 2 other
+            int64_t duration;
+            size_t index;
+        };
+        std::vector<Point> points;
+        std::set<uint64_t> counterTracks;
+        std::set<uint64_t> asyncTracks;
+        for (size_t i = 0; i < thread.events.size(); i++) {
+            const Event& e = thread.events[i];
+            if (e.kind == Kind::Complete) {
+                const int64_t end = std::max(e.endNs, e.startNs + 1);
+                points.push_back(Point{e.startNs, 1, end - e.startNs, i});
+                points.push_back(Point{end, 0, end - e.startNs, i});
+            } else {
+                points.push_back(Point{e.startNs, 2, 0, i});
+            }
+        }
+        std::stable_sort(points.begin(), points.end(), [](const Point& a, const Point& b) {
+            if (a.ns != b.ns) return a.ns < b.ns;
+            if (a.order != b.order) return a.order < b.order;
+            return a.order == 1 ? a.duration > b.duration : a.duration < b.duration;
+        });
+
+        for (const Point& point : points) {
+            const Event& e = thread.events[point.index];
+            switch (e.kind) {
+                case Kind::Complete:
+                    if (point.order == 1) {
+                        ProtoWriter event = sliceEvent(pb::kSliceBegin, threadTrack, e.name);
+                        if (e.argName) {
+                            ProtoWriter annotation;
+                            annotation.string(pb::kAnnotationName, e.argName);
+                            annotation.varint(pb::kAnnotationIntValue, static_cast<uint64_t>(e.arg));
+                            event.message(pb::kEventDebugAnnotations, annotation);
+                        }
+                        if (e.flowOut) event.fixed64(pb::kEventFlowIds, e.flowOut);
+                        if (e.flowIn) event.fixed64(pb::kEventTerminatingFlowIds, e.flowIn);
+                        writer.event(point.ns, event);
+                    } else {
+                        writer.event(point.ns, sliceEvent(pb::kSliceEnd, threadTrack, nullptr));
+                    }
+                    break;
+                case Kind::Instant:
+                    writer.event(point.ns, sliceEvent(pb::kInstant, threadTrack, e.name));
+                    break;
+                case Kind::Counter: {
+                    const uint64_t counterTrack = mix(processTrack, hashName(e.name));
+                    if (counterTracks.insert(counterTrack).second) {
+                        ProtoWriter counterTrackDescriptor;
+                        counterTrackDescriptor.varint(pb::kTrackUuid, counterTrack);
+                        counterTrackDescriptor.string(pb::kTrackName, e.name);
+                        counterTrackDescriptor.varint(pb::kTrackParentUuid, processTrack);
+                        counterTrackDescriptor.message(pb::kTrackCounter, ProtoWriter());
+                        writer.descriptor(counterTrackDescriptor);
+                    }
+                    ProtoWriter event = sliceEvent(pb::kCounter, counterTrack, nullptr);
+                    event.varint(pb::kEventCounterValue, static_cast<uint64_t>(e.arg));
+                    writer.event(point.ns, event);
+                    break;
+                }
+                case Kind::AsyncBegin:
+                case Kind::AsyncEnd: {
+                    // One track per async span, so overlapping spans do not nest
+                    const uint64_t asyncTrack = mix(mix(processTrack, hashName(e.name)), e.flowOut);
+                    if (asyncTracks.insert(asyncTrack).second) {
+                        ProtoWriter asyncTrackDescriptor;
+                        asyncTrackDescriptor.varint(pb::kTrackUuid, asyncTrack);
+                        asyncTrackDescriptor.string(pb::kTrackName, e.name);
+                        asyncTrackDescriptor.varint(pb::kTrackParentUuid, processTrack);
+                        writer.descriptor(asyncTrackDescriptor);
+                    }
+                    writer.event(point.ns, sliceEvent(e.kind == Kind::AsyncBegin ? pb::kSliceBegin : pb::kSliceEnd,
+                                                      asyncTrack, e.kind == Kind::AsyncBegin ? e.name : nullptr));
+                    break;
+                }
+            }
+        }
+        out.append(writer.data());
+    }
+    return out;
+}
+
+} // namespace trace
@@ -0,0 +1,103 @@
+// Trace points for the native audio threads, exported as a Chrome trace
+// (JSON, chrome://tracing or ui.perfetto.dev) or a Perfetto protobuf trace
+//
+// Off until start(); a trace point then costs one relaxed atomic load.
+// While recording, each thread writes fixed-size events into its own ring
+// (a flight recorder: the newest eventsPerThread events are kept) with no
+// lock and no allocation. start() allocates the rings ahead; a thread claims
+// one at its first event with an atomic exchange. Export runs on any thread
+// while recording goes on; an event overwritten during the copy is skipped
+// rather than read torn.
+//
+// Timestamps are steady_clock nanoseconds, the same clock in every addon,
+// so traces from several addons (and the JS spans given to any of them)
+// line up. Threads are identified by OS thread id.
+//
+// Names are not copied: pass string literals, or intern() a name that is
+// not one (from JS). Keep the set of names small and put what varies into
+// the numeric argument.
+
+#ifndef TRACE_TRACE_H
+#define TRACE_TRACE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace trace {
+
+namespace detail {
+extern std::atomic<bool> g_enabled;
+}
+
+inline bool enabled() {
+    return detail::g_enabled.load(std::memory_order_relaxed);
+}
+
+// Events already recorded stay until the next start(), which drops them
+void start(size_t eventsPerThread = 8192);
+void stop();
+
+int64_t nowNs();
+// Unique ids for flows and async spans
+uint64_t newId();
+// Name shown for the calling thread's track; a literal
+void setThreadName(const char* name);
+// A stable copy of name, kept for the life of the process
+const char* intern(const std::string& name);
+
+// A slice from startNs to endNs on the calling thread. flowOut starts an
+// arrow at this slice, flowIn ends one at it (0: none).
+void complete(const char* name, int64_t startNs, int64_t endNs, const char* argName = nullptr, int64_t arg = 0,
+              uint64_t flowOut = 0, uint64_t flowIn = 0);
+void instant(const char* name);
+void counter(const char* name, int64_t value);
+// A span that may end on another thread, or after the JS thread has moved on
+void asyncBegin(const char* name, uint64_t id);
+void asyncEnd(const char* name, uint64_t id);
+
+// Records a slice for its own lifetime, if tracing was on when it began
+class Scope {
+public:
+    explicit Scope(const char* name, const char* argName = nullptr, int64_t arg = 0)
+        : name_(name), argName_(argName), arg_(arg), startNs_(enabled() ? nowNs() : -1) {}
+    ~Scope() {
+        if (startNs_ >= 0) complete(name_, startNs_, nowNs(), argName_, arg_, flowOut_, flowIn_);
+    }
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+    bool active() const { return startNs_ >= 0; }
+    void setArg(int64_t arg) { arg_ = arg; }
+    void flowOut(uint64_t id) { flowOut_ = id; }
+    void flowIn(uint64_t id) { flowIn_ = id; }
+
+private:
+    const char* name_;
+    const char* argName_;
+    int64_t arg_;
+    int64_t startNs_;
+    uint64_t flowOut_ = 0;
+    uint64_t flowIn_ = 0;
+};
+
+struct TraceStats {
+    size_t threads = 0;
+    uint64_t events = 0;        // held in the buffers now
+    uint64_t overwritten = 0;   // lost to the ring wrapping
+    uint64_t dropped = 0;       // from threads that found no spare buffer
+};
+TraceStats stats();
+
+// {"traceEvents": [...]}: complete ("X"), instant, counter, async ("b"/"e")
+// and flow ("s"/"f") events, with process and thread name metadata
+std::string exportChromeJson(const char* processName);
+// A serialized perfetto.protos.Trace: track descriptors for the process and
+// each thread, then TrackEvent packets. Traces from several addons can be
+// concatenated into one.
+std::string exportPerfetto(const char* processName);
+
+} // namespace trace
+
+#endif
@@ -0,0 +1,126 @@
+// trace*() exports shared by the addons
+//
+// Each addon records into its own buffers; trace.js drives all of them and
+// merges their exports. JS spans go on the JS thread's track of whichever
+// addon records them.
+
+#ifndef TRACE_TRACE_NAPI_H
+#define TRACE_TRACE_NAPI_H
+
+#include <napi.h>
+
+#include <string>
+#include <vector>
+
+#include "trace.h"
+
+namespace trace {
+
+namespace detail {
+
+struct JsSpan {
+    const char* name;
+    const char* argName;
+    int64_t arg;
+    int64_t startNs;
+};
+
+// Open traceBegin() spans; JS thread only
+inline std::vector<JsSpan>& jsSpans() {
+    static std::vector<JsSpan> spans;
+    return spans;
+}
+
+inline const char* nameArg(const Napi::CallbackInfo& info, size_t index, const char* fallback) {
+    if (info.Length() <= index || !info[index].IsString()) return fallback;
+    return intern(info[index].As<Napi::String>().Utf8Value());
+}
+
+inline int64_t numberArg(const Napi::CallbackInfo& info, size_t index) {
+    if (info.Length() <= index || !info[index].IsNumber()) return 0;
+    return info[index].As<Napi::Number>().Int64Value();
+}
+
+} // namespace detail
+
+// traceStart(eventsPerThread?), traceStop(), traceEnabled(),
+// traceBegin(name, argName?, arg?), traceEnd(), traceInstant(name),
+// traceCounter(name, value), traceNewId(), traceAsyncBegin(name, id),
+// traceAsyncEnd(name, id), traceSetThreadName(name), traceStats(),
+// traceExport('json' | 'perfetto', processName?): string | Buffer
+inline void initNapi(Napi::Env env, Napi::Object exports) {
+    exports.Set("traceStart", Napi::Function::New(env, [](const Napi::CallbackInfo& info) {
+        const int64_t events = detail::numberArg(info, 0);
+        start(events > 0 ? static_cast<size_t>(events) : 8192);
+        detail::jsSpans().clear();
+    }));
+    exports.Set("traceStop", Napi::Function::New(env, [](const Napi::CallbackInfo&) { stop(); }));
+    exports.Set("traceEnabled", Napi::Function::New(env, [](const Napi::CallbackInfo& info) {
+        return Napi::Boolean::New(info.Env(), enabled());
+    }));
+
+    exports.Set("traceBegin", Napi::Function::New(env, [](const Napi::CallbackInfo& info) {
+        // Unbalanced begin/end pairs must not grow the stack while tracing is off
+        if (!enabled()) return;
+        detail::jsSpans().push_back(detail::JsSpan{detail::nameArg(info, 0, "js"), detail::nameArg(info, 1, nullptr),
+                                                   detail::numberArg(info, 2), nowNs()});
+    }));
+    exports.Set("traceEnd", Napi::Function::New(env, [](const Napi::CallbackInfo&) {
+        std::vector<detail::JsSpan>& spans = detail::jsSpans();
+        if (spans.empty()) return;
+        const detail::JsSpan span = spans.back();
+        spans.pop_back();
+        complete(span.name, span.startNs, nowNs(), span.argName, span.arg);
+    }));
+    exports.Set("traceInstant", Napi::Function::New(env, [](const Napi::CallbackInfo& info) {
+        if (enabled()) instant(detail::nameArg(info, 0, "js"));
+    }));
+    exports.Set("traceCounter", Napi::Function::New(env, [](const Napi::CallbackInfo& info) {
+        if (enabled()) counter(detail::nameArg(info, 0, "js"), detail::numberArg(info, 1));
+    }));
+
+    // Ids stay below 2^53, so they survive the round trip through a Number
+    exports.Set("traceNewId", Napi::Function::New(env, [](const Napi::CallbackInfo& info) {
+        return Napi::Number::New(info.Env(), static_cast<double>(newId()));
+    }));
+    exports.Set("traceAsyncBegin", Napi::Function::New(env, [](const Napi::CallbackInfo& info) {
+        if (enabled()) asyncBegin(detail::nameArg(info, 0, "js"), static_cast<uint64_t>(detail::numberArg(info, 1)));
+    }));
+    exports.Set("traceAsyncEnd", Napi::Function::New(env, [](const Napi::CallbackInfo& info) {
+        if (enabled()) asyncEnd(detail::nameArg(info, 0, "js"), static_cast<uint64_t>(detail::numberArg(info, 1)));
+    }));
+    exports.Set("traceSetThreadName", Napi::Function::New(env, [](const Napi::CallbackInfo& info) {
+        setThreadName(detail::nameArg(info, 0, "js"));
+    }));
+
+    exports.Set("traceStats", Napi::Function::New(env, [](const Napi::CallbackInfo& info) {
+        Napi::Env env = info.Env();
+        const TraceStats s = stats();
+        Napi::Object out = Napi::Object::New(env);
+        out.Set("threads", Napi::Number::New(env, static_cast<double>(s.threads)));
+        out.Set("events", Napi::Number::New(env, static_cast<double>(s.events)));
+        out.Set("overwritten", Napi::Number::New(env, static_cast<double>(s.overwritten)));
+        out.Set("dropped", Napi::Number::New(env, static_cast<double>(s.dropped)));
+        return out;
+    }));
+    exports.Set("traceExport", Napi::Function::New(env, [](const Napi::CallbackInfo& info) -> Napi::Value {
+        Napi::Env env = info.Env();
+        const std::string format = info.Length() > 0 && info[0].IsString()
+            ? info[0].As<Napi::String>().Utf8Value() : "json";
+        const std::string processName = info.Length() > 1 && info[1].IsString()
+            ? info[1].As<Napi::String>().Utf8Value() : "native-audio";
+        if (format == "perfetto") {
+            const std::string data = exportPerfetto(processName.c_str());
+            return Napi::Buffer<char>::Copy(env, data.data(), data.size());
+        }
+        if (format != "json") {
+            Napi::TypeError::New(env, "traceExport: format must be 'json' or 'perfetto'").ThrowAsJavaScriptException();
+            return env.Undefined();
+        }
+        return Napi::String::New(env, exportChromeJson(processName.c_str()));
+    }));
+}
+
+} // namespace trace
+
+#endif
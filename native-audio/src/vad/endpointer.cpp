@@ -0,0 +1,77 @@
+#include "endpointer.h"
+
+#include <algorithm>
+
+namespace vad {
+
+Endpointer::Endpointer(const EndpointerConfig& config, int sampleRate, int frameSamples)
+    : config_(config), hop_(static_cast<uint64_t>(std::max(1, frameSamples))) {
+    const int frameMs = std::max(1, frameSamples * 1000 / std::max(1, sampleRate));
+    minSpeechFrames_ = static_cast<uint64_t>(std::max(1, config.minSpeechMs / frameMs));
+    hangoverFrames_ = static_cast<uint64_t>(std::max(1, config.hangoverMs / frameMs));
+    preRoll_ = static_cast<uint64_t>(std::max(0, config.preRollMs)) * sampleRate / 1000;
+    postRoll_ = static_cast<uint64_t>(std::max(0, config.postRollMs)) * sampleRate / 1000;
+    reset();
+}
+
+void Endpointer::reset() {
+    state_ = State::Silence;
+    frame_ = 0;
+    onsetFrame_ = 0;
+    lastSpeechFrame_ = 0;
+    lastEnd_ = 0;
+    speechFrames_ = 0;
+}
+
+void Endpointer::push(float probability, std::vector<VadEvent>* events) {
+    const uint64_t t = frame_++;
+    switch (state_) {
+        case State::Silence:
+            if (probability < config_.onThreshold) break;
+            onsetFrame_ = t;
+            state_ = State::Onset;
+            // A one-frame minimum starts at once
+            [[fallthrough]];
+        case State::Onset:
+            if (probability < config_.offThreshold) {
+                state_ = State::Silence;
+            } else if (t - onsetFrame_ + 1 >= minSpeechFrames_) {
+                const uint64_t onset = onsetFrame_ * hop_;
+                const uint64_t start = std::max(lastEnd_, onset > preRoll_ ? onset - preRoll_ : 0);
+                events->push_back({VadEventType::SpeechStart, start});
+                state_ = State::Speech;
+                lastSpeechFrame_ = t;
+            }
+            break;
+        case State::Speech:
+            if (probability < config_.offThreshold) {
+                state_ = State::Trailing;
+            } else {
+                lastSpeechFrame_ = t;
+            }
+            break;
+        case State::Trailing:
+            if (probability >= config_.onThreshold) {
+                state_ = State::Speech;
+                lastSpeechFrame_ = t;
+            } else if (t - lastSpeechFrame_ >= hangoverFrames_) {
+                end((t + 1) * hop_, events);
+            }
+            break;
+    }
+}
+
+void Endpointer::flush(uint64_t totalSamples, std::vector<VadEvent>* events) {
+    if (speaking()) end(totalSamples, events);
+    if (state_ == State::Onset) state_ = State::Silence;
+}
+
+void Endpointer::end(uint64_t limit, std::vector<VadEvent>* events) {
+    const uint64_t sample = std::min(limit, (lastSpeechFrame_ + 1) * hop_ + postRoll_);
+    events->push_back({VadEventType::SpeechEnd, sample});
+    speechFrames_ += lastSpeechFrame_ + 1 - onsetFrame_;
+    lastEnd_ = sample;
+    state_ = State::Silence;
+}
+
+} // namespace vad
@@ -0,0 +1,78 @@
+// Speech start/end decisions from per-frame speech probabilities
+//
+//   silence ──p ≥ on──▶ onset ──speech for minSpeechMs──▶ speech
+//      ▲                  │ p < off                         │ p < off
+//      └──────────────────┘                                 ▼
+//      └──────────── silence for hangoverMs ◀──────── trailing ──p ≥ on──▶ speech
+//
+// Two thresholds (hysteresis) keep a probability hovering around one value
+// from toggling the state; minSpeechMs rejects clicks and short bursts, and
+// hangoverMs bridges the pauses inside an utterance, so an end is only
+// reported after a real endpoint. Events carry sample offsets into the
+// stream: a start is moved back by preRollMs so the soft onset of the first
+// word is kept, and an end is placed postRollMs after the last speech frame.
+
+#ifndef VAD_ENDPOINTER_H
+#define VAD_ENDPOINTER_H
+
+#include <cstdint>
+#include <vector>
+
+namespace vad {
+
+struct EndpointerConfig {
+    float onThreshold = 0.6f;
+    float offThreshold = 0.4f;
+    int minSpeechMs = 120;
+    int hangoverMs = 500;
+    int preRollMs = 200;
+    int postRollMs = 150;
+};
+
+enum class VadEventType { SpeechStart, SpeechEnd };
+
+struct VadEvent {
+    VadEventType type;
+    uint64_t sample;   // offset into the stream, at the input sample rate
+};
+
+class Endpointer {
+public:
+    // frameSamples: input samples per probability (the hop)
+    Endpointer(const EndpointerConfig& config, int sampleRate, int frameSamples);
+
+    // Probability for the frame covering samples [frame * hop, (frame + 1) * hop)
+    void push(float probability, std::vector<VadEvent>* events);
+
+    // End of stream at totalSamples: closes an open utterance
+    void flush(uint64_t totalSamples, std::vector<VadEvent>* events);
+
+    void reset();
+
+    bool speaking() const { return state_ == State::Speech || state_ == State::Trailing; }
+    uint64_t frames() const { return frame_; }
+    uint64_t speechFrames() const { return speechFrames_; }
+
+private:
+    enum class State { Silence, Onset, Speech, Trailing };
+
+    EndpointerConfig config_;
+    uint64_t hop_;
+    uint64_t minSpeechFrames_;
+    uint64_t hangoverFrames_;
+    uint64_t preRoll_;
+    uint64_t postRoll_;
+
+    State state_;
+    uint64_t frame_;          // index of the next frame
+    uint64_t onsetFrame_;
+    uint64_t lastSpeechFrame_;
+    uint64_t lastEnd_;        // sample of the last end event
+    uint64_t speechFrames_;   // frames inside reported utterances
+
+    void end(uint64_t limit, std::vector<VadEvent>* events);
+};
+
+} // namespace vad
+
+#endif
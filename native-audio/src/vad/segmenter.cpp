@@ -0,0 +1,176 @@
+#include "segmenter.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace vad {
+
+namespace {
+
+uint64_t msToSamples(int ms, int sampleRate) {
+    return static_cast<uint64_t>(std::max(0, ms)) * static_cast<uint64_t>(sampleRate) / 1000;
+}
+
+} // namespace
+
+Segmenter::Segmenter(const SegmenterConfig& config, std::shared_ptr<const VadModel> model)
+    : config_(config), detector_(config.vad, std::move(model)), sampleRate_(config.vad.sampleRate) {
+    minSamples_ = msToSamples(config.minDurationMs, sampleRate_);
+    maxSamples_ = std::max(msToSamples(config.maxDurationMs, sampleRate_), minSamples_ + 1);
+    overlapSamples_ = std::min(msToSamples(config.overlapMs, sampleRate_), maxSamples_ / 2);
+    searchSamples_ = std::min(msToSamples(config.cutSearchMs, sampleRate_), maxSamples_ / 2);
+    // Start events lie up to preRoll + minSpeech (+ a frame) in the past
+    const EndpointerConfig& ep = config.vad.endpointer;
+    holdSamples_ = std::max(msToSamples(1000, sampleRate_),
+                            msToSamples(ep.preRollMs + ep.minSpeechMs + 100, sampleRate_));
+    compactor_.sampleRate = sampleRate_;
+    compactor_.maxGapMs = config.maxGapMs;
+    compactor_.speechThreshold = ep.offThreshold;
+    reset();
+}
+
+void Segmenter::reset() {
+    detector_.reset();
+    history_.clear();
+    historyStart_ = 0;
+    total_ = 0;
+    events_.clear();
+    probabilities_.clear();
+    probabilityBase_ = 0;
+    active_ = false;
+    open_ = false;
+    segmentStart_ = 0;
+    lastEnd_ = 0;
+    index_ = 0;
+}
+
+size_t Segmenter::process(const int16_t* samples, size_t n, std::vector<Segment>* segments) {
+    const size_t before = segments->size();
+    if (!isValid()) return 0;
+
+    history_.insert(history_.end(), samples, samples + n);
+    total_ += n;
+
+    events_.clear();
+    detector_.process(samples, n, &events_, &probabilities_);
+    for (const VadEvent& event : events_) handle(event, segments);
+
+    if (open_ && total_ - segmentStart_ >= maxSamples_) {
+        // Too long: cut at the quietest point of the recent audio, and start
+        // the next segment overlapSamples_ before it
+        const uint64_t from = std::max(segmentStart_ + minSamples_, total_ - searchSamples_);
+        const uint64_t cut = from < total_ ? quietestPoint(from, total_) : total_;
+        emit(cut, SegmentCut::MaxDuration, segments);
+        active_ = true;
+        open_ = true;
+        segmentStart_ = std::max(historyStart_, cut - std::min(cut, overlapSamples_));
+    } else if (active_ && !open_ && total_ - lastEnd_ >= minSamples_) {
+        // A short utterance nobody followed up on
+        emit(lastEnd_, SegmentCut::Pause, segments);
+    }
+
+    trim();
+    return segments->size() - before;
+}
+
+size_t Segmenter::flush(std::vector<Segment>* segments) {
+    const size_t before = segments->size();
+    if (!isValid()) return 0;
+
+    events_.clear();
+    detector_.flush(&events_, &probabilities_);
+    for (const VadEvent& event : events_) handle(event, segments);
+    if (active_) emit(open_ ? total_ : lastEnd_, SegmentCut::Flush, segments);
+
+    trim();
+    return segments->size() - before;
+}
+
+void Segmenter::handle(const VadEvent& event, std::vector<Segment>* segments) {
+    if (event.type == VadEventType::SpeechStart) {
+        if (open_) return;
+        if (!active_) {
+            segmentStart_ = std::max(historyStart_, event.sample);
+            active_ = true;
+        }
+        // A pending short utterance continues, with the pause in between
+        open_ = true;
+        return;
+    }
+
+    if (!open_) return;
+    open_ = false;
+    lastEnd_ = std::max(segmentStart_, std::min(event.sample, total_));
+    if (lastEnd_ - segmentStart_ >= minSamples_) {
+        emit(lastEnd_, SegmentCut::Pause, segments);
+    }
+}
+
+void Segmenter::emit(uint64_t end, SegmentCut cut, std::vector<Segment>* segments) {
+    const uint64_t start = std::max(segmentStart_, historyStart_);
+    end = std::max(start, std::min(end, total_));
+
+    Segment segment;
+    segment.startSample = start;
+    segment.endSample = end;
+    segment.cut = cut;
+    segment.index = index_++;
+    const int16_t* first = history_.data() + (start - historyStart_);
+    if (config_.maxGapMs > 0) {
+        // Speech probability per hop of the segment; frames not scored yet
+        // (the detector lags by half a window) count as speech
+        const uint64_t hop = static_cast<uint64_t>(std::max(1, detector_.hopSamples()));
+        segmentProbabilities_.clear();
+        for (uint64_t s = start; s < end; s += hop) {
+            const uint64_t frame = (s + hop / 2) / hop;
+            const bool known = frame >= probabilityBase_ && frame - probabilityBase_ < probabilities_.size();
+            segmentProbabilities_.push_back(known ? probabilities_[static_cast<size_t>(frame - probabilityBase_)] : 1.0f);
+        }
+        compactSilence(first, static_cast<size_t>(end - start), segmentProbabilities_.data(),
+                       segmentProbabilities_.size(), static_cast<int>(hop), compactor_, &segment.pcm,
+                       &segment.remap);
+    } else {
+        segment.pcm.assign(first, first + (end - start));
+    }
+    segments->push_back(std::move(segment));
+
+    active_ = false;
+    open_ = false;
+    lastEnd_ = end;
+}
+
+uint64_t Segmenter::quietestPoint(uint64_t from, uint64_t to) const {
+    const uint64_t hop = static_cast<uint64_t>(std::max(1, detector_.hopSamples()));
+    uint64_t best = to;
+    double bestEnergy = std::numeric_limits<double>::max();
+    for (uint64_t h = std::max(from, historyStart_); h + hop <= to; h += hop) {
+        const int16_t* p = history_.data() + (h - historyStart_);
+        double energy = 0.0;
+        for (uint64_t i = 0; i < hop; i++) energy += static_cast<double>(p[i]) * p[i];
+        // Ties go to the later hop: longer segments, fewer cuts
+        if (energy <= bestEnergy) {
+            bestEnergy = energy;
+            best = h + hop / 2;
+        }
+    }
+    return best;
+}
+
+void Segmenter::trim() {
+    uint64_t keep = total_ > holdSamples_ ? total_ - holdSamples_ : 0;
+    if (active_) keep = std::min(keep, segmentStart_);
+    // Erase in blocks of at least the hold, not on every call
+    if (keep <= historyStart_ || keep - historyStart_ < holdSamples_) return;
+    history_.erase(history_.begin(), history_.begin() + static_cast<ptrdiff_t>(keep - historyStart_));
+    historyStart_ = keep;
+
+    const uint64_t hop = static_cast<uint64_t>(std::max(1, detector_.hopSamples()));
+    const uint64_t firstFrame = std::min<uint64_t>(keep / hop, probabilityBase_ + probabilities_.size());
+    if (firstFrame > probabilityBase_) {
+        probabilities_.erase(probabilities_.begin(),
+                             probabilities_.begin() + static_cast<ptrdiff_t>(firstFrame - probabilityBase_));
+        probabilityBase_ = firstFrame;
+    }
+}
+
+} // namespace vad
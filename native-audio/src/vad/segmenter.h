@@ -0,0 +1,111 @@
+// Utterance-aligned segmentation of a capture stream
+//
+// Cuts int16 PCM into segments for transcription at the pauses found by a
+// VoiceDetector instead of every N capture chunks:
+//
+//   - a segment starts at a (pre-rolled) speech start and is cut at the
+//     matching speech end, so words are not split at segment boundaries
+//   - an utterance shorter than minDurationMs waits up to minDurationMs for
+//     the next one and is joined with it, silence included
+//   - an utterance longer than maxDurationMs is cut at the quietest 10 ms
+//     in the last cutSearchMs, and the next segment repeats the overlapMs
+//     before the cut so a word caught by it is heard whole once
+//   - with maxGapMs set, non-speech inside a segment is shortened to it
+//     (silence_compactor.h) and the segment carries the remap table back to
+//     its original timeline
+//
+// Samples are kept in one history buffer (trimmed to the open segment plus a
+// short hold for the pre-roll), and each segment is copied out of it once, as
+// a single contiguous block.
+
+#ifndef VAD_SEGMENTER_H
+#define VAD_SEGMENTER_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "silence_compactor.h"
+#include "voice_detector.h"
+
+namespace vad {
+
+struct SegmenterConfig {
+    VadConfig vad;
+    int minDurationMs = 1000;
+    int maxDurationMs = 15000;
+    int overlapMs = 300;
+    int cutSearchMs = 3000;
+    int maxGapMs = 0;        // 0: no silence compaction
+};
+
+enum class SegmentCut { Pause, MaxDuration, Flush };
+
+struct Segment {
+    std::vector<int16_t> pcm;
+    uint64_t startSample;    // stream offsets, at the input sample rate
+    uint64_t endSample;      // exclusive; startSample + pcm.size() unless compacted
+    std::vector<RemapEntry> remap;   // compacted segments: pcm offsets -> offsets from startSample
+    SegmentCut cut;
+    uint32_t index;          // 0, 1, 2, ... per stream
+};
+
+class Segmenter {
+public:
+    explicit Segmenter(const SegmenterConfig& config, std::shared_ptr<const VadModel> model = nullptr);
+
+    Segmenter(const Segmenter&) = delete;
+    Segmenter& operator=(const Segmenter&) = delete;
+
+    bool isValid() const { return detector_.isValid(); }
+    const std::string& error() const { return detector_.error(); }
+
+    // Append mono samples; finished segments are appended to segments.
+    // Returns the number of segments appended.
+    size_t process(const int16_t* samples, size_t n, std::vector<Segment>* segments);
+
+    // End of stream: closes the open segment, however short
+    size_t flush(std::vector<Segment>* segments);
+
+    void reset();
+
+    bool speaking() const { return open_; }
+    bool pending() const { return active_; }   // audio waiting in an unfinished segment
+    uint64_t samples() const { return total_; }
+    const VoiceDetector& detector() const { return detector_; }
+
+private:
+    SegmenterConfig config_;
+    VoiceDetector detector_;
+    int sampleRate_;
+    uint64_t minSamples_;
+    uint64_t maxSamples_;
+    uint64_t overlapSamples_;
+    uint64_t searchSamples_;
+    uint64_t holdSamples_;
+    CompactorConfig compactor_;
+
+    std::vector<int16_t> history_;
+    uint64_t historyStart_;   // stream offset of history_[0]
+    uint64_t total_;
+    std::vector<VadEvent> events_;
+    std::vector<float> probabilities_;   // per detector frame, from probabilityBase_
+    uint64_t probabilityBase_;
+    std::vector<float> segmentProbabilities_;
+
+    bool active_;             // a segment has started
+    bool open_;               // ... and is inside an utterance
+    uint64_t segmentStart_;
+    uint64_t lastEnd_;        // end of the last closed utterance
+    uint32_t index_;
+
+    void handle(const VadEvent& event, std::vector<Segment>* segments);
+    void emit(uint64_t end, SegmentCut cut, std::vector<Segment>* segments);
+    uint64_t quietestPoint(uint64_t from, uint64_t to) const;
+    void trim();
+};
+
+} // namespace vad
+
+#endif
@@ -0,0 +1,80 @@
+#include "silence_compactor.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace vad {
+
+size_t compactSilence(const int16_t* pcm, size_t n, const float* probabilities, size_t frames, int hop,
+                      const CompactorConfig& config, std::vector<int16_t>* out,
+                      std::vector<RemapEntry>* remap) {
+    out->clear();
+    remap->clear();
+    const size_t step = static_cast<size_t>(std::max(1, hop));
+    const size_t maxGap = static_cast<size_t>(std::max(0, config.maxGapMs)) * config.sampleRate / 1000;
+    const size_t half = maxGap / 2;
+    const size_t fade = std::min(static_cast<size_t>(std::max(0, config.fadeMs)) * config.sampleRate / 1000, half);
+
+    // Ranges to drop, in order
+    std::vector<std::pair<size_t, size_t>> drops;
+    for (size_t k = 0; k < frames;) {
+        if (probabilities[k] >= config.speechThreshold) {
+            k++;
+            continue;
+        }
+        size_t end = k;
+        while (end < frames && probabilities[end] < config.speechThreshold) end++;
+        const size_t a = std::min(n, k * step);
+        const size_t b = std::min(n, end * step);
+        if (b - a > maxGap) {
+            if (a == 0 && b == n) {
+                drops.push_back({maxGap, n});          // nothing but silence
+            } else if (a == 0) {
+                drops.push_back({0, b - maxGap});      // keep the lead-in to speech
+            } else if (b == n) {
+                drops.push_back({a + maxGap, n});      // keep the tail after it
+            } else {
+                drops.push_back({a + half, b - (maxGap - half)});
+            }
+        }
+        k = end;
+    }
+
+    size_t removed = 0;
+    for (const auto& drop : drops) removed += drop.second - drop.first;
+    out->reserve(n - removed);
+
+    // Copy the kept pieces, fading into and out of each splice
+    size_t pos = 0;
+    bool spliced = false;
+    auto keep = [&](size_t from, size_t to, bool fadeOut) {
+        if (to <= from) return;
+        const size_t base = out->size();
+        remap->push_back({static_cast<uint64_t>(base), static_cast<uint64_t>(from)});
+        out->insert(out->end(), pcm + from, pcm + to);
+        const size_t length = to - from;
+        const size_t ramp = std::min(fade, length / 2);
+        for (size_t i = 0; i < ramp; i++) {
+            const float gain = static_cast<float>(i) / static_cast<float>(ramp);
+            if (spliced) (*out)[base + i] = static_cast<int16_t>((*out)[base + i] * gain);
+            if (fadeOut) (*out)[base + length - 1 - i] = static_cast<int16_t>((*out)[base + length - 1 - i] * gain);
+        }
+    };
+    for (const auto& drop : drops) {
+        keep(pos, drop.first, true);
+        pos = drop.second;
+        spliced = true;
+    }
+    keep(pos, n, false);
+    return removed;
+}
+
+uint64_t remapSample(const std::vector<RemapEntry>& remap, uint64_t compacted) {
+    auto it = std::upper_bound(remap.begin(), remap.end(), compacted,
+                               [](uint64_t value, const RemapEntry& entry) { return value < entry.compacted; });
+    if (it == remap.begin()) return compacted;
+    --it;
+    return it->original + (compacted - it->compacted);
+}
+
+} // namespace vad
@@ -0,0 +1,48 @@
+// Silence compaction for segments before upload
+//
+// Non-speech stretches longer than maxGapMs are shortened to maxGapMs: the
+// first and last half of the gap are kept (with a short fade across the
+// splice) and the middle is dropped. Gaps at the start or end of a segment
+// keep the maxGapMs next to the speech. Speech is untouched, so the
+// compacted audio sounds the same to a recognizer while the bytes billed for
+// room tone and long pauses go away.
+//
+// The remap table has one entry per kept piece: the piece starts at
+// `compacted` in the output and at `original` in the input. A time t in the
+// output maps back to original + (t - compacted) of the last entry with
+// compacted <= t, which is exact for every kept sample.
+
+#ifndef VAD_SILENCE_COMPACTOR_H
+#define VAD_SILENCE_COMPACTOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace vad {
+
+struct CompactorConfig {
+    int sampleRate = 16000;
+    int maxGapMs = 300;
+    float speechThreshold = 0.4f;   // frames at or above this are speech
+    int fadeMs = 5;
+};
+
+struct RemapEntry {
+    uint64_t compacted;   // sample offset in the compacted audio
+    uint64_t original;    // sample offset in the input
+};
+
+// probabilities[k] is the speech probability of samples [k * hop, (k + 1) * hop);
+// samples past the last frame count as speech. Returns the number of samples
+// removed; out and remap are replaced.
+size_t compactSilence(const int16_t* pcm, size_t n, const float* probabilities, size_t frames, int hop,
+                      const CompactorConfig& config, std::vector<int16_t>* out,
+                      std::vector<RemapEntry>* remap);
+
+// Original offset of a compacted one
+uint64_t remapSample(const std::vector<RemapEntry>& remap, uint64_t compacted);
+
+} // namespace vad
+
+#endif
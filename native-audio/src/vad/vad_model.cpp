@@ -0,0 +1,89 @@
+#include "vad_model.h"
+
+#include <cmath>
+
+namespace vad {
+
+namespace {
+
+const char* const kContainerKind = "vad";
+
+float sigmoid(float x) {
+    return 1.0f / (1.0f + std::exp(-x));
+}
+
+// y[rows] = w[rows, cols] * x[cols] + bias
+void matVec(const float* w, const float* bias, const float* x, size_t rows, size_t cols, float* y) {
+    for (size_t r = 0; r < rows; r++) {
+        const float* row = w + r * cols;
+        float sum = bias[r];
+        for (size_t c = 0; c < cols; c++) sum += row[c] * x[c];
+        y[r] = sum;
+    }
+}
+
+} // namespace
+
+std::shared_ptr<const VadModel> VadModel::load(const std::string& path, std::string* error) {
+    auto file = std::make_shared<storage::TensorFile>();
+    if (!file->open(path, kContainerKind, error)) return nullptr;
+
+    std::shared_ptr<VadModel> model(new VadModel());
+    // Returns the tensor's values if it has the expected shape
+    auto get = [&](const char* name, std::vector<int64_t> shape) -> const float* {
+        const storage::TensorInfo* info = file->find(name);
+        if (!info || info->type != storage::TensorType::F32 || info->shape != shape) {
+            *error = path + ": " + name + " is missing or has the wrong shape";
+            return nullptr;
+        }
+        return reinterpret_cast<const float*>(file->data(*info, error));
+    };
+
+    const storage::TensorInfo* input = file->find("input.weight");
+    if (!input || input->shape.size() != 2 || input->shape[0] <= 0 || input->shape[1] <= 0) {
+        *error = path + ": input.weight is missing";
+        return nullptr;
+    }
+    const int64_t hidden = input->shape[0];
+    const int64_t mels = input->shape[1];
+    model->hidden_ = static_cast<size_t>(hidden);
+    model->mels_ = static_cast<size_t>(mels);
+    if (!(model->inputW_ = get("input.weight", {hidden, mels})) ||
+        !(model->inputB_ = get("input.bias", {hidden})) ||
+        !(model->weightIh_ = get("gru.weight_ih", {3 * hidden, hidden})) ||
+        !(model->weightHh_ = get("gru.weight_hh", {3 * hidden, hidden})) ||
+        !(model->biasIh_ = get("gru.bias_ih", {3 * hidden})) ||
+        !(model->biasHh_ = get("gru.bias_hh", {3 * hidden})) ||
+        !(model->outputW_ = get("output.weight", {1, hidden})) ||
+        !(model->outputB_ = get("output.bias", {1}))) {
+        return nullptr;
+    }
+    model->file_ = std::move(file);
+    return model;
+}
+
+float VadModel::step(const float* features, float* state, std::vector<float>* scratch) const {
+    const size_t h = hidden_;
+    scratch->resize(7 * h);
+    float* x = scratch->data();
+    float* gi = x + h;        // [3h] input gates
+    float* gh = gi + 3 * h;   // [3h] recurrent gates
+
+    matVec(inputW_, inputB_, features, h, mels_, x);
+    for (size_t i = 0; i < h; i++) x[i] = std::tanh(x[i]);
+
+    matVec(weightIh_, biasIh_, x, 3 * h, h, gi);
+    matVec(weightHh_, biasHh_, state, 3 * h, h, gh);
+    for (size_t i = 0; i < h; i++) {
+        const float r = sigmoid(gi[i] + gh[i]);
+        const float z = sigmoid(gi[h + i] + gh[h + i]);
+        const float n = std::tanh(gi[2 * h + i] + r * gh[2 * h + i]);
+        state[i] = (1.0f - z) * n + z * state[i];
+    }
+
+    float logit = outputB_[0];
+    for (size_t i = 0; i < h; i++) logit += outputW_[i] * state[i];
+    return sigmoid(logit);
+}
+
+} // namespace vad
@@ -0,0 +1,62 @@
+// Recurrent speech/non-speech classifier on log-mel frames
+//
+// One tanh input projection, a GRU and a sigmoid output: a few thousand
+// multiply-adds per 10 ms frame. Weights are read from a tensor container
+// (storage/tensor_file.h) of kind "vad", mapped read-only:
+//
+//   input.weight    F32  [hidden, mels]
+//   input.bias      F32  [hidden]
+//   gru.weight_ih   F32  [3 * hidden, hidden]   gate order r, z, n (PyTorch)
+//   gru.weight_hh   F32  [3 * hidden, hidden]
+//   gru.bias_ih     F32  [3 * hidden]
+//   gru.bias_hh     F32  [3 * hidden]
+//   output.weight   F32  [1, hidden]
+//   output.bias     F32  [1]
+//
+// Features are log10 mel energies at 16 kHz (25 ms window, 10 ms hop) minus a
+// running per-bin mean (VoiceDetector keeps it), so the input level does not
+// matter. The model is immutable; the recurrent state lives with the caller,
+// so one loaded model serves any number of streams.
+
+#ifndef VAD_VAD_MODEL_H
+#define VAD_VAD_MODEL_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "storage/tensor_file.h"
+
+namespace vad {
+
+class VadModel {
+public:
+    // Returns null and sets *error on a missing file or a shape mismatch
+    static std::shared_ptr<const VadModel> load(const std::string& path, std::string* error);
+
+    int mels() const { return static_cast<int>(mels_); }
+    int hidden() const { return static_cast<int>(hidden_); }
+
+    // One frame: updates state (hidden() values, zero to start) and returns
+    // the speech probability. scratch is reused between calls.
+    float step(const float* features, float* state, std::vector<float>* scratch) const;
+
+private:
+    VadModel() : mels_(0), hidden_(0) {}
+
+    std::shared_ptr<storage::TensorFile> file_;
+    size_t mels_;
+    size_t hidden_;
+    const float* inputW_ = nullptr;
+    const float* inputB_ = nullptr;
+    const float* weightIh_ = nullptr;
+    const float* weightHh_ = nullptr;
+    const float* biasIh_ = nullptr;
+    const float* biasHh_ = nullptr;
+    const float* outputW_ = nullptr;
+    const float* outputB_ = nullptr;
+};
+
+} // namespace vad
+
+#endif
@@ -0,0 +1,201 @@
+#include "voice_detector.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace vad {
+
+namespace {
+
+const int kMels = 40;
+// Built-in scorer, in log10 units per 10 ms frame and dB of mean SNR
+const float kFloorRise = 0.003f;   // 3 dB/s
+const float kFloorFall = 0.1f;     // share of a drop taken per frame
+const float kBandMargin = 0.3f;    // per-bin fluctuation of noise not counted (3 dB)
+const float kSnrMidDb = 4.0f;      // probability 0.5
+const float kSnrSlopeDb = 1.5f;
+const double kSpeechBandHz = 4000.0;  // SNR is averaged over bins centered below this
+// Model features: running mean with a ~2 s time constant
+const float kMeanRate = 0.005f;
+
+int hopFor(int sampleRate) {
+    return std::max(1, sampleRate / 100);
+}
+
+// Smallest even length >= 25 ms that the real FFT supports (factors 2, 3, 5)
+int fftSizeFor(int sampleRate) {
+    for (int n = std::max(2, sampleRate / 40); n <= 4096; n++) {
+        if (n % 2 != 0) continue;
+        int m = n;
+        for (int p : {2, 3, 5}) {
+            while (m % p == 0) m /= p;
+        }
+        if (m == 1) return n;
+    }
+    return 0;
+}
+
+// Slaney mel scale, as the frontend's filterbank
+double hzToMel(double hz) {
+    const double logStep = std::log(6.4) / 27.0;
+    return hz < 1000.0 ? hz / (200.0 / 3.0) : 15.0 + std::log(hz / 1000.0) / logStep;
+}
+
+// Bins of a mels-bin filterbank up to sampleRate / 2 centered below hz
+int binsBelow(double hz, int sampleRate, int mels) {
+    const double step = hzToMel(sampleRate / 2.0) / (mels + 1);
+    return std::max(1, std::min(mels, static_cast<int>(hzToMel(hz) / step)));
+}
+
+double elapsedMs(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+}
+
+} // namespace
+
+VoiceDetector::VoiceDetector(const VadConfig& config, std::shared_ptr<const VadModel> model)
+    : config_(config), model_(std::move(model)),
+      endpointer_(config.endpointer, config.sampleRate, hopFor(config.sampleRate)),
+      hop_(hopFor(config.sampleRate)), mels_(kMels), speechBins_(kMels), primed_(false), levelBase_(0), hopEnergy_(0.0),
+      hopCount_(0), probability_(0.0f), processingMs_(0.0) {
+    const int fftSize = fftSizeFor(config.sampleRate);
+    if (config.sampleRate < 8000 || config.sampleRate > 96000 || fftSize == 0) {
+        error_ = "unsupported sample rate " + std::to_string(config.sampleRate);
+        return;
+    }
+    if (model_) {
+        if (config.sampleRate != 16000) {
+            error_ = "the VAD model needs 16 kHz input";
+            return;
+        }
+        mels_ = model_->mels();
+    }
+    speechBins_ = binsBelow(kSpeechBandHz, config.sampleRate, mels_);
+
+    asr::MelConfig mel;
+    mel.sampleRate = config.sampleRate;
+    mel.fftSize = fftSize;
+    mel.hopLength = hop_;
+    mel.mels = mels_;
+    frontend_ = std::make_unique<asr::MelFrontend>(std::make_shared<asr::MelKernel>(mel));
+    reset();
+}
+
+void VoiceDetector::reset() {
+    if (!frontend_) return;
+    frontend_->reset();
+    endpointer_.reset();
+    frames_.clear();
+    floor_.assign(static_cast<size_t>(mels_), 0.0f);
+    mean_.assign(static_cast<size_t>(mels_), 0.0f);
+    state_.assign(model_ ? static_cast<size_t>(model_->hidden()) : 0, 0.0f);
+    primed_ = false;
+    levels_.clear();
+    levelBase_ = 0;
+    hopEnergy_ = 0.0;
+    hopCount_ = 0;
+    probability_ = 0.0f;
+    processingMs_ = 0.0;
+}
+
+size_t VoiceDetector::process(const float* samples, size_t n, std::vector<VadEvent>* events,
+                              std::vector<float>* probabilities) {
+    if (!frontend_) return 0;
+    const auto start = std::chrono::steady_clock::now();
+    const uint64_t before = endpointer_.frames();
+    measure(samples, n);
+    frontend_->push(samples, n, &frames_);
+    score(events, probabilities);
+    processingMs_ += elapsedMs(start);
+    return static_cast<size_t>(endpointer_.frames() - before);
+}
+
+size_t VoiceDetector::process(const int16_t* samples, size_t n, std::vector<VadEvent>* events,
+                              std::vector<float>* probabilities) {
+    converted_.resize(n);
+    for (size_t i = 0; i < n; i++) converted_[i] = samples[i] / 32768.0f;
+    return process(converted_.data(), n, events, probabilities);
+}
+
+void VoiceDetector::flush(std::vector<VadEvent>* events, std::vector<float>* probabilities) {
+    if (!frontend_) return;
+    const auto start = std::chrono::steady_clock::now();
+    frontend_->flush(&frames_);
+    score(events, probabilities);
+    endpointer_.flush(frontend_->samplesReceived(), events);
+    processingMs_ += elapsedMs(start);
+}
+
+void VoiceDetector::measure(const float* samples, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        hopEnergy_ += static_cast<double>(samples[i]) * samples[i];
+        if (++hopCount_ == hop_) {
+            levels_.push_back(static_cast<float>(10.0 * std::log10(hopEnergy_ / hop_ + 1e-20)));
+            hopEnergy_ = 0.0;
+            hopCount_ = 0;
+        }
+    }
+}
+
+float VoiceDetector::frameLevel(uint64_t frame) const {
+    // Frame t is centered on sample t * hop: use the hops on either side
+    float level = -200.0f;
+    bool known = false;
+    for (uint64_t h = frame > 0 ? frame - 1 : 0; h <= frame; h++) {
+        if (h < levelBase_ || h - levelBase_ >= levels_.size()) continue;
+        level = std::max(level, levels_[static_cast<size_t>(h - levelBase_)]);
+        known = true;
+    }
+    return known ? level : 0.0f;
+}
+
+void VoiceDetector::score(std::vector<VadEvent>* events, std::vector<float>* probabilities) {
+    const size_t mels = static_cast<size_t>(mels_);
+    const size_t count = frames_.size() / mels;
+    for (size_t i = 0; i < count; i++) {
+        const uint64_t frame = endpointer_.frames();
+        const float p = frameScore(frames_.data() + i * mels);
+        probability_ = frameLevel(frame) < config_.minLevelDb ? 0.0f : p;
+        endpointer_.push(probability_, events);
+        if (probabilities) probabilities->push_back(probability_);
+    }
+    frames_.clear();
+
+    // Keep the level of the last scored frame's left hop
+    const uint64_t keep = endpointer_.frames() > 0 ? endpointer_.frames() - 1 : 0;
+    if (keep > levelBase_) {
+        const size_t drop = static_cast<size_t>(std::min<uint64_t>(keep - levelBase_, levels_.size()));
+        levels_.erase(levels_.begin(), levels_.begin() + static_cast<ptrdiff_t>(drop));
+        levelBase_ += drop;
+    }
+}
+
+float VoiceDetector::frameScore(const float* mel) {
+    const size_t mels = static_cast<size_t>(mels_);
+    if (!primed_) {
+        floor_.assign(mel, mel + mels);
+        mean_.assign(mel, mel + mels);
+        primed_ = true;
+    }
+
+    if (model_) {
+        features_.resize(mels);
+        for (size_t m = 0; m < mels; m++) {
+            mean_[m] += kMeanRate * (mel[m] - mean_[m]);
+            features_[m] = mel[m] - mean_[m];
+        }
+        return model_->step(features_.data(), state_.data(), &scratch_);
+    }
+
+    float snr = 0.0f;
+    for (size_t m = 0; m < static_cast<size_t>(speechBins_); m++) {
+        const float above = mel[m] - floor_[m];
+        floor_[m] += above < 0.0f ? kFloorFall * above : std::min(above, kFloorRise);
+        snr += std::max(above - kBandMargin, 0.0f);
+    }
+    const float snrDb = 10.0f * snr / static_cast<float>(speechBins_);
+    return 1.0f / (1.0f + std::exp(-(snrDb - kSnrMidDb) / kSnrSlopeDb));
+}
+
+} // namespace vad
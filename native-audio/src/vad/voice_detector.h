@@ -0,0 +1,107 @@
+// Streaming voice activity detection with endpointing
+//
+// Audio is turned into log-mel frames (25 ms window, 10 ms hop, 40 bins) by
+// the ASR frontend, each frame gets a speech probability, and an Endpointer
+// turns the probabilities into speech-start / speech-end events with sample
+// offsets. Two scorers:
+//
+//   model     VadModel (a small GRU) when one is given; 16 kHz input only
+//   built-in  per-bin noise floor tracking: the floor falls quickly toward
+//             quieter frames and rises by at most 3 dB/s, so steady noise
+//             (fans, hum, room tone) becomes the floor while speech stands
+//             out from it. The probability is a logistic of the mean SNR
+//             over the bins below 4 kHz, less 3 dB of noise fluctuation.
+//
+// Either way, frames below minLevelDb (dBFS) are never speech. Cost is the
+// mel frame plus a few hundred operations per 10 ms, well under 1% of a core.
+
+#ifndef VAD_VOICE_DETECTOR_H
+#define VAD_VOICE_DETECTOR_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "asr/mel_frontend.h"
+#include "endpointer.h"
+#include "vad_model.h"
+
+namespace vad {
+
+struct VadConfig {
+    int sampleRate = 16000;
+    float minLevelDb = -70.0f;   // about RMS 10 on int16 samples
+    EndpointerConfig endpointer;
+};
+
+class VoiceDetector {
+public:
+    explicit VoiceDetector(const VadConfig& config, std::shared_ptr<const VadModel> model = nullptr);
+
+    VoiceDetector(const VoiceDetector&) = delete;
+    VoiceDetector& operator=(const VoiceDetector&) = delete;
+
+    bool isValid() const { return error_.empty(); }
+    const std::string& error() const { return error_; }
+
+    // Append mono samples and score every frame that became complete.
+    // Events are appended in order, and the speech probability of each
+    // scored frame to probabilities if given. Returns the number of frames
+    // scored.
+    size_t process(const float* samples, size_t n, std::vector<VadEvent>* events,
+                   std::vector<float>* probabilities = nullptr);
+    size_t process(const int16_t* samples, size_t n, std::vector<VadEvent>* events,
+                   std::vector<float>* probabilities = nullptr);
+
+    // End of stream: score the last frames and close an open utterance
+    void flush(std::vector<VadEvent>* events, std::vector<float>* probabilities = nullptr);
+
+    void reset();
+
+    bool speaking() const { return endpointer_.speaking(); }
+    float probability() const { return probability_; }   // of the last frame
+    bool neural() const { return model_ != nullptr; }
+    uint64_t samples() const { return frontend_ ? frontend_->samplesReceived() : 0; }
+    uint64_t frames() const { return endpointer_.frames(); }
+    uint64_t speechFrames() const { return endpointer_.speechFrames(); }
+    int hopSamples() const { return hop_; }
+    double processingMs() const { return processingMs_; }
+
+private:
+    VadConfig config_;
+    std::shared_ptr<const VadModel> model_;
+    std::unique_ptr<asr::MelFrontend> frontend_;
+    Endpointer endpointer_;
+    std::string error_;
+    int hop_;
+    int mels_;
+    int speechBins_;
+
+    std::vector<float> frames_;
+    std::vector<float> converted_;
+    std::vector<float> floor_;       // built-in: noise floor per bin
+    std::vector<float> mean_;        // model: running mean per bin
+    std::vector<float> features_;
+    std::vector<float> state_;
+    std::vector<float> scratch_;
+    bool primed_;
+
+    // Level per hop (dBFS) for the frames not yet scored
+    std::vector<float> levels_;
+    uint64_t levelBase_;
+    double hopEnergy_;
+    int hopCount_;
+
+    float probability_;
+    double processingMs_;
+
+    void measure(const float* samples, size_t n);
+    void score(std::vector<VadEvent>* events, std::vector<float>* probabilities);
+    float frameScore(const float* mel);
+    float frameLevel(uint64_t frame) const;
+};
+
+} // namespace vad
+
+#endif
@@ -0,0 +1,332 @@
+#include <napi.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "vad/segmenter.h"
+#include "vad/voice_detector.h"
+
+static double GetNumberOption(const Napi::Object& options, const char* key, double fallback) {
+    if (options.Has(key) && options.Get(key).IsNumber()) {
+        return options.Get(key).As<Napi::Number>().DoubleValue();
+    }
+    return fallback;
+}
+
+// Detector options shared by both classes; throws and returns false on a bad model
+static bool ReadVadOptions(Napi::Env env, const Napi::Object& options, vad::VadConfig* config,
+                           std::shared_ptr<const vad::VadModel>* model) {
+    config->sampleRate = static_cast<int>(GetNumberOption(options, "sampleRate", config->sampleRate));
+    config->minLevelDb = static_cast<float>(GetNumberOption(options, "minLevelDb", config->minLevelDb));
+    vad::EndpointerConfig& ep = config->endpointer;
+    ep.onThreshold = static_cast<float>(GetNumberOption(options, "onThreshold", ep.onThreshold));
+    ep.offThreshold = static_cast<float>(GetNumberOption(options, "offThreshold", ep.offThreshold));
+    ep.minSpeechMs = static_cast<int>(GetNumberOption(options, "minSpeechMs", ep.minSpeechMs));
+    ep.hangoverMs = static_cast<int>(GetNumberOption(options, "hangoverMs", ep.hangoverMs));
+    ep.preRollMs = static_cast<int>(GetNumberOption(options, "preRollMs", ep.preRollMs));
+    ep.postRollMs = static_cast<int>(GetNumberOption(options, "postRollMs", ep.postRollMs));
+
+    if (options.Has("modelPath") && options.Get("modelPath").IsString()) {
+        std::string error;
+        *model = vad::VadModel::load(options.Get("modelPath").As<Napi::String>().Utf8Value(), &error);
+        if (!*model) {
+            Napi::Error::New(env, error).ThrowAsJavaScriptException();
+            return false;
+        }
+    }
+    return true;
+}
+
+// Streaming VAD; process() runs inline, it costs a fraction of a
+// millisecond per capture block
+class VoiceActivityAddon : public Napi::ObjectWrap<VoiceActivityAddon> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    VoiceActivityAddon(const Napi::CallbackInfo& info);
+
+private:
+    std::unique_ptr<vad::VoiceDetector> detector_;
+    std::vector<vad::VadEvent> events_;
+
+    Napi::Value Process(const Napi::CallbackInfo& info);
+    Napi::Value Flush(const Napi::CallbackInfo& info);
+    Napi::Value Reset(const Napi::CallbackInfo& info);
+    Napi::Value GetStats(const Napi::CallbackInfo& info);
+
+    Napi::Value TakeResult(Napi::Env env);
+};
+
+VoiceActivityAddon::VoiceActivityAddon(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<VoiceActivityAddon>(info) {
+    Napi::Env env = info.Env();
+
+    vad::VadConfig config;
+    std::shared_ptr<const vad::VadModel> model;
+    if (info.Length() > 0 && info[0].IsObject() &&
+        !ReadVadOptions(env, info[0].As<Napi::Object>(), &config, &model)) {
+        return;
+    }
+
+    detector_ = std::make_unique<vad::VoiceDetector>(config, model);
+    if (!detector_->isValid()) {
+        Napi::Error::New(env, detector_->error()).ThrowAsJavaScriptException();
+        return;
+    }
+}
+
+Napi::Value VoiceActivityAddon::TakeResult(Napi::Env env) {
+    Napi::Array events = Napi::Array::New(env, events_.size());
+    for (size_t i = 0; i < events_.size(); i++) {
+        Napi::Object event = Napi::Object::New(env);
+        event.Set("type", Napi::String::New(env, events_[i].type == vad::VadEventType::SpeechStart ? "start" : "end"));
+        event.Set("sample", Napi::Number::New(env, static_cast<double>(events_[i].sample)));
+        events.Set(static_cast<uint32_t>(i), event);
+    }
+    events_.clear();
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("events", events);
+    result.Set("speaking", Napi::Boolean::New(env, detector_->speaking()));
+    result.Set("probability", Napi::Number::New(env, detector_->probability()));
+    return result;
+}
+
+Napi::Value VoiceActivityAddon::Process(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsTypedArray()) {
+        Napi::TypeError::New(env, "Expected Float32Array, Int16Array or Buffer of int16 PCM")
+            .ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    Napi::TypedArray input = info[0].As<Napi::TypedArray>();
+    switch (input.TypedArrayType()) {
+        case napi_float32_array: {
+            Napi::Float32Array samples = input.As<Napi::Float32Array>();
+            detector_->process(samples.Data(), samples.ElementLength(), &events_);
+            break;
+        }
+        case napi_int16_array: {
+            Napi::Int16Array samples = input.As<Napi::Int16Array>();
+            detector_->process(samples.Data(), samples.ElementLength(), &events_);
+            break;
+        }
+        case napi_uint8_array: {
+            // Node Buffer holding s16le PCM, as produced by main.js
+            Napi::Uint8Array bytes = input.As<Napi::Uint8Array>();
+            detector_->process(reinterpret_cast<const int16_t*>(bytes.Data()),
+                               bytes.ByteLength() / sizeof(int16_t), &events_);
+            break;
+        }
+        default:
+            Napi::TypeError::New(env, "Unsupported TypedArray type for PCM input")
+                .ThrowAsJavaScriptException();
+            return env.Null();
+    }
+
+    return TakeResult(env);
+}
+
+Napi::Value VoiceActivityAddon::Flush(const Napi::CallbackInfo& info) {
+    detector_->flush(&events_);
+    return TakeResult(info.Env());
+}
+
+Napi::Value VoiceActivityAddon::Reset(const Napi::CallbackInfo& info) {
+    detector_->reset();
+    events_.clear();
+    return info.Env().Undefined();
+}
+
+Napi::Value VoiceActivityAddon::GetStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    const double frameMs = 10.0;
+    const double audioMs = detector_->frames() * frameMs;
+
+    Napi::Object stats = Napi::Object::New(env);
+    stats.Set("scorer", Napi::String::New(env, detector_->neural() ? "model" : "built-in"));
+    stats.Set("samples", Napi::Number::New(env, static_cast<double>(detector_->samples())));
+    stats.Set("frames", Napi::Number::New(env, static_cast<double>(detector_->frames())));
+    stats.Set("speechMs", Napi::Number::New(env, detector_->speechFrames() * frameMs));
+    stats.Set("processingMs", Napi::Number::New(env, detector_->processingMs()));
+    stats.Set("coreShare", Napi::Number::New(env, audioMs > 0 ? detector_->processingMs() / audioMs : 0.0));
+    return stats;
+}
+
+Napi::Object VoiceActivityAddon::Init(Napi::Env env, Napi::Object exports) {
+    Napi::Function func = DefineClass(env, "VoiceActivityDetector", {
+        InstanceMethod("process", &VoiceActivityAddon::Process),
+        InstanceMethod("flush", &VoiceActivityAddon::Flush),
+        InstanceMethod("reset", &VoiceActivityAddon::Reset),
+        InstanceMethod("getStats", &VoiceActivityAddon::GetStats),
+    });
+
+    exports.Set("VoiceActivityDetector", func);
+    return exports;
+}
+
+// Hands a segment's samples to JS as an s16le Buffer without copying them
+// again. Runtimes that forbid external buffers (Electron's V8 sandbox) get a
+// copy instead.
+static Napi::Buffer<uint8_t> SamplesToBuffer(Napi::Env env, std::vector<int16_t>&& samples) {
+    if (samples.empty()) return Napi::Buffer<uint8_t>::New(env, 0);
+    std::vector<int16_t>* owned = new std::vector<int16_t>(std::move(samples));
+    return Napi::Buffer<uint8_t>::NewOrCopy(env, reinterpret_cast<uint8_t*>(owned->data()),
+                                            owned->size() * sizeof(int16_t),
+                                            [](Napi::Env, uint8_t*, std::vector<int16_t>* hint) { delete hint; },
+                                            owned);
+}
+
+// Utterance segmenter: process() returns finished segments as contiguous
+// s16le Buffers, cut at speech pauses
+class UtteranceSegmenterAddon : public Napi::ObjectWrap<UtteranceSegmenterAddon> {
+public:
+    static Napi::Object Init(Napi::Env env, Napi::Object exports);
+    UtteranceSegmenterAddon(const Napi::CallbackInfo& info);
+
+private:
+    std::unique_ptr<vad::Segmenter> segmenter_;
+    std::vector<vad::Segment> segments_;
+    int sampleRate_;
+
+    Napi::Value Process(const Napi::CallbackInfo& info);
+    Napi::Value Flush(const Napi::CallbackInfo& info);
+    Napi::Value Reset(const Napi::CallbackInfo& info);
+    Napi::Value GetStats(const Napi::CallbackInfo& info);
+
+    Napi::Value TakeResult(Napi::Env env);
+};
+
+UtteranceSegmenterAddon::UtteranceSegmenterAddon(const Napi::CallbackInfo& info)
+    : Napi::ObjectWrap<UtteranceSegmenterAddon>(info), sampleRate_(0) {
+    Napi::Env env = info.Env();
+
+    vad::SegmenterConfig config;
+    std::shared_ptr<const vad::VadModel> model;
+    if (info.Length() > 0 && info[0].IsObject()) {
+        Napi::Object options = info[0].As<Napi::Object>();
+        if (!ReadVadOptions(env, options, &config.vad, &model)) return;
+        config.minDurationMs = static_cast<int>(GetNumberOption(options, "minDurationMs", config.minDurationMs));
+        config.maxDurationMs = static_cast<int>(GetNumberOption(options, "maxDurationMs", config.maxDurationMs));
+        config.overlapMs = static_cast<int>(GetNumberOption(options, "overlapMs", config.overlapMs));
+        config.cutSearchMs = static_cast<int>(GetNumberOption(options, "cutSearchMs", config.cutSearchMs));
+        config.maxGapMs = static_cast<int>(GetNumberOption(options, "maxGapMs", config.maxGapMs));
+    }
+    sampleRate_ = config.vad.sampleRate;
+
+    segmenter_ = std::make_unique<vad::Segmenter>(config, model);
+    if (!segmenter_->isValid()) {
+        Napi::Error::New(env, segmenter_->error()).ThrowAsJavaScriptException();
+        return;
+    }
+}
+
+Napi::Value UtteranceSegmenterAddon::TakeResult(Napi::Env env) {
+    static const char* const kCuts[] = {"pause", "max", "flush"};
+    const double msPerSample = 1000.0 / sampleRate_;
+
+    Napi::Array segments = Napi::Array::New(env, segments_.size());
+    for (size_t i = 0; i < segments_.size(); i++) {
+        vad::Segment& segment = segments_[i];
+        Napi::Object item = Napi::Object::New(env);
+        item.Set("index", Napi::Number::New(env, segment.index));
+        item.Set("startSample", Napi::Number::New(env, static_cast<double>(segment.startSample)));
+        item.Set("endSample", Napi::Number::New(env, static_cast<double>(segment.endSample)));
+        item.Set("startMs", Napi::Number::New(env, segment.startSample * msPerSample));
+        item.Set("endMs", Napi::Number::New(env, segment.endSample * msPerSample));
+        item.Set("cut", Napi::String::New(env, kCuts[static_cast<int>(segment.cut)]));
+        if (!segment.remap.empty()) {
+            // [compacted, original] sample offset pairs, original relative to startSample
+            Napi::Float64Array remap = Napi::Float64Array::New(env, segment.remap.size() * 2);
+            for (size_t r = 0; r < segment.remap.size(); r++) {
+                remap[r * 2] = static_cast<double>(segment.remap[r].compacted);
+                remap[r * 2 + 1] = static_cast<double>(segment.remap[r].original);
+            }
+            item.Set("remap", remap);
+        }
+        item.Set("pcm", SamplesToBuffer(env, std::move(segment.pcm)));
+        segments.Set(static_cast<uint32_t>(i), item);
+    }
+    segments_.clear();
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("segments", segments);
+    result.Set("speaking", Napi::Boolean::New(env, segmenter_->speaking()));
+    result.Set("pending", Napi::Boolean::New(env, segmenter_->pending()));
+    return result;
+}
+
+Napi::Value UtteranceSegmenterAddon::Process(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsTypedArray()) {
+        Napi::TypeError::New(env, "Expected Int16Array or Buffer of int16 PCM").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    Napi::TypedArray input = info[0].As<Napi::TypedArray>();
+    switch (input.TypedArrayType()) {
+        case napi_int16_array: {
+            Napi::Int16Array samples = input.As<Napi::Int16Array>();
+            segmenter_->process(samples.Data(), samples.ElementLength(), &segments_);
+            break;
+        }
+        case napi_uint8_array: {
+            Napi::Uint8Array bytes = input.As<Napi::Uint8Array>();
+            segmenter_->process(reinterpret_cast<const int16_t*>(bytes.Data()),
+                                bytes.ByteLength() / sizeof(int16_t), &segments_);
+            break;
+        }
+        default:
+            Napi::TypeError::New(env, "Unsupported TypedArray type for PCM input")
+                .ThrowAsJavaScriptException();
+            return env.Null();
+    }
+
+    return TakeResult(env);
+}
+
+Napi::Value UtteranceSegmenterAddon::Flush(const Napi::CallbackInfo& info) {
+    segmenter_->flush(&segments_);
+    return TakeResult(info.Env());
+}
+
+Napi::Value UtteranceSegmenterAddon::Reset(const Napi::CallbackInfo& info) {
+    segmenter_->reset();
+    segments_.clear();
+    return info.Env().Undefined();
+}
+
+Napi::Value UtteranceSegmenterAddon::GetStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    const vad::VoiceDetector& detector = segmenter_->detector();
+    const double audioMs = detector.frames() * 10.0;
+
+    Napi::Object stats = Napi::Object::New(env);
+    stats.Set("scorer", Napi::String::New(env, detector.neural() ? "model" : "built-in"));
+    stats.Set("samples", Napi::Number::New(env, static_cast<double>(segmenter_->samples())));
+    stats.Set("speechMs", Napi::Number::New(env, detector.speechFrames() * 10.0));
+    stats.Set("processingMs", Napi::Number::New(env, detector.processingMs()));
+    stats.Set("coreShare", Napi::Number::New(env, audioMs > 0 ? detector.processingMs() / audioMs : 0.0));
+    return stats;
+}
+
+Napi::Object UtteranceSegmenterAddon::Init(Napi::Env env, Napi::Object exports) {
+    Napi::Function func = DefineClass(env, "UtteranceSegmenter", {
+        InstanceMethod("process", &UtteranceSegmenterAddon::Process),
+        InstanceMethod("flush", &UtteranceSegmenterAddon::Flush),
+        InstanceMethod("reset", &UtteranceSegmenterAddon::Reset),
+        InstanceMethod("getStats", &UtteranceSegmenterAddon::GetStats),
+    });
+
+    exports.Set("UtteranceSegmenter", func);
+    return exports;
+}
+
+Napi::Object InitAll(Napi::Env env, Napi::Object exports) {
+    VoiceActivityAddon::Init(env, exports);
+    return UtteranceSegmenterAddon::Init(env, exports);
+}
+
+NODE_API_MODULE(voice_activity, InitAll)
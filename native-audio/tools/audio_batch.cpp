@@ -0,0 +1,326 @@
+// Offline batch processing of WAV corpora
+//
+// Runs a chain of denoise / resample / loudness normalize / VAD trim over
+// every WAV file under the given directories, one file per task on a
+// work-stealing scheduler across all cores, and reports the real-time factor
+// (processing time / audio duration) per file and for the whole run.
+
+#include <algorithm>
+#include <chrono>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "batch/audio_chain.h"
+#include "batch/file_scheduler.h"
+#include "dsp/wav_file.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct InputFile {
+    fs::path path;
+    fs::path relative;   // under --out
+    uint64_t bytes = 0;
+};
+
+struct FileReport {
+    bool ok = false;
+    std::string error;
+    int worker = 0;
+    int inputRate = 0;
+    int channels = 0;
+    double audioSeconds = 0.0;
+    double outputSeconds = 0.0;
+    double readMs = 0.0;
+    double writeMs = 0.0;
+    double totalMs = 0.0;
+    batch::ChainResult chain;
+
+    double rtf() const { return audioSeconds > 0.0 ? totalMs / 1000.0 / audioSeconds : 0.0; }
+};
+
+struct Options {
+    std::vector<std::string> inputs;
+    std::string chain = "denoise,resample,normalize,trim";
+    std::string out;
+    int sampleRate = 16000;
+    double lufs = -23.0;
+    double peakDb = -1.0;
+    int threads = 0;
+    bool json = false;
+    bool quiet = false;
+};
+
+double msSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void usage(const char* argv0) {
+    std::fprintf(stderr,
+                 "usage: %s [options] <dir|file.wav>...\n"
+                 "  --chain LIST   stages in order (default denoise,resample,normalize,trim)\n"
+                 "  --rate HZ      resample target (default 16000)\n"
+                 "  --lufs LUFS    loudness target (default -23)\n"
+                 "  --peak DB      sample peak ceiling after normalizing (default -1)\n"
+                 "  --threads N    workers (default: all cores)\n"
+                 "  --out DIR      write 16-bit WAVs here, mirroring the input tree\n"
+                 "                 (without it files are processed and discarded)\n"
+                 "  --json         print the report as JSON\n"
+                 "  --quiet        no per-file lines\n",
+                 argv0);
+}
+
+bool parseArgs(int argc, char** argv, Options* options) {
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        auto value = [&](const char** out) {
+            if (i + 1 >= argc) return false;
+            *out = argv[++i];
+            return true;
+        };
+        const char* v = nullptr;
+        if (arg == "--chain") {
+            if (!value(&v)) return false;
+            options->chain = v;
+        } else if (arg == "--rate") {
+            if (!value(&v)) return false;
+            options->sampleRate = std::atoi(v);
+        } else if (arg == "--lufs") {
+            if (!value(&v)) return false;
+            options->lufs = std::atof(v);
+        } else if (arg == "--peak") {
+            if (!value(&v)) return false;
+            options->peakDb = std::atof(v);
+        } else if (arg == "--threads") {
+            if (!value(&v)) return false;
+            options->threads = std::atoi(v);
+        } else if (arg == "--out") {
+            if (!value(&v)) return false;
+            options->out = v;
+        } else if (arg == "--json") {
+            options->json = true;
+        } else if (arg == "--quiet") {
+            options->quiet = true;
+        } else if (arg.size() > 1 && arg[0] == '-') {
+            return false;
+        } else {
+            options->inputs.push_back(arg);
+        }
+    }
+    return !options->inputs.empty() && options->sampleRate > 0;
+}
+
+bool isWav(const fs::path& path) {
+    std::string ext = path.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
+    return ext == ".wav";
+}
+
+bool collectInputs(const std::vector<std::string>& inputs, std::vector<InputFile>* files) {
+    for (const std::string& input : inputs) {
+        std::error_code ec;
+        const fs::path root(input);
+        if (fs::is_directory(root, ec)) {
+            for (auto it = fs::recursive_directory_iterator(root, fs::directory_options::skip_permission_denied, ec);
+                 !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+                if (!it->is_regular_file(ec) || !isWav(it->path())) continue;
+                files->push_back({it->path(), fs::relative(it->path(), root, ec), it->file_size(ec)});
+            }
+        } else if (fs::is_regular_file(root, ec)) {
+            files->push_back({root, root.filename(), fs::file_size(root, ec)});
+        } else {
+            std::fprintf(stderr, "not found: %s\n", input.c_str());
+            return false;
+        }
+        if (ec) {
+            std::fprintf(stderr, "%s: %s\n", input.c_str(), ec.message().c_str());
+            return false;
+        }
+    }
+    std::sort(files->begin(), files->end(), [](const InputFile& a, const InputFile& b) { return a.path < b.path; });
+    return true;
+}
+
+void processFile(const InputFile& file, const batch::ChainConfig& config, const std::string& outDir,
+                 FileReport* report) {
+    const auto start = std::chrono::steady_clock::now();
+    dsp::WavAudio audio;
+    if (!dsp::readWav(file.path.string(), &audio, &report->error)) return;
+    report->inputRate = audio.sampleRate;
+    report->channels = audio.channels;
+    report->audioSeconds = audio.seconds();
+    dsp::downmixToMono(&audio);
+    report->readMs = msSince(start);
+
+    batch::runChain(config, &audio.samples, audio.sampleRate, &report->chain);
+    report->outputSeconds = static_cast<double>(audio.samples.size()) / report->chain.sampleRate;
+
+    if (!outDir.empty()) {
+        const auto writeStart = std::chrono::steady_clock::now();
+        fs::path target = fs::path(outDir) / file.relative;
+        std::error_code ec;
+        fs::create_directories(target.parent_path(), ec);
+        if (ec) {
+            report->error = target.parent_path().string() + ": " + ec.message();
+            return;
+        }
+        if (!dsp::writeWav(target.string(), audio.samples.data(), audio.samples.size(), report->chain.sampleRate, 1,
+                           &report->error)) {
+            return;
+        }
+        report->writeMs = msSince(writeStart);
+    }
+    report->totalMs = msSince(start);
+    report->ok = true;
+}
+
+std::string jsonString(const std::string& s) {
+    std::string out = "\"";
+    for (unsigned char c : s) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += static_cast<char>(c);
+        } else if (c < 0x20) {
+            char buffer[8];
+            std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+            out += buffer;
+        } else {
+            out += static_cast<char>(c);
+        }
+    }
+    return out + "\"";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseArgs(argc, argv, &options)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    batch::ChainConfig config;
+    std::string error;
+    if (!batch::parseChain(options.chain, &config.stages, &error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 2;
+    }
+    config.sampleRate = options.sampleRate;
+    config.loudness.targetLufs = options.lufs;
+    config.loudness.peakDb = options.peakDb;
+
+    std::vector<InputFile> files;
+    if (!collectInputs(options.inputs, &files)) return 2;
+    if (files.empty()) {
+        std::fprintf(stderr, "no .wav files found\n");
+        return 2;
+    }
+
+    std::vector<uint64_t> costs;
+    for (const InputFile& file : files) costs.push_back(file.bytes);
+    std::vector<FileReport> reports(files.size());
+    batch::FileScheduler scheduler(options.threads);
+    std::mutex printMutex;
+
+    const auto start = std::chrono::steady_clock::now();
+    scheduler.run(costs, [&](size_t index, int worker) {
+        FileReport& report = reports[index];
+        report.worker = worker;
+        processFile(files[index], config, options.out, &report);
+        if (options.quiet || options.json) return;
+        std::lock_guard<std::mutex> lock(printMutex);
+        if (report.ok) {
+            std::printf("%-48s %6d Hz %d ch %8.2f s -> %8.2f s %9.1f ms  RTF %.4f  (%.0fx)\n",
+                        files[index].relative.string().c_str(), report.inputRate, report.channels,
+                        report.audioSeconds, report.outputSeconds, report.totalMs, report.rtf(),
+                        report.rtf() > 0.0 ? 1.0 / report.rtf() : 0.0);
+        } else {
+            std::printf("%-48s FAILED: %s\n", files[index].relative.string().c_str(), report.error.c_str());
+        }
+        std::fflush(stdout);
+    });
+    const double wallMs = msSince(start);
+
+    // Whole run
+    size_t failed = 0;
+    double audioSeconds = 0.0;
+    double outputSeconds = 0.0;
+    double cpuMs = 0.0;
+    double readMs = 0.0;
+    double writeMs = 0.0;
+    double stageMs[batch::kStageCount] = {0.0, 0.0, 0.0, 0.0};
+    for (const FileReport& report : reports) {
+        if (!report.ok) {
+            failed++;
+            continue;
+        }
+        audioSeconds += report.audioSeconds;
+        outputSeconds += report.outputSeconds;
+        cpuMs += report.totalMs;
+        readMs += report.readMs;
+        writeMs += report.writeMs;
+        for (int s = 0; s < batch::kStageCount; s++) stageMs[s] += report.chain.stageMs[s];
+    }
+    const double runRtf = audioSeconds > 0.0 ? wallMs / 1000.0 / audioSeconds : 0.0;
+    const double cpuRtf = audioSeconds > 0.0 ? cpuMs / 1000.0 / audioSeconds : 0.0;
+    size_t steals = 0;
+    for (const batch::WorkerStats& stats : scheduler.stats()) steals += stats.steals;
+
+    if (options.json) {
+        const bool normalized = std::find(config.stages.begin(), config.stages.end(), batch::Stage::Normalize) !=
+                                config.stages.end();
+        std::printf("{\"chain\":%s,\"threads\":%d,\"files\":[", jsonString(options.chain).c_str(), scheduler.threads());
+        for (size_t i = 0; i < files.size(); i++) {
+            const FileReport& r = reports[i];
+            std::printf("%s{\"path\":%s,\"ok\":%s", i ? "," : "", jsonString(files[i].path.string()).c_str(),
+                        r.ok ? "true" : "false");
+            if (r.ok) {
+                std::printf(",\"sampleRate\":%d,\"channels\":%d,\"audioSeconds\":%.3f,\"outputSeconds\":%.3f,"
+                            "\"totalMs\":%.3f,\"rtf\":%.6f,\"worker\":%d",
+                            r.inputRate, r.channels, r.audioSeconds, r.outputSeconds, r.totalMs, r.rtf(), r.worker);
+                if (normalized && std::isfinite(r.chain.loudness.inputLufs)) {
+                    std::printf(",\"inputLufs\":%.2f,\"gainDb\":%.2f", r.chain.loudness.inputLufs,
+                                r.chain.loudness.gainDb);
+                }
+            } else {
+                std::printf(",\"error\":%s", jsonString(r.error).c_str());
+            }
+            std::printf("}");
+        }
+        std::printf("],\"failed\":%zu,\"audioSeconds\":%.3f,\"outputSeconds\":%.3f,\"wallMs\":%.3f,"
+                    "\"rtf\":%.6f,\"cpuRtf\":%.6f,\"steals\":%zu,\"stageMs\":{\"read\":%.3f",
+                    failed, audioSeconds, outputSeconds, wallMs, runRtf, cpuRtf, steals, readMs);
+        for (int s = 0; s < batch::kStageCount; s++) {
+            std::printf(",\"%s\":%.3f", batch::stageName(static_cast<batch::Stage>(s)), stageMs[s]);
+        }
+        std::printf(",\"write\":%.3f}}\n", writeMs);
+        return failed ? 1 : 0;
+    }
+
+    std::printf("\n%zu files (%zu failed), %.1f s of audio -> %.1f s, chain %s\n", files.size(), failed, audioSeconds,
+                outputSeconds, options.chain.c_str());
+    std::printf("wall %.2f s on %d threads: RTF %.5f (%.0fx realtime), CPU RTF %.5f per core\n", wallMs / 1000.0,
+                scheduler.threads(), runRtf, runRtf > 0.0 ? 1.0 / runRtf : 0.0, cpuRtf);
+    auto share = [&](const char* name, double ms) {
+        std::printf("  %-10s %9.1f ms  %5.1f%%\n", name, ms, cpuMs > 0.0 ? 100.0 * ms / cpuMs : 0.0);
+    };
+    share("read", readMs);
+    for (batch::Stage stage : config.stages) share(batch::stageName(stage), stageMs[static_cast<int>(stage)]);
+    if (!options.out.empty()) share("write", writeMs);
+    for (size_t w = 0; w < scheduler.stats().size(); w++) {
+        const batch::WorkerStats& stats = scheduler.stats()[w];
+        std::printf("  worker %-3zu %4zu files, %3zu stolen, busy %5.1f%%\n", w, stats.tasks, stats.steals,
+                    wallMs > 0.0 ? 100.0 * stats.busyMs / wallMs : 0.0);
+    }
+    return failed ? 1 : 0;
+}
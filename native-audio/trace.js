@@ -0,0 +1,175 @@
+// Tracing across the native audio addons and the JS around them
+//
+// Each addon records its own threads (the ScreenCaptureKit/WASAPI callback,
+// the delivery thread, the JS callback, RNNoise frames) into per-thread
+// lock-free buffers. This module starts and stops all of them together,
+// records JS spans alongside, and exports one trace: Chrome trace JSON
+// (chrome://tracing, ui.perfetto.dev) or a Perfetto protobuf trace.
+//
+// Until start() every trace point, native or JS, is a cheap no-op. While
+// recording, each thread keeps its newest eventsPerThread events, so a
+// trace saved right after a latency spike holds the moments leading to it.
+const fs = require("fs");
+const path = require("path");
+
+const modules = [];
+
+for (const name of ["speaker_audio_capture", "rnnoise"]) {
+  try {
+    const native = require(`./build/Release/${name}.node`);
+    if (typeof native.traceStart === "function") {
+      modules.push(native);
+    }
+  } catch (error) {
+    // Not built for this platform
+  }
+}
+
+// JS spans and ids go to the first addon; all share one clock
+const primary = modules[0] || null;
+
+function isAvailable() {
+  return primary !== null;
+}
+
+/**
+ * Start recording, dropping whatever an earlier recording left
+ * @param {Object} [options]
+ * @param {number} [options.eventsPerThread=8192] - Ring size per thread
+ */
+function start(options = {}) {
+  for (const native of modules) {
+    native.traceStart(options.eventsPerThread || 8192);
+    native.traceSetThreadName("JavaScript");
+  }
+}
+
+// Recorded events stay until the next start()
+function stop() {
+  for (const native of modules) {
+    native.traceStop();
+  }
+}
+
+function isEnabled() {
+  return primary !== null && primary.traceEnabled();
+}
+
+/**
+ * Open a span on the JS thread; end() closes the innermost one
+ * @param {string} name - Keep the set of names small
+ * @param {string} [argName] - Name of a numeric argument shown with the span
+ * @param {number} [arg]
+ */
+function begin(name, argName, arg) {
+  if (primary) primary.traceBegin(name, argName, arg);
+}
+
+function end() {
+  if (primary) primary.traceEnd();
+}
+
+/**
+ * Run fn inside an async span (a track of its own, as fn may await). A
+ * returned promise ends the span when it settles.
+ * @returns Whatever fn returns
+ */
+function span(name, fn) {
+  if (!isEnabled()) {
+    return fn();
+  }
+  const id = primary.traceNewId();
+  primary.traceAsyncBegin(name, id);
+  let result;
+  try {
+    result = fn();
+  } catch (error) {
+    primary.traceAsyncEnd(name, id);
+    throw error;
+  }
+  if (result && typeof result.then === "function") {
+    return result.finally(() => primary.traceAsyncEnd(name, id));
+  }
+  primary.traceAsyncEnd(name, id);
+  return result;
+}
+
+/**
+ * A span that ends later or elsewhere, e.g. an upload
+ * @returns {number} Pass it to asyncEnd(); 0 when not recording
+ */
+function asyncBegin(name) {
+  if (!isEnabled()) return 0;
+  const id = primary.traceNewId();
+  primary.traceAsyncBegin(name, id);
+  return id;
+}
+
+function asyncEnd(name, id) {
+  if (primary && id) primary.traceAsyncEnd(name, id);
+}
+
+function instant(name) {
+  if (primary) primary.traceInstant(name);
+}
+
+function counter(name, value) {
+  if (primary) primary.traceCounter(name, value);
+}
+
+/**
+ * @returns {Object} Per addon: { threads, events, overwritten, dropped }
+ */
+function getStats() {
+  return modules.map((native) => native.traceStats());
+}
+
+/**
+ * @param {string} [format='json'] - 'json' (a string) or 'perfetto' (a Buffer)
+ * @param {string} [processName]
+ */
+function exportTrace(format = "json", processName = path.basename(process.argv0)) {
+  if (format === "perfetto") {
+    return Buffer.concat(modules.map((native) => native.traceExport("perfetto", processName)));
+  }
+  const traceEvents = [];
+  const seen = new Set();
+  for (const native of modules) {
+    for (const event of JSON.parse(native.traceExport("json", processName)).traceEvents) {
+      // Process and thread names are repeated by every addon
+      if (event.ph === "M") {
+        const key = `${event.name}:${event.pid}:${event.tid}`;
+        if (seen.has(key)) continue;
+        seen.add(key);
+      }
+      traceEvents.push(event);
+    }
+  }
+  return JSON.stringify({ displayTimeUnit: "ms", traceEvents });
+}
+
+/**
+ * Write the trace to file: Perfetto for .pftrace or .perfetto-trace, JSON
+ * otherwise
+ */
+function save(file, processName) {
+  const perfetto = /\.(pftrace|perfetto-trace)$/i.test(file);
+  fs.writeFileSync(file, exportTrace(perfetto ? "perfetto" : "json", processName));
+}
+
+module.exports = {
+  isAvailable,
+  start,
+  stop,
+  isEnabled,
+  begin,
+  end,
+  span,
+  asyncBegin,
+  asyncEnd,
+  instant,
+  counter,
+  getStats,
+  export: exportTrace,
+  save,
+};
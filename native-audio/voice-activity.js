@@ -0,0 +1,171 @@
+// JavaScript wrapper for the native voice activity detector
+let vadModule = null;
+
+try {
+  vadModule = require("./build/Release/voice_activity.node");
+} catch (error) {
+  console.warn("⚠️ Voice activity module not available:", error.message);
+  console.warn("   Silence will be gated on a fixed RMS threshold");
+  console.warn("   To build it: cd native-audio && npm run rebuild");
+}
+
+class VoiceActivityDetector {
+  /**
+   * Streaming VAD with endpointing. Sample offsets in events count from the
+   * first sample passed to process() (or since reset()).
+   * @param {Object} [options]
+   * @param {number} [options.sampleRate=16000] - Input rate (8-96 kHz; 16 kHz with a model)
+   * @param {string} [options.modelPath] - GRU model (tensor container of kind "vad");
+   *   without one a built-in noise-floor tracker is used
+   * @param {number} [options.minLevelDb=-70] - Frames quieter than this (dBFS) are never speech
+   * @param {number} [options.onThreshold=0.6] - Speech probability that opens an utterance
+   * @param {number} [options.offThreshold=0.4] - Probability below which speech is pausing
+   * @param {number} [options.minSpeechMs=120] - Shorter bursts do not start an utterance
+   * @param {number} [options.hangoverMs=500] - Pause that ends an utterance
+   * @param {number} [options.preRollMs=200] - Start events are moved back by this much
+   * @param {number} [options.postRollMs=150] - End events follow the last speech by this much
+   */
+  constructor(options = {}) {
+    this.options = options;
+    this.detector = vadModule ? new vadModule.VoiceActivityDetector(options) : null;
+  }
+
+  /**
+   * Check if the native detector is available
+   * @returns {boolean} True if the module is loaded
+   */
+  isAvailable() {
+    return this.detector !== null;
+  }
+
+  /**
+   * Score new audio
+   * @param {Float32Array|Int16Array|Buffer} samples - Float32 or s16le PCM
+   * @returns {{events: Array<{type: "start"|"end", sample: number}>, speaking: boolean,
+   *           probability: number}}
+   */
+  process(samples) {
+    return this.detector.process(samples);
+  }
+
+  /**
+   * End of stream: closes an open utterance
+   * @returns {{events: Array<{type: "start"|"end", sample: number}>, speaking: boolean,
+   *           probability: number}}
+   */
+  flush() {
+    return this.detector.flush();
+  }
+
+  /**
+   * Forget the stream; offsets start from 0 again
+   */
+  reset() {
+    this.detector.reset();
+  }
+
+  /**
+   * @returns {{scorer: string, samples: number, frames: number, speechMs: number,
+   *           processingMs: number, coreShare: number}}
+   */
+  getStats() {
+    return this.detector.getStats();
+  }
+}
+
+class UtteranceSegmenter {
+  /**
+   * Cuts a PCM stream into segments at speech pauses. Takes every option of
+   * VoiceActivityDetector plus the ones below.
+   * @param {Object} [options]
+   * @param {number} [options.minDurationMs=1000] - Shorter utterances wait this long
+   *   for the next one and are joined with it
+   * @param {number} [options.maxDurationMs=15000] - Longer utterances are cut at the
+   *   quietest 10 ms of the last cutSearchMs
+   * @param {number} [options.overlapMs=300] - Audio before such a cut that is repeated
+   *   at the start of the next segment
+   * @param {number} [options.cutSearchMs=3000]
+   * @param {number} [options.maxGapMs=0] - Shorten non-speech inside a segment to
+   *   this (0 = off); such segments carry a remap table, see originalTimeMs()
+   */
+  constructor(options = {}) {
+    this.options = options;
+    this.segmenter = vadModule ? new vadModule.UtteranceSegmenter(options) : null;
+  }
+
+  /**
+   * Check if the native segmenter is available
+   * @returns {boolean} True if the module is loaded
+   */
+  isAvailable() {
+    return this.segmenter !== null;
+  }
+
+  /**
+   * Append audio and collect the segments it finished
+   * @param {Int16Array|Buffer} samples - s16le PCM at options.sampleRate
+   * @returns {{segments: Array<{index: number, pcm: Buffer, startSample: number,
+   *           endSample: number, startMs: number, endMs: number,
+   *           cut: "pause"|"max"|"flush", remap?: Float64Array}>, speaking: boolean,
+   *           pending: boolean}}
+   *   pcm is one contiguous s16le Buffer per segment; pending is true while
+   *   audio is waiting in an unfinished segment. remap is present when silence
+   *   was compacted: [compactedSample, originalSample] pairs, one per kept piece
+   */
+  process(samples) {
+    return this.segmenter.process(samples);
+  }
+
+  /**
+   * End of stream: returns the unfinished segment, however short
+   * @returns {{segments: Array<Object>, speaking: boolean, pending: boolean}}
+   */
+  flush() {
+    return this.segmenter.flush();
+  }
+
+  /**
+   * Drop buffered audio; offsets and indexes start from 0 again
+   */
+  reset() {
+    this.segmenter.reset();
+  }
+
+  /**
+   * @returns {{scorer: string, samples: number, speechMs: number,
+   *           processingMs: number, coreShare: number}}
+   */
+  getStats() {
+    return this.segmenter.getStats();
+  }
+
+  /**
+   * Map a time in a segment's (possibly compacted) audio, e.g. a word time
+   * from its transcript, back to the stream
+   * @param {Object} segment - A segment returned by process() or flush()
+   * @param {number} ms - Offset into segment.pcm in milliseconds
+   * @returns {number} Milliseconds from the start of the stream
+   */
+  originalTimeMs(segment, ms) {
+    const rate = (this.options.sampleRate || 16000) / 1000;
+    const compacted = ms * rate;
+    let original = compacted;
+    const remap = segment.remap;
+    if (remap) {
+      // Last piece starting at or before the compacted offset
+      let lo = 0;
+      let hi = remap.length / 2 - 1;
+      while (lo < hi) {
+        const mid = (lo + hi + 1) >> 1;
+        if (remap[mid * 2] <= compacted) lo = mid;
+        else hi = mid - 1;
+      }
+      original = remap[lo * 2 + 1] + Math.max(0, compacted - remap[lo * 2]);
+    }
+    return (segment.startSample + original) / rate;
+  }
+}
+
+module.exports = VoiceActivityDetector;
+module.exports.UtteranceSegmenter = UtteranceSegmenter;
+module.exports.isAvailable = () => vadModule !== null;
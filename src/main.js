@@ -19,6 +19,40 @@ if (process.platform === "darwin") {
   }
 }
 
+// Tracing of the audio path (AUDIO_TRACE=<file>): the native capture and
+// delivery threads, the capture callback below and Deepgram uploads, saved
+// on quit as a Perfetto trace (.pftrace) or Chrome trace JSON
+const AUDIO_TRACE_FILE = process.env.AUDIO_TRACE || "";
+let audioTrace = null;
+
+if (AUDIO_TRACE_FILE) {
+  try {
+    audioTrace = require("../native-audio/trace.js");
+    if (audioTrace.isAvailable()) {
+      audioTrace.start();
+      console.log(`✅ Audio tracing on, saved to ${AUDIO_TRACE_FILE} on quit`);
+    } else {
+      console.log("⚠️ Audio tracing needs the native audio modules");
+      audioTrace = null;
+    }
+  } catch (error) {
+    console.log("⚠️ Audio tracing not available:", error.message);
+  }
+}
+
+// handler, recorded as a span on the JS thread while tracing
+function traced(name, handler) {
+  return (...args) => {
+    if (!audioTrace) return handler(...args);
+    audioTrace.begin(name);
+    try {
+      return handler(...args);
+    } finally {
+      audioTrace.end();
+    }
+  };
+}
+
 // Try to load RNNoise module for microphone noise cancellation (macOS only)
 let rnnoiseWrapper = null;
 
@@ -32,6 +66,161 @@ if (process.platform === "darwin") {
   }
 }
 
+// Try to load the native Opus encoder; segments fall back to ffmpeg/MP3 without it
+let OpusEncoder = null;
+let speakerOpusEncoder = null;
+let microphoneOpusEncoder = null;
+
+try {
+  OpusEncoder = require("../native-audio/opus-encoder.js");
+  if (OpusEncoder.isAvailable()) {
+    speakerOpusEncoder = new OpusEncoder({ sampleRate: 16000, bitrate: 24000 });
+    microphoneOpusEncoder = new OpusEncoder({
+      sampleRate: 16000,
+      bitrate: 24000,
+    });
+    console.log("✅ Opus encoder loaded (24 kbps Ogg/Opus segments)");
+  }
+} catch (error) {
+  console.log("⚠️ Opus encoder not available:", error.message);
+  console.log("   Segments will be converted to MP3 with ffmpeg");
+}
+
+// Try to load the native segment writer; microphone audio is then written to
+// WAV segments on a background thread instead of Buffer.concat + writeFileSync
+let AudioStorage = null;
+let microphoneSegmentWriter = null;
+
+try {
+  AudioStorage = require("../native-audio/audio-storage.js");
+  if (AudioStorage.isAvailable()) {
+    console.log("✅ Segment writer loaded (background WAV segments)");
+  }
+} catch (error) {
+  console.log("⚠️ Segment writer not available:", error.message);
+}
+
+// Optional on-device transcription with a Whisper model (ggml format). It is
+// used when no Deepgram client is configured, while Deepgram is unreachable,
+// or for everything with LOCAL_ASR=always; LOCAL_ASR=off disables it. The
+// model comes from LOCAL_ASR_MODEL or the first userData/models/ggml-*.bin.
+// Weights are quantized to int8 at load (LOCAL_ASR_WEIGHTS=f32|int8|int4).
+// While it is in use, voiced capture audio also streams through it for live
+// partial transcripts.
+let LocalAsr = null;
+
+try {
+  LocalAsr = require("../native-audio/local-asr.js");
+  if (LocalAsr.isAvailable()) {
+    console.log("✅ Local ASR module loaded");
+  }
+} catch (error) {
+  console.log("⚠️ Local ASR not available:", error.message);
+}
+
+// Keep-alive uploader for Deepgram requests: a native connection pool (HTTP/2
+// multiplexed when offered) with retries with jittered backoff, sending
+// segment buffers without copying them, behind a scheduler that sends live
+// segments before recovered ones, caps requests in flight and sheds the
+// oldest backlog when the uplink cannot keep up. Without it requests go
+// through https.request on a keep-alive agent.
+let HttpUploader = null;
+let deepgramUploader = null;
+const deepgramAgent = new https.Agent({ keepAlive: true, maxSockets: 4 });
+
+try {
+  HttpUploader = require("../native-audio/http-uploader.js");
+  if (HttpUploader.isAvailable()) {
+    deepgramUploader = new HttpUploader.UploadScheduler({
+      maxInFlight: 4,
+      maxHostConnections: 2,
+      maxQueued: 32,
+      liveSloMs: 5000,
+    });
+    console.log("✅ HTTP uploader loaded (pooled keep-alive connections, live-first scheduling)");
+  }
+} catch (error) {
+  console.log("⚠️ HTTP uploader not available:", error.message);
+}
+
+const LOCAL_ASR_MODE = process.env.LOCAL_ASR || "fallback"; // "always", "fallback" or "off"
+const LOCAL_ASR_WEIGHTS = process.env.LOCAL_ASR_WEIGHTS || "int8";
+const REMOTE_RETRY_MS = 30 * 1000; // How long to stay local after a network error
+let localRecognizerLoading = null;
+let localRecognizer = null; // set once the model has loaded
+let remoteOfflineUntil = 0;
+
+// Spoken language identification (LID_MODEL or userData/models/lid.tnsr).
+// Speaker segments whose language is identified with enough confidence, and
+// the same in every part of the segment, are sent with that language instead
+// of language=multi; mixed or uncertain segments stay multilingual.
+const LID_MIN_CONFIDENCE = 0.8;
+const DEEPGRAM_LANGUAGES = new Set(["en", "es", "fr", "de", "hi", "ru", "pt", "ja", "it", "nl"]);
+let languageIdentifier; // undefined = not tried yet, null = unavailable
+
+// Utterance-aligned segmentation: a native segmenter runs voice activity
+// detection on captured audio and cuts it into segments at speech pauses
+// (joining utterances shorter than SEGMENT_MIN_MS, cutting ones longer than
+// SEGMENT_MAX_MS at their quietest point with SEGMENT_OVERLAP_MS repeated).
+// Each segment arrives as one contiguous buffer, with non-speech inside it
+// shortened to SEGMENT_MAX_GAP_MS; transcript word times are mapped back to
+// the capture timeline through the segment's remap table. The VAD model comes from
+// VAD_MODEL or userData/models/vad.tnsr; without one a built-in noise-floor
+// tracker is used. Without the module, chunks are gated on a fixed RMS
+// threshold and batched by count.
+let VoiceActivity = null;
+
+try {
+  VoiceActivity = require("../native-audio/voice-activity.js");
+  if (VoiceActivity.isAvailable()) {
+    console.log("✅ Voice activity detector loaded");
+  }
+} catch (error) {
+  console.log("⚠️ Voice activity detector not available:", error.message);
+}
+
+const RMS_THRESHOLD = 10; // Minimum int16 RMS of a chunk or file without the VAD
+const SEGMENT_MIN_MS = 1000;
+const SEGMENT_MAX_MS = 15000;
+const SEGMENT_OVERLAP_MS = 300;
+const SEGMENT_MAX_GAP_MS = 300;
+const SEGMENT_TIMELINES_MAX = 256;
+const segmentTimelines = new Map(); // "source:fileIndex" -> segment ms => capture ms
+let speakerSegmenter = null;
+let microphoneSegmenter = null; // false: unavailable for this session
+// Recent chunks held back from the spool while no segment is in progress
+let speakerSpoolHeld = [];
+let microphoneSpoolHeld = [];
+let speakerSegmentIndex = 0;
+let microphoneSegmentIndex = 0;
+
+// Crash-safe capture spools (memory-mapped ring files in userData/spool).
+// Voiced audio is mirrored there until its segment has been sent for
+// transcription; segments left over by a crash are transcribed on next start.
+const CAPTURE_SPOOL_BYTES = 16 * 1024 * 1024;
+const captureSpools = new Map(); // spool file -> CaptureSpool (or null)
+const recoveredSpoolSources = new Set();
+let speakerSpool = null;
+// Per closed writer segment, in order: {spooled, startSample, durationSamples,
+// timeline}; the span of the one being written, or null while it is empty
+let microphoneWriterSegments = [];
+let microphoneWriterSpan = null;
+
+// Segment store (userData/segments): keeps captured segments for replay and
+// re-transcription after the temp_audio files are gone
+const SEGMENT_STORE_MAX_BYTES = 512 * 1024 * 1024;
+const SEGMENT_STORE_MAX_AGE_MS = 7 * 24 * 60 * 60 * 1000;
+const SEGMENT_STREAMS = { speaker: 0, microphone: 1 };
+let segmentStore;
+// Position on the capture timeline: samples handed to the voice logic since
+// capture start (silent ones included), and the span of the chunks batched
+// for the next file without the segmenter
+let speakerCapturedSamples = 0;
+let speakerBatchSpan = null;
+let microphoneCapturedSamples = 0;
+let microphoneBatchSpan = null;
+let microphoneSegmenterStart = 0; // capture offset of the segmenter's sample 0
+
 let mainWindow;
 let deepgramClient;
 let microphoneConnection = null;
@@ -61,9 +250,370 @@ let microphoneAudioStartTime = null;
 // We'll adjust dynamically based on actual sample rate
 const MICROPHONE_CHUNKS_PER_FILE = 20; // Will be recalculated based on actual sample rate
 
+function findLocalAsrModel() {
+  if (process.env.LOCAL_ASR_MODEL) return process.env.LOCAL_ASR_MODEL;
+  const modelDir = path.join(app.getPath("userData"), "models");
+  try {
+    const models = fs
+      .readdirSync(modelDir)
+      .filter((name) => /^ggml-.*\.bin$/.test(name))
+      .sort();
+    return models.length > 0 ? path.join(modelDir, models[0]) : null;
+  } catch (e) {
+    return null;
+  }
+}
+
+async function loadLocalRecognizer() {
+  if (LOCAL_ASR_MODE === "off" || !LocalAsr || !LocalAsr.isAvailable()) {
+    return null;
+  }
+  const modelPath = findLocalAsrModel();
+  if (!modelPath) {
+    console.log(
+      "⚠️ No local ASR model (set LOCAL_ASR_MODEL or add userData/models/ggml-*.bin)"
+    );
+    return null;
+  }
+
+  try {
+    const recognizer = new LocalAsr.LocalRecognizer({ modelPath, weights: LOCAL_ASR_WEIGHTS });
+    const info = await recognizer.load();
+    console.log(
+      `✅ Local ASR model loaded: ${path.basename(modelPath)} (${info.type}, ${
+        info.multilingual ? "multilingual" : "English-only"
+      }, ${info.weights} weights on ${info.kernels}, ${info.threads} threads)`
+    );
+    return recognizer;
+  } catch (error) {
+    console.log(`⚠️ Could not load local ASR model ${modelPath}: ${error.message}`);
+    return null;
+  }
+}
+
+function getLanguageIdentifier() {
+  if (languageIdentifier !== undefined) return languageIdentifier;
+  languageIdentifier = null;
+  if (!LocalAsr || !LocalAsr.isAvailable()) return null;
+
+  const modelPath =
+    process.env.LID_MODEL || path.join(app.getPath("userData"), "models", "lid.tnsr");
+  if (!fs.existsSync(modelPath)) return null;
+  try {
+    languageIdentifier = new LocalAsr.LanguageIdentifier({ modelPath });
+    const info = languageIdentifier.getModelInfo();
+    console.log(
+      `✅ Language identification loaded: ${path.basename(modelPath)} (${
+        info.languages.length
+      } languages)`
+    );
+  } catch (error) {
+    console.log(`⚠️ Could not load language model ${modelPath}: ${error.message}`);
+  }
+  return languageIdentifier;
+}
+
+// Utterance segmenter for one capture stream (s16le PCM at sampleRate), or null
+function createSegmenter(sampleRate) {
+  if (!VoiceActivity || !VoiceActivity.isAvailable()) return null;
+
+  const options = {
+    sampleRate,
+    minDurationMs: SEGMENT_MIN_MS,
+    maxDurationMs: SEGMENT_MAX_MS,
+    overlapMs: SEGMENT_OVERLAP_MS,
+    maxGapMs: SEGMENT_MAX_GAP_MS,
+  };
+  const modelPath =
+    process.env.VAD_MODEL || path.join(app.getPath("userData"), "models", "vad.tnsr");
+  if (sampleRate === 16000 && fs.existsSync(modelPath)) {
+    options.modelPath = modelPath;
+  }
+  try {
+    const segmenter = new VoiceActivity.UtteranceSegmenter(options);
+    console.log(
+      `✅ Utterance segmenter at ${sampleRate} Hz (${segmenter.getStats().scorer} scorer)`
+    );
+    return segmenter;
+  } catch (error) {
+    console.log(`⚠️ Could not create utterance segmenter: ${error.message}`);
+    return null;
+  }
+}
+
+// Remember how a segment's audio maps to the capture timeline
+function setSegmentTimeline(source, fileIndex, timeline) {
+  if (!timeline || fileIndex === undefined) return;
+  segmentTimelines.set(`${source}:${fileIndex}`, timeline);
+  if (segmentTimelines.size > SEGMENT_TIMELINES_MAX) {
+    segmentTimelines.delete(segmentTimelines.keys().next().value);
+  }
+}
+
+// Timeline (segment ms => capture ms) of a segment from the segmenter
+function segmentTimeline(segmenter, segment) {
+  return (ms) => segmenter.originalTimeMs(segment, ms);
+}
+
+// Deepgram word timings on the capture timeline (ms since capture start),
+// or undefined if the segment did not come from the segmenter
+function captureWordTimes(source, fileIndex, words) {
+  const key = `${source}:${fileIndex}`;
+  const timeline = segmentTimelines.get(key);
+  segmentTimelines.delete(key);
+  if (!timeline || !Array.isArray(words)) return undefined;
+  return words.map((word) => ({
+    word: word.punctuated_word || word.word,
+    startMs: Math.round(timeline(word.start * 1000)),
+    endMs: Math.round(timeline(word.end * 1000)),
+  }));
+}
+
+// Language to transcribe s16le 16kHz PCM with, or null for multilingual
+async function identifyLanguage(pcmData, label) {
+  const identifier = getLanguageIdentifier();
+  if (!identifier) return null;
+
+  try {
+    const result = await identifier.identify(pcmData);
+    const decided = result.segments.filter((segment) => segment.language);
+    const uniform = decided.every((segment) => segment.language === result.language);
+    console.log(
+      `🌐 Language of ${label}: ${result.language || "?"} (${result.confidence.toFixed(2)}, ${
+        decided.length
+      }/${result.segments.length} segments, ${result.timings.classifyMs.toFixed(1)} ms)`
+    );
+    if (!result.language || !uniform || result.confidence < LID_MIN_CONFIDENCE) {
+      return null;
+    }
+    return result.language;
+  } catch (error) {
+    console.error(`❌ Language identification failed for ${label}:`, error.message);
+    return null;
+  }
+}
+
+// Loads the model once, in the background; resolves to null if unavailable
+function getLocalRecognizer() {
+  if (!localRecognizerLoading) {
+    localRecognizerLoading = loadLocalRecognizer().then((recognizer) => (localRecognizer = recognizer));
+  }
+  return localRecognizerLoading;
+}
+
+function shouldTranscribeLocally() {
+  return (
+    LOCAL_ASR_MODE === "always" ||
+    !deepgramClient ||
+    Date.now() < remoteOfflineUntil
+  );
+}
+
+// Connection failures (not API errors) switch to local transcription for a
+// while before Deepgram is tried again
+function isNetworkError(error) {
+  return [
+    "ENOTFOUND",
+    "EAI_AGAIN",
+    "ECONNREFUSED",
+    "ECONNRESET",
+    "ETIMEDOUT",
+    "ENETUNREACH",
+    "EHOSTUNREACH",
+  ].includes(error.code);
+}
+
+// Network errors, and uploads the scheduler shed because the uplink is
+// behind, are transcribed locally instead
+function isUploadFallbackError(error) {
+  return isNetworkError(error) || error.code === "ESHED";
+}
+
+function markRemoteOffline(error) {
+  if (Date.now() >= remoteOfflineUntil) {
+    console.log(
+      `📴 Deepgram unreachable (${error.code}), transcribing locally for ${
+        REMOTE_RETRY_MS / 1000
+      }s`
+    );
+  }
+  remoteOfflineUntil = Date.now() + REMOTE_RETRY_MS;
+}
+
+// POST an audio body to Deepgram's /v1/listen and parse the JSON reply.
+// Resolves to { statusCode, data }; connection failures reject with a Node
+// socket error code either way, for isNetworkError(). priority is "live" for
+// segments just captured and "backfill" for recovered ones; the scheduler
+// rejects uploads it had to shed with code ESHED
+async function postToDeepgram(apiKey, query, contentType, body, priority = "live") {
+  if (!audioTrace) return requestDeepgram(apiKey, query, contentType, body, priority);
+  return audioTrace.span(`deepgram upload (${priority})`, () =>
+    requestDeepgram(apiKey, query, contentType, body, priority)
+  );
+}
+
+async function requestDeepgram(apiKey, query, contentType, body, priority) {
+  const headers = {
+    Authorization: `Token ${apiKey}`,
+    "Content-Type": contentType,
+  };
+
+  if (deepgramUploader) {
+    const response = await deepgramUploader.postJson({
+      url: `https://api.deepgram.com/v1/listen?${query}`,
+      headers,
+      body,
+      priority,
+    });
+    const { attempts, reused, timings, queueWaitMs, deferred } = response.upload;
+    console.log(
+      `📡 Deepgram upload (${priority}): ${body.length} bytes in ${timings.totalMs.toFixed(0)}ms (${
+        reused ? "pooled connection" : `new connection, tls ${timings.tlsMs.toFixed(0)}ms`
+      }${attempts > 1 ? `, ${attempts} attempts` : ""}${
+        queueWaitMs >= 1 ? `, queued ${queueWaitMs.toFixed(0)}ms` : ""
+      }${deferred ? ", deferred" : ""})`
+    );
+    return response;
+  }
+
+  const options = {
+    hostname: "api.deepgram.com",
+    path: `/v1/listen?${query}`,
+    method: "POST",
+    agent: deepgramAgent,
+    headers: { ...headers, "Content-Length": body.length },
+  };
+
+  return new Promise((resolve, reject) => {
+    const req = https.request(options, (res) => {
+      let data = "";
+      res.on("data", (chunk) => {
+        data += chunk;
+      });
+      res.on("end", () => {
+        try {
+          const result = JSON.parse(data);
+          resolve({ statusCode: res.statusCode, data: result });
+        } catch (e) {
+          reject(new Error(`Failed to parse response: ${e.message}`));
+        }
+      });
+    });
+
+    req.on("error", (error) => {
+      reject(error);
+    });
+
+    req.end(body);
+  });
+}
+
+// Transcribe s16le 16kHz PCM on-device and send the transcript to the
+// renderer. Resolves to false if no local model is available.
+async function transcribeLocally(pcmData, fileIndex, source, label, language = null) {
+  const recognizer = await getLocalRecognizer();
+  if (!recognizer) return false;
+
+  const tag = source === "microphone" ? "[Microphone] " : "";
+  try {
+    // English-only models reject any other language; let them run as usual
+    const routed = language && (language === "en" || recognizer.getModelInfo().multilingual);
+    const result = await recognizer.transcribe(pcmData, routed ? { language } : {});
+    console.log(
+      `🧠 ${tag}Local transcript ${fileIndex} for ${label} (${
+        result.language
+      }, rtf ${result.rtf.toFixed(2)}): "${result.text}"`
+    );
+    if (!result.text) return true;
+
+    if (mainWindow && !mainWindow.isDestroyed()) {
+      mainWindow.webContents.send("transcript", {
+        text: result.text,
+        isFinal: true,
+        source: source,
+        fileIndex: fileIndex,
+        language: result.language,
+        timestamp: Date.now(),
+      });
+    } else {
+      console.log(`❌ ${tag}Cannot send transcript: mainWindow not available`);
+    }
+  } catch (error) {
+    console.error(`❌ ${tag}Local transcription failed for ${label}:`, error.message);
+  }
+  return true;
+}
+
+// Live partial transcripts on-device while transcription is local, one
+// recognizer stream per capture source. Only partials reach the renderer:
+// final text still comes from the segments, so nothing is shown twice.
+const localStreams = { speaker: null, microphone: null };
+
+// Queue voiced s16le 16kHz PCM on the source's stream, starting it on first use
+function pushLocalStream(source, pcmData) {
+  if (!shouldTranscribeLocally()) {
+    closeLocalStream(source);
+    return;
+  }
+  if (!localRecognizer) {
+    getLocalRecognizer();
+    return;
+  }
+
+  const tag = source === "microphone" ? "[Microphone] " : "";
+  if (!localStreams[source]) {
+    try {
+      localStreams[source] = localRecognizer.createStream({}, (update) => {
+        if (update.error) {
+          console.error(`❌ ${tag}Local streaming recognition failed:`, update.error);
+          return;
+        }
+        if (!update.partial || !mainWindow || mainWindow.isDestroyed()) return;
+        mainWindow.webContents.send("transcript", {
+          text: update.partial,
+          isFinal: false,
+          source: source,
+          language: update.language,
+          timestamp: Date.now(),
+        });
+      });
+      console.log(`🧠 ${tag}Local streaming recognition started`);
+    } catch (error) {
+      console.log(`⚠️ ${tag}Could not start local streaming recognition: ${error.message}`);
+      return;
+    }
+  }
+  localStreams[source].push(pcmData);
+}
+
+function closeLocalStream(source) {
+  const stream = localStreams[source];
+  if (!stream) return;
+  localStreams[source] = null;
+  // The last update is final text, which the segments already deliver
+  stream.finish().catch((error) => {
+    console.log(`⚠️ Could not finish local stream (${source}): ${error.message}`);
+  });
+}
+
+// Box-filter s16le PCM down to 16kHz for the recognizer stream
+function downsampleTo16k(int16Data, sampleRate) {
+  if (sampleRate === 16000) return int16Data;
+  const ratio = sampleRate / 16000;
+  const out = new Int16Array(Math.floor(int16Data.length / ratio));
+  for (let i = 0; i < out.length; i++) {
+    const start = Math.floor(i * ratio);
+    const end = Math.max(start + 1, Math.floor((i + 1) * ratio));
+    let sum = 0;
+    for (let j = start; j < end; j++) sum += int16Data[j];
+    out[i] = Math.round(sum / (end - start));
+  }
+  return out;
+}
+
 // Function to transcribe audio file with Deepgram using raw PCM data (SPEAKER)
-async function transcribeMP3File(mp3FilePath, fileIndex, rawFilePath) {
-  if (!deepgramClient) {
+async function transcribeMP3File(mp3FilePath, fileIndex, rawFilePath, pcmData = null) {
+  if (!deepgramClient && LOCAL_ASR_MODE === "off") {
     console.log(
       `⚠️ Deepgram client not initialized, skipping transcription for ${path.basename(
         mp3FilePath
@@ -77,9 +627,9 @@ async function transcribeMP3File(mp3FilePath, fileIndex, rawFilePath) {
       `🎤 Transcribing audio file ${fileIndex}: ${path.basename(mp3FilePath)}`
     );
 
-    // Use raw PCM data instead of MP3 for better compatibility
-    // Read the raw PCM file (16-bit signed little-endian, 16kHz, mono)
-    const pcmBuffer = fs.readFileSync(rawFilePath);
+    // Use raw PCM data instead of MP3 for better compatibility (16-bit signed
+    // little-endian, 16kHz, mono), from memory when the caller still has it
+    const pcmBuffer = pcmData || fs.readFileSync(rawFilePath);
 
     // Check if audio buffer has actual data before sending to Deepgram
     if (pcmBuffer.length === 0) {
@@ -107,7 +657,6 @@ async function transcribeMP3File(mp3FilePath, fileIndex, rawFilePath) {
     }
 
     const rms = Math.sqrt(sumSquares / int16Array.length) || 0;
-    const RMS_THRESHOLD = 10; // Same threshold as live audio
 
     if (!hasNonZero || rms <= RMS_THRESHOLD) {
       console.log(
@@ -126,6 +675,29 @@ async function transcribeMP3File(mp3FilePath, fileIndex, rawFilePath) {
       )}, hasNonZero=${hasNonZero}, size=${pcmBuffer.length} bytes`
     );
 
+    const language = await identifyLanguage(pcmBuffer, path.basename(rawFilePath));
+
+    if (
+      shouldTranscribeLocally() &&
+      (await transcribeLocally(
+        pcmBuffer,
+        fileIndex,
+        "speaker",
+        path.basename(rawFilePath),
+        language
+      ))
+    ) {
+      return;
+    }
+    if (!deepgramClient) {
+      console.log(
+        `⚠️ Deepgram client not initialized, skipping transcription for ${path.basename(
+          mp3FilePath
+        )}`
+      );
+      return;
+    }
+
     // Get API key from the client
     const apiKey = deepgramClient.key;
     if (!apiKey) {
@@ -133,54 +705,17 @@ async function transcribeMP3File(mp3FilePath, fileIndex, rawFilePath) {
       return;
     }
 
-    // Use Deepgram REST API directly for file transcription
-    // Send raw PCM data (linear16, 16kHz, mono) which we know works
-    const FormData = require("form-data");
-    const form = new FormData();
-    form.append("file", pcmBuffer, {
-      filename: path.basename(rawFilePath) || "audio.raw",
-      contentType: "audio/raw",
-      knownLength: pcmBuffer.length,
-    });
-
-    const options = {
-      hostname: "api.deepgram.com",
-      path: "/v1/listen?model=nova-3&language=multi&smart_format=true&punctuate=true&encoding=linear16&sample_rate=16000&channels=1",
-      method: "POST",
-      headers: {
-        Authorization: `Token ${apiKey}`,
-        ...form.getHeaders(),
-      },
-    };
-
-    const response = await new Promise((resolve, reject) => {
-      const req = https.request(options, (res) => {
-        let data = "";
-        res.on("data", (chunk) => {
-          data += chunk;
-        });
-        res.on("end", () => {
-          try {
-            const result = JSON.parse(data);
-            resolve({ statusCode: res.statusCode, data: result });
-          } catch (e) {
-            reject(new Error(`Failed to parse response: ${e.message}`));
-          }
-        });
-      });
-
-      req.on("error", (error) => {
-        reject(error);
-      });
-
-      // Handle form errors
-      form.on("error", (error) => {
-        reject(error);
-      });
-
-      // Pipe the form data to the request
-      form.pipe(req);
-    });
+    // Send raw PCM (linear16, 16kHz, mono) as the request body; the encoding
+    // is given in the query string
+    const response = await postToDeepgram(
+      apiKey,
+      `model=nova-3&language=${
+        DEEPGRAM_LANGUAGES.has(language) ? language : "multi"
+      }&smart_format=true&punctuate=true&encoding=linear16&sample_rate=16000&channels=1`,
+      "audio/raw",
+      pcmBuffer,
+      fileIndex === undefined ? "backfill" : "live"
+    );
 
     if (response.statusCode !== 200) {
       console.error(
@@ -202,6 +737,11 @@ async function transcribeMP3File(mp3FilePath, fileIndex, rawFilePath) {
           isFinal: true,
           source: "speaker",
           fileIndex: fileIndex,
+          words: captureWordTimes(
+            "speaker",
+            fileIndex,
+            response.data?.results?.channels?.[0]?.alternatives?.[0]?.words
+          ),
           timestamp: Date.now(),
         };
         console.log(`📤 Sending transcript to renderer:`, transcriptData);
@@ -222,6 +762,15 @@ async function transcribeMP3File(mp3FilePath, fileIndex, rawFilePath) {
       `❌ Error transcribing ${path.basename(mp3FilePath)}:`,
       error.message
     );
+    if (isUploadFallbackError(error) && (pcmData || fs.existsSync(rawFilePath))) {
+      if (isNetworkError(error)) markRemoteOffline(error);
+      await transcribeLocally(
+        pcmData || fs.readFileSync(rawFilePath),
+        fileIndex,
+        "speaker",
+        path.basename(rawFilePath)
+      );
+    }
   }
 }
 
@@ -231,7 +780,7 @@ async function transcribeMicrophoneMP3File(
   fileIndex,
   rawFilePath
 ) {
-  if (!deepgramClient) {
+  if (!deepgramClient && LOCAL_ASR_MODE === "off") {
     console.log(
       `⚠️ [Microphone] Deepgram client not initialized, skipping transcription for ${path.basename(
         mp3FilePath
@@ -297,7 +846,6 @@ async function transcribeMicrophoneMP3File(
       }
 
       const rms = Math.sqrt(sumSquares / int16Array.length) || 0;
-      const RMS_THRESHOLD = 10; // Same threshold as live audio
 
       if (!hasNonZero || rms <= RMS_THRESHOLD) {
         console.log(
@@ -317,6 +865,28 @@ async function transcribeMicrophoneMP3File(
       );
     }
 
+    if (
+      shouldTranscribeLocally() &&
+      rawFilePath &&
+      fs.existsSync(rawFilePath) &&
+      (await transcribeLocally(
+        fs.readFileSync(rawFilePath),
+        fileIndex,
+        "microphone",
+        path.basename(rawFilePath)
+      ))
+    ) {
+      return;
+    }
+    if (!deepgramClient) {
+      console.log(
+        `⚠️ [Microphone] Deepgram client not initialized, skipping transcription for ${path.basename(
+          mp3FilePath
+        )}`
+      );
+      return;
+    }
+
     // Get API key from the client
     const apiKey = deepgramClient.key;
     if (!apiKey) {
@@ -324,44 +894,15 @@ async function transcribeMicrophoneMP3File(
       return;
     }
 
-    // Use Deepgram REST API - send MP3 directly with proper content type
-    const options = {
-      hostname: "api.deepgram.com",
-      path: `/v1/listen?model=nova-3&language=multi&smart_format=true&punctuate=true`,
-      method: "POST",
-      headers: {
-        Authorization: `Token ${apiKey}`,
-        "Content-Type": "audio/mp3",
-        "Content-Length": mp3Buffer.length,
-      },
-    };
-
     console.log(`📡 [Microphone] Sending MP3 directly to Deepgram API...`);
 
-    const response = await new Promise((resolve, reject) => {
-      const req = https.request(options, (res) => {
-        let data = "";
-        res.on("data", (chunk) => {
-          data += chunk;
-        });
-        res.on("end", () => {
-          try {
-            const result = JSON.parse(data);
-            resolve({ statusCode: res.statusCode, data: result });
-          } catch (e) {
-            reject(new Error(`Failed to parse response: ${e.message}`));
-          }
-        });
-      });
-
-      req.on("error", (error) => {
-        reject(error);
-      });
-
-      // Write MP3 buffer directly to request
-      req.write(mp3Buffer);
-      req.end();
-    });
+    const response = await postToDeepgram(
+      apiKey,
+      "model=nova-3&language=multi&smart_format=true&punctuate=true",
+      "audio/mp3",
+      mp3Buffer,
+      fileIndex === undefined ? "backfill" : "live"
+    );
 
     console.log(
       `📥 [Microphone] Deepgram response status: ${response.statusCode}`
@@ -406,6 +947,7 @@ async function transcribeMicrophoneMP3File(
           isFinal: true,
           source: "microphone",
           fileIndex: fileIndex,
+          words: captureWordTimes("microphone", fileIndex, words),
           timestamp: Date.now(),
         };
         console.log(
@@ -440,6 +982,286 @@ async function transcribeMicrophoneMP3File(
       error.message,
       error.stack
     );
+    if (isUploadFallbackError(error) && rawFilePath && fs.existsSync(rawFilePath)) {
+      if (isNetworkError(error)) markRemoteOffline(error);
+      await transcribeLocally(
+        fs.readFileSync(rawFilePath),
+        fileIndex,
+        "microphone",
+        path.basename(rawFilePath)
+      );
+    }
+  }
+}
+
+// Function to transcribe an Ogg/Opus segment with Deepgram (SPEAKER and MICROPHONE)
+// opusData is the encoded segment, label names it in logs; pcmData is its
+// s16le 16kHz source, used for silence validation
+async function transcribeOpusFile(opusData, label, fileIndex, pcmData, source) {
+  const tag = source === "microphone" ? "[Microphone] " : "";
+
+  if (!deepgramClient && LOCAL_ASR_MODE === "off") {
+    console.log(
+      `⚠️ ${tag}Deepgram client not initialized, skipping transcription for ${label}`
+    );
+    return;
+  }
+
+  // Speaker segments go to Deepgram in their own language when it is known
+  let language = null;
+  try {
+    const int16Array = new Int16Array(
+      pcmData.buffer,
+      pcmData.byteOffset,
+      Math.floor(pcmData.length / 2)
+    );
+    let hasNonZero = false;
+    let sumSquares = 0;
+
+    for (let i = 0; i < int16Array.length; i++) {
+      const sample = int16Array[i];
+      if (sample !== 0) hasNonZero = true;
+      sumSquares += sample * sample;
+    }
+
+    const rms = Math.sqrt(sumSquares / int16Array.length) || 0;
+
+    if (!hasNonZero || rms <= RMS_THRESHOLD) {
+      console.log(
+        `⏭️ ${tag}Skipping transcription: ${label} contains only silence (rms=${rms.toFixed(
+          2
+        )}, hasNonZero=${hasNonZero})`
+      );
+      return;
+    }
+
+    if (source === "speaker") {
+      language = await identifyLanguage(pcmData, label);
+    }
+
+    if (
+      shouldTranscribeLocally() &&
+      (await transcribeLocally(
+        pcmData,
+        fileIndex,
+        source,
+        label,
+        language
+      ))
+    ) {
+      return;
+    }
+    if (!deepgramClient) {
+      console.log(
+        `⚠️ ${tag}Deepgram client not initialized, skipping transcription for ${label}`
+      );
+      return;
+    }
+
+    const apiKey = deepgramClient.key;
+    if (!apiKey) {
+      console.error(`❌ ${tag}Deepgram API key not found`);
+      return;
+    }
+
+    console.log(
+      `🎤 ${tag}Transcribing Opus file ${fileIndex}: ${label} (${opusData.length} bytes, ${(
+        (opusData.length / pcmData.length) *
+        100
+      ).toFixed(1)}% of PCM)`
+    );
+
+    // Deepgram detects Ogg/Opus from the container, no encoding params needed
+    const response = await postToDeepgram(
+      apiKey,
+      `model=nova-3&language=${
+        DEEPGRAM_LANGUAGES.has(language) ? language : "multi"
+      }&smart_format=true&punctuate=true`,
+      "audio/ogg",
+      opusData,
+      fileIndex === undefined ? "backfill" : "live"
+    );
+
+    if (response.statusCode !== 200) {
+      console.error(
+        `❌ ${tag}Deepgram API error (${response.statusCode}):`,
+        response.data
+      );
+      return;
+    }
+
+    const transcript =
+      response.data?.results?.channels?.[0]?.alternatives?.[0]?.transcript;
+    if (transcript) {
+      console.log(`💬 ${tag}Transcript ${fileIndex}: "${transcript}"`);
+
+      if (mainWindow && !mainWindow.isDestroyed()) {
+        mainWindow.webContents.send("transcript", {
+          text: transcript,
+          isFinal: true,
+          source: source,
+          fileIndex: fileIndex,
+          words: captureWordTimes(
+            source,
+            fileIndex,
+            response.data?.results?.channels?.[0]?.alternatives?.[0]?.words
+          ),
+          timestamp: Date.now(),
+        });
+      } else {
+        console.log(`❌ ${tag}Cannot send transcript: mainWindow not available`);
+      }
+    } else {
+      console.log(
+        `⚠️ ${tag}No transcript found in Deepgram result for ${label}`
+      );
+    }
+  } catch (error) {
+    console.error(
+      `❌ ${tag}Error transcribing ${label}:`,
+      error.message
+    );
+    if (isUploadFallbackError(error)) {
+      if (isNetworkError(error)) markRemoteOffline(error);
+      await transcribeLocally(
+        pcmData,
+        fileIndex,
+        source,
+        label,
+        language
+      );
+    }
+  }
+}
+
+// Encode a s16le 16kHz segment to Ogg/Opus in-process and transcribe it;
+// the encoded segment stays in memory
+function encodeOpusAndTranscribe(encoder, pcmData, baseName, fileIndex, source) {
+  const label = `${baseName}.opus`;
+  const opusData = encoder.encodeSegment(pcmData);
+
+  console.log(
+    `💾 ${source === "microphone" ? "[Microphone] " : ""}Encoded Opus: ${label} (${(pcmData.length / 32000).toFixed(2)}s, ${opusData.length} bytes)`
+  );
+
+  return transcribeOpusFile(opusData, label, fileIndex, pcmData, source);
+}
+
+// Mirror a chunk the segmenter has processed to the spool while a segment
+// is in progress or ends in it (active). A segment's start is dated back
+// before the chunk that began it (pre-roll and minimum speech), so idle
+// chunks are held back, up to SPOOL_LOOKBACK_MS, and spooled once one
+// begins; the onset is then recovered with the rest after a crash.
+const SPOOL_LOOKBACK_MS = 1000;
+
+function spoolSegmenterChunk(spool, held, buffer, active, sampleRate) {
+  if (!spool) return;
+  if (active) {
+    for (const chunk of held) spool.append(chunk);
+    held.length = 0;
+    spool.append(buffer);
+    return;
+  }
+  held.push(buffer);
+  const maxBytes = (sampleRate * 2 * SPOOL_LOOKBACK_MS) / 1000;
+  let bytes = held.reduce((sum, chunk) => sum + chunk.length, 0);
+  while (held.length > 1 && bytes - held[0].length >= maxBytes) {
+    bytes -= held.shift().length;
+  }
+}
+
+// Open (once) the spool for a source and sample rate; the first open per
+// source also recovers whatever a previous run left behind
+function getCaptureSpool(source, sampleRate) {
+  if (!AudioStorage || !AudioStorage.isAvailable()) return null;
+
+  const spoolDir = path.join(app.getPath("userData"), "spool");
+  const spoolFile = path.join(spoolDir, `${source}_${sampleRate}.spool`);
+  if (captureSpools.has(spoolFile)) {
+    return captureSpools.get(spoolFile);
+  }
+
+  let spool = null;
+  try {
+    fs.mkdirSync(spoolDir, { recursive: true });
+    if (!recoveredSpoolSources.has(source)) {
+      recoveredSpoolSources.add(source);
+      recoverCaptureSpools(spoolDir, source);
+    }
+    spool = new AudioStorage.CaptureSpool({
+      path: spoolFile,
+      sampleRate,
+      channels: 1,
+      capacityBytes: CAPTURE_SPOOL_BYTES,
+    });
+  } catch (error) {
+    console.log(`⚠️ Capture spool not available for ${source}: ${error.message}`);
+  }
+  captureSpools.set(spoolFile, spool);
+  return spool;
+}
+
+// Transcribe segments that were captured but never sent, then start clean
+function recoverCaptureSpools(spoolDir, source) {
+  for (const name of fs.readdirSync(spoolDir)) {
+    if (!name.startsWith(`${source}_`) || !name.endsWith(".spool")) continue;
+
+    const spoolFile = path.join(spoolDir, name);
+    const spool = new AudioStorage.CaptureSpool({ path: spoolFile });
+    const { sampleRate } = spool.getStats();
+
+    for (const segment of spool.pendingSegments()) {
+      const pcmData = spool.readSegment(segment.id);
+      if (!pcmData || pcmData.length === 0) continue;
+
+      console.log(
+        `♻️ Recovered ${source} segment ${segment.id} (${(
+          segment.durationMs / 1000
+        ).toFixed(2)}s) from a previous session`
+      );
+      // No fileIndex: recovered transcripts are shown as they arrive
+      if (source === "speaker") {
+        saveSpeakerAudioAsMP3(pcmData, undefined, () => {});
+      } else {
+        saveRecoveredMicrophoneAudio(pcmData, sampleRate);
+      }
+    }
+
+    spool.close();
+    fs.unlinkSync(spoolFile);
+  }
+}
+
+function getSegmentStore() {
+  if (segmentStore !== undefined) return segmentStore;
+  segmentStore = null;
+  if (!AudioStorage || !AudioStorage.isAvailable()) return null;
+
+  try {
+    segmentStore = new AudioStorage.SegmentStore({
+      directory: path.join(app.getPath("userData"), "segments"),
+      maxBytes: SEGMENT_STORE_MAX_BYTES,
+      maxAgeMs: SEGMENT_STORE_MAX_AGE_MS,
+    });
+  } catch (error) {
+    console.log(`⚠️ Segment store not available: ${error.message}`);
+  }
+  return segmentStore;
+}
+
+function storeSegment(meta, data) {
+  const store = getSegmentStore();
+  if (!store) return;
+  try {
+    store.append(meta, data);
+  } catch (error) {
+    console.log(`⚠️ Could not store segment: ${error.message}`);
+  }
+}
+
+function ackSpoolSegment(spool, segment) {
+  if (spool && segment !== null && segment !== undefined) {
+    spool.ack(segment);
   }
 }
 
@@ -447,6 +1269,52 @@ async function transcribeMicrophoneMP3File(
 function saveAudioChunksAsMP3() {
   if (audioChunks.length === 0) return;
 
+  const rawData = Buffer.concat(audioChunks);
+  const span = speakerBatchSpan;
+
+  // Clear chunks for next file
+  audioChunks = [];
+  speakerBatchSpan = null;
+
+  saveSpeakerSegment(rawData, span.startSample, undefined, span.endSample - span.startSample);
+}
+
+// Extend a batch's span on the capture timeline by one chunk
+function extendSpan(span, startSample, samples) {
+  if (!span) return { startSample, endSample: startSample + samples };
+  span.endSample = startSample + samples;
+  return span;
+}
+
+// Store one speaker segment (16kHz s16le, starting at startSample of the
+// capture and covering durationSamples of it, silence skipped or compacted
+// inside included), close its spool segment and transcribe it. timeline maps
+// segment ms to capture ms when silence inside it was compacted.
+function saveSpeakerSegment(rawData, startSample, timeline, durationSamples = rawData.length / 2) {
+  // Track file index for sequential display (start at 0)
+  const fileIndex = speakerSegmentIndex++;
+  setSegmentTimeline("speaker", fileIndex, timeline);
+
+  storeSegment(
+    {
+      session: audioStartTime,
+      stream: SEGMENT_STREAMS.speaker,
+      startSample,
+      durationSamples,
+      sampleRate: 16000,
+      codec: "pcm16",
+    },
+    rawData
+  );
+
+  const spoolSegment = speakerSpool ? speakerSpool.endSegment() : null;
+  saveSpeakerAudioAsMP3(rawData, fileIndex, () =>
+    ackSpoolSegment(speakerSpool, spoolSegment)
+  );
+}
+
+// Encode speaker PCM (16kHz int16), transcribe it and call onDone once sent
+function saveSpeakerAudioAsMP3(rawData, fileIndex, onDone) {
   const timestamp = Date.now();
   const uniqueId = `${timestamp}_${Math.random().toString(36).substr(2, 9)}`;
   const rawFilePath = path.join(
@@ -462,13 +1330,19 @@ function saveAudioChunksAsMP3() {
     `speaker_audio_${uniqueId}.mp3`
   );
 
-  // Track file index for sequential display (start at 0)
-  const fileIndex = Math.floor(
-    (audioChunkCount - audioChunks.length) / SPEAKER_CHUNKS_PER_FILE
-  );
+  // Encode in-process when the Opus encoder is available (no ffmpeg fork)
+  if (speakerOpusEncoder) {
+    encodeOpusAndTranscribe(
+      speakerOpusEncoder,
+      rawData,
+      `speaker_audio_${uniqueId}`,
+      fileIndex,
+      "speaker"
+    ).then(onDone);
+    return;
+  }
 
   // Save raw PCM data
-  const rawData = Buffer.concat(audioChunks);
   fs.writeFileSync(rawFilePath, rawData);
 
   // Convert to MP3 using ffmpeg (if available)
@@ -486,13 +1360,14 @@ function saveAudioChunksAsMP3() {
     } else {
       // MP3 conversion successful
       console.log(
-        `💾 Saved MP3: ${path.basename(mp3FilePath)} (${
-          audioChunks.length
-        } chunks, ${(rawData.length / 32000).toFixed(2)}s)`
+        `💾 Saved MP3: ${path.basename(mp3FilePath)} (${(
+          rawData.length / 32000
+        ).toFixed(2)}s)`
       );
 
       // Transcribe using raw PCM data (before deleting it)
-      await transcribeMP3File(mp3FilePath, fileIndex, rawFilePath);
+      await transcribeMP3File(mp3FilePath, fileIndex, rawFilePath, rawData);
+      onDone();
 
       // Delete raw file after transcription
       try {
@@ -513,15 +1388,181 @@ function saveAudioChunksAsMP3() {
       }
     }
   });
+}
 
-  // Clear chunks for next file
-  audioChunks = [];
+// Create the microphone segment writer for the current sample rate
+function getMicrophoneSegmentWriter() {
+  if (!AudioStorage || !AudioStorage.isAvailable()) return null;
+
+  const sampleRate = microphoneSampleRate;
+  if (
+    microphoneSegmentWriter &&
+    microphoneSegmentWriter.options.sampleRate !== sampleRate
+  ) {
+    // Sample rate changed mid-session: finish the old writer, start a new one
+    endMicrophoneSegment(microphoneSegmentWriter);
+    microphoneSegmentWriter.close();
+    microphoneSegmentWriter = null;
+  }
+
+  if (!microphoneSegmentWriter) {
+    microphoneSegmentWriter = new AudioStorage.SegmentWriter({
+      directory: path.join(__dirname, "..", "temp_audio"),
+      prefix: "microphone_audio",
+      format: "wav",
+      sampleRate,
+      channels: 1,
+      fsync: "none",
+      onSegment: handleMicrophoneSegment,
+      onError: (message) => {
+        // Leave the spooled audio unacknowledged so it is recovered next run
+        microphoneWriterSegments.shift();
+        console.error(`❌ [Microphone] Segment writer error: ${message}`);
+      },
+    });
+  }
+  return microphoneSegmentWriter;
+}
+
+// Append voiced microphone audio, from startSample of the capture, to the
+// segment writer and its spool (unless it was already mirrored there while
+// its segment was in progress)
+function appendMicrophoneAudio(writer, buffer, startSample, spooled = false) {
+  const spool = getCaptureSpool("microphone", writer.options.sampleRate);
+  if (spool && !spooled) {
+    spool.append(buffer);
+  }
+  writer.append(buffer);
+  microphoneWriterSpan = extendSpan(microphoneWriterSpan, startSample, buffer.length / 2);
+}
+
+// Write finished utterance segments: one WAV segment each with the segment
+// writer, otherwise the raw/ffmpeg path
+function saveMicrophoneSegments(segmenter, segments) {
+  for (const segment of segments) {
+    const timeline = segmentTimeline(segmenter, segment);
+    const startSample = microphoneSegmenterStart + segment.startSample;
+    // With silence compacted the PCM is shorter than the span it covers
+    const durationSamples = segment.endSample - segment.startSample;
+    const writer = getMicrophoneSegmentWriter();
+    if (writer) {
+      appendMicrophoneAudio(writer, segment.pcm, startSample, true);
+      microphoneWriterSpan.endSample = startSample + durationSamples;
+      endMicrophoneSegment(writer, timeline);
+    } else {
+      saveMicrophoneAudioAsMP3(segment.pcm, startSample, timeline, durationSamples);
+    }
+  }
+}
+
+// Rotate the writer; remember which spool segment the closed file holds
+// and where it lies on the capture timeline
+function endMicrophoneSegment(writer, timeline) {
+  const span = microphoneWriterSpan;
+  if (!span) return;
+  microphoneWriterSpan = null;
+
+  const spool = getCaptureSpool("microphone", writer.options.sampleRate);
+  microphoneWriterSegments.push({
+    spooled: spool ? { spool, segment: spool.endSegment() } : null,
+    startSample: span.startSample,
+    durationSamples: span.endSample - span.startSample,
+    timeline,
+  });
+  writer.rotate();
+}
+
+// Called once the writer has closed a WAV segment on disk
+function handleMicrophoneSegment(info) {
+  const written = microphoneWriterSegments.shift() || {};
+  const spooled = written.spooled;
+  setSegmentTimeline("microphone", info.index, written.timeline);
+  if (info.frames === 0) {
+    try {
+      fs.unlinkSync(info.path);
+    } catch (e) {}
+    return;
+  }
+
+  const uniqueId = path.basename(info.path, path.extname(info.path));
+  const tempDir = path.dirname(info.path);
+
+  console.log(
+    `💾 [Microphone] Wrote WAV segment: ${path.basename(info.path)} (${
+      info.bytes
+    } bytes, ${(info.durationMs / 1000).toFixed(2)}s)`
+  );
+
+  // Read off the main thread; transcription (which deletes the file) waits
+  // for the copy into the store
+  const session = microphoneAudioStartTime;
+  fs.promises
+    .readFile(info.path)
+    .then((data) =>
+      storeSegment(
+        {
+          session,
+          stream: SEGMENT_STREAMS.microphone,
+          startSample: written.startSample !== undefined ? written.startSample : info.startFrame,
+          durationSamples:
+            written.durationSamples !== undefined ? written.durationSamples : info.frames,
+          sampleRate: info.sampleRate,
+          codec: "wav",
+        },
+        data
+      )
+    )
+    .catch((error) => console.log(`⚠️ Could not store segment: ${error.message}`))
+    .then(() =>
+      resampleAndTranscribeMicrophoneAudio(
+        info.path,
+        "-f wav",
+        path.join(tempDir, `${uniqueId}.raw`),
+        path.join(tempDir, `${uniqueId}.mp3`),
+        uniqueId,
+        info.index,
+        () => spooled && ackSpoolSegment(spooled.spool, spooled.segment)
+      )
+    );
+}
+
+// Feed recovered microphone PCM through the normal resample/transcribe path
+function saveRecoveredMicrophoneAudio(pcmData, sampleRate) {
+  const uniqueId = `recovered_${Date.now()}_${Math.random()
+    .toString(36)
+    .substr(2, 9)}`;
+  const tempDir = path.join(__dirname, "..", "temp_audio");
+  const rawFilePath48k = path.join(tempDir, `microphone_audio_${uniqueId}_48k.raw`);
+  fs.writeFileSync(rawFilePath48k, pcmData);
+
+  resampleAndTranscribeMicrophoneAudio(
+    rawFilePath48k,
+    `-f s16le -ar ${sampleRate} -ac 1`,
+    path.join(tempDir, `microphone_audio_${uniqueId}.raw`),
+    path.join(tempDir, `microphone_audio_${uniqueId}.mp3`),
+    uniqueId,
+    undefined,
+    () => {}
+  );
 }
 
 // Function to save audio chunks as MP3 (MICROPHONE)
 function saveMicrophoneAudioChunksAsMP3() {
   if (microphoneAudioChunks.length === 0) return;
 
+  const rawData = Buffer.concat(microphoneAudioChunks);
+  const span = microphoneBatchSpan;
+  microphoneAudioChunks = [];
+  microphoneBatchSpan = null;
+
+  saveMicrophoneAudioAsMP3(rawData, span.startSample, undefined, span.endSample - span.startSample);
+}
+
+// Save one microphone segment (s16le at microphoneSampleRate, starting at
+// startSample of the capture and covering durationSamples of it) and
+// transcribe it. timeline maps segment ms to capture ms when silence inside
+// it was compacted.
+function saveMicrophoneAudioAsMP3(rawData, startSample, timeline, durationSamples = rawData.length / 2) {
   const timestamp = Date.now();
   const uniqueId = `${timestamp}_${Math.random().toString(36).substr(2, 9)}`;
   const rawFilePath48k = path.join(
@@ -544,27 +1585,57 @@ function saveMicrophoneAudioChunksAsMP3() {
   );
 
   // Track file index for sequential display (start at 0)
-  const fileIndex = Math.floor(
-    (microphoneAudioChunkCount - microphoneAudioChunks.length) /
-      MICROPHONE_CHUNKS_PER_FILE
-  );
+  const fileIndex = microphoneSegmentIndex++;
+  setSegmentTimeline("microphone", fileIndex, timeline);
 
   // Save raw PCM data at original sample rate (48kHz)
-  const rawData = Buffer.concat(microphoneAudioChunks);
-  const chunkCount = microphoneAudioChunks.length; // Store before clearing
   fs.writeFileSync(rawFilePath48k, rawData);
 
+  storeSegment(
+    {
+      session: microphoneAudioStartTime,
+      stream: SEGMENT_STREAMS.microphone,
+      startSample,
+      durationSamples,
+      sampleRate: microphoneSampleRate,
+      codec: "pcm16",
+    },
+    rawData
+  );
+
   console.log(
     `💾 [Microphone] Saved 48kHz RAW: ${path.basename(
       rawFilePath48k
-    )} (${chunkCount} chunks, ${(
+    )} (${(
       rawData.length /
       (microphoneSampleRate * 2)
     ).toFixed(2)}s)`
   );
 
+  resampleAndTranscribeMicrophoneAudio(
+    rawFilePath48k,
+    `-f s16le -ar ${microphoneSampleRate} -ac 1`,
+    rawFilePath,
+    mp3FilePath,
+    uniqueId,
+    fileIndex,
+    () => {}
+  );
+}
+
+// Resample a captured microphone file (raw s16le or WAV) to 16kHz, normalize and transcribe.
+// onDone runs once the segment has been sent for transcription.
+function resampleAndTranscribeMicrophoneAudio(
+  rawFilePath48k,
+  inputFormatArgs,
+  rawFilePath,
+  mp3FilePath,
+  uniqueId,
+  fileIndex,
+  onDone
+) {
   // Resample from 48kHz to 16kHz using ffmpeg
-  const resampleCmd = `ffmpeg -f s16le -ar ${microphoneSampleRate} -ac 1 -i "${rawFilePath48k}" -f s16le -ar 16000 -ac 1 "${rawFilePath}" -y`;
+  const resampleCmd = `ffmpeg ${inputFormatArgs} -i "${rawFilePath48k}" -f s16le -ar 16000 -ac 1 "${rawFilePath}" -y`;
 
   exec(resampleCmd, async (error, stdout, stderr) => {
     if (error) {
@@ -605,7 +1676,8 @@ function saveMicrophoneAudioChunksAsMP3() {
           rawFilePath,
           mp3FilePath,
           fileIndex,
-          rawFilePath48k
+          rawFilePath48k,
+          onDone
         );
       } else {
         // Check normalized audio levels
@@ -623,7 +1695,8 @@ function saveMicrophoneAudioChunksAsMP3() {
           rawFilePath,
           mp3FilePath,
           fileIndex,
-          rawFilePath48k
+          rawFilePath48k,
+          onDone
         );
       }
     });
@@ -635,8 +1708,35 @@ const convertToMP3AndTranscribe = async (
   rawFilePath,
   mp3FilePath,
   fileIndex,
-  rawFilePath48k
+  rawFilePath48k,
+  onDone
 ) => {
+  // Encode in-process when the Opus encoder is available (no ffmpeg fork)
+  if (microphoneOpusEncoder) {
+    const pcmData = fs.readFileSync(rawFilePath);
+    await encodeOpusAndTranscribe(
+      microphoneOpusEncoder,
+      pcmData,
+      path.basename(rawFilePath, ".raw"),
+      fileIndex,
+      "microphone"
+    );
+    onDone();
+
+    for (const tempFile of [rawFilePath48k, rawFilePath]) {
+      try {
+        fs.unlinkSync(tempFile);
+      } catch (e) {
+        console.log(
+          `⚠️ [Microphone] Could not delete temp file: ${path.basename(
+            tempFile
+          )}`
+        );
+      }
+    }
+    return;
+  }
+
   // Convert 16kHz raw to MP3 using ffmpeg
   const ffmpegCmd = `ffmpeg -f s16le -ar 16000 -ac 1 -i "${rawFilePath}" -codec:a libmp3lame -b:a 128k "${mp3FilePath}" -y`;
 
@@ -667,6 +1767,7 @@ const convertToMP3AndTranscribe = async (
 
       // Transcribe using 16kHz RAW PCM file
       await transcribeMicrophoneMP3File(mp3FilePath, fileIndex, rawFilePath);
+      onDone();
 
       // Delete temp 48kHz file
       try {
@@ -702,9 +1803,6 @@ const convertToMP3AndTranscribe = async (
       }
     }
   });
-
-  // Clear chunks for next file
-  microphoneAudioChunks = [];
 };
 
 // Initialize Deepgram client
@@ -897,7 +1995,12 @@ ipcMain.handle("start-microphone-capture", async (event, apiKey) => {
     // Initialize microphone audio saving
     microphoneAudioChunks = [];
     microphoneAudioChunkCount = 0;
+    microphoneSegmentIndex = 0;
+    microphoneSegmenter = null;
+    microphoneSpoolHeld = [];
     microphoneAudioStartTime = Date.now();
+    microphoneCapturedSamples = 0;
+    microphoneBatchSpan = null;
     console.log(
       `💾 [Microphone] Will save audio as MP3 files with unique names`
     );
@@ -941,13 +2044,11 @@ ipcMain.handle("start-speaker-capture", async (event, apiKey) => {
             "⚠️ Cleaning up existing native audio capture instance..."
           );
           try {
-            nativeAudioCapture.stop();
+            await nativeAudioCapture.stop();
           } catch (e) {
             console.log("⚠️ Error stopping existing instance:", e.message);
           }
           nativeAudioCapture = null;
-          // Small delay to ensure cleanup
-          await new Promise((resolve) => setTimeout(resolve, 100));
         }
 
         let audioSampleCount = 0;
@@ -955,11 +2056,17 @@ ipcMain.handle("start-speaker-capture", async (event, apiKey) => {
         // Initialize audio saving
         audioChunks = [];
         audioChunkCount = 0;
+        speakerSegmentIndex = 0;
+        speakerSegmenter = createSegmenter(16000);
+        speakerSpoolHeld = [];
         audioStartTime = Date.now();
+        speakerCapturedSamples = 0;
+        speakerBatchSpan = null;
+        speakerSpool = getCaptureSpool("speaker", 16000);
         console.log(`💾 Will save audio as MP3 files with unique names`);
 
         console.log("🎙️ Creating new native audio capture instance...");
-        nativeAudioCapture = new NativeAudioCapture((audioBuffer) => {
+        nativeAudioCapture = new NativeAudioCapture(traced("speaker chunk handler", (audioBuffer) => {
           // audioBuffer is a Node Buffer of float32 PCM from native
           // Reinterpret bytes as Float32Array without copying per-element
           const byteOffset = audioBuffer.byteOffset || 0;
@@ -998,66 +2105,96 @@ ipcMain.handle("start-speaker-capture", async (event, apiKey) => {
             audioSampleCount++;
           }
 
-          // Send to Deepgram
-          if (speakerConnection && speakerReady) {
-            const buffer = Buffer.from(
-              int16Data.buffer,
-              int16Data.byteOffset,
-              int16Data.byteLength
+          // Segmenting, spooling and saving do not wait for Deepgram: with the
+          // network down the segments are still stored and transcribed locally
+          const buffer = Buffer.from(
+            int16Data.buffer,
+            int16Data.byteOffset,
+            int16Data.byteLength
+          );
+          const chunkStart = speakerCapturedSamples;
+          speakerCapturedSamples += int16Data.length;
+
+          let voiced;
+          if (speakerSegmenter) {
+            // Cut segments at speech pauses; live audio is sent while speaking.
+            // Spooled before the segments it ends are closed in the spool.
+            const result = speakerSegmenter.process(buffer);
+            spoolSegmenterChunk(
+              speakerSpool,
+              speakerSpoolHeld,
+              buffer,
+              result.pending || result.segments.length > 0,
+              16000
             );
-
-            // Check if audio has actual data before saving or sending
+            for (const segment of result.segments) {
+              saveSpeakerSegment(
+                segment.pcm,
+                segment.startSample,
+                segmentTimeline(speakerSegmenter, segment),
+                segment.endSample - segment.startSample
+              );
+            }
+            voiced = result.speaking;
+          } else {
             // Only process if there are non-zero samples and RMS is above threshold
-            const RMS_THRESHOLD = 10; // Minimum RMS to consider as actual audio
-            const hasAudioData = hasNonZero && rms > RMS_THRESHOLD;
-
-            if (hasAudioData) {
+            voiced = hasNonZero && rms > RMS_THRESHOLD;
+            if (voiced) {
               // Save chunk to array only if it has audio data
               audioChunks.push(buffer);
+              speakerBatchSpan = extendSpan(speakerBatchSpan, chunkStart, int16Data.length);
               audioChunkCount++;
+              if (speakerSpool) {
+                speakerSpool.append(buffer);
+              }
 
               // Save as MP3 file every N chunks
               if (audioChunkCount % SPEAKER_CHUNKS_PER_FILE === 0) {
                 saveAudioChunksAsMP3();
               }
+            }
+          }
 
-              // Send to live Deepgram connection
-              try {
-                speakerConnection.send(buffer);
-                speakerSendCount++;
-                if (speakerSendCount <= 5) {
-                  console.log(
-                    `📤 Sent audio chunk ${speakerSendCount}, size=${
-                      buffer.length
-                    } bytes, rms≈${rms.toFixed(2)}`
-                  );
-                }
-              } catch (error) {
-                console.error("❌ Error sending to Deepgram:", error);
-              }
-            } else {
-              // Log occasionally to show we're skipping empty/silent audio
-              if (audioSampleCount % 100 === 0) {
+          // Live partials on-device while transcription is local
+          if (voiced) {
+            pushLocalStream("speaker", int16Data);
+          }
+
+          // Send to the live Deepgram connection
+          if (!speakerConnection || !speakerReady) {
+            if (audioSampleCount === 1) {
+              console.log("⚠️ Speaker connection not ready or not open yet");
+            }
+          } else if (voiced) {
+            try {
+              speakerConnection.send(buffer);
+              speakerSendCount++;
+              if (speakerSendCount <= 5) {
                 console.log(
-                  `⏭️ Skipping empty/silent audio (rms=${rms.toFixed(
-                    2
-                  )}, hasNonZero=${hasNonZero}) - not saving or sending`
+                  `📤 Sent audio chunk ${speakerSendCount}, size=${
+                    buffer.length
+                  } bytes, rms≈${rms.toFixed(2)}`
                 );
               }
+            } catch (error) {
+              console.error("❌ Error sending to Deepgram:", error);
             }
-          } else {
-            if (audioSampleCount === 1) {
-              console.log("⚠️ Speaker connection not ready or not open yet");
-            }
+          } else if (audioSampleCount % 100 === 0) {
+            // Log occasionally to show we're skipping empty/silent audio
+            console.log(
+              `⏭️ Skipping silent audio (rms=${rms.toFixed(
+                2
+              )}, hasNonZero=${hasNonZero}) - not sending`
+            );
           }
-        });
+        }));
 
-        const result = nativeAudioCapture.start();
+        const result = await nativeAudioCapture.start();
         if (result.success) {
           console.log("✅ Native macOS audio capture started");
           mainWindow.webContents.send("native-audio-started", true);
         } else {
-          console.log("⚠️ Native audio capture failed");
+          console.log("⚠️ Native audio capture failed:", result.error);
           mainWindow.webContents.send(
             "speaker-error",
             "Native audio capture failed. Please check Screen Recording permissions in System Preferences."
@@ -1076,6 +2213,22 @@ ipcMain.handle("start-speaker-capture", async (event, apiKey) => {
 });
 
 ipcMain.handle("stop-microphone-capture", async () => {
+  // Save the utterance in progress before the writer closes
+  if (microphoneSegmenter) {
+    saveMicrophoneSegments(microphoneSegmenter, microphoneSegmenter.flush().segments);
+  }
+  microphoneSegmenter = null;
+  microphoneSpoolHeld = [];
+  closeLocalStream("microphone");
+
+  // Close the segment writer; its final segment is reported through onSegment
+  if (microphoneSegmentWriter) {
+    const writer = microphoneSegmentWriter;
+    microphoneSegmentWriter = null;
+    endMicrophoneSegment(writer);
+    await writer.close();
+  }
+
   // Save any remaining microphone audio chunks
   if (microphoneAudioChunks.length > 0) {
     const finalFileIndex = Math.floor(
@@ -1107,7 +2260,8 @@ ipcMain.handle("stop-speaker-capture", async () => {
   // Stop native audio capture if running
   if (nativeAudioCapture) {
     try {
-      const stopResult = nativeAudioCapture.stop();
+      // Resolves after the last captured buffer has reached the callback
+      const stopResult = await nativeAudioCapture.stop();
       console.log("✅ Native audio capture stopped:", stopResult);
     } catch (error) {
       console.error("❌ Error stopping native audio capture:", error.message);
@@ -1115,10 +2269,25 @@ ipcMain.handle("stop-speaker-capture", async () => {
 
     // Clear the reference to allow proper cleanup
     nativeAudioCapture = null;
+  }
 
-    // Give a small delay to ensure native cleanup is complete
-    await new Promise((resolve) => setTimeout(resolve, 200));
+  // Save the utterance in progress
+  if (speakerSegmenter) {
+    for (const segment of speakerSegmenter.flush().segments) {
+      saveSpeakerSegment(
+        segment.pcm,
+        segment.startSample,
+        segmentTimeline(speakerSegmenter, segment),
+        segment.endSample - segment.startSample
+      );
+      console.log(
+        `💾 Saved final segment (${((segment.endMs - segment.startMs) / 1000).toFixed(2)}s)`
+      );
+    }
+    speakerSegmenter = null;
+    speakerSpoolHeld = [];
   }
+  closeLocalStream("speaker");
 
   // Save any remaining audio chunks
   if (audioChunks.length > 0) {
@@ -1161,6 +2330,16 @@ ipcMain.handle(
         // Update sample rate if provided
         if (sampleRate && sampleRate !== microphoneSampleRate) {
           console.log(`📊 [Microphone] Sample rate detected: ${sampleRate} Hz`);
+          // Finish the segment in progress at the old rate
+          if (microphoneSegmenter) {
+            saveMicrophoneSegments(microphoneSegmenter, microphoneSegmenter.flush().segments);
+            microphoneSegmenter = null;
+            microphoneSpoolHeld = [];
+          }
+          // Keep the capture position, in samples at the new rate
+          microphoneCapturedSamples = Math.round(
+            (microphoneCapturedSamples * sampleRate) / microphoneSampleRate
+          );
           microphoneSampleRate = sampleRate;
         }
 
@@ -1187,14 +2366,44 @@ ipcMain.handle(
         const avg = sum / int16View.length;
         const rms = Math.sqrt(sumSquares / int16View.length);
         const hasNonZero = nonZeroCount > 0;
+        const chunkStart = microphoneCapturedSamples;
+        microphoneCapturedSamples += int16View.length;
 
-        // Check if audio has actual data before saving
-        const RMS_THRESHOLD = 10; // Same threshold as speaker audio
-        const hasAudioData = hasNonZero && rms > RMS_THRESHOLD;
+        if (microphoneSegmenter === null) {
+          microphoneSegmenter = createSegmenter(microphoneSampleRate) || false;
+          microphoneSegmenterStart = chunkStart;
+        }
+
+        let hasAudioData;
+        if (microphoneSegmenter) {
+          // Cut segments at speech pauses; spool before closing them
+          const result = microphoneSegmenter.process(buffer);
+          spoolSegmenterChunk(
+            getCaptureSpool("microphone", microphoneSampleRate),
+            microphoneSpoolHeld,
+            buffer,
+            result.pending || result.segments.length > 0,
+            microphoneSampleRate
+          );
+          saveMicrophoneSegments(microphoneSegmenter, result.segments);
+          hasAudioData = result.speaking;
+        } else {
+          // Check if audio has actual data before saving
+          hasAudioData = hasNonZero && rms > RMS_THRESHOLD;
+        }
 
         if (hasAudioData) {
-          // Save microphone audio chunks to file only if it has data
-          microphoneAudioChunks.push(buffer);
+          pushLocalStream("microphone", downsampleTo16k(int16View, microphoneSampleRate));
+
+          // Without the segmenter, save microphone audio chunks to file
+          // only if it has data
+          const segmentWriter = microphoneSegmenter ? null : getMicrophoneSegmentWriter();
+          if (segmentWriter) {
+            appendMicrophoneAudio(segmentWriter, buffer, chunkStart);
+          } else if (!microphoneSegmenter) {
+            microphoneAudioChunks.push(buffer);
+            microphoneBatchSpan = extendSpan(microphoneBatchSpan, chunkStart, int16View.length);
+          }
           microphoneAudioChunkCount++;
 
           // Log first few chunks for debugging with audio quality info
@@ -1241,22 +2450,29 @@ ipcMain.handle(
             }
           }
 
-          // Save as MP3 file every N chunks
-          if (microphoneAudioChunkCount % MICROPHONE_CHUNKS_PER_FILE === 0) {
+          // Without the segmenter, save as MP3 file every N chunks
+          if (
+            !microphoneSegmenter &&
+            microphoneAudioChunkCount % MICROPHONE_CHUNKS_PER_FILE === 0
+          ) {
             console.log(
               `📦 [Microphone] Reached ${microphoneAudioChunkCount} chunks, saving to file...`
             );
-            saveMicrophoneAudioChunksAsMP3();
+            if (segmentWriter) {
+              endMicrophoneSegment(segmentWriter);
+            } else {
+              saveMicrophoneAudioChunksAsMP3();
+            }
           }
-        } else {
+        }
+
+        if (!hasAudioData && microphoneAudioChunkCount % 100 === 0) {
           // Log occasionally to show we're skipping empty/silent audio
-          if (microphoneAudioChunkCount % 100 === 0) {
-            console.log(
-              `⏭️ [Microphone] Skipping empty/silent audio (rms=${rms.toFixed(
-                2
-              )}, hasNonZero=${hasNonZero}) - not saving`
-            );
-          }
+          console.log(
+            `⏭️ [Microphone] Skipping silent audio (rms=${rms.toFixed(
+              2
+            )}, hasNonZero=${hasNonZero}) - not saving`
+          );
         }
 
         return { success: true };
@@ -1269,6 +2485,34 @@ ipcMain.handle(
   }
 );
 
+// Stored segments of a source overlapping [fromMs, toMs); latest session by default
+ipcMain.handle(
+  "list-audio-segments",
+  async (event, source, fromMs, toMs, session) => {
+    const store = getSegmentStore();
+    const stream = SEGMENT_STREAMS[source];
+    if (!store || stream === undefined) return [];
+
+    if (session === undefined) {
+      const sessions = store
+        .streams()
+        .filter((entry) => entry.stream === stream)
+        .map((entry) => entry.session);
+      if (sessions.length === 0) return [];
+      session = Math.max(...sessions);
+    }
+    return store.query({ session, stream, fromMs, toMs });
+  }
+);
+
+ipcMain.handle("read-audio-segment", async (event, id) => {
+  const store = getSegmentStore();
+  if (!store) return null;
+  const segment = store.get(id);
+  const data = store.read(id);
+  return segment && data ? { ...segment, data } : null;
+});
+
 // Get desktop sources for screen/audio capture
 ipcMain.handle("get-desktop-sources", async (event, options = {}) => {
   try {
@@ -1349,6 +2593,10 @@ ipcMain.handle("destroy-rnnoise", async () => {
 app.whenReady().then(() => {
   createWindow();
 
+  if (LOCAL_ASR_MODE === "always") {
+    getLocalRecognizer();
+  }
+
   app.on("activate", () => {
     if (BrowserWindow.getAllWindows().length === 0) {
       createWindow();
@@ -1368,15 +2616,43 @@ app.on("window-all-closed", () => {
   }
 });
 
-app.on("before-quit", () => {
+app.on("before-quit", (event) => {
+  // Let the capture flush its last chunks first, then quit again
+  if (nativeAudioCapture) {
+    event.preventDefault();
+    const capture = nativeAudioCapture;
+    nativeAudioCapture = null;
+    capture
+      .stop()
+      .catch((error) => {
+        console.error("❌ Error stopping native audio capture:", error.message);
+      })
+      .then(() => app.quit());
+    return;
+  }
+  if (audioTrace) {
+    audioTrace.stop();
+    try {
+      audioTrace.save(AUDIO_TRACE_FILE);
+      console.log(`💾 Audio trace saved to ${AUDIO_TRACE_FILE}`);
+    } catch (error) {
+      console.error("❌ Failed to save audio trace:", error.message);
+    }
+  }
   if (microphoneConnection) {
     microphoneConnection.finish();
   }
   if (speakerConnection) {
     speakerConnection.finish();
   }
-  if (nativeAudioCapture) {
-    nativeAudioCapture.stop();
-    nativeAudioCapture = null;
+  // Unacknowledged segments stay on disk and are recovered on next start
+  for (const spool of captureSpools.values()) {
+    if (spool) spool.close();
+  }
+  if (segmentStore) {
+    segmentStore.close();
+  }
+  if (deepgramUploader) {
+    deepgramUploader.close();
   }
 });
@@ -28,6 +28,11 @@ contextBridge.exposeInMainWorld("electronAPI", {
     ipcRenderer.invoke("set-rnnoise-enabled", enabled),
   destroyRNNoise: () => ipcRenderer.invoke("destroy-rnnoise"),
 
+  // Stored audio segments (replay / re-transcription)
+  listAudioSegments: (source, fromMs, toMs, session) =>
+    ipcRenderer.invoke("list-audio-segments", source, fromMs, toMs, session),
+  readAudioSegment: (id) => ipcRenderer.invoke("read-audio-segment", id),
+
   // Desktop capture
   getDesktopSources: (options) =>
     ipcRenderer.invoke("get-desktop-sources", options),